@@ -150,6 +150,15 @@ if(CMAKE_COMPILER_IS_GNUCXX)
     endif()
   endif(NOT MINGW)
 
+  # AVX2/FMA instructions are enabled only for the sources with the runtime-dispatched code
+  if(ENABLE_AVX2_DISPATCH AND NOT MINGW)
+    ocv_check_flag_support(CXX "-mavx2 -mfma -ffp-contract=off" _varname)
+    if(${_varname})
+      set(HAVE_AVX2_DISPATCH 1)
+      set(OPENCV_AVX2_FLAGS "-mavx2 -mfma -ffp-contract=off")
+    endif()
+  endif()
+
   if(X86 OR X86_64)
     if(NOT APPLE AND CMAKE_SIZEOF_VOID_P EQUAL 4)
       if(ENABLE_SSE2)
@@ -222,6 +231,12 @@ if(MSVC)
     set(OPENCV_EXTRA_FLAGS "${OPENCV_EXTRA_FLAGS} /Oi")
   endif()
 
+  # /arch:AVX2 is available since VS2013
+  if(ENABLE_AVX2_DISPATCH AND NOT MSVC_VERSION LESS 1800)
+    set(HAVE_AVX2_DISPATCH 1)
+    set(OPENCV_AVX2_FLAGS "/arch:AVX2")
+  endif()
+
   if(X86 OR X86_64)
     if(CMAKE_SIZEOF_VOID_P EQUAL 4 AND ENABLE_SSE2)
       set(OPENCV_EXTRA_FLAGS "${OPENCV_EXTRA_FLAGS} /fp:fast")# !! important - be on the same wave with x64 compilers
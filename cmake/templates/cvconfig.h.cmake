@@ -166,6 +166,12 @@
 /* Intel Threading Building Blocks */
 #cmakedefine  HAVE_TBB
 
+/* AVX2/FMA code paths selected at runtime */
+#cmakedefine  HAVE_AVX2_DISPATCH
+
+/* Trace regions instrumentation (CV_TRACE_REGION) */
+#cmakedefine  HAVE_TRACE
+
 /* Eigen Matrix & Linear Algebra Library */
 #cmakedefine  HAVE_EIGEN
 
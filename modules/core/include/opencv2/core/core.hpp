@@ -271,6 +271,8 @@ CV_EXPORTS_W int64 getCPUTickCount();
   - CV_CPU_SSE4_2 - SSE 4.2
   - CV_CPU_POPCNT - POPCOUNT
   - CV_CPU_AVX - AVX
+  - CV_CPU_AVX2 - AVX 2
+  - CV_CPU_FMA3 - FMA 3
 
   \note {Note that the function output is not static. Once you called cv::useOptimized(false),
   most of the hardware acceleration is disabled and thus the function will returns false,
@@ -278,6 +280,16 @@ CV_EXPORTS_W int64 getCPUTickCount();
 */
 CV_EXPORTS_W bool checkHardwareSupport(int feature);
 
+/*!
+  Turns off or on the code paths that rely on the particular CPU feature
+
+  The function can be used to compare the different optimization levels, e.g.
+  after cv::setUseHardwareFeature(CV_CPU_AVX2, false) the functions that have AVX2 implementation
+  fall back to the SSE2 code. A feature not supported by the CPU can not be turned on.
+  cv::setUseOptimized(true) turns on all the supported features again.
+*/
+CV_EXPORTS void setUseHardwareFeature(int feature, bool onoff);
+
 //! returns the number of CPUs (including hyper-threading)
 CV_EXPORTS_W int getNumberOfCPUs();
 
@@ -1414,6 +1426,9 @@ static inline size_t getElemSize(int type) { return CV_ELEM_SIZE(type); }
    Custom array allocator
 
 */
+//! the callback releasing the external data owned by cv::Mat, see the Mat constructors taking it
+typedef void (*MatDataDeleter)(void* data, void* userdata);
+
 class CV_EXPORTS MatAllocator
 {
 public:
@@ -1424,6 +1439,85 @@ public:
     virtual void deallocate(int* refcount, uchar* datastart, uchar* data) = 0;
 };
 
+/*!
+   Size-class pooling array allocator
+
+   The released blocks are not returned to the system but kept in the free lists of the thread
+   that released them (up to getCacheLimit() bytes per thread), so that repeated allocation of
+   the same temporary sizes, e.g. on every video frame, does not hit malloc. Within the scope of
+   a cv::MatArenaScope the allocations made by the thread are carved from large chunks instead,
+   and a chunk goes back to the pool as soon as all the arrays allocated from it are released.
+
+   Use getPoolMatAllocator() to get the shared instance and Mat::setDefaultAllocator()
+   to make all the newly allocated matrices use it.
+*/
+class CV_EXPORTS PoolMatAllocator : public MatAllocator
+{
+public:
+    struct CV_EXPORTS Stats
+    {
+        Stats();
+        //! the ratio of the allocations served without calling the system allocator
+        double hitRate() const;
+
+        int64 allocations; //!< the number of allocate() calls
+        int64 bytes; //!< the total number of bytes requested
+        int64 poolHits; //!< the allocations served from the free lists or an arena chunk
+        int64 systemAllocations; //!< the number of blocks and chunks taken from fastMalloc
+    };
+
+    void allocate(int dims, const int* sizes, int type, int*& refcount,
+                  uchar*& datastart, uchar*& data, size_t* step);
+    void deallocate(int* refcount, uchar* datastart, uchar* data);
+
+    //! returns the statistics accumulated by all the threads since the last resetStats()
+    Stats getStats() const;
+    void resetStats();
+    //! sets the maximum number of bytes each thread keeps in its free lists
+    void setCacheLimit(size_t bytes);
+    size_t getCacheLimit() const;
+    //! returns all the blocks cached by the calling thread to the system
+    void releaseCache();
+
+protected:
+    PoolMatAllocator();
+};
+
+//! returns the process-wide pooling allocator
+CV_EXPORTS PoolMatAllocator* getPoolMatAllocator();
+
+/*!
+   Scoped arena mode of the pooling allocator.
+
+   While the object is alive, the arrays allocated by the current thread through
+   PoolMatAllocator are placed one after another in chunks of chunkSize bytes,
+   so all the temporaries created inside the block are released together.
+   The arrays that outlive the scope stay valid and keep their chunk alive.
+   The scopes can be nested but must be destroyed by the thread that created them.
+
+   \code
+   Mat::setDefaultAllocator(getPoolMatAllocator());
+   for(;;)
+   {
+       MatArenaScope arena;
+       cap >> frame;
+       process(frame);
+   }
+   \endcode
+*/
+class CV_EXPORTS MatArenaScope
+{
+public:
+    explicit MatArenaScope(size_t chunkSize=1 << 24);
+    ~MatArenaScope();
+
+protected:
+    void* arena;
+private:
+    MatArenaScope(const MatArenaScope&);
+    MatArenaScope& operator = (const MatArenaScope&);
+};
+
 /*!
    The n-dimensional matrix class.
 
@@ -1659,6 +1753,12 @@ public:
     Mat(int rows, int cols, int type, void* data, size_t step=AUTO_STEP);
     Mat(Size size, int type, void* data, size_t step=AUTO_STEP);
     Mat(int ndims, const int* sizes, int type, void* data, const size_t* steps=0);
+    //! constructor for matrix headers taking the ownership of the external data:
+    //! deleter(data, userdata) is called when the last reference to the data is released
+    Mat(int rows, int cols, int type, void* data, size_t step, MatDataDeleter deleter, void* userdata=0);
+    Mat(Size size, int type, void* data, size_t step, MatDataDeleter deleter, void* userdata=0);
+    Mat(int ndims, const int* sizes, int type, void* data, const size_t* steps,
+        MatDataDeleter deleter, void* userdata=0);
 
     //! creates a matrix header for a part of the bigger matrix
     Mat(const Mat& m, const Range& rowRange, const Range& colRange=Range::all());
@@ -1767,6 +1867,9 @@ public:
 
     //! deallocates the matrix data
     void deallocate();
+    //! sets the allocator used by create() when the matrix has no allocator of its own (0 means fastMalloc)
+    static void setDefaultAllocator(MatAllocator* allocator);
+    static MatAllocator* getDefaultAllocator();
     //! internal use function; properly re-allocates _size, _step arrays
     void copySize(const Mat& m);
 
@@ -2092,6 +2195,25 @@ CV_EXPORTS_W Scalar mean(InputArray src, InputArray mask=noArray());
 //! computes mean value and standard deviation of all or selected array elements
 CV_EXPORTS_W void meanStdDev(InputArray src, OutputArray mean, OutputArray stddev,
                              InputArray mask=noArray());
+//! per-channel statistics of the array elements computed by cv::calcStats
+struct CV_EXPORTS MatStats
+{
+    MatStats();
+    //! the mean value of the processed elements
+    Scalar mean() const;
+    //! the standard deviation of the processed elements
+    Scalar stddev() const;
+
+    Scalar sum; //!< the sum of the elements
+    Scalar sqsum; //!< the sum of the squared elements
+    Scalar minVal; //!< the minimum element
+    Scalar maxVal; //!< the maximum element
+    Scalar nonZero; //!< the number of the non-zero elements
+    int count; //!< the number of the processed elements (pixels)
+};
+
+//! computes sum, sum of squares, minimum, maximum and the number of non-zero elements of each channel in a single pass
+CV_EXPORTS void calcStats(InputArray src, MatStats& stats, InputArray mask=noArray());
 //! computes norm of the selected array part
 CV_EXPORTS_W double norm(InputArray src1, int normType=NORM_L2, InputArray mask=noArray());
 //! computes norm of selected part of the difference between two arrays
@@ -2230,6 +2352,9 @@ CV_EXPORTS_W void patchNaNs(InputOutputArray a, double val=0);
 //! implements generalized matrix product algorithm GEMM from BLAS
 CV_EXPORTS_W void gemm(InputArray src1, InputArray src2, double alpha,
                        InputArray src3, double gamma, OutputArray dst, int flags=0);
+//! computes dst[i] = alpha*op(src1[i])*op(src2[i]) + gamma*op(src3[i]) for every item of the batch, in parallel
+CV_EXPORTS void gemmBatched(InputArrayOfArrays src1, InputArrayOfArrays src2, double alpha,
+                            InputArrayOfArrays src3, double gamma, OutputArrayOfArrays dst, int flags=0);
 //! multiplies matrix by its transposition from the left or from the right
 CV_EXPORTS_W void mulTransposed( InputArray src, OutputArray dst, bool aTa,
                                  InputArray delta=noArray(),
@@ -3962,7 +4087,8 @@ public:
         FORMAT_MASK=(7<<3),
         FORMAT_AUTO=0,
         FORMAT_XML=(1<<3),
-        FORMAT_YAML=(2<<3)
+        FORMAT_YAML=(2<<3),
+        FORMAT_BINARY=(3<<3) //! memory-mapped binary format with raw matrix data
     };
     enum
     {
@@ -4009,6 +4135,8 @@ public:
 
     //! returns the normalized object name for the specified file name
     static string getDefaultObjectName(const string& filename);
+    //! converts the file storage to another format, e.g. XML or YAML to FORMAT_BINARY
+    static void convert(const string& srcFilename, const string& dstFilename, int dstFormat=FORMAT_AUTO);
 
     Ptr<CvFileStorage> fs; //!< the underlying C FileStorage structure
     string elname; //!< the currently written element
@@ -4618,7 +4746,117 @@ public:
     virtual ~ParallelLoopBody();
 };
 
-CV_EXPORTS void parallel_for_(const Range& range, const ParallelLoopBody& body);
+//! splits the range into about nstripes stripes and runs the body over them, possibly concurrently.
+//! nstripes <= 0 lets the active backend choose the granularity.
+CV_EXPORTS void parallel_for_(const Range& range, const ParallelLoopBody& body, double nstripes=-1.);
+
+//! the backends that can execute cv::parallel_for_
+enum
+{
+    PARALLEL_BACKEND_SERIAL=0,       //!< run the loop body on the calling thread
+    PARALLEL_BACKEND_THREAD_POOL=1,  //!< built-in work-stealing thread pool
+    PARALLEL_BACKEND_TBB=2,          //!< Intel Threading Building Blocks
+    PARALLEL_BACKEND_OPENMP=3,       //!< OpenMP
+    PARALLEL_BACKEND_GCD=4,          //!< Grand Central Dispatch
+    PARALLEL_BACKEND_CONCURRENCY=5   //!< Microsoft Concurrency Runtime
+};
+
+//! selects the backend used by parallel_for_. Returns false if it is not available in this build
+CV_EXPORTS bool setParallelBackend(int backend);
+//! returns the backend currently used by parallel_for_
+CV_EXPORTS int getParallelBackend();
+
+/////////////////////////////// Synchronization Primitives //////////////////////////////////
+
+class CV_EXPORTS Mutex
+{
+public:
+    Mutex();
+    ~Mutex();
+    Mutex(const Mutex& m);
+    Mutex& operator = (const Mutex& m);
+
+    void lock();
+    bool trylock();
+    void unlock();
+
+    struct Impl;
+protected:
+    Impl* impl;
+};
+
+class CV_EXPORTS AutoLock
+{
+public:
+    AutoLock(Mutex& m) : mutex(&m) { mutex->lock(); }
+    ~AutoLock() { mutex->unlock(); }
+protected:
+    Mutex* mutex;
+private:
+    AutoLock(const AutoLock&);
+    AutoLock& operator = (const AutoLock&);
+};
+
+/////////////////////////////// Tracing //////////////////////////////////
+
+//! the static description of a trace region; one per place in the code (see CV_TRACE_REGION)
+struct TraceRegionInfo
+{
+    const char* name;
+    const char* filename;
+    int line;
+    int id; //!< assigned by the library when the region is entered for the first time
+};
+
+//! measures the time spent in the scope where the object lives. Does nothing if tracing is disabled
+class CV_EXPORTS TraceRegion
+{
+public:
+    TraceRegion(TraceRegionInfo& info);
+    ~TraceRegion();
+protected:
+    bool active;
+private:
+    TraceRegion(const TraceRegion&);
+    TraceRegion& operator = (const TraceRegion&);
+};
+
+//! the statistics collected for a trace region. The times are in microseconds
+struct CV_EXPORTS TraceRegionStats
+{
+    TraceRegionStats();
+
+    string name;
+    string filename;
+    int line;
+    int64 count;        //!< the number of times the region has been entered
+    double totalTime;   //!< the total time spent in the region
+    double selfTime;    //!< the total time minus the time spent in the nested regions
+    double meanTime;
+    double medianTime;  //!< the percentiles are computed over the calls still kept in the trace buffers
+    double p90Time;
+    double p99Time;
+    double maxTime;
+    int parallelBackend; //!< the last parallel_for_ backend used in the region, -1 if it did not run any
+    int simdPaths;       //!< the mask of (1 << CV_CPU_*) code paths taken in the region
+};
+
+//! turns the collection of the trace on or off (it is on at startup if OPENCV_TRACE environment variable is set)
+CV_EXPORTS void setTraceEnabled(bool enabled);
+//! returns true if the trace is collected
+CV_EXPORTS bool isTraceEnabled();
+//! sets the maximum number of the recent region calls kept by each thread
+CV_EXPORTS void setTraceBufferSize(int ncalls);
+//! discards everything collected so far
+CV_EXPORTS void resetTrace();
+//! returns the statistics for all the regions entered so far, sorted by the total time
+CV_EXPORTS void getTraceStats(vector<TraceRegionStats>& stats);
+//! writes the recent calls to the file in the Chrome trace event format (chrome://tracing)
+CV_EXPORTS void writeTrace(const string& filename);
+//! records in the innermost open region of the calling thread that the code path for the CPU feature was taken
+CV_EXPORTS void traceSimdPath(int feature);
+//! records in the innermost open region of the calling thread that the parallel backend was used
+CV_EXPORTS void traceParallelBackend(int backend);
 
 }
 
@@ -186,6 +186,25 @@ CV_INLINE IppiSize ippiSize(int width, int height)
 
 #ifdef __cplusplus
 
+/* trace regions; compiled in only when OpenCV is configured with ENABLE_TRACE=ON.
+   CV_TRACE_SIMD is meant to be called once per function or per stripe (e.g. when the vector
+   code path is chosen), not from the per-row kernels */
+#ifdef HAVE_TRACE
+#define CV_TRACE_CONCAT_(a, b) a##b
+#define CV_TRACE_CONCAT(a, b) CV_TRACE_CONCAT_(a, b)
+#define CV_TRACE_REGION(name) \
+    static cv::TraceRegionInfo CV_TRACE_CONCAT(__cv_trace_info_, __LINE__) = { name, __FILE__, __LINE__, 0 }; \
+    cv::TraceRegion CV_TRACE_CONCAT(__cv_trace_region_, __LINE__)(CV_TRACE_CONCAT(__cv_trace_info_, __LINE__))
+#define CV_TRACE_FUNCTION() CV_TRACE_REGION(__func__)
+#define CV_TRACE_SIMD(feature) cv::traceSimdPath(feature)
+#define CV_TRACE_PARALLEL(backend) cv::traceParallelBackend(backend)
+#else
+#define CV_TRACE_REGION(name)
+#define CV_TRACE_FUNCTION()
+#define CV_TRACE_SIMD(feature) ((void)0)
+#define CV_TRACE_PARALLEL(backend) ((void)0)
+#endif
+
 namespace cv
 {
 #ifdef HAVE_TBB
@@ -195,6 +214,7 @@ namespace cv
     template<typename Body> static inline
     void parallel_for( const BlockedRange& range, const Body& body )
     {
+        CV_TRACE_PARALLEL(PARALLEL_BACKEND_TBB);
         tbb::parallel_for(range, body);
     }
 
@@ -209,6 +229,7 @@ namespace cv
     template<typename Body> static inline
     void parallel_reduce( const BlockedRange& range, Body& body )
     {
+        CV_TRACE_PARALLEL(PARALLEL_BACKEND_TBB);
         tbb::parallel_reduce(range, body);
     }
 
@@ -231,6 +252,7 @@ namespace cv
     template<typename Body> static inline
     void parallel_for( const BlockedRange& range, const Body& body )
     {
+        CV_TRACE_PARALLEL(PARALLEL_BACKEND_SERIAL);
         body(range);
     }
     typedef std::vector<Rect> ConcurrentRectVector;
@@ -248,6 +270,7 @@ namespace cv
     template<typename Body> static inline
     void parallel_reduce( const BlockedRange& range, Body& body )
     {
+        CV_TRACE_PARALLEL(PARALLEL_BACKEND_SERIAL);
         body(range);
     }
 #endif
@@ -1298,26 +1298,38 @@ CV_EXPORTS MatExpr operator / (const MatExpr& e1, const MatExpr& e2);
 CV_EXPORTS MatExpr operator < (const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr operator < (const Mat& a, double s);
 CV_EXPORTS MatExpr operator < (double s, const Mat& a);
+CV_EXPORTS MatExpr operator < (const MatExpr& e, double s);
+CV_EXPORTS MatExpr operator < (double s, const MatExpr& e);
 
 CV_EXPORTS MatExpr operator <= (const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr operator <= (const Mat& a, double s);
 CV_EXPORTS MatExpr operator <= (double s, const Mat& a);
+CV_EXPORTS MatExpr operator <= (const MatExpr& e, double s);
+CV_EXPORTS MatExpr operator <= (double s, const MatExpr& e);
 
 CV_EXPORTS MatExpr operator == (const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr operator == (const Mat& a, double s);
 CV_EXPORTS MatExpr operator == (double s, const Mat& a);
+CV_EXPORTS MatExpr operator == (const MatExpr& e, double s);
+CV_EXPORTS MatExpr operator == (double s, const MatExpr& e);
 
 CV_EXPORTS MatExpr operator != (const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr operator != (const Mat& a, double s);
 CV_EXPORTS MatExpr operator != (double s, const Mat& a);
+CV_EXPORTS MatExpr operator != (const MatExpr& e, double s);
+CV_EXPORTS MatExpr operator != (double s, const MatExpr& e);
 
 CV_EXPORTS MatExpr operator >= (const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr operator >= (const Mat& a, double s);
 CV_EXPORTS MatExpr operator >= (double s, const Mat& a);
+CV_EXPORTS MatExpr operator >= (const MatExpr& e, double s);
+CV_EXPORTS MatExpr operator >= (double s, const MatExpr& e);
 
 CV_EXPORTS MatExpr operator > (const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr operator > (const Mat& a, double s);
 CV_EXPORTS MatExpr operator > (double s, const Mat& a);
+CV_EXPORTS MatExpr operator > (const MatExpr& e, double s);
+CV_EXPORTS MatExpr operator > (double s, const MatExpr& e);
 
 CV_EXPORTS MatExpr min(const Mat& a, const Mat& b);
 CV_EXPORTS MatExpr min(const Mat& a, double s);
@@ -2941,9 +2941,6 @@ inline size_t FileNode::size() const
         t == SEQ ? node->data.seq->total : (size_t)!isNone();
 }
 
-inline CvFileNode* FileNode::operator *() { return (CvFileNode*)node; }
-inline const CvFileNode* FileNode::operator* () const { return node; }
-
 static inline void read(const FileNode& node, int& value, int default_value)
 {
     value = !node.node ? default_value :
@@ -188,3 +188,59 @@ PERF_TEST_P(Size_MatType, subtractScalar, TYPICAL_MATS_CORE_ARITHM)
     if (CV_MAT_DEPTH(type) != CV_32S)
         SANITY_CHECK(c, 1e-8);
 }
+
+typedef std::tr1::tuple<Size, MatType, SimdTier> Size_MatType_SimdTier_t;
+typedef perf::TestBaseWithParam<Size_MatType_SimdTier_t> Size_MatType_SimdTier;
+
+#define TIER_MATS_CORE_ARITHM testing::Combine( \
+    testing::Values( szVGA, sz1080p ), \
+    testing::Values( CV_8UC1, CV_16SC1, CV_32SC1, CV_32FC1, CV_64FC1 ), \
+    testing::ValuesIn( SimdTier::all() ) )
+
+PERF_TEST_P(Size_MatType_SimdTier, add_tier, TIER_MATS_CORE_ARITHM)
+{
+    Size sz = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    SimdTierScope tier(get<2>(GetParam()));
+    cv::Mat a = Mat(sz, type);
+    cv::Mat b = Mat(sz, type);
+    cv::Mat c = Mat(sz, type);
+
+    declare.in(a, b, WARMUP_RNG).out(c);
+
+    TEST_CYCLE() add(a, b, c);
+
+    SANITY_CHECK(c, 1e-8);
+}
+
+PERF_TEST_P(Size_MatType_SimdTier, absdiff_tier, TIER_MATS_CORE_ARITHM)
+{
+    Size sz = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    SimdTierScope tier(get<2>(GetParam()));
+    cv::Mat a = Mat(sz, type);
+    cv::Mat b = Mat(sz, type);
+    cv::Mat c = Mat(sz, type);
+
+    declare.in(a, b, WARMUP_RNG).out(c);
+
+    TEST_CYCLE() absdiff(a, b, c);
+
+    SANITY_CHECK(c, 1e-8);
+}
+
+PERF_TEST_P(Size_MatType_SimdTier, max_tier, TIER_MATS_CORE_ARITHM)
+{
+    Size sz = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    SimdTierScope tier(get<2>(GetParam()));
+    cv::Mat a = Mat(sz, type);
+    cv::Mat b = Mat(sz, type);
+    cv::Mat c = Mat(sz, type);
+
+    declare.in(a, b, WARMUP_RNG).out(c);
+
+    TEST_CYCLE() max(a, b, c);
+
+    SANITY_CHECK(c);
+}
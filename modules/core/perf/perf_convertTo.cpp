@@ -34,3 +34,32 @@ PERF_TEST_P( Size_DepthSrc_DepthDst_Channels_alpha, convertTo,
 
     SANITY_CHECK(dst, alpha == 1.0 ? 1e-12 : 1e-7);
 }
+
+typedef std::tr1::tuple<Size, MatType, MatType, double, SimdTier> Size_DepthSrc_DepthDst_alpha_SimdTier_t;
+typedef perf::TestBaseWithParam<Size_DepthSrc_DepthDst_alpha_SimdTier_t> Size_DepthSrc_DepthDst_alpha_SimdTier;
+
+PERF_TEST_P( Size_DepthSrc_DepthDst_alpha_SimdTier, convertTo_tier,
+             testing::Combine
+             (
+                 testing::Values(szVGA, sz1080p),
+                 testing::Values(CV_8U, CV_16S, CV_32F),
+                 testing::Values(CV_8U, CV_16S, CV_32F),
+                 testing::Values(1.0, 1./255),
+                 testing::ValuesIn(SimdTier::all())
+             )
+           )
+{
+    Size sz = get<0>(GetParam());
+    int depthSrc = get<1>(GetParam());
+    int depthDst = get<2>(GetParam());
+    double alpha = get<3>(GetParam());
+    SimdTierScope tier(get<4>(GetParam()));
+
+    Mat src(sz, CV_MAKETYPE(depthSrc, 1));
+    randu(src, 0, 255);
+    Mat dst(sz, CV_MAKETYPE(depthDst, 1));
+
+    TEST_CYCLE() src.convertTo(dst, depthDst, alpha);
+
+    SANITY_CHECK(dst, alpha == 1.0 ? 1e-12 : 1e-7);
+}
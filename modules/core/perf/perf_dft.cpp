@@ -6,8 +6,9 @@ using namespace perf;
 using std::tr1::make_tuple;
 using std::tr1::get;
 
-#define MAT_TYPES_DFT  CV_32FC1, CV_64FC1
-#define MAT_SIZES_DFT  sz1080p, sz2K
+// power-of-two sizes and mixed-radix sizes: 640 = 2^7*5, 480 = 2^5*3*5, 1000 = 2^3*5^3, 1080 = 2^3*3^3*5
+#define MAT_TYPES_DFT  CV_32FC1, CV_64FC1, CV_32FC2
+#define MAT_SIZES_DFT  Size(512, 512), Size(1024, 1024), sz2K, szVGA, Size(1000, 1000), sz1080p
 #define TEST_MATS_DFT  testing::Combine(testing::Values(MAT_SIZES_DFT), testing::Values(MAT_TYPES_DFT))
 
 PERF_TEST_P(Size_MatType, dft, TEST_MATS_DFT)
@@ -24,3 +25,45 @@ PERF_TEST_P(Size_MatType, dft, TEST_MATS_DFT)
 
     SANITY_CHECK(dst, 1e-5);
 }
+
+// the small transforms, like in the frequency-domain template matching, where the
+// initialization of the twiddle factors used to take a noticeable part of the time
+PERF_TEST_P(Size_MatType, dft_small,
+            testing::Combine(
+                testing::Values(Size(32, 32), Size(60, 60), Size(64, 64), Size(100, 75)),
+                testing::Values(CV_32FC1, CV_64FC1)
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int type = get<1>(GetParam());
+
+    Mat src(sz, type);
+    Mat dst(sz, type);
+
+    declare.in(src, WARMUP_RNG);
+
+    TEST_CYCLE_MULTIRUN(100) dft(src, dst);
+
+    SANITY_CHECK(dst, 1e-5);
+}
+
+PERF_TEST_P(Size_MatType, dct,
+            testing::Combine(
+                testing::Values(Size(512, 512), Size(1024, 1024), szVGA, Size(1000, 1000)),
+                testing::Values(CV_32FC1, CV_64FC1)
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int type = get<1>(GetParam());
+
+    Mat src(sz, type);
+    Mat dst(sz, type);
+
+    declare.in(src, WARMUP_RNG).time(60);
+
+    TEST_CYCLE() dct(src, dst);
+
+    SANITY_CHECK(dst, 1e-5);
+}
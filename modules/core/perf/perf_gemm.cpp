@@ -0,0 +1,95 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+// "optimized" = false runs the original block loop instead of the packed-panel kernel
+// (the packed kernel is taken only when cv::useOptimized() is true)
+
+typedef std::tr1::tuple<int, MatType, bool> Size_MatType_Optimized_t;
+typedef perf::TestBaseWithParam<Size_MatType_Optimized_t> Size_MatType_Optimized;
+
+PERF_TEST_P(Size_MatType_Optimized, gemm_square,
+            testing::Combine(
+                testing::Values(64, 128, 256, 512),
+                testing::Values(CV_32FC1, CV_64FC1),
+                testing::Bool()
+                )
+            )
+{
+    int n = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    bool optimized = get<2>(GetParam());
+
+    Mat a(n, n, type), b(n, n, type), c(n, n, type), d(n, n, type);
+
+    declare.in(a, b, c, WARMUP_RNG).out(d);
+
+    setUseOptimized(optimized);
+    TEST_CYCLE() gemm(a, b, 1, c, 1, d);
+    setUseOptimized(true);
+
+    SANITY_CHECK(d, 1e-4, ERROR_RELATIVE);
+}
+
+// the skinny products: d is rows x cols, the inner dimension is len
+typedef std::tr1::tuple<Size, int, MatType, bool> Size_Len_MatType_Optimized_t;
+typedef perf::TestBaseWithParam<Size_Len_MatType_Optimized_t> Size_Len_MatType_Optimized;
+
+PERF_TEST_P(Size_Len_MatType_Optimized, gemm_skinny,
+            testing::Combine(
+                testing::Values(Size(4096, 16), Size(16, 4096), Size(1024, 64), Size(64, 64)),
+                testing::Values(64, 1024, 4096),
+                testing::Values(CV_32FC1, CV_64FC1),
+                testing::Bool()
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int len = get<1>(GetParam());
+    int type = get<2>(GetParam());
+    bool optimized = get<3>(GetParam());
+
+    Mat a(sz.height, len, type), b(sz.width, len, type), d(sz, type);
+
+    declare.in(a, b, WARMUP_RNG).out(d);
+
+    setUseOptimized(optimized);
+    TEST_CYCLE() gemm(a, b, 1, noArray(), 0, d, GEMM_2_T);
+    setUseOptimized(true);
+
+    SANITY_CHECK(d, 1e-4, ERROR_RELATIVE);
+}
+
+typedef std::tr1::tuple<int, int, MatType> Count_Size_MatType_t;
+typedef perf::TestBaseWithParam<Count_Size_MatType_t> Count_Size_MatType;
+
+PERF_TEST_P(Count_Size_MatType, gemmBatched,
+            testing::Combine(
+                testing::Values(100, 1000),
+                testing::Values(4, 8, 16, 32),
+                testing::Values(CV_32FC1, CV_64FC1)
+                )
+            )
+{
+    int count = get<0>(GetParam());
+    int n = get<1>(GetParam());
+    int type = get<2>(GetParam());
+
+    vector<Mat> a(count), b(count), d(count);
+    for( int i = 0; i < count; i++ )
+    {
+        a[i].create(n, n, type);
+        b[i].create(n, n, type);
+        d[i].create(n, n, type);
+        randu(a[i], -1, 1);
+        randu(b[i], -1, 1);
+    }
+
+    TEST_CYCLE() gemmBatched(a, b, 1, noArray(), 0, d);
+
+    SANITY_CHECK(d[0], 1e-4, ERROR_RELATIVE);
+}
@@ -0,0 +1,111 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+// The element-wise matrix expressions evaluated in a single pass vs the same
+// computations done by the separate functions with the full-size temporaries.
+
+enum { EXPR_EAGER, EXPR_FUSED };
+CV_ENUM(ExprMode, EXPR_EAGER, EXPR_FUSED)
+
+typedef std::tr1::tuple<Size, MatType, ExprMode> Size_MatType_ExprMode_t;
+typedef perf::TestBaseWithParam<Size_MatType_ExprMode_t> Size_MatType_ExprMode;
+
+PERF_TEST_P(Size_MatType_ExprMode, matexpr_weightedSum,
+            testing::Combine(
+                testing::Values(sz1080p, sz2160p),
+                testing::Values(CV_8UC1, CV_8UC3, CV_32FC1),
+                testing::ValuesIn(ExprMode::all())
+                )
+            )
+{
+    Size size = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    int mode = get<2>(GetParam());
+
+    Mat a(size, type), b(size, type), c(size, type), dst(size, type), temp;
+    declare.in(a, b, c, WARMUP_RNG).out(dst);
+
+    if( mode == EXPR_FUSED )
+    {
+        TEST_CYCLE() dst = a*0.7 + b*0.3 - c;
+    }
+    else
+    {
+        TEST_CYCLE()
+        {
+            addWeighted(a, 0.7, b, 0.3, 0, temp);
+            subtract(temp, c, dst);
+        }
+    }
+
+    SANITY_CHECK(dst, 1);
+}
+
+PERF_TEST_P(Size_MatType_ExprMode, matexpr_absdiffThreshold,
+            testing::Combine(
+                testing::Values(sz1080p, sz2160p),
+                testing::Values(CV_8UC1, CV_8UC3, CV_32FC1),
+                testing::ValuesIn(ExprMode::all())
+                )
+            )
+{
+    Size size = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    int mode = get<2>(GetParam());
+
+    Mat a(size, type), b(size, type), dst(size, CV_8UC(CV_MAT_CN(type))), temp;
+    declare.in(a, b, WARMUP_RNG).out(dst);
+
+    if( mode == EXPR_FUSED )
+    {
+        TEST_CYCLE() dst = abs(a - b) > 30;
+    }
+    else
+    {
+        TEST_CYCLE()
+        {
+            absdiff(a, b, temp);
+            compare(temp, 30, dst, CMP_GT);
+        }
+    }
+
+    SANITY_CHECK(dst);
+}
+
+PERF_TEST_P(Size_MatType_ExprMode, matexpr_chain,
+            testing::Combine(
+                testing::Values(sz1080p, sz2160p),
+                testing::Values(CV_8UC1, CV_32FC1),
+                testing::ValuesIn(ExprMode::all())
+                )
+            )
+{
+    Size size = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    int mode = get<2>(GetParam());
+
+    Mat a(size, type), b(size, type), c(size, type), dst(size, type), t0, t1;
+    declare.in(a, b, c, WARMUP_RNG).out(dst);
+
+    if( mode == EXPR_FUSED )
+    {
+        TEST_CYCLE() dst = (a - b).mul(c, 1./255) + max(a, b)*0.5;
+    }
+    else
+    {
+        TEST_CYCLE()
+        {
+            subtract(a, b, t0);
+            multiply(t0, c, t0, 1./255);
+            max(a, b, t1);
+            addWeighted(t1, 0.5, t0, 1, 0, dst);
+        }
+    }
+
+    SANITY_CHECK(dst, 1);
+}
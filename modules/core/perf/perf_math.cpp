@@ -21,3 +21,68 @@ PERF_TEST_P(VectorLength, phase32f, testing::Values(128, 1000, 128*1024, 512*102
 
     SANITY_CHECK(angle, 5e-5);
 }
+
+typedef std::tr1::tuple<size_t, SimdTier> VectorLength_SimdTier_t;
+typedef perf::TestBaseWithParam<VectorLength_SimdTier_t> VectorLength_SimdTier;
+
+#define TIER_VECTOR_LENGTHS testing::Combine( \
+    testing::Values( 1000, 128*1024, 1024*1024 ), \
+    testing::ValuesIn( SimdTier::all() ) )
+
+PERF_TEST_P(VectorLength_SimdTier, phase32f_tier, TIER_VECTOR_LENGTHS)
+{
+    size_t length = get<0>(GetParam());
+    SimdTierScope tier(get<1>(GetParam()));
+    vector<float> X(length);
+    vector<float> Y(length);
+    vector<float> angle(length);
+
+    declare.in(X, Y, WARMUP_RNG).out(angle);
+
+    TEST_CYCLE_N(200) cv::phase(X, Y, angle, true);
+
+    SANITY_CHECK(angle, 5e-5);
+}
+
+PERF_TEST_P(VectorLength_SimdTier, magnitude32f_tier, TIER_VECTOR_LENGTHS)
+{
+    size_t length = get<0>(GetParam());
+    SimdTierScope tier(get<1>(GetParam()));
+    vector<float> X(length);
+    vector<float> Y(length);
+    vector<float> mag(length);
+
+    declare.in(X, Y, WARMUP_RNG).out(mag);
+
+    TEST_CYCLE_N(200) cv::magnitude(X, Y, mag);
+
+    SANITY_CHECK(mag, 1e-6);
+}
+
+PERF_TEST_P(VectorLength_SimdTier, exp32f_tier, TIER_VECTOR_LENGTHS)
+{
+    size_t length = get<0>(GetParam());
+    SimdTierScope tier(get<1>(GetParam()));
+    Mat src((int)length, 1, CV_32F), dst((int)length, 1, CV_32F);
+
+    randu(src, -10, 10);
+    declare.in(src).out(dst);
+
+    TEST_CYCLE_N(200) cv::exp(src, dst);
+
+    SANITY_CHECK(dst, 1e-5);
+}
+
+PERF_TEST_P(VectorLength_SimdTier, log32f_tier, TIER_VECTOR_LENGTHS)
+{
+    size_t length = get<0>(GetParam());
+    SimdTierScope tier(get<1>(GetParam()));
+    Mat src((int)length, 1, CV_32F), dst((int)length, 1, CV_32F);
+
+    randu(src, 0.01, 1000);
+    declare.in(src).out(dst);
+
+    TEST_CYCLE_N(200) cv::log(src, dst);
+
+    SANITY_CHECK(dst, 1e-5);
+}
@@ -0,0 +1,48 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+// Time of opening a file storage and reading a dense matrix from it. The binary
+// storage is memory-mapped, so reading the matrix does not copy the data.
+
+enum { FS_XML = FileStorage::FORMAT_XML, FS_YAML = FileStorage::FORMAT_YAML, FS_BINARY = FileStorage::FORMAT_BINARY };
+CV_ENUM(StorageFormat, FS_XML, FS_YAML, FS_BINARY)
+
+typedef std::tr1::tuple<Size, MatType, StorageFormat> Size_MatType_StorageFormat_t;
+typedef perf::TestBaseWithParam<Size_MatType_StorageFormat_t> Size_MatType_StorageFormat;
+
+PERF_TEST_P(Size_MatType_StorageFormat, FileStorage_readMat,
+            testing::Combine(
+                testing::Values(szQVGA, szVGA),
+                testing::Values(CV_8UC3, CV_32FC1),
+                testing::ValuesIn(StorageFormat::all())
+                )
+            )
+{
+    Size size = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    int format = get<2>(GetParam());
+
+    Mat src(size, type), dst;
+    declare.in(src, WARMUP_RNG);
+
+    string filename = cv::tempfile(format == FS_XML ? ".xml" : format == FS_YAML ? ".yml" : ".bin");
+    {
+        FileStorage fs(filename, FileStorage::WRITE + format);
+        fs << "mat" << src;
+    }
+
+    TEST_CYCLE()
+    {
+        FileStorage fs(filename, FileStorage::READ);
+        fs["mat"] >> dst;
+    }
+
+    remove(filename.c_str());
+
+    SANITY_CHECK(dst);
+}
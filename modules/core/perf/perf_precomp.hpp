@@ -7,6 +7,19 @@
 #define __OPENCV_PERF_PRECOMP_HPP__
 
 #include "opencv2/ts/ts.hpp"
+#include "opencv2/core/core_c.h"
+
+// Optimization tiers compared by the *_tier tests. On the CPUs without AVX2
+// both tiers run the SSE2 code.
+enum { SIMD_SSE2, SIMD_AVX2 };
+CV_ENUM(SimdTier, SIMD_SSE2, SIMD_AVX2)
+
+class SimdTierScope
+{
+public:
+    explicit SimdTierScope(int tier) { cv::setUseHardwareFeature(CV_CPU_AVX2, tier == SIMD_AVX2); }
+    ~SimdTierScope() { cv::setUseHardwareFeature(CV_CPU_AVX2, true); }
+};
 
 #ifdef GTEST_CREATE_SHARED_LIBRARY
 #error no modules except ts should have GTEST_CREATE_SHARED_LIBRARY defined
@@ -101,3 +101,50 @@ PERF_TEST_P(Size_MatType, countNonZero, testing::Combine( testing::Values( TYPIC
 
     SANITY_CHECK(cnt);
 }
+
+#define TYPICAL_MATS_STATS testing::Combine( testing::Values( TYPICAL_MAT_SIZES ), testing::Values( CV_8UC1, CV_16UC1, CV_32FC1, CV_8UC3 ) )
+
+PERF_TEST_P(Size_MatType, calcStats, TYPICAL_MATS_STATS)
+{
+    Size sz = get<0>(GetParam());
+    int matType = get<1>(GetParam());
+
+    Mat src(sz, matType);
+    MatStats stats;
+
+    declare.in(src, WARMUP_RNG);
+
+    TEST_CYCLE() calcStats(src, stats);
+
+    SANITY_CHECK(stats.mean(), 1e-6);
+    SANITY_CHECK(stats.stddev(), 1e-6);
+    SANITY_CHECK(stats.minVal);
+    SANITY_CHECK(stats.maxVal);
+}
+
+// the same statistics computed by the separate calls, for comparison with calcStats
+PERF_TEST_P(Size_MatType, calcStats_separate, TYPICAL_MATS_STATS)
+{
+    Size sz = get<0>(GetParam());
+    int matType = get<1>(GetParam());
+
+    Mat src(sz, matType);
+    Scalar mean, dev;
+    double minVal = 0, maxVal = 0;
+    int nz = 0;
+
+    declare.in(src, WARMUP_RNG);
+
+    TEST_CYCLE()
+    {
+        meanStdDev(src, mean, dev);
+        minMaxIdx(src.reshape(1), &minVal, &maxVal);
+        nz = countNonZero(src.reshape(1));
+    }
+
+    SANITY_CHECK(mean, 1e-6);
+    SANITY_CHECK(dev, 1e-6);
+    SANITY_CHECK(minVal);
+    SANITY_CHECK(maxVal);
+    SANITY_CHECK(nz);
+}
@@ -681,6 +681,408 @@ void fastFree( void* ptr )
 
 #endif //CV_USE_SYSTEM_MALLOC
 
+/****************************************************************************************\
+*                                 Pooling Mat allocator                                  *
+\****************************************************************************************/
+
+/*
+   Every block handed out by PoolMatAllocator starts with the header below, followed by
+   the matrix data and the reference counter. The pooled blocks have one of the size classes
+   (4 classes per octave, so at most 25% of the block is wasted) and are kept in the
+   per-thread free lists after they are released; the blocks carved from an arena chunk keep
+   the chunk alive until the last of them is released.
+*/
+struct PoolArenaChunk;
+
+struct PoolBlockHeader
+{
+    size_t size;
+    PoolArenaChunk* chunk;
+    PoolBlockHeader* next;
+    int sizeClass;
+};
+
+struct PoolArenaChunk
+{
+    int refcount;
+    size_t size;
+    uchar* ptr;
+    uchar* end;
+};
+
+struct PoolArena
+{
+    PoolArena* prev;
+    size_t chunkSize;
+    PoolArenaChunk* chunk;
+};
+
+static const size_t POOL_HDR_SIZE = (sizeof(PoolBlockHeader) + CV_MALLOC_ALIGN - 1)/CV_MALLOC_ALIGN*CV_MALLOC_ALIGN;
+static const size_t POOL_CHUNK_HDR_SIZE = (sizeof(PoolArenaChunk) + CV_MALLOC_ALIGN - 1)/CV_MALLOC_ALIGN*CV_MALLOC_ALIGN;
+
+enum { POOL_MIN_SHIFT = 6, POOL_MAX_SHIFT = 30, POOL_NCLASSES = (POOL_MAX_SHIFT - POOL_MIN_SHIFT)*4 + 1 };
+
+static size_t poolCacheLimit = (size_t)64 << 20;
+
+static int poolSizeClass(size_t n, size_t& csize)
+{
+    if( n <= ((size_t)1 << POOL_MIN_SHIFT) )
+    {
+        csize = (size_t)1 << POOL_MIN_SHIFT;
+        return 0;
+    }
+    int k = POOL_MIN_SHIFT;
+    while( ((n - 1) >> (k + 1)) != 0 )
+        k++;
+    if( k >= POOL_MAX_SHIFT )
+    {
+        csize = n;
+        return -1;
+    }
+    size_t base = (size_t)1 << k, quarter = base >> 2;
+    int sub = (int)((n - base - 1)/quarter);
+    csize = base + (sub + 1)*quarter;
+    return (k - POOL_MIN_SHIFT)*4 + sub + 1;
+}
+
+struct PoolThreadCache
+{
+    PoolThreadCache();
+    ~PoolThreadCache();
+
+    void release();
+    void releaseChunk(PoolArenaChunk* chunk);
+
+    PoolBlockHeader* freeLists[POOL_NCLASSES];
+    vector<PoolArenaChunk*> spareChunks;
+    size_t cachedBytes;
+    PoolArena* arena;
+    PoolMatAllocator::Stats stats;
+    PoolThreadCache* prev;
+    PoolThreadCache* next;
+};
+
+// the list of all live thread caches, used to collect the statistics. The counters of
+// the other threads are read without synchronization, so the result is approximate
+// while those threads keep allocating.
+static PoolThreadCache* poolCaches = 0;
+static PoolMatAllocator::Stats poolRetiredStats;
+
+static Mutex& getPoolMutex()
+{
+    static Mutex m;
+    return m;
+}
+
+PoolThreadCache::PoolThreadCache()
+{
+    memset(freeLists, 0, sizeof(freeLists));
+    cachedBytes = 0;
+    arena = 0;
+    prev = 0;
+
+    AutoLock lock(getPoolMutex());
+    next = poolCaches;
+    if( next )
+        next->prev = this;
+    poolCaches = this;
+}
+
+PoolThreadCache::~PoolThreadCache()
+{
+    {
+    AutoLock lock(getPoolMutex());
+    if( prev )
+        prev->next = next;
+    else
+        poolCaches = next;
+    if( next )
+        next->prev = prev;
+    poolRetiredStats.allocations += stats.allocations;
+    poolRetiredStats.bytes += stats.bytes;
+    poolRetiredStats.poolHits += stats.poolHits;
+    poolRetiredStats.systemAllocations += stats.systemAllocations;
+    }
+
+    release();
+}
+
+void PoolThreadCache::release()
+{
+    for( int i = 0; i < POOL_NCLASSES; i++ )
+    {
+        PoolBlockHeader* block = freeLists[i];
+        while( block )
+        {
+            PoolBlockHeader* nextBlock = block->next;
+            fastFree(block);
+            block = nextBlock;
+        }
+        freeLists[i] = 0;
+    }
+    for( size_t i = 0; i < spareChunks.size(); i++ )
+        fastFree(spareChunks[i]);
+    spareChunks.clear();
+    cachedBytes = 0;
+}
+
+void PoolThreadCache::releaseChunk(PoolArenaChunk* chunk)
+{
+    if( CV_XADD(&chunk->refcount, -1) != 1 )
+        return;
+    if( cachedBytes + chunk->size <= poolCacheLimit )
+    {
+        spareChunks.push_back(chunk);
+        cachedBytes += chunk->size;
+    }
+    else
+        fastFree(chunk);
+}
+
+#if defined WIN32 || defined _WIN32
+#ifdef WINCE
+#   define TLS_OUT_OF_INDEXES ((DWORD)0xFFFFFFFF)
+#endif //WINCE
+
+static DWORD poolTlsKey = TLS_OUT_OF_INDEXES;
+
+static PoolThreadCache* getPoolThreadCache()
+{
+    if( poolTlsKey == TLS_OUT_OF_INDEXES )
+    {
+        AutoLock lock(getPoolMutex());
+        if( poolTlsKey == TLS_OUT_OF_INDEXES )
+            poolTlsKey = TlsAlloc();
+        CV_Assert(poolTlsKey != TLS_OUT_OF_INDEXES);
+    }
+    PoolThreadCache* cache = (PoolThreadCache*)TlsGetValue(poolTlsKey);
+    if( !cache )
+    {
+        cache = new PoolThreadCache;
+        TlsSetValue(poolTlsKey, cache);
+    }
+    return cache;
+}
+
+void deleteThreadPoolData()
+{
+    if( poolTlsKey != TLS_OUT_OF_INDEXES )
+    {
+        delete (PoolThreadCache*)TlsGetValue(poolTlsKey);
+        TlsSetValue(poolTlsKey, 0);
+    }
+}
+#else //WIN32
+static pthread_key_t poolTlsKey;
+static pthread_once_t poolTlsKeyOnce = PTHREAD_ONCE_INIT;
+
+static void deletePoolThreadCache(void* cache)
+{
+    delete (PoolThreadCache*)cache;
+}
+
+static void makePoolTlsKey()
+{
+    pthread_key_create(&poolTlsKey, deletePoolThreadCache);
+}
+
+static PoolThreadCache* getPoolThreadCache()
+{
+    pthread_once(&poolTlsKeyOnce, makePoolTlsKey);
+    PoolThreadCache* cache = (PoolThreadCache*)pthread_getspecific(poolTlsKey);
+    if( !cache )
+    {
+        cache = new PoolThreadCache;
+        pthread_setspecific(poolTlsKey, cache);
+    }
+    return cache;
+}
+#endif //WIN32
+
+PoolMatAllocator::Stats::Stats()
+{
+    allocations = bytes = poolHits = systemAllocations = 0;
+}
+
+double PoolMatAllocator::Stats::hitRate() const
+{
+    return allocations > 0 ? (double)poolHits/allocations : 0.;
+}
+
+PoolMatAllocator::PoolMatAllocator() {}
+
+struct SharedPoolMatAllocator : public PoolMatAllocator {};
+
+PoolMatAllocator* getPoolMatAllocator()
+{
+    static SharedPoolMatAllocator allocator;
+    return &allocator;
+}
+
+void PoolMatAllocator::allocate(int dims, const int* sizes, int type, int*& refcount,
+                                uchar*& datastart, uchar*& data, size_t* step)
+{
+    size_t esz = CV_ELEM_SIZE(type), total = esz;
+    for( int i = dims-1; i >= 0; i-- )
+    {
+        step[i] = total;
+        total *= sizes[i];
+    }
+    total = alignSize(total, (int)sizeof(*refcount));
+    size_t n = POOL_HDR_SIZE + total + sizeof(*refcount);
+
+    PoolThreadCache* cache = getPoolThreadCache();
+    PoolBlockHeader* block = 0;
+    cache->stats.allocations++;
+    cache->stats.bytes += total;
+
+    PoolArena* arena = cache->arena;
+    if( arena && n <= arena->chunkSize/2 )
+    {
+        n = alignSize(n, CV_MALLOC_ALIGN);
+        PoolArenaChunk* chunk = arena->chunk;
+        bool hit = true;
+        if( !chunk || chunk->ptr + n > chunk->end )
+        {
+            if( chunk )
+                cache->releaseChunk(chunk);
+            chunk = 0;
+            size_t csize = POOL_CHUNK_HDR_SIZE + arena->chunkSize;
+            for( size_t i = 0; i < cache->spareChunks.size(); i++ )
+                if( cache->spareChunks[i]->size == csize )
+                {
+                    chunk = cache->spareChunks[i];
+                    cache->spareChunks.erase(cache->spareChunks.begin() + i);
+                    cache->cachedBytes -= csize;
+                    break;
+                }
+            if( !chunk )
+            {
+                chunk = (PoolArenaChunk*)fastMalloc(csize);
+                chunk->size = csize;
+                hit = false;
+            }
+            chunk->refcount = 1;
+            chunk->ptr = (uchar*)chunk + POOL_CHUNK_HDR_SIZE;
+            chunk->end = (uchar*)chunk + csize;
+            arena->chunk = chunk;
+        }
+        if( hit )
+            cache->stats.poolHits++;
+        else
+            cache->stats.systemAllocations++;
+        block = (PoolBlockHeader*)chunk->ptr;
+        chunk->ptr += n;
+        CV_XADD(&chunk->refcount, 1);
+        block->size = n;
+        block->chunk = chunk;
+        block->sizeClass = -1;
+    }
+    else
+    {
+        size_t csize = 0;
+        int idx = poolSizeClass(n, csize);
+        if( idx >= 0 && cache->freeLists[idx] )
+        {
+            block = cache->freeLists[idx];
+            cache->freeLists[idx] = block->next;
+            cache->cachedBytes -= block->size;
+            cache->stats.poolHits++;
+        }
+        else
+        {
+            block = (PoolBlockHeader*)fastMalloc(csize);
+            block->size = csize;
+            block->sizeClass = idx;
+            cache->stats.systemAllocations++;
+        }
+        block->chunk = 0;
+    }
+    block->next = 0;
+
+    datastart = data = (uchar*)block + POOL_HDR_SIZE;
+    refcount = (int*)(data + total);
+    *refcount = 1;
+}
+
+void PoolMatAllocator::deallocate(int* /*refcount*/, uchar* datastart, uchar* /*data*/)
+{
+    if( !datastart )
+        return;
+    PoolBlockHeader* block = (PoolBlockHeader*)(datastart - POOL_HDR_SIZE);
+    PoolThreadCache* cache = getPoolThreadCache();
+
+    if( block->chunk )
+        cache->releaseChunk(block->chunk);
+    else if( block->sizeClass >= 0 && cache->cachedBytes + block->size <= poolCacheLimit )
+    {
+        block->next = cache->freeLists[block->sizeClass];
+        cache->freeLists[block->sizeClass] = block;
+        cache->cachedBytes += block->size;
+    }
+    else
+        fastFree(block);
+}
+
+PoolMatAllocator::Stats PoolMatAllocator::getStats() const
+{
+    AutoLock lock(getPoolMutex());
+    Stats s = poolRetiredStats;
+    for( PoolThreadCache* cache = poolCaches; cache != 0; cache = cache->next )
+    {
+        s.allocations += cache->stats.allocations;
+        s.bytes += cache->stats.bytes;
+        s.poolHits += cache->stats.poolHits;
+        s.systemAllocations += cache->stats.systemAllocations;
+    }
+    return s;
+}
+
+void PoolMatAllocator::resetStats()
+{
+    AutoLock lock(getPoolMutex());
+    poolRetiredStats = Stats();
+    for( PoolThreadCache* cache = poolCaches; cache != 0; cache = cache->next )
+        cache->stats = Stats();
+}
+
+void PoolMatAllocator::setCacheLimit(size_t bytes)
+{
+    poolCacheLimit = bytes;
+}
+
+size_t PoolMatAllocator::getCacheLimit() const
+{
+    return poolCacheLimit;
+}
+
+void PoolMatAllocator::releaseCache()
+{
+    getPoolThreadCache()->release();
+}
+
+MatArenaScope::MatArenaScope(size_t chunkSize)
+{
+    PoolThreadCache* cache = getPoolThreadCache();
+    PoolArena* a = new PoolArena;
+    a->prev = cache->arena;
+    a->chunkSize = std::max(chunkSize, (size_t)1 << 16);
+    a->chunk = 0;
+    cache->arena = a;
+    arena = a;
+}
+
+MatArenaScope::~MatArenaScope()
+{
+    PoolThreadCache* cache = getPoolThreadCache();
+    PoolArena* a = (PoolArena*)arena;
+    CV_DbgAssert( cache->arena == a );
+    cache->arena = a->prev;
+    if( a->chunk )
+        cache->releaseChunk(a->chunk);
+    delete a;
+}
+
 }
 
 CV_IMPL void cvSetMemoryManager( CvAllocFunc, CvFreeFunc, void * )
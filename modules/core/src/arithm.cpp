@@ -47,6 +47,7 @@
 // */
 
 #include "precomp.hpp"
+#include "simd_avx2.hpp"
 
 namespace cv
 {
@@ -65,11 +66,14 @@ IPPArithmInitializer ippArithmInitializer;
 
 struct NOP {};
 
-template<typename T, class Op, class Op8>
+template<typename T, class Op, class Op8, class OpAVX2>
 void vBinOp8(const T* src1, size_t step1, const T* src2, size_t step2, T* dst, size_t step, Size sz)
 {
 #if CV_SSE2
     Op8 op8;
+#endif
+#ifdef HAVE_AVX2_DISPATCH
+    OpAVX2 opAVX2;
 #endif
     Op op;
 
@@ -79,6 +83,11 @@ void vBinOp8(const T* src1, size_t step1, const T* src2, size_t step2, T* dst, s
     {
         int x = 0;
 
+    #ifdef HAVE_AVX2_DISPATCH
+        if( USE_AVX2 )
+            x = opAVX2(src1, src2, dst, sz.width);
+    #endif
+
     #if CV_SSE2
         if( USE_SSE2 )
         {
@@ -115,12 +124,15 @@ void vBinOp8(const T* src1, size_t step1, const T* src2, size_t step2, T* dst, s
     }
 }
 
-template<typename T, class Op, class Op16>
+template<typename T, class Op, class Op16, class OpAVX2>
 void vBinOp16(const T* src1, size_t step1, const T* src2, size_t step2,
               T* dst, size_t step, Size sz)
 {
 #if CV_SSE2
     Op16 op16;
+#endif
+#ifdef HAVE_AVX2_DISPATCH
+    OpAVX2 opAVX2;
 #endif
     Op op;
 
@@ -130,6 +142,11 @@ void vBinOp16(const T* src1, size_t step1, const T* src2, size_t step2,
     {
         int x = 0;
 
+    #ifdef HAVE_AVX2_DISPATCH
+        if( USE_AVX2 )
+            x = opAVX2(src1, src2, dst, sz.width);
+    #endif
+
     #if CV_SSE2
         if( USE_SSE2 )
         {
@@ -168,12 +185,15 @@ void vBinOp16(const T* src1, size_t step1, const T* src2, size_t step2,
 }
 
 
-template<class Op, class Op32>
+template<class Op, class Op32, class OpAVX2>
 void vBinOp32s(const int* src1, size_t step1, const int* src2, size_t step2,
                int* dst, size_t step, Size sz)
 {
 #if CV_SSE2
     Op32 op32;
+#endif
+#ifdef HAVE_AVX2_DISPATCH
+    OpAVX2 opAVX2;
 #endif
     Op op;
 
@@ -183,6 +203,11 @@ void vBinOp32s(const int* src1, size_t step1, const int* src2, size_t step2,
     {
         int x = 0;
 
+    #ifdef HAVE_AVX2_DISPATCH
+        if( USE_AVX2 )
+            x = opAVX2(src1, src2, dst, sz.width);
+    #endif
+
 #if CV_SSE2
         if( USE_SSE2 )
         {
@@ -225,12 +250,15 @@ void vBinOp32s(const int* src1, size_t step1, const int* src2, size_t step2,
 }
 
 
-template<class Op, class Op32>
+template<class Op, class Op32, class OpAVX2>
 void vBinOp32f(const float* src1, size_t step1, const float* src2, size_t step2,
                float* dst, size_t step, Size sz)
 {
 #if CV_SSE2
     Op32 op32;
+#endif
+#ifdef HAVE_AVX2_DISPATCH
+    OpAVX2 opAVX2;
 #endif
     Op op;
 
@@ -240,6 +268,11 @@ void vBinOp32f(const float* src1, size_t step1, const float* src2, size_t step2,
     {
         int x = 0;
 
+    #ifdef HAVE_AVX2_DISPATCH
+        if( USE_AVX2 )
+            x = opAVX2(src1, src2, dst, sz.width);
+    #endif
+
     #if CV_SSE2
         if( USE_SSE2 )
         {
@@ -281,12 +314,15 @@ void vBinOp32f(const float* src1, size_t step1, const float* src2, size_t step2,
     }
 }
 
-template<class Op, class Op64>
+template<class Op, class Op64, class OpAVX2>
 void vBinOp64f(const double* src1, size_t step1, const double* src2, size_t step2,
                double* dst, size_t step, Size sz)
 {
 #if CV_SSE2
     Op64 op64;
+#endif
+#ifdef HAVE_AVX2_DISPATCH
+    OpAVX2 opAVX2;
 #endif
     Op op;
 
@@ -296,6 +332,11 @@ void vBinOp64f(const double* src1, size_t step1, const double* src2, size_t step
     {
         int x = 0;
 
+    #ifdef HAVE_AVX2_DISPATCH
+        if( USE_AVX2 )
+            x = opAVX2(src1, src2, dst, sz.width);
+    #endif
+
     #if CV_SSE2
         if( USE_SSE2 && (((size_t)src1|(size_t)src2|(size_t)dst)&15) == 0 )
             for( ; x <= sz.width - 4; x += 4 )
@@ -463,6 +504,12 @@ struct _VNot8u { __m128i operator()(const __m128i& a, const __m128i&) const { re
 #define IF_SIMD(op) NOP
 #endif
 
+#ifdef HAVE_AVX2_DISPATCH
+#define IF_AVX2(op) avx2::op
+#else
+#define IF_AVX2(op) NOP
+#endif
+
 template<> inline uchar OpAdd<uchar>::operator ()(uchar a, uchar b) const
 { return CV_FAST_CAST_8U(a + b); }
 template<> inline uchar OpSub<uchar>::operator ()(uchar a, uchar b) const
@@ -534,14 +581,14 @@ static void add8u( const uchar* src1, size_t step1,
 {
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiAdd_8u_C1RSfs(src1, (int)step1, src2, (int)step2, dst, (int)step, (IppiSize&)sz, 0),
-           (vBinOp8<uchar, OpAdd<uchar>, IF_SIMD(_VAdd8u)>(src1, step1, src2, step2, dst, step, sz)));
+           (vBinOp8<uchar, OpAdd<uchar>, IF_SIMD(_VAdd8u), IF_AVX2(VAdd8u)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 static void add8s( const schar* src1, size_t step1,
                    const schar* src2, size_t step2,
                    schar* dst, size_t step, Size sz, void* )
 {
-    vBinOp8<schar, OpAdd<schar>, IF_SIMD(_VAdd8s)>(src1, step1, src2, step2, dst, step, sz);
+    vBinOp8<schar, OpAdd<schar>, IF_SIMD(_VAdd8s), IF_AVX2(VAdd8s)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 static void add16u( const ushort* src1, size_t step1,
@@ -550,7 +597,7 @@ static void add16u( const ushort* src1, size_t step1,
 {
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiAdd_16u_C1RSfs(src1, (int)step1, src2, (int)step2, dst, (int)step, (IppiSize&)sz, 0),
-            (vBinOp16<ushort, OpAdd<ushort>, IF_SIMD(_VAdd16u)>(src1, step1, src2, step2, dst, step, sz)));
+            (vBinOp16<ushort, OpAdd<ushort>, IF_SIMD(_VAdd16u), IF_AVX2(VAdd16u)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 static void add16s( const short* src1, size_t step1,
@@ -559,14 +606,14 @@ static void add16s( const short* src1, size_t step1,
 {
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiAdd_16s_C1RSfs(src1, (int)step1, src2, (int)step2, dst, (int)step, (IppiSize&)sz, 0),
-           (vBinOp16<short, OpAdd<short>, IF_SIMD(_VAdd16s)>(src1, step1, src2, step2, dst, step, sz)));
+           (vBinOp16<short, OpAdd<short>, IF_SIMD(_VAdd16s), IF_AVX2(VAdd16s)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 static void add32s( const int* src1, size_t step1,
                     const int* src2, size_t step2,
                     int* dst, size_t step, Size sz, void* )
 {
-    vBinOp32s<OpAdd<int>, IF_SIMD(_VAdd32s)>(src1, step1, src2, step2, dst, step, sz);
+    vBinOp32s<OpAdd<int>, IF_SIMD(_VAdd32s), IF_AVX2(VAdd32s)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 static void add32f( const float* src1, size_t step1,
@@ -575,14 +622,14 @@ static void add32f( const float* src1, size_t step1,
 {
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiAdd_32f_C1R(src1, (int)step1, src2, (int)step2, dst, (int)step, (IppiSize&)sz),
-           (vBinOp32f<OpAdd<float>, IF_SIMD(_VAdd32f)>(src1, step1, src2, step2, dst, step, sz)));
+           (vBinOp32f<OpAdd<float>, IF_SIMD(_VAdd32f), IF_AVX2(VAdd32f)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 static void add64f( const double* src1, size_t step1,
                     const double* src2, size_t step2,
                     double* dst, size_t step, Size sz, void* )
 {
-    vBinOp64f<OpAdd<double>, IF_SIMD(_VAdd64f)>(src1, step1, src2, step2, dst, step, sz);
+    vBinOp64f<OpAdd<double>, IF_SIMD(_VAdd64f), IF_AVX2(VAdd64f)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 static void sub8u( const uchar* src1, size_t step1,
@@ -591,14 +638,14 @@ static void sub8u( const uchar* src1, size_t step1,
 {
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiSub_8u_C1RSfs(src2, (int)step2, src1, (int)step1, dst, (int)step, (IppiSize&)sz, 0),
-           (vBinOp8<uchar, OpSub<uchar>, IF_SIMD(_VSub8u)>(src1, step1, src2, step2, dst, step, sz)));
+           (vBinOp8<uchar, OpSub<uchar>, IF_SIMD(_VSub8u), IF_AVX2(VSub8u)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 static void sub8s( const schar* src1, size_t step1,
                    const schar* src2, size_t step2,
                    schar* dst, size_t step, Size sz, void* )
 {
-    vBinOp8<schar, OpSub<schar>, IF_SIMD(_VSub8s)>(src1, step1, src2, step2, dst, step, sz);
+    vBinOp8<schar, OpSub<schar>, IF_SIMD(_VSub8s), IF_AVX2(VSub8s)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 static void sub16u( const ushort* src1, size_t step1,
@@ -607,7 +654,7 @@ static void sub16u( const ushort* src1, size_t step1,
 {
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiSub_16u_C1RSfs(src2, (int)step2, src1, (int)step1, dst, (int)step, (IppiSize&)sz, 0),
-           (vBinOp16<ushort, OpSub<ushort>, IF_SIMD(_VSub16u)>(src1, step1, src2, step2, dst, step, sz)));
+           (vBinOp16<ushort, OpSub<ushort>, IF_SIMD(_VSub16u), IF_AVX2(VSub16u)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 static void sub16s( const short* src1, size_t step1,
@@ -616,14 +663,14 @@ static void sub16s( const short* src1, size_t step1,
 {
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiSub_16s_C1RSfs(src2, (int)step2, src1, (int)step1, dst, (int)step, (IppiSize&)sz, 0),
-           (vBinOp16<short, OpSub<short>, IF_SIMD(_VSub16s)>(src1, step1, src2, step2, dst, step, sz)));
+           (vBinOp16<short, OpSub<short>, IF_SIMD(_VSub16s), IF_AVX2(VSub16s)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 static void sub32s( const int* src1, size_t step1,
                     const int* src2, size_t step2,
                     int* dst, size_t step, Size sz, void* )
 {
-    vBinOp32s<OpSub<int>, IF_SIMD(_VSub32s)>(src1, step1, src2, step2, dst, step, sz);
+    vBinOp32s<OpSub<int>, IF_SIMD(_VSub32s), IF_AVX2(VSub32s)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 static void sub32f( const float* src1, size_t step1,
@@ -632,14 +679,14 @@ static void sub32f( const float* src1, size_t step1,
 {
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiSub_32f_C1R(src2, (int)step2, src1, (int)step1, dst, (int)step, (IppiSize&)sz),
-           (vBinOp32f<OpSub<float>, IF_SIMD(_VSub32f)>(src1, step1, src2, step2, dst, step, sz)));
+           (vBinOp32f<OpSub<float>, IF_SIMD(_VSub32f), IF_AVX2(VSub32f)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 static void sub64f( const double* src1, size_t step1,
                     const double* src2, size_t step2,
                     double* dst, size_t step, Size sz, void* )
 {
-    vBinOp64f<OpSub<double>, IF_SIMD(_VSub64f)>(src1, step1, src2, step2, dst, step, sz);
+    vBinOp64f<OpSub<double>, IF_SIMD(_VSub64f), IF_AVX2(VSub64f)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 template<> inline uchar OpMin<uchar>::operator ()(uchar a, uchar b) const { return CV_MIN_8U(a, b); }
@@ -664,7 +711,7 @@ static void max8u( const uchar* src1, size_t step1,
     }
   }
 #else
-  vBinOp8<uchar, OpMax<uchar>, IF_SIMD(_VMax8u)>(src1, step1, src2, step2, dst, step, sz);
+  vBinOp8<uchar, OpMax<uchar>, IF_SIMD(_VMax8u), IF_AVX2(VMax8u)>(src1, step1, src2, step2, dst, step, sz);
 #endif
 
 //    IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
@@ -676,7 +723,7 @@ static void max8s( const schar* src1, size_t step1,
                    const schar* src2, size_t step2,
                    schar* dst, size_t step, Size sz, void* )
 {
-    vBinOp8<schar, OpMax<schar>, IF_SIMD(_VMax8s)>(src1, step1, src2, step2, dst, step, sz);
+    vBinOp8<schar, OpMax<schar>, IF_SIMD(_VMax8s), IF_AVX2(VMax8s)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 static void max16u( const ushort* src1, size_t step1,
@@ -698,7 +745,7 @@ static void max16u( const ushort* src1, size_t step1,
     }
   }
 #else
-  vBinOp16<ushort, OpMax<ushort>, IF_SIMD(_VMax16u)>(src1, step1, src2, step2, dst, step, sz);
+  vBinOp16<ushort, OpMax<ushort>, IF_SIMD(_VMax16u), IF_AVX2(VMax16u)>(src1, step1, src2, step2, dst, step, sz);
 #endif
 
 //    IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
@@ -710,14 +757,14 @@ static void max16s( const short* src1, size_t step1,
                     const short* src2, size_t step2,
                     short* dst, size_t step, Size sz, void* )
 {
-    vBinOp16<short, OpMax<short>, IF_SIMD(_VMax16s)>(src1, step1, src2, step2, dst, step, sz);
+    vBinOp16<short, OpMax<short>, IF_SIMD(_VMax16s), IF_AVX2(VMax16s)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 static void max32s( const int* src1, size_t step1,
                     const int* src2, size_t step2,
                     int* dst, size_t step, Size sz, void* )
 {
-    vBinOp32s<OpMax<int>, IF_SIMD(_VMax32s)>(src1, step1, src2, step2, dst, step, sz);
+    vBinOp32s<OpMax<int>, IF_SIMD(_VMax32s), IF_AVX2(VMax32s)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 static void max32f( const float* src1, size_t step1,
@@ -739,7 +786,7 @@ static void max32f( const float* src1, size_t step1,
     }
   }
 #else
-  vBinOp32f<OpMax<float>, IF_SIMD(_VMax32f)>(src1, step1, src2, step2, dst, step, sz);
+  vBinOp32f<OpMax<float>, IF_SIMD(_VMax32f), IF_AVX2(VMax32f)>(src1, step1, src2, step2, dst, step, sz);
 #endif
 //    IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
 //           ippiMaxEvery_32f_C1R(src1, (int)step1, src2, (int)step2, dst, (IppiSize&)sz),
@@ -750,7 +797,7 @@ static void max64f( const double* src1, size_t step1,
                     const double* src2, size_t step2,
                     double* dst, size_t step, Size sz, void* )
 {
-    vBinOp64f<OpMax<double>, IF_SIMD(_VMax64f)>(src1, step1, src2, step2, dst, step, sz);
+    vBinOp64f<OpMax<double>, IF_SIMD(_VMax64f), IF_AVX2(VMax64f)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 static void min8u( const uchar* src1, size_t step1,
@@ -772,7 +819,7 @@ static void min8u( const uchar* src1, size_t step1,
     }
   }
 #else
-  vBinOp8<uchar, OpMin<uchar>, IF_SIMD(_VMin8u)>(src1, step1, src2, step2, dst, step, sz);
+  vBinOp8<uchar, OpMin<uchar>, IF_SIMD(_VMin8u), IF_AVX2(VMin8u)>(src1, step1, src2, step2, dst, step, sz);
 #endif
 
 //    IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
@@ -784,7 +831,7 @@ static void min8s( const schar* src1, size_t step1,
                    const schar* src2, size_t step2,
                    schar* dst, size_t step, Size sz, void* )
 {
-    vBinOp8<schar, OpMin<schar>, IF_SIMD(_VMin8s)>(src1, step1, src2, step2, dst, step, sz);
+    vBinOp8<schar, OpMin<schar>, IF_SIMD(_VMin8s), IF_AVX2(VMin8s)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 static void min16u( const ushort* src1, size_t step1,
@@ -806,7 +853,7 @@ static void min16u( const ushort* src1, size_t step1,
     }
   }
 #else
-  vBinOp16<ushort, OpMin<ushort>, IF_SIMD(_VMin16u)>(src1, step1, src2, step2, dst, step, sz);
+  vBinOp16<ushort, OpMin<ushort>, IF_SIMD(_VMin16u), IF_AVX2(VMin16u)>(src1, step1, src2, step2, dst, step, sz);
 #endif
 
 //    IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
@@ -818,14 +865,14 @@ static void min16s( const short* src1, size_t step1,
                     const short* src2, size_t step2,
                     short* dst, size_t step, Size sz, void* )
 {
-    vBinOp16<short, OpMin<short>, IF_SIMD(_VMin16s)>(src1, step1, src2, step2, dst, step, sz);
+    vBinOp16<short, OpMin<short>, IF_SIMD(_VMin16s), IF_AVX2(VMin16s)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 static void min32s( const int* src1, size_t step1,
                     const int* src2, size_t step2,
                     int* dst, size_t step, Size sz, void* )
 {
-    vBinOp32s<OpMin<int>, IF_SIMD(_VMin32s)>(src1, step1, src2, step2, dst, step, sz);
+    vBinOp32s<OpMin<int>, IF_SIMD(_VMin32s), IF_AVX2(VMin32s)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 static void min32f( const float* src1, size_t step1,
@@ -847,7 +894,7 @@ static void min32f( const float* src1, size_t step1,
     }
   }
 #else
-  vBinOp32f<OpMin<float>, IF_SIMD(_VMin32f)>(src1, step1, src2, step2, dst, step, sz);
+  vBinOp32f<OpMin<float>, IF_SIMD(_VMin32f), IF_AVX2(VMin32f)>(src1, step1, src2, step2, dst, step, sz);
 #endif
 //    IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
 //           ippiMinEvery_32f_C1R(src1, (int)step1, src2, (int)step2, dst, (IppiSize&)sz),
@@ -858,7 +905,7 @@ static void min64f( const double* src1, size_t step1,
                     const double* src2, size_t step2,
                     double* dst, size_t step, Size sz, void* )
 {
-    vBinOp64f<OpMin<double>, IF_SIMD(_VMin64f)>(src1, step1, src2, step2, dst, step, sz);
+    vBinOp64f<OpMin<double>, IF_SIMD(_VMin64f), IF_AVX2(VMin64f)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 static void absdiff8u( const uchar* src1, size_t step1,
@@ -867,14 +914,14 @@ static void absdiff8u( const uchar* src1, size_t step1,
 {
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiAbsDiff_8u_C1R(src1, (int)step1, src2, (int)step2, dst, (int)step, (IppiSize&)sz),
-           (vBinOp8<uchar, OpAbsDiff<uchar>, IF_SIMD(_VAbsDiff8u)>(src1, step1, src2, step2, dst, step, sz)));
+           (vBinOp8<uchar, OpAbsDiff<uchar>, IF_SIMD(_VAbsDiff8u), IF_AVX2(VAbsDiff8u)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 static void absdiff8s( const schar* src1, size_t step1,
                        const schar* src2, size_t step2,
                        schar* dst, size_t step, Size sz, void* )
 {
-    vBinOp8<schar, OpAbsDiff<schar>, IF_SIMD(_VAbsDiff8s)>(src1, step1, src2, step2, dst, step, sz);
+    vBinOp8<schar, OpAbsDiff<schar>, IF_SIMD(_VAbsDiff8s), IF_AVX2(VAbsDiff8s)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 static void absdiff16u( const ushort* src1, size_t step1,
@@ -883,21 +930,21 @@ static void absdiff16u( const ushort* src1, size_t step1,
 {
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiAbsDiff_16u_C1R(src1, (int)step1, src2, (int)step2, dst, (int)step, (IppiSize&)sz),
-           (vBinOp16<ushort, OpAbsDiff<ushort>, IF_SIMD(_VAbsDiff16u)>(src1, step1, src2, step2, dst, step, sz)));
+           (vBinOp16<ushort, OpAbsDiff<ushort>, IF_SIMD(_VAbsDiff16u), IF_AVX2(VAbsDiff16u)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 static void absdiff16s( const short* src1, size_t step1,
                         const short* src2, size_t step2,
                         short* dst, size_t step, Size sz, void* )
 {
-    vBinOp16<short, OpAbsDiff<short>, IF_SIMD(_VAbsDiff16s)>(src1, step1, src2, step2, dst, step, sz);
+    vBinOp16<short, OpAbsDiff<short>, IF_SIMD(_VAbsDiff16s), IF_AVX2(VAbsDiff16s)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 static void absdiff32s( const int* src1, size_t step1,
                         const int* src2, size_t step2,
                         int* dst, size_t step, Size sz, void* )
 {
-    vBinOp32s<OpAbsDiff<int>, IF_SIMD(_VAbsDiff32s)>(src1, step1, src2, step2, dst, step, sz);
+    vBinOp32s<OpAbsDiff<int>, IF_SIMD(_VAbsDiff32s), IF_AVX2(VAbsDiff32s)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 static void absdiff32f( const float* src1, size_t step1,
@@ -906,14 +953,14 @@ static void absdiff32f( const float* src1, size_t step1,
 {
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiAbsDiff_32f_C1R(src1, (int)step1, src2, (int)step2, dst, (int)step, (IppiSize&)sz),
-           (vBinOp32f<OpAbsDiff<float>, IF_SIMD(_VAbsDiff32f)>(src1, step1, src2, step2, dst, step, sz)));
+           (vBinOp32f<OpAbsDiff<float>, IF_SIMD(_VAbsDiff32f), IF_AVX2(VAbsDiff32f)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 static void absdiff64f( const double* src1, size_t step1,
                         const double* src2, size_t step2,
                         double* dst, size_t step, Size sz, void* )
 {
-    vBinOp64f<OpAbsDiff<double>, IF_SIMD(_VAbsDiff64f)>(src1, step1, src2, step2, dst, step, sz);
+    vBinOp64f<OpAbsDiff<double>, IF_SIMD(_VAbsDiff64f), IF_AVX2(VAbsDiff64f)>(src1, step1, src2, step2, dst, step, sz);
 }
 
 
@@ -923,7 +970,7 @@ static void and8u( const uchar* src1, size_t step1,
 {
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiAnd_8u_C1R(src1, (int)step1, src2, (int)step2, dst, (int)step, (IppiSize&)sz),
-           (vBinOp8<uchar, OpAnd<uchar>, IF_SIMD(_VAnd8u)>(src1, step1, src2, step2, dst, step, sz)));
+           (vBinOp8<uchar, OpAnd<uchar>, IF_SIMD(_VAnd8u), IF_AVX2(VAnd8u)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 static void or8u( const uchar* src1, size_t step1,
@@ -932,7 +979,7 @@ static void or8u( const uchar* src1, size_t step1,
 {
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiOr_8u_C1R(src1, (int)step1, src2, (int)step2, dst, (int)step, (IppiSize&)sz),
-           (vBinOp8<uchar, OpOr<uchar>, IF_SIMD(_VOr8u)>(src1, step1, src2, step2, dst, step, sz)));
+           (vBinOp8<uchar, OpOr<uchar>, IF_SIMD(_VOr8u), IF_AVX2(VOr8u)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 static void xor8u( const uchar* src1, size_t step1,
@@ -941,7 +988,7 @@ static void xor8u( const uchar* src1, size_t step1,
 {
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiXor_8u_C1R(src1, (int)step1, src2, (int)step2, dst, (int)step, (IppiSize&)sz),
-           (vBinOp8<uchar, OpXor<uchar>, IF_SIMD(_VXor8u)>(src1, step1, src2, step2, dst, step, sz)));
+           (vBinOp8<uchar, OpXor<uchar>, IF_SIMD(_VXor8u), IF_AVX2(VXor8u)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 static void not8u( const uchar* src1, size_t step1,
@@ -950,7 +997,7 @@ static void not8u( const uchar* src1, size_t step1,
 {
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiNot_8u_C1R(src1, (int)step1, dst, (int)step, (IppiSize&)sz),
-           (vBinOp8<uchar, OpNot<uchar>, IF_SIMD(_VNot8u)>(src1, step1, src2, step2, dst, step, sz)));
+           (vBinOp8<uchar, OpNot<uchar>, IF_SIMD(_VNot8u), IF_AVX2(VNot8u)>(src1, step1, src2, step2, dst, step, sz)));
 }
 
 /****************************************************************************************\
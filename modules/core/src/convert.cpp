@@ -41,6 +41,7 @@
 //M*/
 
 #include "precomp.hpp"
+#include "simd_avx2.hpp"
 
 namespace cv
 {
@@ -561,6 +562,51 @@ void cv::insertChannel(InputArray _src, InputOutputArray _dst, int coi)
 namespace cv
 {
 
+#ifdef HAVE_AVX2_DISPATCH
+
+// maps the conversion kernels to their AVX2 versions; the pairs without one process nothing
+template<typename T, typename DT> struct CvtAVX2
+{
+    int operator()(const T*, DT*, int) const { return 0; }
+};
+
+template<typename T, typename DT, typename WT> struct CvtScaleAVX2
+{
+    int operator()(const T*, DT*, int, WT, WT) const { return 0; }
+};
+
+#define DEF_CVT_AVX2(stype, dtype, func) \
+template<> struct CvtAVX2<stype, dtype> \
+{ \
+    int operator()(const stype* src, dtype* dst, int len) const \
+    { return avx2::func(src, dst, len); } \
+}
+
+#define DEF_CVT_SCALE_AVX2(stype, dtype, func) \
+template<> struct CvtScaleAVX2<stype, dtype, float> \
+{ \
+    int operator()(const stype* src, dtype* dst, int len, float scale, float shift) const \
+    { return avx2::func(src, dst, len, scale, shift); } \
+}
+
+DEF_CVT_AVX2(uchar, float, cvt8u32f);
+DEF_CVT_AVX2(ushort, float, cvt16u32f);
+DEF_CVT_AVX2(short, float, cvt16s32f);
+DEF_CVT_AVX2(int, float, cvt32s32f);
+DEF_CVT_AVX2(float, uchar, cvt32f8u);
+DEF_CVT_AVX2(float, ushort, cvt32f16u);
+DEF_CVT_AVX2(float, int, cvt32f32s);
+
+DEF_CVT_SCALE_AVX2(uchar, uchar, cvtScale8u);
+DEF_CVT_SCALE_AVX2(uchar, float, cvtScale8u32f);
+DEF_CVT_SCALE_AVX2(ushort, float, cvtScale16u32f);
+DEF_CVT_SCALE_AVX2(short, float, cvtScale16s32f);
+DEF_CVT_SCALE_AVX2(float, float, cvtScale32f);
+DEF_CVT_SCALE_AVX2(float, uchar, cvtScale32f8u);
+DEF_CVT_SCALE_AVX2(float, short, cvtScale32f16s);
+
+#endif
+
 template<typename T, typename DT, typename WT> static void
 cvtScaleAbs_( const T* src, size_t sstep,
               DT* dst, size_t dstep, Size size,
@@ -601,6 +647,10 @@ cvtScale_( const T* src, size_t sstep,
     for( ; size.height--; src += sstep, dst += dstep )
     {
         int x = 0;
+        #ifdef HAVE_AVX2_DISPATCH
+        if( USE_AVX2 )
+            x = CvtScaleAVX2<T, DT, WT>()(src, dst, size.width, scale, shift);
+        #endif
         #if CV_ENABLE_UNROLLED
         for( ; x <= size.width - 4; x += 4 )
         {
@@ -631,6 +681,10 @@ cvtScale_<short, short, float>( const short* src, size_t sstep,
     for( ; size.height--; src += sstep, dst += dstep )
     {
         int x = 0;
+        #ifdef HAVE_AVX2_DISPATCH
+            if(USE_AVX2)
+                x = avx2::cvtScale16s(src, dst, size.width, scale, shift);
+        #endif
         #if CV_SSE2
             if(USE_SSE2)
             {
@@ -724,6 +778,10 @@ cvt_( const T* src, size_t sstep,
     for( ; size.height--; src += sstep, dst += dstep )
     {
         int x = 0;
+        #ifdef HAVE_AVX2_DISPATCH
+        if( USE_AVX2 )
+            x = CvtAVX2<T, DT>()(src, dst, size.width);
+        #endif
         #if CV_ENABLE_UNROLLED
         for( ; x <= size.width - 4; x += 4 )
         {
@@ -752,6 +810,10 @@ cvt_<float, short>( const float* src, size_t sstep,
     for( ; size.height--; src += sstep, dst += dstep )
     {
         int x = 0;
+        #ifdef HAVE_AVX2_DISPATCH
+        if(USE_AVX2)
+            x = avx2::cvt32f16s(src, dst, size.width);
+        #endif
         #if   CV_SSE2
         if(USE_SSE2){
               for( ; x <= size.width - 8; x += 8 )
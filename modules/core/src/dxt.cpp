@@ -367,7 +367,36 @@ template<typename T> struct DFT_VecR4
     int operator()(Complex<T>*, int, int, int&, const Complex<T>*) const { return 1; }
 };
 
+#if CV_SSE2
+
+// SSE3 instructions used by the radix-4 butterflies, emulated with SSE2 when SSE3 is not available
+static inline __m128 _dft_moveldup_ps( __m128 x )
+{
+#if CV_SSE3
+    return _mm_moveldup_ps(x);
+#else
+    return _mm_shuffle_ps(x, x, _MM_SHUFFLE(2,2,0,0));
+#endif
+}
+
+static inline __m128 _dft_movehdup_ps( __m128 x )
+{
+#if CV_SSE3
+    return _mm_movehdup_ps(x);
+#else
+    return _mm_shuffle_ps(x, x, _MM_SHUFFLE(3,3,1,1));
+#endif
+}
+
+static inline __m128 _dft_addsub_ps( __m128 a, __m128 b )
+{
 #if CV_SSE3
+    return _mm_addsub_ps(a, b);
+#else
+    const __m128i neg02_mask = _mm_set_epi32(0, (int)0x80000000, 0, (int)0x80000000);
+    return _mm_add_ps(a, _mm_xor_ps(b, _mm_castsi128_ps(neg02_mask)));
+#endif
+}
 
 // optimized radix-4 transform
 template<> struct DFT_VecR4<float>
@@ -420,16 +449,16 @@ template<> struct DFT_VecR4<float>
                     x13 = _mm_loadh_pi(x13, (const __m64*)&v1[nx]); // x1, x3 = r1 i1 r3 i3
                     w23 = _mm_loadh_pi(w23, (const __m64*)&wave[dw*3]); // w2, w3 = wr2 wi2 wr3 wi3
                     
-                    t0 = _mm_mul_ps(_mm_moveldup_ps(x13), w23);
-                    t1 = _mm_mul_ps(_mm_movehdup_ps(x13), _mm_shuffle_ps(w23, w23, _MM_SHUFFLE(2,3,0,1)));
-                    x13 = _mm_addsub_ps(t0, t1);
+                    t0 = _mm_mul_ps(_dft_moveldup_ps(x13), w23);
+                    t1 = _mm_mul_ps(_dft_movehdup_ps(x13), _mm_shuffle_ps(w23, w23, _MM_SHUFFLE(2,3,0,1)));
+                    x13 = _dft_addsub_ps(t0, t1);
                     // re(x1*w2), im(x1*w2), re(x3*w3), im(x3*w3)
                     x02 = _mm_loadl_pi(x02, (const __m64*)&v1[0]); // x2 = r2 i2
                     w01 = _mm_loadl_pi(w01, (const __m64*)&wave[dw]); // w1 = wr1 wi1
                     x02 = _mm_shuffle_ps(x02, x02, _MM_SHUFFLE(0,0,1,1));
                     w01 = _mm_shuffle_ps(w01, w01, _MM_SHUFFLE(1,0,0,1));
                     x02 = _mm_mul_ps(x02, w01);
-                    x02 = _mm_addsub_ps(x02, _mm_movelh_ps(x02, x02));
+                    x02 = _dft_addsub_ps(x02, _mm_movelh_ps(x02, x02));
                     // re(x0) im(x0) re(x2*w1), im(x2*w1)
                     x02 = _mm_loadl_pi(x02, (const __m64*)&v0[0]);
                     
@@ -453,6 +482,62 @@ template<> struct DFT_VecR4<float>
     }
 };
 
+// a*w for the complex numbers stored as (re, im)
+static inline __m128d _dft_cmul_pd( __m128d a, __m128d w, __m128d neg0_mask )
+{
+    __m128d t0 = _mm_mul_pd(a, _mm_unpacklo_pd(w, w));
+    __m128d t1 = _mm_mul_pd(_mm_shuffle_pd(a, a, 1), _mm_unpackhi_pd(w, w));
+    return _mm_add_pd(t0, _mm_xor_pd(t1, neg0_mask));
+}
+
+// optimized radix-4 transform, one complex number per register
+template<> struct DFT_VecR4<double>
+{
+    int operator()(Complex<double>* dst, int N, int n0, int& _dw0, const Complex<double>* wave) const
+    {
+        int n = 1, i, j, nx, dw, dw0 = _dw0;
+        __m128d neg0_mask = _mm_set_pd(0., -0.), neg1_mask = _mm_set_pd(-0., 0.);
+
+        for( ; n*4 <= N; )
+        {
+            nx = n;
+            n *= 4;
+            dw0 /= 4;
+
+            for( i = 0; i < n0; i += n )
+            {
+                double *v0 = (double*)(dst + i), *v1 = v0 + nx*4;
+                const double* w = (const double*)wave;
+
+                for( j = 0, dw = 0; j < nx; j++, dw += dw0, v0 += 2, v1 += 2 )
+                {
+                    __m128d x0 = _mm_loadu_pd(v0), x1 = _mm_loadu_pd(v0 + nx*2);
+                    __m128d x2 = _mm_loadu_pd(v1), x3 = _mm_loadu_pd(v1 + nx*2);
+                    if( j > 0 )
+                    {
+                        x1 = _dft_cmul_pd(x1, _mm_loadu_pd(w + dw*4), neg0_mask);
+                        x2 = _dft_cmul_pd(x2, _mm_loadu_pd(w + dw*2), neg0_mask);
+                        x3 = _dft_cmul_pd(x3, _mm_loadu_pd(w + dw*6), neg0_mask);
+                    }
+
+                    // s0 +/- s1 and d0 +/- (-i)*d1
+                    __m128d s0 = _mm_add_pd(x0, x1), d0 = _mm_sub_pd(x0, x1);
+                    __m128d s1 = _mm_add_pd(x2, x3), d1 = _mm_sub_pd(x2, x3);
+                    d1 = _mm_xor_pd(_mm_shuffle_pd(d1, d1, 1), neg1_mask);
+
+                    _mm_storeu_pd(v0, _mm_add_pd(s0, s1));
+                    _mm_storeu_pd(v1, _mm_sub_pd(s0, s1));
+                    _mm_storeu_pd(v0 + nx*2, _mm_add_pd(d0, d1));
+                    _mm_storeu_pd(v1 + nx*2, _mm_sub_pd(d0, d1));
+                }
+            }
+        }
+
+        _dw0 = dw0;
+        return n;
+    }
+};
+
 #endif
 
 #ifdef HAVE_IPP
@@ -642,7 +727,7 @@ DFT( const Complex<T>* src, Complex<T>* dst, int n,
     // 1. power-2 transforms
     if( (factors[0] & 1) == 0 )
     {
-        if( factors[0] >= 4 && checkHardwareSupport(CV_CPU_SSE3))
+        if( factors[0] >= 4 && checkHardwareSupport(CV_SSE3 ? CV_CPU_SSE3 : CV_CPU_SSE2) )
         {
             DFT_VecR4<T> vr4;
             n = vr4(dst, factors[0], n0, dw0, wave);
@@ -1449,7 +1534,224 @@ static void CCSIDFT_64f( const double* src, double* dst, int n, int nf, int* fac
 {
     CCSIDFT( src, dst, n, nf, factors, itab, wave, tab_size, spec, buf, flags, scale);
 }
-    
+
+/*
+   The factorization, the permutation table and the twiddle factors of 1D DFT
+   (and, for DCT, the DCT twiddle factors) of the particular length.
+   The plans are computed once and shared by all the dft() and dct() calls
+   via the process-wide cache, so the per-call initialization is gone.
+*/
+struct DFTPlan
+{
+    DFTPlan( int _n, int _complex_elem_size, int _inv_itab, bool _dct );
+    size_t memSize() const { return (itab.size() + 2*(wave.size() + dct_wave.size()))*sizeof(int); }
+
+    int n, complex_elem_size, inv_itab;
+    bool dct;
+    int nf;
+    int factors[34];
+    vector<int> itab;
+    // Complex<float> or Complex<double> elements
+    vector<double> wave, dct_wave;
+};
+
+static void DCTInit( int n, int elem_size, void* _wave, int inv );
+
+DFTPlan::DFTPlan( int _n, int _complex_elem_size, int _inv_itab, bool _dct )
+    : n(_n), complex_elem_size(_complex_elem_size), inv_itab(_inv_itab), dct(_dct)
+{
+    nf = DFTFactorize( n, factors );
+    itab.resize(n);
+    wave.resize(n*complex_elem_size/sizeof(double) + 1);
+    DFTInit( n, nf, factors, &itab[0], complex_elem_size, &wave[0], inv_itab );
+    if( dct )
+    {
+        dct_wave.resize((n/2 + 1)*complex_elem_size/sizeof(double) + 1);
+        DCTInit( n, complex_elem_size, &dct_wave[0], inv_itab );
+    }
+}
+
+enum { DFT_PLAN_CACHE_SIZE = 1 << 24, DFT_PARALLEL_MIN = 1 << 15 };
+
+static Mutex& getDFTPlanMutex()
+{
+    static Mutex m;
+    return m;
+}
+
+// returns the plan from the cache or creates a new one; the least recently used
+// plans are evicted when the total size of the cached tables exceeds DFT_PLAN_CACHE_SIZE
+static Ptr<DFTPlan> getDFTPlan( int n, int complex_elem_size, int inv_itab, bool dct )
+{
+    static vector<Ptr<DFTPlan> > plans;
+    static size_t plansSize = 0;
+
+    AutoLock lock(getDFTPlanMutex());
+    for( size_t i = plans.size(); i-- > 0; )
+    {
+        const DFTPlan& p = *plans[i];
+        if( p.n == n && p.complex_elem_size == complex_elem_size &&
+            p.inv_itab == inv_itab && p.dct == dct )
+        {
+            Ptr<DFTPlan> plan = plans[i];
+            plans.erase(plans.begin() + i);
+            plans.push_back(plan);
+            return plan;
+        }
+    }
+
+    Ptr<DFTPlan> plan = new DFTPlan(n, complex_elem_size, inv_itab, dct);
+    size_t sz = plan->memSize();
+    if( sz <= (size_t)DFT_PLAN_CACHE_SIZE )
+    {
+        while( plansSize + sz > (size_t)DFT_PLAN_CACHE_SIZE )
+        {
+            plansSize -= plans[0]->memSize();
+            plans.erase(plans.begin());
+        }
+        plans.push_back(plan);
+        plansSize += sz;
+    }
+    return plan;
+}
+
+static void parallelDFT( const ParallelLoopBody& body, int count, int len )
+{
+    double total = (double)count*len;
+    if( count > 1 && total >= DFT_PARALLEL_MIN )
+        parallel_for_(Range(0, count), body, total/DFT_PARALLEL_MIN);
+    else
+        body(Range(0, count));
+}
+
+// the row-wise 1D transforms; each thread uses its own buffer
+class DFTRowsInvoker : public ParallelLoopBody
+{
+public:
+    DFTRowsInvoker( const Mat& _src, Mat& _dst, DFTFunc _func, int _len, int _nf, const int* _factors,
+                    const int* _itab, const uchar* _wave, const void* _spec, int _flags, double _scale,
+                    int _complex_elem_size, bool _use_buf, int _dptr_offset, int _dst_full_len, int _buf_size )
+        : src(&_src), dst(&_dst), func(_func), len(_len), nf(_nf), factors(_factors), itab(_itab),
+          wave(_wave), spec(_spec), flags(_flags), scale(_scale), complex_elem_size(_complex_elem_size),
+          use_buf(_use_buf), dptr_offset(_dptr_offset), dst_full_len(_dst_full_len), buf_size(_buf_size) {}
+
+    void operator()( const Range& range ) const
+    {
+        AutoBuffer<uchar> _buf(buf_size + 32);
+        uchar* ptr = alignPtr((uchar*)_buf, 16);
+        uchar* tmp_buf = 0;
+        int _factors[34];
+
+        // the transforms temporarily modify the factors
+        memcpy( _factors, factors, sizeof(_factors) );
+        if( use_buf )
+        {
+            tmp_buf = ptr;
+            ptr += len*complex_elem_size;
+        }
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            const uchar* sptr = src->data + i*src->step;
+            uchar* dptr0 = dst->data + i*dst->step;
+            uchar* dptr = tmp_buf ? tmp_buf : dptr0;
+
+            func( sptr, dptr, len, nf, _factors, itab, wave, len, spec, ptr, flags, scale );
+            if( dptr != dptr0 )
+                memcpy( dptr0, dptr + dptr_offset, dst_full_len );
+        }
+    }
+
+protected:
+    const Mat* src;
+    Mat* dst;
+    DFTFunc func;
+    int len, nf;
+    const int *factors, *itab;
+    const uchar* wave;
+    const void* spec;
+    int flags;
+    double scale;
+    int complex_elem_size;
+    bool use_buf;
+    int dptr_offset, dst_full_len, buf_size;
+};
+
+// the column-wise 1D transforms of the complex data, two columns at once;
+// the i-th range element corresponds to the columns (a + i*2) and (a + i*2 + 1)
+class DFTColumnsInvoker : public ParallelLoopBody
+{
+public:
+    DFTColumnsInvoker( const uchar* _sptr0, size_t _sstep, uchar* _dptr0, size_t _dstep,
+                       int _a, int _b, DFTFunc _func, int _len, int _nf, const int* _factors,
+                       const int* _itab, const uchar* _wave, const void* _spec, int _inv, double _scale,
+                       int _complex_elem_size, bool _use_buf, int _buf_size )
+        : sptr0(_sptr0), sstep(_sstep), dptr0(_dptr0), dstep(_dstep), a(_a), b(_b), func(_func),
+          len(_len), nf(_nf), factors(_factors), itab(_itab), wave(_wave), spec(_spec), inv(_inv),
+          scale(_scale), complex_elem_size(_complex_elem_size), use_buf(_use_buf), buf_size(_buf_size) {}
+
+    void operator()( const Range& range ) const
+    {
+        AutoBuffer<uchar> _buf(buf_size + 32);
+        uchar* ptr = alignPtr((uchar*)_buf, 16);
+        uchar *buf0, *buf1, *dbuf0, *dbuf1;
+        int _factors[34];
+
+        memcpy( _factors, factors, sizeof(_factors) );
+        buf0 = ptr;
+        ptr += len*complex_elem_size;
+        buf1 = ptr;
+        ptr += len*complex_elem_size;
+        dbuf0 = buf0, dbuf1 = buf1;
+
+        if( use_buf )
+        {
+            dbuf1 = ptr;
+            dbuf0 = buf1;
+            ptr += len*complex_elem_size;
+        }
+
+        for( int k = range.start; k < range.end; k++ )
+        {
+            int i = a + k*2;
+            const uchar* sptr = sptr0 + k*2*complex_elem_size;
+            uchar* dptr = dptr0 + k*2*complex_elem_size;
+
+            if( i+1 < b )
+            {
+                CopyFrom2Columns( sptr, sstep, buf0, buf1, len, complex_elem_size );
+                func( buf1, dbuf1, len, nf, _factors, itab, wave, len, spec, ptr, inv, scale );
+            }
+            else
+                CopyColumn( sptr, sstep, buf0, complex_elem_size, len, complex_elem_size );
+
+            func( buf0, dbuf0, len, nf, _factors, itab, wave, len, spec, ptr, inv, scale );
+
+            if( i+1 < b )
+                CopyTo2Columns( dbuf0, dbuf1, dptr, dstep, len, complex_elem_size );
+            else
+                CopyColumn( dbuf0, complex_elem_size, dptr, dstep, len, complex_elem_size );
+        }
+    }
+
+protected:
+    const uchar* sptr0;
+    size_t sstep;
+    uchar* dptr0;
+    size_t dstep;
+    int a, b;
+    DFTFunc func;
+    int len, nf;
+    const int *factors, *itab;
+    const uchar* wave;
+    const void* spec;
+    int inv;
+    double scale;
+    int complex_elem_size;
+    bool use_buf;
+    int buf_size;
+};
+
 }
     
 
@@ -1467,9 +1769,10 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
 
     AutoBuffer<uchar> buf;
     void *spec = 0;
+    Ptr<DFTPlan> plan;
     
     Mat src0 = _src0.getMat(), src = src0;
-    int prev_len = 0, stage = 0;
+    int stage = 0;
     bool inv = (flags & DFT_INVERSE) != 0;
     int nf = 0, real_transform = src.channels() == 1 || (inv && (flags & DFT_REAL_OUTPUT)!=0);
     int type = src.type(), depth = src.depth();
@@ -1587,11 +1890,12 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
         else
 #endif
         {
-            if( len != prev_len )
-                nf = DFTFactorize( len, factors );
+            // the factorization and the tables are taken from the plan cache
+            plan = getDFTPlan( len, complex_elem_size, stage == 0 && inv && real_transform, false );
+            nf = plan->nf;
+            memcpy( factors, plan->factors, sizeof(factors) );
 
             inplace_transform = factors[0] == factors[nf-1];
-            sz += len*(complex_elem_size + sizeof(int));
             i = nf > 1 && (factors[0] & 1) == 0;
             if( (factors[i] & 1) != 0 && factors[i] > 5 )
                 sz += (factors[i]+1)*complex_elem_size;
@@ -1604,41 +1908,21 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
             }
         }
 
-        ptr = (uchar*)buf;
-        buf.allocate( sz + 32 );
-        if( ptr != (uchar*)buf )
-            prev_len = 0; // because we release the buffer,
-                          // force recalculation of
-                          // twiddle factors and permutation table
-        ptr = (uchar*)buf;
         if( !spec )
         {
-            wave = ptr;
-            ptr += len*complex_elem_size;
-            itab = (int*)ptr;
-            ptr = (uchar*)cvAlignPtr( ptr + len*sizeof(int), 16 );
-
-            if( len != prev_len || (!inplace_transform && inv && real_transform))
-                DFTInit( len, nf, factors, itab, complex_elem_size,
-                            wave, stage == 0 && inv && real_transform );
-            // otherwise reuse the tables calculated on the previous stage
+            wave = (uchar*)&plan->wave[0];
+            itab = &plan->itab[0];
         }
 
         if( stage == 0 )
         {
-            uchar* tmp_buf = 0;
             int dptr_offset = 0;
             int dst_full_len = len*elem_size;
             int _flags = (int)inv + (src.channels() != dst.channels() ?
                          DFT_COMPLEX_INPUT_OR_OUTPUT : 0);
-            if( use_buf )
-            {
-                tmp_buf = ptr;
-                ptr += len*complex_elem_size;
-                if( odd_real && !inv && len > 1 &&
-                    !(_flags & DFT_COMPLEX_INPUT_OR_OUTPUT))
-                    dptr_offset = elem_size;
-            }
+            if( use_buf && odd_real && !inv && len > 1 &&
+                !(_flags & DFT_COMPLEX_INPUT_OR_OUTPUT))
+                dptr_offset = elem_size;
 
             if( !inv && (_flags & DFT_COMPLEX_INPUT_OR_OUTPUT) )
                 dst_full_len += (len & 1) ? elem_size : complex_elem_size;
@@ -1653,21 +1937,12 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
             if( nonzero_rows <= 0 || nonzero_rows > count )
                 nonzero_rows = count;
 
-            for( i = 0; i < nonzero_rows; i++ )
-            {
-                uchar* sptr = src.data + i*src.step;
-                uchar* dptr0 = dst.data + i*dst.step;
-                uchar* dptr = dptr0;
-
-                if( tmp_buf )
-                    dptr = tmp_buf;
-                
-                dft_func( sptr, dptr, len, nf, factors, itab, wave, len, spec, ptr, _flags, scale );
-                if( dptr != dptr0 )
-                    memcpy( dptr0, dptr + dptr_offset, dst_full_len );
-            }
+            // the rows are transformed in parallel, each thread with its own buffer
+            DFTRowsInvoker body( src, dst, dft_func, len, nf, factors, itab, wave, spec, _flags, scale,
+                                 complex_elem_size, use_buf != 0, dptr_offset, dst_full_len, sz );
+            parallelDFT( body, nonzero_rows, len );
 
-            for( ; i < count; i++ )
+            for( i = nonzero_rows; i < count; i++ )
             {
                 uchar* dptr0 = dst.data + i*dst.step;
                 memset( dptr0, 0, dst_full_len );
@@ -1683,6 +1958,8 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
             uchar *buf0, *buf1, *dbuf0, *dbuf1;
             uchar* sptr0 = src.data;
             uchar* dptr0 = dst.data;
+            buf.allocate( sz + 32 );
+            ptr = alignPtr((uchar*)buf, 16);
             buf0 = ptr;
             ptr += len*complex_elem_size;
             buf1 = ptr;
@@ -1791,26 +2068,12 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
                 }
             }
 
-            for( i = a; i < b; i += 2 )
+            // the rest of the columns are transformed in parallel, by pairs
+            if( a < b )
             {
-                if( i+1 < b )
-                {
-                    CopyFrom2Columns( sptr0, src.step, buf0, buf1, len, complex_elem_size );
-                    dft_func( buf1, dbuf1, len, nf, factors, itab,
-                              wave, len, spec, ptr, inv, scale );
-                }
-                else
-                    CopyColumn( sptr0, src.step, buf0, complex_elem_size, len, complex_elem_size );
-
-                dft_func( buf0, dbuf0, len, nf, factors, itab,
-                          wave, len, spec, ptr, inv, scale );
-
-                if( i+1 < b )
-                    CopyTo2Columns( dbuf0, dbuf1, dptr0, dst.step, len, complex_elem_size );
-                else
-                    CopyColumn( dbuf0, complex_elem_size, dptr0, dst.step, len, complex_elem_size );
-                sptr0 += 2*complex_elem_size;
-                dptr0 += 2*complex_elem_size;
+                DFTColumnsInvoker body( sptr0, src.step, dptr0, dst.step, a, b, dft_func, len, nf, factors,
+                                        itab, wave, spec, inv, scale, complex_elem_size, use_buf != 0, sz );
+                parallelDFT( body, (b - a + 1)/2, len*2 );
             }
 
             if( stage != 0 )
@@ -2215,6 +2478,48 @@ static void IDCT_64f(const double* src, int src_step, double* dft_src, double* d
          n, nf, factors, itab, dft_wave, dct_wave, spec, buf);
 }    
 
+// the 1D DCTs of the rows or the columns; each thread uses its own buffer
+class DCTInvoker : public ParallelLoopBody
+{
+public:
+    DCTInvoker( const uchar* _sptr, size_t _sstep0, size_t _sstep1, uchar* _dptr, size_t _dstep0,
+                size_t _dstep1, DCTFunc _func, int _len, const DFTPlan* _plan, int _elem_size, int _buf_size )
+        : sptr(_sptr), sstep0(_sstep0), sstep1(_sstep1), dptr(_dptr), dstep0(_dstep0), dstep1(_dstep1),
+          func(_func), len(_len), plan(_plan), elem_size(_elem_size), buf_size(_buf_size) {}
+
+    void operator()( const Range& range ) const
+    {
+        AutoBuffer<uchar> _buf(buf_size + 32);
+        uchar* ptr = alignPtr((uchar*)_buf, 16);
+        uchar *src_dft_buf, *dst_dft_buf;
+        int factors[34];
+
+        memcpy( factors, plan->factors, sizeof(factors) );
+        src_dft_buf = dst_dft_buf = ptr;
+        ptr += len*elem_size;
+        if( factors[0] != factors[plan->nf-1] )
+        {
+            dst_dft_buf = ptr;
+            ptr += len*elem_size;
+        }
+
+        for( int i = range.start; i < range.end; i++ )
+            func( sptr + i*sstep0, (int)sstep1, src_dft_buf, dst_dft_buf,
+                  dptr + i*dstep0, (int)dstep1, len, plan->nf, factors,
+                  &plan->itab[0], &plan->wave[0], &plan->dct_wave[0], 0, ptr );
+    }
+
+protected:
+    const uchar* sptr;
+    size_t sstep0, sstep1;
+    uchar* dptr;
+    size_t dstep0, dstep1;
+    DCTFunc func;
+    int len;
+    const DFTPlan* plan;
+    int elem_size, buf_size;
+};
+
 }
     
 void cv::dct( InputArray _src0, OutputArray _dst, int flags )
@@ -2230,18 +2535,9 @@ void cv::dct( InputArray _src0, OutputArray _dst, int flags )
     bool inv = (flags & DCT_INVERSE) != 0;
     Mat src0 = _src0.getMat(), src = src0;
     int type = src.type(), depth = src.depth();
-    void /* *spec_dft = 0, */ *spec = 0;
-
-    double scale = 1.;
-    int prev_len = 0, nf = 0, stage, end_stage;
-    uchar *src_dft_buf = 0, *dst_dft_buf = 0;
-    uchar *dft_wave = 0, *dct_wave = 0;
-    int* itab = 0;
-    uchar* ptr = 0;
+    int stage, end_stage;
     int elem_size = (int)src.elemSize(), complex_elem_size = elem_size*2;
-    int factors[34], inplace_transform;
-    int i, len, count;
-    AutoBuffer<uchar> buf;
+    int len, count;
 
     CV_Assert( type == CV_32FC1 || type == CV_64FC1 );
     _dst.create( src.rows, src.cols, type );
@@ -2287,86 +2583,19 @@ void cv::dct( InputArray _src0, OutputArray _dst, int flags )
             sstep0 = dstep0 = elem_size;
         }
 
-        if( len != prev_len )
-        {
-            int sz;
-
-            if( len > 1 && (len & 1) )
-                CV_Error( CV_StsNotImplemented, "Odd-size DCT\'s are not implemented" );
+        if( len > 1 && (len & 1) )
+            CV_Error( CV_StsNotImplemented, "Odd-size DCT\'s are not implemented" );
 
-            sz = len*elem_size;
-            sz += (len/2 + 1)*complex_elem_size;
+        // the factorization and the tables are taken from the plan cache
+        Ptr<DFTPlan> plan = getDFTPlan( len, complex_elem_size, inv, true );
+        const int* factors = plan->factors;
+        int i = plan->nf > 1 && (factors[0] & 1) == 0;
+        int sz = len*elem_size*2 + complex_elem_size;
+        if( (factors[i] & 1) != 0 && factors[i] > 5 )
+            sz += (factors[i]+1)*complex_elem_size;
 
-            spec = 0;
-            inplace_transform = 1;
-            /*if( len*count >= 64 && DFTInitAlloc_R_32f_p )
-            {
-                int ipp_sz = 0;
-                if( depth == CV_32F )
-                {
-                    if( spec_dft )
-                        IPPI_CALL( DFTFree_R_32f_p( spec_dft ));
-                    IPPI_CALL( DFTInitAlloc_R_32f_p( &spec_dft, len, 8, cvAlgHintNone ));
-                    IPPI_CALL( DFTGetBufSize_R_32f_p( spec_dft, &ipp_sz ));
-                }
-                else
-                {
-                    if( spec_dft )
-                        IPPI_CALL( DFTFree_R_64f_p( spec_dft ));
-                    IPPI_CALL( DFTInitAlloc_R_64f_p( &spec_dft, len, 8, cvAlgHintNone ));
-                    IPPI_CALL( DFTGetBufSize_R_64f_p( spec_dft, &ipp_sz ));
-                }
-                spec = spec_dft;
-                sz += ipp_sz;
-            }
-            else*/
-            {
-                sz += len*(complex_elem_size + sizeof(int)) + complex_elem_size;
-
-                nf = DFTFactorize( len, factors );
-                inplace_transform = factors[0] == factors[nf-1];
-
-                i = nf > 1 && (factors[0] & 1) == 0;
-                if( (factors[i] & 1) != 0 && factors[i] > 5 )
-                    sz += (factors[i]+1)*complex_elem_size;
-
-                if( !inplace_transform )
-                    sz += len*elem_size;
-            }
-
-            buf.allocate( sz + 32 );
-            ptr = (uchar*)buf;
-
-            if( !spec )
-            {
-                dft_wave = ptr;
-                ptr += len*complex_elem_size;
-                itab = (int*)ptr;
-                ptr = (uchar*)cvAlignPtr( ptr + len*sizeof(int), 16 );
-                DFTInit( len, nf, factors, itab, complex_elem_size, dft_wave, inv );
-            }
-                
-            dct_wave = ptr;
-            ptr += (len/2 + 1)*complex_elem_size;
-            src_dft_buf = dst_dft_buf = ptr;
-            ptr += len*elem_size;
-            if( !inplace_transform )
-            {
-                dst_dft_buf = ptr;
-                ptr += len*elem_size;
-            }
-            DCTInit( len, complex_elem_size, dct_wave, inv );
-            if( !inv )
-                scale += scale;
-            prev_len = len;
-        }
-        // otherwise reuse the tables calculated on the previous stage
-        for( i = 0; i < count; i++ )
-        {
-            dct_func( sptr + i*sstep0, (int)sstep1, src_dft_buf, dst_dft_buf,
-                      dptr + i*dstep0, (int)dstep1, len, nf, factors,
-                      itab, dft_wave, dct_wave, spec, ptr );
-        }
+        DCTInvoker body( sptr, sstep0, sstep1, dptr, dstep0, dstep1, dct_func, len, plan, elem_size, sz );
+        parallelDFT( body, count, len );
         src = dst;
     }
 }
@@ -41,6 +41,7 @@
 //M*/
 
 #include "precomp.hpp"
+#include "simd_avx2.hpp"
 
 
 namespace cv
@@ -87,6 +88,11 @@ static void FastAtan2_32f(const float *Y, const float *X, float *angle, int len,
         return;
 #endif
 
+#ifdef HAVE_AVX2_DISPATCH
+    if( USE_AVX2 )
+        i = avx2::fastAtan2_32f(Y, X, angle, len, scale);
+#endif
+
 #if CV_SSE2
     if( USE_SSE2 )
     {
@@ -198,6 +204,11 @@ static void Magnitude_32f(const float* x, const float* y, float* mag, int len)
 {
     int i = 0;
 
+#ifdef HAVE_AVX2_DISPATCH
+    if( USE_AVX2 )
+        i = avx2::magnitude32f(x, y, mag, len);
+#endif
+
 #if CV_SSE
     if( USE_SSE2 )
     {
@@ -224,6 +235,11 @@ static void Magnitude_64f(const double* x, const double* y, double* mag, int len
 {
     int i = 0;
 
+#ifdef HAVE_AVX2_DISPATCH
+    if( USE_AVX2 )
+        i = avx2::magnitude64f(x, y, mag, len);
+#endif
+
 #if CV_SSE2
     if( USE_SSE2 )
     {
@@ -781,6 +797,11 @@ static void Exp_32f( const float *_x, float *y, int n )
     const Cv32suf* x = (const Cv32suf*)_x;
     Cv32suf buf[4];
 
+#ifdef HAVE_AVX2_DISPATCH
+    if( USE_AVX2 )
+        i = avx2::exp32f(_x, y, n, expTab);
+#endif
+
 #if CV_SSE2
     if( n >= 8 && USE_SSE2 )
     {
@@ -1464,6 +1485,11 @@ static void Log_32f( const float *_x, float *y, int n )
     Cv32suf buf[4];
     const int* x = (const int*)_x;
 
+#ifdef HAVE_AVX2_DISPATCH
+    if( USE_AVX2 )
+        i = avx2::log32f(_x, y, n, icvLogTab);
+#endif
+
 #if CV_SSE2
     if( USE_SSE2 )
     {
@@ -41,6 +41,7 @@
 //M*/
 
 #include "precomp.hpp"
+#include "simd_avx2.hpp"
 
 #ifdef HAVE_IPP
 #include "ippversion.h"
@@ -693,6 +694,324 @@ static void GEMMStore_64fc( const Complexd* c_data, size_t c_step,
     GEMMStore(c_data, c_step, d_buf, d_buf_step, d_data, d_step, d_size, alpha, beta, flags);
 }
 
+/*
+  Packed-panel GEMM for the large CV_32FC1 and CV_64FC1 products.
+
+  A is split into strips of mr rows and B into strips of nr columns (the rows and columns of
+  op(A) and op(B), so the transposition flags are handled here). Each strip is copied into a
+  contiguous panel where the mr (nr) values of the same k are adjacent, padded with zeros,
+  slab by slab of GEMM_KC values of k. The micro-kernel then multiplies an mr x kc panel of A
+  by a kc x nr panel of B, keeping the whole mr x nr block of the product in registers.
+  The panels, the micro-kernel and the tile buffers are always double, so CV_32FC1 products
+  are accumulated in double, like in GEMMSingleMul and GEMMBlockMul.
+
+  D is processed by GEMM_MC x GEMM_NC tiles, in parallel. A tile accumulates A*B over all the
+  slabs in a local buffer and then stores alpha*A*B + beta*C, so D may share the data with
+  any of A, B and C: A and B are packed before D is touched, and C is read element by element
+  right before the same element of D is written.
+*/
+
+enum { GEMM_MC = 96, GEMM_NC = 256, GEMM_KC = 256 };
+
+typedef void (*GEMMKernelFunc)( int kc, const double* a, const double* b, double* c, size_t ldc );
+
+struct GEMMKernel
+{
+    int mr, nr;
+    GEMMKernelFunc func;
+};
+
+// mr is not necessarily a power of 2, so alignSize() can not be used
+static inline int GEMMRoundUp( int a, int r )
+{
+    return (a + r - 1)/r*r;
+}
+
+template<typename T, int MR, int NR> static void
+GEMMKernel_( int kc, const T* a, const T* b, T* c, size_t ldc )
+{
+    T s[MR][NR];
+    int i, j, k;
+
+    for( i = 0; i < MR; i++ )
+        for( j = 0; j < NR; j++ )
+            s[i][j] = 0;
+
+    for( k = 0; k < kc; k++, a += MR, b += NR )
+        for( i = 0; i < MR; i++ )
+        {
+            T ai = a[i];
+            for( j = 0; j < NR; j++ )
+                s[i][j] += ai*b[j];
+        }
+
+    for( i = 0; i < MR; i++, c += ldc )
+        for( j = 0; j < NR; j++ )
+            c[j] += s[i][j];
+}
+
+#if CV_SSE2
+
+static void GEMMKernel_64f_SSE2( int kc, const double* a, const double* b, double* c, size_t ldc )
+{
+    __m128d c00 = _mm_setzero_pd(), c01 = c00, c10 = c00, c11 = c00;
+    __m128d c20 = c00, c21 = c00, c30 = c00, c31 = c00;
+
+    for( int k = 0; k < kc; k++, a += 4, b += 4 )
+    {
+        __m128d b0 = _mm_loadu_pd(b), b1 = _mm_loadu_pd(b + 2);
+        __m128d t = _mm_set1_pd(a[0]);
+        c00 = _mm_add_pd(c00, _mm_mul_pd(t, b0));
+        c01 = _mm_add_pd(c01, _mm_mul_pd(t, b1));
+        t = _mm_set1_pd(a[1]);
+        c10 = _mm_add_pd(c10, _mm_mul_pd(t, b0));
+        c11 = _mm_add_pd(c11, _mm_mul_pd(t, b1));
+        t = _mm_set1_pd(a[2]);
+        c20 = _mm_add_pd(c20, _mm_mul_pd(t, b0));
+        c21 = _mm_add_pd(c21, _mm_mul_pd(t, b1));
+        t = _mm_set1_pd(a[3]);
+        c30 = _mm_add_pd(c30, _mm_mul_pd(t, b0));
+        c31 = _mm_add_pd(c31, _mm_mul_pd(t, b1));
+    }
+
+    _mm_storeu_pd(c, _mm_add_pd(_mm_loadu_pd(c), c00));
+    _mm_storeu_pd(c + 2, _mm_add_pd(_mm_loadu_pd(c + 2), c01));
+    c += ldc;
+    _mm_storeu_pd(c, _mm_add_pd(_mm_loadu_pd(c), c10));
+    _mm_storeu_pd(c + 2, _mm_add_pd(_mm_loadu_pd(c + 2), c11));
+    c += ldc;
+    _mm_storeu_pd(c, _mm_add_pd(_mm_loadu_pd(c), c20));
+    _mm_storeu_pd(c + 2, _mm_add_pd(_mm_loadu_pd(c + 2), c21));
+    c += ldc;
+    _mm_storeu_pd(c, _mm_add_pd(_mm_loadu_pd(c), c30));
+    _mm_storeu_pd(c + 2, _mm_add_pd(_mm_loadu_pd(c + 2), c31));
+}
+
+#endif
+
+static GEMMKernel getGEMMKernel()
+{
+    GEMMKernel kernel;
+
+#ifdef HAVE_AVX2_DISPATCH
+    if( USE_AVX2 )
+    {
+        kernel.mr = avx2::GEMM_MR;
+        kernel.nr = avx2::GEMM_NR;
+        kernel.func = avx2::gemmKernel64f;
+        return kernel;
+    }
+#endif
+
+    kernel.mr = kernel.nr = 4;
+#if CV_SSE2
+    if( USE_SSE2 )
+    {
+        kernel.func = GEMMKernel_64f_SSE2;
+        return kernel;
+    }
+#endif
+    kernel.func = GEMMKernel_<double, 4, 4>;
+    return kernel;
+}
+
+// a matrix operand seen as the rows x len matrix op(X); element (i, k) is at data + i*step0 + k*step1
+struct GEMMPanel
+{
+    const uchar* data;
+    size_t step0, step1;
+    int rows, r;
+    double* packed;
+};
+
+template<typename T> static void
+GEMMPackStrip( const GEMMPanel& p, int len, int s )
+{
+    int r = p.r, i0 = s*r, n = std::min(r, p.rows - i0);
+    size_t rows_pad = GEMMRoundUp(p.rows, r);
+
+    for( int k0 = 0; k0 < len; k0 += GEMM_KC )
+    {
+        int kc = std::min((int)GEMM_KC, len - k0);
+        double* dst = p.packed + k0*rows_pad + (size_t)i0*kc;
+        const uchar* src = p.data + i0*p.step0 + k0*p.step1;
+
+        for( int k = 0; k < kc; k++, dst += r, src += p.step1 )
+        {
+            int i = 0;
+            for( ; i < n; i++ )
+                dst[i] = *(const T*)(src + i*p.step0);
+            for( ; i < r; i++ )
+                dst[i] = 0;
+        }
+    }
+}
+
+template<typename T> class GEMMPackInvoker : public ParallelLoopBody
+{
+public:
+    GEMMPackInvoker( const GEMMPanel& _a, const GEMMPanel& _b, int _len )
+        : a(_a), b(_b), len(_len), astrips((_a.rows + _a.r - 1)/_a.r) {}
+
+    void operator()( const Range& range ) const
+    {
+        for( int s = range.start; s < range.end; s++ )
+        {
+            if( s < astrips )
+                GEMMPackStrip<T>(a, len, s);
+            else
+                GEMMPackStrip<T>(b, len, s - astrips);
+        }
+    }
+
+protected:
+    GEMMPanel a, b;
+    int len, astrips;
+};
+
+template<typename T> class GEMMPackedInvoker : public ParallelLoopBody
+{
+public:
+    GEMMPackedInvoker( const GEMMKernel& _kernel, const GEMMPanel& _a, const GEMMPanel& _b, int _len,
+                       const uchar* _c, size_t _c_step0, size_t _c_step1, Mat& _d,
+                       double _alpha, double _beta )
+        : kernel(_kernel), a(_a), b(_b), len(_len), c(_c), c_step0(_c_step0), c_step1(_c_step1),
+          d(&_d), alpha(_alpha), beta(_beta)
+    {
+        ntiles_n = (b.rows + GEMM_NC - 1)/GEMM_NC;
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int mr = kernel.mr, nr = kernel.nr;
+        size_t m_pad = GEMMRoundUp(a.rows, mr), n_pad = GEMMRoundUp(b.rows, nr);
+        AutoBuffer<double> _buf(GEMMRoundUp(GEMM_MC, mr)*GEMMRoundUp(GEMM_NC, nr));
+        double* buf = _buf;
+
+        for( int t = range.start; t < range.end; t++ )
+        {
+            int i0 = (t / ntiles_n)*GEMM_MC, j0 = (t % ntiles_n)*GEMM_NC;
+            int mc = std::min((int)GEMM_MC, a.rows - i0), nc = std::min((int)GEMM_NC, b.rows - j0);
+            int mc_pad = GEMMRoundUp(mc, mr), nc_pad = GEMMRoundUp(nc, nr);
+            int i, j, k0;
+
+            memset(buf, 0, mc_pad*nc_pad*sizeof(buf[0]));
+
+            for( k0 = 0; k0 < len; k0 += GEMM_KC )
+            {
+                int kc = std::min((int)GEMM_KC, len - k0);
+                const double* apanel = a.packed + k0*m_pad + (size_t)i0*kc;
+                const double* bpanel = b.packed + k0*n_pad + (size_t)j0*kc;
+
+                for( j = 0; j < nc_pad; j += nr )
+                    for( i = 0; i < mc_pad; i += mr )
+                        kernel.func( kc, apanel + i*kc, bpanel + j*kc, buf + i*nc_pad + j, nc_pad );
+            }
+
+            for( i = 0; i < mc; i++ )
+            {
+                const double* s = buf + i*nc_pad;
+                T* dst = (T*)(d->data + (i0 + i)*d->step) + j0;
+
+                if( c )
+                {
+                    const uchar* src = c + (i0 + i)*c_step0 + j0*c_step1;
+                    for( j = 0; j < nc; j++, src += c_step1 )
+                        dst[j] = (T)(s[j]*alpha + *(const T*)src*beta);
+                }
+                else
+                    for( j = 0; j < nc; j++ )
+                        dst[j] = (T)(s[j]*alpha);
+            }
+        }
+    }
+
+protected:
+    GEMMKernel kernel;
+    GEMMPanel a, b;
+    int len, ntiles_n;
+    const uchar* c;
+    size_t c_step0, c_step1;
+    Mat* d;
+    double alpha, beta;
+};
+
+template<typename T> static void
+GEMMPacked( const Mat& A, const Mat& B, double alpha, const Mat& C, double beta,
+            Mat& D, int len, int flags )
+{
+    GEMMKernel kernel = getGEMMKernel();
+    GEMMPanel a, b;
+    size_t esz = sizeof(T);
+
+    a.data = A.data;
+    a.rows = D.rows;
+    a.r = kernel.mr;
+    if( !(flags & GEMM_1_T) )
+        a.step0 = A.step, a.step1 = esz;
+    else
+        a.step0 = esz, a.step1 = A.step;
+
+    b.data = B.data;
+    b.rows = D.cols;
+    b.r = kernel.nr;
+    if( !(flags & GEMM_2_T) )
+        b.step0 = esz, b.step1 = B.step;
+    else
+        b.step0 = B.step, b.step1 = esz;
+
+    size_t a_size = (size_t)GEMMRoundUp(a.rows, a.r)*len, b_size = (size_t)GEMMRoundUp(b.rows, b.r)*len;
+    AutoBuffer<double> buf(a_size + b_size);
+    a.packed = buf;
+    b.packed = (double*)buf + a_size;
+
+    int astrips = (a.rows + a.r - 1)/a.r, bstrips = (b.rows + b.r - 1)/b.r;
+    parallel_for_(Range(0, astrips + bstrips), GEMMPackInvoker<T>(a, b, len));
+
+    size_t c_step0 = 0, c_step1 = 0;
+    if( C.data )
+    {
+        if( !(flags & GEMM_3_T) )
+            c_step0 = C.step, c_step1 = esz;
+        else
+            c_step0 = esz, c_step1 = C.step;
+    }
+
+    int ntiles = ((D.rows + GEMM_MC - 1)/GEMM_MC)*((D.cols + GEMM_NC - 1)/GEMM_NC);
+    parallel_for_(Range(0, ntiles), GEMMPackedInvoker<T>(kernel, a, b, len,
+                  C.data, c_step0, c_step1, D, alpha, beta));
+}
+
+// the products smaller than that are left to GEMMSingleMul/GEMMBlockMul
+static const double GEMM_PACKED_MIN_OPS = 64.*64*64;
+
+static bool useGEMMPacked( int type, Size d_size, int len )
+{
+    return (type == CV_32FC1 || type == CV_64FC1) && useOptimized() &&
+        len >= 16 && d_size.width >= 16 && d_size.height >= 4 &&
+        (double)d_size.width*d_size.height*len >= GEMM_PACKED_MIN_OPS;
+}
+
+class GEMMBatchInvoker : public ParallelLoopBody
+{
+public:
+    GEMMBatchInvoker( const vector<Mat>& _a, const vector<Mat>& _b, double _alpha,
+                      const vector<Mat>& _c, double _beta, vector<Mat>& _d, int _flags )
+        : a(&_a), b(&_b), c(&_c), d(&_d), alpha(_alpha), beta(_beta), flags(_flags) {}
+
+    void operator()( const Range& range ) const
+    {
+        for( int i = range.start; i < range.end; i++ )
+            gemm( (*a)[i], (*b)[i], alpha, c->empty() ? Mat() : (*c)[i], beta, (*d)[i], flags );
+    }
+
+protected:
+    const vector<Mat> *a, *b, *c;
+    vector<Mat>* d;
+    double alpha, beta;
+    int flags;
+};
+
 }
 
 void cv::gemm( InputArray matA, InputArray matB, double alpha,
@@ -1007,6 +1326,15 @@ void cv::gemm( InputArray matA, InputArray matB, double alpha,
         }
     }
 
+    if( useGEMMPacked(type, d_size, len) )
+    {
+        if( type == CV_32FC1 )
+            GEMMPacked<float>(A, B, alpha, C, beta, D, len, flags);
+        else
+            GEMMPacked<double>(A, B, alpha, C, beta, D, len, flags);
+        return;
+    }
+
     {
     size_t b_step = B.step;
     GEMMSingleMulFunc singleMulFunc;
@@ -1272,6 +1600,30 @@ void cv::gemm( InputArray matA, InputArray matB, double alpha,
     }
 }
 
+void cv::gemmBatched( InputArrayOfArrays _src1, InputArrayOfArrays _src2, double alpha,
+                      InputArrayOfArrays _src3, double beta, OutputArrayOfArrays _dst, int flags )
+{
+    vector<Mat> A, B, C;
+    _src1.getMatVector(A);
+    _src2.getMatVector(B);
+    if( beta != 0 && !_src3.empty() )
+        _src3.getMatVector(C);
+
+    int i, n = (int)A.size();
+    CV_Assert( (int)B.size() == n && (C.empty() || (int)C.size() == n) );
+
+    _dst.create(n, 1, n > 0 ? A[0].type() : CV_32F);
+    vector<Mat> D(n);
+    for( i = 0; i < n; i++ )
+    {
+        Size d_size(flags & GEMM_2_T ? B[i].rows : B[i].cols, flags & GEMM_1_T ? A[i].cols : A[i].rows);
+        _dst.create(d_size, A[i].type(), i);
+        D[i] = _dst.getMat(i);
+    }
+
+    parallel_for_(Range(0, n), GEMMBatchInvoker(A, B, alpha, C, beta, D, flags));
+}
+
 /****************************************************************************************\
 *                                        Transform                                       *
 \****************************************************************************************/
@@ -204,6 +204,36 @@ public:
 
 static MatOp_Initializer g_MatOp_Initializer;
 
+/*
+  The chains of the element-wise operations that can not be folded into a single MatOp_AddEx,
+  MatOp_Bin or MatOp_Cmp expression (like a*alpha + b*beta - c or abs(a - b) > t) are collected
+  into a small program that is evaluated in a single pass over the data, block by block,
+  without the full-size temporary matrices. The intermediate results are kept in float
+  (or double for 32s and 64f matrices) and are not saturated.
+*/
+class MatOp_Fused : public MatOp
+{
+public:
+    MatOp_Fused() {}
+    virtual ~MatOp_Fused() {}
+
+    bool elementWise(const MatExpr& /*expr*/) const { return true; }
+    void assign(const MatExpr& expr, Mat& m, int type=-1) const;
+    void roi(const MatExpr& expr, const Range& rowRange, const Range& colRange, MatExpr& res) const;
+    void diag(const MatExpr& expr, int d, MatExpr& res) const;
+    int type(const MatExpr& expr) const;
+
+    // e1 + scale*e2 (FUSE_SUM), scale*e1*e2 (FUSE_MUL), scale*e1/e2 (FUSE_DIV)
+    static bool makeExpr(MatExpr& res, int op, const MatExpr& e1, const MatExpr& e2, double scale);
+    // alpha*e + s (FUSE_SUM), alpha/e (FUSE_DIV), abs(e - s) (FUSE_ABSDIFF)
+    static bool makeExpr(MatExpr& res, int op, const MatExpr& e, double alpha, const Scalar& s=Scalar());
+    static bool makeCmp(MatExpr& res, int cmpop, const MatExpr& e, double alpha);
+};
+
+static MatOp_Fused g_MatOp_Fused;
+
+enum { FUSE_INPUT=0, FUSE_SUM=1, FUSE_MUL=2, FUSE_DIV=3, FUSE_ABSDIFF=4, FUSE_MIN=5, FUSE_MAX=6, FUSE_CMP=7 };
+
 static inline bool isIdentity(const MatExpr& e) { return e.op == &g_MatOp_Identity; }
 static inline bool isAddEx(const MatExpr& e) { return e.op == &g_MatOp_AddEx; }
 static inline bool isScaled(const MatExpr& e) { return isAddEx(e) && (!e.b.data || e.beta == 0) && e.s == Scalar(); }
@@ -216,6 +246,9 @@ static inline bool isSolve(const MatExpr& e) { return e.op == &g_MatOp_Solve; }
 static inline bool isGEMM(const MatExpr& e) { return e.op == &g_MatOp_GEMM; }
 static inline bool isMatProd(const MatExpr& e) { return e.op == &g_MatOp_GEMM && (!e.c.data || e.beta == 0); }
 static inline bool isInitializer(const MatExpr& e) { return e.op == &g_MatOp_Initializer; }
+static inline bool isFused(const MatExpr& e) { return e.op == &g_MatOp_Fused; }
+static inline bool isSimpleTerm(const MatExpr& e) { return isIdentity(e) || (isAddEx(e) && (!e.b.data || e.beta == 0)); }
+static inline bool isSimpleFactor(const MatExpr& e) { return isIdentity(e) || isScaled(e) || isReciprocal(e); }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -327,6 +360,10 @@ void MatOp::add(const MatExpr& e1, const MatExpr& e2, MatExpr& res) const
 {
     if( this == e2.op )
     {
+        if( (!isSimpleTerm(e1) || !isSimpleTerm(e2)) &&
+            MatOp_Fused::makeExpr(res, FUSE_SUM, e1, e2, 1) )
+            return;
+
         double alpha = 1, beta = 1;
         Scalar s;
         Mat m1, m2;
@@ -356,6 +393,9 @@ void MatOp::add(const MatExpr& e1, const MatExpr& e2, MatExpr& res) const
 
 void MatOp::add(const MatExpr& expr1, const Scalar& s, MatExpr& res) const
 {
+    if( !isIdentity(expr1) && MatOp_Fused::makeExpr(res, FUSE_SUM, expr1, 1, s) )
+        return;
+
     Mat m1;
     expr1.op->assign(expr1, m1);
     MatOp_AddEx::makeExpr(res, m1, Mat(), 1, 0, s);
@@ -366,6 +406,10 @@ void MatOp::subtract(const MatExpr& e1, const MatExpr& e2, MatExpr& res) const
 {
     if( this == e2.op )
     {
+        if( (!isSimpleTerm(e1) || !isSimpleTerm(e2)) &&
+            MatOp_Fused::makeExpr(res, FUSE_SUM, e1, e2, -1) )
+            return;
+
         double alpha = 1, beta = -1;
         Scalar s;
         Mat m1, m2;
@@ -395,6 +439,9 @@ void MatOp::subtract(const MatExpr& e1, const MatExpr& e2, MatExpr& res) const
 
 void MatOp::subtract(const Scalar& s, const MatExpr& expr, MatExpr& res) const
 {
+    if( !isIdentity(expr) && MatOp_Fused::makeExpr(res, FUSE_SUM, expr, -1, s) )
+        return;
+
     Mat m;
     expr.op->assign(expr, m);
     MatOp_AddEx::makeExpr(res, m, Mat(), -1, 0, s);
@@ -405,6 +452,10 @@ void MatOp::multiply(const MatExpr& e1, const MatExpr& e2, MatExpr& res, double
 {
     if( this == e2.op )
     {
+        if( (!isSimpleFactor(e1) || !isSimpleFactor(e2)) &&
+            MatOp_Fused::makeExpr(res, FUSE_MUL, e1, e2, scale) )
+            return;
+
         Mat m1, m2;
 
         if( isReciprocal(e1) )
@@ -454,6 +505,9 @@ void MatOp::multiply(const MatExpr& e1, const MatExpr& e2, MatExpr& res, double
 
 void MatOp::multiply(const MatExpr& expr, double s, MatExpr& res) const
 {
+    if( !isIdentity(expr) && MatOp_Fused::makeExpr(res, FUSE_SUM, expr, s) )
+        return;
+
     Mat m;
     expr.op->assign(expr, m);
     MatOp_AddEx::makeExpr(res, m, Mat(), s, 0);
@@ -464,6 +518,10 @@ void MatOp::divide(const MatExpr& e1, const MatExpr& e2, MatExpr& res, double sc
 {
     if( this == e2.op )
     {
+        if( (!isSimpleFactor(e1) || !isSimpleFactor(e2)) &&
+            MatOp_Fused::makeExpr(res, FUSE_DIV, e1, e2, scale) )
+            return;
+
         if( isReciprocal(e1) && isReciprocal(e2) )
             MatOp_Bin::makeExpr(res, '/', e2.a, e1.a, e1.alpha/e2.alpha);
         else
@@ -502,6 +560,9 @@ void MatOp::divide(const MatExpr& e1, const MatExpr& e2, MatExpr& res, double sc
 
 void MatOp::divide(double s, const MatExpr& expr, MatExpr& res) const
 {
+    if( !isIdentity(expr) && MatOp_Fused::makeExpr(res, FUSE_DIV, expr, s) )
+        return;
+
     Mat m;
     expr.op->assign(expr, m);
     MatOp_Bin::makeExpr(res, '/', m, Mat(), s);
@@ -510,6 +571,9 @@ void MatOp::divide(double s, const MatExpr& expr, MatExpr& res) const
 
 void MatOp::abs(const MatExpr& expr, MatExpr& res) const
 {
+    if( !isIdentity(expr) && MatOp_Fused::makeExpr(res, FUSE_ABSDIFF, expr, 1) )
+        return;
+
     Mat m;
     expr.op->assign(expr, m);
     MatOp_Bin::makeExpr(res, 'a', m, Mat());
@@ -902,6 +966,18 @@ MatExpr operator / (const MatExpr& e1, const MatExpr& e2)
     return en;
 }
 
+static void makeCmpExpr(MatExpr& res, int cmpop, const MatExpr& e, double s)
+{
+    if( isIdentity(e) )
+        MatOp_Cmp::makeExpr(res, cmpop, e.a, s);
+    else if( !MatOp_Fused::makeCmp(res, cmpop, e, s) )
+    {
+        Mat m;
+        e.op->assign(e, m);
+        MatOp_Cmp::makeExpr(res, cmpop, m, s);
+    }
+}
+
 MatExpr operator < (const Mat& a, const Mat& b)
 {
     MatExpr e;
@@ -923,6 +999,20 @@ MatExpr operator < (double s, const Mat& a)
     return e;
 }
 
+MatExpr operator < (const MatExpr& e, double s)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_LT, e, s);
+    return en;
+}
+
+MatExpr operator < (double s, const MatExpr& e)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_GT, e, s);
+    return en;
+}
+
 MatExpr operator <= (const Mat& a, const Mat& b)
 {
     MatExpr e;
@@ -944,6 +1034,20 @@ MatExpr operator <= (double s, const Mat& a)
     return e;
 }
 
+MatExpr operator <= (const MatExpr& e, double s)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_LE, e, s);
+    return en;
+}
+
+MatExpr operator <= (double s, const MatExpr& e)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_GE, e, s);
+    return en;
+}
+
 MatExpr operator == (const Mat& a, const Mat& b)
 {
     MatExpr e;
@@ -965,6 +1069,20 @@ MatExpr operator == (double s, const Mat& a)
     return e;
 }
 
+MatExpr operator == (const MatExpr& e, double s)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_EQ, e, s);
+    return en;
+}
+
+MatExpr operator == (double s, const MatExpr& e)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_EQ, e, s);
+    return en;
+}
+
 MatExpr operator != (const Mat& a, const Mat& b)
 {
     MatExpr e;
@@ -986,6 +1104,20 @@ MatExpr operator != (double s, const Mat& a)
     return e;
 }
 
+MatExpr operator != (const MatExpr& e, double s)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_NE, e, s);
+    return en;
+}
+
+MatExpr operator != (double s, const MatExpr& e)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_NE, e, s);
+    return en;
+}
+
 MatExpr operator >= (const Mat& a, const Mat& b)
 {
     MatExpr e;
@@ -1007,6 +1139,20 @@ MatExpr operator >= (double s, const Mat& a)
     return e;
 }
 
+MatExpr operator >= (const MatExpr& e, double s)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_GE, e, s);
+    return en;
+}
+
+MatExpr operator >= (double s, const MatExpr& e)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_LE, e, s);
+    return en;
+}
+
 MatExpr operator > (const Mat& a, const Mat& b)
 {
     MatExpr e;
@@ -1028,6 +1174,20 @@ MatExpr operator > (double s, const Mat& a)
     return e;
 }
 
+MatExpr operator > (const MatExpr& e, double s)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_GT, e, s);
+    return en;
+}
+
+MatExpr operator > (double s, const MatExpr& e)
+{
+    MatExpr en;
+    makeCmpExpr(en, CV_CMP_LT, e, s);
+    return en;
+}
+
 MatExpr min(const Mat& a, const Mat& b)
 {
     MatExpr e;
@@ -1574,6 +1734,1015 @@ inline void MatOp_Initializer::makeExpr(MatExpr& res, int method, Size sz, int t
 }
 
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+enum { FUSED_MAX_TERMS = 4, FUSED_MAX_NODES = 32, FUSED_BLOCK_SIZE = 512, FUSED_PARALLEL_MIN = 1 << 16 };
+
+struct FusedExprNode
+{
+    FusedExprNode(int _op=FUSE_INPUT) : op(_op), nargs(0), cmpop(0), alpha(1)
+    {
+        for( int i = 0; i < FUSED_MAX_TERMS; i++ )
+            args[i] = -1, coeffs[i] = 0;
+    }
+
+    int op, nargs, cmpop;
+    // the argument nodes; the input index for FUSE_INPUT
+    int args[FUSED_MAX_TERMS];
+    // the FUSE_SUM coefficients
+    double coeffs[FUSED_MAX_TERMS];
+    // the scale of FUSE_MUL and FUSE_DIV, the scalar operand of FUSE_MIN, FUSE_MAX and FUSE_CMP
+    double alpha;
+    // the FUSE_SUM shift and the scalar operand of FUSE_ABSDIFF
+    Scalar s;
+};
+
+// the nodes are stored in the evaluation order, the last one is the result
+struct FusedExprProgram
+{
+    typedef vector<std::pair<int, double> > Terms;
+
+    int addInput(const Mat& m);
+    int addNode(const FusedExprNode& node);
+    int addExpr(const MatExpr& e);
+    void addProgram(const FusedExprProgram& p, size_t count, vector<int>& ofs);
+    void addTerms(const MatExpr& e, double coeff, Terms& terms, Scalar& s);
+    int addSum(const Terms& terms, const Scalar& s);
+    bool isMask() const { return nodes.back().op == FUSE_CMP; }
+    bool isValid() const;
+
+    int refcount;
+    vector<Mat> inputs;
+    vector<FusedExprNode> nodes;
+};
+
+// deletes FusedExprProgram when the last MatExpr referencing it is destroyed
+class FusedExprAllocator : public MatAllocator
+{
+public:
+    void allocate(int, const int*, int, int*&, uchar*&, uchar*&, size_t*)
+    {
+        CV_Error(CV_StsNotImplemented, "");
+    }
+
+    void deallocate(int* /*refcount*/, uchar* datastart, uchar* /*data*/)
+    {
+        delete (FusedExprProgram*)datastart;
+    }
+};
+
+static FusedExprAllocator g_fusedExprAllocator;
+
+static inline const FusedExprProgram* fusedProgram(const MatExpr& e)
+{
+    return (const FusedExprProgram*)e.c.data;
+}
+
+static bool isFusable(const MatExpr& e)
+{
+    if( isIdentity(e) || isAddEx(e) )
+        return true;
+    if( e.op == &g_MatOp_Bin )
+        return e.flags == '*' || e.flags == '/' || e.flags == 'a' || e.flags == 'm' || e.flags == 'M';
+    if( isFused(e) )
+        return !fusedProgram(e)->isMask();
+    return false;
+}
+
+int FusedExprProgram::addInput(const Mat& m)
+{
+    size_t i, j, k = inputs.size();
+    for( i = 0; i < k; i++ )
+        if( inputs[i].data == m.data && inputs[i].step == m.step && inputs[i].size == m.size )
+            break;
+    if( i == k )
+        inputs.push_back(m);
+    for( j = 0; j < nodes.size(); j++ )
+        if( nodes[j].op == FUSE_INPUT && nodes[j].args[0] == (int)i )
+            return (int)j;
+    FusedExprNode node(FUSE_INPUT);
+    node.args[0] = (int)i;
+    return addNode(node);
+}
+
+int FusedExprProgram::addNode(const FusedExprNode& node)
+{
+    nodes.push_back(node);
+    return (int)nodes.size() - 1;
+}
+
+void FusedExprProgram::addProgram(const FusedExprProgram& p, size_t count, vector<int>& ofs)
+{
+    ofs.resize(p.nodes.size(), -1);
+    for( size_t i = 0; i < count; i++ )
+    {
+        const FusedExprNode& node = p.nodes[i];
+        if( node.op == FUSE_INPUT )
+            ofs[i] = addInput(p.inputs[node.args[0]]);
+        else
+        {
+            FusedExprNode node1 = node;
+            for( int j = 0; j < node.nargs; j++ )
+                node1.args[j] = ofs[node.args[j]];
+            ofs[i] = addNode(node1);
+        }
+    }
+}
+
+int FusedExprProgram::addExpr(const MatExpr& e)
+{
+    if( isIdentity(e) )
+        return addInput(e.a);
+
+    if( isAddEx(e) )
+    {
+        Terms terms;
+        Scalar s;
+        addTerms(e, 1, terms, s);
+        return addSum(terms, s);
+    }
+
+    if( isFused(e) )
+    {
+        const FusedExprProgram& p = *fusedProgram(e);
+        vector<int> ofs;
+        addProgram(p, p.nodes.size(), ofs);
+        return ofs.back();
+    }
+
+    CV_Assert( e.op == &g_MatOp_Bin );
+    FusedExprNode node;
+    node.nargs = e.b.data ? 2 : 1;
+    node.args[0] = addInput(e.a);
+    if( e.b.data )
+        node.args[1] = addInput(e.b);
+
+    switch( e.flags )
+    {
+    case '*':
+        node.op = FUSE_MUL;
+        node.alpha = e.alpha;
+        break;
+    case '/':
+        node.op = FUSE_DIV;
+        node.alpha = e.alpha;
+        break;
+    case 'a':
+        node.op = FUSE_ABSDIFF;
+        node.s = e.s;
+        break;
+    default:
+        node.op = e.flags == 'm' ? FUSE_MIN : FUSE_MAX;
+        node.alpha = e.s[0];
+    }
+    return addNode(node);
+}
+
+void FusedExprProgram::addTerms(const MatExpr& e, double coeff, Terms& terms, Scalar& s)
+{
+    if( isIdentity(e) )
+        terms.push_back(std::make_pair(addInput(e.a), coeff));
+    else if( isAddEx(e) )
+    {
+        terms.push_back(std::make_pair(addInput(e.a), coeff*e.alpha));
+        if( e.b.data && e.beta != 0 )
+            terms.push_back(std::make_pair(addInput(e.b), coeff*e.beta));
+        s += e.s*coeff;
+    }
+    else if( isFused(e) && fusedProgram(e)->nodes.back().op == FUSE_SUM )
+    {
+        // merge the terms of the sums instead of summing the sums
+        const FusedExprProgram& p = *fusedProgram(e);
+        const FusedExprNode& last = p.nodes.back();
+        vector<int> ofs;
+        addProgram(p, p.nodes.size() - 1, ofs);
+        for( int j = 0; j < last.nargs; j++ )
+            terms.push_back(std::make_pair(ofs[last.args[j]], coeff*last.coeffs[j]));
+        s += last.s*coeff;
+    }
+    else
+        terms.push_back(std::make_pair(addExpr(e), coeff));
+}
+
+// the terms are summed from left to right, as cv::add would do it
+int FusedExprProgram::addSum(const Terms& terms, const Scalar& s)
+{
+    int prev = -1;
+    size_t i = 0;
+    do
+    {
+        FusedExprNode node(FUSE_SUM);
+        if( prev >= 0 )
+        {
+            node.args[0] = prev;
+            node.coeffs[0] = 1;
+            node.nargs = 1;
+        }
+        for( ; i < terms.size() && node.nargs < FUSED_MAX_TERMS; i++, node.nargs++ )
+        {
+            node.args[node.nargs] = terms[i].first;
+            node.coeffs[node.nargs] = terms[i].second;
+        }
+        prev = addNode(node);
+    }
+    while( i < terms.size() );
+
+    nodes[prev].s = s;
+    return prev;
+}
+
+bool FusedExprProgram::isValid() const
+{
+    if( nodes.size() > FUSED_MAX_NODES )
+        return false;
+    const Mat& m0 = inputs[0];
+    if( m0.dims > 2 || m0.channels() > 4 || !m0.data )
+        return false;
+    for( size_t i = 1; i < inputs.size(); i++ )
+        if( inputs[i].type() != m0.type() || inputs[i].size != m0.size )
+            return false;
+    return true;
+}
+
+static bool makeFusedExpr(MatExpr& res, FusedExprProgram* p)
+{
+    if( !p->isValid() )
+    {
+        delete p;
+        return false;
+    }
+    Mat holder(1, 1, CV_8U, p);
+    p->refcount = 1;
+    holder.refcount = &p->refcount;
+    holder.allocator = &g_fusedExprAllocator;
+    res = MatExpr(&g_MatOp_Fused, 0, p->inputs[0], Mat(), holder, 1, 0);
+    return true;
+}
+
+bool MatOp_Fused::makeExpr(MatExpr& res, int op, const MatExpr& e1, const MatExpr& e2, double scale)
+{
+    if( !useOptimized() || !isFusable(e1) || !isFusable(e2) )
+        return false;
+
+    FusedExprProgram* p = new FusedExprProgram;
+    if( op == FUSE_SUM )
+    {
+        FusedExprProgram::Terms terms;
+        Scalar s;
+        p->addTerms(e1, 1, terms, s);
+        p->addTerms(e2, scale, terms, s);
+        p->addSum(terms, s);
+    }
+    else
+    {
+        FusedExprNode node(op);
+        node.nargs = 2;
+        node.args[0] = p->addExpr(e1);
+        node.args[1] = p->addExpr(e2);
+        node.alpha = scale;
+        p->addNode(node);
+    }
+    return makeFusedExpr(res, p);
+}
+
+bool MatOp_Fused::makeExpr(MatExpr& res, int op, const MatExpr& e, double alpha, const Scalar& s)
+{
+    if( !useOptimized() || !isFusable(e) )
+        return false;
+
+    FusedExprProgram* p = new FusedExprProgram;
+    if( op == FUSE_SUM )
+    {
+        FusedExprProgram::Terms terms;
+        Scalar s1 = s;
+        p->addTerms(e, alpha, terms, s1);
+        p->addSum(terms, s1);
+    }
+    else
+    {
+        FusedExprNode node(op);
+        node.nargs = 1;
+        node.args[0] = p->addExpr(e);
+        node.alpha = alpha;
+        node.s = s;
+        p->addNode(node);
+    }
+    return makeFusedExpr(res, p);
+}
+
+bool MatOp_Fused::makeCmp(MatExpr& res, int cmpop, const MatExpr& e, double alpha)
+{
+    if( !useOptimized() || !isFusable(e) )
+        return false;
+
+    FusedExprProgram* p = new FusedExprProgram;
+    FusedExprNode node(FUSE_CMP);
+    node.nargs = 1;
+    node.args[0] = p->addExpr(e);
+    node.cmpop = cmpop;
+    node.alpha = alpha;
+    p->addNode(node);
+    return makeFusedExpr(res, p);
+}
+
+void MatOp_Fused::roi(const MatExpr& e, const Range& rowRange, const Range& colRange, MatExpr& res) const
+{
+    FusedExprProgram* p = new FusedExprProgram(*fusedProgram(e));
+    for( size_t i = 0; i < p->inputs.size(); i++ )
+        p->inputs[i] = p->inputs[i](rowRange, colRange);
+    makeFusedExpr(res, p);
+}
+
+void MatOp_Fused::diag(const MatExpr& e, int d, MatExpr& res) const
+{
+    FusedExprProgram* p = new FusedExprProgram(*fusedProgram(e));
+    for( size_t i = 0; i < p->inputs.size(); i++ )
+        p->inputs[i] = p->inputs[i].diag(d);
+    makeFusedExpr(res, p);
+}
+
+int MatOp_Fused::type(const MatExpr& e) const
+{
+    const FusedExprProgram& p = *fusedProgram(e);
+    return p.isMask() ? CV_8UC(p.inputs[0].channels()) : p.inputs[0].type();
+}
+
+/////////////////////////////// the element-wise kernels of MatOp_Fused ///////////////////////////////////
+
+// d = x*a + y*b + s; y and s are optional
+template<typename WT> static void
+fusedScaleAdd( const WT* x, WT a, const WT* y, WT b, const WT* s, WT* d, int len )
+{
+    int j = 0;
+    for( ; j < len; j++ )
+    {
+        WT v = x[j]*a;
+        if( y )
+            v += y[j]*b;
+        if( s )
+            v += s[j];
+        d[j] = v;
+    }
+}
+
+static void fusedScaleAdd( const float* x, float a, const float* y, float b, const float* s, float* d, int len )
+{
+    int j = 0;
+#if CV_SSE2
+    if( USE_SSE2 )
+    {
+        __m128 va = _mm_set1_ps(a), vb = _mm_set1_ps(b);
+        for( ; j <= len - 8; j += 8 )
+        {
+            __m128 v0 = _mm_mul_ps(_mm_loadu_ps(x + j), va);
+            __m128 v1 = _mm_mul_ps(_mm_loadu_ps(x + j + 4), va);
+            if( y )
+            {
+                v0 = _mm_add_ps(v0, _mm_mul_ps(_mm_loadu_ps(y + j), vb));
+                v1 = _mm_add_ps(v1, _mm_mul_ps(_mm_loadu_ps(y + j + 4), vb));
+            }
+            if( s )
+            {
+                v0 = _mm_add_ps(v0, _mm_loadu_ps(s + j));
+                v1 = _mm_add_ps(v1, _mm_loadu_ps(s + j + 4));
+            }
+            _mm_storeu_ps(d + j, v0);
+            _mm_storeu_ps(d + j + 4, v1);
+        }
+    }
+#endif
+    for( ; j < len; j++ )
+    {
+        float v = x[j]*a;
+        if( y )
+            v += y[j]*b;
+        if( s )
+            v += s[j];
+        d[j] = v;
+    }
+}
+
+// d = src[0]*a[0] + ... + src[n-1]*a[n-1] + s, computed right from the 8u data;
+// the terms are summed in the same order as by fusedScaleAdd
+template<typename WT> static void
+fusedScaleAdd8u( const uchar** src, const WT* a, int n, const WT* s, WT* d, int len )
+{
+    for( int j = 0; j < len; j++ )
+    {
+        WT v = src[0][j]*a[0];
+        for( int k = 1; k < n; k++ )
+            v += src[k][j]*a[k];
+        if( s )
+            v += s[j];
+        d[j] = v;
+    }
+}
+
+static void fusedScaleAdd8u( const uchar** src, const float* a, int n, const float* s, float* d, int len )
+{
+    int j = 0, k;
+#if CV_SSE2
+    if( USE_SSE2 )
+    {
+        __m128i z = _mm_setzero_si128();
+        for( ; j <= len - 8; j += 8 )
+        {
+            __m128 v0 = _mm_setzero_ps(), v1 = v0;
+            for( k = 0; k < n; k++ )
+            {
+                __m128i v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(src[k] + j)), z);
+                __m128 va = _mm_set1_ps(a[k]);
+                __m128 t0 = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(v, z)), va);
+                __m128 t1 = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(v, z)), va);
+                v0 = k == 0 ? t0 : _mm_add_ps(v0, t0);
+                v1 = k == 0 ? t1 : _mm_add_ps(v1, t1);
+            }
+            if( s )
+            {
+                v0 = _mm_add_ps(v0, _mm_loadu_ps(s + j));
+                v1 = _mm_add_ps(v1, _mm_loadu_ps(s + j + 4));
+            }
+            _mm_storeu_ps(d + j, v0);
+            _mm_storeu_ps(d + j + 4, v1);
+        }
+    }
+#endif
+    for( ; j < len; j++ )
+    {
+        float v = src[0][j]*a[0];
+        for( k = 1; k < n; k++ )
+            v += src[k][j]*a[k];
+        if( s )
+            v += s[j];
+        d[j] = v;
+    }
+}
+
+enum { FUSED_FIXED_BITS = 14 };
+
+// d = saturate((src[0]*a[0] + ... + src[n-1]*a[n-1] + s) >> FUSED_FIXED_BITS), the fixed-point
+// variant of fusedScaleAdd8u for the 8u weighted sums, like addWeighted, stored right to 8u.
+// s includes the 1/2 rounding term; the halves are then rounded to even, as cvRound does.
+// The terms are added in pairs with _mm_madd_epi16.
+static void fusedScaleAdd8uFixed( const uchar** src, const short* a, int n, const int* s, uchar* d, int len )
+{
+    const int frac_mask = (1 << FUSED_FIXED_BITS) - 1;
+    int j = 0, k;
+#if CV_SSE2
+    if( USE_SSE2 )
+    {
+        __m128i z = _mm_setzero_si128(), one = _mm_set1_epi32(1), vmask = _mm_set1_epi32(frac_mask);
+        __m128i va[FUSED_MAX_TERMS/2];
+        for( k = 0; k < n; k += 2 )
+            va[k/2] = _mm_set1_epi32((int)(((k + 1 < n ? (unsigned)(ushort)a[k+1] : 0u) << 16) | (ushort)a[k]));
+        for( ; j <= len - 8; j += 8 )
+        {
+            __m128i v0 = _mm_loadu_si128((const __m128i*)(s + j));
+            __m128i v1 = _mm_loadu_si128((const __m128i*)(s + j + 4));
+            for( k = 0; k < n; k += 2 )
+            {
+                __m128i x = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(src[k] + j)), z);
+                __m128i y = k + 1 < n ? _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(src[k+1] + j)), z) : z;
+                v0 = _mm_add_epi32(v0, _mm_madd_epi16(_mm_unpacklo_epi16(x, y), va[k/2]));
+                v1 = _mm_add_epi32(v1, _mm_madd_epi16(_mm_unpackhi_epi16(x, y), va[k/2]));
+            }
+            // the zero fraction after adding 1/2 means the exact half, then the lowest bit is cleared
+            __m128i h0 = _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(v0, vmask), z), one);
+            __m128i h1 = _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(v1, vmask), z), one);
+            v0 = _mm_andnot_si128(h0, _mm_srai_epi32(v0, FUSED_FIXED_BITS));
+            v1 = _mm_andnot_si128(h1, _mm_srai_epi32(v1, FUSED_FIXED_BITS));
+            v0 = _mm_packs_epi32(v0, v1);
+            _mm_storel_epi64((__m128i*)(d + j), _mm_packus_epi16(v0, v0));
+        }
+    }
+#endif
+    for( ; j < len; j++ )
+    {
+        int v = s[j];
+        for( k = 0; k < n; k++ )
+            v += src[k][j]*a[k];
+        int q = v >> FUSED_FIXED_BITS;
+        d[j] = saturate_cast<uchar>((v & frac_mask) == 0 ? q & ~1 : q);
+    }
+}
+
+template<typename WT> static void
+fusedMul( const WT* x, const WT* y, WT scale, WT* d, int len )
+{
+    for( int j = 0; j < len; j++ )
+        d[j] = x[j]*y[j]*scale;
+}
+
+static void fusedMul( const float* x, const float* y, float scale, float* d, int len )
+{
+    int j = 0;
+#if CV_SSE2
+    if( USE_SSE2 )
+    {
+        __m128 vs = _mm_set1_ps(scale);
+        for( ; j <= len - 4; j += 4 )
+            _mm_storeu_ps(d + j, _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(x + j), _mm_loadu_ps(y + j)), vs));
+    }
+#endif
+    for( ; j < len; j++ )
+        d[j] = x[j]*y[j]*scale;
+}
+
+// d = x*scale/y or scale/y when x is NULL; the division by 0 gives 0, as in cv::divide
+template<typename WT> static void
+fusedDiv( const WT* x, const WT* y, WT scale, WT* d, int len )
+{
+    for( int j = 0; j < len; j++ )
+        d[j] = y[j] != 0 ? (x ? x[j] : (WT)1)*scale/y[j] : (WT)0;
+}
+
+static void fusedDiv( const float* x, const float* y, float scale, float* d, int len )
+{
+    int j = 0;
+#if CV_SSE2
+    if( USE_SSE2 )
+    {
+        __m128 vs = _mm_set1_ps(scale), z = _mm_setzero_ps();
+        for( ; j <= len - 4; j += 4 )
+        {
+            __m128 vy = _mm_loadu_ps(y + j);
+            __m128 vx = x ? _mm_mul_ps(_mm_loadu_ps(x + j), vs) : vs;
+            _mm_storeu_ps(d + j, _mm_and_ps(_mm_div_ps(vx, vy), _mm_cmpneq_ps(vy, z)));
+        }
+    }
+#endif
+    for( ; j < len; j++ )
+        d[j] = y[j] != 0 ? (x ? x[j] : 1.f)*scale/y[j] : 0.f;
+}
+
+// d = |x - y| or |x - s| when y is NULL
+template<typename WT> static void
+fusedAbsDiff( const WT* x, const WT* y, const WT* s, WT* d, int len )
+{
+    const WT* y1 = y ? y : s;
+    for( int j = 0; j < len; j++ )
+        d[j] = std::abs(x[j] - y1[j]);
+}
+
+static void fusedAbsDiff( const float* x, const float* y, const float* s, float* d, int len )
+{
+    const float* y1 = y ? y : s;
+    int j = 0;
+#if CV_SSE2
+    if( USE_SSE2 )
+    {
+        __m128 absmask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+        for( ; j <= len - 4; j += 4 )
+            _mm_storeu_ps(d + j, _mm_and_ps(_mm_sub_ps(_mm_loadu_ps(x + j), _mm_loadu_ps(y1 + j)), absmask));
+    }
+#endif
+    for( ; j < len; j++ )
+        d[j] = std::abs(x[j] - y1[j]);
+}
+
+// d = min(x, y) or max(x, y); y is the constant a when it is NULL
+template<typename WT> static void
+fusedMinMax( const WT* x, const WT* y, WT a, WT* d, int len, bool isMax )
+{
+    for( int j = 0; j < len; j++ )
+    {
+        WT v = y ? y[j] : a;
+        d[j] = isMax ? std::max(x[j], v) : std::min(x[j], v);
+    }
+}
+
+static void fusedMinMax( const float* x, const float* y, float a, float* d, int len, bool isMax )
+{
+    int j = 0;
+#if CV_SSE2
+    if( USE_SSE2 )
+    {
+        __m128 va = _mm_set1_ps(a);
+        for( ; j <= len - 4; j += 4 )
+        {
+            __m128 vx = _mm_loadu_ps(x + j), vy = y ? _mm_loadu_ps(y + j) : va;
+            _mm_storeu_ps(d + j, isMax ? _mm_max_ps(vx, vy) : _mm_min_ps(vx, vy));
+        }
+    }
+#endif
+    for( ; j < len; j++ )
+    {
+        float v = y ? y[j] : a;
+        d[j] = isMax ? std::max(x[j], v) : std::min(x[j], v);
+    }
+}
+
+template<typename WT> static inline bool fusedCmp1( WT x, WT a, int cmpop )
+{
+    switch( cmpop )
+    {
+    case CMP_EQ: return x == a;
+    case CMP_GT: return x > a;
+    case CMP_GE: return x >= a;
+    case CMP_LT: return x < a;
+    case CMP_LE: return x <= a;
+    default: return x != a;
+    }
+}
+
+template<typename WT> static void
+fusedCmp( const WT* x, WT a, int cmpop, uchar* d, int len )
+{
+    for( int j = 0; j < len; j++ )
+        d[j] = fusedCmp1(x[j], a, cmpop) ? (uchar)255 : (uchar)0;
+}
+
+static void fusedCmp( const float* x, float a, int cmpop, uchar* d, int len )
+{
+    int j = 0;
+#if CV_SSE2
+    if( USE_SSE2 )
+    {
+        __m128 va = _mm_set1_ps(a);
+        __m128i inv = _mm_set1_epi32(cmpop == CMP_NE ? -1 : 0);
+        for( ; j <= len - 8; j += 8 )
+        {
+            __m128 v0 = _mm_loadu_ps(x + j), v1 = _mm_loadu_ps(x + j + 4), m0, m1;
+            switch( cmpop )
+            {
+            case CMP_GT: m0 = _mm_cmpgt_ps(v0, va); m1 = _mm_cmpgt_ps(v1, va); break;
+            case CMP_GE: m0 = _mm_cmpge_ps(v0, va); m1 = _mm_cmpge_ps(v1, va); break;
+            case CMP_LT: m0 = _mm_cmplt_ps(v0, va); m1 = _mm_cmplt_ps(v1, va); break;
+            case CMP_LE: m0 = _mm_cmple_ps(v0, va); m1 = _mm_cmple_ps(v1, va); break;
+            default: m0 = _mm_cmpeq_ps(v0, va); m1 = _mm_cmpeq_ps(v1, va);
+            }
+            __m128i m = _mm_packs_epi32(_mm_castps_si128(m0), _mm_castps_si128(m1));
+            m = _mm_xor_si128(m, inv);
+            _mm_storel_epi64((__m128i*)(d + j), _mm_packs_epi16(m, m));
+        }
+    }
+#endif
+    for( ; j < len; j++ )
+        d[j] = fusedCmp1(x[j], a, cmpop) ? (uchar)255 : (uchar)0;
+}
+
+template<typename T, typename WT> static void
+fusedLoad_( const T* src, WT* d, int len )
+{
+    for( int j = 0; j < len; j++ )
+        d[j] = (WT)src[j];
+}
+
+static void fusedLoad_( const uchar* src, float* d, int len )
+{
+    int j = 0;
+#if CV_SSE2
+    if( USE_SSE2 )
+    {
+        __m128i z = _mm_setzero_si128();
+        for( ; j <= len - 16; j += 16 )
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(src + j));
+            __m128i v0 = _mm_unpacklo_epi8(v, z), v1 = _mm_unpackhi_epi8(v, z);
+            _mm_storeu_ps(d + j, _mm_cvtepi32_ps(_mm_unpacklo_epi16(v0, z)));
+            _mm_storeu_ps(d + j + 4, _mm_cvtepi32_ps(_mm_unpackhi_epi16(v0, z)));
+            _mm_storeu_ps(d + j + 8, _mm_cvtepi32_ps(_mm_unpacklo_epi16(v1, z)));
+            _mm_storeu_ps(d + j + 12, _mm_cvtepi32_ps(_mm_unpackhi_epi16(v1, z)));
+        }
+    }
+#endif
+    for( ; j < len; j++ )
+        d[j] = (float)src[j];
+}
+
+template<typename WT> static void
+fusedLoad( const uchar* src, int depth, WT* d, int len )
+{
+    switch( depth )
+    {
+    case CV_8U: fusedLoad_(src, d, len); break;
+    case CV_8S: fusedLoad_((const schar*)src, d, len); break;
+    case CV_16U: fusedLoad_((const ushort*)src, d, len); break;
+    case CV_16S: fusedLoad_((const short*)src, d, len); break;
+    case CV_32S: fusedLoad_((const int*)src, d, len); break;
+    case CV_32F: fusedLoad_((const float*)src, d, len); break;
+    default: fusedLoad_((const double*)src, d, len);
+    }
+}
+
+template<typename WT, typename T> static void
+fusedStore_( const WT* src, T* d, int len )
+{
+    for( int j = 0; j < len; j++ )
+        d[j] = saturate_cast<T>(src[j]);
+}
+
+static void fusedStore_( const float* src, uchar* d, int len )
+{
+    int j = 0;
+#if CV_SSE2
+    if( USE_SSE2 )
+    {
+        for( ; j <= len - 16; j += 16 )
+        {
+            __m128i v0 = _mm_cvtps_epi32(_mm_loadu_ps(src + j));
+            __m128i v1 = _mm_cvtps_epi32(_mm_loadu_ps(src + j + 4));
+            __m128i v2 = _mm_cvtps_epi32(_mm_loadu_ps(src + j + 8));
+            __m128i v3 = _mm_cvtps_epi32(_mm_loadu_ps(src + j + 12));
+            v0 = _mm_packs_epi32(v0, v1);
+            v2 = _mm_packs_epi32(v2, v3);
+            _mm_storeu_si128((__m128i*)(d + j), _mm_packus_epi16(v0, v2));
+        }
+    }
+#endif
+    for( ; j < len; j++ )
+        d[j] = saturate_cast<uchar>(src[j]);
+}
+
+template<typename WT> static void
+fusedStore( const WT* src, uchar* d, int depth, int len )
+{
+    switch( depth )
+    {
+    case CV_8U: fusedStore_(src, d, len); break;
+    case CV_8S: fusedStore_(src, (schar*)d, len); break;
+    case CV_16U: fusedStore_(src, (ushort*)d, len); break;
+    case CV_16S: fusedStore_(src, (short*)d, len); break;
+    case CV_32S: fusedStore_(src, (int*)d, len); break;
+    case CV_32F: fusedStore_(src, (float*)d, len); break;
+    default: fusedStore_(src, (double*)d, len);
+    }
+}
+
+// abs(a - b) compared with a threshold for 8u matrices: d = lo <= |a - b| <= hi ? 255 : 0
+static void absDiffRange8u( const uchar* a, const uchar* b, uchar* d, int len, int lo, int hi )
+{
+    int j = 0;
+#if CV_SSE2
+    if( USE_SSE2 )
+    {
+        __m128i vlo = _mm_set1_epi8((char)lo), vhi = _mm_set1_epi8((char)hi);
+        for( ; j <= len - 16; j += 16 )
+        {
+            __m128i va = _mm_loadu_si128((const __m128i*)(a + j));
+            __m128i vb = _mm_loadu_si128((const __m128i*)(b + j));
+            __m128i v = _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va));
+            __m128i m = _mm_and_si128(_mm_cmpeq_epi8(_mm_max_epu8(v, vlo), v),
+                                      _mm_cmpeq_epi8(_mm_min_epu8(v, vhi), v));
+            _mm_storeu_si128((__m128i*)(d + j), m);
+        }
+    }
+#endif
+    for( ; j < len; j++ )
+    {
+        int v = std::abs(a[j] - b[j]);
+        d[j] = lo <= v && v <= hi ? (uchar)255 : (uchar)0;
+    }
+}
+
+// finds the range of abs(a - b) values, for which the comparison with the threshold is true
+static bool absDiffRange( int cmpop, double t, int& lo, int& hi )
+{
+    t = std::min(std::max(t, -1.), 256.);
+    switch( cmpop )
+    {
+    case CMP_GT: lo = cvFloor(t) + 1; hi = 255; break;
+    case CMP_GE: lo = cvCeil(t); hi = 255; break;
+    case CMP_LT: lo = 0; hi = cvCeil(t) - 1; break;
+    case CMP_LE: lo = 0; hi = cvFloor(t); break;
+    default: return false;
+    }
+    lo = std::max(lo, 0);
+    hi = std::min(hi, 255);
+    if( lo > hi )
+        lo = 1, hi = 0;
+    return true;
+}
+
+template<typename WT> class FusedExprInvoker : public ParallelLoopBody
+{
+public:
+    FusedExprInvoker(const FusedExprProgram& _p, Mat& _dst, int rows, int _rowlen)
+        : p(&_p), dst(&_dst), rowlen(_rowlen), fixedSum(false), absdiffRange(false), lo(0), hi(0)
+    {
+        const Mat& m0 = p->inputs[0];
+        int cn = m0.channels();
+        sdepth = m0.depth();
+        blocklen = (FUSED_BLOCK_SIZE/cn)*cn;
+        nblocks = (rowlen + blocklen - 1)/blocklen;
+        ntotal = rows*nblocks;
+
+        // the per-channel scalars are unrolled to the block length
+        size_t i, nnodes = p->nodes.size();
+        consts.resize(nnodes*blocklen);
+        for( i = 0; i < nnodes; i++ )
+        {
+            const FusedExprNode& node = p->nodes[i];
+            if( node.op == FUSE_SUM || (node.op == FUSE_ABSDIFF && node.nargs == 1) )
+                for( int j = 0; j < blocklen; j++ )
+                    consts[i*blocklen + j] = (WT)node.s[j % cn];
+        }
+
+        // the sums of 8u inputs read the source data directly,
+        // and the inputs used only by such sums are not converted at all
+        direct.resize(nnodes, (uchar)0);
+        convert.resize(nnodes, (uchar)0);
+        convert[nnodes-1] = 1;
+        for( i = 0; i < nnodes; i++ )
+        {
+            const FusedExprNode& node = p->nodes[i];
+            if( node.op == FUSE_INPUT )
+                continue;
+            bool isDirect = sdepth == CV_8U && node.op == FUSE_SUM && node.nargs > 0;
+            for( int k = 0; k < node.nargs; k++ )
+                isDirect = isDirect && p->nodes[node.args[k]].op == FUSE_INPUT;
+            direct[i] = isDirect;
+            for( int k = 0; k < node.nargs && !isDirect; k++ )
+                convert[node.args[k]] = 1;
+        }
+
+        // a weighted sum of 8u inputs, stored to 8u, is computed in fixed-point
+        const FusedExprNode& root = p->nodes[nnodes-1];
+        double maxShift = 0;
+        for( int c = 0; c < cn; c++ )
+            maxShift = std::max(maxShift, std::abs(root.s[c]));
+        fixedSum = direct[nnodes-1] && dst->depth() == CV_8U &&
+            (size_t)root.nargs == nnodes - 1 && maxShift < (1 << 16);
+        for( int k = 0; k < root.nargs && fixedSum; k++ )
+        {
+            fixedSum = std::abs(root.coeffs[k]) < 1.99;
+            icoeffs[k] = (short)cvRound(root.coeffs[k]*(1 << FUSED_FIXED_BITS));
+        }
+        if( fixedSum )
+        {
+            ishift.resize(blocklen);
+            for( int j = 0; j < blocklen; j++ )
+                ishift[j] = cvRound(root.s[j % cn]*(1 << FUSED_FIXED_BITS)) + (1 << (FUSED_FIXED_BITS - 1));
+        }
+
+        // abs(a - b) > t and alike for 8u matrices are computed without the conversion to float
+        if( sdepth == CV_8U && nnodes == 4 && p->nodes[0].op == FUSE_INPUT && p->nodes[1].op == FUSE_INPUT &&
+            p->nodes[2].op == FUSE_ABSDIFF && p->nodes[2].nargs == 2 &&
+            p->nodes[3].op == FUSE_CMP && p->nodes[3].args[0] == 2 )
+            absdiffRange = absDiffRange(p->nodes[3].cmpop, p->nodes[3].alpha, lo, hi);
+    }
+
+    int blocks() const { return ntotal; }
+
+    void operator()(const Range& range) const
+    {
+        size_t nnodes = p->nodes.size(), esz1 = CV_ELEM_SIZE1(sdepth);
+        int ddepth = dst->depth();
+        AutoBuffer<WT> _buf(nnodes*blocklen + 16);
+        WT* buf = alignPtr((WT*)_buf, 16);
+        AutoBuffer<const WT*> _regs(nnodes);
+        const WT** regs = _regs;
+        AutoBuffer<const uchar*> _srcs(nnodes);
+        const uchar** srcs = _srcs;
+
+        for( int bi = range.start; bi < range.end; bi++ )
+        {
+            int y = bi/nblocks, x = (bi - y*nblocks)*blocklen, len = std::min(blocklen, rowlen - x);
+            uchar* dptr = dst->ptr(y) + x*CV_ELEM_SIZE1(ddepth);
+
+            if( absdiffRange )
+            {
+                const FusedExprNode& node = p->nodes[2];
+                const uchar* a = p->inputs[p->nodes[node.args[0]].args[0]].ptr(y) + x;
+                const uchar* b = p->inputs[p->nodes[node.args[1]].args[0]].ptr(y) + x;
+                absDiffRange8u(a, b, dptr, len, lo, hi);
+                continue;
+            }
+
+            if( fixedSum )
+            {
+                const FusedExprNode& node = p->nodes[nnodes-1];
+                const uchar* src[FUSED_MAX_TERMS];
+                for( int k = 0; k < node.nargs; k++ )
+                    src[k] = p->inputs[p->nodes[node.args[k]].args[0]].ptr(y) + x;
+                fusedScaleAdd8uFixed(src, icoeffs, node.nargs, &ishift[0], dptr, len);
+                continue;
+            }
+
+            for( size_t i = 0; i < nnodes; i++ )
+            {
+                const FusedExprNode& node = p->nodes[i];
+                const WT* c = &consts[i*blocklen];
+                WT* d = buf + i*blocklen;
+                const WT* a0 = node.nargs > 0 && node.op != FUSE_INPUT ? regs[node.args[0]] : 0;
+                const WT* a1 = node.nargs > 1 ? regs[node.args[1]] : 0;
+
+                switch( node.op )
+                {
+                case FUSE_INPUT:
+                    {
+                    const uchar* sptr = p->inputs[node.args[0]].ptr(y) + x*esz1;
+                    srcs[i] = sptr;
+                    if( sdepth == DataType<WT>::depth )
+                        d = (WT*)sptr;
+                    else if( convert[i] )
+                        fusedLoad(sptr, sdepth, d, len);
+                    }
+                    break;
+                case FUSE_SUM:
+                    {
+                    // the shift is added after all the terms
+                    const WT* shift = node.s == Scalar() ? (const WT*)0 : c;
+                    if( direct[i] )
+                    {
+                        const uchar* src[FUSED_MAX_TERMS];
+                        WT coeffs[FUSED_MAX_TERMS];
+                        for( int k = 0; k < node.nargs; k++ )
+                        {
+                            src[k] = srcs[node.args[k]];
+                            coeffs[k] = (WT)node.coeffs[k];
+                        }
+                        fusedScaleAdd8u(src, coeffs, node.nargs, shift, d, len);
+                        break;
+                    }
+                    fusedScaleAdd(a0, (WT)node.coeffs[0], a1, (WT)node.coeffs[1],
+                                  node.nargs <= 2 ? shift : (const WT*)0, d, len);
+                    for( int k = 2; k < node.nargs; k++ )
+                        fusedScaleAdd(regs[node.args[k]], (WT)node.coeffs[k], (const WT*)d, (WT)1,
+                                      k == node.nargs - 1 ? shift : (const WT*)0, d, len);
+                    }
+                    break;
+                case FUSE_MUL:
+                    fusedMul(a0, a1, (WT)node.alpha, d, len);
+                    break;
+                case FUSE_DIV:
+                    if( a1 )
+                        fusedDiv(a0, a1, (WT)node.alpha, d, len);
+                    else
+                        fusedDiv((const WT*)0, a0, (WT)node.alpha, d, len);
+                    break;
+                case FUSE_ABSDIFF:
+                    fusedAbsDiff(a0, a1, c, d, len);
+                    break;
+                case FUSE_MIN:
+                case FUSE_MAX:
+                    fusedMinMax(a0, a1, (WT)node.alpha, d, len, node.op == FUSE_MAX);
+                    break;
+                default:
+                    // the comparison can only be the last node
+                    fusedCmp(a0, (WT)node.alpha, node.cmpop, dptr, len);
+                }
+                regs[i] = d;
+            }
+
+            if( !p->isMask() )
+                fusedStore(regs[nnodes-1], dptr, ddepth, len);
+        }
+    }
+
+protected:
+    const FusedExprProgram* p;
+    Mat* dst;
+    int rowlen, blocklen, nblocks, ntotal, sdepth;
+    vector<WT> consts;
+    vector<uchar> direct, convert;
+    bool fixedSum;
+    short icoeffs[FUSED_MAX_TERMS];
+    vector<int> ishift;
+    bool absdiffRange;
+    int lo, hi;
+};
+
+template<typename WT> static void
+runFusedExpr( const FusedExprProgram& p, Mat& dst, int rows, int rowlen )
+{
+    FusedExprInvoker<WT> body(p, dst, rows, rowlen);
+    size_t total = (size_t)rows*rowlen;
+    if( total < FUSED_PARALLEL_MIN )
+        body(Range(0, body.blocks()));
+    else
+        parallel_for_(Range(0, body.blocks()), body, (double)total/FUSED_PARALLEL_MIN);
+}
+
+void MatOp_Fused::assign(const MatExpr& e, Mat& m, int _type) const
+{
+    const FusedExprProgram& p = *fusedProgram(e);
+    int stype = p.inputs[0].type(), cn = CV_MAT_CN(stype), sdepth = CV_MAT_DEPTH(stype);
+    int ddepth = p.isMask() ? CV_8U : _type < 0 ? sdepth : CV_MAT_DEPTH(_type);
+
+    if( _type >= 0 && CV_MAT_DEPTH(_type) != ddepth )
+    {
+        Mat temp;
+        assign(e, temp);
+        temp.convertTo(m, _type);
+        return;
+    }
+    CV_Assert( _type < 0 || CV_MAT_CN(_type) == cn );
+
+    // if m is one of the inputs and is reallocated, the program still holds the input data
+    m.create(p.inputs[0].dims, p.inputs[0].size, CV_MAKETYPE(ddepth, cn));
+
+    bool continuous = m.isContinuous();
+    for( size_t i = 0; i < p.inputs.size(); i++ )
+        continuous = continuous && p.inputs[i].isContinuous();
+    int rows = continuous ? 1 : m.rows, rowlen = (continuous ? (int)m.total() : m.cols)*cn;
+
+    if( sdepth == CV_32S || sdepth == CV_64F )
+        runFusedExpr<double>(p, m, rows, rowlen);
+    else
+        runFusedExpr<float>(p, m, rows, rowlen);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 MatExpr Mat::t() const
@@ -180,6 +180,18 @@ static void finalizeHdr(Mat& m)
 }
 
 
+static MatAllocator* defaultAllocator = 0;
+
+void Mat::setDefaultAllocator(MatAllocator* allocator)
+{
+    defaultAllocator = allocator;
+}
+
+MatAllocator* Mat::getDefaultAllocator()
+{
+    return defaultAllocator;
+}
+
 void Mat::create(int d, const int* _sizes, int _type)
 {
     int i;
@@ -208,6 +220,8 @@ void Mat::create(int d, const int* _sizes, int _type)
 #ifdef HAVE_TGPU
         if( !allocator || allocator == tegra::getAllocator() ) allocator = tegra::getAllocator(d, _sizes, _type);
 #endif
+        if( !allocator )
+            allocator = defaultAllocator;
         if( !allocator )
         {
             size_t totalsize = alignSize(step.p[0]*size.p[0], (int)sizeof(*refcount));
@@ -261,6 +275,90 @@ void Mat::deallocate()
     }
 }
 
+/*
+   The reference counter of the external data is kept in a separate block together with the
+   deleter; Mat::refcount points to the first field of the block, which is how the allocator
+   finds the deleter when the last reference is released.
+*/
+struct ExternalMatData
+{
+    int refcount;
+    MatDataDeleter deleter;
+    void* userdata;
+};
+
+static void freeExternalMatData(void* data, void*)
+{
+    fastFree(data);
+}
+
+class ExternalMatAllocator : public MatAllocator
+{
+public:
+    // only called when the matrix that owned the external data is re-created
+    // with a different size or type; the new data is then allocated as usual
+    void allocate(int dims, const int* sizes, int type, int*& refcount,
+                  uchar*& datastart, uchar*& data, size_t* step)
+    {
+        size_t total = CV_ELEM_SIZE(type);
+        for( int i = dims-1; i >= 0; i-- )
+        {
+            step[i] = total;
+            total *= sizes[i];
+        }
+        datastart = data = (uchar*)fastMalloc(total);
+        refcount = attach(freeExternalMatData, 0);
+    }
+
+    void deallocate(int* refcount, uchar* datastart, uchar*)
+    {
+        ExternalMatData* ext = (ExternalMatData*)refcount;
+        if( ext->deleter )
+            ext->deleter(datastart, ext->userdata);
+        delete ext;
+    }
+
+    static int* attach(MatDataDeleter deleter, void* userdata)
+    {
+        ExternalMatData* ext = new ExternalMatData;
+        ext->refcount = 1;
+        ext->deleter = deleter;
+        ext->userdata = userdata;
+        return &ext->refcount;
+    }
+};
+
+static void setExternalOwner(Mat& m, MatDataDeleter deleter, void* userdata)
+{
+    static ExternalMatAllocator externalAllocator;
+    m.refcount = ExternalMatAllocator::attach(deleter, userdata);
+    m.allocator = &externalAllocator;
+}
+
+Mat::Mat(int _rows, int _cols, int _type, void* _data, size_t _step,
+         MatDataDeleter deleter, void* userdata) : size(&rows)
+{
+    initEmpty();
+    *this = Mat(_rows, _cols, _type, _data, _step);
+    setExternalOwner(*this, deleter, userdata);
+}
+
+Mat::Mat(Size _sz, int _type, void* _data, size_t _step,
+         MatDataDeleter deleter, void* userdata) : size(&rows)
+{
+    initEmpty();
+    *this = Mat(_sz, _type, _data, _step);
+    setExternalOwner(*this, deleter, userdata);
+}
+
+Mat::Mat(int _dims, const int* _sizes, int _type, void* _data, const size_t* _steps,
+         MatDataDeleter deleter, void* userdata) : size(&rows)
+{
+    initEmpty();
+    *this = Mat(_dims, _sizes, _type, _data, _steps);
+    setExternalOwner(*this, deleter, userdata);
+}
+
 
 Mat::Mat(const Mat& m, const Range& _rowRange, const Range& _colRange) : size(&rows)
 {
@@ -40,15 +40,31 @@
 //
 //M*/
 
+
 #include "precomp.hpp"
 
+#if !(defined WIN32 || defined _WIN32 || defined WINCE) && defined HAVE_LIBPTHREAD
+#  define HAVE_THREAD_POOL
+#  include <pthread.h>
+#endif
+
 #ifdef HAVE_CONCURRENCY
 #  include <ppl.h>
-#elif defined HAVE_OPENMP
+#endif
+
+#if defined _OPENMP && !defined HAVE_OPENMP
+#  define HAVE_OPENMP
+#endif
+
+#ifdef HAVE_OPENMP
 #  include <omp.h>
-#elif defined HAVE_GCD
+#endif
+
+#ifdef HAVE_GCD
 #  include <dispatch/dispatch.h>
-#elif defined HAVE_TBB
+#endif
+
+#ifdef HAVE_TBB
 #  include "tbb/tbb_stddef.h"
 #  if TBB_VERSION_MAJOR*100 + TBB_VERSION_MINOR >= 202
 #    include "tbb/tbb.h"
@@ -58,72 +74,599 @@
 #  else
 #    undef HAVE_TBB
 #  endif // end TBB version
-#endif // HAVE_CONCURRENCY
+#endif // HAVE_TBB
 
 /*
+    HAVE_THREAD_POOL - using the built-in pthreads-based work-stealing pool
     HAVE_TBB - using TBB
     HAVE_GCD - using GCD
     HAVE_OPENMP - using OpenMP
     HAVE_CONCURRENCY - using visual studio 2010 concurrency
+
+    Every backend that is available at compile time can be selected at runtime with
+    setParallelBackend(). By default the first of TBB, Concurrency, OpenMP, GCD that
+    the library was configured with is used, and the built-in pool otherwise.
 */
 
 namespace cv
 {
     ParallelLoopBody::~ParallelLoopBody() { }
 
-#ifdef HAVE_TBB
-    class TbbProxyLoopBody
+    // maps the indices of [0, nstripes) to the consecutive subranges of the user range
+    class ParallelLoopBodyWrapper
     {
     public:
-        TbbProxyLoopBody(const ParallelLoopBody& _body) :
-            body(&_body)
-        { }
+        ParallelLoopBodyWrapper(const ParallelLoopBody& _body, const Range& _r, double _nstripes)
+        {
+            body = &_body;
+            wholeRange = _r;
+            double len = wholeRange.end - wholeRange.start;
+            nstripes = cvRound(_nstripes <= 0 ? len : MIN(MAX(_nstripes, 1.), len));
+        }
+
+        void operator()(const Range& sr) const
+        {
+            Range r;
+            r.start = (int)(wholeRange.start +
+                            ((int64)sr.start*(wholeRange.end - wholeRange.start) + nstripes/2)/nstripes);
+            r.end = sr.end >= nstripes ? wholeRange.end : (int)(wholeRange.start +
+                            ((int64)sr.end*(wholeRange.end - wholeRange.start) + nstripes/2)/nstripes);
+            (*body)(r);
+        }
 
+        Range stripeRange() const { return Range(0, nstripes); }
+
+    protected:
+        const ParallelLoopBody* body;
+        Range wholeRange;
+        int nstripes;
+    };
+
+#if defined HAVE_TBB || defined HAVE_CONCURRENCY
+    class ProxyLoopBody
+    {
+    public:
+        ProxyLoopBody(const ParallelLoopBodyWrapper& _body) : body(&_body) { }
+
+#ifdef HAVE_TBB
         void operator ()(const tbb::blocked_range<int>& range) const
         {
-            body->operator()(Range(range.begin(), range.end()));
+            (*body)(Range(range.begin(), range.end()));
+        }
+#endif
+        void operator ()(int i) const
+        {
+            (*body)(Range(i, i + 1));
         }
 
     private:
-        const ParallelLoopBody* body;
+        const ParallelLoopBodyWrapper* body;
     };
-#endif // end HAVE_TBB
+#endif // HAVE_TBB || HAVE_CONCURRENCY
+
+#ifdef HAVE_TBB
+    static tbb::task_scheduler_init tbbScheduler(tbb::task_scheduler_init::deferred);
+#endif
 
 #ifdef HAVE_GCD
     static
     void block_function(void* context, size_t index)
     {
-        ParallelLoopBody* ptr_body = static_cast<ParallelLoopBody*>(context);
-        ptr_body->operator()(Range(index, index + 1));
+        ParallelLoopBodyWrapper* ptr_body = static_cast<ParallelLoopBodyWrapper*>(context);
+        (*ptr_body)(Range((int)index, (int)index + 1));
     }
 #endif // HAVE_GCD
 
-    void parallel_for_(const Range& range, const ParallelLoopBody& body)
+#ifdef HAVE_THREAD_POOL
+
+    /*
+        The pool keeps getNumThreads()-1 sleeping workers; the thread calling parallel_for_
+        acts as the worker #0. Each job is split into nstripes stripes, which are dealt
+        evenly to the per-thread slots. A thread takes the stripes from the front of its
+        own slot and, once it runs dry, steals the back half of another slot. Only one job
+        runs at a time: parallel_for_ issued from inside a job, or from another thread
+        while the pool is busy, is executed serially on the calling thread, so nested
+        loops never oversubscribe the CPU.
+    */
+    class ThreadPool
     {
-#ifdef HAVE_TBB
+    public:
+        static ThreadPool& instance();
 
-        tbb::parallel_for(tbb::blocked_range<int>(range.start, range.end), TbbProxyLoopBody(body));
+        ThreadPool();
+        ~ThreadPool();
 
-#elif defined HAVE_CONCURRENCY
+        //! runs the job on nthreads threads; returns false if the pool can not take it
+        bool run(const ParallelLoopBodyWrapper& body, int nthreads);
+        //! 1-based index of the pool thread inside the job or 0 outside of it
+        static int threadIndex();
 
-        Concurrency::parallel_for(range.start, range.end, body);
+    protected:
+        struct Slot
+        {
+            Slot() { pthread_mutex_init(&mutex, 0); begin = end = 0; }
+            ~Slot() { pthread_mutex_destroy(&mutex); }
 
-#elif defined HAVE_OPENMP
+            pthread_mutex_t mutex;
+            int begin, end;
+        };
+
+        struct Job
+        {
+            const ParallelLoopBodyWrapper* body;
+            int nslots;
+            int active;
+            volatile int cancelled;
+            bool failed;
+            Exception exc;
+        };
+
+        struct WorkerInfo
+        {
+            ThreadPool* pool;
+            int idx;
+            unsigned generation;
+        };
+
+        static void* workerMain(void* arg);
+        static void resetAfterFork();
+        void workerLoop(int idx, unsigned seen);
+        void process(Job& job, int slot);
+        bool pop(int slot, int& stripe);
+        bool steal(int slot, int nslots);
+        void fail(Job& job, const Exception& exc);
+        void init();
+
+        pthread_mutex_t mutex;
+        pthread_cond_t jobCond, doneCond;
+        vector<pthread_t> threads;
+        vector<Slot*> slots;
+        Job* job;
+        unsigned generation;
+        bool busy, stop;
+    };
+
+    static pthread_key_t poolThreadKey;
+    static pthread_once_t poolThreadKeyOnce = PTHREAD_ONCE_INIT;
+
+    static void makePoolThreadKey()
+    {
+        pthread_key_create(&poolThreadKey, 0);
+    }
+
+    static void setPoolThreadIndex(int idx)
+    {
+        pthread_once(&poolThreadKeyOnce, makePoolThreadKey);
+        pthread_setspecific(poolThreadKey, (void*)(size_t)idx);
+    }
+
+    int ThreadPool::threadIndex()
+    {
+        pthread_once(&poolThreadKeyOnce, makePoolThreadKey);
+        return (int)(size_t)pthread_getspecific(poolThreadKey);
+    }
+
+    ThreadPool& ThreadPool::instance()
+    {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    ThreadPool::ThreadPool()
+    {
+        init();
+        pthread_atfork(0, 0, resetAfterFork);
+    }
+
+    void ThreadPool::init()
+    {
+        pthread_mutex_init(&mutex, 0);
+        pthread_cond_init(&jobCond, 0);
+        pthread_cond_init(&doneCond, 0);
+        job = 0;
+        generation = 0;
+        busy = stop = false;
+    }
+
+    // the worker threads do not survive fork(), so the child starts with an empty pool
+    void ThreadPool::resetAfterFork()
+    {
+        ThreadPool& pool = instance();
+        pool.threads.clear();
+        for( size_t i = 0; i < pool.slots.size(); i++ )
+            pthread_mutex_init(&pool.slots[i]->mutex, 0);
+        pool.init();
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        pthread_mutex_lock(&mutex);
+        stop = true;
+        pthread_cond_broadcast(&jobCond);
+        pthread_mutex_unlock(&mutex);
+
+        for( size_t i = 0; i < threads.size(); i++ )
+            pthread_join(threads[i], 0);
+        for( size_t i = 0; i < slots.size(); i++ )
+            delete slots[i];
+
+        pthread_cond_destroy(&doneCond);
+        pthread_cond_destroy(&jobCond);
+        pthread_mutex_destroy(&mutex);
+    }
+
+    void* ThreadPool::workerMain(void* arg)
+    {
+        WorkerInfo info = *(WorkerInfo*)arg;
+        delete (WorkerInfo*)arg;
+        setPoolThreadIndex(info.idx + 1);
+        info.pool->workerLoop(info.idx, info.generation);
+        return 0;
+    }
+
+    void ThreadPool::workerLoop(int idx, unsigned seen)
+    {
+        for(;;)
+        {
+            pthread_mutex_lock(&mutex);
+            while( !stop && generation == seen )
+                pthread_cond_wait(&jobCond, &mutex);
+            if( stop )
+            {
+                pthread_mutex_unlock(&mutex);
+                break;
+            }
+            seen = generation;
+            Job* j = job;
+            pthread_mutex_unlock(&mutex);
+
+            if( !j || idx + 1 >= j->nslots )
+                continue;
+
+            process(*j, idx + 1);
+
+            pthread_mutex_lock(&mutex);
+            if( --j->active == 0 )
+                pthread_cond_signal(&doneCond);
+            pthread_mutex_unlock(&mutex);
+        }
+    }
+
+    bool ThreadPool::pop(int slot, int& stripe)
+    {
+        Slot& s = *slots[slot];
+        bool ok = false;
+        pthread_mutex_lock(&s.mutex);
+        if( s.begin < s.end )
+        {
+            stripe = s.begin++;
+            ok = true;
+        }
+        pthread_mutex_unlock(&s.mutex);
+        return ok;
+    }
 
-#pragma omp parallel for schedule(dynamic)
-        for (int i = range.start; i < range.end; ++i)
-            body(Range(i, i + 1));
+    bool ThreadPool::steal(int slot, int nslots)
+    {
+        for( int k = 1; k < nslots; k++ )
+        {
+            Slot& victim = *slots[(slot + k) % nslots];
+            int begin = 0, end = 0;
+
+            pthread_mutex_lock(&victim.mutex);
+            int n = victim.end - victim.begin;
+            if( n > 0 )
+            {
+                end = victim.end;
+                begin = victim.end -= (n + 1)/2;
+            }
+            pthread_mutex_unlock(&victim.mutex);
+
+            if( begin < end )
+            {
+                Slot& s = *slots[slot];
+                pthread_mutex_lock(&s.mutex);
+                s.begin = begin;
+                s.end = end;
+                pthread_mutex_unlock(&s.mutex);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void ThreadPool::fail(Job& j, const Exception& exc)
+    {
+        pthread_mutex_lock(&mutex);
+        if( !j.failed )
+        {
+            j.failed = true;
+            j.exc = exc;
+        }
+        j.cancelled = 1;
+        pthread_mutex_unlock(&mutex);
+    }
 
-#elif defined (HAVE_GCD)
+    void ThreadPool::process(Job& j, int slot)
+    {
+        int stripe = 0;
+        while( !j.cancelled && (pop(slot, stripe) || (steal(slot, j.nslots) && pop(slot, stripe))) )
+        {
+            try
+            {
+                (*j.body)(Range(stripe, stripe + 1));
+            }
+            catch(const Exception& e)
+            {
+                fail(j, e);
+            }
+            catch(const std::exception& e)
+            {
+                fail(j, Exception(CV_StsError, e.what(), "parallel_for_", __FILE__, __LINE__));
+            }
+            catch(...)
+            {
+                fail(j, Exception(CV_StsError, "Unknown exception", "parallel_for_", __FILE__, __LINE__));
+            }
+        }
+    }
+
+    bool ThreadPool::run(const ParallelLoopBodyWrapper& body, int nthreads)
+    {
+        int nstripes = body.stripeRange().end;
+        nthreads = std::min(nthreads, nstripes);
+        if( nthreads <= 1 )
+            return false;
 
-        dispatch_queue_t concurrent_queue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
-        dispatch_apply_f(range.end - range.start, concurrent_queue, &const_cast<ParallelLoopBody&>(body), block_function);
+        pthread_mutex_lock(&mutex);
+        if( busy || stop )
+        {
+            pthread_mutex_unlock(&mutex);
+            return false;
+        }
+        busy = true;
+
+        while( (int)threads.size() < nthreads - 1 )
+        {
+            WorkerInfo* info = new WorkerInfo;
+            info->pool = this;
+            info->idx = (int)threads.size();
+            info->generation = generation;
+            pthread_t t;
+            if( pthread_create(&t, 0, workerMain, info) != 0 )
+            {
+                delete info;
+                nthreads = (int)threads.size() + 1;
+                break;
+            }
+            threads.push_back(t);
+        }
+        if( nthreads <= 1 )
+        {
+            busy = false;
+            pthread_mutex_unlock(&mutex);
+            return false;
+        }
+        while( (int)slots.size() < nthreads )
+            slots.push_back(new Slot);
+
+        for( int i = 0; i < nthreads; i++ )
+        {
+            slots[i]->begin = (int)((int64)i*nstripes/nthreads);
+            slots[i]->end = (int)((int64)(i + 1)*nstripes/nthreads);
+        }
+
+        Job j;
+        j.body = &body;
+        j.nslots = nthreads;
+        j.active = nthreads - 1;
+        j.cancelled = 0;
+        j.failed = false;
+
+        job = &j;
+        generation++;
+        pthread_cond_broadcast(&jobCond);
+        pthread_mutex_unlock(&mutex);
+
+        setPoolThreadIndex(1);
+        process(j, 0);
+        setPoolThreadIndex(0);
+
+        pthread_mutex_lock(&mutex);
+        while( j.active > 0 )
+            pthread_cond_wait(&doneCond, &mutex);
+        job = 0;
+        busy = false;
+        pthread_mutex_unlock(&mutex);
+
+        if( j.failed )
+            throw j.exc;
+        return true;
+    }
+
+#endif // HAVE_THREAD_POOL
+
+    // the number of stripes per thread the pool uses when the caller gives no hint
+    static const int POOL_STRIPES_PER_THREAD = 4;
+
+    static int numThreads = -1;
+    static int parallelBackend = -1;
+
+    static bool isParallelBackendAvailable(int backend)
+    {
+        switch( backend )
+        {
+        case PARALLEL_BACKEND_SERIAL:
+            return true;
+#ifdef HAVE_THREAD_POOL
+        case PARALLEL_BACKEND_THREAD_POOL:
+            return true;
+#endif
+#ifdef HAVE_TBB
+        case PARALLEL_BACKEND_TBB:
+            return true;
+#endif
+#ifdef HAVE_OPENMP
+        case PARALLEL_BACKEND_OPENMP:
+            return true;
+#endif
+#ifdef HAVE_GCD
+        case PARALLEL_BACKEND_GCD:
+            return true;
+#endif
+#ifdef HAVE_CONCURRENCY
+        case PARALLEL_BACKEND_CONCURRENCY:
+            return true;
+#endif
+        default:
+            return false;
+        }
+    }
 
+    static int defaultParallelBackend()
+    {
+#if defined HAVE_TBB
+        return PARALLEL_BACKEND_TBB;
+#elif defined HAVE_CONCURRENCY
+        return PARALLEL_BACKEND_CONCURRENCY;
+#elif defined HAVE_OPENMP
+        return PARALLEL_BACKEND_OPENMP;
+#elif defined HAVE_GCD
+        return PARALLEL_BACKEND_GCD;
+#elif defined HAVE_THREAD_POOL
+        return PARALLEL_BACKEND_THREAD_POOL;
 #else
+        return PARALLEL_BACKEND_SERIAL;
+#endif
+    }
+
+    bool setParallelBackend(int backend)
+    {
+        if( !isParallelBackendAvailable(backend) )
+            return false;
+        parallelBackend = backend;
+        return true;
+    }
+
+    int getParallelBackend()
+    {
+        if( parallelBackend < 0 )
+            parallelBackend = defaultParallelBackend();
+        return parallelBackend;
+    }
+
+    void parallel_for_(const Range& range, const ParallelLoopBody& body, double nstripes)
+    {
+        if( range.end <= range.start )
+            return;
 
-        body(range);
+        int backend = getParallelBackend();
+        int nthreads = getNumThreads();
+
+        if( backend == PARALLEL_BACKEND_SERIAL || nthreads <= 1 ||
+            range.end - range.start == 1 || nstripes == 1
+#ifdef HAVE_THREAD_POOL
+            || ThreadPool::threadIndex() > 0
+#endif
+            )
+        {
+            CV_TRACE_PARALLEL(PARALLEL_BACKEND_SERIAL);
+            body(range);
+            return;
+        }
 
-#endif // end HAVE_TBB
+        CV_TRACE_PARALLEL(backend);
+        if( backend == PARALLEL_BACKEND_THREAD_POOL && nstripes <= 0 )
+            nstripes = nthreads*POOL_STRIPES_PER_THREAD;
+
+        ParallelLoopBodyWrapper pbody(body, range, nstripes);
+        Range stripeRange = pbody.stripeRange();
+
+        switch( backend )
+        {
+#ifdef HAVE_THREAD_POOL
+        case PARALLEL_BACKEND_THREAD_POOL:
+            if( !ThreadPool::instance().run(pbody, nthreads) )
+                body(range);
+            break;
+#endif
+
+#ifdef HAVE_TBB
+        case PARALLEL_BACKEND_TBB:
+            tbb::parallel_for(tbb::blocked_range<int>(stripeRange.start, stripeRange.end), ProxyLoopBody(pbody));
+            break;
+#endif
+
+#ifdef HAVE_CONCURRENCY
+        case PARALLEL_BACKEND_CONCURRENCY:
+            Concurrency::parallel_for(stripeRange.start, stripeRange.end, ProxyLoopBody(pbody));
+            break;
+#endif
+
+#ifdef HAVE_OPENMP
+        case PARALLEL_BACKEND_OPENMP:
+            {
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+            for (int i = stripeRange.start; i < stripeRange.end; ++i)
+                pbody(Range(i, i + 1));
+            }
+            break;
+#endif
+
+#ifdef HAVE_GCD
+        case PARALLEL_BACKEND_GCD:
+            {
+            dispatch_queue_t concurrent_queue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+            dispatch_apply_f(stripeRange.end - stripeRange.start, concurrent_queue, &pbody, block_function);
+            }
+            break;
+#endif
+
+        default:
+            (void)stripeRange;
+            body(range);
+        }
+    }
+
+    int getNumThreads(void)
+    {
+        if( numThreads < 0 )
+            numThreads = getNumberOfCPUs();
+        return numThreads;
+    }
+
+    void setNumThreads( int threads )
+    {
+        if( threads <= 0 )
+            threads = getNumberOfCPUs();
+        numThreads = threads;
+
+#ifdef HAVE_TBB
+        if( tbbScheduler.is_active() )
+            tbbScheduler.terminate();
+        tbbScheduler.initialize(threads);
+#endif
+
+#ifdef HAVE_OPENMP
+        omp_set_num_threads(threads);
+#endif
+    }
+
+    int getThreadNum(void)
+    {
+        switch( getParallelBackend() )
+        {
+#ifdef HAVE_THREAD_POOL
+        case PARALLEL_BACKEND_THREAD_POOL:
+            return std::max(ThreadPool::threadIndex() - 1, 0);
+#endif
+#ifdef HAVE_OPENMP
+        case PARALLEL_BACKEND_OPENMP:
+            return omp_get_thread_num();
+#endif
+        default:
+            return 0;
+        }
     }
 
 } // namespace cv
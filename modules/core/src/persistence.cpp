@@ -47,6 +47,15 @@
 #include <iterator>
 #include <wchar.h>
 
+#if defined WIN32 || defined _WIN32 || defined WINCE
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
 #define USE_ZLIB 1
 
 #ifdef __APPLE__
@@ -229,6 +238,9 @@ typedef void (*CvWriteString)( struct CvFileStorage* fs, const char* key,
 typedef void (*CvWriteComment)( struct CvFileStorage* fs, const char* comment, int eol_comment );
 typedef void (*CvStartNextStream)( struct CvFileStorage* fs );
 
+struct CvFSBinaryWriter;
+struct CvFSMapping;
+
 typedef struct CvFileStorage
 {
     int flags;
@@ -269,10 +281,121 @@ typedef struct CvFileStorage
     size_t strbufsize, strbufpos;
     std::deque<char>* outbuf;
 
+    CvFSBinaryWriter* binwriter;
+    CvFSMapping* mapping;
+    bool has_lazy_seqs;
+
     bool is_opened;
 }
 CvFileStorage;
 
+/*
+  The binary storage format (CV_STORAGE_FORMAT_BINARY).
+
+  The file starts with the 16-byte signature CV_FS_BIN_SIGNATURE, followed by the 32-bit
+  byte order mark and a reserved 32-bit word, and then contains a flat list of records.
+  All the numbers are stored in the native byte order. Every record starts with the record
+  type byte:
+
+    CV_FS_BIN_STREAM <type:byte>    - starts the next top-level collection (map or sequence)
+    CV_FS_BIN_INT <key> <int32>
+    CV_FS_BIN_REAL <key> <float64>
+    CV_FS_BIN_STRING <key> <str>
+    CV_FS_BIN_SEQ|MAP [|CV_FS_BIN_FLOW] <key> <type_name:str>
+                                    - starts a collection, closed by CV_FS_BIN_END
+    CV_FS_BIN_END
+    CV_FS_BIN_RAW <dt:str> <count:int32> <padding> <data>
+                                    - count elements of the format dt, as written
+                                      by cvWriteRawData; the data is aligned by CV_FS_BIN_ALIGN
+                                      bytes relative to the beginning of the file
+
+  where <str> is <length:int32> followed by the characters (without the trailing zero).
+  <key> is present only in the elements of maps: it is the 32-bit key index; the index equal
+  to the number of the keys met so far introduces a new key and is followed by its <str>.
+
+  When read, the file is memory-mapped (gzip-ed files are decompressed to memory) and
+  the raw data is not decoded into file nodes until the sequence is accessed element-wise,
+  so the matrices are read directly from the mapping or even share the data with it.
+*/
+
+#define CV_FS_BIN_SIGNATURE "%OPENCV-BIN:1.0\n"
+#define CV_FS_BIN_SIGNATURE_SIZE 16
+#define CV_FS_BIN_HEADER_SIZE 24
+#define CV_FS_BIN_BYTE_ORDER 0x01020304
+#define CV_FS_BIN_ALIGN 16
+#define CV_FS_BIN_BUF_SIZE (1 << 16)
+// the raw sequences with fewer elements are decoded into file nodes right away
+#define CV_FS_BIN_MIN_LAZY 64
+
+enum
+{
+    CV_FS_BIN_INT = 1,
+    CV_FS_BIN_REAL = 2,
+    CV_FS_BIN_STRING = 3,
+    CV_FS_BIN_SEQ = 4,
+    CV_FS_BIN_MAP = 5,
+    CV_FS_BIN_END = 6,
+    CV_FS_BIN_RAW = 7,
+    CV_FS_BIN_STREAM = 8,
+    CV_FS_BIN_FLOW = 128
+};
+
+// the sequence (read from a binary storage) that keeps its elements as raw data as well
+#define CV_NODE_SEQ_RAW 512
+#define CV_NODE_SEQ_IS_RAW(seq) (((seq)->flags & CV_NODE_SEQ_RAW) != 0)
+// the raw sequence, which file nodes have not been decoded yet
+#define CV_NODE_SEQ_LAZY 1024
+#define CV_NODE_SEQ_IS_LAZY(seq) (((seq)->flags & CV_NODE_SEQ_LAZY) != 0)
+// the collection, which nested lazy sequences have all been decoded
+#define CV_NODE_TREE_DECODED 2048
+
+typedef struct CvFileNodeRawSeq
+{
+    CV_SEQUENCE_FIELDS()
+    const uchar* raw_data;
+    const char* raw_dt;
+}
+CvFileNodeRawSeq;
+
+// the memory-mapped (or read to memory) binary storage;
+// it is shared by the storage and the matrices that reference its data
+struct CvFSMapping
+{
+    int refcount;
+    uchar* data;
+    size_t size;
+    bool mapped;
+};
+
+struct CvFSBinaryWriter
+{
+    CvFSBinaryWriter() : pos(0), raw_count(0) {}
+
+    std::vector<uchar> buf; // the output not flushed to the file yet
+    size_t pos; // the current offset in the file
+    std::map<std::string, int> keys; // indices of the keys written so far
+    std::string raw_dt; // the raw data of the current sequence,
+    std::vector<uchar> raw; // collected from the subsequent cvWriteRawData calls
+    int raw_count;
+};
+
+static void icvReleaseMapping( CvFSMapping* mapping )
+{
+    if( mapping && CV_XADD(&mapping->refcount, -1) == 1 )
+    {
+        if( !mapping->mapped )
+            cv::fastFree( mapping->data );
+#if defined WIN32 || defined _WIN32 || defined WINCE
+        else
+            UnmapViewOfFile( mapping->data );
+#else
+        else
+            munmap( mapping->data, mapping->size );
+#endif
+        delete mapping;
+    }
+}
+
 static void icvPuts( CvFileStorage* fs, const char* str )
 {
     if( fs->outbuf )
@@ -287,6 +410,21 @@ static void icvPuts( CvFileStorage* fs, const char* str )
         CV_Error( CV_StsError, "The storage is not opened" );
 }
 
+static void icvPutBytes( CvFileStorage* fs, const void* data, size_t len )
+{
+    const char* ptr = (const char*)data;
+    if( fs->outbuf )
+        std::copy(ptr, ptr + len, std::back_inserter(*fs->outbuf));
+    else if( fs->file )
+        fwrite( ptr, 1, len, fs->file );
+#if USE_ZLIB
+    else if( fs->gzfile )
+        gzwrite( fs->gzfile, ptr, (unsigned)len );
+#endif
+    else
+        CV_Error( CV_StsError, "The storage is not opened" );
+}
+
 static char* icvGets( CvFileStorage* fs, char* str, int maxCount )
 {
     if( fs->strbuf )
@@ -360,6 +498,7 @@ static void icvRewind( CvFileStorage* fs )
 #define CV_XML_INDENT  2
 #define CV_YML_INDENT_FLOW  1
 #define CV_FS_MAX_LEN 4096
+#define CV_FS_MAX_FMT_PAIRS  128
 
 #define CV_FILE_STORAGE ('Y' + ('A' << 8) + ('M' << 16) + ('L' << 24))
 #define CV_IS_FILE_STORAGE(fs) ((fs) != 0 && (fs)->flags == CV_FILE_STORAGE)
@@ -545,6 +684,8 @@ icvFSFlush( CvFileStorage* fs )
 }
 
 
+static void icvBinFlush( CvFileStorage* fs );
+
 static void
 icvClose( CvFileStorage* fs, std::string* out )
 {
@@ -563,7 +704,10 @@ icvClose( CvFileStorage* fs, std::string* out )
                 while( fs->write_stack->total > 0 )
                     cvEndWriteStruct(fs);
             }
-            icvFSFlush(fs);
+            if( fs->fmt == CV_STORAGE_FORMAT_BINARY )
+                icvBinFlush(fs);
+            else
+                icvFSFlush(fs);
             if( fs->fmt == CV_STORAGE_FORMAT_XML )
                 icvPuts( fs, "</opencv_storage>\n" );
         }
@@ -600,6 +744,9 @@ cvReleaseFileStorage( CvFileStorage** p_fs )
         if( fs->outbuf )
             delete fs->outbuf;
 
+        delete fs->binwriter;
+        icvReleaseMapping( fs->mapping );
+
         memset( fs, 0, sizeof(*fs) );
         cvFree( &fs );
     }
@@ -656,6 +803,18 @@ cvGetHashedKey( CvFileStorage* fs, const char* str, int len, int create_missing
 }
 
 
+static void icvDecodeRawSeq( CvSeq* seq );
+
+// decodes the file nodes of the lazy sequence (if any), before its elements are accessed directly
+static inline void icvDecodeNode( const CvFileNode* node )
+{
+    if( node && CV_NODE_IS_SEQ(node->tag) && CV_NODE_SEQ_IS_LAZY(node->data.seq) )
+        icvDecodeRawSeq( node->data.seq );
+}
+
+static void icvDecodeNodeTree( const CvFileStorage* fs, const CvFileNode* node );
+
+
 CV_IMPL CvFileNode*
 cvGetFileNode( CvFileStorage* fs, CvFileNode* _map_node,
                const CvStringHashNode* key,
@@ -711,6 +870,7 @@ cvGetFileNode( CvFileStorage* fs, CvFileNode* _map_node,
                 if( !create_missing )
                 {
                     value = &another->value;
+                    icvDecodeNodeTree( fs, value );
                     return value;
                 }
                 CV_PARSE_ERROR( "Duplicated key" );
@@ -731,8 +891,9 @@ cvGetFileNode( CvFileStorage* fs, CvFileNode* _map_node,
 }
 
 
-CV_IMPL CvFileNode*
-cvGetFileNodeByName( const CvFileStorage* fs, const CvFileNode* _map_node, const char* str )
+// the same as cvGetFileNodeByName, but keeps the lazy sequences as is
+static CvFileNode*
+icvGetFileNodeByName( const CvFileStorage* fs, const CvFileNode* _map_node, const char* str )
 {
     CvFileNode* value = 0;
     int i, len, tab_size;
@@ -802,6 +963,15 @@ cvGetFileNodeByName( const CvFileStorage* fs, const CvFileNode* _map_node, const
 }
 
 
+CV_IMPL CvFileNode*
+cvGetFileNodeByName( const CvFileStorage* fs, const CvFileNode* _map_node, const char* str )
+{
+    CvFileNode* value = icvGetFileNodeByName( fs, _map_node, str );
+    icvDecodeNodeTree( fs, value );
+    return value;
+}
+
+
 CV_IMPL CvFileNode*
 cvGetRootFileNode( const CvFileStorage* fs, int stream_index )
 {
@@ -810,7 +980,9 @@ cvGetRootFileNode( const CvFileStorage* fs, int stream_index )
     if( !fs->roots || (unsigned)stream_index >= (unsigned)fs->roots->total )
         return 0;
 
-    return (CvFileNode*)cvGetSeqElem( fs->roots, stream_index );
+    CvFileNode* value = (CvFileNode*)cvGetSeqElem( fs->roots, stream_index );
+    icvDecodeNodeTree( fs, value );
+    return value;
 }
 
 
@@ -2512,171 +2684,962 @@ icvXMLWriteScalar( CvFileStorage* fs, const char* key, const char* data, int len
 
 
 static void
-icvXMLWriteInt( CvFileStorage* fs, const char* key, int value )
+icvXMLWriteInt( CvFileStorage* fs, const char* key, int value )
+{
+    char buf[128], *ptr = icv_itoa( value, buf, 10 );
+    int len = (int)strlen(ptr);
+    icvXMLWriteScalar( fs, key, ptr, len );
+}
+
+
+static void
+icvXMLWriteReal( CvFileStorage* fs, const char* key, double value )
+{
+    char buf[128];
+    int len = (int)strlen( icvDoubleToString( buf, value ));
+    icvXMLWriteScalar( fs, key, buf, len );
+}
+
+
+static void
+icvXMLWriteString( CvFileStorage* fs, const char* key, const char* str, int quote )
+{
+    char buf[CV_FS_MAX_LEN*6+16];
+    char* data = (char*)str;
+    int i, len;
+
+    if( !str )
+        CV_Error( CV_StsNullPtr, "Null string pointer" );
+
+    len = (int)strlen(str);
+    if( len > CV_FS_MAX_LEN )
+        CV_Error( CV_StsBadArg, "The written string is too long" );
+
+    if( quote || len == 0 || str[0] != '\"' || str[0] != str[len-1] )
+    {
+        int need_quote = quote || len == 0;
+        data = buf;
+        *data++ = '\"';
+        for( i = 0; i < len; i++ )
+        {
+            char c = str[i];
+
+            if( (uchar)c >= 128 || c == ' ' )
+            {
+                *data++ = c;
+                need_quote = 1;
+            }
+            else if( !cv_isprint(c) || c == '<' || c == '>' || c == '&' || c == '\'' || c == '\"' )
+            {
+                *data++ = '&';
+                if( c == '<' )
+                {
+                    memcpy(data, "lt", 2);
+                    data += 2;
+                }
+                else if( c == '>' )
+                {
+                    memcpy(data, "gt", 2);
+                    data += 2;
+                }
+                else if( c == '&' )
+                {
+                    memcpy(data, "amp", 3);
+                    data += 3;
+                }
+                else if( c == '\'' )
+                {
+                    memcpy(data, "apos", 4);
+                    data += 4;
+                }
+                else if( c == '\"' )
+                {
+                    memcpy( data, "quot", 4);
+                    data += 4;
+                }
+                else
+                {
+                    sprintf( data, "#x%02x", (uchar)c );
+                    data += 4;
+                }
+                *data++ = ';';
+                need_quote = 1;
+            }
+            else
+                *data++ = c;
+        }
+        if( !need_quote && (cv_isdigit(str[0]) ||
+            str[0] == '+' || str[0] == '-' || str[0] == '.' ))
+            need_quote = 1;
+
+        if( need_quote )
+            *data++ = '\"';
+        len = (int)(data - buf) - !need_quote;
+        *data++ = '\0';
+        data = buf + !need_quote;
+    }
+
+    icvXMLWriteScalar( fs, key, data, len );
+}
+
+
+static void
+icvXMLWriteComment( CvFileStorage* fs, const char* comment, int eol_comment )
+{
+    int len;
+    int multiline;
+    const char* eol;
+    char* ptr;
+
+    if( !comment )
+        CV_Error( CV_StsNullPtr, "Null comment" );
+
+    if( strstr(comment, "--") != 0 )
+        CV_Error( CV_StsBadArg, "Double hyphen \'--\' is not allowed in the comments" );
+
+    len = (int)strlen(comment);
+    eol = strchr(comment, '\n');
+    multiline = eol != 0;
+    ptr = fs->buffer;
+
+    if( multiline || !eol_comment || fs->buffer_end - ptr < len + 5 )
+        ptr = icvXMLFlush( fs );
+    else if( ptr > fs->buffer_start + fs->struct_indent )
+        *ptr++ = ' ';
+
+    if( !multiline )
+    {
+        ptr = icvFSResizeWriteBuffer( fs, ptr, len + 9 );
+        sprintf( ptr, "<!-- %s -->", comment );
+        len = (int)strlen(ptr);
+    }
+    else
+    {
+        strcpy( ptr, "<!--" );
+        len = 4;
+    }
+
+    fs->buffer = ptr + len;
+    ptr = icvXMLFlush(fs);
+
+    if( multiline )
+    {
+        while( comment )
+        {
+            if( eol )
+            {
+                ptr = icvFSResizeWriteBuffer( fs, ptr, (int)(eol - comment) + 1 );
+                memcpy( ptr, comment, eol - comment + 1 );
+                ptr += eol - comment;
+                comment = eol + 1;
+                eol = strchr( comment, '\n' );
+            }
+            else
+            {
+                len = (int)strlen(comment);
+                ptr = icvFSResizeWriteBuffer( fs, ptr, len );
+                memcpy( ptr, comment, len );
+                ptr += len;
+                comment = 0;
+            }
+            fs->buffer = ptr;
+            ptr = icvXMLFlush( fs );
+        }
+        sprintf( ptr, "-->" );
+        fs->buffer = ptr + 3;
+        icvXMLFlush( fs );
+    }
+}
+
+
+/****************************************************************************************\
+*                                      Binary Parser                                     *
+\****************************************************************************************/
+
+static int icvDecodeFormat( const char* dt, int* fmt_pairs, int max_len );
+static int icvCalcElemSize( const char* dt, int initial_size );
+
+static void
+icvRawScalarToNode( const uchar* ptr, int elem_type, CvFileNode* node )
+{
+    node->info = 0;
+    node->tag = CV_NODE_INT;
+    switch( elem_type )
+    {
+    case CV_8U:
+        node->data.i = *ptr;
+        break;
+    case CV_8S:
+        node->data.i = *(const schar*)ptr;
+        break;
+    case CV_16U:
+        node->data.i = *(const ushort*)ptr;
+        break;
+    case CV_16S:
+        node->data.i = *(const short*)ptr;
+        break;
+    case CV_32S:
+        node->data.i = *(const int*)ptr;
+        break;
+    case CV_32F:
+        node->tag = CV_NODE_REAL;
+        node->data.f = *(const float*)ptr;
+        break;
+    case CV_64F:
+        node->tag = CV_NODE_REAL;
+        node->data.f = *(const double*)ptr;
+        break;
+    case CV_USRTYPE1: /* reference */
+        node->data.i = (int)*(const size_t*)ptr;
+        break;
+    default:
+        CV_Error( CV_StsBadArg, "Invalid data type specification" );
+    }
+}
+
+
+/* decodes count scalars of the raw data of the format dt, starting from the scalar pos */
+static void
+icvRawDataToNodes( const uchar* data, const char* dt, int pos, int count, CvFileNode* nodes )
+{
+    int fmt_pairs[CV_FS_MAX_FMT_PAIRS*2], fmt_pair_count;
+    int i, k, cn = 0, skip;
+    size_t elem_size;
+    const uchar* elem;
+
+    fmt_pair_count = icvDecodeFormat( dt, fmt_pairs, CV_FS_MAX_FMT_PAIRS );
+    for( k = 0; k < fmt_pair_count; k++ )
+        cn += fmt_pairs[k*2];
+    elem_size = icvCalcElemSize( dt, 0 );
+    elem = data + (size_t)(pos / cn)*elem_size;
+    skip = pos % cn;
+
+    for( ; count > 0; elem += elem_size )
+    {
+        int offset = 0;
+        for( k = 0; k < fmt_pair_count && count > 0; k++ )
+        {
+            int elem_type = fmt_pairs[k*2+1];
+            int comp_size = CV_ELEM_SIZE(elem_type);
+
+            offset = cvAlign( offset, comp_size );
+            for( i = 0; i < fmt_pairs[k*2] && count > 0; i++, offset += comp_size )
+            {
+                if( skip > 0 )
+                {
+                    skip--;
+                    continue;
+                }
+                icvRawScalarToNode( elem + offset, elem_type, nodes++ );
+                count--;
+            }
+        }
+    }
+}
+
+
+static void
+icvPushRawData( CvSeq* seq, const uchar* data, const char* dt, int total )
+{
+    const int block_size = 256;
+    CvFileNode nodes[block_size];
+
+    for( int pos = 0; pos < total; pos += block_size )
+    {
+        int count = MIN( block_size, total - pos );
+        icvRawDataToNodes( data, dt, pos, count, nodes );
+        cvSeqPushMulti( seq, nodes, count );
+    }
+}
+
+
+static cv::Mutex& getRawSeqMutex()
+{
+    static cv::Mutex m;
+    return m;
+}
+
+
+/* decodes the file nodes of the lazy sequence. The nodes are built aside and then attached
+   to the sequence, and the lazy flag is cleared last, so the concurrent readers see either
+   the raw data or all the nodes. The raw data stays valid */
+static void
+icvDecodeRawSeq( CvSeq* seq )
+{
+    if( !CV_NODE_SEQ_IS_LAZY(seq) )
+        return;
+
+    cv::AutoLock lock(getRawSeqMutex());
+    if( !CV_NODE_SEQ_IS_LAZY(seq) )
+        return;
+
+    const CvFileNodeRawSeq* raw = (const CvFileNodeRawSeq*)seq;
+    CvSeq* nodes = cvCreateSeq( 0, sizeof(CvSeq), sizeof(CvFileNode), seq->storage );
+    icvPushRawData( nodes, raw->raw_data, raw->raw_dt, seq->total );
+
+    seq->first = nodes->first;
+    seq->ptr = nodes->ptr;
+    seq->block_max = nodes->block_max;
+    seq->free_blocks = nodes->free_blocks;
+    CV_XADD( &seq->flags, -CV_NODE_SEQ_LAZY );
+}
+
+
+/* decodes the nested lazy sequences of the node, before the node is passed to the C API,
+   where the sequences are read directly. The decoded subtrees are marked, so it is done once */
+static void
+icvDecodeNodeTree( const CvFileStorage* fs, const CvFileNode* node )
+{
+    if( !fs || !node || !fs->has_lazy_seqs || !CV_NODE_IS_COLLECTION(node->tag) ||
+        (node->data.seq->flags & CV_NODE_TREE_DECODED) )
+        return;
+
+    CvSeq* seq = node->data.seq;
+    int is_map = CV_NODE_IS_MAP(node->tag);
+
+    if( CV_NODE_SEQ_IS_RAW(seq) )
+        icvDecodeRawSeq( seq );
+    else
+    {
+        CvSeqReader reader;
+        cvStartReadSeq( seq, &reader, 0 );
+        for( int i = 0; i < seq->total; i++ )
+        {
+            const CvFileNode* elem = (const CvFileNode*)reader.ptr;
+            if( !is_map || CV_IS_SET_ELEM(elem) )
+                icvDecodeNodeTree( fs, elem );
+            CV_NEXT_SEQ_ELEM( seq->elem_size, reader );
+        }
+    }
+
+    cv::AutoLock lock(getRawSeqMutex());
+    seq->flags |= CV_NODE_TREE_DECODED;
+}
+
+
+/* decodes the lazy sequence and drops its raw data, before more elements are added to it */
+static void
+icvDropRawData( CvSeq* seq )
+{
+    icvDecodeRawSeq( seq );
+    seq->flags &= ~CV_NODE_SEQ_RAW;
+}
+
+
+/* reads the slice of the raw sequence, reader->delta_index is the current scalar position */
+static void
+icvReadRawSlice( const CvFileStorage* fs, CvSeqReader* reader,
+                 int len, char* data, const char* dt )
+{
+    const CvFileNodeRawSeq* seq = (const CvFileNodeRawSeq*)reader->seq;
+    int src_pairs[CV_FS_MAX_FMT_PAIRS*2], src_pair_count;
+    int dst_pairs[CV_FS_MAX_FMT_PAIRS*2], dst_pair_count;
+    int k, cn = 0, pos = reader->delta_index;
+    size_t elem_size = icvCalcElemSize( dt, 0 );
+
+    if( len < 0 || len > seq->total - pos )
+        CV_Error( CV_StsOutOfRange, "The sequence slice is out of range" );
+
+    src_pair_count = icvDecodeFormat( seq->raw_dt, src_pairs, CV_FS_MAX_FMT_PAIRS );
+    dst_pair_count = icvDecodeFormat( dt, dst_pairs, CV_FS_MAX_FMT_PAIRS );
+    for( k = 0; k < dst_pair_count; k++ )
+        cn += dst_pairs[k*2];
+    reader->delta_index = pos + len;
+
+    if( src_pair_count == dst_pair_count &&
+        memcmp( src_pairs, dst_pairs, src_pair_count*2*sizeof(src_pairs[0]) ) == 0 &&
+        pos % cn == 0 && len % cn == 0 )
+    {
+        memcpy( data, seq->raw_data + (size_t)(pos/cn)*elem_size, (size_t)(len/cn)*elem_size );
+        return;
+    }
+
+    // convert the data via the temporary file nodes, a few records at once
+    int block_size = MAX(256/cn, 1)*cn;
+    cv::AutoBuffer<CvFileNode> _nodes(block_size + 1);
+    CvFileNode* nodes = _nodes;
+    CvSeq stub;
+    memset( &stub, 0, sizeof(stub) );
+
+    while( len > 0 )
+    {
+        int count = MIN( block_size, len );
+        CvSeqReader block_reader;
+
+        icvRawDataToNodes( seq->raw_data, seq->raw_dt, pos, count, nodes );
+        memset( &block_reader, 0, sizeof(block_reader) );
+        block_reader.seq = &stub;
+        block_reader.ptr = block_reader.block_min = (schar*)nodes;
+        block_reader.block_max = (schar*)(nodes + count + 1);
+        cvReadRawDataSlice( fs, &block_reader, count, data, dt );
+
+        data += (size_t)(count/cn)*elem_size;
+        pos += count;
+        len -= count;
+    }
+}
+
+
+static CvFSMapping*
+icvMapBinaryStorage( CvFileStorage* fs )
+{
+    CvFSMapping* mapping = new CvFSMapping;
+    mapping->refcount = 1;
+    mapping->data = 0;
+    mapping->size = 0;
+    mapping->mapped = false;
+
+#if USE_ZLIB
+    if( fs->gzfile )
+    {
+        const int chunk_size = 1 << 20;
+        std::vector<uchar> buf;
+        int len;
+
+        gzrewind( fs->gzfile );
+        do
+        {
+            size_t size = buf.size();
+            buf.resize( size + chunk_size );
+            len = gzread( fs->gzfile, &buf[size], chunk_size );
+            buf.resize( size + MAX(len, 0) );
+        }
+        while( len == chunk_size );
+
+        mapping->size = buf.size();
+        mapping->data = (uchar*)cv::fastMalloc( mapping->size + 1 );
+        if( !buf.empty() )
+            memcpy( mapping->data, &buf[0], buf.size() );
+        return mapping;
+    }
+#endif
+
+    // the mapping is copy-on-write, so the matrices that share the data may be modified
+#if (defined WIN32 || defined _WIN32) && !defined WINCE
+    HANDLE file = CreateFileA( fs->filename, GENERIC_READ, FILE_SHARE_READ, 0,
+                               OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0 );
+    if( file != INVALID_HANDLE_VALUE )
+    {
+        LARGE_INTEGER size;
+        if( GetFileSizeEx( file, &size ) && size.QuadPart > 0 )
+        {
+            HANDLE fmap = CreateFileMappingA( file, 0, PAGE_WRITECOPY, 0, 0, 0 );
+            if( fmap )
+            {
+                mapping->data = (uchar*)MapViewOfFile( fmap, FILE_MAP_COPY, 0, 0, 0 );
+                mapping->size = (size_t)size.QuadPart;
+                CloseHandle( fmap );
+            }
+        }
+        CloseHandle( file );
+    }
+#elif !defined WINCE
+    int fd = open( fs->filename, O_RDONLY );
+    if( fd >= 0 )
+    {
+        struct stat st;
+        if( fstat( fd, &st ) == 0 && st.st_size > 0 )
+        {
+            void* ptr = mmap( 0, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+            if( ptr != MAP_FAILED )
+            {
+                mapping->data = (uchar*)ptr;
+                mapping->size = (size_t)st.st_size;
+            }
+        }
+        close( fd );
+    }
+#endif
+
+    if( mapping->data )
+    {
+        mapping->mapped = true;
+        return mapping;
+    }
+
+    // the file could not be mapped, read it to memory
+    FILE* f = fopen( fs->filename, "rb" );
+    if( f )
+    {
+        fseek( f, 0, SEEK_END );
+        long size = ftell( f );
+        fseek( f, 0, SEEK_SET );
+        mapping->data = (uchar*)cv::fastMalloc( MAX(size, 0L) + 1 );
+        mapping->size = fread( mapping->data, 1, MAX(size, 0L), f );
+        fclose( f );
+    }
+    else
+    {
+        delete mapping;
+        CV_Error( CV_StsError, "Could not read the binary storage" );
+    }
+    return mapping;
+}
+
+
+static const uchar*
+icvBinGetBytes( CvFileStorage* fs, const uchar*& ptr, const uchar* end, size_t len )
+{
+    const uchar* data = ptr;
+    if( (size_t)(end - ptr) < len )
+        CV_PARSE_ERROR( "Unexpected end of the binary storage" );
+    ptr += len;
+    return data;
+}
+
+static int
+icvBinGetInt( CvFileStorage* fs, const uchar*& ptr, const uchar* end )
+{
+    int value;
+    memcpy( &value, icvBinGetBytes( fs, ptr, end, sizeof(value) ), sizeof(value) );
+    return value;
+}
+
+static const char*
+icvBinGetString( CvFileStorage* fs, const uchar*& ptr, const uchar* end, int& len )
+{
+    len = icvBinGetInt( fs, ptr, end );
+    if( len < 0 )
+        CV_PARSE_ERROR( "Invalid string length" );
+    return (const char*)icvBinGetBytes( fs, ptr, end, len );
+}
+
+
+static void
+icvBinCreateCollection( CvFileStorage* fs, int tag, CvFileNode* collection )
+{
+    if( CV_NODE_IS_MAP(tag) )
+        collection->data.map = cvCreateMap( 0, sizeof(CvFileNodeHash),
+                            sizeof(CvFileMapNode), fs->memstorage, 16 );
+    else
+        collection->data.seq = cvCreateSeq( 0, sizeof(CvFileNodeRawSeq),
+                            sizeof(CvFileNode), fs->memstorage );
+    collection->tag = tag;
+    cvSetSeqBlockSize( collection->data.seq, 8 );
+}
+
+
+static void
+icvBinAddRawData( CvFileStorage* fs, CvFileNode* node, const char* dt, const uchar* data, int count )
+{
+    CvFileNodeRawSeq* seq = (CvFileNodeRawSeq*)node->data.seq;
+    int fmt_pairs[CV_FS_MAX_FMT_PAIRS*2], fmt_pair_count, k, cn = 0;
+
+    fmt_pair_count = icvDecodeFormat( dt, fmt_pairs, CV_FS_MAX_FMT_PAIRS );
+    for( k = 0; k < fmt_pair_count; k++ )
+        cn += fmt_pairs[k*2];
+    if( count > INT_MAX/MAX(cn, 1) )
+        CV_PARSE_ERROR( "Too long raw data" );
+
+    if( seq->total == 0 )
+    {
+        seq->flags |= CV_NODE_SEQ_RAW | CV_NODE_SEQ_LAZY;
+        seq->raw_data = data;
+        seq->raw_dt = dt;
+        seq->total = count*cn;
+        fs->has_lazy_seqs = true;
+    }
+    else
+    {
+        // the sequence with mixed content is decoded right away
+        icvDropRawData( (CvSeq*)seq );
+        icvPushRawData( (CvSeq*)seq, data, dt, count*cn );
+    }
+}
+
+
+static void
+icvBinParse( CvFileStorage* fs )
+{
+    const uchar* start = fs->mapping->data;
+    const uchar* end = start + fs->mapping->size;
+    const uchar* ptr = start;
+    std::vector<CvStringHashNode*> keys;
+    std::vector<CvFileNode*> stack;
+    CvFileNode* node = 0;
+    char buf[CV_FS_MAX_LEN + 16];
+    int len;
+
+    icvBinGetBytes( fs, ptr, end, CV_FS_BIN_HEADER_SIZE );
+    if( memcmp( start, CV_FS_BIN_SIGNATURE, CV_FS_BIN_SIGNATURE_SIZE ) != 0 )
+        CV_PARSE_ERROR( "Invalid binary storage signature" );
+    ptr = start + CV_FS_BIN_SIGNATURE_SIZE;
+    if( icvBinGetInt( fs, ptr, end ) != CV_FS_BIN_BYTE_ORDER )
+        CV_PARSE_ERROR( "The binary storage has been written on the machine with different byte order" );
+    ptr = start + CV_FS_BIN_HEADER_SIZE;
+
+    while( ptr < end )
+    {
+        int op = *ptr++;
+        int flow = op & CV_FS_BIN_FLOW;
+        op &= ~CV_FS_BIN_FLOW;
+
+        if( op == CV_FS_BIN_STREAM )
+        {
+            int tag = *icvBinGetBytes( fs, ptr, end, 1 );
+            if( !stack.empty() )
+                CV_PARSE_ERROR( "Unclosed collection in the end of the stream" );
+            if( !CV_NODE_IS_COLLECTION(tag) )
+                CV_PARSE_ERROR( "Only collections are supported as the streams" );
+            node = (CvFileNode*)cvSeqPush( fs->roots, 0 );
+            memset( node, 0, sizeof(*node) );
+            icvBinCreateCollection( fs, CV_NODE_TYPE(tag), node );
+            continue;
+        }
+
+        if( !node )
+            CV_PARSE_ERROR( "The binary storage does not start with a stream" );
+
+        if( op == CV_FS_BIN_END )
+        {
+            if( stack.empty() )
+                CV_PARSE_ERROR( "Unmatched end of collection" );
+            if( CV_NODE_IS_SEQ(node->tag) && node->data.seq->total < CV_FS_BIN_MIN_LAZY )
+                icvDecodeNode( node );
+            node = stack.back();
+            stack.pop_back();
+            continue;
+        }
+
+        if( op == CV_FS_BIN_RAW )
+        {
+            const char* dt = icvBinGetString( fs, ptr, end, len );
+            if( len == 0 || len > CV_FS_MAX_LEN )
+                CV_PARSE_ERROR( "Invalid raw data format" );
+            dt = cvMemStorageAllocString( fs->memstorage, dt, len ).ptr;
+            int count = icvBinGetInt( fs, ptr, end );
+            size_t elem_size = icvCalcElemSize( dt, 0 );
+            if( !CV_NODE_IS_SEQ(node->tag) )
+                CV_PARSE_ERROR( "Raw data may only be stored in sequences" );
+            if( count < 0 || elem_size == 0 || (size_t)count > (size_t)(end - start)/elem_size )
+                CV_PARSE_ERROR( "Invalid raw data size" );
+            size_t ofs = ptr - start;
+            icvBinGetBytes( fs, ptr, end, cv::alignSize( ofs, CV_FS_BIN_ALIGN ) - ofs );
+            const uchar* data = icvBinGetBytes( fs, ptr, end, count*elem_size );
+            icvBinAddRawData( fs, node, dt, data, count );
+            continue;
+        }
+
+        int is_map = CV_NODE_IS_MAP(node->tag);
+        CvFileNode* elem;
+
+        if( is_map )
+        {
+            int idx = icvBinGetInt( fs, ptr, end );
+            if( idx == (int)keys.size() )
+            {
+                const char* key = icvBinGetString( fs, ptr, end, len );
+                if( len == 0 || len > CV_FS_MAX_LEN )
+                    CV_PARSE_ERROR( "Invalid key" );
+                keys.push_back( cvGetHashedKey( fs, key, len, 1 ));
+            }
+            else if( (unsigned)idx > keys.size() )
+                CV_PARSE_ERROR( "Invalid key index" );
+            elem = cvGetFileNode( fs, node, keys[idx], 1 );
+        }
+        else
+        {
+            icvDropRawData( node->data.seq );
+            elem = (CvFileNode*)cvSeqPush( node->data.seq, 0 );
+        }
+        memset( elem, 0, sizeof(*elem) );
+
+        switch( op )
+        {
+        case CV_FS_BIN_INT:
+            elem->tag = CV_NODE_INT;
+            elem->data.i = icvBinGetInt( fs, ptr, end );
+            break;
+        case CV_FS_BIN_REAL:
+            elem->tag = CV_NODE_REAL;
+            memcpy( &elem->data.f, icvBinGetBytes( fs, ptr, end, sizeof(double) ), sizeof(double) );
+            break;
+        case CV_FS_BIN_STRING:
+            {
+            const char* str = icvBinGetString( fs, ptr, end, len );
+            elem->tag = CV_NODE_STRING;
+            elem->data.str = cvMemStorageAllocString( fs->memstorage, str, len );
+            }
+            break;
+        case CV_FS_BIN_SEQ:
+        case CV_FS_BIN_MAP:
+            {
+            const char* type_name = icvBinGetString( fs, ptr, end, len );
+            if( len < 0 || len > CV_FS_MAX_LEN )
+            {
+                CV_PARSE_ERROR( "Too long type name" );
+                return;
+            }
+            memcpy( buf, type_name, len );
+            buf[len] = '\0';
+            elem->info = len > 0 ? cvFindType( buf ) : 0;
+            icvBinCreateCollection( fs, (op == CV_FS_BIN_MAP ? CV_NODE_MAP : CV_NODE_SEQ) +
+                                    (elem->info ? CV_NODE_USER : 0), elem );
+            if( flow )
+                elem->data.seq->flags |= CV_NODE_SEQ_SIMPLE;
+            stack.push_back( node );
+            node = elem;
+            }
+            break;
+        default:
+            CV_PARSE_ERROR( "Unknown record type" );
+        }
+
+        if( is_map )
+            elem->tag |= CV_NODE_NAMED;
+    }
+
+    if( !stack.empty() )
+        CV_PARSE_ERROR( "Unexpected end of the binary storage" );
+}
+
+
+/****************************************************************************************\
+*                                     Binary Emitter                                     *
+\****************************************************************************************/
+
+static void
+icvBinPut( CvFileStorage* fs, const void* data, size_t len )
+{
+    CvFSBinaryWriter* writer = fs->binwriter;
+    const uchar* ptr = (const uchar*)data;
+
+    writer->pos += len;
+    if( writer->buf.size() + len >= CV_FS_BIN_BUF_SIZE )
+    {
+        if( !writer->buf.empty() )
+            icvPutBytes( fs, &writer->buf[0], writer->buf.size() );
+        writer->buf.clear();
+        if( len >= CV_FS_BIN_BUF_SIZE )
+        {
+            icvPutBytes( fs, ptr, len );
+            return;
+        }
+    }
+    writer->buf.insert( writer->buf.end(), ptr, ptr + len );
+}
+
+static void
+icvBinPutInt( CvFileStorage* fs, int value )
+{
+    icvBinPut( fs, &value, sizeof(value) );
+}
+
+static void
+icvBinPutString( CvFileStorage* fs, const char* str, int len )
+{
+    icvBinPutInt( fs, len );
+    icvBinPut( fs, str, len );
+}
+
+
+static void
+icvBinFlushRaw( CvFileStorage* fs )
+{
+    static const uchar zeros[CV_FS_BIN_ALIGN] = {0};
+    CvFSBinaryWriter* writer = fs->binwriter;
+    uchar op = CV_FS_BIN_RAW;
+
+    if( writer->raw_count == 0 )
+        return;
+
+    icvBinPut( fs, &op, 1 );
+    icvBinPutString( fs, writer->raw_dt.c_str(), (int)writer->raw_dt.size() );
+    icvBinPutInt( fs, writer->raw_count );
+    icvBinPut( fs, zeros, (CV_FS_BIN_ALIGN - writer->pos % CV_FS_BIN_ALIGN) % CV_FS_BIN_ALIGN );
+    icvBinPut( fs, &writer->raw[0], writer->raw.size() );
+    writer->raw.clear();
+    writer->raw_count = 0;
+}
+
+
+static void
+icvBinFlush( CvFileStorage* fs )
+{
+    CvFSBinaryWriter* writer = fs->binwriter;
+
+    icvBinFlushRaw( fs );
+    if( !writer->buf.empty() )
+        icvPutBytes( fs, &writer->buf[0], writer->buf.size() );
+    writer->buf.clear();
+}
+
+
+/* starts the next element of the current collection; the record (if op != 0)
+   is written together with the element key */
+static void
+icvBinStartElem( CvFileStorage* fs, const char* key, int op )
+{
+    CvFSBinaryWriter* writer = fs->binwriter;
+    int struct_flags = fs->struct_flags;
+
+    if( key && key[0] == '\0' )
+        key = 0;
+
+    icvBinFlushRaw( fs );
+
+    if( CV_NODE_IS_COLLECTION(struct_flags) )
+    {
+        if( (CV_NODE_IS_MAP(struct_flags) ^ (key != 0)) )
+            CV_Error( CV_StsBadArg, "An attempt to add element without a key to a map, "
+                                    "or add element with key to sequence" );
+    }
+    else
+    {
+        // the first element defines the type of the top-level collection
+        uchar header[] = { CV_FS_BIN_STREAM, (uchar)(key ? CV_NODE_MAP : CV_NODE_SEQ) };
+        fs->is_first = 0;
+        struct_flags = CV_NODE_EMPTY | header[1];
+        icvBinPut( fs, header, sizeof(header) );
+    }
+    fs->struct_flags = struct_flags & ~CV_NODE_EMPTY;
+
+    if( !op )
+        return;
+
+    uchar c = (uchar)op;
+    icvBinPut( fs, &c, 1 );
+
+    if( key )
+    {
+        int keylen = (int)strlen(key);
+        if( keylen > CV_FS_MAX_LEN )
+            CV_Error( CV_StsBadArg, "The key is too long" );
+
+        std::map<std::string, int>::const_iterator it = writer->keys.find(key);
+        if( it != writer->keys.end() )
+            icvBinPutInt( fs, it->second );
+        else
+        {
+            int idx = (int)writer->keys.size();
+            writer->keys[key] = idx;
+            icvBinPutInt( fs, idx );
+            icvBinPutString( fs, key, keylen );
+        }
+    }
+}
+
+
+static void
+icvBinStartWriteStruct( CvFileStorage* fs, const char* key, int struct_flags,
+                        const char* type_name CV_DEFAULT(0))
+{
+    int parent_flags;
+    int op;
+
+    struct_flags = (struct_flags & (CV_NODE_TYPE_MASK|CV_NODE_FLOW)) | CV_NODE_EMPTY;
+    if( !CV_NODE_IS_COLLECTION(struct_flags))
+        CV_Error( CV_StsBadArg,
+        "Some collection type - CV_NODE_SEQ or CV_NODE_MAP, must be specified" );
+
+    op = (CV_NODE_IS_MAP(struct_flags) ? CV_FS_BIN_MAP : CV_FS_BIN_SEQ) +
+         (CV_NODE_IS_FLOW(struct_flags) ? CV_FS_BIN_FLOW : 0);
+    icvBinStartElem( fs, key, op );
+    icvBinPutString( fs, type_name, type_name ? (int)strlen(type_name) : 0 );
+
+    parent_flags = fs->struct_flags;
+    cvSeqPush( fs->write_stack, &parent_flags );
+    fs->struct_flags = struct_flags;
+}
+
+
+static void
+icvBinEndWriteStruct( CvFileStorage* fs )
+{
+    int parent_flags = 0;
+    uchar op = CV_FS_BIN_END;
+
+    if( fs->write_stack->total == 0 )
+        CV_Error( CV_StsError, "EndWriteStruct w/o matching StartWriteStruct" );
+
+    icvBinFlushRaw( fs );
+    icvBinPut( fs, &op, 1 );
+    cvSeqPop( fs->write_stack, &parent_flags );
+    fs->struct_flags = parent_flags;
+}
+
+
+static void
+icvBinStartNextStream( CvFileStorage* fs )
+{
+    if( !fs->is_first )
+    {
+        while( fs->write_stack->total > 0 )
+            icvBinEndWriteStruct(fs);
+        icvBinFlushRaw( fs );
+        fs->struct_flags = CV_NODE_EMPTY;
+    }
+}
+
+
+static void
+icvBinWriteInt( CvFileStorage* fs, const char* key, int value )
 {
-    char buf[128], *ptr = icv_itoa( value, buf, 10 );
-    int len = (int)strlen(ptr);
-    icvXMLWriteScalar( fs, key, ptr, len );
+    icvBinStartElem( fs, key, CV_FS_BIN_INT );
+    icvBinPutInt( fs, value );
 }
 
 
 static void
-icvXMLWriteReal( CvFileStorage* fs, const char* key, double value )
+icvBinWriteReal( CvFileStorage* fs, const char* key, double value )
 {
-    char buf[128];
-    int len = (int)strlen( icvDoubleToString( buf, value ));
-    icvXMLWriteScalar( fs, key, buf, len );
+    icvBinStartElem( fs, key, CV_FS_BIN_REAL );
+    icvBinPut( fs, &value, sizeof(value) );
 }
 
 
 static void
-icvXMLWriteString( CvFileStorage* fs, const char* key, const char* str, int quote )
+icvBinWriteString( CvFileStorage* fs, const char* key,
+                   const char* str, int /*quote*/ )
 {
-    char buf[CV_FS_MAX_LEN*6+16];
-    char* data = (char*)str;
-    int i, len;
-
     if( !str )
         CV_Error( CV_StsNullPtr, "Null string pointer" );
 
-    len = (int)strlen(str);
+    int len = (int)strlen(str);
     if( len > CV_FS_MAX_LEN )
         CV_Error( CV_StsBadArg, "The written string is too long" );
 
-    if( quote || len == 0 || str[0] != '\"' || str[0] != str[len-1] )
-    {
-        int need_quote = quote || len == 0;
-        data = buf;
-        *data++ = '\"';
-        for( i = 0; i < len; i++ )
-        {
-            char c = str[i];
-
-            if( (uchar)c >= 128 || c == ' ' )
-            {
-                *data++ = c;
-                need_quote = 1;
-            }
-            else if( !cv_isprint(c) || c == '<' || c == '>' || c == '&' || c == '\'' || c == '\"' )
-            {
-                *data++ = '&';
-                if( c == '<' )
-                {
-                    memcpy(data, "lt", 2);
-                    data += 2;
-                }
-                else if( c == '>' )
-                {
-                    memcpy(data, "gt", 2);
-                    data += 2;
-                }
-                else if( c == '&' )
-                {
-                    memcpy(data, "amp", 3);
-                    data += 3;
-                }
-                else if( c == '\'' )
-                {
-                    memcpy(data, "apos", 4);
-                    data += 4;
-                }
-                else if( c == '\"' )
-                {
-                    memcpy( data, "quot", 4);
-                    data += 4;
-                }
-                else
-                {
-                    sprintf( data, "#x%02x", (uchar)c );
-                    data += 4;
-                }
-                *data++ = ';';
-                need_quote = 1;
-            }
-            else
-                *data++ = c;
-        }
-        if( !need_quote && (cv_isdigit(str[0]) ||
-            str[0] == '+' || str[0] == '-' || str[0] == '.' ))
-            need_quote = 1;
-
-        if( need_quote )
-            *data++ = '\"';
-        len = (int)(data - buf) - !need_quote;
-        *data++ = '\0';
-        data = buf + !need_quote;
-    }
-
-    icvXMLWriteScalar( fs, key, data, len );
+    icvBinStartElem( fs, key, CV_FS_BIN_STRING );
+    icvBinPutString( fs, str, len );
 }
 
 
 static void
-icvXMLWriteComment( CvFileStorage* fs, const char* comment, int eol_comment )
+icvBinWriteComment( CvFileStorage* /*fs*/, const char* comment, int /*eol_comment*/ )
 {
-    int len;
-    int multiline;
-    const char* eol;
-    char* ptr;
-
+    // the comments are not stored in the binary storages
     if( !comment )
         CV_Error( CV_StsNullPtr, "Null comment" );
+}
 
-    if( strstr(comment, "--") != 0 )
-        CV_Error( CV_StsBadArg, "Double hyphen \'--\' is not allowed in the comments" );
-
-    len = (int)strlen(comment);
-    eol = strchr(comment, '\n');
-    multiline = eol != 0;
-    ptr = fs->buffer;
-
-    if( multiline || !eol_comment || fs->buffer_end - ptr < len + 5 )
-        ptr = icvXMLFlush( fs );
-    else if( ptr > fs->buffer_start + fs->struct_indent )
-        *ptr++ = ' ';
 
-    if( !multiline )
-    {
-        ptr = icvFSResizeWriteBuffer( fs, ptr, len + 9 );
-        sprintf( ptr, "<!-- %s -->", comment );
-        len = (int)strlen(ptr);
-    }
+/* writes the scalar of the raw data that can not be stored as is */
+static void
+icvBinWriteScalar( CvFileStorage* fs, const uchar* ptr, int elem_type )
+{
+    CvFileNode node;
+    memset( &node, 0, sizeof(node) );
+    icvRawScalarToNode( ptr, elem_type, &node );
+    if( CV_NODE_IS_INT(node.tag) )
+        icvBinWriteInt( fs, 0, node.data.i );
     else
-    {
-        strcpy( ptr, "<!--" );
-        len = 4;
-    }
+        icvBinWriteReal( fs, 0, node.data.f );
+}
 
-    fs->buffer = ptr + len;
-    ptr = icvXMLFlush(fs);
 
-    if( multiline )
+/* appends the data to the current raw record, or starts the new one */
+static void
+icvBinWriteRawData( CvFileStorage* fs, const uchar* data, int len, const char* dt, size_t elem_size )
+{
+    CvFSBinaryWriter* writer = fs->binwriter;
+
+    if( writer->raw_count == 0 || writer->raw_dt != dt )
     {
-        while( comment )
-        {
-            if( eol )
-            {
-                ptr = icvFSResizeWriteBuffer( fs, ptr, (int)(eol - comment) + 1 );
-                memcpy( ptr, comment, eol - comment + 1 );
-                ptr += eol - comment;
-                comment = eol + 1;
-                eol = strchr( comment, '\n' );
-            }
-            else
-            {
-                len = (int)strlen(comment);
-                ptr = icvFSResizeWriteBuffer( fs, ptr, len );
-                memcpy( ptr, comment, len );
-                ptr += len;
-                comment = 0;
-            }
-            fs->buffer = ptr;
-            ptr = icvXMLFlush( fs );
-        }
-        sprintf( ptr, "-->" );
-        fs->buffer = ptr + 3;
-        icvXMLFlush( fs );
+        icvBinStartElem( fs, 0, 0 );
+        writer->raw_dt = dt;
     }
+    writer->raw.insert( writer->raw.end(), data, data + len*elem_size );
+    writer->raw_count += len;
 }
 
 
@@ -2708,6 +3671,14 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
     if( mem && append )
         CV_Error( CV_StsBadFlag, "CV_STORAGE_APPEND and CV_STORAGE_MEMORY are not currently compatible" );
 
+    if( write_mode && (flags & CV_STORAGE_FORMAT_MASK) == CV_STORAGE_FORMAT_BINARY )
+    {
+        if( mem )
+            CV_Error( CV_StsBadFlag, "Binary file storages can not be written to memory" );
+        if( append )
+            CV_Error( CV_StsNotImplemented, "Appending data to binary file storages is not implemented" );
+    }
+
     fs = (CvFileStorage*)cvAlloc( sizeof(*fs) );
     memset( fs, 0, sizeof(*fs));
 
@@ -2738,7 +3709,8 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
 
         if( !isGZ )
         {
-            fs->file = fopen(fs->filename, !fs->write_mode ? "rt" : !append ? "wt" : "a+t" );
+            fs->file = fopen(fs->filename, !fs->write_mode ? "rt" : append ? "a+t" :
+                (flags & CV_STORAGE_FORMAT_MASK) == CV_STORAGE_FORMAT_BINARY ? "wb" : "wt" );
             if( !fs->file )
                 goto _exit_;
         }
@@ -2856,6 +3828,20 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
             fs->write_comment = icvXMLWriteComment;
             fs->start_next_stream = icvXMLStartNextStream;
         }
+        else if( fs->fmt == CV_STORAGE_FORMAT_BINARY )
+        {
+            int header[] = { CV_FS_BIN_BYTE_ORDER, 0 };
+            fs->binwriter = new CvFSBinaryWriter;
+            icvBinPut( fs, CV_FS_BIN_SIGNATURE, CV_FS_BIN_SIGNATURE_SIZE );
+            icvBinPut( fs, header, sizeof(header) );
+            fs->start_write_struct = icvBinStartWriteStruct;
+            fs->end_write_struct = icvBinEndWriteStruct;
+            fs->write_int = icvBinWriteInt;
+            fs->write_real = icvBinWriteReal;
+            fs->write_string = icvBinWriteString;
+            fs->write_comment = icvBinWriteComment;
+            fs->start_next_stream = icvBinStartNextStream;
+        }
         else
         {
             if( !append )
@@ -2881,10 +3867,27 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
 
         size_t buf_size = 1 << 20;
         const char* yaml_signature = "%YAML:";
+        const char* binary_signature = "%OPENCV-BIN:";
         char buf[16];
         icvGets( fs, buf, sizeof(buf)-2 );
         fs->fmt = strncmp( buf, yaml_signature, strlen(yaml_signature) ) == 0 ?
-            CV_STORAGE_FORMAT_YAML : CV_STORAGE_FORMAT_XML;
+            CV_STORAGE_FORMAT_YAML : strncmp( buf, binary_signature, strlen(binary_signature) ) == 0 ?
+            CV_STORAGE_FORMAT_BINARY : CV_STORAGE_FORMAT_XML;
+
+        if( fs->fmt == CV_STORAGE_FORMAT_BINARY )
+        {
+            if( mem )
+                CV_Error( CV_StsBadFlag, "Binary file storages can not be read from memory" );
+
+            fs->mapping = icvMapBinaryStorage( fs );
+            fs->str_hash = cvCreateMap( 0, sizeof(CvStringHash),
+                            sizeof(CvStringHashNode), fs->memstorage, 256 );
+            fs->roots = cvCreateSeq( 0, sizeof(CvSeq),
+                            sizeof(CvFileNode), fs->memstorage );
+            icvBinParse( fs );
+            fs->is_opened = true;
+            goto _exit_;
+        }
 
         if( !isGZ )
         {
@@ -3004,7 +4007,6 @@ cvStartNextStream( CvFileStorage* fs )
 
 
 static const char icvTypeSymbol[] = "ucwsifdr";
-#define CV_FS_MAX_FMT_PAIRS  128
 
 static char*
 icvEncodeFormat( int elem_type, char* dt )
@@ -3131,6 +4133,20 @@ cvWriteRawData( CvFileStorage* fs, const void* _data, int len, const char* dt )
     if( !data0 )
         CV_Error( CV_StsNullPtr, "Null data pointer" );
 
+    if( fs->fmt == CV_STORAGE_FORMAT_BINARY )
+    {
+        // the data is stored as is, unless it contains references or has irregular layout
+        int elem_size = icvCalcElemSize( dt, 0 );
+        for( k = 0; k < fmt_pair_count; k++ )
+            if( fmt_pairs[k*2+1] == CV_USRTYPE1 || elem_size % CV_ELEM_SIZE(fmt_pairs[k*2+1]) != 0 )
+                break;
+        if( k == fmt_pair_count )
+        {
+            icvBinWriteRawData( fs, (const uchar*)data0, len, dt, elem_size );
+            return;
+        }
+    }
+
     if( fmt_pair_count == 1 )
     {
         fmt_pairs[0] *= len;
@@ -3195,6 +4211,8 @@ cvWriteRawData( CvFileStorage* fs, const void* _data, int len, const char* dt )
                     int buf_len = (int)strlen(ptr);
                     icvXMLWriteScalar( fs, 0, ptr, buf_len );
                 }
+                else if( fs->fmt == CV_STORAGE_FORMAT_BINARY )
+                    icvBinWriteScalar( fs, (const uchar*)data - elem_size, elem_type );
                 else
                     icvYMLWrite( fs, 0, ptr );
             }
@@ -3225,7 +4243,15 @@ cvStartReadRawData( const CvFileStorage* fs, const CvFileNode* src, CvSeqReader*
     }
     else if( node_type == CV_NODE_SEQ )
     {
-        cvStartReadSeq( src->data.seq, reader, 0 );
+        if( CV_NODE_SEQ_IS_RAW(src->data.seq) )
+        {
+            // the data is read by cvReadRawDataSlice directly, delta_index is the read position;
+            // the zero header_size tells such a reader from the one started by cvStartReadSeq
+            memset( reader, 0, sizeof(*reader) );
+            reader->seq = src->data.seq;
+        }
+        else
+            cvStartReadSeq( src->data.seq, reader, 0 );
     }
     else if( node_type == CV_NODE_NONE )
     {
@@ -3252,6 +4278,12 @@ cvReadRawDataSlice( const CvFileStorage* fs, CvSeqReader* reader,
     if( !reader->seq && len != 1 )
         CV_Error( CV_StsBadSize, "The readed sequence is a scalar, thus len must be 1" );
 
+    if( reader->seq && reader->header_size == 0 && CV_NODE_SEQ_IS_RAW(reader->seq) )
+    {
+        icvReadRawSlice( fs, reader, len, data0, dt );
+        return;
+    }
+
     fmt_pair_count = icvDecodeFormat( dt, fmt_pairs, CV_FS_MAX_FMT_PAIRS );
 
     for(;;)
@@ -3411,6 +4443,18 @@ icvWriteCollection( CvFileStorage* fs, const CvFileNode* node )
     int is_map = CV_NODE_IS_MAP(node->tag);
     CvSeqReader reader;
 
+    if( !is_map && CV_NODE_SEQ_IS_RAW(node->data.seq) )
+    {
+        const CvFileNodeRawSeq* seq = (const CvFileNodeRawSeq*)node->data.seq;
+        int fmt_pairs[CV_FS_MAX_FMT_PAIRS*2], fmt_pair_count, cn = 0;
+
+        fmt_pair_count = icvDecodeFormat( seq->raw_dt, fmt_pairs, CV_FS_MAX_FMT_PAIRS );
+        for( i = 0; i < fmt_pair_count; i++ )
+            cn += fmt_pairs[i*2];
+        cvWriteRawData( fs, seq->raw_data, total/cn, seq->raw_dt );
+        return;
+    }
+
     cvStartReadSeq( node->data.seq, &reader, 0 );
 
     for( i = 0; i < total; i++ )
@@ -3576,7 +4620,7 @@ icvReadMat( CvFileStorage* fs, CvFileNode* node )
 
     elem_type = icvDecodeSimpleFormat( dt );
 
-    data = cvGetFileNodeByName( fs, node, "data" );
+    data = icvGetFileNodeByName( fs, node, "data" );
     if( !data )
         CV_Error( CV_StsError, "The matrix data is not found in file storage" );
 
@@ -3668,7 +4712,7 @@ icvReadMatND( CvFileStorage* fs, CvFileNode* node )
     cvReadRawData( fs, sizes_node, sizes, "i" );
     elem_type = icvDecodeSimpleFormat( dt );
 
-    data = cvGetFileNodeByName( fs, node, "data" );
+    data = icvGetFileNodeByName( fs, node, "data" );
     if( !data )
         CV_Error( CV_StsError, "The matrix data is not found in file storage" );
 
@@ -3957,7 +5001,7 @@ icvReadImage( CvFileStorage* fs, CvFileNode* node )
     if( strcmp( data_order, "interleaved" ) != 0 )
         CV_Error( CV_StsError, "Only interleaved images can be read" );
 
-    data = cvGetFileNodeByName( fs, node, "data" );
+    data = icvGetFileNodeByName( fs, node, "data" );
     if( !data )
         CV_Error( CV_StsError, "The image data is not found in file storage" );
 
@@ -4995,6 +6039,7 @@ cvRead( CvFileStorage* fs, CvFileNode* node, CvAttrList* list )
     if( !CV_NODE_IS_USER(node->tag) || !node->info )
         CV_Error( CV_StsError, "The node does not represent a user object (unknown type?)" );
 
+    icvDecodeNodeTree( fs, node );
     obj = node->info->read( fs, node );
     if( list )
         *list = cvAttrList(0,0);
@@ -5209,7 +6254,9 @@ string FileStorage::releaseAndGetString()
     
 FileNode FileStorage::root(int streamidx) const
 {
-    return isOpened() ? FileNode(fs, cvGetRootFileNode(fs, streamidx)) : FileNode();
+    if( !isOpened() || !fs->roots || (unsigned)streamidx >= (unsigned)fs->roots->total )
+        return FileNode();
+    return FileNode(fs, (CvFileNode*)cvGetSeqElem(fs->roots, streamidx));
 }
 
 FileStorage& operator << (FileStorage& fs, const string& str)
@@ -5271,6 +6318,76 @@ FileStorage& operator << (FileStorage& fs, const string& str)
 }
 
 
+static void icvConvertFileNode( CvFileStorage* src, CvFileStorage* dst,
+                                const char* name, CvFileNode* node );
+
+static void icvConvertCollection( CvFileStorage* src, CvFileStorage* dst, CvFileNode* node )
+{
+    if( CV_NODE_IS_SEQ(node->tag) && CV_NODE_SEQ_IS_RAW(node->data.seq) )
+    {
+        icvWriteCollection( dst, node );
+        return;
+    }
+
+    int i, total = node->data.seq->total;
+    int elem_size = node->data.seq->elem_size;
+    int is_map = CV_NODE_IS_MAP(node->tag);
+    CvSeqReader reader;
+
+    cvStartReadSeq( node->data.seq, &reader, 0 );
+    for( i = 0; i < total; i++ )
+    {
+        CvFileMapNode* elem = (CvFileMapNode*)reader.ptr;
+        if( !is_map || CV_IS_SET_ELEM(elem) )
+            icvConvertFileNode( src, dst, is_map ? elem->key->str.ptr : 0, &elem->value );
+        CV_NEXT_SEQ_ELEM( elem_size, reader );
+    }
+}
+
+static void icvConvertFileNode( CvFileStorage* src, CvFileStorage* dst,
+                                const char* name, CvFileNode* node )
+{
+    const char* type_name = CV_NODE_IS_USER(node->tag) && node->info ? node->info->type_name : 0;
+
+    if( type_name && (strcmp(type_name, CV_TYPE_NAME_MAT) == 0 ||
+                      strcmp(type_name, CV_TYPE_NAME_MATND) == 0) )
+    {
+        // the dense matrices are re-encoded to store their data as raw binary data
+        void* obj = cvRead( src, node );
+        cvWrite( dst, name, obj );
+        cvRelease( &obj );
+    }
+    else if( CV_NODE_IS_COLLECTION(node->tag) )
+    {
+        dst->start_write_struct( dst, name, CV_NODE_TYPE(node->tag) +
+                (CV_NODE_SEQ_IS_SIMPLE(node->data.seq) ? CV_NODE_FLOW : 0),
+                node->info ? node->info->type_name : 0 );
+        icvConvertCollection( src, dst, node );
+        dst->end_write_struct( dst );
+    }
+    else
+        icvWriteFileNode( dst, name, node );
+}
+
+void FileStorage::convert( const string& srcFilename, const string& dstFilename, int dstFormat )
+{
+    Ptr<CvFileStorage> src = cvOpenFileStorage( srcFilename.c_str(), 0, CV_STORAGE_READ );
+    if( src.empty() )
+        CV_Error_( CV_StsError, ("Could not open %s for reading", srcFilename.c_str()) );
+    Ptr<CvFileStorage> dst = cvOpenFileStorage( dstFilename.c_str(), 0,
+                                    CV_STORAGE_WRITE + (dstFormat & FORMAT_MASK) );
+    if( dst.empty() )
+        CV_Error_( CV_StsError, ("Could not open %s for writing", dstFilename.c_str()) );
+
+    for( int i = 0; i < src->roots->total; i++ )
+    {
+        if( i > 0 )
+            cvStartNextStream( dst );
+        icvConvertCollection( src, dst, (CvFileNode*)cvGetSeqElem( src->roots, i ) );
+    }
+}
+
+
 void FileStorage::writeRaw( const string& fmt, const uchar* vec, size_t len )
 {
     if( !isOpened() )
@@ -5290,32 +6407,48 @@ void FileStorage::writeObj( const string& name, const void* obj )
 }
 
 
+// the C++ readers keep the lazy sequences as is, and decode them only when the elements are
+// accessed one by one; the nodes passed to the C API are decoded with all the nested sequences
+
 FileNode FileStorage::operator[](const string& nodename) const
 {
-    return FileNode(fs, cvGetFileNodeByName(fs, 0, nodename.c_str()));
+    return FileNode(fs, icvGetFileNodeByName(fs, 0, nodename.c_str()));
 }
 
 FileNode FileStorage::operator[](const char* nodename) const
 {
-    return FileNode(fs, cvGetFileNodeByName(fs, 0, nodename));
+    return FileNode(fs, icvGetFileNodeByName(fs, 0, nodename));
 }
 
 FileNode FileNode::operator[](const string& nodename) const
 {
-    return FileNode(fs, cvGetFileNodeByName(fs, node, nodename.c_str()));
+    return FileNode(fs, icvGetFileNodeByName(fs, node, nodename.c_str()));
 }
 
 FileNode FileNode::operator[](const char* nodename) const
 {
-    return FileNode(fs, cvGetFileNodeByName(fs, node, nodename));
+    return FileNode(fs, icvGetFileNodeByName(fs, node, nodename));
 }
 
 FileNode FileNode::operator[](int i) const
 {
+    icvDecodeNode( node );
     return isSeq() ? FileNode(fs, (CvFileNode*)cvGetSeqElem(node->data.seq, i)) :
         i == 0 ? *this : FileNode();
 }
 
+CvFileNode* FileNode::operator *()
+{
+    icvDecodeNodeTree( fs, node );
+    return (CvFileNode*)node;
+}
+
+const CvFileNode* FileNode::operator* () const
+{
+    icvDecodeNodeTree( fs, node );
+    return node;
+}
+
 string FileNode::name() const
 {
     const char* str;
@@ -5347,6 +6480,7 @@ FileNodeIterator::FileNodeIterator(const CvFileStorage* _fs,
         container = _node;
         if( !(_node->tag & FileNode::USER) && (node_type == FileNode::SEQ || node_type == FileNode::MAP) )
         {
+            icvDecodeNode( _node );
             cvStartReadSeq( _node->data.seq, &reader );
             remaining = FileNode(_fs, _node).size();
         }
@@ -5515,6 +6649,112 @@ WriteStructContext::WriteStructContext(FileStorage& _fs, const string& name,
 WriteStructContext::~WriteStructContext() { cvEndWriteStruct(**fs); }
 
 
+/*
+  The matrices read from binary storages share the data with the mapping: the reference counter
+  of such a matrix keeps the mapping alive. The matrices allocated later by the same Mat headers
+  are allocated by the same allocator, so it allocates the regular memory as well.
+*/
+struct MappedMatRefcount
+{
+    int refcount;
+    CvFSMapping* mapping;
+};
+
+class MappedMatAllocator : public MatAllocator
+{
+public:
+    void allocate(int dims, const int* sizes, int type, int*& refcount,
+                  uchar*& datastart, uchar*& data, size_t* step)
+    {
+        size_t total = CV_ELEM_SIZE(type);
+        for( int i = dims-1; i >= 0; i-- )
+        {
+            step[i] = total;
+            total *= sizes[i];
+        }
+        MappedMatRefcount* u = new MappedMatRefcount;
+        u->refcount = 1;
+        u->mapping = 0;
+        refcount = &u->refcount;
+        datastart = data = (uchar*)fastMalloc(total);
+    }
+
+    void deallocate(int* refcount, uchar* datastart, uchar* /*data*/)
+    {
+        MappedMatRefcount* u = (MappedMatRefcount*)refcount;
+        if( u->mapping )
+            icvReleaseMapping(u->mapping);
+        else
+            fastFree(datastart);
+        delete u;
+    }
+};
+
+static MappedMatAllocator mappedMatAllocator;
+
+// makes the matrix header for the dense matrix data stored in the binary storage mapping
+static bool readMappedMat( const FileNode& node, Mat& mat )
+{
+    const CvFileStorage* fs = node.fs;
+    const CvFileNode* n = node.node;
+    int sizes[CV_MAX_DIM], dims, type, total;
+
+    if( !fs->mapping || !CV_NODE_IS_USER(n->tag) || !n->info )
+        return false;
+    bool isMat = strcmp(n->info->type_name, CV_TYPE_NAME_MAT) == 0;
+    if( !isMat && strcmp(n->info->type_name, CV_TYPE_NAME_MATND) != 0 )
+        return false;
+
+    const CvFileNode* data = icvGetFileNodeByName(fs, n, "data");
+    const char* dt = cvReadStringByName(fs, n, "dt", 0);
+    if( !data || !dt || !CV_NODE_IS_SEQ(data->tag) || !CV_NODE_SEQ_IS_RAW(data->data.seq) )
+        return false;
+    const CvFileNodeRawSeq* seq = (const CvFileNodeRawSeq*)data->data.seq;
+
+    int fmt_pairs[CV_FS_MAX_FMT_PAIRS*2];
+    if( icvDecodeFormat(seq->raw_dt, fmt_pairs, CV_FS_MAX_FMT_PAIRS) != 1 || fmt_pairs[0] > 4 )
+        return false;
+    type = CV_MAKETYPE(fmt_pairs[1], fmt_pairs[0]);
+    if( type != icvDecodeSimpleFormat(dt) )
+        return false;
+
+    if( isMat )
+    {
+        dims = 2;
+        sizes[0] = cvReadIntByName(fs, n, "rows", -1);
+        sizes[1] = cvReadIntByName(fs, n, "cols", -1);
+    }
+    else
+    {
+        const CvFileNode* sizes_node = icvGetFileNodeByName(fs, n, "sizes");
+        dims = !sizes_node ? 0 : CV_NODE_IS_SEQ(sizes_node->tag) ? sizes_node->data.seq->total :
+            CV_NODE_IS_INT(sizes_node->tag) ? 1 : 0;
+        if( dims <= 0 || dims > CV_MAX_DIM )
+            return false;
+        cvReadRawData(fs, sizes_node, sizes, "i");
+    }
+
+    total = CV_MAT_CN(type);
+    for( int i = 0; i < dims; i++ )
+    {
+        if( sizes[i] <= 0 )
+            return false;
+        total *= sizes[i];
+    }
+    if( total != seq->total )
+        return false;
+
+    Mat m(dims, sizes, type, (void*)seq->raw_data);
+    MappedMatRefcount* u = new MappedMatRefcount;
+    u->refcount = 1;
+    u->mapping = fs->mapping;
+    CV_XADD(&fs->mapping->refcount, 1);
+    m.refcount = &u->refcount;
+    m.allocator = &mappedMatAllocator;
+    mat = m;
+    return true;
+}
+
 void read( const FileNode& node, Mat& mat, const Mat& default_mat )
 {
     if( node.empty() )
@@ -5522,6 +6762,11 @@ void read( const FileNode& node, Mat& mat, const Mat& default_mat )
         default_mat.copyTo(mat);
         return;
     }
+    // do not overwrite the data shared with the mapping
+    if( mat.allocator == &mappedMatAllocator )
+        mat.release();
+    if( mat.empty() && readMappedMat(node, mat) )
+        return;
     void* obj = cvRead((CvFileStorage*)node.fs, (CvFileNode*)*node);
     if(CV_IS_MAT_HDR_Z(obj))
     {
@@ -0,0 +1,723 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+/* ////////////////////////////////////////////////////////////////////
+//
+//  AVX2/FMA versions of the element-wise arithmetic, convertTo and math kernels.
+//  The file is compiled with the AVX2 instructions enabled (see core/CMakeLists.txt),
+//  the functions are called from arithm.cpp, convert.cpp and mathfuncs.cpp when USE_AVX2 is set.
+//
+// */
+
+#include "precomp.hpp"
+#include "simd_avx2.hpp"
+
+#ifdef HAVE_AVX2_DISPATCH
+
+#include <immintrin.h>
+
+namespace cv
+{
+namespace avx2
+{
+
+/****************************************************************************************\
+*                              Element-wise binary operations                            *
+\****************************************************************************************/
+
+struct _VAdd8u { __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_adds_epu8(a,b); }};
+struct _VSub8u { __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_subs_epu8(a,b); }};
+struct _VMin8u { __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_min_epu8(a,b); }};
+struct _VMax8u { __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_max_epu8(a,b); }};
+struct _VAbsDiff8u
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const
+    { return _mm256_add_epi8(_mm256_subs_epu8(a,b),_mm256_subs_epu8(b,a)); }
+};
+
+struct _VAdd8s { __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_adds_epi8(a,b); }};
+struct _VSub8s { __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_subs_epi8(a,b); }};
+struct _VMin8s { __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_min_epi8(a,b); }};
+struct _VMax8s { __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_max_epi8(a,b); }};
+struct _VAbsDiff8s
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const
+    {
+        __m256i d = _mm256_subs_epi8(a, b);
+        __m256i m = _mm256_cmpgt_epi8(b, a);
+        return _mm256_subs_epi8(_mm256_xor_si256(d, m), m);
+    }
+};
+
+struct _VAdd16u { __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_adds_epu16(a,b); }};
+struct _VSub16u { __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_subs_epu16(a,b); }};
+struct _VMin16u { __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_min_epu16(a,b); }};
+struct _VMax16u { __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_max_epu16(a,b); }};
+struct _VAbsDiff16u
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const
+    { return _mm256_add_epi16(_mm256_subs_epu16(a,b),_mm256_subs_epu16(b,a)); }
+};
+
+struct _VAdd16s { __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_adds_epi16(a,b); }};
+struct _VSub16s { __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_subs_epi16(a,b); }};
+struct _VMin16s { __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_min_epi16(a,b); }};
+struct _VMax16s { __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_max_epi16(a,b); }};
+struct _VAbsDiff16s
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const
+    { return _mm256_subs_epi16(_mm256_max_epi16(a,b), _mm256_min_epi16(a,b)); }
+};
+
+struct _VAdd32s { __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_add_epi32(a,b); }};
+struct _VSub32s { __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_sub_epi32(a,b); }};
+struct _VMin32s { __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_min_epi32(a,b); }};
+struct _VMax32s { __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_max_epi32(a,b); }};
+struct _VAbsDiff32s
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const
+    {
+        __m256i d = _mm256_sub_epi32(a, b);
+        __m256i m = _mm256_cmpgt_epi32(b, a);
+        return _mm256_sub_epi32(_mm256_xor_si256(d, m), m);
+    }
+};
+
+struct _VAnd8u { __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_and_si256(a,b); }};
+struct _VOr8u  { __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_or_si256(a,b); }};
+struct _VXor8u { __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_xor_si256(a,b); }};
+struct _VNot8u { __m256i operator()(const __m256i& a, const __m256i&) const { return _mm256_xor_si256(_mm256_set1_epi32(-1),a); }};
+
+struct _VAdd32f { __m256 operator()(const __m256& a, const __m256& b) const { return _mm256_add_ps(a,b); }};
+struct _VSub32f { __m256 operator()(const __m256& a, const __m256& b) const { return _mm256_sub_ps(a,b); }};
+struct _VMin32f { __m256 operator()(const __m256& a, const __m256& b) const { return _mm256_min_ps(a,b); }};
+struct _VMax32f { __m256 operator()(const __m256& a, const __m256& b) const { return _mm256_max_ps(a,b); }};
+struct _VAbsDiff32f
+{
+    __m256 operator()(const __m256& a, const __m256& b) const
+    { return _mm256_and_ps(_mm256_sub_ps(a,b), _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff))); }
+};
+
+struct _VAdd64f { __m256d operator()(const __m256d& a, const __m256d& b) const { return _mm256_add_pd(a,b); }};
+struct _VSub64f { __m256d operator()(const __m256d& a, const __m256d& b) const { return _mm256_sub_pd(a,b); }};
+struct _VMin64f { __m256d operator()(const __m256d& a, const __m256d& b) const { return _mm256_min_pd(a,b); }};
+struct _VMax64f { __m256d operator()(const __m256d& a, const __m256d& b) const { return _mm256_max_pd(a,b); }};
+struct _VAbsDiff64f
+{
+    __m256d operator()(const __m256d& a, const __m256d& b) const
+    { return _mm256_and_pd(_mm256_sub_pd(a,b), _mm256_castsi256_pd(_mm256_set1_epi64x(0x7fffffffffffffffLL))); }
+};
+
+template<typename T, class VOp> static int
+vBinOpInt( const T* src1, const T* src2, T* dst, int len )
+{
+    const int v = (int)(32/sizeof(T));
+    VOp op;
+    int x = 0;
+
+    for( ; x <= len - v*2; x += v*2 )
+    {
+        __m256i r0 = _mm256_loadu_si256((const __m256i*)(src1 + x));
+        __m256i r1 = _mm256_loadu_si256((const __m256i*)(src1 + x + v));
+        r0 = op(r0, _mm256_loadu_si256((const __m256i*)(src2 + x)));
+        r1 = op(r1, _mm256_loadu_si256((const __m256i*)(src2 + x + v)));
+        _mm256_storeu_si256((__m256i*)(dst + x), r0);
+        _mm256_storeu_si256((__m256i*)(dst + x + v), r1);
+    }
+    for( ; x <= len - v; x += v )
+    {
+        __m256i r0 = _mm256_loadu_si256((const __m256i*)(src1 + x));
+        r0 = op(r0, _mm256_loadu_si256((const __m256i*)(src2 + x)));
+        _mm256_storeu_si256((__m256i*)(dst + x), r0);
+    }
+    return x;
+}
+
+template<class VOp> static int
+vBinOp32f( const float* src1, const float* src2, float* dst, int len )
+{
+    VOp op;
+    int x = 0;
+
+    for( ; x <= len - 16; x += 16 )
+    {
+        __m256 r0 = _mm256_loadu_ps(src1 + x);
+        __m256 r1 = _mm256_loadu_ps(src1 + x + 8);
+        r0 = op(r0, _mm256_loadu_ps(src2 + x));
+        r1 = op(r1, _mm256_loadu_ps(src2 + x + 8));
+        _mm256_storeu_ps(dst + x, r0);
+        _mm256_storeu_ps(dst + x + 8, r1);
+    }
+    return x;
+}
+
+template<class VOp> static int
+vBinOp64f( const double* src1, const double* src2, double* dst, int len )
+{
+    VOp op;
+    int x = 0;
+
+    for( ; x <= len - 8; x += 8 )
+    {
+        __m256d r0 = _mm256_loadu_pd(src1 + x);
+        __m256d r1 = _mm256_loadu_pd(src1 + x + 4);
+        r0 = op(r0, _mm256_loadu_pd(src2 + x));
+        r1 = op(r1, _mm256_loadu_pd(src2 + x + 4));
+        _mm256_storeu_pd(dst + x, r0);
+        _mm256_storeu_pd(dst + x + 4, r1);
+    }
+    return x;
+}
+
+#define DEF_BIN_OP(name, T, impl) \
+int name::operator()(const T* src1, const T* src2, T* dst, int len) const \
+{ return impl<_##name>(src1, src2, dst, len); }
+
+#define DEF_BIN_OP_INT(name, T) \
+int name::operator()(const T* src1, const T* src2, T* dst, int len) const \
+{ return vBinOpInt<T, _##name>(src1, src2, dst, len); }
+
+DEF_BIN_OP_INT(VAdd8u, uchar)
+DEF_BIN_OP_INT(VSub8u, uchar)
+DEF_BIN_OP_INT(VMin8u, uchar)
+DEF_BIN_OP_INT(VMax8u, uchar)
+DEF_BIN_OP_INT(VAbsDiff8u, uchar)
+
+DEF_BIN_OP_INT(VAdd8s, schar)
+DEF_BIN_OP_INT(VSub8s, schar)
+DEF_BIN_OP_INT(VMin8s, schar)
+DEF_BIN_OP_INT(VMax8s, schar)
+DEF_BIN_OP_INT(VAbsDiff8s, schar)
+
+DEF_BIN_OP_INT(VAdd16u, ushort)
+DEF_BIN_OP_INT(VSub16u, ushort)
+DEF_BIN_OP_INT(VMin16u, ushort)
+DEF_BIN_OP_INT(VMax16u, ushort)
+DEF_BIN_OP_INT(VAbsDiff16u, ushort)
+
+DEF_BIN_OP_INT(VAdd16s, short)
+DEF_BIN_OP_INT(VSub16s, short)
+DEF_BIN_OP_INT(VMin16s, short)
+DEF_BIN_OP_INT(VMax16s, short)
+DEF_BIN_OP_INT(VAbsDiff16s, short)
+
+DEF_BIN_OP_INT(VAdd32s, int)
+DEF_BIN_OP_INT(VSub32s, int)
+DEF_BIN_OP_INT(VMin32s, int)
+DEF_BIN_OP_INT(VMax32s, int)
+DEF_BIN_OP_INT(VAbsDiff32s, int)
+
+DEF_BIN_OP_INT(VAnd8u, uchar)
+DEF_BIN_OP_INT(VOr8u, uchar)
+DEF_BIN_OP_INT(VXor8u, uchar)
+DEF_BIN_OP_INT(VNot8u, uchar)
+
+DEF_BIN_OP(VAdd32f, float, vBinOp32f)
+DEF_BIN_OP(VSub32f, float, vBinOp32f)
+DEF_BIN_OP(VMin32f, float, vBinOp32f)
+DEF_BIN_OP(VMax32f, float, vBinOp32f)
+DEF_BIN_OP(VAbsDiff32f, float, vBinOp32f)
+
+DEF_BIN_OP(VAdd64f, double, vBinOp64f)
+DEF_BIN_OP(VSub64f, double, vBinOp64f)
+DEF_BIN_OP(VMin64f, double, vBinOp64f)
+DEF_BIN_OP(VMax64f, double, vBinOp64f)
+DEF_BIN_OP(VAbsDiff64f, double, vBinOp64f)
+
+#undef DEF_BIN_OP
+#undef DEF_BIN_OP_INT
+
+/****************************************************************************************\
+*                                        convertTo                                       *
+\****************************************************************************************/
+
+static inline __m256 load8u32f( const uchar* src )
+{
+    return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)src)));
+}
+
+// rounds 16 floats to the nearest integers and packs them with saturation
+static inline __m256i pack32f16s( const __m256& f0, const __m256& f1 )
+{
+    __m256i r = _mm256_packs_epi32(_mm256_cvtps_epi32(f0), _mm256_cvtps_epi32(f1));
+    return _mm256_permute4x64_epi64(r, 0xD8);
+}
+
+static inline __m256i pack32f16u( const __m256& f0, const __m256& f1 )
+{
+    __m256i r = _mm256_packus_epi32(_mm256_cvtps_epi32(f0), _mm256_cvtps_epi32(f1));
+    return _mm256_permute4x64_epi64(r, 0xD8);
+}
+
+static inline __m128i pack32f8u( const __m256& f0, const __m256& f1 )
+{
+    __m256i r = pack32f16s(f0, f1);
+    return _mm_packus_epi16(_mm256_castsi256_si128(r), _mm256_extracti128_si256(r, 1));
+}
+
+int cvt8u32f( const uchar* src, float* dst, int len )
+{
+    int x = 0;
+    for( ; x <= len - 16; x += 16 )
+    {
+        _mm256_storeu_ps(dst + x, load8u32f(src + x));
+        _mm256_storeu_ps(dst + x + 8, load8u32f(src + x + 8));
+    }
+    return x;
+}
+
+int cvt16u32f( const ushort* src, float* dst, int len )
+{
+    int x = 0;
+    for( ; x <= len - 8; x += 8 )
+    {
+        __m256i r = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(src + x)));
+        _mm256_storeu_ps(dst + x, _mm256_cvtepi32_ps(r));
+    }
+    return x;
+}
+
+int cvt16s32f( const short* src, float* dst, int len )
+{
+    int x = 0;
+    for( ; x <= len - 8; x += 8 )
+    {
+        __m256i r = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(src + x)));
+        _mm256_storeu_ps(dst + x, _mm256_cvtepi32_ps(r));
+    }
+    return x;
+}
+
+int cvt32s32f( const int* src, float* dst, int len )
+{
+    int x = 0;
+    for( ; x <= len - 8; x += 8 )
+    {
+        __m256i r = _mm256_loadu_si256((const __m256i*)(src + x));
+        _mm256_storeu_ps(dst + x, _mm256_cvtepi32_ps(r));
+    }
+    return x;
+}
+
+int cvt32f8u( const float* src, uchar* dst, int len )
+{
+    int x = 0;
+    for( ; x <= len - 16; x += 16 )
+    {
+        __m128i r = pack32f8u(_mm256_loadu_ps(src + x), _mm256_loadu_ps(src + x + 8));
+        _mm_storeu_si128((__m128i*)(dst + x), r);
+    }
+    return x;
+}
+
+int cvt32f16u( const float* src, ushort* dst, int len )
+{
+    int x = 0;
+    for( ; x <= len - 16; x += 16 )
+    {
+        __m256i r = pack32f16u(_mm256_loadu_ps(src + x), _mm256_loadu_ps(src + x + 8));
+        _mm256_storeu_si256((__m256i*)(dst + x), r);
+    }
+    return x;
+}
+
+int cvt32f16s( const float* src, short* dst, int len )
+{
+    int x = 0;
+    for( ; x <= len - 16; x += 16 )
+    {
+        __m256i r = pack32f16s(_mm256_loadu_ps(src + x), _mm256_loadu_ps(src + x + 8));
+        _mm256_storeu_si256((__m256i*)(dst + x), r);
+    }
+    return x;
+}
+
+int cvt32f32s( const float* src, int* dst, int len )
+{
+    int x = 0;
+    for( ; x <= len - 8; x += 8 )
+        _mm256_storeu_si256((__m256i*)(dst + x), _mm256_cvtps_epi32(_mm256_loadu_ps(src + x)));
+    return x;
+}
+
+int cvtScale8u( const uchar* src, uchar* dst, int len, float scale, float shift )
+{
+    __m256 scale8 = _mm256_set1_ps(scale), shift8 = _mm256_set1_ps(shift);
+    int x = 0;
+    for( ; x <= len - 16; x += 16 )
+    {
+        __m256 f0 = _mm256_add_ps(_mm256_mul_ps(load8u32f(src + x), scale8), shift8);
+        __m256 f1 = _mm256_add_ps(_mm256_mul_ps(load8u32f(src + x + 8), scale8), shift8);
+        _mm_storeu_si128((__m128i*)(dst + x), pack32f8u(f0, f1));
+    }
+    return x;
+}
+
+int cvtScale8u32f( const uchar* src, float* dst, int len, float scale, float shift )
+{
+    __m256 scale8 = _mm256_set1_ps(scale), shift8 = _mm256_set1_ps(shift);
+    int x = 0;
+    for( ; x <= len - 16; x += 16 )
+    {
+        __m256 f0 = _mm256_add_ps(_mm256_mul_ps(load8u32f(src + x), scale8), shift8);
+        __m256 f1 = _mm256_add_ps(_mm256_mul_ps(load8u32f(src + x + 8), scale8), shift8);
+        _mm256_storeu_ps(dst + x, f0);
+        _mm256_storeu_ps(dst + x + 8, f1);
+    }
+    return x;
+}
+
+int cvtScale16u32f( const ushort* src, float* dst, int len, float scale, float shift )
+{
+    __m256 scale8 = _mm256_set1_ps(scale), shift8 = _mm256_set1_ps(shift);
+    int x = 0;
+    for( ; x <= len - 8; x += 8 )
+    {
+        __m256i r = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(src + x)));
+        __m256 f = _mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(r), scale8), shift8);
+        _mm256_storeu_ps(dst + x, f);
+    }
+    return x;
+}
+
+int cvtScale16s32f( const short* src, float* dst, int len, float scale, float shift )
+{
+    __m256 scale8 = _mm256_set1_ps(scale), shift8 = _mm256_set1_ps(shift);
+    int x = 0;
+    for( ; x <= len - 8; x += 8 )
+    {
+        __m256i r = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(src + x)));
+        __m256 f = _mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(r), scale8), shift8);
+        _mm256_storeu_ps(dst + x, f);
+    }
+    return x;
+}
+
+int cvtScale16s( const short* src, short* dst, int len, float scale, float shift )
+{
+    __m256 scale8 = _mm256_set1_ps(scale), shift8 = _mm256_set1_ps(shift);
+    int x = 0;
+    for( ; x <= len - 16; x += 16 )
+    {
+        __m256i r0 = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(src + x)));
+        __m256i r1 = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(src + x + 8)));
+        __m256 f0 = _mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(r0), scale8), shift8);
+        __m256 f1 = _mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(r1), scale8), shift8);
+        _mm256_storeu_si256((__m256i*)(dst + x), pack32f16s(f0, f1));
+    }
+    return x;
+}
+
+int cvtScale32f( const float* src, float* dst, int len, float scale, float shift )
+{
+    __m256 scale8 = _mm256_set1_ps(scale), shift8 = _mm256_set1_ps(shift);
+    int x = 0;
+    for( ; x <= len - 16; x += 16 )
+    {
+        __m256 f0 = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(src + x), scale8), shift8);
+        __m256 f1 = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(src + x + 8), scale8), shift8);
+        _mm256_storeu_ps(dst + x, f0);
+        _mm256_storeu_ps(dst + x + 8, f1);
+    }
+    return x;
+}
+
+int cvtScale32f8u( const float* src, uchar* dst, int len, float scale, float shift )
+{
+    __m256 scale8 = _mm256_set1_ps(scale), shift8 = _mm256_set1_ps(shift);
+    int x = 0;
+    for( ; x <= len - 16; x += 16 )
+    {
+        __m256 f0 = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(src + x), scale8), shift8);
+        __m256 f1 = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(src + x + 8), scale8), shift8);
+        _mm_storeu_si128((__m128i*)(dst + x), pack32f8u(f0, f1));
+    }
+    return x;
+}
+
+int cvtScale32f16s( const float* src, short* dst, int len, float scale, float shift )
+{
+    __m256 scale8 = _mm256_set1_ps(scale), shift8 = _mm256_set1_ps(shift);
+    int x = 0;
+    for( ; x <= len - 16; x += 16 )
+    {
+        __m256 f0 = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(src + x), scale8), shift8);
+        __m256 f1 = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(src + x + 8), scale8), shift8);
+        _mm256_storeu_si256((__m256i*)(dst + x), pack32f16s(f0, f1));
+    }
+    return x;
+}
+
+/****************************************************************************************\
+*                                     Math functions                                     *
+\****************************************************************************************/
+
+int magnitude32f( const float* x, const float* y, float* mag, int len )
+{
+    int i = 0;
+    for( ; i <= len - 16; i += 16 )
+    {
+        __m256 x0 = _mm256_loadu_ps(x + i), x1 = _mm256_loadu_ps(x + i + 8);
+        __m256 y0 = _mm256_loadu_ps(y + i), y1 = _mm256_loadu_ps(y + i + 8);
+        x0 = _mm256_fmadd_ps(x0, x0, _mm256_mul_ps(y0, y0));
+        x1 = _mm256_fmadd_ps(x1, x1, _mm256_mul_ps(y1, y1));
+        _mm256_storeu_ps(mag + i, _mm256_sqrt_ps(x0));
+        _mm256_storeu_ps(mag + i + 8, _mm256_sqrt_ps(x1));
+    }
+    return i;
+}
+
+int magnitude64f( const double* x, const double* y, double* mag, int len )
+{
+    int i = 0;
+    for( ; i <= len - 8; i += 8 )
+    {
+        __m256d x0 = _mm256_loadu_pd(x + i), x1 = _mm256_loadu_pd(x + i + 4);
+        __m256d y0 = _mm256_loadu_pd(y + i), y1 = _mm256_loadu_pd(y + i + 4);
+        x0 = _mm256_fmadd_pd(x0, x0, _mm256_mul_pd(y0, y0));
+        x1 = _mm256_fmadd_pd(x1, x1, _mm256_mul_pd(y1, y1));
+        _mm256_storeu_pd(mag + i, _mm256_sqrt_pd(x0));
+        _mm256_storeu_pd(mag + i + 4, _mm256_sqrt_pd(x1));
+    }
+    return i;
+}
+
+// the polynomial coefficients are the same as in mathfuncs.cpp
+static const float atan2_p1 = 0.9997878412794807f*(float)(180/CV_PI);
+static const float atan2_p3 = -0.3258083974640975f*(float)(180/CV_PI);
+static const float atan2_p5 = 0.1555786518463281f*(float)(180/CV_PI);
+static const float atan2_p7 = -0.04432655554792128f*(float)(180/CV_PI);
+
+int fastAtan2_32f( const float* Y, const float* X, float* angle, int len, float scale )
+{
+    __m256 eps = _mm256_set1_ps((float)DBL_EPSILON);
+    __m256 absmask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    __m256 _90 = _mm256_set1_ps(90.f), _180 = _mm256_set1_ps(180.f), _360 = _mm256_set1_ps(360.f);
+    __m256 z = _mm256_setzero_ps(), scale8 = _mm256_set1_ps(scale);
+    __m256 p1 = _mm256_set1_ps(atan2_p1), p3 = _mm256_set1_ps(atan2_p3);
+    __m256 p5 = _mm256_set1_ps(atan2_p5), p7 = _mm256_set1_ps(atan2_p7);
+    int i = 0;
+
+    for( ; i <= len - 8; i += 8 )
+    {
+        __m256 x = _mm256_loadu_ps(X + i), y = _mm256_loadu_ps(Y + i);
+        __m256 ax = _mm256_and_ps(x, absmask), ay = _mm256_and_ps(y, absmask);
+        __m256 mask = _mm256_cmp_ps(ax, ay, _CMP_LT_OQ);
+        __m256 tmin = _mm256_min_ps(ax, ay), tmax = _mm256_max_ps(ax, ay);
+        __m256 c = _mm256_div_ps(tmin, _mm256_add_ps(tmax, eps));
+        __m256 c2 = _mm256_mul_ps(c, c);
+        __m256 a = _mm256_fmadd_ps(c2, p7, p5);
+        a = _mm256_fmadd_ps(a, c2, p3);
+        a = _mm256_fmadd_ps(a, c2, p1);
+        a = _mm256_mul_ps(a, c);
+
+        a = _mm256_blendv_ps(a, _mm256_sub_ps(_90, a), mask);
+        a = _mm256_blendv_ps(a, _mm256_sub_ps(_180, a), _mm256_cmp_ps(x, z, _CMP_LT_OQ));
+        a = _mm256_blendv_ps(a, _mm256_sub_ps(_360, a), _mm256_cmp_ps(y, z, _CMP_LT_OQ));
+
+        _mm256_storeu_ps(angle + i, _mm256_mul_ps(a, scale8));
+    }
+    return i;
+}
+
+// the constants are the same as in mathfuncs.cpp
+#define EXPTAB_SCALE 6
+#define EXPTAB_MASK  ((1 << EXPTAB_SCALE) - 1)
+#define EXPPOLY_32F_A0 .9670371139572337719125840413672004409288e-2
+
+static const double exp_prescale = 1.4426950408889634073599246810019 * (1 << EXPTAB_SCALE);
+static const double exp_postscale = 1./(1 << EXPTAB_SCALE);
+static const double exp_max_val = 3000.*(1 << EXPTAB_SCALE); // log10(DBL_MAX) < 3000
+
+static inline __m256 combine( const __m128& lo, const __m128& hi )
+{
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+}
+
+// gathers 4 doubles; the masked form with a zero source is used because the source of
+// _mm256_i32gather_pd is left uninitialized
+static inline __m256d gather4d( const double* base, __m128i idx )
+{
+    return _mm256_mask_i32gather_pd(_mm256_setzero_pd(), base, idx,
+                                    _mm256_castsi256_pd(_mm256_set1_epi32(-1)), 8);
+}
+
+int exp32f( const float* src, float* dst, int len, const double* expTab )
+{
+    static const float
+        A4 = (float)(1.000000000000002438532970795181890933776 / EXPPOLY_32F_A0),
+        A3 = (float)(.6931471805521448196800669615864773144641 / EXPPOLY_32F_A0),
+        A2 = (float)(.2402265109513301490103372422686535526573 / EXPPOLY_32F_A0),
+        A1 = (float)(.5550339366753125211915322047004666939128e-1 / EXPPOLY_32F_A0);
+
+    __m256d prescale4 = _mm256_set1_pd(exp_prescale);
+    __m256 postscale8 = _mm256_set1_ps((float)exp_postscale);
+    __m256 maxval8 = _mm256_set1_ps((float)(exp_max_val/exp_prescale));
+    __m256 minval8 = _mm256_set1_ps((float)(-exp_max_val/exp_prescale));
+    __m256 mA1 = _mm256_set1_ps(A1), mA2 = _mm256_set1_ps(A2);
+    __m256 mA3 = _mm256_set1_ps(A3), mA4 = _mm256_set1_ps(A4);
+    int i = 0;
+
+    for( ; i <= len - 8; i += 8 )
+    {
+        __m256 xf = _mm256_loadu_ps(src + i);
+        xf = _mm256_min_ps(_mm256_max_ps(xf, minval8), maxval8);
+
+        __m256d xd0 = _mm256_mul_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(xf)), prescale4);
+        __m256d xd1 = _mm256_mul_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(xf, 1)), prescale4);
+        __m128i xi0 = _mm256_cvtpd_epi32(xd0), xi1 = _mm256_cvtpd_epi32(xd1);
+
+        xd0 = _mm256_sub_pd(xd0, _mm256_cvtepi32_pd(xi0));
+        xd1 = _mm256_sub_pd(xd1, _mm256_cvtepi32_pd(xi1));
+        xf = _mm256_mul_ps(combine(_mm256_cvtpd_ps(xd0), _mm256_cvtpd_ps(xd1)), postscale8);
+
+        __m128i mask = _mm_set1_epi32(EXPTAB_MASK);
+        __m256d yd0 = gather4d(expTab, _mm_and_si128(xi0, mask));
+        __m256d yd1 = gather4d(expTab, _mm_and_si128(xi1, mask));
+        __m256 yf = combine(_mm256_cvtpd_ps(yd0), _mm256_cvtpd_ps(yd1));
+
+        __m256i xi = _mm256_inserti128_si256(_mm256_castsi128_si256(xi0), xi1, 1);
+        xi = _mm256_add_epi32(_mm256_srai_epi32(xi, EXPTAB_SCALE), _mm256_set1_epi32(127));
+        xi = _mm256_min_epi32(_mm256_max_epi32(xi, _mm256_setzero_si256()), _mm256_set1_epi32(255));
+        yf = _mm256_mul_ps(yf, _mm256_castsi256_ps(_mm256_slli_epi32(xi, 23)));
+
+        __m256 zf = _mm256_add_ps(xf, mA1);
+        zf = _mm256_fmadd_ps(zf, xf, mA2);
+        zf = _mm256_fmadd_ps(zf, xf, mA3);
+        zf = _mm256_fmadd_ps(zf, xf, mA4);
+
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(zf, yf));
+    }
+    return i;
+}
+
+#define LOGTAB_SCALE    8
+#define LOGTAB_MASK         ((1 << LOGTAB_SCALE) - 1)
+#define LOGTAB_MASK2_32F    ((1 << (23 - LOGTAB_SCALE)) - 1)
+
+static const double ln_2 = 0.69314718055994530941723212145818;
+
+int log32f( const float* src, float* dst, int len, const double* logTab )
+{
+    static const float
+        A0 = 0.3333333333333333333333333f,
+        A1 = -0.5f,
+        A2 = 1.f;
+
+    __m256d ln2_4 = _mm256_set1_pd(ln_2);
+    __m256 _1_8 = _mm256_set1_ps(1.f), shift8 = _mm256_set1_ps(-1.f/512);
+    __m256 mA0 = _mm256_set1_ps(A0), mA1 = _mm256_set1_ps(A1), mA2 = _mm256_set1_ps(A2);
+    int i = 0;
+
+    for( ; i <= len - 8; i += 8 )
+    {
+        __m256i h0 = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i yi0 = _mm256_sub_epi32(_mm256_and_si256(_mm256_srli_epi32(h0, 23),
+                                       _mm256_set1_epi32(255)), _mm256_set1_epi32(127));
+        __m256d yd0 = _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(yi0)), ln2_4);
+        __m256d yd1 = _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(yi0, 1)), ln2_4);
+
+        __m256i xi0 = _mm256_or_si256(_mm256_and_si256(h0, _mm256_set1_epi32(LOGTAB_MASK2_32F)),
+                                      _mm256_set1_epi32(127 << 23));
+
+        h0 = _mm256_and_si256(_mm256_srli_epi32(h0, 23 - LOGTAB_SCALE - 1), _mm256_set1_epi32(LOGTAB_MASK*2));
+        __m128i idx0 = _mm256_castsi256_si128(h0), idx1 = _mm256_extracti128_si256(h0, 1);
+        h0 = _mm256_cmpeq_epi32(h0, _mm256_set1_epi32(510));
+
+        __m256d t0 = gather4d(logTab, idx0);
+        __m256d t1 = gather4d(logTab + 1, idx0);
+        __m256d t2 = gather4d(logTab, idx1);
+        __m256d t3 = gather4d(logTab + 1, idx1);
+
+        yd0 = _mm256_add_pd(yd0, t0);
+        yd1 = _mm256_add_pd(yd1, t2);
+        __m256 yf = combine(_mm256_cvtpd_ps(yd0), _mm256_cvtpd_ps(yd1));
+
+        __m256 xf = _mm256_sub_ps(_mm256_castsi256_ps(xi0), _1_8);
+        xf = _mm256_mul_ps(xf, combine(_mm256_cvtpd_ps(t1), _mm256_cvtpd_ps(t3)));
+        xf = _mm256_add_ps(xf, _mm256_and_ps(_mm256_castsi256_ps(h0), shift8));
+
+        __m256 zf = _mm256_fmadd_ps(xf, mA0, mA1);
+        zf = _mm256_fmadd_ps(zf, xf, mA2);
+        yf = _mm256_fmadd_ps(zf, xf, yf);
+
+        _mm256_storeu_ps(dst + i, yf);
+    }
+    return i;
+}
+
+/****************************************************************************************\
+*                                   GEMM micro-kernels                                   *
+\****************************************************************************************/
+
+#define CV_GEMM_ROW_64F(r) \
+    t = _mm256_broadcast_sd(a + r); \
+    c##r##0 = _mm256_fmadd_pd(t, b0, c##r##0); \
+    c##r##1 = _mm256_fmadd_pd(t, b1, c##r##1)
+
+#define CV_GEMM_STORE_64F(r) \
+    _mm256_storeu_pd(c + ldc*r, _mm256_add_pd(_mm256_loadu_pd(c + ldc*r), c##r##0)); \
+    _mm256_storeu_pd(c + ldc*r + 4, _mm256_add_pd(_mm256_loadu_pd(c + ldc*r + 4), c##r##1))
+
+void gemmKernel64f( int kc, const double* a, const double* b, double* c, size_t ldc )
+{
+    __m256d c00 = _mm256_setzero_pd(), c01 = c00, c10 = c00, c11 = c00, c20 = c00, c21 = c00;
+    __m256d c30 = c00, c31 = c00, c40 = c00, c41 = c00, c50 = c00, c51 = c00;
+
+    for( int k = 0; k < kc; k++, a += GEMM_MR, b += GEMM_NR )
+    {
+        __m256d b0 = _mm256_loadu_pd(b), b1 = _mm256_loadu_pd(b + 4), t;
+        CV_GEMM_ROW_64F(0); CV_GEMM_ROW_64F(1); CV_GEMM_ROW_64F(2);
+        CV_GEMM_ROW_64F(3); CV_GEMM_ROW_64F(4); CV_GEMM_ROW_64F(5);
+    }
+
+    CV_GEMM_STORE_64F(0); CV_GEMM_STORE_64F(1); CV_GEMM_STORE_64F(2);
+    CV_GEMM_STORE_64F(3); CV_GEMM_STORE_64F(4); CV_GEMM_STORE_64F(5);
+}
+
+#undef CV_GEMM_ROW_64F
+#undef CV_GEMM_STORE_64F
+
+}
+}
+
+#endif
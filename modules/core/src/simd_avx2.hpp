@@ -0,0 +1,150 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#ifndef __OPENCV_CORE_SIMD_AVX2_HPP__
+#define __OPENCV_CORE_SIMD_AVX2_HPP__
+
+#ifdef HAVE_AVX2_DISPATCH
+
+/*
+  AVX2/FMA kernels. They are compiled in simd_avx2.cpp with the AVX2 instructions enabled,
+  so they may be called only when USE_AVX2 is set. Every kernel processes the leading part
+  of the row that fits its vector width and returns the number of the processed elements;
+  the rest of the row is left to the caller's SSE2 or scalar code.
+*/
+
+namespace cv
+{
+namespace avx2
+{
+
+#define CV_AVX2_BIN_OP(name, T) \
+struct name { int operator()(const T* src1, const T* src2, T* dst, int len) const; }
+
+CV_AVX2_BIN_OP(VAdd8u, uchar);
+CV_AVX2_BIN_OP(VSub8u, uchar);
+CV_AVX2_BIN_OP(VMin8u, uchar);
+CV_AVX2_BIN_OP(VMax8u, uchar);
+CV_AVX2_BIN_OP(VAbsDiff8u, uchar);
+
+CV_AVX2_BIN_OP(VAdd8s, schar);
+CV_AVX2_BIN_OP(VSub8s, schar);
+CV_AVX2_BIN_OP(VMin8s, schar);
+CV_AVX2_BIN_OP(VMax8s, schar);
+CV_AVX2_BIN_OP(VAbsDiff8s, schar);
+
+CV_AVX2_BIN_OP(VAdd16u, ushort);
+CV_AVX2_BIN_OP(VSub16u, ushort);
+CV_AVX2_BIN_OP(VMin16u, ushort);
+CV_AVX2_BIN_OP(VMax16u, ushort);
+CV_AVX2_BIN_OP(VAbsDiff16u, ushort);
+
+CV_AVX2_BIN_OP(VAdd16s, short);
+CV_AVX2_BIN_OP(VSub16s, short);
+CV_AVX2_BIN_OP(VMin16s, short);
+CV_AVX2_BIN_OP(VMax16s, short);
+CV_AVX2_BIN_OP(VAbsDiff16s, short);
+
+CV_AVX2_BIN_OP(VAdd32s, int);
+CV_AVX2_BIN_OP(VSub32s, int);
+CV_AVX2_BIN_OP(VMin32s, int);
+CV_AVX2_BIN_OP(VMax32s, int);
+CV_AVX2_BIN_OP(VAbsDiff32s, int);
+
+CV_AVX2_BIN_OP(VAdd32f, float);
+CV_AVX2_BIN_OP(VSub32f, float);
+CV_AVX2_BIN_OP(VMin32f, float);
+CV_AVX2_BIN_OP(VMax32f, float);
+CV_AVX2_BIN_OP(VAbsDiff32f, float);
+
+CV_AVX2_BIN_OP(VAdd64f, double);
+CV_AVX2_BIN_OP(VSub64f, double);
+CV_AVX2_BIN_OP(VMin64f, double);
+CV_AVX2_BIN_OP(VMax64f, double);
+CV_AVX2_BIN_OP(VAbsDiff64f, double);
+
+CV_AVX2_BIN_OP(VAnd8u, uchar);
+CV_AVX2_BIN_OP(VOr8u, uchar);
+CV_AVX2_BIN_OP(VXor8u, uchar);
+CV_AVX2_BIN_OP(VNot8u, uchar);
+
+#undef CV_AVX2_BIN_OP
+
+// convertTo without scaling, dst[x] = saturate_cast<DT>(src[x])
+int cvt8u32f( const uchar* src, float* dst, int len );
+int cvt16u32f( const ushort* src, float* dst, int len );
+int cvt16s32f( const short* src, float* dst, int len );
+int cvt32s32f( const int* src, float* dst, int len );
+int cvt32f8u( const float* src, uchar* dst, int len );
+int cvt32f16u( const float* src, ushort* dst, int len );
+int cvt32f16s( const float* src, short* dst, int len );
+int cvt32f32s( const float* src, int* dst, int len );
+
+// convertTo with scaling, dst[x] = saturate_cast<DT>(src[x]*scale + shift);
+// the products are not fused, so the results match the SSE2 and the scalar code exactly
+int cvtScale8u( const uchar* src, uchar* dst, int len, float scale, float shift );
+int cvtScale8u32f( const uchar* src, float* dst, int len, float scale, float shift );
+int cvtScale16u32f( const ushort* src, float* dst, int len, float scale, float shift );
+int cvtScale16s32f( const short* src, float* dst, int len, float scale, float shift );
+int cvtScale16s( const short* src, short* dst, int len, float scale, float shift );
+int cvtScale32f( const float* src, float* dst, int len, float scale, float shift );
+int cvtScale32f8u( const float* src, uchar* dst, int len, float scale, float shift );
+int cvtScale32f16s( const float* src, short* dst, int len, float scale, float shift );
+
+int magnitude32f( const float* x, const float* y, float* mag, int len );
+int magnitude64f( const double* x, const double* y, double* mag, int len );
+int fastAtan2_32f( const float* Y, const float* X, float* angle, int len, float scale );
+// expTab and logTab are the tables from mathfuncs.cpp
+int exp32f( const float* src, float* dst, int len, const double* expTab );
+int log32f( const float* src, float* dst, int len, const double* logTab );
+
+// GEMM micro-kernel, c[0..GEMM_MR-1][0..GEMM_NR-1] += a*b, where a and b are kc columns of the
+// packed A panel and kc rows of the packed B panel (see GEMMPacked in matmul.cpp)
+enum { GEMM_MR = 6, GEMM_NR = 8 };
+void gemmKernel64f( int kc, const double* a, const double* b, double* c, size_t ldc );
+
+}
+}
+
+#endif
+
+#endif
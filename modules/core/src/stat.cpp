@@ -56,6 +56,110 @@ template<typename T> static inline Scalar rawToScalar(const T& v)
     return s;
 }
 
+#if CV_SSE2
+
+static inline int stat_hsum_epi32(__m128i v)
+{
+    int CV_DECL_ALIGNED(16) buf[4];
+    _mm_store_si128((__m128i*)buf, v);
+    return buf[0] + buf[1] + buf[2] + buf[3];
+}
+
+static inline int64 stat_hsum_epi64(__m128i v)
+{
+    int64 CV_DECL_ALIGNED(16) buf[2];
+    _mm_store_si128((__m128i*)buf, v);
+    return buf[0] + buf[1];
+}
+
+static inline double stat_hsum_pd(__m128d v)
+{
+    double CV_DECL_ALIGNED(16) buf[2];
+    _mm_store_pd(buf, v);
+    return buf[0] + buf[1];
+}
+
+// the masks of 8 (16-bit lanes) and 4 (32-bit lanes) elements, all ones where mask[i] == 0
+static inline __m128i stat_zmask8(const uchar* mask)
+{
+    __m128i m = _mm_cmpeq_epi8(_mm_loadl_epi64((const __m128i*)mask), _mm_setzero_si128());
+    return _mm_unpacklo_epi8(m, m);
+}
+
+static inline __m128i stat_zmask4(const uchar* mask)
+{
+    __m128i m = _mm_cvtsi32_si128(*(const int*)mask);
+    m = _mm_unpacklo_epi8(m, m);
+    return _mm_cmpeq_epi32(_mm_unpacklo_epi16(m, m), _mm_setzero_si128());
+}
+
+// the number of elements of the mask that are not zero
+static inline int stat_countMask(const uchar* mask, int len)
+{
+    int i = 0, nz = 0;
+    __m128i z = _mm_setzero_si128(), one = _mm_set1_epi8(1), n = z;
+    for( ; i <= len - 16; i += 16 )
+    {
+        __m128i m = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(mask + i)), z);
+        n = _mm_add_epi64(n, _mm_sad_epu8(_mm_andnot_si128(m, one), z));
+    }
+    nz = (int)stat_hsum_epi64(n);
+    for( ; i < len; i++ )
+        nz += mask[i] != 0;
+    return nz;
+}
+
+static inline uchar stat_hmin_epu8(__m128i v)
+{
+    v = _mm_min_epu8(v, _mm_srli_si128(v, 8));
+    v = _mm_min_epu8(v, _mm_srli_si128(v, 4));
+    v = _mm_min_epu8(v, _mm_srli_si128(v, 2));
+    v = _mm_min_epu8(v, _mm_srli_si128(v, 1));
+    return (uchar)_mm_cvtsi128_si32(v);
+}
+
+static inline uchar stat_hmax_epu8(__m128i v)
+{
+    v = _mm_max_epu8(v, _mm_srli_si128(v, 8));
+    v = _mm_max_epu8(v, _mm_srli_si128(v, 4));
+    v = _mm_max_epu8(v, _mm_srli_si128(v, 2));
+    v = _mm_max_epu8(v, _mm_srli_si128(v, 1));
+    return (uchar)_mm_cvtsi128_si32(v);
+}
+
+// 16-bit unsigned values are compared as the signed ones after flipping the sign bit
+static inline ushort stat_hmin_epu16(__m128i v)
+{
+    v = _mm_min_epi16(v, _mm_srli_si128(v, 8));
+    v = _mm_min_epi16(v, _mm_srli_si128(v, 4));
+    v = _mm_min_epi16(v, _mm_srli_si128(v, 2));
+    return (ushort)(_mm_cvtsi128_si32(v) ^ 0x8000);
+}
+
+static inline ushort stat_hmax_epu16(__m128i v)
+{
+    v = _mm_max_epi16(v, _mm_srli_si128(v, 8));
+    v = _mm_max_epi16(v, _mm_srli_si128(v, 4));
+    v = _mm_max_epi16(v, _mm_srli_si128(v, 2));
+    return (ushort)(_mm_cvtsi128_si32(v) ^ 0x8000);
+}
+
+static inline float stat_hmin_ps(__m128 v)
+{
+    v = _mm_min_ps(v, _mm_movehl_ps(v, v));
+    v = _mm_min_ss(v, _mm_shuffle_ps(v, v, 1));
+    return _mm_cvtss_f32(v);
+}
+
+static inline float stat_hmax_ps(__m128 v)
+{
+    v = _mm_max_ps(v, _mm_movehl_ps(v, v));
+    v = _mm_max_ss(v, _mm_shuffle_ps(v, v, 1));
+    return _mm_cvtss_f32(v);
+}
+
+#endif
+
 /****************************************************************************************\
 *                                        sum                                             *
 \****************************************************************************************/
@@ -177,13 +281,62 @@ static int sum_(const T* src0, const uchar* mask, ST* dst, int len, int cn )
 
 
 static int sum8u( const uchar* src, const uchar* mask, int* dst, int len, int cn )
-{ return sum_(src, mask, dst, len, cn); }
+{
+#if CV_SSE2
+    if( cn == 1 && USE_SSE2 )
+    {
+        int i = 0, nz = mask ? stat_countMask(mask, len) : len;
+        __m128i z = _mm_setzero_si128(), s0 = z;
+        if( !mask )
+        {
+            for( ; i <= len - 16; i += 16 )
+                s0 = _mm_add_epi64(s0, _mm_sad_epu8(_mm_loadu_si128((const __m128i*)(src + i)), z));
+        }
+        else
+        {
+            for( ; i <= len - 16; i += 16 )
+            {
+                __m128i m = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(mask + i)), z);
+                __m128i v = _mm_andnot_si128(m, _mm_loadu_si128((const __m128i*)(src + i)));
+                s0 = _mm_add_epi64(s0, _mm_sad_epu8(v, z));
+            }
+        }
+        int s = (int)stat_hsum_epi64(s0);
+        for( ; i < len; i++ )
+            s += mask && !mask[i] ? 0 : src[i];
+        dst[0] += s;
+        return nz;
+    }
+#endif
+    return sum_(src, mask, dst, len, cn);
+}
 
 static int sum8s( const schar* src, const uchar* mask, int* dst, int len, int cn )
 { return sum_(src, mask, dst, len, cn); }
 
 static int sum16u( const ushort* src, const uchar* mask, int* dst, int len, int cn )
-{ return sum_(src, mask, dst, len, cn); }
+{
+#if CV_SSE2
+    if( cn == 1 && USE_SSE2 )
+    {
+        int i = 0, nz = mask ? stat_countMask(mask, len) : len;
+        __m128i z = _mm_setzero_si128(), s0 = z;
+        for( ; i <= len - 8; i += 8 )
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+            if( mask )
+                v = _mm_andnot_si128(stat_zmask8(mask + i), v);
+            s0 = _mm_add_epi32(s0, _mm_add_epi32(_mm_unpacklo_epi16(v, z), _mm_unpackhi_epi16(v, z)));
+        }
+        int s = stat_hsum_epi32(s0);
+        for( ; i < len; i++ )
+            s += mask && !mask[i] ? 0 : src[i];
+        dst[0] += s;
+        return nz;
+    }
+#endif
+    return sum_(src, mask, dst, len, cn);
+}
 
 static int sum16s( const short* src, const uchar* mask, int* dst, int len, int cn )
 { return sum_(src, mask, dst, len, cn); }
@@ -192,7 +345,29 @@ static int sum32s( const int* src, const uchar* mask, double* dst, int len, int
 { return sum_(src, mask, dst, len, cn); }
 
 static int sum32f( const float* src, const uchar* mask, double* dst, int len, int cn )
-{ return sum_(src, mask, dst, len, cn); }
+{
+#if CV_SSE2
+    if( cn == 1 && USE_SSE2 )
+    {
+        int i = 0, nz = mask ? stat_countMask(mask, len) : len;
+        __m128d s0 = _mm_setzero_pd(), s1 = s0;
+        for( ; i <= len - 4; i += 4 )
+        {
+            __m128 v = _mm_loadu_ps(src + i);
+            if( mask )
+                v = _mm_andnot_ps(_mm_castsi128_ps(stat_zmask4(mask + i)), v);
+            s0 = _mm_add_pd(s0, _mm_cvtps_pd(v));
+            s1 = _mm_add_pd(s1, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+        }
+        double s = stat_hsum_pd(_mm_add_pd(s0, s1));
+        for( ; i < len; i++ )
+            s += mask && !mask[i] ? 0 : src[i];
+        dst[0] += s;
+        return nz;
+    }
+#endif
+    return sum_(src, mask, dst, len, cn);
+}
 
 static int sum64f( const double* src, const uchar* mask, double* dst, int len, int cn )
 { return sum_(src, mask, dst, len, cn); }
@@ -258,13 +433,48 @@ static int countNonZero8u( const uchar* src, int len )
 }
 
 static int countNonZero16u( const ushort* src, int len )
-{ return countNonZero_(src, len); }
+{
+    int i = 0, nz = 0;
+#if CV_SSE2
+    if( USE_SSE2 )
+    {
+        __m128i z = _mm_setzero_si128(), one = _mm_set1_epi16(1), nzero = z;
+        for( ; i <= len - 8; i += 8 )
+        {
+            __m128i iszero = _mm_cmpeq_epi16(_mm_loadu_si128((const __m128i*)(src + i)), z);
+            nzero = _mm_add_epi32(nzero, _mm_madd_epi16(_mm_and_si128(iszero, one), one));
+        }
+        nz = i - stat_hsum_epi32(nzero);
+    }
+#endif
+    for( ; i < len; i++ )
+        nz += src[i] != 0;
+    return nz;
+}
 
 static int countNonZero32s( const int* src, int len )
 { return countNonZero_(src, len); }
 
 static int countNonZero32f( const float* src, int len )
-{ return countNonZero_(src, len); }
+{
+    int i = 0, nz = 0;
+#if CV_SSE2
+    if( USE_SSE2 )
+    {
+        __m128 z = _mm_setzero_ps();
+        __m128i nzero = _mm_setzero_si128();
+        for( ; i <= len - 4; i += 4 )
+        {
+            __m128 iszero = _mm_cmpeq_ps(_mm_loadu_ps(src + i), z);
+            nzero = _mm_sub_epi32(nzero, _mm_castps_si128(iszero));
+        }
+        nz = i - stat_hsum_epi32(nzero);
+    }
+#endif
+    for( ; i < len; i++ )
+        nz += src[i] != 0;
+    return nz;
+}
 
 static int countNonZero64f( const double* src, int len )
 { return countNonZero_(src, len); }
@@ -405,13 +615,75 @@ static int sumsqr_(const T* src0, const uchar* mask, ST* sum, SQT* sqsum, int le
 
 
 static int sqsum8u( const uchar* src, const uchar* mask, int* sum, int* sqsum, int len, int cn )
-{ return sumsqr_(src, mask, sum, sqsum, len, cn); }
+{
+#if CV_SSE2
+    if( cn == 1 && USE_SSE2 )
+    {
+        int i = 0, nz = mask ? stat_countMask(mask, len) : len;
+        __m128i z = _mm_setzero_si128(), s0 = z, sq0 = z;
+        for( ; i <= len - 16; i += 16 )
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+            if( mask )
+                v = _mm_andnot_si128(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(mask + i)), z), v);
+            __m128i v0 = _mm_unpacklo_epi8(v, z), v1 = _mm_unpackhi_epi8(v, z);
+            s0 = _mm_add_epi64(s0, _mm_sad_epu8(v, z));
+            sq0 = _mm_add_epi32(sq0, _mm_add_epi32(_mm_madd_epi16(v0, v0), _mm_madd_epi16(v1, v1)));
+        }
+        int s = (int)stat_hsum_epi64(s0), sq = stat_hsum_epi32(sq0);
+        for( ; i < len; i++ )
+            if( !mask || mask[i] )
+            {
+                int v = src[i];
+                s += v;
+                sq += v*v;
+            }
+        sum[0] += s;
+        sqsum[0] += sq;
+        return nz;
+    }
+#endif
+    return sumsqr_(src, mask, sum, sqsum, len, cn);
+}
 
 static int sqsum8s( const schar* src, const uchar* mask, int* sum, int* sqsum, int len, int cn )
 { return sumsqr_(src, mask, sum, sqsum, len, cn); }
 
 static int sqsum16u( const ushort* src, const uchar* mask, int* sum, double* sqsum, int len, int cn )
-{ return sumsqr_(src, mask, sum, sqsum, len, cn); }
+{
+#if CV_SSE2
+    if( cn == 1 && USE_SSE2 )
+    {
+        int i = 0, nz = mask ? stat_countMask(mask, len) : len;
+        __m128i z = _mm_setzero_si128(), s0 = z, sq0 = z;
+        for( ; i <= len - 8; i += 8 )
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+            if( mask )
+                v = _mm_andnot_si128(stat_zmask8(mask + i), v);
+            __m128i v0 = _mm_unpacklo_epi16(v, z), v1 = _mm_unpackhi_epi16(v, z);
+            s0 = _mm_add_epi32(s0, _mm_add_epi32(v0, v1));
+            // the squares do not fit 32-bit signed integers, so they are accumulated as 64-bit ones
+            sq0 = _mm_add_epi64(sq0, _mm_add_epi64(_mm_mul_epu32(v0, v0), _mm_mul_epu32(v1, v1)));
+            v0 = _mm_srli_epi64(v0, 32); v1 = _mm_srli_epi64(v1, 32);
+            sq0 = _mm_add_epi64(sq0, _mm_add_epi64(_mm_mul_epu32(v0, v0), _mm_mul_epu32(v1, v1)));
+        }
+        int s = stat_hsum_epi32(s0);
+        int64 sq = stat_hsum_epi64(sq0);
+        for( ; i < len; i++ )
+            if( !mask || mask[i] )
+            {
+                int v = src[i];
+                s += v;
+                sq += (int64)v*v;
+            }
+        sum[0] += s;
+        sqsum[0] += (double)sq;
+        return nz;
+    }
+#endif
+    return sumsqr_(src, mask, sum, sqsum, len, cn);
+}
 
 static int sqsum16s( const short* src, const uchar* mask, int* sum, double* sqsum, int len, int cn )
 { return sumsqr_(src, mask, sum, sqsum, len, cn); }
@@ -420,7 +692,38 @@ static int sqsum32s( const int* src, const uchar* mask, double* sum, double* sqs
 { return sumsqr_(src, mask, sum, sqsum, len, cn); }
 
 static int sqsum32f( const float* src, const uchar* mask, double* sum, double* sqsum, int len, int cn )
-{ return sumsqr_(src, mask, sum, sqsum, len, cn); }
+{
+#if CV_SSE2
+    if( cn == 1 && USE_SSE2 )
+    {
+        int i = 0, nz = mask ? stat_countMask(mask, len) : len;
+        __m128d s0 = _mm_setzero_pd(), s1 = s0, sq0 = s0, sq1 = s0;
+        for( ; i <= len - 4; i += 4 )
+        {
+            __m128 v = _mm_loadu_ps(src + i);
+            if( mask )
+                v = _mm_andnot_ps(_mm_castsi128_ps(stat_zmask4(mask + i)), v);
+            __m128d v0 = _mm_cvtps_pd(v), v1 = _mm_cvtps_pd(_mm_movehl_ps(v, v));
+            s0 = _mm_add_pd(s0, v0);
+            s1 = _mm_add_pd(s1, v1);
+            sq0 = _mm_add_pd(sq0, _mm_mul_pd(v0, v0));
+            sq1 = _mm_add_pd(sq1, _mm_mul_pd(v1, v1));
+        }
+        double s = stat_hsum_pd(_mm_add_pd(s0, s1)), sq = stat_hsum_pd(_mm_add_pd(sq0, sq1));
+        for( ; i < len; i++ )
+            if( !mask || mask[i] )
+            {
+                double v = src[i];
+                s += v;
+                sq += v*v;
+            }
+        sum[0] += s;
+        sqsum[0] += sq;
+        return nz;
+    }
+#endif
+    return sumsqr_(src, mask, sum, sqsum, len, cn);
+}
 
 static int sqsum64f( const double* src, const uchar* mask, double* sum, double* sqsum, int len, int cn )
 { return sumsqr_(src, mask, sum, sqsum, len, cn); }
@@ -433,58 +736,223 @@ static SumSqrFunc sumSqrTab[] =
     (SumSqrFunc)sqsum32s, (SumSqrFunc)GET_OPTIMIZED(sqsum32f), (SumSqrFunc)sqsum64f, 0
 };
 
+/****************************************************************************************\
+*                                  parallel reductions                                   *
+\****************************************************************************************/
+
+// The reductions are computed over the stripes of at most STAT_STRIPE_SIZE array elements.
+// The stripes are short enough for the integer accumulators of the block functions not to
+// overflow, and they do not depend on the number of threads, so the partial results merged
+// in the stripe order give exactly the same result in any parallel configuration.
+enum { STAT_STRIPE_SIZE = 1 << 15, STAT_MAX_ARRAYS = 3 };
+
+static inline size_t statStripeSize(int cn)
+{
+    return std::max(STAT_STRIPE_SIZE/cn, 1);
 }
 
-cv::Scalar cv::sum( InputArray _src )
+class StatReducer
 {
-    Mat src = _src.getMat();
-    int k, cn = src.channels(), depth = src.depth();
-    SumFunc func = sumTab[depth];
+public:
+    StatReducer(int _resultSize) : resultSize(_resultSize) {}
+    virtual ~StatReducer() {}
 
-    CV_Assert( cn <= 4 && func != 0 );
+    virtual void init(double* result) const
+    {
+        for( int i = 0; i < resultSize; i++ )
+            result[i] = 0;
+    }
+    // processes len pixels of the arrays starting from the pixel idx;
+    // the pointers to the empty arrays (like the missing mask) are 0
+    virtual void operator()(uchar** ptrs, int len, size_t idx, double* result) const = 0;
+    virtual void merge(double* result, const double* partial) const
+    {
+        for( int i = 0; i < resultSize; i++ )
+            result[i] += partial[i];
+    }
 
-    const Mat* arrays[] = {&src, 0};
-    uchar* ptrs[1];
-    NAryMatIterator it(arrays, ptrs);
-    Scalar s;
-    int total = (int)it.size, blockSize = total, intSumBlockSize = 0;
-    int j, count = 0;
-    AutoBuffer<int> _buf;
-    int* buf = (int*)&s[0];
-    size_t esz = 0;
-    bool blockSum = depth < CV_32S;
+    int resultSize;
+};
 
-    if( blockSum )
+class StatReduceInvoker : public ParallelLoopBody
+{
+public:
+    StatReduceInvoker(const StatReducer& _reducer, uchar** _planes, const size_t* _esz, int _narrays,
+                      size_t _planeSize, size_t _total, size_t _stripeSize, double* _partials)
+        : reducer(&_reducer), planes(_planes), esz(_esz), narrays(_narrays), planeSize(_planeSize),
+          total(_total), stripeSize(_stripeSize), partials(_partials)
     {
-        intSumBlockSize = depth <= CV_8S ? (1 << 23) : (1 << 15);
-        blockSize = std::min(blockSize, intSumBlockSize);
-        _buf.allocate(cn);
-        buf = _buf;
+    }
 
-        for( k = 0; k < cn; k++ )
-            buf[k] = 0;
-        esz = src.elemSize();
+    void operator()(const Range& range) const
+    {
+        uchar* ptrs[STAT_MAX_ARRAYS] = {0, 0, 0};
+
+        for( int s = range.start; s < range.end; s++ )
+        {
+            double* result = partials + (size_t)s*reducer->resultSize;
+            size_t idx = (size_t)s*stripeSize, end = std::min(idx + stripeSize, total);
+
+            reducer->init(result);
+            while( idx < end )
+            {
+                size_t plane = idx/planeSize, ofs = idx - plane*planeSize;
+                int len = (int)std::min(planeSize - ofs, end - idx);
+                for( int k = 0; k < narrays; k++ )
+                {
+                    uchar* ptr = planes[plane*narrays + k];
+                    ptrs[k] = ptr ? ptr + ofs*esz[k] : 0;
+                }
+                (*reducer)(ptrs, len, idx, result);
+                idx += len;
+            }
+        }
     }
 
+protected:
+    const StatReducer* reducer;
+    uchar** planes;
+    const size_t* esz;
+    int narrays;
+    size_t planeSize, total, stripeSize;
+    double* partials;
+};
+
+// runs the reduction over the 0-terminated list of the arrays of the same size;
+// the stripe size is given in pixels
+static void parallelReduce(const Mat** arrays, const StatReducer& reducer, size_t stripeSize, double* result)
+{
+    int k, narrays = 0;
+    while( arrays[narrays] )
+        narrays++;
+    CV_Assert( narrays <= STAT_MAX_ARRAYS );
+
+    uchar* ptrs[STAT_MAX_ARRAYS];
+    size_t esz[STAT_MAX_ARRAYS];
+    NAryMatIterator it(arrays, ptrs, narrays);
+    size_t planeSize = it.size, total = planeSize*it.nplanes;
+    AutoBuffer<uchar*> _planes(std::max(it.nplanes, (size_t)1)*narrays);
+    uchar** planes = _planes;
+
+    for( k = 0; k < narrays; k++ )
+        esz[k] = arrays[k]->elemSize();
     for( size_t i = 0; i < it.nplanes; i++, ++it )
+        for( k = 0; k < narrays; k++ )
+            planes[i*narrays + k] = ptrs[k];
+
+    reducer.init(result);
+    if( total == 0 )
+        return;
+
+    int nstripes = (int)((total + stripeSize - 1)/stripeSize);
+    AutoBuffer<double> _partials((size_t)nstripes*reducer.resultSize);
+    double* partials = _partials;
+    StatReduceInvoker invoker(reducer, planes, esz, narrays, planeSize, total, stripeSize, partials);
+
+    if( nstripes == 1 )
+        invoker(Range(0, 1));
+    else
+        parallel_for_(Range(0, nstripes), invoker);
+
+    for( int s = 0; s < nstripes; s++ )
+        reducer.merge(result, partials + (size_t)s*reducer.resultSize);
+}
+
+// the sums of the channels followed by the number of the processed pixels
+class SumReducer : public StatReducer
+{
+public:
+    SumReducer(SumFunc _func, int _depth, int _cn)
+        : StatReducer(_cn + 1), func(_func), depth(_depth), cn(_cn) {}
+
+    void operator()(uchar** ptrs, int len, size_t, double* result) const
     {
-        for( j = 0; j < total; j += blockSize )
+        int k, nz;
+        if( depth <= CV_16S )
         {
-            int bsz = std::min(total - j, blockSize);
-            func( ptrs[0], 0, (uchar*)buf, bsz, cn );
-            count += bsz;
-            if( blockSum && (count + blockSize >= intSumBlockSize || (i+1 >= it.nplanes && j+bsz >= total)) )
+            int buf[4] = {0, 0, 0, 0};
+            nz = func(ptrs[0], ptrs[1], (uchar*)buf, len, cn);
+            for( k = 0; k < cn; k++ )
+                result[k] += buf[k];
+        }
+        else
+            nz = func(ptrs[0], ptrs[1], (uchar*)result, len, cn);
+        result[cn] += nz;
+    }
+
+protected:
+    SumFunc func;
+    int depth, cn;
+};
+
+// the sums and the sums of squares of the channels followed by the number of the processed pixels
+class SumSqrReducer : public StatReducer
+{
+public:
+    SumSqrReducer(SumSqrFunc _func, int _depth, int _cn)
+        : StatReducer(_cn*2 + 1), func(_func), depth(_depth), cn(_cn) {}
+
+    void operator()(uchar** ptrs, int len, size_t, double* result) const
+    {
+        int k, nz;
+        double* sq = result + cn;
+        if( depth <= CV_16S )
+        {
+            AutoBuffer<int> _buf(cn*2);
+            int *sbuf = _buf, *sqbuf = sbuf + cn;
+            for( k = 0; k < cn*2; k++ )
+                sbuf[k] = 0;
+            if( depth <= CV_8S )
             {
+                nz = func(ptrs[0], ptrs[1], (uchar*)sbuf, (uchar*)sqbuf, len, cn);
                 for( k = 0; k < cn; k++ )
-                {
-                    s[k] += buf[k];
-                    buf[k] = 0;
-                }
-                count = 0;
+                    sq[k] += sqbuf[k];
             }
-            ptrs[0] += bsz*esz;
+            else
+                nz = func(ptrs[0], ptrs[1], (uchar*)sbuf, (uchar*)sq, len, cn);
+            for( k = 0; k < cn; k++ )
+                result[k] += sbuf[k];
         }
+        else
+            nz = func(ptrs[0], ptrs[1], (uchar*)result, (uchar*)sq, len, cn);
+        result[cn*2] += nz;
+    }
+
+protected:
+    SumSqrFunc func;
+    int depth, cn;
+};
+
+class CountNonZeroReducer : public StatReducer
+{
+public:
+    CountNonZeroReducer(CountNonZeroFunc _func) : StatReducer(1), func(_func) {}
+
+    void operator()(uchar** ptrs, int len, size_t, double* result) const
+    {
+        result[0] += func(ptrs[0], len);
     }
+
+protected:
+    CountNonZeroFunc func;
+};
+}
+
+cv::Scalar cv::sum( InputArray _src )
+{
+    Mat src = _src.getMat();
+    int k, cn = src.channels(), depth = src.depth();
+    SumFunc func = sumTab[depth];
+
+    CV_Assert( cn <= 4 && func != 0 );
+
+    const Mat* arrays[] = {&src, 0};
+    double result[5];
+    parallelReduce(arrays, SumReducer(func, depth, cn), statStripeSize(cn), result);
+
+    Scalar s;
+    for( k = 0; k < cn; k++ )
+        s[k] = result[k];
     return s;
 }
 
@@ -496,14 +964,9 @@ int cv::countNonZero( InputArray _src )
     CV_Assert( src.channels() == 1 && func != 0 );
 
     const Mat* arrays[] = {&src, 0};
-    uchar* ptrs[1];
-    NAryMatIterator it(arrays, ptrs);
-    int total = (int)it.size, nz = 0;
-
-    for( size_t i = 0; i < it.nplanes; i++, ++it )
-        nz += func( ptrs[0], total );
-
-    return nz;
+    double nz = 0;
+    parallelReduce(arrays, CountNonZeroReducer(func), STAT_STRIPE_SIZE, &nz);
+    return saturate_cast<int>(nz);
 }
 
 cv::Scalar cv::mean( InputArray _src, InputArray _mask )
@@ -517,146 +980,511 @@ cv::Scalar cv::mean( InputArray _src, InputArray _mask )
     CV_Assert( cn <= 4 && func != 0 );
 
     const Mat* arrays[] = {&src, &mask, 0};
-    uchar* ptrs[2];
-    NAryMatIterator it(arrays, ptrs);
+    double result[5];
+    parallelReduce(arrays, SumReducer(func, depth, cn), statStripeSize(cn), result);
+
     Scalar s;
-    int total = (int)it.size, blockSize = total, intSumBlockSize = 0;
-    int j, count = 0;
-    AutoBuffer<int> _buf;
-    int* buf = (int*)&s[0];
-    bool blockSum = depth <= CV_16S;
-    size_t esz = 0, nz0 = 0;
+    double scale = result[cn] ? 1./result[cn] : 0;
+    for( k = 0; k < cn; k++ )
+        s[k] = result[k]*scale;
+    return s;
+}
+
+
+void cv::meanStdDev( InputArray _src, OutputArray _mean, OutputArray _sdv, InputArray _mask )
+{
+    Mat src = _src.getMat(), mask = _mask.getMat();
+    CV_Assert( mask.empty() || mask.type() == CV_8U );
 
-    if( blockSum )
+    int j, k, cn = src.channels(), depth = src.depth();
+    SumSqrFunc func = sumSqrTab[depth];
+
+    CV_Assert( func != 0 );
+
+    const Mat* arrays[] = {&src, &mask, 0};
+    AutoBuffer<double> _buf(cn*2 + 1);
+    double *s = (double*)_buf, *sq = s + cn, nz0;
+    parallelReduce(arrays, SumSqrReducer(func, depth, cn), statStripeSize(cn), s);
+    nz0 = s[cn*2];
+
+    double scale = nz0 ? 1./nz0 : 0.;
+    for( k = 0; k < cn; k++ )
     {
-        intSumBlockSize = depth <= CV_8S ? (1 << 23) : (1 << 15);
-        blockSize = std::min(blockSize, intSumBlockSize);
-        _buf.allocate(cn);
-        buf = _buf;
+        s[k] *= scale;
+        sq[k] = std::sqrt(std::max(sq[k]*scale - s[k]*s[k], 0.));
+    }
 
+    for( j = 0; j < 2; j++ )
+    {
+        const double* sptr = j == 0 ? s : sq;
+        _OutputArray _dst = j == 0 ? _mean : _sdv;
+        if( !_dst.needed() )
+            continue;
+
+        if( !_dst.fixedSize() )
+            _dst.create(cn, 1, CV_64F, -1, true);
+        Mat dst = _dst.getMat();
+        int dcn = (int)dst.total();
+        CV_Assert( dst.type() == CV_64F && dst.isContinuous() &&
+                   (dst.cols == 1 || dst.rows == 1) && dcn >= cn );
+        double* dptr = dst.ptr<double>();
         for( k = 0; k < cn; k++ )
-            buf[k] = 0;
-        esz = src.elemSize();
+            dptr[k] = sptr[k];
+        for( ; k < dcn; k++ )
+            dptr[k] = 0;
     }
+}
 
-    for( size_t i = 0; i < it.nplanes; i++, ++it )
+/****************************************************************************************\
+*                                       calcStats                                        *
+\****************************************************************************************/
+
+namespace cv
+{
+
+// accumulates the statistics of len pixels into the result laid out as
+// [sum cn][sqsum cn][min cn][max cn][nonzero cn]; returns the number of the processed pixels
+template<typename T, typename ST, typename SQT, int cn> static int
+calcStatsCn_( const T* src, const uchar* mask, double* result, int len )
+{
+    ST s[cn];
+    SQT sq[cn];
+    T vmin[cn], vmax[cn];
+    int i, k, count = 0, nz[cn];
+
+    for( k = 0; k < cn; k++ )
+    {
+        s[k] = 0;
+        sq[k] = 0;
+        nz[k] = 0;
+        vmin[k] = std::numeric_limits<T>::max();
+        vmax[k] = (T)(std::numeric_limits<T>::is_integer ?
+                      std::numeric_limits<T>::min() : -std::numeric_limits<T>::max());
+    }
+
+    for( i = 0; i < len; i++, src += cn )
     {
-        for( j = 0; j < total; j += blockSize )
+        if( mask && !mask[i] )
+            continue;
+        for( k = 0; k < cn; k++ )
         {
-            int bsz = std::min(total - j, blockSize);
-            int nz = func( ptrs[0], ptrs[1], (uchar*)buf, bsz, cn );
-            count += nz;
-            nz0 += nz;
-            if( blockSum && (count + blockSize >= intSumBlockSize || (i+1 >= it.nplanes && j+bsz >= total)) )
+            T v = src[k];
+            s[k] += v;
+            sq[k] += (SQT)v*v;
+            // the NaNs do not change the extremums, as in minMaxIdx
+            vmin[k] = std::min(vmin[k], v);
+            vmax[k] = std::max(vmax[k], v);
+            nz[k] += v != 0;
+        }
+        count++;
+    }
+
+    if( count > 0 )
+        for( k = 0; k < cn; k++ )
+        {
+            result[k] += s[k];
+            result[k + cn] += sq[k];
+            result[k + cn*2] = std::min(result[k + cn*2], (double)vmin[k]);
+            result[k + cn*3] = std::max(result[k + cn*3], (double)vmax[k]);
+            result[k + cn*4] += nz[k];
+        }
+    return count;
+}
+
+template<typename T, typename ST, typename SQT> static int
+calcStats_( const T* src, const uchar* mask, double* result, int len, int cn )
+{
+    if( cn == 1 )
+        return calcStatsCn_<T, ST, SQT, 1>(src, mask, result, len);
+    if( cn == 2 )
+        return calcStatsCn_<T, ST, SQT, 2>(src, mask, result, len);
+    if( cn == 3 )
+        return calcStatsCn_<T, ST, SQT, 3>(src, mask, result, len);
+    return calcStatsCn_<T, ST, SQT, 4>(src, mask, result, len);
+}
+
+static inline void calcStatsUpdate1( double* result, double s, double sq, double vmin, double vmax, int nz )
+{
+    result[0] += s;
+    result[1] += sq;
+    result[2] = std::min(result[2], vmin);
+    result[3] = std::max(result[3], vmax);
+    result[4] += nz;
+}
+
+#if CV_SSE2
+// the unmasked multi-channel arrays are processed in the groups of 1 (cn == 2, 4) or 3 (cn == 3)
+// vectors, so the lane L of a group always holds the channel L % cn; the lanes are accumulated
+// separately and merged into the channels at the end
+static int calcStats8uC( const uchar* src, double* result, int len, int cn )
+{
+    const int MAX_GROUP = 48;
+    int ngroups = cn == 3 ? 3 : 1, gsize = ngroups*16, total = len*cn, i = 0, t, j, k;
+    __m128i z = _mm_setzero_si128(), vmin[3], vmax[3], vsq[3][4];
+    int CV_DECL_ALIGNED(16) ibuf[16];
+    ushort CV_DECL_ALIGNED(16) sbuf[16];
+    uchar CV_DECL_ALIGNED(16) bbuf[16];
+    int lsum[MAX_GROUP], lsq[MAX_GROUP], lzero[MAX_GROUP], lmin[MAX_GROUP], lmax[MAX_GROUP];
+
+    for( t = 0; t < ngroups; t++ )
+    {
+        vmin[t] = _mm_set1_epi8(-1);
+        vmax[t] = z;
+        for( k = 0; k < 4; k++ )
+            vsq[t][k] = z;
+    }
+    for( j = 0; j < gsize; j++ )
+        lsum[j] = lzero[j] = 0;
+
+    while( i <= total - gsize )
+    {
+        // up to 256 values of 255 at most are summed in the 16-bit lanes
+        int n = std::min((total - i)/gsize, 256);
+        __m128i vs[3][2], vz[3][2];
+        for( t = 0; t < ngroups; t++ )
+            vs[t][0] = vs[t][1] = vz[t][0] = vz[t][1] = z;
+
+        for( ; n > 0; n--, i += gsize )
+            for( t = 0; t < ngroups; t++ )
             {
-                for( k = 0; k < cn; k++ )
+                __m128i v = _mm_loadu_si128((const __m128i*)(src + i + t*16));
+                vmin[t] = _mm_min_epu8(vmin[t], v);
+                vmax[t] = _mm_max_epu8(vmax[t], v);
+                __m128i v0 = _mm_unpacklo_epi8(v, z), v1 = _mm_unpackhi_epi8(v, z);
+                vs[t][0] = _mm_add_epi16(vs[t][0], v0);
+                vs[t][1] = _mm_add_epi16(vs[t][1], v1);
+                v0 = _mm_mullo_epi16(v0, v0);
+                v1 = _mm_mullo_epi16(v1, v1);
+                vsq[t][0] = _mm_add_epi32(vsq[t][0], _mm_unpacklo_epi16(v0, z));
+                vsq[t][1] = _mm_add_epi32(vsq[t][1], _mm_unpackhi_epi16(v0, z));
+                vsq[t][2] = _mm_add_epi32(vsq[t][2], _mm_unpacklo_epi16(v1, z));
+                vsq[t][3] = _mm_add_epi32(vsq[t][3], _mm_unpackhi_epi16(v1, z));
+                // the comparison lanes are -1 for the zeros
+                __m128i m = _mm_cmpeq_epi8(v, z);
+                vz[t][0] = _mm_sub_epi16(vz[t][0], _mm_unpacklo_epi8(m, m));
+                vz[t][1] = _mm_sub_epi16(vz[t][1], _mm_unpackhi_epi8(m, m));
+            }
+
+        for( t = 0; t < ngroups; t++ )
+            for( k = 0; k < 2; k++ )
+            {
+                _mm_store_si128((__m128i*)sbuf, vs[t][k]);
+                _mm_store_si128((__m128i*)(sbuf + 8), vz[t][k]);
+                for( j = 0; j < 8; j++ )
                 {
-                    s[k] += buf[k];
-                    buf[k] = 0;
+                    lsum[t*16 + k*8 + j] += sbuf[j];
+                    lzero[t*16 + k*8 + j] += sbuf[j + 8];
                 }
-                count = 0;
             }
-            ptrs[0] += bsz*esz;
-            if( ptrs[1] )
-                ptrs[1] += bsz;
+    }
+
+    for( t = 0; t < ngroups; t++ )
+    {
+        _mm_store_si128((__m128i*)bbuf, vmin[t]);
+        for( j = 0; j < 16; j++ )
+            lmin[t*16 + j] = bbuf[j];
+        _mm_store_si128((__m128i*)bbuf, vmax[t]);
+        for( j = 0; j < 16; j++ )
+            lmax[t*16 + j] = bbuf[j];
+        for( k = 0; k < 4; k++ )
+        {
+            _mm_store_si128((__m128i*)ibuf, vsq[t][k]);
+            for( j = 0; j < 4; j++ )
+                lsq[t*16 + k*4 + j] = ibuf[j];
         }
     }
-    return s*(nz0 ? 1./nz0 : 0);
-}
 
+    int s[4] = {0, 0, 0, 0}, sq[4] = {0, 0, 0, 0}, zeros[4] = {0, 0, 0, 0};
+    int bmin[4] = {255, 255, 255, 255}, bmax[4] = {0, 0, 0, 0};
+    for( j = 0; j < gsize; j++ )
+    {
+        k = j % cn;
+        s[k] += lsum[j];
+        sq[k] += lsq[j];
+        zeros[k] += lzero[j];
+        bmin[k] = std::min(bmin[k], lmin[j]);
+        bmax[k] = std::max(bmax[k], lmax[j]);
+    }
+    for( k = 0; i < total; i++ )
+    {
+        int v = src[i];
+        s[k] += v;
+        sq[k] += v*v;
+        zeros[k] += v == 0;
+        bmin[k] = std::min(bmin[k], v);
+        bmax[k] = std::max(bmax[k], v);
+        if( ++k == cn )
+            k = 0;
+    }
 
-void cv::meanStdDev( InputArray _src, OutputArray _mean, OutputArray _sdv, InputArray _mask )
+    if( len > 0 )
+        for( k = 0; k < cn; k++ )
+        {
+            result[k] += s[k];
+            result[k + cn] += sq[k];
+            result[k + cn*2] = std::min(result[k + cn*2], (double)bmin[k]);
+            result[k + cn*3] = std::max(result[k + cn*3], (double)bmax[k]);
+            result[k + cn*4] += len - zeros[k];
+        }
+    return len;
+}
+#endif
+
+static int calcStats8u( const uchar* src, const uchar* mask, double* result, int len, int cn )
 {
-    Mat src = _src.getMat(), mask = _mask.getMat();
-    CV_Assert( mask.empty() || mask.type() == CV_8U );
+#if CV_SSE2
+    if( USE_SSE2 && cn == 1 )
+    {
+        int i = 0, count = mask ? stat_countMask(mask, len) : len;
+        __m128i z = _mm_setzero_si128(), one = _mm_set1_epi8(1);
+        __m128i vs = z, vsq = z, vzero = z, vmin = _mm_set1_epi8(-1), vmax = z;
+        for( ; i <= len - 16; i += 16 )
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+            if( mask )
+            {
+                __m128i m = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(mask + i)), z);
+                vmin = _mm_min_epu8(vmin, _mm_or_si128(v, m));
+                v = _mm_andnot_si128(m, v);
+            }
+            else
+                vmin = _mm_min_epu8(vmin, v);
+            vmax = _mm_max_epu8(vmax, v);
+            vs = _mm_add_epi64(vs, _mm_sad_epu8(v, z));
+            __m128i v0 = _mm_unpacklo_epi8(v, z), v1 = _mm_unpackhi_epi8(v, z);
+            vsq = _mm_add_epi32(vsq, _mm_add_epi32(_mm_madd_epi16(v0, v0), _mm_madd_epi16(v1, v1)));
+            // the masked out elements are zeros at this point, so they are counted as zeros too
+            vzero = _mm_add_epi64(vzero, _mm_sad_epu8(_mm_and_si128(_mm_cmpeq_epi8(v, z), one), z));
+        }
+        int s = (int)stat_hsum_epi64(vs), sq = stat_hsum_epi32(vsq);
+        int nz = i - (int)stat_hsum_epi64(vzero);
+        int bmin = stat_hmin_epu8(vmin), bmax = stat_hmax_epu8(vmax);
+        for( ; i < len; i++ )
+            if( !mask || mask[i] )
+            {
+                int v = src[i];
+                s += v;
+                sq += v*v;
+                bmin = std::min(bmin, v);
+                bmax = std::max(bmax, v);
+                nz += v != 0;
+            }
+        if( count > 0 )
+            calcStatsUpdate1(result, s, sq, bmin, bmax, nz);
+        return count;
+    }
+    if( USE_SSE2 && !mask )
+        return calcStats8uC(src, result, len, cn);
+#endif
+    return calcStats_<uchar, int, int>(src, mask, result, len, cn);
+}
 
-    int k, cn = src.channels(), depth = src.depth();
-    SumSqrFunc func = sumSqrTab[depth];
+static int calcStats8s( const schar* src, const uchar* mask, double* result, int len, int cn )
+{ return calcStats_<schar, int, int>(src, mask, result, len, cn); }
 
-    CV_Assert( func != 0 );
+static int calcStats16u( const ushort* src, const uchar* mask, double* result, int len, int cn )
+{
+#if CV_SSE2
+    if( USE_SSE2 && cn == 1 )
+    {
+        int i = 0, count = mask ? stat_countMask(mask, len) : len;
+        __m128i z = _mm_setzero_si128(), one = _mm_set1_epi16(1), delta = _mm_set1_epi16((short)0x8000);
+        __m128i vs = z, vsq = z, vzero = z, vmin = _mm_set1_epi16(0x7fff), vmax = delta;
+        for( ; i <= len - 8; i += 8 )
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+            if( mask )
+            {
+                __m128i m = stat_zmask8(mask + i);
+                vmin = _mm_min_epi16(vmin, _mm_xor_si128(_mm_or_si128(v, m), delta));
+                v = _mm_andnot_si128(m, v);
+            }
+            else
+                vmin = _mm_min_epi16(vmin, _mm_xor_si128(v, delta));
+            vmax = _mm_max_epi16(vmax, _mm_xor_si128(v, delta));
+            __m128i v0 = _mm_unpacklo_epi16(v, z), v1 = _mm_unpackhi_epi16(v, z);
+            vs = _mm_add_epi32(vs, _mm_add_epi32(v0, v1));
+            vsq = _mm_add_epi64(vsq, _mm_add_epi64(_mm_mul_epu32(v0, v0), _mm_mul_epu32(v1, v1)));
+            v0 = _mm_srli_epi64(v0, 32);
+            v1 = _mm_srli_epi64(v1, 32);
+            vsq = _mm_add_epi64(vsq, _mm_add_epi64(_mm_mul_epu32(v0, v0), _mm_mul_epu32(v1, v1)));
+            vzero = _mm_add_epi32(vzero, _mm_madd_epi16(_mm_and_si128(_mm_cmpeq_epi16(v, z), one), one));
+        }
+        int s = stat_hsum_epi32(vs), nz = i - stat_hsum_epi32(vzero);
+        double sq = (double)stat_hsum_epi64(vsq);
+        int bmin = stat_hmin_epu16(vmin), bmax = stat_hmax_epu16(vmax);
+        for( ; i < len; i++ )
+            if( !mask || mask[i] )
+            {
+                int v = src[i];
+                s += v;
+                sq += (double)v*v;
+                bmin = std::min(bmin, v);
+                bmax = std::max(bmax, v);
+                nz += v != 0;
+            }
+        if( count > 0 )
+            calcStatsUpdate1(result, s, sq, bmin, bmax, nz);
+        return count;
+    }
+#endif
+    return calcStats_<ushort, int, double>(src, mask, result, len, cn);
+}
 
-    const Mat* arrays[] = {&src, &mask, 0};
-    uchar* ptrs[2];
-    NAryMatIterator it(arrays, ptrs);
-    int total = (int)it.size, blockSize = total, intSumBlockSize = 0;
-    int j, count = 0, nz0 = 0;
-    AutoBuffer<double> _buf(cn*4);
-    double *s = (double*)_buf, *sq = s + cn;
-    int *sbuf = (int*)s, *sqbuf = (int*)sq;
-    bool blockSum = depth <= CV_16S, blockSqSum = depth <= CV_8S;
-    size_t esz = 0;
+static int calcStats16s( const short* src, const uchar* mask, double* result, int len, int cn )
+{ return calcStats_<short, int, double>(src, mask, result, len, cn); }
 
-    for( k = 0; k < cn; k++ )
-        s[k] = sq[k] = 0;
+static int calcStats32s( const int* src, const uchar* mask, double* result, int len, int cn )
+{ return calcStats_<int, double, double>(src, mask, result, len, cn); }
 
-    if( blockSum )
+static int calcStats32f( const float* src, const uchar* mask, double* result, int len, int cn )
+{
+#if CV_SSE2
+    if( USE_SSE2 && cn == 1 )
     {
-        intSumBlockSize = 1 << 15;
-        blockSize = std::min(blockSize, intSumBlockSize);
-        sbuf = (int*)(sq + cn);
-        if( blockSqSum )
-            sqbuf = sbuf + cn;
-        for( k = 0; k < cn; k++ )
-            sbuf[k] = sqbuf[k] = 0;
-        esz = src.elemSize();
+        int i = 0, count = mask ? stat_countMask(mask, len) : len;
+        __m128 zf = _mm_setzero_ps(), vmin = _mm_set1_ps(FLT_MAX), vmax = _mm_set1_ps(-FLT_MAX);
+        __m128d vs0 = _mm_setzero_pd(), vs1 = vs0, vsq0 = vs0, vsq1 = vs0;
+        __m128i vzero = _mm_setzero_si128();
+        for( ; i <= len - 4; i += 4 )
+        {
+            __m128 v = _mm_loadu_ps(src + i);
+            if( mask )
+            {
+                __m128 m = _mm_castsi128_ps(stat_zmask4(mask + i));
+                vmin = _mm_min_ps(_mm_or_ps(_mm_and_ps(m, vmin), _mm_andnot_ps(m, v)), vmin);
+                vmax = _mm_max_ps(_mm_or_ps(_mm_and_ps(m, vmax), _mm_andnot_ps(m, v)), vmax);
+                v = _mm_andnot_ps(m, v);
+            }
+            else
+            {
+                vmin = _mm_min_ps(v, vmin);
+                vmax = _mm_max_ps(v, vmax);
+            }
+            __m128d v0 = _mm_cvtps_pd(v), v1 = _mm_cvtps_pd(_mm_movehl_ps(v, v));
+            vs0 = _mm_add_pd(vs0, v0);
+            vs1 = _mm_add_pd(vs1, v1);
+            vsq0 = _mm_add_pd(vsq0, _mm_mul_pd(v0, v0));
+            vsq1 = _mm_add_pd(vsq1, _mm_mul_pd(v1, v1));
+            // the comparison mask lanes are -1 for the zeros
+            vzero = _mm_sub_epi32(vzero, _mm_castps_si128(_mm_cmpeq_ps(v, zf)));
+        }
+        double s = stat_hsum_pd(_mm_add_pd(vs0, vs1)), sq = stat_hsum_pd(_mm_add_pd(vsq0, vsq1));
+        int nz = i - stat_hsum_epi32(vzero);
+        float bmin = stat_hmin_ps(vmin), bmax = stat_hmax_ps(vmax);
+        for( ; i < len; i++ )
+            if( !mask || mask[i] )
+            {
+                float v = src[i];
+                s += v;
+                sq += (double)v*v;
+                bmin = std::min(bmin, v);
+                bmax = std::max(bmax, v);
+                nz += v != 0;
+            }
+        if( count > 0 )
+            calcStatsUpdate1(result, s, sq, bmin, bmax, nz);
+        return count;
     }
+#endif
+    return calcStats_<float, double, double>(src, mask, result, len, cn);
+}
 
-    for( size_t i = 0; i < it.nplanes; i++, ++it )
+static int calcStats64f( const double* src, const uchar* mask, double* result, int len, int cn )
+{ return calcStats_<double, double, double>(src, mask, result, len, cn); }
+
+typedef int (*CalcStatsFunc)(const uchar*, const uchar*, double*, int, int);
+
+static CalcStatsFunc calcStatsTab[] =
+{
+    (CalcStatsFunc)GET_OPTIMIZED(calcStats8u), (CalcStatsFunc)calcStats8s,
+    (CalcStatsFunc)GET_OPTIMIZED(calcStats16u), (CalcStatsFunc)calcStats16s,
+    (CalcStatsFunc)calcStats32s, (CalcStatsFunc)GET_OPTIMIZED(calcStats32f),
+    (CalcStatsFunc)calcStats64f, 0
+};
+
+// [sum cn][sqsum cn][min cn][max cn][nonzero cn] followed by the number of the processed pixels
+class CalcStatsReducer : public StatReducer
+{
+public:
+    CalcStatsReducer(CalcStatsFunc _func, int _cn) : StatReducer(_cn*5 + 1), func(_func), cn(_cn) {}
+
+    void init(double* result) const
     {
-        for( j = 0; j < total; j += blockSize )
+        StatReducer::init(result);
+        for( int k = 0; k < cn; k++ )
         {
-            int bsz = std::min(total - j, blockSize);
-            int nz = func( ptrs[0], ptrs[1], (uchar*)sbuf, (uchar*)sqbuf, bsz, cn );
-            count += nz;
-            nz0 += nz;
-            if( blockSum && (count + blockSize >= intSumBlockSize || (i+1 >= it.nplanes && j+bsz >= total)) )
-            {
-                for( k = 0; k < cn; k++ )
-                {
-                    s[k] += sbuf[k];
-                    sbuf[k] = 0;
-                }
-                if( blockSqSum )
-                {
-                    for( k = 0; k < cn; k++ )
-                    {
-                        sq[k] += sqbuf[k];
-                        sqbuf[k] = 0;
-                    }
-                }
-                count = 0;
-            }
-            ptrs[0] += bsz*esz;
-            if( ptrs[1] )
-                ptrs[1] += bsz;
+            result[k + cn*2] = DBL_MAX;
+            result[k + cn*3] = -DBL_MAX;
         }
     }
 
-    double scale = nz0 ? 1./nz0 : 0.;
-    for( k = 0; k < cn; k++ )
+    void operator()(uchar** ptrs, int len, size_t, double* result) const
     {
-        s[k] *= scale;
-        sq[k] = std::sqrt(std::max(sq[k]*scale - s[k]*s[k], 0.));
+        result[cn*5] += func(ptrs[0], ptrs[1], result, len, cn);
     }
 
-    for( j = 0; j < 2; j++ )
+    void merge(double* result, const double* partial) const
     {
-        const double* sptr = j == 0 ? s : sq;
-        _OutputArray _dst = j == 0 ? _mean : _sdv;
-        if( !_dst.needed() )
-            continue;
+        for( int k = 0; k < cn; k++ )
+        {
+            result[k] += partial[k];
+            result[k + cn] += partial[k + cn];
+            result[k + cn*2] = std::min(result[k + cn*2], partial[k + cn*2]);
+            result[k + cn*3] = std::max(result[k + cn*3], partial[k + cn*3]);
+            result[k + cn*4] += partial[k + cn*4];
+        }
+        result[cn*5] += partial[cn*5];
+    }
+
+protected:
+    CalcStatsFunc func;
+    int cn;
+};
+
+}
+
+cv::MatStats::MatStats() : count(0)
+{
+}
+
+cv::Scalar cv::MatStats::mean() const
+{
+    return count > 0 ? sum*(1./count) : Scalar();
+}
+
+cv::Scalar cv::MatStats::stddev() const
+{
+    Scalar m = mean(), sdv;
+    if( count > 0 )
+        for( int k = 0; k < 4; k++ )
+            sdv[k] = std::sqrt(std::max(sqsum[k]/count - m[k]*m[k], 0.));
+    return sdv;
+}
+
+void cv::calcStats( InputArray _src, MatStats& stats, InputArray _mask )
+{
+    Mat src = _src.getMat(), mask = _mask.getMat();
+    CV_Assert( mask.empty() || mask.type() == CV_8U );
+
+    int k, cn = src.channels();
+    CalcStatsFunc func = calcStatsTab[src.depth()];
+
+    CV_Assert( cn <= 4 && func != 0 );
+
+    const Mat* arrays[] = {&src, &mask, 0};
+    double result[21];
+    parallelReduce(arrays, CalcStatsReducer(func, cn), statStripeSize(cn), result);
 
-        if( !_dst.fixedSize() )
-            _dst.create(cn, 1, CV_64F, -1, true);
-        Mat dst = _dst.getMat();
-        int dcn = (int)dst.total();
-        CV_Assert( dst.type() == CV_64F && dst.isContinuous() &&
-                   (dst.cols == 1 || dst.rows == 1) && dcn >= cn );
-        double* dptr = dst.ptr<double>();
-        for( k = 0; k < cn; k++ )
-            dptr[k] = sptr[k];
-        for( ; k < dcn; k++ )
-            dptr[k] = 0;
+    stats = MatStats();
+    stats.count = saturate_cast<int>(result[cn*5]);
+    for( k = 0; k < cn; k++ )
+    {
+        stats.sum[k] = result[k];
+        stats.sqsum[k] = result[k + cn];
+        stats.minVal[k] = stats.count > 0 ? result[k + cn*2] : 0;
+        stats.maxVal[k] = stats.count > 0 ? result[k + cn*3] : 0;
+        stats.nonZero[k] = result[k + cn*4];
     }
 }
 
@@ -715,9 +1543,71 @@ minMaxIdx_( const T* src, const uchar* mask, WT* _minVal, WT* _maxVal,
     *_maxVal = maxVal;
 }
 
+// updates the extremums with the minimum and maximum of the block found by the vectorized loop;
+// the positions are taken from the first occurrences, as in minMaxIdx_
+template<typename T, typename WT> static void
+minMaxIdxUpdate_( const T* src, const uchar* mask, T bmin, T bmax, WT* _minVal, WT* _maxVal,
+                  size_t* _minIdx, size_t* _maxIdx, int len, size_t startIdx )
+{
+    int i;
+    if( bmin < *_minVal )
+    {
+        for( i = 0; i < len; i++ )
+            if( src[i] == bmin && (!mask || mask[i]) )
+            {
+                *_minVal = bmin;
+                *_minIdx = startIdx + i;
+                break;
+            }
+    }
+    if( bmax > *_maxVal )
+    {
+        for( i = 0; i < len; i++ )
+            if( src[i] == bmax && (!mask || mask[i]) )
+            {
+                *_maxVal = bmax;
+                *_maxIdx = startIdx + i;
+                break;
+            }
+    }
+}
+
 static void minMaxIdx_8u(const uchar* src, const uchar* mask, int* minval, int* maxval,
                          size_t* minidx, size_t* maxidx, int len, size_t startidx )
-{ minMaxIdx_(src, mask, minval, maxval, minidx, maxidx, len, startidx ); }
+{
+#if CV_SSE2
+    if( USE_SSE2 && len >= 16 )
+    {
+        int i = 0;
+        __m128i z = _mm_setzero_si128(), vmin = _mm_set1_epi8(-1), vmax = z;
+        for( ; i <= len - 16; i += 16 )
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+            if( mask )
+            {
+                __m128i m = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(mask + i)), z);
+                vmin = _mm_min_epu8(vmin, _mm_or_si128(v, m));
+                vmax = _mm_max_epu8(vmax, _mm_andnot_si128(m, v));
+            }
+            else
+            {
+                vmin = _mm_min_epu8(vmin, v);
+                vmax = _mm_max_epu8(vmax, v);
+            }
+        }
+        uchar bmin = stat_hmin_epu8(vmin), bmax = stat_hmax_epu8(vmax);
+        for( ; i < len; i++ )
+            if( !mask || mask[i] )
+            {
+                bmin = std::min(bmin, src[i]);
+                bmax = std::max(bmax, src[i]);
+            }
+        minMaxIdxUpdate_(src, mask, bmin, bmax, minval, maxval, minidx, maxidx, len, startidx);
+        return;
+    }
+#endif
+    minMaxIdx_(src, mask, minval, maxval, minidx, maxidx, len, startidx );
+}
 
 static void minMaxIdx_8s(const schar* src, const uchar* mask, int* minval, int* maxval,
                          size_t* minidx, size_t* maxidx, int len, size_t startidx )
@@ -725,7 +1615,41 @@ static void minMaxIdx_8s(const schar* src, const uchar* mask, int* minval, int*
 
 static void minMaxIdx_16u(const ushort* src, const uchar* mask, int* minval, int* maxval,
                           size_t* minidx, size_t* maxidx, int len, size_t startidx )
-{ minMaxIdx_(src, mask, minval, maxval, minidx, maxidx, len, startidx ); }
+{
+#if CV_SSE2
+    if( USE_SSE2 && len >= 8 )
+    {
+        int i = 0;
+        __m128i delta = _mm_set1_epi16((short)0x8000), vmin = _mm_set1_epi16(0x7fff), vmax = delta;
+        for( ; i <= len - 8; i += 8 )
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+            if( mask )
+            {
+                __m128i m = stat_zmask8(mask + i);
+                vmin = _mm_min_epi16(vmin, _mm_xor_si128(_mm_or_si128(v, m), delta));
+                vmax = _mm_max_epi16(vmax, _mm_xor_si128(_mm_andnot_si128(m, v), delta));
+            }
+            else
+            {
+                v = _mm_xor_si128(v, delta);
+                vmin = _mm_min_epi16(vmin, v);
+                vmax = _mm_max_epi16(vmax, v);
+            }
+        }
+        ushort bmin = stat_hmin_epu16(vmin), bmax = stat_hmax_epu16(vmax);
+        for( ; i < len; i++ )
+            if( !mask || mask[i] )
+            {
+                bmin = std::min(bmin, src[i]);
+                bmax = std::max(bmax, src[i]);
+            }
+        minMaxIdxUpdate_(src, mask, bmin, bmax, minval, maxval, minidx, maxidx, len, startidx);
+        return;
+    }
+#endif
+    minMaxIdx_(src, mask, minval, maxval, minidx, maxidx, len, startidx );
+}
 
 static void minMaxIdx_16s(const short* src, const uchar* mask, int* minval, int* maxval,
                           size_t* minidx, size_t* maxidx, int len, size_t startidx )
@@ -737,7 +1661,44 @@ static void minMaxIdx_32s(const int* src, const uchar* mask, int* minval, int* m
 
 static void minMaxIdx_32f(const float* src, const uchar* mask, float* minval, float* maxval,
                           size_t* minidx, size_t* maxidx, int len, size_t startidx )
-{ minMaxIdx_(src, mask, minval, maxval, minidx, maxidx, len, startidx ); }
+{
+#if CV_SSE2
+    if( USE_SSE2 && len >= 4 )
+    {
+        int i = 0;
+        // the NaNs are skipped, since _mm_min_ps/_mm_max_ps return the second operand for them
+        __m128 vmin = _mm_set1_ps(FLT_MAX), vmax = _mm_set1_ps(-FLT_MAX);
+        for( ; i <= len - 4; i += 4 )
+        {
+            __m128 v = _mm_loadu_ps(src + i);
+            if( mask )
+            {
+                __m128 m = _mm_castsi128_ps(stat_zmask4(mask + i));
+                vmin = _mm_min_ps(_mm_or_ps(_mm_and_ps(m, vmin), _mm_andnot_ps(m, v)), vmin);
+                vmax = _mm_max_ps(_mm_or_ps(_mm_and_ps(m, vmax), _mm_andnot_ps(m, v)), vmax);
+            }
+            else
+            {
+                vmin = _mm_min_ps(v, vmin);
+                vmax = _mm_max_ps(v, vmax);
+            }
+        }
+        float bmin = stat_hmin_ps(vmin), bmax = stat_hmax_ps(vmax);
+        for( ; i < len; i++ )
+            if( !mask || mask[i] )
+            {
+                float v = src[i];
+                if( v < bmin )
+                    bmin = v;
+                if( v > bmax )
+                    bmax = v;
+            }
+        minMaxIdxUpdate_(src, mask, bmin, bmax, minval, maxval, minidx, maxidx, len, startidx);
+        return;
+    }
+#endif
+    minMaxIdx_(src, mask, minval, maxval, minidx, maxidx, len, startidx );
+}
 
 static void minMaxIdx_64f(const double* src, const uchar* mask, double* minval, double* maxval,
                           size_t* minidx, size_t* maxidx, int len, size_t startidx )
@@ -754,6 +1715,65 @@ static MinMaxIdxFunc minmaxTab[] =
     0
 };
 
+// the minimum, its 1-based index, the maximum and its 1-based index; the indices are 0 if nothing is found
+class MinMaxReducer : public StatReducer
+{
+public:
+    MinMaxReducer(MinMaxIdxFunc _func, int _depth, int _cn)
+        : StatReducer(4), func(_func), depth(_depth), cn(_cn) {}
+
+    void operator()(uchar** ptrs, int len, size_t idx, double* result) const
+    {
+        size_t minidx = 0, maxidx = 0, startidx = idx*cn + 1;
+        double partial[4];
+
+        len *= cn;
+        if( depth == CV_32F )
+        {
+            float fminval = FLT_MAX, fmaxval = -FLT_MAX;
+            func(ptrs[0], ptrs[1], (int*)&fminval, (int*)&fmaxval, &minidx, &maxidx, len, startidx);
+            partial[0] = fminval;
+            partial[2] = fmaxval;
+        }
+        else if( depth == CV_64F )
+        {
+            double dminval = DBL_MAX, dmaxval = -DBL_MAX;
+            func(ptrs[0], ptrs[1], (int*)&dminval, (int*)&dmaxval, &minidx, &maxidx, len, startidx);
+            partial[0] = dminval;
+            partial[2] = dmaxval;
+        }
+        else
+        {
+            int iminval = INT_MAX, imaxval = INT_MIN;
+            func(ptrs[0], ptrs[1], &iminval, &imaxval, &minidx, &maxidx, len, startidx);
+            partial[0] = iminval;
+            partial[2] = imaxval;
+        }
+        partial[1] = (double)minidx;
+        partial[3] = (double)maxidx;
+        merge(result, partial);
+    }
+
+    // the partial results are merged in the stripe order, so the first occurrence wins on ties
+    void merge(double* result, const double* partial) const
+    {
+        if( partial[1] != 0 && (result[1] == 0 || partial[0] < result[0]) )
+        {
+            result[0] = partial[0];
+            result[1] = partial[1];
+        }
+        if( partial[3] != 0 && (result[3] == 0 || partial[2] > result[2]) )
+        {
+            result[2] = partial[2];
+            result[3] = partial[3];
+        }
+    }
+
+protected:
+    MinMaxIdxFunc func;
+    int depth, cn;
+};
+
 static void ofs2idx(const Mat& a, size_t ofs, int* idx)
 {
     int i, d = a.dims;
@@ -789,31 +1809,13 @@ void cv::minMaxIdx(InputArray _src, double* minVal,
     CV_Assert( func != 0 );
 
     const Mat* arrays[] = {&src, &mask, 0};
-    uchar* ptrs[2];
-    NAryMatIterator it(arrays, ptrs);
-
-    size_t minidx = 0, maxidx = 0;
-    int iminval = INT_MAX, imaxval = INT_MIN;
-    float fminval = FLT_MAX, fmaxval = -FLT_MAX;
-    double dminval = DBL_MAX, dmaxval = -DBL_MAX;
-    size_t startidx = 1;
-    int *minval = &iminval, *maxval = &imaxval;
-    int planeSize = (int)it.size*cn;
-
-    if( depth == CV_32F )
-        minval = (int*)&fminval, maxval = (int*)&fmaxval;
-    else if( depth == CV_64F )
-        minval = (int*)&dminval, maxval = (int*)&dmaxval;
-
-    for( size_t i = 0; i < it.nplanes; i++, ++it, startidx += planeSize )
-        func( ptrs[0], ptrs[1], minval, maxval, &minidx, &maxidx, planeSize, startidx );
+    double result[4];
+    parallelReduce(arrays, MinMaxReducer(func, depth, cn), statStripeSize(cn), result);
 
+    size_t minidx = (size_t)result[1], maxidx = (size_t)result[3];
+    double dminval = result[0], dmaxval = result[2];
     if( minidx == 0 )
         dminval = dmaxval = 0;
-    else if( depth == CV_32F )
-        dminval = fminval, dmaxval = fmaxval;
-    else if( depth <= CV_32S )
-        dminval = iminval, dmaxval = imaxval;
 
     if( minVal )
         *minVal = dminval;
@@ -1230,26 +2232,280 @@ normDiffL2_(const T* src1, const T* src2, const uchar* mask, ST* _result, int le
 }
 
 
-#define CV_DEF_NORM_FUNC(L, suffix, type, ntype) \
-    static int norm##L##_##suffix(const type* src, const uchar* mask, ntype* r, int len, int cn) \
-{ return norm##L##_(src, mask, r, len, cn); } \
+#define CV_DEF_NORM_DIFF_FUNC(L, suffix, type, ntype) \
     static int normDiff##L##_##suffix(const type* src1, const type* src2, \
     const uchar* mask, ntype* r, int len, int cn) \
 { return normDiff##L##_(src1, src2, mask, r, (int)len, cn); }
 
+#define CV_DEF_NORM_FUNC(L, suffix, type, ntype) \
+    static int norm##L##_##suffix(const type* src, const uchar* mask, ntype* r, int len, int cn) \
+{ return norm##L##_(src, mask, r, len, cn); } \
+    CV_DEF_NORM_DIFF_FUNC(L, suffix, type, ntype)
+
 #define CV_DEF_NORM_ALL(suffix, type, inftype, l1type, l2type) \
     CV_DEF_NORM_FUNC(Inf, suffix, type, inftype) \
     CV_DEF_NORM_FUNC(L1, suffix, type, l1type) \
     CV_DEF_NORM_FUNC(L2, suffix, type, l2type)
 
-CV_DEF_NORM_ALL(8u, uchar, int, int, int)
+#define CV_DEF_NORM_DIFF_ALL(suffix, type, inftype, l1type, l2type) \
+    CV_DEF_NORM_DIFF_FUNC(Inf, suffix, type, inftype) \
+    CV_DEF_NORM_DIFF_FUNC(L1, suffix, type, l1type) \
+    CV_DEF_NORM_DIFF_FUNC(L2, suffix, type, l2type)
+
+// the norms of a single 8u, 16u or 32f array are computed by the vectorized functions below
+CV_DEF_NORM_DIFF_ALL(8u, uchar, int, int, int)
 CV_DEF_NORM_ALL(8s, schar, int, int, int)
-CV_DEF_NORM_ALL(16u, ushort, int, int, double)
+CV_DEF_NORM_DIFF_ALL(16u, ushort, int, int, double)
 CV_DEF_NORM_ALL(16s, short, int, int, double)
 CV_DEF_NORM_ALL(32s, int, int, double, double)
-CV_DEF_NORM_ALL(32f, float, float, double, double)
+CV_DEF_NORM_DIFF_ALL(32f, float, float, double, double)
 CV_DEF_NORM_ALL(64f, double, double, double, double)
 
+// with a mask only the single-channel arrays are processed by the vector loops;
+// otherwise the channels are treated as the separate elements
+static int normInf_8u(const uchar* src, const uchar* mask, int* r, int len, int cn)
+{
+#if CV_SSE2
+    if( USE_SSE2 && (cn == 1 || !mask) )
+    {
+        int i = 0, result = *r;
+        __m128i z = _mm_setzero_si128(), vmax = z;
+        len *= cn;
+        for( ; i <= len - 16; i += 16 )
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+            if( mask )
+                v = _mm_andnot_si128(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(mask + i)), z), v);
+            vmax = _mm_max_epu8(vmax, v);
+        }
+        result = std::max(result, (int)stat_hmax_epu8(vmax));
+        for( ; i < len; i++ )
+            if( !mask || mask[i] )
+                result = std::max(result, (int)src[i]);
+        *r = result;
+        return 0;
+    }
+#endif
+    return normInf_(src, mask, r, len, cn);
+}
+
+static int normL1_8u(const uchar* src, const uchar* mask, int* r, int len, int cn)
+{
+#if CV_SSE2
+    if( USE_SSE2 && (cn == 1 || !mask) )
+    {
+        int i = 0;
+        __m128i z = _mm_setzero_si128(), s0 = z;
+        len *= cn;
+        for( ; i <= len - 16; i += 16 )
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+            if( mask )
+                v = _mm_andnot_si128(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(mask + i)), z), v);
+            s0 = _mm_add_epi64(s0, _mm_sad_epu8(v, z));
+        }
+        int result = *r + (int)stat_hsum_epi64(s0);
+        for( ; i < len; i++ )
+            if( !mask || mask[i] )
+                result += src[i];
+        *r = result;
+        return 0;
+    }
+#endif
+    return normL1_(src, mask, r, len, cn);
+}
+
+static int normL2_8u(const uchar* src, const uchar* mask, int* r, int len, int cn)
+{
+#if CV_SSE2
+    if( USE_SSE2 && (cn == 1 || !mask) )
+    {
+        int i = 0;
+        __m128i z = _mm_setzero_si128(), sq0 = z;
+        len *= cn;
+        for( ; i <= len - 16; i += 16 )
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+            if( mask )
+                v = _mm_andnot_si128(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(mask + i)), z), v);
+            __m128i v0 = _mm_unpacklo_epi8(v, z), v1 = _mm_unpackhi_epi8(v, z);
+            sq0 = _mm_add_epi32(sq0, _mm_add_epi32(_mm_madd_epi16(v0, v0), _mm_madd_epi16(v1, v1)));
+        }
+        int result = *r + stat_hsum_epi32(sq0);
+        for( ; i < len; i++ )
+            if( !mask || mask[i] )
+                result += (int)src[i]*src[i];
+        *r = result;
+        return 0;
+    }
+#endif
+    return normL2_(src, mask, r, len, cn);
+}
+
+static int normInf_16u(const ushort* src, const uchar* mask, int* r, int len, int cn)
+{
+#if CV_SSE2
+    if( USE_SSE2 && (cn == 1 || !mask) )
+    {
+        int i = 0, result = *r;
+        __m128i delta = _mm_set1_epi16((short)0x8000), vmax = delta;
+        len *= cn;
+        for( ; i <= len - 8; i += 8 )
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+            if( mask )
+                v = _mm_andnot_si128(stat_zmask8(mask + i), v);
+            vmax = _mm_max_epi16(vmax, _mm_xor_si128(v, delta));
+        }
+        result = std::max(result, (int)stat_hmax_epu16(vmax));
+        for( ; i < len; i++ )
+            if( !mask || mask[i] )
+                result = std::max(result, (int)src[i]);
+        *r = result;
+        return 0;
+    }
+#endif
+    return normInf_(src, mask, r, len, cn);
+}
+
+static int normL1_16u(const ushort* src, const uchar* mask, int* r, int len, int cn)
+{
+#if CV_SSE2
+    if( USE_SSE2 && (cn == 1 || !mask) )
+    {
+        int i = 0;
+        __m128i z = _mm_setzero_si128(), s0 = z;
+        len *= cn;
+        for( ; i <= len - 8; i += 8 )
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+            if( mask )
+                v = _mm_andnot_si128(stat_zmask8(mask + i), v);
+            s0 = _mm_add_epi32(s0, _mm_add_epi32(_mm_unpacklo_epi16(v, z), _mm_unpackhi_epi16(v, z)));
+        }
+        int result = *r + stat_hsum_epi32(s0);
+        for( ; i < len; i++ )
+            if( !mask || mask[i] )
+                result += src[i];
+        *r = result;
+        return 0;
+    }
+#endif
+    return normL1_(src, mask, r, len, cn);
+}
+
+static int normL2_16u(const ushort* src, const uchar* mask, double* r, int len, int cn)
+{
+#if CV_SSE2
+    if( USE_SSE2 && (cn == 1 || !mask) )
+    {
+        int i = 0;
+        __m128i z = _mm_setzero_si128(), sq0 = z;
+        len *= cn;
+        for( ; i <= len - 8; i += 8 )
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+            if( mask )
+                v = _mm_andnot_si128(stat_zmask8(mask + i), v);
+            __m128i v0 = _mm_unpacklo_epi16(v, z), v1 = _mm_unpackhi_epi16(v, z);
+            sq0 = _mm_add_epi64(sq0, _mm_add_epi64(_mm_mul_epu32(v0, v0), _mm_mul_epu32(v1, v1)));
+            v0 = _mm_srli_epi64(v0, 32); v1 = _mm_srli_epi64(v1, 32);
+            sq0 = _mm_add_epi64(sq0, _mm_add_epi64(_mm_mul_epu32(v0, v0), _mm_mul_epu32(v1, v1)));
+        }
+        int64 result = stat_hsum_epi64(sq0);
+        for( ; i < len; i++ )
+            if( !mask || mask[i] )
+                result += (int64)src[i]*src[i];
+        *r += (double)result;
+        return 0;
+    }
+#endif
+    return normL2_(src, mask, r, len, cn);
+}
+
+static int normInf_32f(const float* src, const uchar* mask, float* r, int len, int cn)
+{
+#if CV_SSE2
+    if( USE_SSE2 && (cn == 1 || !mask) )
+    {
+        int i = 0;
+        float result = *r;
+        __m128 absmask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)), vmax = _mm_setzero_ps();
+        len *= cn;
+        for( ; i <= len - 4; i += 4 )
+        {
+            __m128 v = _mm_and_ps(_mm_loadu_ps(src + i), absmask);
+            if( mask )
+                v = _mm_andnot_ps(_mm_castsi128_ps(stat_zmask4(mask + i)), v);
+            vmax = _mm_max_ps(v, vmax);
+        }
+        result = std::max(result, stat_hmax_ps(vmax));
+        for( ; i < len; i++ )
+            if( !mask || mask[i] )
+                result = std::max(result, std::abs(src[i]));
+        *r = result;
+        return 0;
+    }
+#endif
+    return normInf_(src, mask, r, len, cn);
+}
+
+static int normL1_32f(const float* src, const uchar* mask, double* r, int len, int cn)
+{
+#if CV_SSE2
+    if( USE_SSE2 && (cn == 1 || !mask) )
+    {
+        int i = 0;
+        __m128 absmask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+        __m128d s0 = _mm_setzero_pd(), s1 = s0;
+        len *= cn;
+        for( ; i <= len - 4; i += 4 )
+        {
+            __m128 v = _mm_and_ps(_mm_loadu_ps(src + i), absmask);
+            if( mask )
+                v = _mm_andnot_ps(_mm_castsi128_ps(stat_zmask4(mask + i)), v);
+            s0 = _mm_add_pd(s0, _mm_cvtps_pd(v));
+            s1 = _mm_add_pd(s1, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+        }
+        double result = stat_hsum_pd(_mm_add_pd(s0, s1));
+        for( ; i < len; i++ )
+            if( !mask || mask[i] )
+                result += std::abs(src[i]);
+        *r += result;
+        return 0;
+    }
+#endif
+    return normL1_(src, mask, r, len, cn);
+}
+
+static int normL2_32f(const float* src, const uchar* mask, double* r, int len, int cn)
+{
+#if CV_SSE2
+    if( USE_SSE2 && (cn == 1 || !mask) )
+    {
+        int i = 0;
+        __m128d s0 = _mm_setzero_pd(), s1 = s0;
+        len *= cn;
+        for( ; i <= len - 4; i += 4 )
+        {
+            __m128 v = _mm_loadu_ps(src + i);
+            if( mask )
+                v = _mm_andnot_ps(_mm_castsi128_ps(stat_zmask4(mask + i)), v);
+            __m128d v0 = _mm_cvtps_pd(v), v1 = _mm_cvtps_pd(_mm_movehl_ps(v, v));
+            s0 = _mm_add_pd(s0, _mm_mul_pd(v0, v0));
+            s1 = _mm_add_pd(s1, _mm_mul_pd(v1, v1));
+        }
+        double result = stat_hsum_pd(_mm_add_pd(s0, s1));
+        for( ; i < len; i++ )
+            if( !mask || mask[i] )
+                result += (double)src[i]*src[i];
+        *r += result;
+        return 0;
+    }
+#endif
+    return normL2_(src, mask, r, len, cn);
+}
+
 
 typedef int (*NormFunc)(const uchar*, const uchar*, uchar*, int, int);
 typedef int (*NormDiffFunc)(const uchar*, const uchar*, const uchar*, uchar*, int, int);
@@ -1292,6 +2548,72 @@ static NormDiffFunc normDiffTab[3][8] =
     }
 };
 
+// the norm of the array or of the difference of two arrays;
+// the partial NORM_INF results are merged with max and the others are summed up
+class NormReducer : public StatReducer
+{
+public:
+    NormReducer(NormFunc _func, NormDiffFunc _diffFunc, int _normType, int _depth, int _cn)
+        : StatReducer(1), func(_func), diffFunc(_diffFunc), normType(_normType), depth(_depth), cn(_cn) {}
+
+    void operator()(uchar** ptrs, int len, size_t, double* result) const
+    {
+        union
+        {
+            double d;
+            float f;
+            int i;
+            unsigned u;
+        }
+        r;
+        r.d = 0;
+        if( func )
+            func(ptrs[0], ptrs[1], (uchar*)&r, len, cn);
+        else
+            diffFunc(ptrs[0], ptrs[1], ptrs[2], (uchar*)&r, len, cn);
+
+        double v = r.d;
+        if( normType == NORM_INF )
+        {
+            if( depth == CV_32F )
+                v = r.f;
+            else if( depth <= CV_32S )
+                v = func ? (double)r.i : (double)r.u;
+        }
+        else if( (normType == NORM_L1 && depth <= CV_16S) || depth <= CV_8S )
+            v = func ? (double)r.i : (double)r.u;
+        merge(result, &v);
+    }
+
+    void merge(double* result, const double* partial) const
+    {
+        if( normType == NORM_INF )
+            result[0] = std::max(result[0], partial[0]);
+        else
+            result[0] += partial[0];
+    }
+
+protected:
+    NormFunc func;
+    NormDiffFunc diffFunc;
+    int normType, depth, cn;
+};
+
+class HammingReducer : public StatReducer
+{
+public:
+    HammingReducer(int _cellSize) : StatReducer(1), cellSize(_cellSize) {}
+
+    void operator()(uchar** ptrs, int len, size_t, double* result) const
+    {
+        result[0] += ptrs[1] ? normHamming(ptrs[0], ptrs[1], len, cellSize) :
+                               normHamming(ptrs[0], len, cellSize);
+    }
+
+protected:
+    int cellSize;
+};
+
 }
 
 double cv::norm( InputArray _src, int normType, InputArray _mask )
@@ -1305,8 +2627,9 @@ double cv::norm( InputArray _src, int normType, InputArray _mask )
 
     if( src.isContinuous() && mask.empty() )
     {
+        // the short arrays are processed right away, the rest is split into the stripes
         size_t len = src.total()*cn;
-        if( len == (size_t)(int)len )
+        if( len <= STAT_STRIPE_SIZE )
         {
             if( depth == CV_32F )
             {
@@ -1363,14 +2686,8 @@ double cv::norm( InputArray _src, int normType, InputArray _mask )
         int cellSize = normType == NORM_HAMMING ? 1 : 2;
 
         const Mat* arrays[] = {&src, 0};
-        uchar* ptrs[1];
-        NAryMatIterator it(arrays, ptrs);
-        int total = (int)it.size;
-        int result = 0;
-
-        for( size_t i = 0; i < it.nplanes; i++, ++it )
-            result += normHamming(ptrs[0], total, cellSize);
-
+        double result = 0;
+        parallelReduce(arrays, HammingReducer(cellSize), STAT_STRIPE_SIZE, &result);
         return result;
     }
 
@@ -1378,63 +2695,12 @@ double cv::norm( InputArray _src, int normType, InputArray _mask )
     CV_Assert( func != 0 );
 
     const Mat* arrays[] = {&src, &mask, 0};
-    uchar* ptrs[2];
-    union
-    {
-        double d;
-        int i;
-        float f;
-    }
-    result;
-    result.d = 0;
-    NAryMatIterator it(arrays, ptrs);
-    int j, total = (int)it.size, blockSize = total, intSumBlockSize = 0, count = 0;
-    bool blockSum = (normType == NORM_L1 && depth <= CV_16S) ||
-            ((normType == NORM_L2 || normType == NORM_L2SQR) && depth <= CV_8S);
-    int isum = 0;
-    int *ibuf = &result.i;
-    size_t esz = 0;
-
-    if( blockSum )
-    {
-        intSumBlockSize = (normType == NORM_L1 && depth <= CV_8S ? (1 << 23) : (1 << 15))/cn;
-        blockSize = std::min(blockSize, intSumBlockSize);
-        ibuf = &isum;
-        esz = src.elemSize();
-    }
-
-    for( size_t i = 0; i < it.nplanes; i++, ++it )
-    {
-        for( j = 0; j < total; j += blockSize )
-        {
-            int bsz = std::min(total - j, blockSize);
-            func( ptrs[0], ptrs[1], (uchar*)ibuf, bsz, cn );
-            count += bsz;
-            if( blockSum && (count + blockSize >= intSumBlockSize || (i+1 >= it.nplanes && j+bsz >= total)) )
-            {
-                result.d += isum;
-                isum = 0;
-                count = 0;
-            }
-            ptrs[0] += bsz*esz;
-            if( ptrs[1] )
-                ptrs[1] += bsz;
-        }
-    }
-
-    if( normType == NORM_INF )
-    {
-        if( depth == CV_64F )
-            ;
-        else if( depth == CV_32F )
-            result.d = result.f;
-        else
-            result.d = result.i;
-    }
-    else if( normType == NORM_L2 )
-        result.d = std::sqrt(result.d);
+    double result = 0;
+    parallelReduce(arrays, NormReducer(func, 0, normType, depth, cn), statStripeSize(cn), &result);
 
-    return result.d;
+    if( normType == NORM_L2 )
+        result = std::sqrt(result);
+    return result;
 }
 
 
@@ -1455,7 +2721,7 @@ double cv::norm( InputArray _src1, InputArray _src2, int normType, InputArray _m
     if( src1.isContinuous() && src2.isContinuous() && mask.empty() )
     {
         size_t len = src1.total()*src1.channels();
-        if( len == (size_t)(int)len )
+        if( len <= STAT_STRIPE_SIZE )
         {
             if( src1.depth() == CV_32F )
             {
@@ -1504,14 +2770,8 @@ double cv::norm( InputArray _src1, InputArray _src2, int normType, InputArray _m
         int cellSize = normType == NORM_HAMMING ? 1 : 2;
 
         const Mat* arrays[] = {&src1, &src2, 0};
-        uchar* ptrs[2];
-        NAryMatIterator it(arrays, ptrs);
-        int total = (int)it.size;
-        int result = 0;
-
-        for( size_t i = 0; i < it.nplanes; i++, ++it )
-            result += normHamming(ptrs[0], ptrs[1], total, cellSize);
-
+        double result = 0;
+        parallelReduce(arrays, HammingReducer(cellSize), STAT_STRIPE_SIZE, &result);
         return result;
     }
 
@@ -1519,65 +2779,12 @@ double cv::norm( InputArray _src1, InputArray _src2, int normType, InputArray _m
     CV_Assert( func != 0 );
 
     const Mat* arrays[] = {&src1, &src2, &mask, 0};
-    uchar* ptrs[3];
-    union
-    {
-        double d;
-        float f;
-        int i;
-        unsigned u;
-    }
-    result;
-    result.d = 0;
-    NAryMatIterator it(arrays, ptrs);
-    int j, total = (int)it.size, blockSize = total, intSumBlockSize = 0, count = 0;
-    bool blockSum = (normType == NORM_L1 && depth <= CV_16S) ||
-            ((normType == NORM_L2 || normType == NORM_L2SQR) && depth <= CV_8S);
-    unsigned isum = 0;
-    unsigned *ibuf = &result.u;
-    size_t esz = 0;
+    double result = 0;
+    parallelReduce(arrays, NormReducer(0, func, normType, depth, cn), statStripeSize(cn), &result);
 
-    if( blockSum )
-    {
-        intSumBlockSize = normType == NORM_L1 && depth <= CV_8S ? (1 << 23) : (1 << 15);
-        blockSize = std::min(blockSize, intSumBlockSize);
-        ibuf = &isum;
-        esz = src1.elemSize();
-    }
-
-    for( size_t i = 0; i < it.nplanes; i++, ++it )
-    {
-        for( j = 0; j < total; j += blockSize )
-        {
-            int bsz = std::min(total - j, blockSize);
-            func( ptrs[0], ptrs[1], ptrs[2], (uchar*)ibuf, bsz, cn );
-            count += bsz;
-            if( blockSum && (count + blockSize >= intSumBlockSize || (i+1 >= it.nplanes && j+bsz >= total)) )
-            {
-                result.d += isum;
-                isum = 0;
-                count = 0;
-            }
-            ptrs[0] += bsz*esz;
-            ptrs[1] += bsz*esz;
-            if( ptrs[2] )
-                ptrs[2] += bsz;
-        }
-    }
-
-    if( normType == NORM_INF )
-    {
-        if( depth == CV_64F )
-            ;
-        else if( depth == CV_32F )
-            result.d = result.f;
-        else
-            result.d = result.u;
-    }
-    else if( normType == NORM_L2 )
-        result.d = std::sqrt(result.d);
-
-    return result.d;
+    if( normType == NORM_L2 )
+        result = std::sqrt(result);
+    return result;
 }
 
 
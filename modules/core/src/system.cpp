@@ -179,16 +179,109 @@ struct HWFeatures
             f.have[CV_CPU_SSE4_2] = (cpuid_data[2] & (1<<20)) != 0;
             f.have[CV_CPU_POPCNT] = (cpuid_data[2] & (1<<23)) != 0;
             f.have[CV_CPU_AVX]    = (cpuid_data[2] & (1<<28)) != 0;
+
+            // the 256-bit instructions can be used only if the OS preserves the YMM state
+            int ebx7 = 0;
+            if( (cpuid_data[2] & (1<<27)) != 0 && (getXCR0() & 6) == 6 )
+            {
+                f.have[CV_CPU_FMA3] = f.have[CV_CPU_AVX] && (cpuid_data[2] & (1<<12)) != 0;
+                if( getStructuredFeatures(ebx7) )
+                    f.have[CV_CPU_AVX2] = f.have[CV_CPU_AVX] && (ebx7 & (1<<5)) != 0;
+            }
+            else
+                f.have[CV_CPU_AVX] = false;
         }
 
         return f;
     }
 
+    static int64 getXCR0()
+    {
+    #if defined _MSC_FULL_VER && _MSC_FULL_VER >= 160040219 && (defined _M_IX86 || defined _M_X64)
+        return (int64)_xgetbv(0);
+    #elif defined __GNUC__ && (defined __i386__ || defined __x86_64__)
+        unsigned lo = 0, hi = 0;
+        // xgetbv is emitted as bytes, since the old assemblers do not know the mnemonic
+        asm volatile(".byte 0x0f, 0x01, 0xd0" : "=a"(lo), "=d"(hi) : "c"(0));
+        return ((int64)hi << 32) | lo;
+    #else
+        return 0;
+    #endif
+    }
+
+    // retrieves EBX of the CPUID leaf 7 (structured extended features)
+    static bool getStructuredFeatures(int& ebx7)
+    {
+        int cpuid_data[4] = { 0, 0, 0, 0 };
+
+    #if defined _MSC_FULL_VER && _MSC_FULL_VER >= 160040219 && (defined _M_IX86 || defined _M_X64)
+        __cpuid(cpuid_data, 0);
+        if( cpuid_data[0] < 7 )
+            return false;
+        __cpuidex(cpuid_data, 7, 0);
+    #elif defined __GNUC__ && (defined __i386__ || defined __x86_64__)
+        int maxLeaf = 0, a = 0, b = 0, c = 0, d = 0;
+        #ifdef __x86_64__
+        asm __volatile__
+        (
+         "movl $0, %%eax\n\t"
+         "cpuid\n\t"
+         :[eax]"=a"(maxLeaf),[ebx]"=b"(b),[ecx]"=c"(c),[edx]"=d"(d)
+         :
+         : "cc"
+        );
+        if( maxLeaf < 7 )
+            return false;
+        asm __volatile__
+        (
+         "movl $7, %%eax\n\t"
+         "movl $0, %%ecx\n\t"
+         "cpuid\n\t"
+         :[eax]"=a"(a),[ebx]"=b"(b),[ecx]"=c"(c),[edx]"=d"(d)
+         :
+         : "cc"
+        );
+        #else
+        asm volatile
+        (
+         "pushl %%ebx\n\t"
+         "movl $0,%%eax\n\t"
+         "cpuid\n\t"
+         "popl %%ebx\n\t"
+         : "=a"(maxLeaf), "=c"(c), "=d"(d)
+         :
+         : "cc"
+        );
+        if( maxLeaf < 7 )
+            return false;
+        asm volatile
+        (
+         "pushl %%ebx\n\t"
+         "movl $7,%%eax\n\t"
+         "movl $0,%%ecx\n\t"
+         "cpuid\n\t"
+         "movl %%ebx,%%esi\n\t"
+         "popl %%ebx\n\t"
+         : "=a"(a), "=S"(b), "=c"(c), "=d"(d)
+         :
+         : "cc"
+        );
+        #endif
+        cpuid_data[1] = b;
+    #else
+        return false;
+    #endif
+
+        ebx7 = cpuid_data[1];
+        return true;
+    }
+
     int x86_family;
     bool have[MAX_FEATURE+1];
 };
 
-static HWFeatures  featuresEnabled = HWFeatures::initialize(), featuresDisabled = HWFeatures();
+static HWFeatures  featuresDetected = HWFeatures::initialize(), featuresDisabled = HWFeatures();
+static HWFeatures  featuresEnabled = featuresDetected;
 static HWFeatures* currentFeatures = &featuresEnabled;
 
 bool checkHardwareSupport(int feature)
@@ -211,12 +304,30 @@ IPPInitializer ippInitializer;
 volatile bool USE_SSE2 = featuresEnabled.have[CV_CPU_SSE2];
 volatile bool USE_SSE4_2 = featuresEnabled.have[CV_CPU_SSE4_2];
 volatile bool USE_AVX = featuresEnabled.have[CV_CPU_AVX];
+volatile bool USE_AVX2 = featuresEnabled.have[CV_CPU_AVX2] && featuresEnabled.have[CV_CPU_FMA3];
+
+static void updateFeatureFlags()
+{
+    USE_SSE2 = currentFeatures->have[CV_CPU_SSE2];
+    USE_SSE4_2 = currentFeatures->have[CV_CPU_SSE4_2];
+    USE_AVX = currentFeatures->have[CV_CPU_AVX];
+    USE_AVX2 = currentFeatures->have[CV_CPU_AVX2] && currentFeatures->have[CV_CPU_FMA3];
+}
 
 void setUseOptimized( bool flag )
 {
     useOptimizedFlag = flag;
+    if( flag )
+        featuresEnabled = featuresDetected;
     currentFeatures = flag ? &featuresEnabled : &featuresDisabled;
-    USE_SSE2 = currentFeatures->have[CV_CPU_SSE2];
+    updateFeatureFlags();
+}
+
+void setUseHardwareFeature( int feature, bool flag )
+{
+    CV_Assert( 0 <= feature && feature <= CV_HARDWARE_MAX_FEATURE );
+    featuresEnabled.have[feature] = flag && featuresDetected.have[feature];
+    updateFeatureFlags();
 }
 
 bool useOptimized(void)
@@ -333,53 +444,6 @@ int64 getCPUTickCount(void)
 #endif
 
 
-static int numThreads = 0;
-static int numProcs   = 0;
-
-int getNumThreads(void)
-{
-    if( !numProcs )
-        setNumThreads(0);
-    return numThreads;
-}
-
-void setNumThreads( int
-#ifdef _OPENMP
-                             threads
-#endif
-                  )
-{
-    if( !numProcs )
-    {
-#ifdef _OPENMP
-        numProcs = omp_get_num_procs();
-#else
-        numProcs = 1;
-#endif
-    }
-
-#ifdef _OPENMP
-    if( threads <= 0 )
-        threads = numProcs;
-    else
-        threads = MIN( threads, numProcs );
-
-    numThreads = threads;
-#else
-    numThreads = 1;
-#endif
-}
-
-
-int getThreadNum(void)
-{
-#ifdef _OPENMP
-    return omp_get_thread_num();
-#else
-    return 0;
-#endif
-}
-
 #ifdef ANDROID
 static inline int getNumberOfCPUsImpl()
 {
@@ -460,6 +524,61 @@ int getNumberOfCPUs(void)
 #endif
 }
 
+struct Mutex::Impl
+{
+#if defined WIN32 || defined _WIN32
+    Impl() { InitializeCriticalSection(&cs); refcount = 1; }
+    ~Impl() { DeleteCriticalSection(&cs); }
+
+    void lock() { EnterCriticalSection(&cs); }
+    bool trylock() { return TryEnterCriticalSection(&cs) != 0; }
+    void unlock() { LeaveCriticalSection(&cs); }
+
+    CRITICAL_SECTION cs;
+#else
+    Impl() { pthread_mutex_init(&mt, 0); refcount = 1; }
+    ~Impl() { pthread_mutex_destroy(&mt); }
+
+    void lock() { pthread_mutex_lock(&mt); }
+    bool trylock() { return pthread_mutex_trylock(&mt) == 0; }
+    void unlock() { pthread_mutex_unlock(&mt); }
+
+    pthread_mutex_t mt;
+#endif
+    int refcount;
+};
+
+Mutex::Mutex()
+{
+    impl = new Mutex::Impl;
+}
+
+Mutex::~Mutex()
+{
+    if( CV_XADD(&impl->refcount, -1) == 1 )
+        delete impl;
+    impl = 0;
+}
+
+Mutex::Mutex(const Mutex& m)
+{
+    impl = m.impl;
+    CV_XADD(&impl->refcount, 1);
+}
+
+Mutex& Mutex::operator = (const Mutex& m)
+{
+    CV_XADD(&m.impl->refcount, 1);
+    if( CV_XADD(&impl->refcount, -1) == 1 )
+        delete impl;
+    impl = m.impl;
+    return *this;
+}
+
+void Mutex::lock() { impl->lock(); }
+void Mutex::unlock() { impl->unlock(); }
+bool Mutex::trylock() { return impl->trylock(); }
+
 const std::string& getBuildInformation()
 {
     static std::string build_info =
@@ -924,7 +1043,9 @@ BOOL WINAPI DllMain( HINSTANCE, DWORD  fdwReason, LPVOID )
     if( fdwReason == DLL_THREAD_DETACH || fdwReason == DLL_PROCESS_DETACH )
     {
         cv::deleteThreadAllocData();
+        cv::deleteThreadPoolData();
         cv::deleteThreadRNGData();
+        cv::deleteThreadTraceData();
     }
     return TRUE;
 }
@@ -0,0 +1,597 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "precomp.hpp"
+
+namespace cv
+{
+
+enum { TRACE_MAX_DEPTH = 64, TRACE_MAX_PENDING = 256, TRACE_DEFAULT_BUFFER_SIZE = 1 << 16 };
+
+// one finished call of a region
+struct TraceEvent
+{
+    int id, thread, depth, backend, simd;
+    int64 start, end;
+};
+
+// the exact totals for a region, kept regardless of the ring buffer size
+struct TraceRegionTotals
+{
+    TraceRegionTotals() : count(0), total(0), self(0), maxTime(0), backend(-1), simd(0) {}
+    void add(const TraceRegionTotals& t);
+    int64 count, total, self, maxTime;
+    int backend, simd;
+};
+
+struct TraceOpenRegion
+{
+    int id, backend, simd;
+    int64 start, childTime;
+};
+
+// a finished call that has not been published to the collectors yet
+struct TraceClosedRegion
+{
+    TraceEvent event;
+    int64 childTime;
+};
+
+// a ring buffer of the recent calls
+struct TraceEventBuffer
+{
+    TraceEventBuffer() : head(0) {}
+    void push(const TraceEvent& e, int bufferSize);
+    void shrink(int bufferSize);
+    void clear() { events.clear(); head = 0; }
+
+    vector<TraceEvent> events;
+    size_t head;
+};
+
+// the data of one thread. Only the owner thread touches the open and the closed
+// regions, so entering and leaving a region takes no lock. The closed regions are
+// moved under the mutex to the events and totals, which the collectors read,
+// when the outermost region is left or when there are too many of them
+struct TraceThreadData
+{
+    TraceThreadData(int _index) : index(_index), depth(0), npending(0), generation(0) {}
+
+    void flush();
+    void clear();
+
+    int index;
+    Mutex mutex;
+    TraceEventBuffer buffer;
+    vector<TraceRegionTotals> totals;
+    TraceOpenRegion stack[TRACE_MAX_DEPTH];
+    int depth;
+    TraceClosedRegion pending[TRACE_MAX_PENDING];
+    int npending;
+    int generation; // the reset count when the first pending call was closed
+};
+
+struct TraceStorage
+{
+    TraceStorage() : bufferSize(TRACE_DEFAULT_BUFFER_SIZE), generation(0), nthreads(0), startTick(getTickCount())
+    {
+        regions.push_back((TraceRegionInfo*)0); // the region ids start from 1
+    }
+
+    Mutex mutex;
+    vector<TraceRegionInfo*> regions;
+    vector<TraceThreadData*> threads;
+    // the calls made by the threads that have finished
+    TraceEventBuffer finishedEvents;
+    vector<TraceRegionTotals> finishedTotals;
+    int bufferSize;
+    volatile int generation;
+    int nthreads;
+    int64 startTick;
+};
+
+// the storage is never destroyed, so that the threads finishing
+// after the static objects are destroyed can still release their data
+static TraceStorage& getTraceStorage()
+{
+    static TraceStorage* storage = new TraceStorage;
+    return *storage;
+}
+
+static bool traceEnabledByEnv()
+{
+    const char* str = getenv("OPENCV_TRACE");
+    return str && strcmp(str, "0") != 0;
+}
+
+static volatile bool traceEnabled = traceEnabledByEnv();
+
+void TraceRegionTotals::add(const TraceRegionTotals& t)
+{
+    count += t.count;
+    total += t.total;
+    self += t.self;
+    maxTime = std::max(maxTime, t.maxTime);
+    if( t.backend >= 0 )
+        backend = t.backend;
+    simd |= t.simd;
+}
+
+void TraceEventBuffer::push(const TraceEvent& e, int bufferSize)
+{
+    if( bufferSize <= 0 )
+        return;
+    if( events.size() < (size_t)bufferSize )
+        events.push_back(e);
+    else
+    {
+        if( head >= events.size() )
+            head = 0;
+        events[head++] = e;
+    }
+}
+
+void TraceEventBuffer::shrink(int bufferSize)
+{
+    if( events.size() > (size_t)bufferSize )
+    {
+        vector<TraceEvent>(events.begin(), events.begin() + bufferSize).swap(events);
+        head = 0;
+    }
+}
+
+void TraceThreadData::flush()
+{
+    if( npending == 0 )
+        return;
+    TraceStorage& storage = getTraceStorage();
+    AutoLock lock(mutex);
+
+    // the calls closed before resetTrace() are dropped
+    if( generation == storage.generation )
+    {
+        int bufferSize = storage.bufferSize;
+        for( int i = 0; i < npending; i++ )
+        {
+            const TraceEvent& e = pending[i].event;
+            int64 duration = e.end - e.start;
+            if( (size_t)e.id >= totals.size() )
+                totals.resize(e.id + 1);
+            TraceRegionTotals& t = totals[e.id];
+            t.count++;
+            t.total += duration;
+            t.self += duration - pending[i].childTime;
+            t.maxTime = std::max(t.maxTime, duration);
+            if( e.backend >= 0 )
+                t.backend = e.backend;
+            t.simd |= e.simd;
+            buffer.push(e, bufferSize);
+        }
+    }
+    npending = 0;
+}
+
+void TraceThreadData::clear()
+{
+    AutoLock lock(mutex);
+    buffer.clear();
+    totals.clear();
+}
+
+static TraceThreadData* createTraceThreadData()
+{
+    TraceStorage& storage = getTraceStorage();
+    AutoLock lock(storage.mutex);
+    TraceThreadData* data = new TraceThreadData(storage.nthreads++);
+    storage.threads.push_back(data);
+    return data;
+}
+
+// moves the calls of a finished thread to the storage and frees its data
+static void releaseTraceThreadData(TraceThreadData* data)
+{
+    if( !data )
+        return;
+    data->flush();
+
+    TraceStorage& storage = getTraceStorage();
+    AutoLock lock(storage.mutex);
+    storage.threads.erase(std::remove(storage.threads.begin(), storage.threads.end(), data),
+                          storage.threads.end());
+    if( storage.finishedTotals.size() < data->totals.size() )
+        storage.finishedTotals.resize(data->totals.size());
+    for( size_t i = 0; i < data->totals.size(); i++ )
+        storage.finishedTotals[i].add(data->totals[i]);
+    for( size_t i = 0; i < data->buffer.events.size(); i++ )
+        storage.finishedEvents.push(data->buffer.events[i], storage.bufferSize);
+    delete data;
+}
+
+#ifdef WIN32
+#ifdef WINCE
+#   define TLS_OUT_OF_INDEXES ((DWORD)0xFFFFFFFF)
+#endif //WINCE
+
+static DWORD traceTlsKey = TLS_OUT_OF_INDEXES;
+
+static TraceThreadData* getTraceThreadData()
+{
+    if( traceTlsKey == TLS_OUT_OF_INDEXES )
+    {
+        AutoLock lock(getTraceStorage().mutex);
+        if( traceTlsKey == TLS_OUT_OF_INDEXES )
+            traceTlsKey = TlsAlloc();
+        CV_Assert(traceTlsKey != TLS_OUT_OF_INDEXES);
+    }
+    TraceThreadData* data = (TraceThreadData*)TlsGetValue(traceTlsKey);
+    if( !data )
+    {
+        data = createTraceThreadData();
+        TlsSetValue(traceTlsKey, data);
+    }
+    return data;
+}
+
+void deleteThreadTraceData()
+{
+    if( traceTlsKey != TLS_OUT_OF_INDEXES )
+    {
+        releaseTraceThreadData((TraceThreadData*)TlsGetValue(traceTlsKey));
+        TlsSetValue(traceTlsKey, 0);
+    }
+}
+#else //WIN32
+static pthread_key_t traceTlsKey;
+static pthread_once_t traceTlsKeyOnce = PTHREAD_ONCE_INIT;
+
+static void deleteTraceThreadData(void* data)
+{
+    releaseTraceThreadData((TraceThreadData*)data);
+}
+
+static void makeTraceTlsKey()
+{
+    pthread_key_create(&traceTlsKey, deleteTraceThreadData);
+}
+
+static TraceThreadData* getTraceThreadData()
+{
+    pthread_once(&traceTlsKeyOnce, makeTraceTlsKey);
+    TraceThreadData* data = (TraceThreadData*)pthread_getspecific(traceTlsKey);
+    if( !data )
+    {
+        data = createTraceThreadData();
+        pthread_setspecific(traceTlsKey, data);
+    }
+    return data;
+}
+#endif //WIN32
+
+static void registerTraceRegion(TraceRegionInfo& info)
+{
+    TraceStorage& storage = getTraceStorage();
+    AutoLock lock(storage.mutex);
+    if( info.id == 0 )
+    {
+        storage.regions.push_back(&info);
+        info.id = (int)storage.regions.size() - 1;
+    }
+}
+
+TraceRegion::TraceRegion(TraceRegionInfo& info) : active(false)
+{
+    if( !traceEnabled )
+        return;
+    if( info.id == 0 )
+        registerTraceRegion(info);
+
+    TraceThreadData* data = getTraceThreadData();
+    if( data->depth >= TRACE_MAX_DEPTH )
+        return;
+    TraceOpenRegion& r = data->stack[data->depth++];
+    r.id = info.id;
+    r.backend = -1;
+    r.simd = 0;
+    r.childTime = 0;
+    active = true;
+    r.start = getTickCount();
+}
+
+TraceRegion::~TraceRegion()
+{
+    if( !active )
+        return;
+    int64 end = getTickCount();
+    TraceThreadData* data = getTraceThreadData();
+    const TraceOpenRegion& r = data->stack[--data->depth];
+    if( data->depth > 0 )
+        data->stack[data->depth-1].childTime += end - r.start;
+
+    if( data->npending == 0 )
+        data->generation = getTraceStorage().generation;
+    TraceClosedRegion& c = data->pending[data->npending++];
+    TraceEvent e = { r.id, data->index, data->depth, r.backend, r.simd, r.start, end };
+    c.event = e;
+    c.childTime = r.childTime;
+    if( data->depth == 0 || data->npending == TRACE_MAX_PENDING )
+        data->flush();
+}
+
+void traceSimdPath(int feature)
+{
+    if( !traceEnabled || (unsigned)feature >= 32 )
+        return;
+    TraceThreadData* data = getTraceThreadData();
+    if( data->depth > 0 )
+        data->stack[data->depth-1].simd |= 1 << feature;
+}
+
+void traceParallelBackend(int backend)
+{
+    if( !traceEnabled )
+        return;
+    TraceThreadData* data = getTraceThreadData();
+    if( data->depth > 0 )
+        data->stack[data->depth-1].backend = backend;
+}
+
+void setTraceEnabled(bool enabled)
+{
+    traceEnabled = enabled;
+}
+
+bool isTraceEnabled()
+{
+    return traceEnabled;
+}
+
+void setTraceBufferSize(int ncalls)
+{
+    CV_Assert( ncalls >= 0 );
+    TraceStorage& storage = getTraceStorage();
+    AutoLock lock(storage.mutex);
+    storage.bufferSize = ncalls;
+    storage.finishedEvents.shrink(ncalls);
+    for( size_t i = 0; i < storage.threads.size(); i++ )
+    {
+        TraceThreadData* data = storage.threads[i];
+        AutoLock tlock(data->mutex);
+        data->buffer.shrink(ncalls);
+    }
+}
+
+void resetTrace()
+{
+    TraceStorage& storage = getTraceStorage();
+    AutoLock lock(storage.mutex);
+    storage.generation++;
+    storage.finishedEvents.clear();
+    storage.finishedTotals.clear();
+    for( size_t i = 0; i < storage.threads.size(); i++ )
+        storage.threads[i]->clear();
+    storage.startTick = getTickCount();
+}
+
+TraceRegionStats::TraceRegionStats()
+    : line(0), count(0), totalTime(0), selfTime(0), meanTime(0), medianTime(0),
+      p90Time(0), p99Time(0), maxTime(0), parallelBackend(-1), simdPaths(0)
+{
+}
+
+struct TraceStatsGreater
+{
+    bool operator()(const TraceRegionStats& a, const TraceRegionStats& b) const
+    { return a.totalTime > b.totalTime; }
+};
+
+static double tracePercentile(const vector<int64>& sorted, double q)
+{
+    return (double)sorted[std::min(sorted.size() - 1, (size_t)(q*sorted.size()))];
+}
+
+void getTraceStats(vector<TraceRegionStats>& stats)
+{
+    TraceStorage& storage = getTraceStorage();
+    AutoLock lock(storage.mutex);
+    size_t i, j, nregions = storage.regions.size();
+    vector<TraceRegionTotals> totals(nregions);
+    vector<vector<int64> > durations(nregions);
+
+    for( j = 0; j < storage.finishedTotals.size(); j++ )
+        totals[j].add(storage.finishedTotals[j]);
+    for( j = 0; j < storage.finishedEvents.events.size(); j++ )
+    {
+        const TraceEvent& e = storage.finishedEvents.events[j];
+        durations[e.id].push_back(e.end - e.start);
+    }
+
+    for( i = 0; i < storage.threads.size(); i++ )
+    {
+        TraceThreadData* data = storage.threads[i];
+        AutoLock tlock(data->mutex);
+        for( j = 0; j < data->totals.size(); j++ )
+            totals[j].add(data->totals[j]);
+        for( j = 0; j < data->buffer.events.size(); j++ )
+        {
+            const TraceEvent& e = data->buffer.events[j];
+            durations[e.id].push_back(e.end - e.start);
+        }
+    }
+
+    double scale = 1e6/getTickFrequency();
+    stats.clear();
+    for( i = 1; i < nregions; i++ )
+    {
+        const TraceRegionTotals& t = totals[i];
+        if( t.count == 0 )
+            continue;
+        const TraceRegionInfo* info = storage.regions[i];
+        TraceRegionStats s;
+        s.name = info->name;
+        s.filename = info->filename;
+        s.line = info->line;
+        s.count = t.count;
+        s.totalTime = t.total*scale;
+        s.selfTime = t.self*scale;
+        s.meanTime = s.totalTime/t.count;
+        s.maxTime = t.maxTime*scale;
+        s.parallelBackend = t.backend;
+        s.simdPaths = t.simd;
+        vector<int64>& d = durations[i];
+        if( !d.empty() )
+        {
+            std::sort(d.begin(), d.end());
+            s.medianTime = tracePercentile(d, 0.5)*scale;
+            s.p90Time = tracePercentile(d, 0.9)*scale;
+            s.p99Time = tracePercentile(d, 0.99)*scale;
+        }
+        stats.push_back(s);
+    }
+    std::sort(stats.begin(), stats.end(), TraceStatsGreater());
+}
+
+static const char* traceBackendName(int backend)
+{
+    static const char* names[] = { "serial", "thread_pool", "tbb", "openmp", "gcd", "concurrency" };
+    return (unsigned)backend < sizeof(names)/sizeof(names[0]) ? names[backend] : "unknown";
+}
+
+static string traceSimdNames(int mask)
+{
+    static const char* names[] = { "", "MMX", "SSE", "SSE2", "SSE3", "SSSE3", "SSE4.1", "SSE4.2",
+                                   "POPCNT", "", "AVX", "AVX2", "FMA3" };
+    string str;
+    for( int i = 1; i < (int)(sizeof(names)/sizeof(names[0])); i++ )
+        if( (mask & (1 << i)) && names[i][0] )
+        {
+            if( !str.empty() )
+                str += ' ';
+            str += names[i];
+        }
+    return str;
+}
+
+static void writeJSONString(FILE* f, const char* str)
+{
+    fputc('\"', f);
+    for( ; *str; str++ )
+    {
+        if( *str == '\"' || *str == '\\' )
+            fputc('\\', f);
+        fputc(*str, f);
+    }
+    fputc('\"', f);
+}
+
+struct TraceEventLess
+{
+    bool operator()(const TraceEvent& a, const TraceEvent& b) const
+    {
+        return a.thread < b.thread || (a.thread == b.thread &&
+               (a.start < b.start || (a.start == b.start && a.depth < b.depth)));
+    }
+};
+
+void writeTrace(const string& filename)
+{
+    FILE* f = fopen(filename.c_str(), "wt");
+    if( !f )
+        CV_Error_( CV_StsError, ("Can not open %s for writing", filename.c_str()) );
+
+    TraceStorage& storage = getTraceStorage();
+    AutoLock lock(storage.mutex);
+    double scale = 1e6/getTickFrequency();
+    bool first = true;
+
+    vector<TraceEvent> events = storage.finishedEvents.events;
+    for( size_t i = 0; i < storage.threads.size(); i++ )
+    {
+        TraceThreadData* data = storage.threads[i];
+        AutoLock tlock(data->mutex);
+        events.insert(events.end(), data->buffer.events.begin(), data->buffer.events.end());
+    }
+    std::sort(events.begin(), events.end(), TraceEventLess());
+
+    fprintf(f, "{\"traceEvents\":[");
+    for( size_t j = 0; j < events.size(); j++ )
+    {
+        const TraceEvent& e = events[j];
+        const TraceRegionInfo* info = storage.regions[e.id];
+        const char* shortname = info->filename;
+        for( const char* p = shortname; *p; p++ )
+            if( *p == '/' || *p == '\\' )
+                shortname = p + 1;
+
+        fprintf(f, "%s\n{\"name\":", first ? "" : ",");
+        writeJSONString(f, info->name);
+        fprintf(f, ",\"cat\":");
+        writeJSONString(f, shortname);
+        fprintf(f, ",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"line\":%d",
+                e.thread, (e.start - storage.startTick)*scale, (e.end - e.start)*scale, info->line);
+        if( e.backend >= 0 )
+            fprintf(f, ",\"parallel\":\"%s\"", traceBackendName(e.backend));
+        if( e.simd )
+            fprintf(f, ",\"simd\":\"%s\"", traceSimdNames(e.simd).c_str());
+        fprintf(f, "}}");
+        first = false;
+    }
+    fprintf(f, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    fclose(f);
+}
+
+// writes the trace at exit if the OPENCV_TRACE_FILE environment variable is set
+struct TraceAutoWriter
+{
+    ~TraceAutoWriter()
+    {
+        const char* filename = getenv("OPENCV_TRACE_FILE");
+        if( filename && *filename )
+        {
+            try { writeTrace(filename); }
+            catch(...) {}
+        }
+    }
+};
+
+static TraceAutoWriter traceAutoWriter;
+
+}
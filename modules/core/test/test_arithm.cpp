@@ -1523,3 +1523,164 @@ protected:
 TEST(Core_ArithmMask, uninitialized) { CV_ArithmMaskTest test; test.safe_run(); }
 
 
+
+TEST(Core_CalcStats, accuracy)
+{
+    RNG& rng = theRNG();
+    const int depths[] = { CV_8U, CV_8S, CV_16U, CV_16S, CV_32S, CV_32F, CV_64F };
+
+    for( int iter = 0; iter < 100; iter++ )
+    {
+        int depth = depths[iter % 7], cn = rng.uniform(1, 5);
+        Size sz(rng.uniform(1, 300), rng.uniform(1, 300));
+        if( iter % 10 == 0 )
+            sz = Size(512, 300); // several reduction stripes
+        Mat big(sz.height + 2, sz.width + 3, CV_MAKETYPE(depth, cn)), src, mask;
+        cvtest::randUni(rng, big, Scalar::all(-100), Scalar::all(100));
+        src = iter % 3 == 0 ? big(Rect(Point(1, 1), sz)) : big(Rect(Point(0, 0), sz)).clone();
+        // make some pixels zero
+        Mat zeroMask(sz, CV_8U);
+        rng.fill(zeroMask, RNG::UNIFORM, 0, 4);
+        src.setTo(Scalar::all(0), zeroMask == 0);
+        if( iter % 2 == 0 )
+        {
+            mask.create(sz, CV_8U);
+            rng.fill(mask, RNG::UNIFORM, -1, 2);
+        }
+
+        MatStats stats;
+        calcStats(src, stats, mask);
+
+        Scalar refMean, refSdv;
+        meanStdDev(src, refMean, refSdv, mask);
+        int count = mask.empty() ? (int)src.total() : countNonZero(mask);
+        ASSERT_EQ(count, stats.count);
+
+        vector<Mat> planes;
+        split(src, planes);
+        for( int k = 0; k < cn; k++ )
+        {
+            double minVal = 0, maxVal = 0;
+            minMaxIdx(planes[k], &minVal, &maxVal, 0, 0, mask);
+            Mat masked = Mat::zeros(sz, planes[k].type());
+            planes[k].copyTo(masked, mask.empty() ? Mat(sz, CV_8U, Scalar::all(1)) : mask);
+
+            EXPECT_NEAR(cv::sum(masked)[0], stats.sum[k], 1e-6*std::max(std::abs(stats.sum[k]), 1.));
+            EXPECT_NEAR(norm(masked, NORM_L2SQR), stats.sqsum[k], 1e-6*std::max(stats.sqsum[k], 1.));
+            EXPECT_NEAR(refMean[k], stats.mean()[k], 1e-6);
+            EXPECT_NEAR(refSdv[k], stats.stddev()[k], 1e-5);
+            EXPECT_EQ(minVal, stats.minVal[k]);
+            EXPECT_EQ(maxVal, stats.maxVal[k]);
+            EXPECT_EQ(countNonZero(masked), stats.nonZero[k]);
+        }
+    }
+}
+
+TEST(Core_Stat, parallelDeterminism)
+{
+    Mat src(1000, 1001, CV_32FC1), src2, src8u(2000, 2000, CV_8UC1, Scalar::all(255));
+    cvtest::randUni(theRNG(), src, Scalar::all(-1), Scalar::all(1));
+    flip(src, src2, 1);
+    int nthreads = getNumThreads();
+
+    Scalar s[2], sdv[2];
+    double n[2], ndiff[2], minVal[2], maxVal[2];
+    Point minLoc[2], maxLoc[2];
+    MatStats stats[2];
+    for( int i = 0; i < 2; i++ )
+    {
+        setNumThreads(i == 0 ? 1 : 4);
+        s[i] = cv::sum(src);
+        meanStdDev(src, s[i], sdv[i]);
+        n[i] = norm(src, NORM_L2);
+        ndiff[i] = norm(src, src2, NORM_L1);
+        minMaxLoc(src, &minVal[i], &maxVal[i], &minLoc[i], &maxLoc[i]);
+        calcStats(src, stats[i]);
+    }
+    setNumThreads(nthreads);
+
+    EXPECT_EQ(s[0], s[1]);
+    EXPECT_EQ(sdv[0], sdv[1]);
+    EXPECT_EQ(n[0], n[1]);
+    EXPECT_EQ(ndiff[0], ndiff[1]);
+    EXPECT_EQ(minVal[0], minVal[1]);
+    EXPECT_EQ(maxVal[0], maxVal[1]);
+    EXPECT_EQ(minLoc[0], minLoc[1]);
+    EXPECT_EQ(maxLoc[0], maxLoc[1]);
+    EXPECT_EQ(stats[0].sum, stats[1].sum);
+    EXPECT_EQ(stats[0].sqsum, stats[1].sqsum);
+
+    // the integer block sums must not overflow on the large arrays
+    double total = (double)src8u.total();
+    EXPECT_EQ(255*total, cv::sum(src8u)[0]);
+    EXPECT_EQ(255*255*total, norm(src8u, NORM_L2SQR));
+    EXPECT_EQ(255*total, norm(src8u, Mat::zeros(src8u.size(), CV_8U), NORM_L1));
+    calcStats(src8u, stats[0]);
+    EXPECT_EQ(255*255*total, stats[0].sqsum[0]);
+    EXPECT_EQ(total, stats[0].nonZero[0]);
+}
+
+TEST(Core_SIMDTiers, accuracy)
+{
+    // the same input is processed with the AVX2 tier and with the SSE2 tier
+    if( !checkHardwareSupport(CV_CPU_AVX2) )
+        return;
+
+    const int depths[] = { CV_8U, CV_8S, CV_16U, CV_16S, CV_32S, CV_32F, CV_64F };
+    const int ndepths = (int)(sizeof(depths)/sizeof(depths[0]));
+    RNG& rng = theRNG();
+    // an odd width, so that the AVX2 part of the rows is followed by the SSE2/scalar tail
+    Size sz(1001, 17);
+
+    for( int i = 0; i < ndepths; i++ )
+    {
+        Mat a(sz, depths[i]), b(sz, depths[i]);
+        rng.fill(a, RNG::UNIFORM, -1000, 1000);
+        rng.fill(b, RNG::UNIFORM, -1000, 1000);
+
+        vector<Mat> dst[2];
+        for( int t = 0; t < 2; t++ )
+        {
+            setUseHardwareFeature(CV_CPU_AVX2, t == 0);
+            Mat d;
+            add(a, b, d); dst[t].push_back(d.clone());
+            subtract(a, b, d); dst[t].push_back(d.clone());
+            min(a, b, d); dst[t].push_back(d.clone());
+            max(a, b, d); dst[t].push_back(d.clone());
+            absdiff(a, b, d); dst[t].push_back(d.clone());
+            bitwise_and(a, b, d); dst[t].push_back(d.clone());
+            bitwise_xor(a, b, d); dst[t].push_back(d.clone());
+            for( int j = 0; j < ndepths; j++ )
+            {
+                a.convertTo(d, depths[j]); dst[t].push_back(d.clone());
+                a.convertTo(d, depths[j], 0.37, -5.5); dst[t].push_back(d.clone());
+            }
+        }
+        setUseHardwareFeature(CV_CPU_AVX2, true);
+
+        for( size_t k = 0; k < dst[0].size(); k++ )
+            EXPECT_EQ(0, norm(dst[0][k], dst[1][k], NORM_INF)) << "depth " << depths[i] << ", test #" << k;
+    }
+
+    // the AVX2 math functions use FMA, so the results may differ in the last bits
+    Mat x(sz, CV_32F), y(sz, CV_32F), px(sz, CV_32F);
+    rng.fill(x, RNG::UNIFORM, -80, 80);
+    rng.fill(y, RNG::UNIFORM, -80, 80);
+    rng.fill(px, RNG::UNIFORM, 1e-3, 1e5);
+
+    Mat mag[2], angle[2], e[2], l[2];
+    for( int t = 0; t < 2; t++ )
+    {
+        setUseHardwareFeature(CV_CPU_AVX2, t == 0);
+        magnitude(x, y, mag[t]);
+        phase(x, y, angle[t], true);
+        exp(x, e[t]);
+        log(px, l[t]);
+    }
+    setUseHardwareFeature(CV_CPU_AVX2, true);
+
+    EXPECT_LE(norm(mag[0], mag[1], NORM_RELATIVE + NORM_INF), 1e-6);
+    EXPECT_LE(norm(angle[0], angle[1], NORM_INF), 1e-3);
+    EXPECT_LE(norm(e[0], e[1], NORM_RELATIVE + NORM_INF), 1e-6);
+    EXPECT_LE(norm(l[0], l[1], NORM_INF), 1e-5);
+}
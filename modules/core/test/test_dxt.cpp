@@ -828,3 +828,40 @@ TEST(Core_DFT, accuracy) { CxCore_DFTTest test; test.safe_run(); }
 TEST(Core_MulSpectrums, accuracy) { CxCore_MulSpectrumsTest test; test.safe_run(); }
 
 
+
+TEST(Core_DFT, parallel)
+{
+    int types[] = { CV_32FC1, CV_64FC1, CV_32FC2, CV_64FC2 };
+    Size sizes[] = { Size(256, 200), Size(512, 128), Size(90, 450) };
+    int nthreads = getNumThreads();
+    RNG& rng = theRNG();
+
+    for( size_t t = 0; t < sizeof(types)/sizeof(types[0]); t++ )
+    for( size_t s = 0; s < sizeof(sizes)/sizeof(sizes[0]); s++ )
+    {
+        Mat src(sizes[s], types[t]), dst0, dst1, inv0, inv1, dct0, dct1;
+        rng.fill(src, RNG::UNIFORM, -1, 1);
+        int invflags = DFT_INVERSE + DFT_SCALE + (src.channels() == 1 ? DFT_REAL_OUTPUT : 0);
+
+        // the rows and the columns are split between the threads,
+        // but each 1D transform is computed exactly as in the serial case
+        setNumThreads(1);
+        dft(src, dst0);
+        dft(dst0, inv0, invflags);
+        if( src.channels() == 1 )
+            dct(src, dct0);
+
+        setNumThreads(4);
+        dft(src, dst1);
+        dft(dst1, inv1, invflags);
+        if( src.channels() == 1 )
+            dct(src, dct1);
+        setNumThreads(nthreads);
+
+        EXPECT_EQ(0, norm(dst0, dst1, NORM_INF));
+        EXPECT_EQ(0, norm(inv0, inv1, NORM_INF));
+        EXPECT_LE(norm(inv1, src, NORM_INF), 1e-4);
+        if( src.channels() == 1 )
+            EXPECT_EQ(0, norm(dct0, dct1, NORM_INF));
+    }
+}
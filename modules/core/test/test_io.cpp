@@ -91,7 +91,7 @@ protected:
             {-1000000, 1000000}, {-10, 10}, {-10, 10}};
         RNG& rng = ts->get_rng();
         RNG rng0;
-        test_case_count = 4;
+        test_case_count = 6;
         int progress = 0;
         MemStorage storage(cvCreateMemStorage(0));
 
@@ -103,9 +103,11 @@ protected:
             cvClearMemStorage(storage);
 
             bool mem = (idx % 4) >= 2;
-            string filename = tempfile(idx % 2 ? ".yml" : ".xml");
+            bool binary = idx >= 4;
+            string filename = tempfile(binary ? (idx % 2 ? ".bin.gz" : ".bin") : idx % 2 ? ".yml" : ".xml");
 
-            FileStorage fs(filename, FileStorage::WRITE + (mem ? FileStorage::MEMORY : 0));
+            FileStorage fs(filename, FileStorage::WRITE + (mem ? FileStorage::MEMORY : 0) +
+                           (binary ? FileStorage::FORMAT_BINARY : 0));
 
             int test_int = (int)cvtest::randInt(rng);
             double test_real = (cvtest::randInt(rng)%2?1:-1)*exp(cvtest::randReal(rng)*18-9);
@@ -426,6 +428,124 @@ protected:
 
 TEST(Core_InputOutput, misc) { CV_MiscIOTest test; test.safe_run(); }
 
+class CV_BinaryIOTest : public cvtest::BaseTest
+{
+public:
+    CV_BinaryIOTest() {}
+    ~CV_BinaryIOTest() {}
+protected:
+    void run(int)
+    {
+        try
+        {
+            string xmlname = cv::tempfile(".xml");
+            string binname = cv::tempfile(".bin");
+            string ymlname = cv::tempfile(".yml");
+
+            Mat m8u(37, 41, CV_8UC3), m32f(100, 100, CV_32F);
+            int sz[] = {5, 6, 7};
+            Mat m64f(3, sz, CV_64FC2);
+            randu(m8u, Scalar::all(0), Scalar::all(256));
+            randu(m32f, Scalar::all(-1), Scalar::all(1));
+            randu(m64f, Scalar::all(-100), Scalar::all(100));
+            vector<int> vi(1000);
+            for( size_t i = 0; i < vi.size(); i++ )
+                vi[i] = (int)(i*i);
+
+            FileStorage fs(xmlname, FileStorage::WRITE);
+            fs << "m8u" << m8u << "m32f" << m32f << "m64f" << m64f << "vi" << vi;
+            fs << "params" << "{" << "name" << "binary" << "scale" << 0.5 << "levels" << "[:" << 1 << 2 << 3 << "]" << "}";
+            fs.release();
+
+            FileStorage::convert(xmlname, binname, FileStorage::FORMAT_BINARY);
+            FileStorage::convert(binname, ymlname, FileStorage::FORMAT_YAML);
+
+            fs.open(binname, FileStorage::READ);
+            CV_Assert( fs.isOpened() );
+
+            // the dense matrices share the data with the mapped storage
+            Mat a, b, c;
+            fs["m32f"] >> a;
+            fs["m32f"] >> b;
+            CV_Assert( a.data == b.data && ((size_t)a.data & 15) == 0 );
+            CV_Assert( norm(a, m32f, NORM_INF) == 0 );
+            fs["m8u"] >> c;
+            CV_Assert( c.type() == CV_8UC3 && norm(c, m8u, NORM_INF) == 0 );
+            fs["m64f"] >> c;
+            CV_Assert( c.dims == 3 && c.type() == CV_64FC2 && norm(c, m64f, NORM_INF) == 0 );
+
+            // the raw arrays are materialized on demand
+            FileNode vn = fs["vi"];
+            CV_Assert( vn.isSeq() && vn.size() == vi.size() );
+            CV_Assert( (int)vn[999] == 999*999 );
+            vector<int> vi2;
+            vn >> vi2;
+            CV_Assert( vi2 == vi );
+
+            vector<double> vd(100);
+            FileNodeIterator it = vn.begin();
+            it += 10;
+            it.readRaw("d", (uchar*)&vd[0], vd.size());
+            CV_Assert( vd[0] == vi[10] && vd[99] == vi[109] );
+
+            // the C API reads the raw data directly
+            Ptr<CvMat> cm = (CvMat*)fs["m8u"].readObj();
+            CV_Assert( !cm.empty() && norm(Mat(cm), m8u, NORM_INF) == 0 );
+
+            FileNode params = fs["params"];
+            CV_Assert( (string)params["name"] == "binary" && (double)params["scale"] == 0.5 );
+            CV_Assert( params["levels"].size() == 3 && (int)params["levels"][2] == 3 );
+
+            // the nodes passed to the C API have all the nested sequences decoded
+            CV_Assert( *fs["m32f"] != 0 );
+            const CvFileNode* dnode = fs["m32f"]["data"].node;
+            CvFileNode* e = (CvFileNode*)cvGetSeqElem( dnode->data.seq, 1234 );
+            CV_Assert( e && e->data.f == m32f.at<float>(12, 34) );
+            fs.release();
+
+            CvFileStorage* cfs = cvOpenFileStorage( binname.c_str(), 0, CV_STORAGE_READ );
+            CV_Assert( cfs != 0 );
+            CvFileNode* cvi = cvGetFileNodeByName( cfs, 0, "vi" );
+            CV_Assert( cvi && CV_NODE_IS_SEQ(cvi->tag) && cvi->data.seq->total == (int)vi.size() );
+            CvSeqReader reader;
+            cvStartReadSeq( cvi->data.seq, &reader, 0 );
+            for( size_t i = 0; i < vi.size(); i++ )
+            {
+                CV_Assert( ((CvFileNode*)reader.ptr)->data.i == vi[i] );
+                CV_NEXT_SEQ_ELEM( cvi->data.seq->elem_size, reader );
+            }
+            CvFileNode* cdata = cvGetFileNodeByName( cfs, cvGetFileNodeByName(cfs, 0, "m8u"), "data" );
+            e = (CvFileNode*)cvGetSeqElem( cdata->data.seq, 41*3 + 2 );
+            CV_Assert( e && e->data.i == m8u.at<Vec3b>(1, 0)[2] );
+            cvReleaseFileStorage( &cfs );
+
+            // the matrices stay valid after the storage is closed
+            CV_Assert( norm(a, m32f, NORM_INF) == 0 && norm(c, m64f, NORM_INF) == 0 );
+
+            fs.open(ymlname, FileStorage::READ);
+            fs["m8u"] >> c;
+            CV_Assert( norm(c, m8u, NORM_INF) == 0 );
+            fs["m32f"] >> c;
+            CV_Assert( norm(c, m32f, NORM_INF) == 0 );
+            vi2.clear();
+            fs["vi"] >> vi2;
+            CV_Assert( vi2 == vi );
+            CV_Assert( (int)fs["params"]["levels"][1] == 2 );
+            fs.release();
+
+            remove(xmlname.c_str());
+            remove(binname.c_str());
+            remove(ymlname.c_str());
+        }
+        catch(...)
+        {
+            ts->set_failed_test_info(cvtest::TS::FAIL_MISMATCH);
+        }
+    }
+};
+
+TEST(Core_InputOutput, binary) { CV_BinaryIOTest test; test.safe_run(); }
+
 /*class CV_BigMatrixIOTest : public cvtest::BaseTest
 {
 public:
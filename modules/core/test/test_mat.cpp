@@ -871,4 +871,90 @@ TEST(Core_Mat, reshape_1942)
         cn = M.channels();
     );
     ASSERT_EQ(1, cn);
-}
\ No newline at end of file
+}
+
+TEST(Core_Mat, pool_allocator)
+{
+    PoolMatAllocator* pool = getPoolMatAllocator();
+    MatAllocator* prevAllocator = Mat::getDefaultAllocator();
+    Mat::setDefaultAllocator(pool);
+    pool->releaseCache();
+    pool->resetStats();
+
+    for( int iter = 0; iter < 10; iter++ )
+    {
+        Mat a(480, 640, CV_8UC3, Scalar::all(iter)), b;
+        a.convertTo(b, CV_32F);
+        ASSERT_EQ(pool, a.allocator);
+        ASSERT_EQ((size_t)0, (size_t)a.data % 16);
+        ASSERT_EQ(iter*640*480*3., sum(b)[0] + sum(b)[1] + sum(b)[2]);
+    }
+
+    PoolMatAllocator::Stats stats = pool->getStats();
+    EXPECT_EQ(20, stats.allocations);
+    EXPECT_EQ(2, stats.systemAllocations);
+    EXPECT_EQ(18, stats.poolHits);
+
+    Mat escaped;
+    {
+        MatArenaScope arena(1 << 20);
+        Mat tmp(100, 100, CV_32S, Scalar(7));
+        escaped = Mat(10, 10, CV_64F, Scalar(3));
+        ASSERT_EQ((size_t)0, (size_t)tmp.data % 16);
+        ASSERT_EQ((size_t)0, (size_t)escaped.data % 16);
+        ASSERT_EQ(100*100*7., sum(tmp)[0]);
+    }
+    EXPECT_EQ(300., sum(escaped)[0]);
+
+    pool->releaseCache();
+    Mat::setDefaultAllocator(prevAllocator);
+    Mat c(10, 10, CV_8U);
+    EXPECT_EQ(prevAllocator, c.allocator);
+}
+
+static void countingDeleter(void* data, void* userdata)
+{
+    fastFree(data);
+    ++*(int*)userdata;
+}
+
+TEST(Core_Mat, externalData)
+{
+    int released = 0;
+    {
+        uchar* buf = (uchar*)fastMalloc(100*128);
+        Mat a(100, 120, CV_8UC1, buf, 128, countingDeleter, &released);
+        ASSERT_TRUE(a.refcount != 0);
+        EXPECT_EQ((size_t)128, a.step[0]);
+        a.setTo(Scalar::all(5));
+
+        Mat roi = a(Rect(10, 10, 20, 20)), b = a;
+        a.release();
+        b.release();
+        EXPECT_EQ(0, released);
+        EXPECT_EQ(20*20*5., sum(roi)[0]);
+
+        // the same size and type: the external data is reused
+        roi.create(20, 20, CV_8UC1);
+        EXPECT_EQ(0, released);
+        roi.create(30, 30, CV_8UC1);
+        EXPECT_EQ(1, released);
+        roi.setTo(Scalar::all(1));
+        EXPECT_EQ(30*30., sum(roi)[0]);
+    }
+    EXPECT_EQ(1, released);
+
+    int sizes[] = {4, 5, 6};
+    Mat c(3, sizes, CV_32F, fastMalloc(4*5*6*sizeof(float)), 0, countingDeleter, &released);
+    Mat d = c;
+    c.release();
+    EXPECT_EQ(1, released);
+    d.release();
+    EXPECT_EQ(2, released);
+
+    // the header without a deleter still counts the references, but does not release the data
+    float stackBuf[4];
+    Mat e(Size(2, 2), CV_32F, stackBuf, Mat::AUTO_STEP, 0);
+    e = Scalar(1);
+    EXPECT_EQ(4., sum(e)[0]);
+}
@@ -2598,5 +2598,87 @@ TEST(CovariationMatrixVectorOfMatWithMean, accuracy)
     ASSERT_EQ(sDiff.dot(sDiff), 0.0);
 }
 
+TEST(Core_GEMM, packed)
+{
+    // the shapes large enough for the packed-panel kernel, including the partial tiles and strips
+    const int shapes[][3] = { {97, 301, 259}, {5, 700, 64}, {300, 17, 513}, {256, 256, 256} };
+    RNG& rng = theRNG();
+
+    for( int depth = CV_32F; depth <= CV_64F; depth++ )
+        for( int s = 0; s < (int)(sizeof(shapes)/sizeof(shapes[0])); s++ )
+            for( int flags = 0; flags < 8; flags++ )
+            {
+                int m = shapes[s][0], n = shapes[s][1], k = shapes[s][2];
+                Mat A = flags & GEMM_1_T ? Mat(k, m, depth) : Mat(m, k, depth);
+                Mat B = flags & GEMM_2_T ? Mat(n, k, depth) : Mat(k, n, depth);
+                Mat C = flags & GEMM_3_T ? Mat(n, m, depth) : Mat(m, n, depth);
+                rng.fill(A, RNG::UNIFORM, -1, 1);
+                rng.fill(B, RNG::UNIFORM, -1, 1);
+                rng.fill(C, RNG::UNIFORM, -1, 1);
+
+                Mat D, Dref;
+                cv::gemm(A, B, 0.7, C, -1.3, D, flags);
+                cvtest::gemm(A, B, 0.7, C, -1.3, Dref, flags);
+
+                double eps = depth == CV_32F ? 1e-5 : 1e-12;
+                ASSERT_LE(norm(D, Dref, NORM_INF), eps*norm(Dref, NORM_INF))
+                    << "depth=" << depth << ", m=" << m << ", n=" << n << ", k=" << k << ", flags=" << flags;
+            }
+
+    // the destination shares the data with the inputs
+    Mat A(200, 200, CV_32F), B(200, 200, CV_32F), Dref;
+    rng.fill(A, RNG::UNIFORM, -1, 1);
+    rng.fill(B, RNG::UNIFORM, -1, 1);
+    cvtest::gemm(A, B, 1, A, 2, Dref, 0);
+    cv::gemm(A, B, 1, A, 2, A, 0);
+    ASSERT_LE(norm(A, Dref, NORM_INF), 1e-5*norm(Dref, NORM_INF));
+}
+
+TEST(Core_GEMM, packed_large_k)
+{
+    // a float accumulator would lose ~K*FLT_EPSILON on the sums of the positive products,
+    // so the result must match the product computed in double up to the final rounding
+    const int m = 32, n = 16, k = 100000;
+    Mat A(m, k, CV_32F), B(k, n, CV_32F), A64, B64, D, Dref;
+    theRNG().fill(A, RNG::UNIFORM, 0, 1);
+    theRNG().fill(B, RNG::UNIFORM, 0, 1);
+    A.convertTo(A64, CV_64F);
+    B.convertTo(B64, CV_64F);
+
+    cv::gemm(A, B, 1, Mat(), 0, D, 0);
+    cvtest::gemm(A64, B64, 1, Mat(), 0, Dref, 0);
+
+    ASSERT_EQ(CV_32F, D.type());
+    D.convertTo(D, CV_64F);
+    ASSERT_LE(norm(D, Dref, NORM_INF), 1e-6*norm(Dref, NORM_INF));
+}
+
+TEST(Core_GEMM, batched)
+{
+    RNG& rng = theRNG();
+    vector<Mat> A(50), B(50), C(50), D;
+
+    for( size_t i = 0; i < A.size(); i++ )
+    {
+        int m = rng.uniform(1, 20), n = rng.uniform(1, 20), k = rng.uniform(1, 20);
+        A[i].create(k, m, CV_64F);
+        B[i].create(k, n, CV_64F);
+        C[i].create(m, n, CV_64F);
+        rng.fill(A[i], RNG::UNIFORM, -1, 1);
+        rng.fill(B[i], RNG::UNIFORM, -1, 1);
+        rng.fill(C[i], RNG::UNIFORM, -1, 1);
+    }
+
+    cv::gemmBatched(A, B, 2, C, 0.5, D, GEMM_1_T);
+
+    ASSERT_EQ(A.size(), D.size());
+    for( size_t i = 0; i < A.size(); i++ )
+    {
+        Mat Dref;
+        cv::gemm(A[i], B[i], 2, C[i], 0.5, Dref, GEMM_1_T);
+        ASSERT_EQ(0., norm(D[i], Dref, NORM_INF)) << "i=" << i;
+    }
+}
+
 /* End of file. */
 
@@ -1,4 +1,5 @@
 #include "test_precomp.hpp"
+#include <fstream>
 
 using namespace cv;
 using namespace std;
@@ -39,4 +40,159 @@ TEST(Core_OutputArraySreate, _1997)
     Size submatSize = Size(256, 256);
 
     ASSERT_NO_THROW(local::create( mat(Rect(Point(), submatSize)), submatSize, mat.type() ));
-}
\ No newline at end of file
+}
+
+class ParallelCountBody : public ParallelLoopBody
+{
+public:
+    ParallelCountBody(vector<int>& _counts, bool _nested) : counts(&_counts), nested(_nested) {}
+
+    void operator()(const Range& r) const
+    {
+        for( int i = r.start; i < r.end; i++ )
+        {
+            if( nested )
+            {
+                vector<int> inner(16, 0);
+                parallel_for_(Range(0, (int)inner.size()), ParallelCountBody(inner, false));
+                for( size_t j = 0; j < inner.size(); j++ )
+                    if( inner[j] != 1 )
+                        return;
+            }
+            CV_XADD(&(*counts)[i], 1);
+        }
+    }
+
+protected:
+    vector<int>* counts;
+    bool nested;
+};
+
+class ParallelThrowBody : public ParallelLoopBody
+{
+public:
+    void operator()(const Range& r) const
+    {
+        if( r.start <= 500 && 500 < r.end )
+            CV_Error(CV_StsBadArg, "stop");
+    }
+};
+
+TEST(Core_Parallel, backends)
+{
+    int prevBackend = getParallelBackend();
+    int prevThreads = getNumThreads();
+    int backends[] = { PARALLEL_BACKEND_SERIAL, PARALLEL_BACKEND_THREAD_POOL, PARALLEL_BACKEND_TBB,
+                       PARALLEL_BACKEND_OPENMP, PARALLEL_BACKEND_GCD, PARALLEL_BACKEND_CONCURRENCY };
+
+    ASSERT_TRUE(setParallelBackend(PARALLEL_BACKEND_SERIAL));
+    ASSERT_FALSE(setParallelBackend(-1));
+    setNumThreads(4);
+
+    for( size_t k = 0; k < sizeof(backends)/sizeof(backends[0]); k++ )
+    {
+        if( !setParallelBackend(backends[k]) )
+            continue;
+        EXPECT_EQ(backends[k], getParallelBackend());
+
+        for( int nested = 0; nested < 2; nested++ )
+        {
+            double nstripes[] = { -1., 1., 3., 1000., 1e6 };
+            for( size_t s = 0; s < sizeof(nstripes)/sizeof(nstripes[0]); s++ )
+            {
+                vector<int> counts(1000, 0);
+                parallel_for_(Range(0, (int)counts.size()), ParallelCountBody(counts, nested != 0), nstripes[s]);
+                EXPECT_EQ((int)counts.size(), countNonZero(Mat(counts) == 1)) << "backend " << backends[k] <<
+                    ", nested " << nested << ", nstripes " << nstripes[s];
+            }
+        }
+
+        EXPECT_THROW(parallel_for_(Range(0, 1000), ParallelThrowBody()), cv::Exception);
+    }
+
+    setParallelBackend(prevBackend);
+    setNumThreads(prevThreads);
+}
+
+class TraceSumBody : public ParallelLoopBody
+{
+public:
+    TraceSumBody(vector<double>& _buf) : buf(&_buf) {}
+    void operator()(const Range& r) const
+    {
+        for( int i = r.start; i < r.end; i++ )
+            (*buf)[i] = std::sqrt((double)i);
+    }
+protected:
+    vector<double>* buf;
+};
+
+static const TraceRegionStats* findTraceStats(const vector<TraceRegionStats>& stats, const string& name)
+{
+    for( size_t i = 0; i < stats.size(); i++ )
+        if( stats[i].name == name )
+            return &stats[i];
+    return 0;
+}
+
+TEST(Core_Tracing, regions)
+{
+    static TraceRegionInfo outerInfo = { "Core_Tracing_outer", __FILE__, __LINE__, 0 };
+    static TraceRegionInfo innerInfo = { "Core_Tracing_inner", __FILE__, __LINE__, 0 };
+    bool prevEnabled = isTraceEnabled();
+    vector<double> buf(10000);
+
+    setTraceEnabled(false);
+    {
+        TraceRegion outer(outerInfo);
+    }
+    setTraceEnabled(true);
+    resetTrace();
+
+    for( int i = 0; i < 10; i++ )
+    {
+        TraceRegion outer(outerInfo);
+        for( int j = 0; j < 3; j++ )
+        {
+            TraceRegion inner(innerInfo);
+            parallel_for_(Range(0, (int)buf.size()), TraceSumBody(buf));
+        }
+        traceSimdPath(CV_CPU_SSE2);
+    }
+
+    vector<TraceRegionStats> stats;
+    getTraceStats(stats);
+    const TraceRegionStats* outer = findTraceStats(stats, outerInfo.name);
+    const TraceRegionStats* inner = findTraceStats(stats, innerInfo.name);
+    ASSERT_TRUE(outer != 0);
+    ASSERT_TRUE(inner != 0);
+
+    EXPECT_EQ(10, (int)outer->count);
+    EXPECT_EQ(30, (int)inner->count);
+    EXPECT_LE(outer->selfTime, outer->totalTime);
+    EXPECT_NEAR(inner->totalTime, outer->totalTime - outer->selfTime, 1e-3);
+    EXPECT_LE(inner->medianTime, inner->p90Time);
+    EXPECT_LE(inner->p90Time, inner->p99Time);
+    EXPECT_LE(inner->p99Time, inner->maxTime);
+    EXPECT_EQ(getParallelBackend() == PARALLEL_BACKEND_SERIAL || getNumThreads() <= 1 ?
+              (int)PARALLEL_BACKEND_SERIAL : getParallelBackend(), inner->parallelBackend);
+    EXPECT_EQ(-1, outer->parallelBackend);
+    EXPECT_EQ(1 << CV_CPU_SSE2, outer->simdPaths);
+    EXPECT_EQ(0, inner->simdPaths);
+
+    string filename = cv::tempfile(".json");
+    writeTrace(filename);
+    setTraceEnabled(prevEnabled);
+
+    std::ifstream f(filename.c_str());
+    string text((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    f.close();
+    remove(filename.c_str());
+
+    EXPECT_EQ(0u, text.find("{\"traceEvents\":["));
+    int nevents = 0;
+    for( size_t pos = 0; (pos = text.find("\"name\":\"Core_Tracing_inner\"", pos)) != string::npos; pos++ )
+        nevents++;
+    EXPECT_EQ(30, nevents);
+    EXPECT_NE(string::npos, text.find("\"simd\":\"SSE2\""));
+}
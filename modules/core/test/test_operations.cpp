@@ -1130,3 +1130,118 @@ protected:
 };
 
 TEST(Core_SparseMat, iterations) { CV_SparseMatTest test; test.safe_run(); }
+
+// the element-wise expressions evaluated in a single pass (MatOp_Fused) vs the reference computed in double
+TEST(Core_MatExpr, fused)
+{
+    int types[] = { CV_8UC1, CV_8UC3, CV_16SC1, CV_32FC1, CV_64FC2 };
+    RNG& rng = theRNG();
+
+    for( size_t t = 0; t < sizeof(types)/sizeof(types[0]); t++ )
+    for( int roi = 0; roi < 2; roi++ )
+    {
+        int type = types[t], depth = CV_MAT_DEPTH(type);
+        double eps = depth <= CV_32S ? 0 : depth == CV_32F ? 1e-3 : 1e-10;
+        Mat A(480, 641, type), B(480, 641, type), C(480, 641, type);
+        rng.fill(A, RNG::UNIFORM, 0, 100);
+        rng.fill(B, RNG::UNIFORM, 0, 100);
+        rng.fill(C, RNG::UNIFORM, 1, 50);
+        Mat a = A, b = B, c = C;
+        if( roi )
+        {
+            Rect r(3, 5, 600, 400);
+            a = A(r); b = B(r); c = C(r);
+        }
+
+        Mat ad, bd, cd, t0, t1, ref;
+        a.convertTo(ad, CV_64F);
+        b.convertTo(bd, CV_64F);
+        c.convertTo(cd, CV_64F);
+
+        // a weighted sum of 3 matrices
+        Mat r0 = a*0.5 + b*0.25 - c + Scalar::all(7);
+        addWeighted(ad, 0.5, bd, 0.25, 7, t0);
+        subtract(t0, cd, t0);
+        t0.convertTo(ref, type);
+        ASSERT_EQ(type, r0.type());
+        EXPECT_LE(norm(r0, ref, NORM_INF), eps);
+
+        // ... converted to float
+        if( CV_MAT_CN(type) == 1 )
+        {
+            Mat_<float> r0f = a*0.5 + b*0.25 - c + Scalar::all(7);
+            t0.convertTo(ref, CV_32F);
+            EXPECT_LE(norm(r0f, ref, NORM_INF), 1e-3);
+        }
+
+        // ... and its sub-matrix
+        Rect sub(10, 20, 100, 50);
+        Mat r0s = (a*0.5 + b*0.25 - c + Scalar::all(7))(sub);
+        EXPECT_EQ(0, norm(r0s, r0(sub), NORM_INF));
+
+        // absdiff + threshold
+        Mat m0 = abs(a - b) > 20.5;
+        absdiff(a, b, t1);
+        compare(t1.reshape(1), 20.5, ref, CMP_GT);
+        ASSERT_EQ(CV_8UC(a.channels()), m0.type());
+        EXPECT_EQ(0, norm(m0.reshape(1), ref, NORM_INF));
+
+        Mat m1 = 30 >= abs(a - b);
+        compare(t1.reshape(1), 30, ref, CMP_LE);
+        EXPECT_EQ(0, norm(m1.reshape(1), ref, NORM_INF));
+
+        Mat m2 = abs(a*0.5 + b*0.5 - c) <= 10;
+        addWeighted(ad, 0.5, bd, 0.5, 0, t0);
+        subtract(t0, cd, t0);
+        compare(Mat(abs(t0)).reshape(1), 10, ref, CMP_LE);
+        EXPECT_EQ(0, norm(m2.reshape(1), ref, NORM_INF));
+
+        // products, quotients, min/max
+        Mat r1 = (a - b).mul(c, 0.5);
+        subtract(ad, bd, t0);
+        multiply(t0, cd, t0, 0.5);
+        t0.convertTo(ref, type);
+        EXPECT_LE(norm(r1, ref, NORM_INF), eps);
+
+        Mat r2 = (a + b)/c;
+        add(ad, bd, t0);
+        divide(t0, cd, t0);
+        t0.convertTo(ref, type);
+        // cv::divide multiplies by the reciprocals, so the exact halves may come off by 1 ulp there
+        EXPECT_LE(norm(r2, ref, NORM_INF), depth <= CV_32S ? 1 : eps);
+
+        Mat r3 = max(a, b)*2 - min(a, c);
+        max(ad, bd, t0);
+        min(ad, cd, t1);
+        addWeighted(t0, 2, t1, -1, 0, t0);
+        t0.convertTo(ref, type);
+        EXPECT_LE(norm(r3, ref, NORM_INF), eps);
+
+        // in-place
+        Mat d = a.clone();
+        d = d*2 - b - c;
+        addWeighted(ad, 2, bd, -1, 0, t0);
+        subtract(t0, cd, t0);
+        t0.convertTo(ref, type);
+        EXPECT_LE(norm(d, ref, NORM_INF), eps);
+    }
+}
+
+TEST(Core_MatExpr, fused_vs_eager)
+{
+    Mat a(300, 400, CV_32FC1), b(300, 400, CV_32FC1), c(300, 400, CV_32FC1);
+    randu(a, -10, 10);
+    randu(b, -10, 10);
+    randu(c, -10, 10);
+
+    Mat r0 = a*0.3 + b*0.7 - c, r1 = abs(a - b*2) > 3, r2 = a + b + b + b;
+
+    bool useOpt = useOptimized();
+    setUseOptimized(false);
+    Mat e0 = a*0.3 + b*0.7 - c, e1 = abs(a - b*2) > 3, e2 = a + b + b + b;
+    setUseOptimized(useOpt);
+
+    EXPECT_LE(norm(r0, e0, NORM_INF), 1e-5);
+    EXPECT_EQ(0, norm(r1, e1, NORM_INF));
+    EXPECT_EQ(0, norm(r2, e2, NORM_INF));
+}
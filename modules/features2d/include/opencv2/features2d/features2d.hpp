@@ -544,6 +544,9 @@ public:
       CV_PROP_RW bool filterByConvexity;
       CV_PROP_RW float minConvexity, maxConvexity;
 
+      //! find the blobs by connectedComponentsWithStats() instead of findContours() when no shape filter is on
+      CV_PROP_RW bool useConnectedComponents;
+
       void read( const FileNode& fn );
       void write( FileStorage& fs ) const;
   };
@@ -87,6 +87,8 @@ SimpleBlobDetector::Params::Params()
 	//minConvexity = 0.8;
 	minConvexity = 0.95f;
 	maxConvexity = std::numeric_limits<float>::max();
+
+	useConnectedComponents = false;
 }
 
 void SimpleBlobDetector::Params::read(const cv::FileNode& fn )
@@ -116,6 +118,8 @@ void SimpleBlobDetector::Params::read(const cv::FileNode& fn )
     filterByConvexity = (int)fn["filterByConvexity"] != 0 ? true : false;
     minConvexity = fn["minConvexity"];
     maxConvexity = fn["maxConvexity"];
+
+    useConnectedComponents = (int)fn["useConnectedComponents"] != 0 ? true : false;
 }
 
 void SimpleBlobDetector::Params::write(cv::FileStorage& fs) const
@@ -145,6 +149,8 @@ void SimpleBlobDetector::Params::write(cv::FileStorage& fs) const
     fs << "filterByConvexity" << (int)filterByConvexity;
     fs << "minConvexity" << minConvexity;
     fs << "maxConvexity" << maxConvexity;
+
+    fs << "useConnectedComponents" << (int)useConnectedComponents;
 }
 
 SimpleBlobDetector::SimpleBlobDetector(const SimpleBlobDetector::Params &parameters) :
@@ -167,6 +173,54 @@ void SimpleBlobDetector::findBlobs(const cv::Mat &image, const cv::Mat &binaryIm
 	(void)image;
 	centers.clear();
 
+	if (params.useConnectedComponents &&
+		!params.filterByCircularity && !params.filterByInertia && !params.filterByConvexity)
+	{
+		// No shape filters are enabled, so the contours are not needed: the area and the center
+		// of every blob come from the connected component labeling, which is much cheaper.
+		// The light blobs are the 8-connected components of the binary image, the dark ones are
+		// the 4-connected components of its inverse that do not touch the image border, the same
+		// regions findContours() would outline.
+		for (int color = 0; color < 2; color++)
+		{
+			uchar blobColor = color == 0 ? 0 : 255;
+			if (params.filterByColor && params.blobColor != blobColor)
+				continue;
+
+			Mat labels, stats, centroids;
+			int nlabels = blobColor == 0 ?
+				connectedComponentsWithStats(binaryImage == 0, labels, stats, centroids, 4) :
+				connectedComponentsWithStats(binaryImage, labels, stats, centroids, 8);
+
+			for (int label = 1; label < nlabels; label++)
+			{
+				const int* st = stats.ptr<int>(label);
+				if (blobColor == 0 && (st[CC_STAT_LEFT] == 0 || st[CC_STAT_TOP] == 0 ||
+					st[CC_STAT_LEFT] + st[CC_STAT_WIDTH] == binaryImage.cols ||
+					st[CC_STAT_TOP] + st[CC_STAT_HEIGHT] == binaryImage.rows))
+					continue;
+
+				double area = st[CC_STAT_AREA];
+				if (params.filterByArea && (area < params.minArea || area >= params.maxArea))
+					continue;
+
+				Center center;
+				center.confidence = 1;
+				center.location = Point2d(centroids.at<double>(label, 0), centroids.at<double>(label, 1));
+
+				if (params.filterByColor)
+				{
+					if (binaryImage.at<uchar> (cvRound(center.location.y), cvRound(center.location.x)) != params.blobColor)
+						continue;
+				}
+
+				center.radius = std::sqrt(area / CV_PI);
+				centers.push_back(center);
+			}
+		}
+		return;
+	}
+
 	vector < vector<Point> > contours;
 	Mat tmpBinaryImage = binaryImage.clone();
 	findContours(tmpBinaryImage, contours, CV_RETR_LIST, CV_CHAIN_APPROX_NONE);
@@ -0,0 +1,110 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "test_precomp.hpp"
+
+using namespace cv;
+using namespace std;
+
+static void detectBlobs(const Mat& img, SimpleBlobDetector::Params params, vector<KeyPoint>& keypoints)
+{
+    SimpleBlobDetector detector(params);
+    detector.detect(img, keypoints);
+}
+
+// without the shape filters the detector can take the connected component labeling path,
+// which must find the same blobs as the contour-based one
+TEST(Features2d_SimpleBlobDetector, labelingMatchesContours)
+{
+    Mat img(480, 640, CV_8UC1, Scalar::all(128));
+    RNG rng(12345);
+    vector<Point> darkCenters, lightCenters;
+    for( int y = 40; y < img.rows - 40; y += 80 )
+        for( int x = 40; x < img.cols - 40; x += 80 )
+        {
+            Point c(x + rng.uniform(-10, 10), y + rng.uniform(-10, 10));
+            bool dark = rng.uniform(0, 2) == 0;
+            circle(img, c, rng.uniform(6, 20), Scalar::all(dark ? 20 : 235), -1, CV_AA);
+            (dark ? darkCenters : lightCenters).push_back(c);
+        }
+
+    for( int color = 0; color < 2; color++ )
+    {
+        SimpleBlobDetector::Params contourParams;
+        contourParams.blobColor = color == 0 ? 0 : 255;
+        contourParams.maxArea = 2000;
+        contourParams.filterByInertia = false;
+        contourParams.filterByConvexity = false;
+        contourParams.filterByCircularity = true;
+        contourParams.minCircularity = 0.f;
+
+        SimpleBlobDetector::Params noShapeParams = contourParams;
+        noShapeParams.filterByCircularity = false;
+        SimpleBlobDetector::Params labelingParams = noShapeParams;
+        labelingParams.useConnectedComponents = true;
+
+        vector<KeyPoint> byContours, byDefault, byLabeling;
+        detectBlobs(img, contourParams, byContours);
+        detectBlobs(img, noShapeParams, byDefault);
+        detectBlobs(img, labelingParams, byLabeling);
+
+        // the labeling is used only on request
+        ASSERT_EQ(byContours.size(), byDefault.size()) << "color " << color;
+        for( size_t i = 0; i < byDefault.size(); i++ )
+        {
+            EXPECT_EQ(byContours[i].pt, byDefault[i].pt) << "color " << color << ", blob " << i;
+            EXPECT_EQ(byContours[i].size, byDefault[i].size) << "color " << color << ", blob " << i;
+        }
+
+        const vector<Point>& centers = color == 0 ? darkCenters : lightCenters;
+        ASSERT_EQ(centers.size(), byContours.size()) << "color " << color;
+        ASSERT_EQ(centers.size(), byLabeling.size()) << "color " << color;
+
+        for( size_t i = 0; i < byLabeling.size(); i++ )
+        {
+            double minDist = DBL_MAX;
+            for( size_t j = 0; j < byContours.size(); j++ )
+                minDist = std::min(minDist, norm(byLabeling[i].pt - byContours[j].pt));
+            EXPECT_LT(minDist, 1.) << "color " << color << ", blob " << i;
+        }
+    }
+}
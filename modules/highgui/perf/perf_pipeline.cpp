@@ -0,0 +1,78 @@
+#include "perf_precomp.hpp"
+#include "opencv2/imgproc/imgproc.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+// The frames are decoded into the buffers owned by the application (a ring of frame slots,
+// like the ones in a shared memory segment) and then converted to grayscale.
+
+typedef perf::TestBaseWithParam<Size> Pipeline;
+
+static void releaseSlot(void*, void*)
+{
+}
+
+static void encodeFrames(Size sz, vector<vector<uchar> >& frames)
+{
+    Mat frame(sz, CV_8UC3);
+    frames.resize(4);
+    for( size_t i = 0; i < frames.size(); i++ )
+    {
+        randu(frame, Scalar::all(0), Scalar::all(255));
+        imencode(".bmp", frame, frames[i]);
+    }
+}
+
+// the frames are decoded by imdecode() and copied to the slots
+PERF_TEST_P(Pipeline, decode_copy_cvtColor, testing::Values(szVGA, sz720p, sz1080p))
+{
+    Size sz = GetParam();
+    vector<vector<uchar> > frames;
+    encodeFrames(sz, frames);
+    vector<uchar> slots(sz.area()*3*frames.size());
+    Mat gray;
+
+    declare.time(60);
+
+    size_t i = 0;
+    TEST_CYCLE()
+    {
+        Mat slot(sz, CV_8UC3, &slots[sz.area()*3*(i % frames.size())]);
+        Mat frame = imdecode(frames[i % frames.size()], 1);
+        frame.copyTo(slot);
+        cvtColor(slot, gray, COLOR_BGR2GRAY);
+        i++;
+    }
+
+    SANITY_CHECK(gray);
+}
+
+// the frames are decoded right into the slots wrapped by the reference-counted headers
+PERF_TEST_P(Pipeline, decode_external_cvtColor, testing::Values(szVGA, sz720p, sz1080p))
+{
+    Size sz = GetParam();
+    vector<vector<uchar> > frames;
+    encodeFrames(sz, frames);
+    vector<uchar> slots(sz.area()*3*frames.size());
+    vector<Mat> slotMats(frames.size());
+    for( size_t k = 0; k < frames.size(); k++ )
+        slotMats[k] = Mat(sz, CV_8UC3, &slots[sz.area()*3*k], Mat::AUTO_STEP, releaseSlot);
+    Mat gray;
+
+    declare.time(60);
+
+    size_t i = 0;
+    TEST_CYCLE()
+    {
+        Mat& slot = slotMats[i % frames.size()];
+        imdecode(frames[i % frames.size()], 1, &slot);
+        cvtColor(slot, gray, COLOR_BGR2GRAY);
+        i++;
+    }
+
+    SANITY_CHECK(gray);
+}
@@ -225,3 +225,38 @@ TEST(Highgui_Image, write_imageseq) { CV_GrfmtWriteSequenceImageTest test; test.
 
 TEST(Highgui_Image, read_bmp_rle8) { CV_GrfmtReadBMPRLE8Test test; test.safe_run(); }
 
+static void releaseFrameSlot(void*, void* userdata)
+{
+    ++*(int*)userdata;
+}
+
+TEST(Highgui_Image, imdecode_into_external_buffer)
+{
+    Mat src(48, 64, CV_8UC3), dst;
+    randu(src, Scalar::all(0), Scalar::all(255));
+    vector<uchar> buf;
+    ASSERT_TRUE(imencode(".bmp", src, buf));
+
+    // the frame slot owned by someone else, e.g. a shared memory segment
+    vector<uchar> slot(48*64*3);
+    int released = 0;
+    dst = Mat(48, 64, CV_8UC3, &slot[0], 64*3, releaseFrameSlot, &released);
+
+    Mat img = imdecode(buf, 1, &dst);
+    EXPECT_EQ(&slot[0], img.data);
+    EXPECT_EQ(&slot[0], dst.data);
+    EXPECT_EQ(0., norm(src, dst, NORM_INF));
+
+    img.release();
+    dst.release();
+    EXPECT_EQ(1, released);
+
+    // on failure the destination is released too
+    released = 0;
+    dst = Mat(48, 64, CV_8UC3, &slot[0], 64*3, releaseFrameSlot, &released);
+    vector<uchar> garbage(100, (uchar)0);
+    img = imdecode(garbage, 1, &dst);
+    EXPECT_TRUE(img.empty());
+    EXPECT_TRUE(dst.empty());
+    EXPECT_EQ(1, released);
+}
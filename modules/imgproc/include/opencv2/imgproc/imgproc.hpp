@@ -250,6 +250,7 @@ public:
     virtual int proceed(const uchar* src, int srcStep, int srcCount,
                         uchar* dst, int dstStep);
     //! applies filter to the specified ROI of the image. if srcRoi=(0,0,-1,-1), the whole image is filtered.
+    //! large images are split into horizontal bands processed in parallel by copies of the engine.
     virtual void apply( const Mat& src, Mat& dst,
                         const Rect& srcRoi=Rect(0,0,-1,-1),
                         Point dstOfs=Point(0,0),
@@ -398,6 +399,9 @@ CV_EXPORTS_W void GaussianBlur( InputArray src,
 CV_EXPORTS_W void bilateralFilter( InputArray src, OutputArray dst, int d,
                                    double sigmaColor, double sigmaSpace,
                                    int borderType=BORDER_DEFAULT );
+//! smooths the image using the bilateral grid approximation of the bilateral filter. Each pixel is processed in O(1) time
+CV_EXPORTS_W void bilateralGridFilter( InputArray src, OutputArray dst,
+                                       double sigmaColor, double sigmaSpace );
 //! smooths the image using the box filter. Each pixel is processed in O(1) time
 CV_EXPORTS_W void boxFilter( InputArray src, OutputArray dst, int ddepth,
                              Size ksize, Point anchor=Point(-1,-1),
@@ -440,6 +444,11 @@ CV_EXPORTS_W void Canny( InputArray image, OutputArray edges,
                          double threshold1, double threshold2,
                          int apertureSize=3, bool L2gradient=false );
 
+//! applies Canny edge detector to the precomputed image derivatives (16-bit, as computed by Sobel()).
+CV_EXPORTS void Canny( InputArray dx, InputArray dy, OutputArray edges,
+                       double threshold1, double threshold2,
+                       bool L2gradient=false );
+
 //! computes minimum eigen value of 2x2 derivative covariation matrix at each pixel - the cornerness criteria
 CV_EXPORTS_W void cornerMinEigenVal( InputArray src, OutputArray dst,
                                    int blockSize, int ksize=3,
@@ -576,13 +585,18 @@ CV_EXPORTS_W void getRectSubPix( InputArray image, Size patchSize,
 //! computes the integral image
 CV_EXPORTS_W void integral( InputArray src, OutputArray sum, int sdepth=-1 );
 
-//! computes the integral image and integral for the squared image
+//! computes the integral image and integral for the squared image; any of the two outputs may be omitted
 CV_EXPORTS_AS(integral2) void integral( InputArray src, OutputArray sum,
                                         OutputArray sqsum, int sdepth=-1 );
 //! computes the integral image, integral for the squared image and the tilted integral image
 CV_EXPORTS_AS(integral3) void integral( InputArray src, OutputArray sum,
                                         OutputArray sqsum, OutputArray tilted,
                                         int sdepth=-1 );
+//! the same as above, with the depth of the integral for the squared image (CV_32F or CV_64F)
+CV_EXPORTS void integral( InputArray src, OutputArray sum, OutputArray sqsum,
+                          int sdepth, int sqdepth );
+CV_EXPORTS void integral( InputArray src, OutputArray sum, OutputArray sqsum,
+                          OutputArray tilted, int sdepth, int sqdepth );
 
 //! adds image to the accumulator (dst += src). Unlike cv::add, dst and src can have different types.
 CV_EXPORTS_W void accumulate( InputArray src, InputOutputArray dst,
@@ -633,6 +647,37 @@ CV_EXPORTS_W void pyrUp( InputArray src, OutputArray dst,
 CV_EXPORTS void buildPyramid( InputArray src, OutputArrayOfArrays dst,
                               int maxlevel, int borderType=BORDER_DEFAULT );
 
+/*!
+ The Gaussian Pyramid
+
+ All the levels except the base one are stored in a single buffer, which is reused when
+ the pyramid is rebuilt for an image of the same size and type, e.g. for the next video frame.
+ The base level shares the data with the source image. One pyramid can be built per frame
+ and passed to all the algorithms that need it, see GaussianPyramid::levels().
+*/
+class CV_EXPORTS GaussianPyramid
+{
+public:
+    //! the default constructor
+    GaussianPyramid();
+    //! the full constructor that builds the pyramid with maxlevel+1 levels
+    GaussianPyramid(InputArray img, int maxlevel, int borderType=BORDER_DEFAULT);
+    //! builds the pyramid with maxlevel+1 levels using pyrDown()
+    void build(InputArray img, int maxlevel, int borderType=BORDER_DEFAULT);
+    //! returns the number of levels, including the base one
+    int size() const;
+    //! returns true if the pyramid has not been built
+    bool empty() const;
+    //! returns the i-th level; level 0 is the source image
+    const Mat& operator[](int i) const;
+    //! returns all the levels; can be passed wherever a vector of images is expected
+    const vector<Mat>& levels() const;
+
+protected:
+    Mat buf;
+    vector<Mat> pyr;
+};
+
 //! corrects lens distortion for the given camera matrix and distortion coefficients
 CV_EXPORTS_W void undistort( InputArray src, OutputArray dst,
                              InputArray cameraMatrix,
@@ -704,6 +749,42 @@ CV_EXPORTS_W void calcBackProject( InputArrayOfArrays images, const vector<int>&
                                    const vector<float>& ranges,
                                    double scale );
 
+/*!
+ The histogram of a rectangular window moving over an 8-bit image.
+
+ When the window moves, only the pixels that enter or leave it are processed, so scanning
+ an image or following a target (e.g. with CamShift or meanShift) costs about the perimeter
+ of the window per step instead of its area.
+*/
+class CV_EXPORTS SlidingHistogram
+{
+public:
+    //! the default constructor
+    SlidingHistogram();
+    //! the full constructor; see create()
+    SlidingHistogram(const vector<int>& channels, const vector<int>& histSize,
+                     const vector<float>& ranges);
+    //! sets the histogram layout: the image channels, the number of bins and the uniform ranges
+    void create(const vector<int>& channels, const vector<int>& histSize,
+                const vector<float>& ranges);
+    //! sets the image and computes the histogram of the window from scratch
+    void setImage(InputArray image, Rect window);
+    //! moves and/or resizes the window, updating the histogram incrementally
+    void moveWindow(Rect window);
+    //! returns the current window
+    Rect window() const;
+    //! returns the histogram of the current window, in the format of calcHist()
+    void getHist(OutputArray hist) const;
+
+protected:
+    void addRect(Rect r, int delta);
+
+    Mat image, counts;
+    vector<int> channels;
+    vector<size_t> tab;
+    Rect win;
+};
+
 /*CV_EXPORTS void calcBackProjectPatch( const Mat* images, int nimages, const int* channels,
                                       InputArray hist, OutputArray dst, Size patchSize,
                                       int method, double factor=1 );
@@ -721,6 +802,34 @@ CV_EXPORTS double compareHist( const SparseMat& H1, const SparseMat& H2, int met
 //! normalizes the grayscale image brightness and contrast by normalizing its histogram
 CV_EXPORTS_W void equalizeHist( InputArray src, OutputArray dst );
 
+/*!
+ Contrast Limited Adaptive Histogram Equalization
+
+ Equalizes the histograms of the image tiles separately, clipping them at the given limit,
+ and bilinearly interpolates between the per-tile look-up tables. Works with 8UC1 and 16UC1 images.
+ The buffers are kept between the calls, so processing frames of the same size does not reallocate them.
+*/
+class CV_EXPORTS_W CLAHE : public Algorithm
+{
+public:
+    //! equalizes the histogram of src and writes the result to dst
+    CV_WRAP virtual void apply(InputArray src, OutputArray dst) = 0;
+
+    //! sets the threshold for contrast limiting, in units of the average histogram bin height
+    CV_WRAP virtual void setClipLimit(double clipLimit) = 0;
+    CV_WRAP virtual double getClipLimit() const = 0;
+
+    //! sets the number of tiles in the horizontal and the vertical direction
+    CV_WRAP virtual void setTilesGridSize(Size tileGridSize) = 0;
+    CV_WRAP virtual Size getTilesGridSize() const = 0;
+
+    //! releases the internal buffers
+    CV_WRAP virtual void collectGarbage() = 0;
+};
+
+//! creates CLAHE object with the given clip limit and tile grid size
+CV_EXPORTS_W Ptr<CLAHE> createCLAHE(double clipLimit=40.0, Size tileGridSize=Size(8, 8));
+
 CV_EXPORTS float EMD( InputArray signature1, InputArray signature2,
                       int distType, InputArray cost=noArray(),
                       float* lowerBound=0, OutputArray flow=noArray() );
@@ -1019,6 +1128,9 @@ enum
 //! converts image from one color space to another
 CV_EXPORTS_W void cvtColor( InputArray src, OutputArray dst, int code, int dstCn=0 );
 
+//! converts image into several color spaces at once, reading the source only once
+CV_EXPORTS_W void cvtColorMulti( InputArray src, OutputArrayOfArrays dst, const vector<int>& codes );
+
 //! raster image moments
 class CV_EXPORTS_W_MAP Moments
 {
@@ -1055,6 +1167,61 @@ enum { TM_SQDIFF=0, TM_SQDIFF_NORMED=1, TM_CCORR=2, TM_CCORR_NORMED=3, TM_CCOEFF
 CV_EXPORTS_W void matchTemplate( InputArray image, InputArray templ,
                                  OutputArray result, int method );
 
+/*!
+ Matches a fixed set of templates against a sequence of images.
+
+ The template statistics are computed once, and the template spectra are computed once per
+ image size. Every block of the image is transformed once for all the templates.
+*/
+class CV_EXPORTS TemplateMatcher
+{
+public:
+    //! the default constructor
+    TemplateMatcher();
+    //! the full constructor; see setTemplates()
+    TemplateMatcher(InputArrayOfArrays templs, int method);
+    //! sets the templates (of the same type, possibly of different sizes) and the comparison method
+    void setTemplates(InputArrayOfArrays templs, int method);
+    //! computes the proximity map of every template; results[i] corresponds to the i-th template
+    void match(InputArray image, OutputArrayOfArrays results);
+    //! returns the number of templates
+    int size() const;
+    //! returns the comparison method
+    int getMethod() const;
+
+protected:
+    vector<Mat> templs;
+    vector<Scalar> templMean;
+    vector<double> templNorm, templSum2;
+    vector<uchar> flat;
+    int method;
+
+    // the spectra of the templates for the images of imgSize and imgType
+    vector<Mat> dftTempls;
+    Size imgSize, dftSize, blockSize;
+    int imgType;
+};
+
+//! connected components statistics, the columns of the stats matrix
+enum
+{
+    CC_STAT_LEFT=0, //!< the leftmost (x) coordinate of the bounding box
+    CC_STAT_TOP=1, //!< the topmost (y) coordinate of the bounding box
+    CC_STAT_WIDTH=2, //!< the width of the bounding box
+    CC_STAT_HEIGHT=3, //!< the height of the bounding box
+    CC_STAT_AREA=4, //!< the number of pixels in the component
+    CC_STAT_MAX=5
+};
+
+//! labels the connected components of the non-zero pixels; returns the number of labels, including the background label 0
+CV_EXPORTS_W int connectedComponents( InputArray image, OutputArray labels,
+                                      int connectivity=8, int ltype=CV_32S );
+
+//! labels the connected components and computes their areas, bounding boxes and centroids
+CV_EXPORTS_W int connectedComponentsWithStats( InputArray image, OutputArray labels,
+                                               OutputArray stats, OutputArray centroids,
+                                               int connectivity=8, int ltype=CV_32S );
+
 //! mode of the contour retrieval algorithm
 enum
 {
@@ -1124,6 +1291,127 @@ CV_EXPORTS_W void fitLine( InputArray points, OutputArray line, int distType,
 //! checks if the point is inside the contour. Optionally computes the signed distance from the point to the contour boundary
 CV_EXPORTS_W double pointPolygonTest( InputArray contour, Point2f pt, bool measureDist );
 
+/*!
+ Run-length encoded binary image.
+
+ Every row is stored as the sorted list of disjoint, non-adjacent runs [start, end) of
+ the non-zero pixels, so the memory footprint and the processing time of the functions
+ below depend on the number of runs rather than on the image area.
+*/
+class CV_EXPORTS RLEImage
+{
+public:
+    //! the default constructor
+    RLEImage();
+    //! creates an empty (all-zero) image of the specified size
+    RLEImage(Size size);
+    //! encodes the non-zero pixels of the 8-bit single-channel mask
+    explicit RLEImage(InputArray mask);
+
+    //! makes the image empty (all-zero) and of the specified size
+    void create(Size size);
+    //! decodes the image into an 8-bit mask with the run pixels set to value and the rest to 0
+    void copyTo(OutputArray mask, int value=255) const;
+    //! returns the image size
+    Size size() const;
+    //! returns true if the image has no runs
+    bool empty() const;
+    //! returns the number of the non-zero pixels
+    int area() const;
+
+    //! the number of rows and columns
+    int rows, cols;
+    //! the (start, end) x-coordinates of the runs, row by row; the end is not included
+    vector<Vec2i> runs;
+    //! the runs of the row y are runs[rowOfs[y]], ..., runs[rowOfs[y+1]-1]
+    vector<int> rowOfs;
+};
+
+//! encodes the thresholded 8U, 16S or 32F image; only THRESH_BINARY and THRESH_BINARY_INV are supported
+CV_EXPORTS void threshold( InputArray src, RLEImage& dst, double thresh, int type );
+
+//! computes the per-pixel conjunction of the run-length encoded images of the same size
+CV_EXPORTS void bitwise_and( const RLEImage& src1, const RLEImage& src2, RLEImage& dst );
+//! computes the per-pixel disjunction of the run-length encoded images of the same size
+CV_EXPORTS void bitwise_or( const RLEImage& src1, const RLEImage& src2, RLEImage& dst );
+//! computes the per-pixel "exclusive or" of the run-length encoded images of the same size
+CV_EXPORTS void bitwise_xor( const RLEImage& src1, const RLEImage& src2, RLEImage& dst );
+//! inverts the run-length encoded image
+CV_EXPORTS void bitwise_not( const RLEImage& src, RLEImage& dst );
+
+//! erodes the run-length encoded image with the ksize.width x ksize.height rectangle
+CV_EXPORTS void erode( const RLEImage& src, RLEImage& dst, Size ksize, Point anchor=Point(-1,-1) );
+//! dilates the run-length encoded image with the ksize.width x ksize.height rectangle
+CV_EXPORTS void dilate( const RLEImage& src, RLEImage& dst, Size ksize, Point anchor=Point(-1,-1) );
+
+//! computes the moments of the run-length encoded image
+CV_EXPORTS Moments moments( const RLEImage& image );
+//! computes the bounding rectangle of the non-zero pixels of the run-length encoded image
+CV_EXPORTS Rect boundingRect( const RLEImage& image );
+
+//! retrieves contours and the hierarchical information from the run-length encoded image
+CV_EXPORTS void findContours( const RLEImage& image, OutputArrayOfArrays contours,
+                              OutputArray hierarchy, int mode,
+                              int method, Point offset=Point());
+
+//! retrieves contours from the run-length encoded image
+CV_EXPORTS void findContours( const RLEImage& image, OutputArrayOfArrays contours,
+                              int mode, int method, Point offset=Point());
+
+/*!
+ Contours stored in flat arrays.
+
+ The points of all the contours are kept in a single array, and the object keeps the
+ temporary buffers of findContours(), so the same object can be reused for a sequence of
+ images without reallocating the contours and the buffers once they are large enough.
+*/
+class CV_EXPORTS FlatContours
+{
+public:
+    //! the default constructor
+    FlatContours();
+    //! the copy constructor; copies the contours only, not the temporary buffers
+    FlatContours(const FlatContours& c);
+    //! the assignment operator; copies the contours only, not the temporary buffers
+    FlatContours& operator = (const FlatContours& c);
+    //! the destructor
+    ~FlatContours();
+    //! returns the number of contours
+    int size() const;
+    //! returns true if there are no contours
+    bool empty() const;
+    //! returns the points of the i-th contour
+    const Point* contour(int i) const;
+    //! returns the number of points in the i-th contour
+    int contourSize(int i) const;
+    //! removes all the contours, keeping the allocated memory
+    void clear();
+
+    //! the points of all the contours; the i-th contour is points()[offsets()[i]], ..., points()[offsets()[i+1]-1]
+    const vector<Point>& points() const;
+    //! the offsets of the contours in points(), size()+1 elements
+    const vector<int>& offsets() const;
+    //! the next and previous contours at the same level, the first child and the parent of every contour
+    const vector<Vec4i>& hierarchy() const;
+
+    //! the contours and the temporary buffers; the type is only defined inside the library
+    class Impl;
+
+protected:
+    friend void findContours( InputArray image, FlatContours& contours, int mode, int method, Point offset );
+    friend void findContours( const RLEImage& image, FlatContours& contours, int mode, int method, Point offset );
+
+    Impl* impl;
+};
+
+//! retrieves contours from the 8-bit binary image in parallel; the image is not modified
+CV_EXPORTS void findContours( InputArray image, FlatContours& contours,
+                              int mode, int method, Point offset=Point());
+
+//! retrieves contours from the run-length encoded image in parallel
+CV_EXPORTS void findContours( const RLEImage& image, FlatContours& contours,
+                              int mode, int method, Point offset=Point());
+
 
 class CV_EXPORTS_W Subdiv2D
 {
@@ -0,0 +1,84 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+// A detection-like front end (color conversion, scaling, pyramid, smoothing,
+// gradients, rectification) run with the default fastMalloc-based allocation,
+// with PoolMatAllocator and with PoolMatAllocator in the per-frame arena mode.
+// The number of the Mat allocations and of the system allocations per frame
+// is reported as the test properties.
+
+enum { ALLOC_MALLOC, ALLOC_POOL, ALLOC_POOL_ARENA };
+CV_ENUM(AllocMode, ALLOC_MALLOC, ALLOC_POOL, ALLOC_POOL_ARENA)
+
+typedef std::tr1::tuple<Size, AllocMode> Size_AllocMode_t;
+typedef perf::TestBaseWithParam<Size_AllocMode_t> Size_AllocMode;
+
+static void detectionFrontEnd(const Mat& frame, Mat& features)
+{
+    Mat gray, small, blurred, dx, dy, mag, warped;
+    vector<Mat> pyramid;
+
+    cvtColor(frame, gray, CV_BGR2GRAY);
+    resize(gray, small, Size(), 0.75, 0.75, INTER_LINEAR);
+    buildPyramid(small, pyramid, 3);
+    GaussianBlur(pyramid[1], blurred, Size(5, 5), 0);
+    Sobel(blurred, dx, CV_32F, 1, 0);
+    Sobel(blurred, dy, CV_32F, 0, 1);
+    magnitude(dx, dy, mag);
+
+    Mat M = getRotationMatrix2D(Point2f(mag.cols*0.5f, mag.rows*0.5f), 5, 1);
+    warpAffine(mag, warped, M, mag.size());
+    warped.convertTo(features, CV_8U);
+}
+
+PERF_TEST_P(Size_AllocMode, pipeline_allocations,
+            testing::Combine(
+                testing::Values(szVGA, sz1080p),
+                testing::ValuesIn(AllocMode::all())
+                )
+            )
+{
+    Size size = get<0>(GetParam());
+    int mode = get<1>(GetParam());
+
+    Mat frame(size, CV_8UC3, Scalar::all(0)), features;
+    detectionFrontEnd(frame, features);
+    declare.in(frame, WARMUP_RNG).out(features);
+
+    PoolMatAllocator* pool = getPoolMatAllocator();
+    MatAllocator* prevAllocator = Mat::getDefaultAllocator();
+    if( mode != ALLOC_MALLOC )
+        Mat::setDefaultAllocator(pool);
+    pool->resetStats();
+
+    int frames = 0;
+    TEST_CYCLE()
+    {
+        if( mode == ALLOC_POOL_ARENA )
+        {
+            MatArenaScope arena;
+            detectionFrontEnd(frame, features);
+        }
+        else
+            detectionFrontEnd(frame, features);
+        frames++;
+    }
+
+    PoolMatAllocator::Stats stats = pool->getStats();
+    Mat::setDefaultAllocator(prevAllocator);
+    pool->releaseCache();
+
+    if( mode != ALLOC_MALLOC && frames > 0 )
+    {
+        RecordProperty("allocations_per_frame", (int)(stats.allocations/frames));
+        RecordProperty("system_allocations_per_frame", (int)(stats.systemAllocations/frames));
+        RecordProperty("pool_hit_rate_percent", cvRound(stats.hitRate()*100));
+    }
+
+    SANITY_CHECK(features, 1);
+}
@@ -36,3 +36,51 @@ PERF_TEST_P( TestBilateralFilter, BilateralFilter,
 
     SANITY_CHECK(dst);
 }
+
+typedef TestBaseWithParam< tr1::tuple<Size, int, Mat_Type> > TestBilateralFilterAperture;
+
+PERF_TEST_P( TestBilateralFilterAperture, BilateralFilter_aperture,
+             Combine(
+                Values( szVGA ), // image size
+                Values( 3, 9, 15, 25, 35, 51 ), // d
+                Values( CV_8UC1, CV_32FC1 ) // image type
+             )
+)
+{
+    Size sz   = get<0>(GetParam());
+    int d     = get<1>(GetParam());
+    int type  = get<2>(GetParam());
+    double sigmaColor = CV_MAT_DEPTH(type) == CV_8U ? 30. : 30./255, sigmaSpace = d/3.;
+
+    Mat src(sz, type);
+    Mat dst(sz, type);
+
+    declare.in(src, WARMUP_RNG).out(dst).time(60);
+
+    TEST_CYCLE() bilateralFilter(src, dst, d, sigmaColor, sigmaSpace, BORDER_REPLICATE);
+
+    SANITY_CHECK(dst, 1);
+}
+
+PERF_TEST_P( TestBilateralFilterAperture, BilateralGridFilter,
+             Combine(
+                Values( szVGA, sz1080p ), // image size
+                Values( 3, 9, 15, 25, 35, 51 ), // d, the equivalent aperture of bilateralFilter
+                ValuesIn( Mat_Type::all() ) // image type
+             )
+)
+{
+    Size sz   = get<0>(GetParam());
+    int d     = get<1>(GetParam());
+    int type  = get<2>(GetParam());
+    double sigmaColor = CV_MAT_DEPTH(type) == CV_8U ? 30. : 30./255, sigmaSpace = d/3.;
+
+    Mat src(sz, type);
+    Mat dst(sz, type);
+
+    declare.in(src, WARMUP_RNG).out(dst).time(20);
+
+    TEST_CYCLE() bilateralGridFilter(src, dst, sigmaColor, sigmaSpace);
+
+    SANITY_CHECK(dst, 1);
+}
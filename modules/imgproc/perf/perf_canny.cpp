@@ -35,3 +35,62 @@ PERF_TEST_P(Img_Aperture_L2_thresholds, canny,
 
     SANITY_CHECK(edges);
 }
+
+typedef std::tr1::tuple<Size, MatType, bool> Size_MatType_L2_t;
+typedef perf::TestBaseWithParam<Size_MatType_L2_t> Size_MatType_L2;
+
+static void makeCannySource(Mat& img, Size sz, int type)
+{
+    img.create(sz, type);
+    randu(img, Scalar::all(0), Scalar::all(256));
+    GaussianBlur(img, img, Size(7, 7), 2);
+}
+
+PERF_TEST_P(Size_MatType_L2, canny_noise,
+            testing::Combine(
+                testing::Values(sz1080p, sz720p),
+                testing::Values(CV_8UC1, CV_8UC3),
+                testing::Bool()
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    bool useL2 = get<2>(GetParam());
+
+    Mat img;
+    makeCannySource(img, sz, type);
+    Mat edges(img.size(), CV_8UC1);
+
+    declare.in(img).out(edges);
+
+    TEST_CYCLE() Canny(img, edges, 50, 150, 3, useL2);
+
+    SANITY_CHECK(edges);
+}
+
+typedef std::tr1::tuple<Size, bool> Size_L2_t;
+typedef perf::TestBaseWithParam<Size_L2_t> Size_L2;
+
+PERF_TEST_P(Size_L2, canny_derivatives,
+            testing::Combine(
+                testing::Values(sz1080p, sz720p),
+                testing::Bool()
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    bool useL2 = get<1>(GetParam());
+
+    Mat img, dx, dy;
+    makeCannySource(img, sz, CV_8UC1);
+    Sobel(img, dx, CV_16S, 1, 0, 3, 1, 0, BORDER_REPLICATE);
+    Sobel(img, dy, CV_16S, 0, 1, 3, 1, 0, BORDER_REPLICATE);
+    Mat edges(img.size(), CV_8UC1);
+
+    declare.in(dx, dy).out(edges);
+
+    TEST_CYCLE() Canny(dx, dy, edges, 50, 150, useL2);
+
+    SANITY_CHECK(edges);
+}
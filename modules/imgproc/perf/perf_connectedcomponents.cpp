@@ -0,0 +1,66 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+typedef std::tr1::tuple<Size, int> Size_Connectivity_t;
+typedef perf::TestBaseWithParam<Size_Connectivity_t> Size_Connectivity;
+
+static void makeBlobs(Mat& img, Size sz)
+{
+    Mat noise(sz, CV_8UC1);
+    randu(noise, Scalar::all(0), Scalar::all(256));
+    GaussianBlur(noise, noise, Size(7, 7), 0);
+    threshold(noise, img, 128, 255, THRESH_BINARY);
+}
+
+PERF_TEST_P(Size_Connectivity, connectedComponentsWithStats, testing::Combine(
+                testing::Values(sz1080p, szVGA),
+                testing::Values(4, 8)
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int connectivity = get<1>(GetParam());
+
+    Mat img, labels, stats, centroids;
+    makeBlobs(img, sz);
+
+    declare.in(img);
+
+    int nlabels = 0;
+    TEST_CYCLE() nlabels = connectedComponentsWithStats(img, labels, stats, centroids, connectivity);
+
+    SANITY_CHECK(nlabels);
+    SANITY_CHECK(stats);
+}
+
+typedef perf::TestBaseWithParam<Size> Size_Only;
+
+// the way the blob statistics used to be collected, for comparison
+PERF_TEST_P(Size_Only, findContoursBlobStats, testing::Values(sz1080p, szVGA))
+{
+    Size sz = GetParam();
+
+    Mat img, tmp;
+    makeBlobs(img, sz);
+    vector<vector<Point> > contours;
+    vector<Moments> moms;
+
+    declare.in(img);
+
+    TEST_CYCLE()
+    {
+        img.copyTo(tmp);
+        findContours(tmp, contours, RETR_LIST, CHAIN_APPROX_NONE);
+        moms.resize(contours.size());
+        for( size_t i = 0; i < contours.size(); i++ )
+            moms[i] = moments(contours[i]);
+    }
+
+    int ncontours = (int)contours.size();
+    SANITY_CHECK(ncontours);
+}
@@ -267,3 +267,66 @@ PERF_TEST_P(Size_CvtMode2, cvtColorYUV420,
 
     SANITY_CHECK(dst, 1);
 }
+
+CV_ENUM(CvtModeParallel, CV_BGR2GRAY, CX_BGRA2YCrCb, CV_BGR2YCrCb, CV_BGR2HSV, CV_BGR2Lab,
+        CV_BayerBG2BGR, CV_BayerBG2GRAY, CV_BayerBG2BGR_VNG)
+
+typedef perf::TestBaseWithParam<CvtModeParallel> CvtModeParallelOnly;
+
+PERF_TEST_P(CvtModeParallelOnly, cvtColor1080p, testing::ValuesIn(CvtModeParallel::all()))
+{
+    Size sz = sz1080p;
+    int mode = GetParam();
+    ChPair ch = getConversionInfo(mode);
+    mode %= CV_COLORCVT_MAX;
+
+    Mat src(sz, CV_8UC(ch.scn));
+    Mat dst(sz, CV_8UC(ch.dcn));
+
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    TEST_CYCLE() cvtColor(src, dst, mode, ch.dcn);
+
+    SANITY_CHECK(dst, 1);
+}
+
+typedef std::tr1::tuple<MatType, bool> MatType_Fused_t;
+typedef perf::TestBaseWithParam<MatType_Fused_t> MatType_Fused;
+
+// Gray + HSV + YCrCb of one 4K frame: three cvtColor calls read the frame
+// three times, cvtColorMulti reads it once.
+PERF_TEST_P(MatType_Fused, cvtColorMulti_4k,
+            testing::Combine(
+                testing::Values(CV_8UC3, CV_32FC3),
+                testing::Bool()
+                )
+            )
+{
+    Size sz(3840, 2160);
+    int type = get<0>(GetParam());
+    bool fused = get<1>(GetParam());
+    int codes[] = { CV_BGR2GRAY, CV_BGR2HSV, CV_BGR2YCrCb };
+    vector<int> cvtCodes(codes, codes + 3);
+
+    Mat src(sz, type);
+    vector<Mat> dst(3);
+
+    declare.in(src, WARMUP_RNG).time(60);
+
+    if( fused )
+    {
+        TEST_CYCLE() cvtColorMulti(src, dst, cvtCodes);
+    }
+    else
+    {
+        TEST_CYCLE()
+        {
+            for( int i = 0; i < 3; i++ )
+                cvtColor(src, dst[i], codes[i]);
+        }
+    }
+
+    Mat gray = dst[0], ycrcb = dst[2];
+    SANITY_CHECK(gray, 1);
+    SANITY_CHECK(ycrcb, 1);
+}
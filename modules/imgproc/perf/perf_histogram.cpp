@@ -0,0 +1,150 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+typedef TestBaseWithParam<Size> Size_Only;
+
+PERF_TEST_P(Size_Only, equalizeHist,
+            testing::Values(sz1080p, sz2160p)
+            )
+{
+    Size sz = GetParam();
+
+    Mat src(sz, CV_8UC1);
+    Mat dst(sz, CV_8UC1);
+
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    TEST_CYCLE() equalizeHist(src, dst);
+
+    SANITY_CHECK(dst);
+}
+
+typedef std::tr1::tuple<Size, MatType, double> Size_MatType_ClipLimit_t;
+typedef TestBaseWithParam<Size_MatType_ClipLimit_t> Size_MatType_ClipLimit;
+
+PERF_TEST_P(Size_MatType_ClipLimit, CLAHE, testing::Combine(
+                testing::Values(sz1080p, sz2160p),
+                testing::Values(CV_8UC1, CV_16UC1),
+                testing::Values(0.0, 40.0)
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    double clipLimit = get<2>(GetParam());
+
+    Mat src(sz, type);
+    Mat dst(sz, type);
+
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    Ptr<CLAHE> clahe = createCLAHE(clipLimit);
+
+    TEST_CYCLE() clahe->apply(src, dst);
+
+    SANITY_CHECK(dst);
+}
+
+typedef std::tr1::tuple<Size, int> Size_Dims_t;
+typedef perf::TestBaseWithParam<Size_Dims_t> Size_Dims;
+
+// a joint histogram of the color channels, as used for the scene change detection
+PERF_TEST_P(Size_Dims, calcHist_color,
+            testing::Combine(
+                testing::Values(sz720p, sz1080p),
+                testing::Values(1, 3)
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int dims = get<1>(GetParam());
+
+    Mat src(sz, CV_8UC3);
+    Mat hist;
+    int channels[] = { 0, 1, 2 };
+    int histSize[] = { 16, 16, 16 };
+    float range[] = { 0, 256 };
+    const float* ranges[] = { range, range, range };
+
+    declare.in(src, WARMUP_RNG);
+
+    TEST_CYCLE() calcHist(&src, 1, channels, Mat(), hist, dims, histSize, ranges);
+
+    SANITY_CHECK(hist);
+}
+
+PERF_TEST_P(Size_Dims, calcBackProject_color,
+            testing::Combine(
+                testing::Values(sz720p, sz1080p),
+                testing::Values(1, 3)
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int dims = get<1>(GetParam());
+
+    Mat src(sz, CV_8UC3);
+    Mat hist, dst(sz, CV_8UC1);
+    int channels[] = { 0, 1, 2 };
+    int histSize[] = { 16, 16, 16 };
+    float range[] = { 0, 256 };
+    const float* ranges[] = { range, range, range };
+
+    declare.in(src, WARMUP_RNG).out(dst);
+    calcHist(&src, 1, channels, Mat(), hist, dims, histSize, ranges);
+
+    TEST_CYCLE() calcBackProject(&src, 1, channels, hist, dst, ranges, 0.01);
+
+    SANITY_CHECK(dst);
+}
+
+typedef std::tr1::tuple<int, bool> WinSize_Sliding_t;
+typedef perf::TestBaseWithParam<WinSize_Sliding_t> WinSize_Sliding;
+
+// the histograms of all the windows along a row: the incremental update vs calcHist for each one
+PERF_TEST_P(WinSize_Sliding, slidingHistogram,
+            testing::Combine(
+                testing::Values(32, 64, 128),
+                testing::Bool()
+                )
+            )
+{
+    int winSize = get<0>(GetParam());
+    bool sliding = get<1>(GetParam());
+
+    Mat src(szVGA, CV_8UC3);
+    declare.in(src, WARMUP_RNG);
+
+    vector<int> channels(1, 0), histSize(1, 30);
+    vector<float> ranges(2);
+    ranges[0] = 0; ranges[1] = 180;
+    Mat hist;
+
+    if( sliding )
+    {
+        SlidingHistogram sh(channels, histSize, ranges);
+        TEST_CYCLE()
+        {
+            sh.setImage(src, Rect(0, 200, winSize, winSize));
+            for( int x = 1; x + winSize <= src.cols; x++ )
+                sh.moveWindow(Rect(x, 200, winSize, winSize));
+        }
+        sh.getHist(hist);
+    }
+    else
+    {
+        TEST_CYCLE()
+        {
+            for( int x = 0; x + winSize <= src.cols; x++ )
+                calcHist(vector<Mat>(1, src(Rect(x, 200, winSize, winSize))), channels, Mat(),
+                         hist, histSize, ranges);
+        }
+    }
+
+    SANITY_CHECK(hist);
+}
@@ -80,3 +80,38 @@ PERF_TEST_P( Size_MatType_OutMatDepth, integral_sqsum_tilted,
     SANITY_CHECK(sqsum, 1e-6);
     SANITY_CHECK(tilted, 1e-6, tilted.depth() > CV_32S ? ERROR_RELATIVE : ERROR_ABSOLUTE);
 }
+
+typedef std::tr1::tuple<Size, MatType, MatDepth, bool> Size_MatType_SqMatDepth_SumNeeded_t;
+typedef perf::TestBaseWithParam<Size_MatType_SqMatDepth_SumNeeded_t> Size_MatType_SqMatDepth_SumNeeded;
+
+PERF_TEST_P(Size_MatType_SqMatDepth_SumNeeded, integral_sqdepth,
+            testing::Combine(
+                testing::Values(szVGA, sz720p, sz1080p),
+                testing::Values(CV_8UC1, CV_32FC1),
+                testing::Values(CV_32F, CV_64F),
+                testing::Bool()
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int matType = get<1>(GetParam());
+    int sqdepth = get<2>(GetParam());
+    bool sumNeeded = get<3>(GetParam());
+    int sdepth = CV_MAT_DEPTH(matType) == CV_8U ? CV_32S : CV_32F;
+
+    Mat src(sz, matType);
+    Mat sum, sqsum;
+
+    declare.in(src, WARMUP_RNG);
+
+    if( sumNeeded )
+    {
+        TEST_CYCLE() integral(src, sum, sqsum, sdepth, sqdepth);
+    }
+    else
+    {
+        TEST_CYCLE() integral(src, noArray(), sqsum, sdepth, sqdepth);
+    }
+
+    SANITY_CHECK(sqsum, 1e-6, ERROR_RELATIVE);
+}
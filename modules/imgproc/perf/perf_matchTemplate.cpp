@@ -0,0 +1,80 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+CV_ENUM(MethodType, CV_TM_SQDIFF, CV_TM_SQDIFF_NORMED, CV_TM_CCORR, CV_TM_CCORR_NORMED, CV_TM_CCOEFF, CV_TM_CCOEFF_NORMED)
+
+typedef std::tr1::tuple<Size, Size, MethodType> ImgSize_TmplSize_Method_t;
+typedef perf::TestBaseWithParam<ImgSize_TmplSize_Method_t> ImgSize_TmplSize_Method;
+
+PERF_TEST_P(ImgSize_TmplSize_Method, matchTemplate,
+            testing::Combine(
+                testing::Values(szVGA, sz720p),
+                testing::Values(Size(16, 16), Size(64, 64)),
+                testing::ValuesIn(MethodType::all())
+                )
+            )
+{
+    Size imgSz = get<0>(GetParam());
+    Size tmplSz = get<1>(GetParam());
+    int method = get<2>(GetParam());
+
+    Mat img(imgSz, CV_8UC1);
+    Mat tmpl(tmplSz, CV_8UC1);
+    Mat result(imgSz - tmplSz + Size(1, 1), CV_32F);
+
+    declare.in(img, tmpl, WARMUP_RNG).out(result);
+
+    TEST_CYCLE() matchTemplate(img, tmpl, result, method);
+
+    SANITY_CHECK(result, 1e-4, ERROR_RELATIVE);
+}
+
+typedef std::tr1::tuple<int, bool> TmplCount_Prepared_t;
+typedef perf::TestBaseWithParam<TmplCount_Prepared_t> TmplCount_Prepared;
+
+// the same set of templates on every frame: the plain calls vs the prepared templates
+PERF_TEST_P(TmplCount_Prepared, matchTemplate_multiple,
+            testing::Combine(
+                testing::Values(1, 4, 16, 64),
+                testing::Bool()
+                )
+            )
+{
+    int ntempl = get<0>(GetParam());
+    bool prepared = get<1>(GetParam());
+    const int method = CV_TM_CCOEFF_NORMED;
+
+    Mat img(szVGA, CV_8UC1);
+    declare.in(img, WARMUP_RNG);
+
+    vector<Mat> templs(ntempl), results(ntempl);
+    RNG rng(0x1234);
+    for( int k = 0; k < ntempl; k++ )
+    {
+        Size tmplSz(rng.uniform(24, 49), rng.uniform(24, 49));
+        templs[k].create(tmplSz, CV_8UC1);
+        rng.fill(templs[k], RNG::UNIFORM, 0, 256);
+    }
+
+    TemplateMatcher matcher(templs, method);
+
+    if( prepared )
+    {
+        TEST_CYCLE() matcher.match(img, results);
+    }
+    else
+    {
+        TEST_CYCLE()
+        {
+            for( int k = 0; k < ntempl; k++ )
+                matchTemplate(img, templs[k], results[k], method);
+        }
+    }
+
+    SANITY_CHECK(results[0], 1e-4, ERROR_ABSOLUTE);
+}
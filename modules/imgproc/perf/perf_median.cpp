@@ -0,0 +1,32 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+typedef std::tr1::tuple<Size, MatType, int> Size_MatType_Aperture_t;
+typedef perf::TestBaseWithParam<Size_MatType_Aperture_t> Size_MatType_Aperture;
+
+PERF_TEST_P(Size_MatType_Aperture, medianBlur_aperture,
+            testing::Combine(
+                testing::Values(szVGA, sz1080p),
+                testing::Values(CV_8UC1, CV_8UC4, CV_16UC1, CV_32FC1),
+                testing::Values(3, 5, 7, 9, 15, 25, 35, 51)
+                )
+            )
+{
+    Size size = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    int ksize = get<2>(GetParam());
+
+    Mat src(size, type);
+    Mat dst(size, type);
+
+    declare.in(src, WARMUP_RNG).out(dst).time(30);
+
+    TEST_CYCLE() medianBlur(src, dst, ksize);
+
+    SANITY_CHECK(dst);
+}
@@ -38,3 +38,82 @@ PERF_TEST_P(Size_MatType, dilate, TYPICAL_MATS_MORPH)
 
     SANITY_CHECK(dst);
 }
+
+typedef std::tr1::tuple<MatType, int> MatType_KSize_t;
+typedef perf::TestBaseWithParam<MatType_KSize_t> MatType_KSize;
+
+PERF_TEST_P(MatType_KSize, erode_ksize,
+            testing::Combine(
+                testing::Values(CV_8UC1, CV_8UC4, CV_16UC1, CV_32FC1),
+                testing::Values(3, 7, 15, 31, 61, 101)
+                )
+            )
+{
+    Size sz = sz1080p;
+    int type = get<0>(GetParam());
+    int ksize = get<1>(GetParam());
+    Mat kernel = getStructuringElement(MORPH_RECT, Size(ksize, ksize));
+
+    Mat src(sz, type);
+    Mat dst(sz, type);
+
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    TEST_CYCLE() erode(src, dst, kernel);
+
+    SANITY_CHECK(dst);
+}
+
+PERF_TEST_P(MatType_KSize, dilate_line_ksize,
+            testing::Combine(
+                testing::Values(CV_8UC1, CV_32FC1),
+                testing::Values(15, 31, 61, 101, 201)
+                )
+            )
+{
+    Size sz = sz1080p;
+    int type = get<0>(GetParam());
+    int ksize = get<1>(GetParam());
+    Mat hline = getStructuringElement(MORPH_RECT, Size(ksize, 1));
+    Mat vline = getStructuringElement(MORPH_RECT, Size(1, ksize));
+
+    Mat src(sz, type);
+    Mat dst(sz, type);
+
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    TEST_CYCLE()
+    {
+        dilate(src, dst, hline);
+        dilate(dst, dst, vline);
+    }
+
+    SANITY_CHECK(dst);
+}
+
+CV_ENUM(MorphOp, MORPH_OPEN, MORPH_CLOSE, MORPH_GRADIENT, MORPH_TOPHAT, MORPH_BLACKHAT)
+
+typedef std::tr1::tuple<MorphOp, int> MorphOp_KSize_t;
+typedef perf::TestBaseWithParam<MorphOp_KSize_t> MorphOp_KSize;
+
+PERF_TEST_P(MorphOp_KSize, morphologyEx_ksize,
+            testing::Combine(
+                testing::ValuesIn(MorphOp::all()),
+                testing::Values(3, 15, 31, 61)
+                )
+            )
+{
+    Size sz = sz1080p;
+    int op = get<0>(GetParam());
+    int ksize = get<1>(GetParam());
+    Mat kernel = getStructuringElement(MORPH_RECT, Size(ksize, ksize));
+
+    Mat src(sz, CV_8UC1);
+    Mat dst(sz, CV_8UC1);
+
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    TEST_CYCLE() morphologyEx(src, dst, op, kernel);
+
+    SANITY_CHECK(dst);
+}
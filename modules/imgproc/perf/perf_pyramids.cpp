@@ -43,3 +43,43 @@ PERF_TEST_P(Size_MatType, pyrUp, testing::Combine(
 
     SANITY_CHECK(dst);
 }
+
+PERF_TEST_P(Size_MatType, buildPyramid, testing::Combine(
+                testing::Values(sz1080p, sz720p, szVGA),
+                testing::Values(CV_8UC1, CV_8UC3, CV_32FC1)
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int matType = get<1>(GetParam());
+
+    Mat src(sz, matType);
+    vector<Mat> pyr;
+
+    declare.in(src, WARMUP_RNG);
+
+    TEST_CYCLE() buildPyramid(src, pyr, 4);
+
+    Mat last = pyr.back();
+    SANITY_CHECK(last);
+}
+
+PERF_TEST_P(Size_MatType, gaussianPyramid, testing::Combine(
+                testing::Values(sz1080p, sz720p, szVGA),
+                testing::Values(CV_8UC1, CV_8UC3, CV_32FC1)
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int matType = get<1>(GetParam());
+
+    Mat src(sz, matType);
+    GaussianPyramid pyr;
+
+    declare.in(src, WARMUP_RNG);
+
+    TEST_CYCLE() pyr.build(src, 4);
+
+    Mat last = pyr[4];
+    SANITY_CHECK(last);
+}
@@ -0,0 +1,179 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+enum { MASK_SPARSE, MASK_DENSE };
+enum { MASK_THRESHOLD, MASK_ERODE, MASK_DILATE, MASK_AND, MASK_MOMENTS, MASK_CONTOURS };
+
+CV_ENUM(MaskDensity, MASK_SPARSE, MASK_DENSE)
+CV_ENUM(MaskOp, MASK_THRESHOLD, MASK_ERODE, MASK_DILATE, MASK_AND, MASK_MOMENTS, MASK_CONTOURS)
+
+typedef std::tr1::tuple<MaskDensity, MaskOp> MaskDensity_MaskOp_t;
+typedef perf::TestBaseWithParam<MaskDensity_MaskOp_t> MaskDensity_MaskOp;
+
+// sparse: a few dozens of blobs covering ~5% of the image; dense: half of the image in small blobs
+static void makeMaskSource(Mat& img, Size sz, int density, uint64 seed)
+{
+    RNG rng(seed);
+    if( density == MASK_SPARSE )
+    {
+        img = Mat::zeros(sz, CV_8UC1);
+        for( int i = 0; i < 40; i++ )
+        {
+            Point c(rng.uniform(0, sz.width), rng.uniform(0, sz.height));
+            Size axes(rng.uniform(10, 60), rng.uniform(10, 60));
+            ellipse(img, c, axes, rng.uniform(0, 180), 0, 360, Scalar::all(rng.uniform(129, 256)), -1);
+        }
+    }
+    else
+    {
+        Mat noise(sz, CV_8UC1);
+        rng.fill(noise, RNG::UNIFORM, 0, 256);
+        GaussianBlur(noise, img, Size(7, 7), 0);
+    }
+}
+
+// returns the number of contours or the area for the operations without the image output
+static double runMaskOp(const Mat& src, const Mat& mask, const Mat& mask2, Mat& dst, int op)
+{
+    vector<vector<Point> > contours;
+
+    switch( op )
+    {
+    case MASK_THRESHOLD:
+        threshold(src, dst, 128, 255, THRESH_BINARY);
+        break;
+    case MASK_ERODE:
+        erode(mask, dst, Mat());
+        break;
+    case MASK_DILATE:
+        dilate(mask, dst, Mat());
+        break;
+    case MASK_AND:
+        bitwise_and(mask, mask2, dst);
+        break;
+    case MASK_MOMENTS:
+        return moments(mask, true).m00;
+    case MASK_CONTOURS:
+        mask.copyTo(dst);
+        findContours(dst, contours, RETR_LIST, CHAIN_APPROX_SIMPLE);
+        return (double)contours.size();
+    }
+    return 0;
+}
+
+static double runMaskOp(const Mat& src, const RLEImage& mask, const RLEImage& mask2, RLEImage& dst, int op)
+{
+    vector<vector<Point> > contours;
+
+    switch( op )
+    {
+    case MASK_THRESHOLD:
+        threshold(src, dst, 128, THRESH_BINARY);
+        break;
+    case MASK_ERODE:
+        erode(mask, dst, Size(3, 3));
+        break;
+    case MASK_DILATE:
+        dilate(mask, dst, Size(3, 3));
+        break;
+    case MASK_AND:
+        bitwise_and(mask, mask2, dst);
+        break;
+    case MASK_MOMENTS:
+        return moments(mask).m00;
+    case MASK_CONTOURS:
+        findContours(mask, contours, RETR_LIST, CHAIN_APPROX_SIMPLE);
+        return (double)contours.size();
+    }
+    return 0;
+}
+
+PERF_TEST_P(MaskDensity_MaskOp, mask_dense, testing::Combine(testing::ValuesIn(MaskDensity::all()), testing::ValuesIn(MaskOp::all())))
+{
+    int density = get<0>(GetParam()), op = get<1>(GetParam());
+
+    Mat src, src2, mask, mask2, dst;
+    double result = 0;
+    makeMaskSource(src, sz1080p, density, 0x1234);
+    makeMaskSource(src2, sz1080p, density, 0x4321);
+    threshold(src, mask, 128, 255, THRESH_BINARY);
+    threshold(src2, mask2, 128, 255, THRESH_BINARY);
+    dst.create(sz1080p, CV_8UC1);
+
+    declare.in(src, mask);
+
+    TEST_CYCLE() result = runMaskOp(src, mask, mask2, dst, op);
+
+    int area = countNonZero(mask);
+    SANITY_CHECK(area);
+    SANITY_CHECK(result);
+}
+
+PERF_TEST_P(MaskDensity_MaskOp, mask_rle, testing::Combine(testing::ValuesIn(MaskDensity::all()), testing::ValuesIn(MaskOp::all())))
+{
+    int density = get<0>(GetParam()), op = get<1>(GetParam());
+
+    Mat src, src2;
+    makeMaskSource(src, sz1080p, density, 0x1234);
+    makeMaskSource(src2, sz1080p, density, 0x4321);
+    RLEImage mask, mask2, dst;
+    double result = 0;
+    threshold(src, mask, 128, THRESH_BINARY);
+    threshold(src2, mask2, 128, THRESH_BINARY);
+
+    declare.in(src);
+
+    TEST_CYCLE() result = runMaskOp(src, mask, mask2, dst, op);
+
+    int area = mask.area();
+    SANITY_CHECK(area);
+    SANITY_CHECK(result);
+}
+
+typedef perf::TestBaseWithParam<MaskDensity> MaskDensityOnly;
+
+PERF_TEST_P(MaskDensityOnly, findContours_vectors, testing::ValuesIn(MaskDensity::all()))
+{
+    int density = GetParam();
+
+    Mat src, mask, tmp;
+    makeMaskSource(src, sz1080p, density, 0x1234);
+    threshold(src, mask, 128, 255, THRESH_BINARY);
+    tmp.create(sz1080p, CV_8UC1);
+    vector<vector<Point> > contours;
+    vector<Vec4i> hierarchy;
+
+    declare.in(mask);
+
+    TEST_CYCLE()
+    {
+        mask.copyTo(tmp);
+        findContours(tmp, contours, hierarchy, RETR_CCOMP, CHAIN_APPROX_SIMPLE);
+    }
+
+    int ncontours = (int)contours.size();
+    SANITY_CHECK(ncontours);
+}
+
+PERF_TEST_P(MaskDensityOnly, findContours_flat, testing::ValuesIn(MaskDensity::all()))
+{
+    int density = GetParam();
+
+    Mat src, mask;
+    makeMaskSource(src, sz1080p, density, 0x1234);
+    threshold(src, mask, 128, 255, THRESH_BINARY);
+    FlatContours contours;
+
+    declare.in(mask);
+
+    // the buffers of the object are reused by all the iterations
+    TEST_CYCLE() findContours(mask, contours, RETR_CCOMP, CHAIN_APPROX_SIMPLE);
+
+    int ncontours = contours.size();
+    SANITY_CHECK(ncontours);
+}
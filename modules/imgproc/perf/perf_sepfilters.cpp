@@ -242,3 +242,24 @@ PERF_TEST_P(Size_MatType_dx_dy_Border3x3ROI, scharrViaSobelFilter,
 
     SANITY_CHECK(dst);
 }
+
+PERF_TEST_P(Size_MatType, sepFilter2D,
+            testing::Combine(
+                testing::Values(sz720p, sz1080p),
+                testing::Values(CV_8UC1, CV_8UC4, CV_32FC1)
+            )
+          )
+{
+    Size size = get<0>(GetParam());
+    int type = get<1>(GetParam());
+
+    Mat src(size, type);
+    Mat dst(size, type);
+    Mat kernelX = getGaussianKernel(9, 2., CV_32F), kernelY = getGaussianKernel(7, 1.5, CV_32F);
+
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    TEST_CYCLE() sepFilter2D(src, dst, -1, kernelX, kernelY);
+
+    SANITY_CHECK(dst, 1);
+}
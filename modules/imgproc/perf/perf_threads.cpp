@@ -0,0 +1,75 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+// Thread scaling of the parallel_for_-based kernels: the same call is timed
+// with 1, 2, 4 and 8 threads; the output must not depend on the thread count.
+
+typedef std::tr1::tuple<Size, int> Size_NumThreads_t;
+typedef perf::TestBaseWithParam<Size_NumThreads_t> Size_NumThreads;
+
+#define THREADS_SWEEP testing::Values(1, 2, 4, 8)
+
+PERF_TEST_P(Size_NumThreads, threads_resize,
+            testing::Combine(
+                testing::Values(sz720p, sz1080p),
+                THREADS_SWEEP
+                )
+            )
+{
+    Size size = get<0>(GetParam());
+    int nthreads = get<1>(GetParam());
+
+    Mat src(size, CV_8UC3);
+    Mat dst(size.height*2/3, size.width*2/3, CV_8UC3);
+
+    declare.in(src, WARMUP_RNG).out(dst).threads(nthreads);
+
+    TEST_CYCLE() resize(src, dst, dst.size(), 0, 0, INTER_LINEAR);
+
+    SANITY_CHECK(dst, 1);
+}
+
+PERF_TEST_P(Size_NumThreads, threads_GaussianBlur,
+            testing::Combine(
+                testing::Values(sz720p, sz1080p),
+                THREADS_SWEEP
+                )
+            )
+{
+    Size size = get<0>(GetParam());
+    int nthreads = get<1>(GetParam());
+
+    Mat src(size, CV_8UC3);
+    Mat dst(size, CV_8UC3);
+
+    declare.in(src, WARMUP_RNG).out(dst).threads(nthreads);
+
+    TEST_CYCLE() GaussianBlur(src, dst, Size(7, 7), 0);
+
+    SANITY_CHECK(dst, 1);
+}
+
+PERF_TEST_P(Size_NumThreads, threads_cvtColor,
+            testing::Combine(
+                testing::Values(sz720p, sz1080p),
+                THREADS_SWEEP
+                )
+            )
+{
+    Size size = get<0>(GetParam());
+    int nthreads = get<1>(GetParam());
+
+    Mat src(size, CV_8UC3);
+    Mat dst(size, CV_8UC3);
+
+    declare.in(src, WARMUP_RNG).out(dst).threads(nthreads);
+
+    TEST_CYCLE() cvtColor(src, dst, CV_BGR2HSV);
+
+    SANITY_CHECK(dst, 1);
+}
@@ -77,3 +77,37 @@ PERF_TEST_P( TestWarpPerspective, WarpPerspective,
 
 }
 
+typedef TestBaseWithParam< tr1::tuple<Size, InterType> > TestRemap;
+
+PERF_TEST_P( TestRemap, Remap,
+             Combine(
+                Values( sz720p, sz1080p ),
+                ValuesIn( InterType::all() )
+             )
+)
+{
+    Size sz;
+    int interType;
+    sz         = get<0>(GetParam());
+    interType  = get<1>(GetParam());
+
+    Mat src(sz, CV_8UC3), dst(sz, CV_8UC3);
+    Mat mapX(sz, CV_32FC1), mapY(sz, CV_32FC1);
+
+    // rectification-like radial map
+    Point2f c(sz.width/2.f, sz.height/2.f);
+    float k = 0.3f/(c.x*c.x + c.y*c.y);
+    for( int y = 0; y < sz.height; y++ )
+        for( int x = 0; x < sz.width; x++ )
+        {
+            float dx = x - c.x, dy = y - c.y, r = 1 + k*(dx*dx + dy*dy);
+            mapX.at<float>(y, x) = c.x + dx*r;
+            mapY.at<float>(y, x) = c.y + dy*r;
+        }
+
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    TEST_CYCLE() remap( src, dst, mapX, mapY, interType, BORDER_CONSTANT, Scalar::all(0) );
+
+    SANITY_CHECK(dst);
+}
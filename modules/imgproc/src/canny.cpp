@@ -41,238 +41,447 @@
 
 #include "precomp.hpp"
 
-void cv::Canny( InputArray _src, OutputArray _dst,
-                double low_thresh, double high_thresh,
-                int aperture_size, bool L2gradient )
+namespace cv
 {
-    Mat src = _src.getMat();
-    CV_Assert( src.depth() == CV_8U );
-    
-    _dst.create(src.size(), CV_8U);
-    Mat dst = _dst.getMat();
-
-    if (!L2gradient && (aperture_size & CV_CANNY_L2_GRADIENT) == CV_CANNY_L2_GRADIENT)
-    {
-        //backward compatibility
-        aperture_size &= ~CV_CANNY_L2_GRADIENT;
-        L2gradient = true;
-    }
-
-    if ((aperture_size & 1) == 0 || (aperture_size != -1 && (aperture_size < 3 || aperture_size > 7)))
-        CV_Error(CV_StsBadFlag, "");
-
-#ifdef HAVE_TEGRA_OPTIMIZATION
-    if (tegra::canny(src, dst, low_thresh, high_thresh, aperture_size, L2gradient))
-        return;
-#endif
 
-    const int cn = src.channels();
-    cv::Mat dx(src.rows, src.cols, CV_16SC(cn));
-    cv::Mat dy(src.rows, src.cols, CV_16SC(cn));
+enum { CANNY_PARALLEL_MIN = 1 << 16 };
 
-    cv::Sobel(src, dx, CV_16S, 1, 0, aperture_size, 1, 0, cv::BORDER_REPLICATE);
-    cv::Sobel(src, dy, CV_16S, 0, 1, aperture_size, 1, 0, cv::BORDER_REPLICATE);
+#define CANNY_SHIFT 15
 
-    if (low_thresh > high_thresh)
-        std::swap(low_thresh, high_thresh);
+/* sector numbers
+   (Top-Left Origin)
 
-    if (L2gradient)
-    {
-        low_thresh = std::min(32767.0, low_thresh);
-        high_thresh = std::min(32767.0, high_thresh);
-		
-        if (low_thresh > 0) low_thresh *= low_thresh;
-        if (high_thresh > 0) high_thresh *= high_thresh;
-    }
-    int low = cvFloor(low_thresh);
-    int high = cvFloor(high_thresh);
+    1   2   3
+     *  *  *
+      * * *
+    0*******0
+      * * *
+     *  *  *
+    3   2   1
+*/
 
-    ptrdiff_t mapstep = src.cols + 2;
-    cv::AutoBuffer<uchar> buffer((src.cols+2)*(src.rows+2) + cn * mapstep * 3 * sizeof(int));
-    
-    int* mag_buf[3];
-    mag_buf[0] = (int*)(uchar*)buffer;
-    mag_buf[1] = mag_buf[0] + mapstep*cn;
-    mag_buf[2] = mag_buf[1] + mapstep*cn;
-    memset(mag_buf[0], 0, /* cn* */mapstep*sizeof(int));
+// computes the gradient magnitude of one row; for multi-channel images it also
+// picks the channel with the largest magnitude and stores its derivatives in _dxsel/_dysel
+static void cannyMagnitudeRow(const short* _dx, const short* _dy, int* _norm, short* _dxsel, short* _dysel,
+                              int cols, int cn, bool L2gradient)
+{
+    int j = 0, len = cols*cn;
 
-    uchar* map = (uchar*)(mag_buf[2] + mapstep*cn);
-    memset(map, 1, mapstep);
-    memset(map + mapstep*(src.rows + 1), 1, mapstep);
-
-    int maxsize = std::max(1 << 10, src.cols * src.rows / 10);
-    std::vector<uchar*> stack(maxsize);
-    uchar **stack_top = &stack[0];
-    uchar **stack_bottom = &stack[0];
-
-    /* sector numbers
-       (Top-Left Origin)
-
-        1   2   3
-         *  *  *
-          * * *
-        0*******0
-          * * *
-         *  *  *
-        3   2   1
-    */
-
-    #define CANNY_PUSH(d)    *(d) = uchar(2), *stack_top++ = (d)
-    #define CANNY_POP(d)     (d) = *--stack_top
-
-    // calculate magnitude and angle of gradient, perform non-maxima supression.
-    // fill the map with one of the following values:
-    //   0 - the pixel might belong to an edge
-    //   1 - the pixel can not belong to an edge
-    //   2 - the pixel does belong to an edge
-    for (int i = 0; i <= src.rows; i++)
+    if (!L2gradient)
     {
-        int* _norm = mag_buf[(i > 0) + 1] + 1;
-        if (i < src.rows)
+#if CV_SSE2
+        if (checkHardwareSupport(CV_CPU_SSE2))
         {
-            short* _dx = dx.ptr<short>(i);
-            short* _dy = dy.ptr<short>(i);
-
-            if (!L2gradient)
-            {
-                for (int j = 0; j < src.cols*cn; j++)
-                    _norm[j] = std::abs(int(_dx[j])) + std::abs(int(_dy[j]));
-            }
-            else
+            for (; j <= len - 8; j += 8)
             {
-                for (int j = 0; j < src.cols*cn; j++)
-                    _norm[j] = int(_dx[j])*_dx[j] + int(_dy[j])*_dy[j];
+                __m128i v_dx = _mm_loadu_si128((const __m128i*)(_dx + j));
+                __m128i v_dy = _mm_loadu_si128((const __m128i*)(_dy + j));
+                // sign-extend to 32 bits, then |x| = (x ^ s) - s
+                __m128i dx0 = _mm_srai_epi32(_mm_unpacklo_epi16(v_dx, v_dx), 16);
+                __m128i dx1 = _mm_srai_epi32(_mm_unpackhi_epi16(v_dx, v_dx), 16);
+                __m128i dy0 = _mm_srai_epi32(_mm_unpacklo_epi16(v_dy, v_dy), 16);
+                __m128i dy1 = _mm_srai_epi32(_mm_unpackhi_epi16(v_dy, v_dy), 16);
+                __m128i s;
+                s = _mm_srai_epi32(dx0, 31); dx0 = _mm_sub_epi32(_mm_xor_si128(dx0, s), s);
+                s = _mm_srai_epi32(dx1, 31); dx1 = _mm_sub_epi32(_mm_xor_si128(dx1, s), s);
+                s = _mm_srai_epi32(dy0, 31); dy0 = _mm_sub_epi32(_mm_xor_si128(dy0, s), s);
+                s = _mm_srai_epi32(dy1, 31); dy1 = _mm_sub_epi32(_mm_xor_si128(dy1, s), s);
+                _mm_storeu_si128((__m128i*)(_norm + j), _mm_add_epi32(dx0, dy0));
+                _mm_storeu_si128((__m128i*)(_norm + j + 4), _mm_add_epi32(dx1, dy1));
             }
-			
-            if (cn > 1)
+        }
+#endif
+        for (; j < len; j++)
+            _norm[j] = std::abs(int(_dx[j])) + std::abs(int(_dy[j]));
+    }
+    else
+    {
+#if CV_SSE2
+        if (checkHardwareSupport(CV_CPU_SSE2))
+        {
+            for (; j <= len - 8; j += 8)
             {
-                for(int j = 0, jn = 0; j < src.cols; ++j, jn += cn)
-                {
-                    int maxIdx = jn;
-                    for(int k = 1; k < cn; ++k)
-                        if(_norm[jn + k] > _norm[maxIdx]) maxIdx = jn + k;
-                    _norm[j] = _norm[maxIdx];
-                    _dx[j] = _dx[maxIdx];
-                    _dy[j] = _dy[maxIdx];
-                }
+                __m128i v_dx = _mm_loadu_si128((const __m128i*)(_dx + j));
+                __m128i v_dy = _mm_loadu_si128((const __m128i*)(_dy + j));
+                __m128i v0 = _mm_unpacklo_epi16(v_dx, v_dy), v1 = _mm_unpackhi_epi16(v_dx, v_dy);
+                _mm_storeu_si128((__m128i*)(_norm + j), _mm_madd_epi16(v0, v0));
+                _mm_storeu_si128((__m128i*)(_norm + j + 4), _mm_madd_epi16(v1, v1));
             }
-            _norm[-1] = _norm[src.cols] = 0;
         }
-        else
-            memset(_norm-1, 0, /* cn* */mapstep*sizeof(int));
-		
-        // at the very beginning we do not have a complete ring
-        // buffer of 3 magnitude rows for non-maxima suppression
-        if (i == 0)
-            continue;
+#endif
+        for (; j < len; j++)
+            _norm[j] = int(_dx[j])*_dx[j] + int(_dy[j])*_dy[j];
+    }
 
-        uchar* _map = map + mapstep*i + 1;
-        _map[-1] = _map[src.cols] = 1;
+    if (cn > 1)
+    {
+        for(j = 0; j < cols; ++j)
+        {
+            int jn = j*cn, maxIdx = jn;
+            for(int k = 1; k < cn; ++k)
+                if(_norm[jn + k] > _norm[maxIdx]) maxIdx = jn + k;
+            _norm[j] = _norm[maxIdx];
+            _dxsel[j] = _dx[maxIdx];
+            _dysel[j] = _dy[maxIdx];
+        }
+    }
+    _norm[-1] = _norm[cols] = 0;
+}
 
-        int* _mag = mag_buf[1] + 1; // take the central row
-        ptrdiff_t magstep1 = mag_buf[2] - mag_buf[1];
-        ptrdiff_t magstep2 = mag_buf[0] - mag_buf[1];
+/*
+   Gradient magnitude, non-maxima suppression and hysteresis for a horizontal stripe of the image.
+
+   The map has one row of 1's above and below the image and one column of 1's on each side:
+     0 - the pixel might belong to an edge
+     1 - the pixel can not belong to an edge
+     2 - the pixel does belong to an edge
+   A stripe writes only its own rows of the map. The magnitude of the rows just above and below
+   the stripe is recomputed locally, and the hysteresis stops at the stripe boundary, recording
+   the pixels across it, which are handled by the serial fix-up pass afterwards.
+*/
+class CannyInvoker : public ParallelLoopBody
+{
+public:
+    CannyInvoker(const Mat& _dx, const Mat& _dy, uchar* _map, ptrdiff_t _mapstep,
+                 int _low, int _high, bool _L2gradient, std::vector<uchar*>& _borderPixels, Mutex& _borderMutex) :
+        dx(&_dx), dy(&_dy), map(_map), mapstep(_mapstep), low(_low), high(_high), L2gradient(_L2gradient),
+        borderPixels(&_borderPixels), borderMutex(&_borderMutex)
+    {
+    }
+
+    void operator()(const Range& range) const
+    {
+        const int rows = dx->rows, cols = dx->cols, cn = dx->channels();
+        const int TG22 = (int)(0.4142135623730950488016887242097*(1<<CANNY_SHIFT) + 0.5);
+
+        AutoBuffer<int> _magbuf(mapstep*cn*3);
+        AutoBuffer<short> _dxybuf(cn > 1 ? cols*6 : 1);
+        int* mag_buf[3];
+        short* dx_buf[3];
+        short* dy_buf[3];
+        for (int k = 0; k < 3; k++)
+        {
+            mag_buf[k] = (int*)_magbuf + mapstep*cn*k;
+            dx_buf[k] = (short*)_dxybuf + cols*k*2;
+            dy_buf[k] = dx_buf[k] + cols;
+        }
 
-        const short* _x = dx.ptr<short>(i-1);
-        const short* _y = dy.ptr<short>(i-1);
+#if CV_SSE2
+        bool useSIMD = checkHardwareSupport(CV_CPU_SSE2);
+#endif
 
-        if ((stack_top - stack_bottom) + src.cols > maxsize)
+        // the magnitude of the row above the stripe
+        if (range.start > 0)
         {
-            int sz = (int)(stack_top - stack_bottom);
-            maxsize = maxsize * 3/2;
-            stack.resize(maxsize);
-            stack_bottom = &stack[0];
-            stack_top = stack_bottom + sz;
+            int r = range.start - 1;
+            cannyMagnitudeRow(dx->ptr<short>(r), dy->ptr<short>(r), mag_buf[0] + 1, dx_buf[0], dy_buf[0], cols, cn, L2gradient);
         }
+        else
+            memset(mag_buf[0], 0, mapstep*sizeof(int));
+
+        int maxsize = std::max(1 << 10, (range.end - range.start) * cols / 10);
+        std::vector<uchar*> stack(maxsize);
+        uchar **stack_top = &stack[0];
+        uchar **stack_bottom = &stack[0];
+        std::vector<uchar*> border;
+
+        #define CANNY_PUSH(d)    *(d) = uchar(2), *stack_top++ = (d)
+        #define CANNY_POP(d)     (d) = *--stack_top
 
-        int prev_flag = 0;
-        for (int j = 0; j < src.cols; j++)
+        // calculate magnitude and angle of gradient, perform non-maxima supression.
+        for (int i = range.start; i <= range.end; i++)
         {
-            #define CANNY_SHIFT 15
-            const int TG22 = (int)(0.4142135623730950488016887242097*(1<<CANNY_SHIFT) + 0.5);
+            int b = (i > range.start) + 1;
+            int* _norm = mag_buf[b] + 1;
+            if (i < rows)
+                cannyMagnitudeRow(dx->ptr<short>(i), dy->ptr<short>(i), _norm, dx_buf[b], dy_buf[b], cols, cn, L2gradient);
+            else
+                memset(_norm-1, 0, mapstep*sizeof(int));
 
-            int m = _mag[j];
+            // at the very beginning we do not have a complete ring
+            // buffer of 3 magnitude rows for non-maxima suppression
+            if (i == range.start)
+                continue;
 
-            if (m > low)
-            {
-                int xs = _x[j];
-                int ys = _y[j];
-                int x = std::abs(xs);
-                int y = std::abs(ys) << CANNY_SHIFT;
+            int r = i - 1;
+            uchar* _map = map + mapstep*(r + 1) + 1;
+            _map[-1] = _map[cols] = 1;
+
+            int* _mag = mag_buf[1] + 1; // take the central row
+            ptrdiff_t magstep1 = mag_buf[2] - mag_buf[1];
+            ptrdiff_t magstep2 = mag_buf[0] - mag_buf[1];
 
-                int tg22x = x * TG22;
+            const short* _x = cn > 1 ? dx_buf[1] : dx->ptr<short>(r);
+            const short* _y = cn > 1 ? dy_buf[1] : dy->ptr<short>(r);
 
-                if (y < tg22x)
+            if ((stack_top - stack_bottom) + cols > maxsize)
+            {
+                int sz = (int)(stack_top - stack_bottom);
+                maxsize = maxsize * 3/2;
+                stack.resize(maxsize);
+                stack_bottom = &stack[0];
+                stack_top = stack_bottom + sz;
+            }
+
+            // the row above belongs to another stripe, so it can not be checked
+            bool checkAbove = r > range.start;
+            int prev_flag = 0;
+            for (int j = 0; j < cols; j++)
+            {
+#if CV_SSE2
+                // skip the runs of pixels below the low threshold, the most common case
+                if (useSIMD && j <= cols - 8)
                 {
-                    if (m > _mag[j-1] && m >= _mag[j+1]) goto __ocv_canny_push;
+                    __m128i v_low = _mm_set1_epi32(low);
+                    __m128i v_m0 = _mm_cmpgt_epi32(_mm_loadu_si128((const __m128i*)(_mag + j)), v_low);
+                    __m128i v_m1 = _mm_cmpgt_epi32(_mm_loadu_si128((const __m128i*)(_mag + j + 4)), v_low);
+                    if (_mm_movemask_epi8(_mm_or_si128(v_m0, v_m1)) == 0)
+                    {
+                        memset(_map + j, 1, 8);
+                        prev_flag = 0;
+                        j += 7;
+                        continue;
+                    }
                 }
-                else
+#endif
+                int m = _mag[j];
+
+                if (m > low)
                 {
-                    int tg67x = tg22x + (x << (CANNY_SHIFT+1));
-                    if (y > tg67x)
+                    int xs = _x[j];
+                    int ys = _y[j];
+                    int x = std::abs(xs);
+                    int y = std::abs(ys) << CANNY_SHIFT;
+
+                    int tg22x = x * TG22;
+
+                    if (y < tg22x)
                     {
-                        if (m > _mag[j+magstep2] && m >= _mag[j+magstep1]) goto __ocv_canny_push;
+                        if (m > _mag[j-1] && m >= _mag[j+1]) goto __ocv_canny_push;
                     }
                     else
                     {
-                        int s = (xs ^ ys) < 0 ? -1 : 1;
-                        if (m > _mag[j+magstep2-s] && m > _mag[j+magstep1+s]) goto __ocv_canny_push;
+                        int tg67x = tg22x + (x << (CANNY_SHIFT+1));
+                        if (y > tg67x)
+                        {
+                            if (m > _mag[j+magstep2] && m >= _mag[j+magstep1]) goto __ocv_canny_push;
+                        }
+                        else
+                        {
+                            int s = (xs ^ ys) < 0 ? -1 : 1;
+                            if (m > _mag[j+magstep2-s] && m > _mag[j+magstep1+s]) goto __ocv_canny_push;
+                        }
                     }
                 }
-            }
-            prev_flag = 0;
-            _map[j] = uchar(1);
-            continue;
+                prev_flag = 0;
+                _map[j] = uchar(1);
+                continue;
 __ocv_canny_push:
-            if (!prev_flag && m > high && _map[j-mapstep] != 2)
+                if (!prev_flag && m > high && !(checkAbove && _map[j-mapstep] == 2))
+                {
+                    CANNY_PUSH(_map + j);
+                    prev_flag = 1;
+                }
+                else
+                    _map[j] = 0;
+            }
+
+            // scroll the ring buffers
+            int* _m = mag_buf[0]; mag_buf[0] = mag_buf[1]; mag_buf[1] = mag_buf[2]; mag_buf[2] = _m;
+            short* _s = dx_buf[0]; dx_buf[0] = dx_buf[1]; dx_buf[1] = dx_buf[2]; dx_buf[2] = _s;
+            _s = dy_buf[0]; dy_buf[0] = dy_buf[1]; dy_buf[1] = dy_buf[2]; dy_buf[2] = _s;
+        }
+
+        // now track the edges (hysteresis thresholding) within the stripe
+        const uchar* lo = map + mapstep*(range.start + 1);
+        const uchar* hi = map + mapstep*(range.end + 1);
+        const ptrdiff_t ofs[] = { -1, 1, -mapstep-1, -mapstep, -mapstep+1, mapstep-1, mapstep, mapstep+1 };
+
+        while (stack_top > stack_bottom)
+        {
+            uchar* m;
+            if ((stack_top - stack_bottom) + 8 > maxsize)
             {
-                CANNY_PUSH(_map + j);
-                prev_flag = 1;
+                int sz = (int)(stack_top - stack_bottom);
+                maxsize = maxsize * 3/2;
+                stack.resize(maxsize);
+                stack_bottom = &stack[0];
+                stack_top = stack_bottom + sz;
             }
-            else
-                _map[j] = 0;
+
+            CANNY_POP(m);
+
+            for (int k = 0; k < 8; k++)
+            {
+                uchar* n = m + ofs[k];
+                if (n < lo || n >= hi)
+                    border.push_back(n);
+                else if (!*n)
+                    CANNY_PUSH(n);
+            }
+        }
+
+        #undef CANNY_PUSH
+        #undef CANNY_POP
+
+        if (!border.empty())
+        {
+            AutoLock lock(*borderMutex);
+            borderPixels->insert(borderPixels->end(), border.begin(), border.end());
         }
+    }
 
-        // scroll the ring buffer
-        _mag = mag_buf[0];
-        mag_buf[0] = mag_buf[1];
-        mag_buf[1] = mag_buf[2];
-        mag_buf[2] = _mag;
+private:
+    const Mat* dx;
+    const Mat* dy;
+    uchar* map;
+    ptrdiff_t mapstep;
+    int low, high;
+    bool L2gradient;
+    std::vector<uchar*>* borderPixels;
+    Mutex* borderMutex;
+};
+
+class CannyFinalInvoker : public ParallelLoopBody
+{
+public:
+    CannyFinalInvoker(const uchar* _map, ptrdiff_t _mapstep, Mat& _dst) :
+        map(_map), mapstep(_mapstep), dst(&_dst)
+    {
     }
 
-    // now track the edges (hysteresis thresholding)
-    while (stack_top > stack_bottom)
+    void operator()(const Range& range) const
     {
-        uchar* m;
-        if ((stack_top - stack_bottom) + 8 > maxsize)
+        for (int i = range.start; i < range.end; i++)
         {
-            int sz = (int)(stack_top - stack_bottom);
-            maxsize = maxsize * 3/2;
-            stack.resize(maxsize);
-            stack_bottom = &stack[0];
-            stack_top = stack_bottom + sz;
+            const uchar* pmap = map + mapstep*(i + 1) + 1;
+            uchar* pdst = dst->ptr(i);
+            for (int j = 0; j < dst->cols; j++)
+                pdst[j] = (uchar)-(pmap[j] >> 1);
         }
+    }
+
+private:
+    const uchar* map;
+    ptrdiff_t mapstep;
+    Mat* dst;
+};
 
-        CANNY_POP(m);
+static void canny_(const Mat& dx, const Mat& dy, Mat& dst, double low_thresh, double high_thresh, bool L2gradient)
+{
+    if (low_thresh > high_thresh)
+        std::swap(low_thresh, high_thresh);
+
+    if (L2gradient)
+    {
+        low_thresh = std::min(32767.0, low_thresh);
+        high_thresh = std::min(32767.0, high_thresh);
 
-        if (!m[-1])         CANNY_PUSH(m - 1);
-        if (!m[1])          CANNY_PUSH(m + 1);
-        if (!m[-mapstep-1]) CANNY_PUSH(m - mapstep - 1);
-        if (!m[-mapstep])   CANNY_PUSH(m - mapstep);
-        if (!m[-mapstep+1]) CANNY_PUSH(m - mapstep + 1);
-        if (!m[mapstep-1])  CANNY_PUSH(m + mapstep - 1);
-        if (!m[mapstep])    CANNY_PUSH(m + mapstep);
-        if (!m[mapstep+1])  CANNY_PUSH(m + mapstep + 1);
+        if (low_thresh > 0) low_thresh *= low_thresh;
+        if (high_thresh > 0) high_thresh *= high_thresh;
+    }
+    int low = cvFloor(low_thresh);
+    int high = cvFloor(high_thresh);
+
+    int rows = dx.rows, cols = dx.cols;
+    ptrdiff_t mapstep = cols + 2;
+    AutoBuffer<uchar> buffer(mapstep*(rows+2));
+    uchar* map = buffer;
+    memset(map, 1, mapstep);
+    memset(map + mapstep*(rows + 1), 1, mapstep);
+
+    std::vector<uchar*> borderPixels;
+    Mutex borderMutex;
+    int nstripes = (int)std::min((size_t)rows/8, dx.total()/CANNY_PARALLEL_MIN);
+    Range range(0, rows);
+
+    CannyInvoker body(dx, dy, map, mapstep, low, high, L2gradient, borderPixels, borderMutex);
+    if (nstripes > 1)
+        parallel_for_(range, body, nstripes);
+    else
+        body(range);
+
+    // continue the edges across the stripe boundaries
+    std::vector<uchar*> stack;
+    for (size_t k = 0; k < borderPixels.size(); k++)
+    {
+        uchar* m = borderPixels[k];
+        if (*m)
+            continue;
+        *m = 2;
+        stack.push_back(m);
+
+        while (!stack.empty())
+        {
+            m = stack.back();
+            stack.pop_back();
+
+            uchar* neighbors[] = { m - 1, m + 1, m - mapstep - 1, m - mapstep, m - mapstep + 1,
+                                   m + mapstep - 1, m + mapstep, m + mapstep + 1 };
+            for (int n = 0; n < 8; n++)
+                if (!*neighbors[n])
+                {
+                    *neighbors[n] = 2;
+                    stack.push_back(neighbors[n]);
+                }
+        }
     }
 
     // the final pass, form the final image
-    const uchar* pmap = map + mapstep + 1;
-    uchar* pdst = dst.ptr();
-    for (int i = 0; i < src.rows; i++, pmap += mapstep, pdst += dst.step)
+    CannyFinalInvoker finalPass(map, mapstep, dst);
+    if (nstripes > 1)
+        parallel_for_(range, finalPass, nstripes);
+    else
+        finalPass(range);
+}
+
+}
+
+void cv::Canny( InputArray _src, OutputArray _dst,
+                double low_thresh, double high_thresh,
+                int aperture_size, bool L2gradient )
+{
+    Mat src = _src.getMat();
+    CV_Assert( src.depth() == CV_8U );
+
+    _dst.create(src.size(), CV_8U);
+    Mat dst = _dst.getMat();
+
+    if (!L2gradient && (aperture_size & CV_CANNY_L2_GRADIENT) == CV_CANNY_L2_GRADIENT)
     {
-        for (int j = 0; j < src.cols; j++)
-            pdst[j] = (uchar)-(pmap[j] >> 1);
+        //backward compatibility
+        aperture_size &= ~CV_CANNY_L2_GRADIENT;
+        L2gradient = true;
     }
+
+    if ((aperture_size & 1) == 0 || (aperture_size != -1 && (aperture_size < 3 || aperture_size > 7)))
+        CV_Error(CV_StsBadFlag, "");
+
+#ifdef HAVE_TEGRA_OPTIMIZATION
+    if (tegra::canny(src, dst, low_thresh, high_thresh, aperture_size, L2gradient))
+        return;
+#endif
+
+    const int cn = src.channels();
+    Mat dx(src.rows, src.cols, CV_16SC(cn));
+    Mat dy(src.rows, src.cols, CV_16SC(cn));
+
+    Sobel(src, dx, CV_16S, 1, 0, aperture_size, 1, 0, BORDER_REPLICATE);
+    Sobel(src, dy, CV_16S, 0, 1, aperture_size, 1, 0, BORDER_REPLICATE);
+
+    canny_(dx, dy, dst, low_thresh, high_thresh, L2gradient);
+}
+
+void cv::Canny( InputArray _dx, InputArray _dy, OutputArray _dst,
+                double low_thresh, double high_thresh, bool L2gradient )
+{
+    Mat dx = _dx.getMat(), dy = _dy.getMat();
+    CV_Assert( dx.depth() == CV_16S && dx.type() == dy.type() && dx.size() == dy.size() );
+
+    _dst.create(dx.size(), CV_8U);
+    Mat dst = _dst.getMat();
+
+    canny_(dx, dy, dst, low_thresh, high_thresh, L2gradient);
 }
 
 void cvCanny( const CvArr* image, CvArr* edges, double threshold1,
@@ -0,0 +1,460 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "precomp.hpp"
+
+/*
+   Contrast Limited Adaptive Histogram Equalization.
+
+   The image is split into tilesX x tilesY tiles. For every tile the clipped
+   histogram and the corresponding equalization LUT are computed, then every pixel
+   is mapped through the 4 LUTs of the nearest tiles and the results are
+   bilinearly interpolated.
+*/
+
+namespace cv
+{
+
+enum { CLAHE_PARALLEL_MIN = 1 << 16 };
+
+template<typename T, int histSize> class CLAHE_CalcLut_Invoker : public ParallelLoopBody
+{
+public:
+    CLAHE_CalcLut_Invoker(const Mat& _src, Mat& _lut, Size _tileSize, int _tilesX, int _clipLimit, float _lutScale) :
+        src(&_src), lut(&_lut), tileSize(_tileSize), tilesX(_tilesX), clipLimit(_clipLimit), lutScale(_lutScale)
+    {
+    }
+
+    void operator()(const Range& range) const
+    {
+        AutoBuffer<int> _tileHist(histSize);
+        int* tileHist = _tileHist;
+
+        for( int k = range.start; k < range.end; k++ )
+        {
+            int ty = k / tilesX;
+            int tx = k % tilesX;
+            Mat tile = (*src)(Rect(tx * tileSize.width, ty * tileSize.height, tileSize.width, tileSize.height));
+            T* tileLut = lut->ptr<T>(k);
+            int i, j;
+
+            memset(tileHist, 0, histSize*sizeof(tileHist[0]));
+
+            for( i = 0; i < tileSize.height; i++ )
+            {
+                const T* ptr = tile.ptr<T>(i);
+                for( j = 0; j <= tileSize.width - 4; j += 4 )
+                {
+                    int t0 = ptr[j], t1 = ptr[j+1];
+                    tileHist[t0]++; tileHist[t1]++;
+                    t0 = ptr[j+2]; t1 = ptr[j+3];
+                    tileHist[t0]++; tileHist[t1]++;
+                }
+                for( ; j < tileSize.width; j++ )
+                    tileHist[ptr[j]]++;
+            }
+
+            if( clipLimit > 0 )
+            {
+                // clip the histogram and redistribute the excess uniformly
+                int clipped = 0;
+                for( i = 0; i < histSize; i++ )
+                {
+                    if( tileHist[i] > clipLimit )
+                    {
+                        clipped += tileHist[i] - clipLimit;
+                        tileHist[i] = clipLimit;
+                    }
+                }
+
+                int redistBatch = clipped / histSize;
+                int residual = clipped - redistBatch * histSize;
+
+                for( i = 0; i < histSize; i++ )
+                    tileHist[i] += redistBatch;
+
+                if( residual != 0 )
+                {
+                    int residualStep = MAX(histSize / residual, 1);
+                    for( i = 0; i < histSize && residual > 0; i += residualStep, residual-- )
+                        tileHist[i]++;
+                }
+            }
+
+            int sum = 0;
+            for( i = 0; i < histSize; i++ )
+            {
+                sum += tileHist[i];
+                tileLut[i] = saturate_cast<T>(sum * lutScale);
+            }
+        }
+    }
+
+private:
+    const Mat* src;
+    Mat* lut;
+    Size tileSize;
+    int tilesX;
+    int clipLimit;
+    float lutScale;
+};
+
+template<typename T> struct CLAHE_InterpVec
+{
+    int operator()(const T*, T*, const T*, const T*, const int*, const int*,
+                   const float*, const float*, float, float, int) const { return 0; }
+};
+
+#if CV_SSE2
+
+// blends the LUT values of 4 pixels; the operations go in the same order as in the plain C loop,
+// so the result is bit-exact with it
+static inline __m128i clahe_interp4(const float* l1a, const float* l1b, const float* l2a, const float* l2b,
+                                    const float* xa, const float* xa1, __m128 ya, __m128 ya1)
+{
+    __m128 a = _mm_loadu_ps(xa), a1 = _mm_loadu_ps(xa1);
+    __m128 r1 = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(l1a), a1), _mm_mul_ps(_mm_loadu_ps(l1b), a));
+    __m128 r2 = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(l2a), a1), _mm_mul_ps(_mm_loadu_ps(l2b), a));
+    return _mm_cvtps_epi32(_mm_add_ps(_mm_mul_ps(r1, ya1), _mm_mul_ps(r2, ya)));
+}
+
+template<typename T> static inline void clahe_gather4(const T* srcRow, const T* lutPlane1, const T* lutPlane2,
+                                                     const int* ind1, const int* ind2,
+                                                     float* l1a, float* l1b, float* l2a, float* l2b)
+{
+    for( int k = 0; k < 4; k++ )
+    {
+        int v = srcRow[k];
+        l1a[k] = (float)lutPlane1[ind1[k] + v];
+        l1b[k] = (float)lutPlane1[ind2[k] + v];
+        l2a[k] = (float)lutPlane2[ind1[k] + v];
+        l2b[k] = (float)lutPlane2[ind2[k] + v];
+    }
+}
+
+template<> struct CLAHE_InterpVec<uchar>
+{
+    int operator()(const uchar* srcRow, uchar* dstRow, const uchar* lutPlane1, const uchar* lutPlane2,
+                   const int* ind1, const int* ind2, const float* xa, const float* xa1,
+                   float _ya, float _ya1, int width) const
+    {
+        if( !checkHardwareSupport(CV_CPU_SSE2) )
+            return 0;
+
+        float CV_DECL_ALIGNED(16) buf[16];
+        __m128 ya = _mm_set1_ps(_ya), ya1 = _mm_set1_ps(_ya1);
+        int x = 0;
+
+        for( ; x <= width - 8; x += 8 )
+        {
+            clahe_gather4(srcRow + x, lutPlane1, lutPlane2, ind1 + x, ind2 + x, buf, buf + 4, buf + 8, buf + 12);
+            __m128i r0 = clahe_interp4(buf, buf + 4, buf + 8, buf + 12, xa + x, xa1 + x, ya, ya1);
+            clahe_gather4(srcRow + x + 4, lutPlane1, lutPlane2, ind1 + x + 4, ind2 + x + 4, buf, buf + 4, buf + 8, buf + 12);
+            __m128i r1 = clahe_interp4(buf, buf + 4, buf + 8, buf + 12, xa + x + 4, xa1 + x + 4, ya, ya1);
+            r0 = _mm_packs_epi32(r0, r1);
+            _mm_storel_epi64((__m128i*)(dstRow + x), _mm_packus_epi16(r0, r0));
+        }
+
+        return x;
+    }
+};
+
+template<> struct CLAHE_InterpVec<ushort>
+{
+    int operator()(const ushort* srcRow, ushort* dstRow, const ushort* lutPlane1, const ushort* lutPlane2,
+                   const int* ind1, const int* ind2, const float* xa, const float* xa1,
+                   float _ya, float _ya1, int width) const
+    {
+        if( !checkHardwareSupport(CV_CPU_SSE2) )
+            return 0;
+
+        float CV_DECL_ALIGNED(16) buf[16];
+        __m128 ya = _mm_set1_ps(_ya), ya1 = _mm_set1_ps(_ya1);
+        // there is no unsigned 32->16 bit pack in SSE2, so the values are shifted to the signed range and back
+        __m128i delta32 = _mm_set1_epi32(32768), delta16 = _mm_set1_epi16((short)-32768);
+        int x = 0;
+
+        for( ; x <= width - 8; x += 8 )
+        {
+            clahe_gather4(srcRow + x, lutPlane1, lutPlane2, ind1 + x, ind2 + x, buf, buf + 4, buf + 8, buf + 12);
+            __m128i r0 = clahe_interp4(buf, buf + 4, buf + 8, buf + 12, xa + x, xa1 + x, ya, ya1);
+            clahe_gather4(srcRow + x + 4, lutPlane1, lutPlane2, ind1 + x + 4, ind2 + x + 4, buf, buf + 4, buf + 8, buf + 12);
+            __m128i r1 = clahe_interp4(buf, buf + 4, buf + 8, buf + 12, xa + x + 4, xa1 + x + 4, ya, ya1);
+            r0 = _mm_packs_epi32(_mm_sub_epi32(r0, delta32), _mm_sub_epi32(r1, delta32));
+            _mm_storeu_si128((__m128i*)(dstRow + x), _mm_sub_epi16(r0, delta16));
+        }
+
+        return x;
+    }
+};
+
+#endif
+
+template<typename T> class CLAHE_Interpolation_Invoker : public ParallelLoopBody
+{
+public:
+    CLAHE_Interpolation_Invoker(const Mat& _src, Mat& _dst, const Mat& _lut, const Mat& _tab,
+                                Size _tileSize, int _tilesY) :
+        src(&_src), dst(&_dst), lut(&_lut), tab(&_tab), tileSize(_tileSize), tilesY(_tilesY)
+    {
+    }
+
+    void operator()(const Range& range) const
+    {
+        const float inv_th = 1.0f / tileSize.height;
+        int width = src->cols, tilesX = lut->rows / tilesY;
+        const int* ind1 = tab->ptr<int>(0);
+        const int* ind2 = tab->ptr<int>(1);
+        const float* xa = tab->ptr<float>(2);
+        const float* xa1 = tab->ptr<float>(3);
+        CLAHE_InterpVec<T> vecOp;
+
+        for( int y = range.start; y < range.end; y++ )
+        {
+            const T* srcRow = src->ptr<T>(y);
+            T* dstRow = dst->ptr<T>(y);
+
+            float tyf = y * inv_th - 0.5f;
+            int ty1 = cvFloor(tyf);
+            int ty2 = ty1 + 1;
+            float ya = tyf - ty1, ya1 = 1.0f - ya;
+
+            ty1 = std::max(ty1, 0);
+            ty2 = std::min(ty2, tilesY - 1);
+
+            const T* lutPlane1 = lut->ptr<T>(ty1 * tilesX);
+            const T* lutPlane2 = lut->ptr<T>(ty2 * tilesX);
+
+            int x = vecOp(srcRow, dstRow, lutPlane1, lutPlane2, ind1, ind2, xa, xa1, ya, ya1, width);
+
+            for( ; x < width; x++ )
+            {
+                int v = srcRow[x];
+                float res = ((float)lutPlane1[ind1[x] + v] * xa1[x] + (float)lutPlane1[ind2[x] + v] * xa[x]) * ya1 +
+                            ((float)lutPlane2[ind1[x] + v] * xa1[x] + (float)lutPlane2[ind2[x] + v] * xa[x]) * ya;
+                dstRow[x] = saturate_cast<T>(res);
+            }
+        }
+    }
+
+private:
+    const Mat* src;
+    Mat* dst;
+    const Mat* lut;
+    const Mat* tab;
+    Size tileSize;
+    int tilesY;
+};
+
+class CLAHE_Impl : public CLAHE
+{
+public:
+    CLAHE_Impl(double clipLimit = 40.0, int tilesX = 8, int tilesY = 8);
+
+    AlgorithmInfo* info() const;
+
+    void apply(InputArray src, OutputArray dst);
+
+    void setClipLimit(double clipLimit);
+    double getClipLimit() const;
+
+    void setTilesGridSize(Size tileGridSize);
+    Size getTilesGridSize() const;
+
+    void collectGarbage();
+
+private:
+    double clipLimit_;
+    int tilesX_;
+    int tilesY_;
+
+    // the state kept between the calls, so that the frames of the same size
+    // are processed without any memory allocation
+    Mat srcExt_;
+    Mat lut_;
+    Mat tab_;
+};
+
+CLAHE_Impl::CLAHE_Impl(double clipLimit, int tilesX, int tilesY) :
+    clipLimit_(clipLimit), tilesX_(tilesX), tilesY_(tilesY)
+{
+}
+
+CV_INIT_ALGORITHM(CLAHE_Impl, "CLAHE",
+                  obj.info()->addParam(obj, "clipLimit", obj.clipLimit_);
+                  obj.info()->addParam(obj, "tilesX", obj.tilesX_);
+                  obj.info()->addParam(obj, "tilesY", obj.tilesY_));
+
+void CLAHE_Impl::apply(InputArray _src, OutputArray _dst)
+{
+    Mat src = _src.getMat();
+    CV_Assert( src.type() == CV_8UC1 || src.type() == CV_16UC1 );
+    CV_Assert( tilesX_ > 0 && tilesY_ > 0 );
+
+    const int histSize = src.depth() == CV_8U ? 256 : 65536;
+
+    Size tileSize;
+    Mat srcForLut;
+
+    if( src.cols % tilesX_ == 0 && src.rows % tilesY_ == 0 )
+    {
+        tileSize = Size(src.cols / tilesX_, src.rows / tilesY_);
+        srcForLut = src;
+    }
+    else
+    {
+        int padY = (tilesY_ - src.rows % tilesY_) % tilesY_;
+        int padX = (tilesX_ - src.cols % tilesX_) % tilesX_;
+        copyMakeBorder(src, srcExt_, 0, padY, 0, padX, BORDER_REFLECT_101);
+        tileSize = Size(srcExt_.cols / tilesX_, srcExt_.rows / tilesY_);
+        srcForLut = srcExt_;
+    }
+
+    const int tileSizeTotal = tileSize.area();
+    const float lutScale = (float)(histSize - 1) / tileSizeTotal;
+
+    int clipLimit = 0;
+    if( clipLimit_ > 0.0 )
+    {
+        clipLimit = (int)(clipLimit_ * tileSizeTotal / histSize);
+        clipLimit = std::max(clipLimit, 1);
+    }
+
+    int ntiles = tilesX_ * tilesY_;
+    lut_.create(ntiles, histSize, src.type());
+
+    // each tile is processed by exactly one thread, so the LUTs do not depend on the number of threads
+    if( src.depth() == CV_8U )
+    {
+        CLAHE_CalcLut_Invoker<uchar, 256> calcLut(srcForLut, lut_, tileSize, tilesX_, clipLimit, lutScale);
+        parallel_for_(Range(0, ntiles), calcLut);
+    }
+    else
+    {
+        CLAHE_CalcLut_Invoker<ushort, 65536> calcLut(srcForLut, lut_, tileSize, tilesX_, clipLimit, lutScale);
+        parallel_for_(Range(0, ntiles), calcLut);
+    }
+
+    // the horizontal interpolation coefficients are the same for all the rows
+    int width = src.cols;
+    int lutStep = (int)(lut_.step / lut_.elemSize());
+    tab_.create(4, width, CV_32S);
+    int* ind1 = tab_.ptr<int>(0);
+    int* ind2 = tab_.ptr<int>(1);
+    float* xa = tab_.ptr<float>(2);
+    float* xa1 = tab_.ptr<float>(3);
+    const float inv_tw = 1.0f / tileSize.width;
+
+    for( int x = 0; x < width; x++ )
+    {
+        float txf = x * inv_tw - 0.5f;
+        int tx1 = cvFloor(txf);
+        int tx2 = tx1 + 1;
+
+        xa[x] = txf - tx1;
+        xa1[x] = 1.0f - xa[x];
+
+        tx1 = std::max(tx1, 0);
+        tx2 = std::min(tx2, tilesX_ - 1);
+
+        ind1[x] = tx1 * lutStep;
+        ind2[x] = tx2 * lutStep;
+    }
+
+    _dst.create( src.size(), src.type() );
+    Mat dst = _dst.getMat();
+
+    int nstripes = (int)std::min((size_t)src.rows, src.total()/CLAHE_PARALLEL_MIN);
+    Range rows(0, src.rows);
+
+    if( src.depth() == CV_8U )
+    {
+        CLAHE_Interpolation_Invoker<uchar> interpolation(src, dst, lut_, tab_, tileSize, tilesY_);
+        if( nstripes > 1 )
+            parallel_for_(rows, interpolation, nstripes);
+        else
+            interpolation(rows);
+    }
+    else
+    {
+        CLAHE_Interpolation_Invoker<ushort> interpolation(src, dst, lut_, tab_, tileSize, tilesY_);
+        if( nstripes > 1 )
+            parallel_for_(rows, interpolation, nstripes);
+        else
+            interpolation(rows);
+    }
+}
+
+void CLAHE_Impl::setClipLimit(double clipLimit)
+{
+    clipLimit_ = clipLimit;
+}
+
+double CLAHE_Impl::getClipLimit() const
+{
+    return clipLimit_;
+}
+
+void CLAHE_Impl::setTilesGridSize(Size tileGridSize)
+{
+    tilesX_ = tileGridSize.width;
+    tilesY_ = tileGridSize.height;
+}
+
+Size CLAHE_Impl::getTilesGridSize() const
+{
+    return Size(tilesX_, tilesY_);
+}
+
+void CLAHE_Impl::collectGarbage()
+{
+    srcExt_.release();
+    lut_.release();
+    tab_.release();
+}
+
+}
+
+cv::Ptr<cv::CLAHE> cv::createCLAHE(double clipLimit, cv::Size tileGridSize)
+{
+    return new CLAHE_Impl(clipLimit, tileGridSize.width, tileGridSize.height);
+}
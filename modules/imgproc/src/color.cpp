@@ -156,24 +156,142 @@ template<> struct ColorChannel<float>
 
 ///////////////////////////// Top-level template function ////////////////////////////////
 
-template<class Cvt> void CvtColorLoop(const Mat& srcmat, Mat& dstmat, const Cvt& cvt)
+template<class Cvt> class CvtColorLoop_Invoker : public ParallelLoopBody
 {
     typedef typename Cvt::channel_type _Tp;
-    Size sz = srcmat.size();
-    const uchar* src = srcmat.data;
-    uchar* dst = dstmat.data;
-    size_t srcstep = srcmat.step, dststep = dstmat.step;
+public:
+    CvtColorLoop_Invoker(const Mat& _src, Mat& _dst, const Cvt& _cvt) :
+        src(_src), dst(_dst), cvt(_cvt)
+    {
+    }
+
+    virtual void operator()(const Range& range) const
+    {
+        const uchar* yS = src.ptr<uchar>(range.start);
+        uchar* yD = dst.ptr<uchar>(range.start);
+
+        // continuous stripes are converted in a single call
+        if( src.isContinuous() && dst.isContinuous() )
+            cvt((const _Tp*)yS, (_Tp*)yD, src.cols*(range.end - range.start));
+        else
+            for( int i = range.start; i < range.end; i++, yS += src.step, yD += dst.step )
+                cvt((const _Tp*)yS, (_Tp*)yD, src.cols);
+    }
+
+private:
+    const Mat& src;
+    Mat& dst;
+    const Cvt& cvt;
+};
+
+enum { CVTCOLOR_PARALLEL_MIN = 1 << 16 };
+
+template<class Cvt> void CvtColorLoop(const Mat& srcmat, Mat& dstmat, const Cvt& cvt)
+{
+    CvtColorLoop_Invoker<Cvt> body(srcmat, dstmat, cvt);
+    int nstripes = (int)std::min(srcmat.total()/CVTCOLOR_PARALLEL_MIN, (size_t)srcmat.rows);
+
+    if( nstripes > 1 )
+        parallel_for_(Range(0, srcmat.rows), body, nstripes);
+    else
+        body(Range(0, srcmat.rows));
+}
+
+#if CV_SSE2
+
+// Splits 32 interleaved 3-channel pixels (v[0..5] in memory order) into the
+// planes v[0..1], v[2..3], v[4..5] with 5 rounds of byte unpacking.
+static inline void deinterleave3_8u(__m128i v[6])
+{
+    for( int k = 0; k < 5; k++ )
+    {
+        __m128i t0 = _mm_unpacklo_epi8(v[0], v[3]), t1 = _mm_unpackhi_epi8(v[0], v[3]);
+        __m128i t2 = _mm_unpacklo_epi8(v[1], v[4]), t3 = _mm_unpackhi_epi8(v[1], v[4]);
+        __m128i t4 = _mm_unpacklo_epi8(v[2], v[5]), t5 = _mm_unpackhi_epi8(v[2], v[5]);
+        v[0] = t0; v[1] = t1; v[2] = t2; v[3] = t3; v[4] = t4; v[5] = t5;
+    }
+}
+
+// The inverse of deinterleave3_8u: even/odd byte selection, 5 rounds.
+static inline void interleave3_8u(__m128i v[6])
+{
+    const __m128i mask = _mm_set1_epi16(0x00ff);
+    for( int k = 0; k < 5; k++ )
+    {
+        __m128i t0 = _mm_packus_epi16(_mm_and_si128(v[0], mask), _mm_and_si128(v[1], mask));
+        __m128i t1 = _mm_packus_epi16(_mm_and_si128(v[2], mask), _mm_and_si128(v[3], mask));
+        __m128i t2 = _mm_packus_epi16(_mm_and_si128(v[4], mask), _mm_and_si128(v[5], mask));
+        __m128i t3 = _mm_packus_epi16(_mm_srli_epi16(v[0], 8), _mm_srli_epi16(v[1], 8));
+        __m128i t4 = _mm_packus_epi16(_mm_srli_epi16(v[2], 8), _mm_srli_epi16(v[3], 8));
+        __m128i t5 = _mm_packus_epi16(_mm_srli_epi16(v[4], 8), _mm_srli_epi16(v[5], 8));
+        v[0] = t0; v[1] = t1; v[2] = t2; v[3] = t3; v[4] = t4; v[5] = t5;
+    }
+}
+
+// Splits 16 interleaved 4-channel pixels into 4 planes with 4 rounds of byte unpacking.
+static inline void deinterleave4_8u(__m128i v[4])
+{
+    for( int k = 0; k < 4; k++ )
+    {
+        __m128i t0 = _mm_unpacklo_epi8(v[0], v[2]), t1 = _mm_unpackhi_epi8(v[0], v[2]);
+        __m128i t2 = _mm_unpacklo_epi8(v[1], v[3]), t3 = _mm_unpackhi_epi8(v[1], v[3]);
+        v[0] = t0; v[1] = t1; v[2] = t2; v[3] = t3;
+    }
+}
 
-    if( srcmat.isContinuous() && dstmat.isContinuous() )
+// Loads 32 pixels with 3 or 4 channels and returns the first 3 planes in v[0..5].
+static inline void loadPlanes_8u(const uchar* src, int scn, __m128i v[6])
+{
+    if( scn == 3 )
+    {
+        for( int k = 0; k < 6; k++ )
+            v[k] = _mm_loadu_si128((const __m128i*)(src + k*16));
+        deinterleave3_8u(v);
+    }
+    else
     {
-        sz.width *= sz.height;
-        sz.height = 1;
+        __m128i a[4], b[4];
+        for( int k = 0; k < 4; k++ )
+        {
+            a[k] = _mm_loadu_si128((const __m128i*)(src + k*16));
+            b[k] = _mm_loadu_si128((const __m128i*)(src + 64 + k*16));
+        }
+        deinterleave4_8u(a);
+        deinterleave4_8u(b);
+        v[0] = a[0]; v[1] = b[0]; v[2] = a[1]; v[3] = b[1]; v[4] = a[2]; v[5] = b[2];
     }
+}
+
+// Computes (c0*k0 + c1*k1 + c2*k2 + delta) >> shift for 8 16-bit values in 32-bit precision;
+// k01 holds the (k0, k1) pairs of 16-bit coefficients and k2 holds the (k2, 0) pairs.
+static inline __m128i weightedSum3_16s(__m128i c0, __m128i c1, __m128i c2,
+                                       __m128i k01, __m128i k2, __m128i delta, int shift)
+{
+    const __m128i z = _mm_setzero_si128();
+    __m128i lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(c0, c1), k01),
+                               _mm_madd_epi16(_mm_unpacklo_epi16(c2, z), k2));
+    __m128i hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(c0, c1), k01),
+                               _mm_madd_epi16(_mm_unpackhi_epi16(c2, z), k2));
+    lo = _mm_srai_epi32(_mm_add_epi32(lo, delta), shift);
+    hi = _mm_srai_epi32(_mm_add_epi32(hi, delta), shift);
+    return _mm_packs_epi32(lo, hi);
+}
+
+static inline __m128i pairCoeffs_16s(int k0, int k1)
+{
+    return _mm_set1_epi32((k0 & 0xffff) | (k1 << 16));
+}
 
-    for( ; sz.height--; src += srcstep, dst += dststep )
-        cvt((const _Tp*)src, (_Tp*)dst, sz.width);
+static inline bool fitsInt16(const int* coeffs, int n)
+{
+    for( int i = 0; i < n; i++ )
+        if( coeffs[i] != (short)coeffs[i] )
+            return false;
+    return true;
 }
 
+#endif
+
 
 ////////////////// Various 3/4-channel to 3/4-channel RGB transformations /////////////////
 
@@ -426,16 +544,48 @@ template<> struct RGB2Gray<uchar>
             tab[i+256] = g;
             tab[i+512] = r;
         }
+
+        cb = db; cg = dg; cr = dr;
+#if CV_SSE2
+        useSIMD = checkHardwareSupport(CV_CPU_SSE2) && fitsInt16(coeffs, 3);
+        if( useSIMD )
+            CV_TRACE_SIMD(CV_CPU_SSE2);
+#endif
     }
     void operator()(const uchar* src, uchar* dst, int n) const
     {
-        int scn = srccn;
+        int scn = srccn, i = 0;
         const int* _tab = tab;
-        for(int i = 0; i < n; i++, src += scn)
+#if CV_SSE2
+        if( useSIMD )
+        {
+            // the same integer arithmetic as in the table-based loop below
+            __m128i k01 = pairCoeffs_16s(cb, cg), k2 = pairCoeffs_16s(cr, 0);
+            __m128i delta = _mm_set1_epi32(1 << (yuv_shift-1)), z = _mm_setzero_si128();
+            for( ; i <= n - 32; i += 32, src += scn*32 )
+            {
+                __m128i v[6];
+                loadPlanes_8u(src, scn, v);
+                for( int k = 0; k < 2; k++ )
+                {
+                    __m128i y0 = weightedSum3_16s(_mm_unpacklo_epi8(v[k], z), _mm_unpacklo_epi8(v[k+2], z),
+                                                  _mm_unpacklo_epi8(v[k+4], z), k01, k2, delta, yuv_shift);
+                    __m128i y1 = weightedSum3_16s(_mm_unpackhi_epi8(v[k], z), _mm_unpackhi_epi8(v[k+2], z),
+                                                  _mm_unpackhi_epi8(v[k+4], z), k01, k2, delta, yuv_shift);
+                    _mm_storeu_si128((__m128i*)(dst + i + k*16), _mm_packus_epi16(y0, y1));
+                }
+            }
+        }
+#endif
+        for( ; i < n; i++, src += scn)
             dst[i] = (uchar)((_tab[src[0]] + _tab[src[1]+256] + _tab[src[2]+512]) >> yuv_shift);
     }
     int srccn;
     int tab[256*3];
+    int cb, cg, cr;
+#if CV_SSE2
+    bool useSIMD;
+#endif
 };
 
 
@@ -494,6 +644,68 @@ template<typename _Tp> struct RGB2YCrCb_f
 };
 
 
+template<typename _Tp> static inline bool RGB2YCrCb_useSIMD(const _Tp*, const int*)
+{
+    return false;
+}
+
+template<typename _Tp> static inline int RGB2YCrCb_vec(const _Tp*, _Tp*, int, int, int, const int*)
+{
+    return 0;
+}
+
+#if CV_SSE2
+static inline bool RGB2YCrCb_useSIMD(const uchar*, const int* coeffs)
+{
+    return checkHardwareSupport(CV_CPU_SSE2) && fitsInt16(coeffs, 5);
+}
+
+// converts the initial part of the row with SSE2 and returns the number of processed pixels;
+// the results are bit-exact with the scalar code in RGB2YCrCb_i
+static inline int RGB2YCrCb_vec(const uchar* src, uchar* dst, int n, int scn, int bidx, const int* coeffs)
+{
+    if( !RGB2YCrCb_useSIMD(src, coeffs) )
+        return 0;
+
+    __m128i k01 = pairCoeffs_16s(coeffs[0], coeffs[1]), k2 = pairCoeffs_16s(coeffs[2], 0);
+    __m128i k3 = pairCoeffs_16s(coeffs[3], 0), k4 = pairCoeffs_16s(coeffs[4], 0);
+    __m128i ydelta = _mm_set1_epi32(1 << (yuv_shift-1));
+    __m128i cdelta = _mm_set1_epi32((128 << yuv_shift) + (1 << (yuv_shift-1)));
+    __m128i z = _mm_setzero_si128();
+    int i = 0;
+
+    for( ; i <= n - 32; i += 32, src += scn*32, dst += 96 )
+    {
+        __m128i v[6], r[6];
+        loadPlanes_8u(src, scn, v);
+        for( int k = 0; k < 2; k++ )
+        {
+            __m128i ch[3][2];
+            for( int c = 0; c < 3; c++ )
+            {
+                ch[c][0] = _mm_unpacklo_epi8(v[k + c*2], z);
+                ch[c][1] = _mm_unpackhi_epi8(v[k + c*2], z);
+            }
+
+            __m128i y[2], cr[2], cb[2];
+            for( int h = 0; h < 2; h++ )
+            {
+                y[h] = weightedSum3_16s(ch[0][h], ch[1][h], ch[2][h], k01, k2, ydelta, yuv_shift);
+                cr[h] = weightedSum3_16s(_mm_sub_epi16(ch[bidx^2][h], y[h]), z, z, k3, z, cdelta, yuv_shift);
+                cb[h] = weightedSum3_16s(_mm_sub_epi16(ch[bidx][h], y[h]), z, z, k4, z, cdelta, yuv_shift);
+            }
+            r[k] = _mm_packus_epi16(y[0], y[1]);
+            r[k+2] = _mm_packus_epi16(cr[0], cr[1]);
+            r[k+4] = _mm_packus_epi16(cb[0], cb[1]);
+        }
+        interleave3_8u(r);
+        for( int k = 0; k < 6; k++ )
+            _mm_storeu_si128((__m128i*)(dst + k*16), r[k]);
+    }
+    return i;
+}
+#endif
+
 template<typename _Tp> struct RGB2YCrCb_i
 {
     typedef _Tp channel_type;
@@ -504,14 +716,18 @@ template<typename _Tp> struct RGB2YCrCb_i
         static const int coeffs0[] = {R2Y, G2Y, B2Y, 11682, 9241};
         memcpy(coeffs, _coeffs ? _coeffs : coeffs0, 5*sizeof(coeffs[0]));
         if(blueIdx==0) std::swap(coeffs[0], coeffs[2]);
+        if( RGB2YCrCb_useSIMD((const _Tp*)0, coeffs) )
+            CV_TRACE_SIMD(CV_CPU_SSE2);
     }
     void operator()(const _Tp* src, _Tp* dst, int n) const
     {
         int scn = srccn, bidx = blueIdx;
         int C0 = coeffs[0], C1 = coeffs[1], C2 = coeffs[2], C3 = coeffs[3], C4 = coeffs[4];
         int delta = ColorChannel<_Tp>::half()*(1 << yuv_shift);
+        int i = RGB2YCrCb_vec(src, dst, n, scn, bidx, coeffs);
+        src += i*scn;
         n *= 3;
-        for(int i = 0; i < n; i += 3, src += scn)
+        for(i *= 3; i < n; i += 3, src += scn)
         {
             int Y = CV_DESCALE(src[0]*C0 + src[1]*C1 + src[2]*C2, yuv_shift);
             int Cr = CV_DESCALE((src[bidx^2] - Y)*C3 + delta, yuv_shift);
@@ -783,6 +999,11 @@ template<typename _Tp> struct XYZ2RGB_i
 ////////////////////////////////////// RGB <-> HSV ///////////////////////////////////////
 
 
+static const int hsv_shift = 12;
+static int sdiv_table[256];
+static int hdiv_table180[256];
+static int hdiv_table256[256];
+
 struct RGB2HSV_b
 {
     typedef uchar channel_type;
@@ -791,26 +1012,14 @@ struct RGB2HSV_b
     : srccn(_srccn), blueIdx(_blueIdx), hrange(_hrange)
     {
         CV_Assert( hrange == 180 || hrange == 256 );
-    }
 
-    void operator()(const uchar* src, uchar* dst, int n) const
-    {
-        int i, bidx = blueIdx, scn = srccn;
-        const int hsv_shift = 12;
-
-        static int sdiv_table[256];
-        static int hdiv_table180[256];
-        static int hdiv_table256[256];
+        // the tables are filled here rather than in operator(),
+        // which may be called from several threads at once
         static volatile bool initialized = false;
-
-        int hr = hrange;
-        const int* hdiv_table = hr == 180 ? hdiv_table180 : hdiv_table256;
-        n *= 3;
-
         if( !initialized )
         {
             sdiv_table[0] = hdiv_table180[0] = hdiv_table256[0] = 0;
-            for( i = 1; i < 256; i++ )
+            for( int i = 1; i < 256; i++ )
             {
                 sdiv_table[i] = saturate_cast<int>((255 << hsv_shift)/(1.*i));
                 hdiv_table180[i] = saturate_cast<int>((180 << hsv_shift)/(6.*i));
@@ -818,6 +1027,15 @@ struct RGB2HSV_b
             }
             initialized = true;
         }
+    }
+
+    void operator()(const uchar* src, uchar* dst, int n) const
+    {
+        int i, bidx = blueIdx, scn = srccn;
+
+        int hr = hrange;
+        const int* hdiv_table = hr == 180 ? hdiv_table180 : hdiv_table256;
+        n *= 3;
 
         for( i = 0; i < n; i += 3, src += scn )
         {
@@ -1748,6 +1966,8 @@ public:
     SIMDBayerInterpolator_8u()
     {
         use_simd = checkHardwareSupport(CV_CPU_SSE2);
+        if( use_simd )
+            CV_TRACE_SIMD(CV_CPU_SSE2);
     }
 
     int bayer2Gray(const uchar* bayer, int bayer_step, uchar* dst,
@@ -1886,94 +2106,128 @@ typedef SIMDBayerStubInterpolator_<uchar> SIMDBayerInterpolator_8u;
 #endif
 
 template<typename T, class SIMDInterpolator>
-static void Bayer2Gray_( const Mat& srcmat, Mat& dstmat, int code )
+class Bayer2Gray_Invoker : public ParallelLoopBody
 {
-    SIMDInterpolator vecOp;
-    const int R2Y = 4899;
-    const int G2Y = 9617;
-    const int B2Y = 1868;
-    const int SHIFT = 14;
-
-    const T* bayer0 = (const T*)srcmat.data;
-    int bayer_step = (int)(srcmat.step/sizeof(T));
-    T* dst0 = (T*)dstmat.data;
-    int dst_step = (int)(dstmat.step/sizeof(T));
-    Size size = srcmat.size();
-    int bcoeff = B2Y, rcoeff = R2Y;
-    int start_with_green = code == CV_BayerGB2GRAY || code == CV_BayerGR2GRAY;
-    bool brow = true;
-
-    if( code != CV_BayerBG2GRAY && code != CV_BayerGB2GRAY )
+public:
+    Bayer2Gray_Invoker(const Mat& _srcmat, Mat& _dstmat, int _code) :
+        srcmat(_srcmat), dstmat(_dstmat), code(_code)
     {
-        brow = false;
-        std::swap(bcoeff, rcoeff);
     }
 
-    dst0 += dst_step + 1;
-    size.height -= 2;
-    size.width -= 2;
-
-    for( ; size.height-- > 0; bayer0 += bayer_step, dst0 += dst_step )
+    virtual void operator()(const Range& range) const
     {
-        unsigned t0, t1, t2;
-        const T* bayer = bayer0;
-        T* dst = dst0;
-        const T* bayer_end = bayer + size.width;
-
-        if( size.width <= 0 )
+        SIMDInterpolator vecOp;
+        const int R2Y = 4899;
+        const int G2Y = 9617;
+        const int B2Y = 1868;
+        const int SHIFT = 14;
+
+        int bayer_step = (int)(srcmat.step/sizeof(T));
+        int dst_step = (int)(dstmat.step/sizeof(T));
+        const T* bayer0 = (const T*)srcmat.data + bayer_step*range.start;
+        T* dst0 = (T*)dstmat.data + dst_step*range.start;
+        Size size = srcmat.size();
+        int bcoeff = B2Y, rcoeff = R2Y;
+        int start_with_green = code == CV_BayerGB2GRAY || code == CV_BayerGR2GRAY;
+        bool brow = true;
+
+        if( code != CV_BayerBG2GRAY && code != CV_BayerGB2GRAY )
         {
-            dst[-1] = dst[size.width] = 0;
-            continue;
+            brow = false;
+            std::swap(bcoeff, rcoeff);
         }
 
-        if( start_with_green )
+        // the pattern alternates from row to row
+        if( range.start % 2 != 0 )
         {
-            t0 = (bayer[1] + bayer[bayer_step*2+1])*rcoeff;
-            t1 = (bayer[bayer_step] + bayer[bayer_step+2])*bcoeff;
-            t2 = bayer[bayer_step+1]*(2*G2Y);
-
-            dst[0] = (T)CV_DESCALE(t0 + t1 + t2, SHIFT+1);
-            bayer++;
-            dst++;
+            brow = !brow;
+            std::swap(bcoeff, rcoeff);
+            start_with_green = !start_with_green;
         }
 
-        int delta = vecOp.bayer2Gray(bayer, bayer_step, dst, size.width, bcoeff, G2Y, rcoeff);
-        bayer += delta;
-        dst += delta;
+        dst0 += dst_step + 1;
+        size.width -= 2;
 
-        for( ; bayer <= bayer_end - 2; bayer += 2, dst += 2 )
+        for( int i = range.start; i < range.end; i++, bayer0 += bayer_step, dst0 += dst_step )
         {
-            t0 = (bayer[0] + bayer[2] + bayer[bayer_step*2] + bayer[bayer_step*2+2])*rcoeff;
-            t1 = (bayer[1] + bayer[bayer_step] + bayer[bayer_step+2] + bayer[bayer_step*2+1])*G2Y;
-            t2 = bayer[bayer_step+1]*(4*bcoeff);
-            dst[0] = (T)CV_DESCALE(t0 + t1 + t2, SHIFT+2);
+            unsigned t0, t1, t2;
+            const T* bayer = bayer0;
+            T* dst = dst0;
+            const T* bayer_end = bayer + size.width;
 
-            t0 = (bayer[2] + bayer[bayer_step*2+2])*rcoeff;
-            t1 = (bayer[bayer_step+1] + bayer[bayer_step+3])*bcoeff;
-            t2 = bayer[bayer_step+2]*(2*G2Y);
-            dst[1] = (T)CV_DESCALE(t0 + t1 + t2, SHIFT+1);
-        }
+            if( size.width <= 0 )
+            {
+                dst[-1] = dst[size.width] = 0;
+                continue;
+            }
 
-        if( bayer < bayer_end )
-        {
-            t0 = (bayer[0] + bayer[2] + bayer[bayer_step*2] + bayer[bayer_step*2+2])*rcoeff;
-            t1 = (bayer[1] + bayer[bayer_step] + bayer[bayer_step+2] + bayer[bayer_step*2+1])*G2Y;
-            t2 = bayer[bayer_step+1]*(4*bcoeff);
-            dst[0] = (T)CV_DESCALE(t0 + t1 + t2, SHIFT+2);
-            bayer++;
-            dst++;
-        }
+            if( start_with_green )
+            {
+                t0 = (bayer[1] + bayer[bayer_step*2+1])*rcoeff;
+                t1 = (bayer[bayer_step] + bayer[bayer_step+2])*bcoeff;
+                t2 = bayer[bayer_step+1]*(2*G2Y);
+
+                dst[0] = (T)CV_DESCALE(t0 + t1 + t2, SHIFT+1);
+                bayer++;
+                dst++;
+            }
+
+            int delta = vecOp.bayer2Gray(bayer, bayer_step, dst, size.width, bcoeff, G2Y, rcoeff);
+            bayer += delta;
+            dst += delta;
+
+            for( ; bayer <= bayer_end - 2; bayer += 2, dst += 2 )
+            {
+                t0 = (bayer[0] + bayer[2] + bayer[bayer_step*2] + bayer[bayer_step*2+2])*rcoeff;
+                t1 = (bayer[1] + bayer[bayer_step] + bayer[bayer_step+2] + bayer[bayer_step*2+1])*G2Y;
+                t2 = bayer[bayer_step+1]*(4*bcoeff);
+                dst[0] = (T)CV_DESCALE(t0 + t1 + t2, SHIFT+2);
+
+                t0 = (bayer[2] + bayer[bayer_step*2+2])*rcoeff;
+                t1 = (bayer[bayer_step+1] + bayer[bayer_step+3])*bcoeff;
+                t2 = bayer[bayer_step+2]*(2*G2Y);
+                dst[1] = (T)CV_DESCALE(t0 + t1 + t2, SHIFT+1);
+            }
+
+            if( bayer < bayer_end )
+            {
+                t0 = (bayer[0] + bayer[2] + bayer[bayer_step*2] + bayer[bayer_step*2+2])*rcoeff;
+                t1 = (bayer[1] + bayer[bayer_step] + bayer[bayer_step+2] + bayer[bayer_step*2+1])*G2Y;
+                t2 = bayer[bayer_step+1]*(4*bcoeff);
+                dst[0] = (T)CV_DESCALE(t0 + t1 + t2, SHIFT+2);
+                bayer++;
+                dst++;
+            }
 
-        dst0[-1] = dst0[0];
-        dst0[size.width] = dst0[size.width-1];
+            dst0[-1] = dst0[0];
+            dst0[size.width] = dst0[size.width-1];
 
-        brow = !brow;
-        std::swap(bcoeff, rcoeff);
-        start_with_green = !start_with_green;
+            brow = !brow;
+            std::swap(bcoeff, rcoeff);
+            start_with_green = !start_with_green;
+        }
     }
 
-    size = dstmat.size();
-    dst0 = (T*)dstmat.data;
+private:
+    Mat srcmat;
+    Mat dstmat;
+    int code;
+};
+
+template<typename T, class SIMDInterpolator>
+static void Bayer2Gray_( const Mat& srcmat, Mat& dstmat, int code )
+{
+    Range range(0, std::max(srcmat.rows - 2, 0));
+    Bayer2Gray_Invoker<T, SIMDInterpolator> body(srcmat, dstmat, code);
+    int nstripes = (int)std::min(srcmat.total()/CVTCOLOR_PARALLEL_MIN, (size_t)range.end);
+    if( nstripes > 1 )
+        parallel_for_(range, body, nstripes);
+    else
+        body(range);
+
+    int dst_step = (int)(dstmat.step/sizeof(T));
+    Size size = dstmat.size();
+    T* dst0 = (T*)dstmat.data;
     if( size.height > 2 )
         for( int i = 0; i < size.width; i++ )
         {
@@ -1988,115 +2242,148 @@ static void Bayer2Gray_( const Mat& srcmat, Mat& dstmat, int code )
 }
 
 template<typename T, class SIMDInterpolator>
-static void Bayer2RGB_( const Mat& srcmat, Mat& dstmat, int code )
+class Bayer2RGB_Invoker : public ParallelLoopBody
 {
-    SIMDInterpolator vecOp;
-    const T* bayer0 = (const T*)srcmat.data;
-    int bayer_step = (int)(srcmat.step/sizeof(T));
-    T* dst0 = (T*)dstmat.data;
-    int dst_step = (int)(dstmat.step/sizeof(T));
-    Size size = srcmat.size();
-    int blue = code == CV_BayerBG2BGR || code == CV_BayerGB2BGR ? -1 : 1;
-    int start_with_green = code == CV_BayerGB2BGR || code == CV_BayerGR2BGR;
-
-    dst0 += dst_step + 3 + 1;
-    size.height -= 2;
-    size.width -= 2;
-
-    for( ; size.height-- > 0; bayer0 += bayer_step, dst0 += dst_step )
+public:
+    Bayer2RGB_Invoker(const Mat& _srcmat, Mat& _dstmat, int _code) :
+        srcmat(_srcmat), dstmat(_dstmat), code(_code)
     {
-        int t0, t1;
-        const T* bayer = bayer0;
-        T* dst = dst0;
-        const T* bayer_end = bayer + size.width;
+    }
 
-        if( size.width <= 0 )
+    virtual void operator()(const Range& range) const
+    {
+        SIMDInterpolator vecOp;
+        int bayer_step = (int)(srcmat.step/sizeof(T));
+        int dst_step = (int)(dstmat.step/sizeof(T));
+        const T* bayer0 = (const T*)srcmat.data + bayer_step*range.start;
+        T* dst0 = (T*)dstmat.data + dst_step*range.start;
+        Size size = srcmat.size();
+        int blue = code == CV_BayerBG2BGR || code == CV_BayerGB2BGR ? -1 : 1;
+        int start_with_green = code == CV_BayerGB2BGR || code == CV_BayerGR2BGR;
+
+        // the pattern alternates from row to row
+        if( range.start % 2 != 0 )
         {
-            dst[-4] = dst[-3] = dst[-2] = dst[size.width*3-1] =
-            dst[size.width*3] = dst[size.width*3+1] = 0;
-            continue;
+            blue = -blue;
+            start_with_green = !start_with_green;
         }
 
-        if( start_with_green )
+        dst0 += dst_step + 3 + 1;
+        size.width -= 2;
+
+        for( int i = range.start; i < range.end; i++, bayer0 += bayer_step, dst0 += dst_step )
         {
-            t0 = (bayer[1] + bayer[bayer_step*2+1] + 1) >> 1;
-            t1 = (bayer[bayer_step] + bayer[bayer_step+2] + 1) >> 1;
-            dst[-blue] = (T)t0;
-            dst[0] = bayer[bayer_step+1];
-            dst[blue] = (T)t1;
-            bayer++;
-            dst += 3;
-        }
+            int t0, t1;
+            const T* bayer = bayer0;
+            T* dst = dst0;
+            const T* bayer_end = bayer + size.width;
 
-        int delta = vecOp.bayer2RGB(bayer, bayer_step, dst, size.width, blue);
-        bayer += delta;
-        dst += delta*3;
+            if( size.width <= 0 )
+            {
+                dst[-4] = dst[-3] = dst[-2] = dst[size.width*3-1] =
+                dst[size.width*3] = dst[size.width*3+1] = 0;
+                continue;
+            }
 
-        if( blue > 0 )
-        {
-            for( ; bayer <= bayer_end - 2; bayer += 2, dst += 6 )
+            if( start_with_green )
             {
-                t0 = (bayer[0] + bayer[2] + bayer[bayer_step*2] +
-                      bayer[bayer_step*2+2] + 2) >> 2;
-                t1 = (bayer[1] + bayer[bayer_step] +
-                      bayer[bayer_step+2] + bayer[bayer_step*2+1]+2) >> 2;
-                dst[-1] = (T)t0;
-                dst[0] = (T)t1;
-                dst[1] = bayer[bayer_step+1];
+                t0 = (bayer[1] + bayer[bayer_step*2+1] + 1) >> 1;
+                t1 = (bayer[bayer_step] + bayer[bayer_step+2] + 1) >> 1;
+                dst[-blue] = (T)t0;
+                dst[0] = bayer[bayer_step+1];
+                dst[blue] = (T)t1;
+                bayer++;
+                dst += 3;
+            }
 
-                t0 = (bayer[2] + bayer[bayer_step*2+2] + 1) >> 1;
-                t1 = (bayer[bayer_step+1] + bayer[bayer_step+3] + 1) >> 1;
-                dst[2] = (T)t0;
-                dst[3] = bayer[bayer_step+2];
-                dst[4] = (T)t1;
+            int delta = vecOp.bayer2RGB(bayer, bayer_step, dst, size.width, blue);
+            bayer += delta;
+            dst += delta*3;
+
+            if( blue > 0 )
+            {
+                for( ; bayer <= bayer_end - 2; bayer += 2, dst += 6 )
+                {
+                    t0 = (bayer[0] + bayer[2] + bayer[bayer_step*2] +
+                          bayer[bayer_step*2+2] + 2) >> 2;
+                    t1 = (bayer[1] + bayer[bayer_step] +
+                          bayer[bayer_step+2] + bayer[bayer_step*2+1]+2) >> 2;
+                    dst[-1] = (T)t0;
+                    dst[0] = (T)t1;
+                    dst[1] = bayer[bayer_step+1];
+
+                    t0 = (bayer[2] + bayer[bayer_step*2+2] + 1) >> 1;
+                    t1 = (bayer[bayer_step+1] + bayer[bayer_step+3] + 1) >> 1;
+                    dst[2] = (T)t0;
+                    dst[3] = bayer[bayer_step+2];
+                    dst[4] = (T)t1;
+                }
             }
-        }
-        else
-        {
-            for( ; bayer <= bayer_end - 2; bayer += 2, dst += 6 )
+            else
+            {
+                for( ; bayer <= bayer_end - 2; bayer += 2, dst += 6 )
+                {
+                    t0 = (bayer[0] + bayer[2] + bayer[bayer_step*2] +
+                          bayer[bayer_step*2+2] + 2) >> 2;
+                    t1 = (bayer[1] + bayer[bayer_step] +
+                          bayer[bayer_step+2] + bayer[bayer_step*2+1]+2) >> 2;
+                    dst[1] = (T)t0;
+                    dst[0] = (T)t1;
+                    dst[-1] = bayer[bayer_step+1];
+
+                    t0 = (bayer[2] + bayer[bayer_step*2+2] + 1) >> 1;
+                    t1 = (bayer[bayer_step+1] + bayer[bayer_step+3] + 1) >> 1;
+                    dst[4] = (T)t0;
+                    dst[3] = bayer[bayer_step+2];
+                    dst[2] = (T)t1;
+                }
+            }
+
+            if( bayer < bayer_end )
             {
                 t0 = (bayer[0] + bayer[2] + bayer[bayer_step*2] +
                       bayer[bayer_step*2+2] + 2) >> 2;
                 t1 = (bayer[1] + bayer[bayer_step] +
                       bayer[bayer_step+2] + bayer[bayer_step*2+1]+2) >> 2;
-                dst[1] = (T)t0;
+                dst[-blue] = (T)t0;
                 dst[0] = (T)t1;
-                dst[-1] = bayer[bayer_step+1];
-
-                t0 = (bayer[2] + bayer[bayer_step*2+2] + 1) >> 1;
-                t1 = (bayer[bayer_step+1] + bayer[bayer_step+3] + 1) >> 1;
-                dst[4] = (T)t0;
-                dst[3] = bayer[bayer_step+2];
-                dst[2] = (T)t1;
+                dst[blue] = bayer[bayer_step+1];
+                bayer++;
+                dst += 3;
             }
-        }
 
-        if( bayer < bayer_end )
-        {
-            t0 = (bayer[0] + bayer[2] + bayer[bayer_step*2] +
-                  bayer[bayer_step*2+2] + 2) >> 2;
-            t1 = (bayer[1] + bayer[bayer_step] +
-                  bayer[bayer_step+2] + bayer[bayer_step*2+1]+2) >> 2;
-            dst[-blue] = (T)t0;
-            dst[0] = (T)t1;
-            dst[blue] = bayer[bayer_step+1];
-            bayer++;
-            dst += 3;
+            dst0[-4] = dst0[-1];
+            dst0[-3] = dst0[0];
+            dst0[-2] = dst0[1];
+            dst0[size.width*3-1] = dst0[size.width*3-4];
+            dst0[size.width*3] = dst0[size.width*3-3];
+            dst0[size.width*3+1] = dst0[size.width*3-2];
+
+            blue = -blue;
+            start_with_green = !start_with_green;
         }
+    }
 
-        dst0[-4] = dst0[-1];
-        dst0[-3] = dst0[0];
-        dst0[-2] = dst0[1];
-        dst0[size.width*3-1] = dst0[size.width*3-4];
-        dst0[size.width*3] = dst0[size.width*3-3];
-        dst0[size.width*3+1] = dst0[size.width*3-2];
+private:
+    Mat srcmat;
+    Mat dstmat;
+    int code;
+};
 
-        blue = -blue;
-        start_with_green = !start_with_green;
-    }
+template<typename T, class SIMDInterpolator>
+static void Bayer2RGB_( const Mat& srcmat, Mat& dstmat, int code )
+{
+    Range range(0, std::max(srcmat.rows - 2, 0));
+    Bayer2RGB_Invoker<T, SIMDInterpolator> body(srcmat, dstmat, code);
+    int nstripes = (int)std::min(srcmat.total()/CVTCOLOR_PARALLEL_MIN, (size_t)range.end);
+    if( nstripes > 1 )
+        parallel_for_(range, body, nstripes);
+    else
+        body(range);
 
-    size = dstmat.size();
-    dst0 = (T*)dstmat.data;
+    int dst_step = (int)(dstmat.step/sizeof(T));
+    Size size = dstmat.size();
+    T* dst0 = (T*)dstmat.data;
     if( size.height > 2 )
         for( int i = 0; i < size.width*3; i++ )
         {
@@ -2113,548 +2400,589 @@ static void Bayer2RGB_( const Mat& srcmat, Mat& dstmat, int code )
 
 /////////////////// Demosaicing using Variable Number of Gradients ///////////////////////
 
-static void Bayer2RGB_VNG_8u( const Mat& srcmat, Mat& dstmat, int code )
+class Bayer2RGB_VNG_8u_Invoker : public ParallelLoopBody
 {
-    const uchar* bayer = srcmat.data;
-    int bstep = (int)srcmat.step;
-    uchar* dst = dstmat.data;
-    int dststep = (int)dstmat.step;
-    Size size = srcmat.size();
-
-    int blueIdx = code == CV_BayerBG2BGR_VNG || code == CV_BayerGB2BGR_VNG ? 0 : 2;
-    bool greenCell0 = code != CV_BayerBG2BGR_VNG && code != CV_BayerRG2BGR_VNG;
-
-    // for too small images use the simple interpolation algorithm
-    if( MIN(size.width, size.height) < 8 )
+public:
+    Bayer2RGB_VNG_8u_Invoker(const Mat& _srcmat, Mat& _dstmat, int _code) :
+        srcmat(_srcmat), dstmat(_dstmat), code(_code)
     {
-        Bayer2RGB_<uchar, SIMDBayerInterpolator_8u>( srcmat, dstmat, code );
-        return;
     }
 
-    const int brows = 3, bcn = 7;
-    int N = size.width, N2 = N*2, N3 = N*3, N4 = N*4, N5 = N*5, N6 = N*6, N7 = N*7;
-    int i, bufstep = N7*bcn;
-    cv::AutoBuffer<ushort> _buf(bufstep*brows);
-    ushort* buf = (ushort*)_buf;
+    // processes the rows [range.start, range.end) of the image with 2-pixel top margin;
+    // every stripe fills its own gradient buffer, starting one row above the stripe
+    virtual void operator()(const Range& range) const
+    {
+        const uchar* bayer = srcmat.data;
+        int bstep = (int)srcmat.step;
+        uchar* dst = dstmat.data;
+        int dststep = (int)dstmat.step;
+        Size size = srcmat.size();
+
+        int blueIdx = code == CV_BayerBG2BGR_VNG || code == CV_BayerGB2BGR_VNG ? 0 : 2;
+        bool greenCell0 = code != CV_BayerBG2BGR_VNG && code != CV_BayerRG2BGR_VNG;
+
+        // the pattern alternates from row to row
+        if( range.start % 2 != 0 )
+        {
+            greenCell0 = !greenCell0;
+            blueIdx ^= 2;
+        }
+
+        const int brows = 3, bcn = 7;
+        int N = size.width, N2 = N*2, N3 = N*3, N4 = N*4, N5 = N*5, N6 = N*6, N7 = N*7;
+        int i, bufstep = N7*bcn;
+        cv::AutoBuffer<ushort> _buf(bufstep*brows);
+        ushort* buf = (ushort*)_buf;
 
-    bayer += bstep*2;
+        bayer += bstep*2;
 
 #if CV_SSE2
-    bool haveSSE = cv::checkHardwareSupport(CV_CPU_SSE2);
-    #define _mm_absdiff_epu16(a,b) _mm_adds_epu16(_mm_subs_epu16(a, b), _mm_subs_epu16(b, a))
+        bool haveSSE = cv::checkHardwareSupport(CV_CPU_SSE2);
+        if( haveSSE )
+            CV_TRACE_SIMD(CV_CPU_SSE2);
+        #define _mm_absdiff_epu16(a,b) _mm_adds_epu16(_mm_subs_epu16(a, b), _mm_subs_epu16(b, a))
 #endif
 
-    for( int y = 2; y < size.height - 4; y++ )
-    {
-        uchar* dstrow = dst + dststep*y + 6;
-        const uchar* srow;
-
-        for( int dy = (y == 2 ? -1 : 1); dy <= 1; dy++ )
+        for( int y = range.start; y < range.end; y++ )
         {
-            ushort* brow = buf + ((y + dy - 1)%brows)*bufstep + 1;
-            srow = bayer + (y+dy)*bstep + 1;
+            uchar* dstrow = dst + dststep*y + 6;
+            const uchar* srow;
+
+            for( int dy = (y == range.start ? -1 : 1); dy <= 1; dy++ )
+            {
+                ushort* brow = buf + ((y + dy - 1)%brows)*bufstep + 1;
+                srow = bayer + (y+dy)*bstep + 1;
 
-            for( i = 0; i < bcn; i++ )
-                brow[N*i-1] = brow[(N-2) + N*i] = 0;
+                for( i = 0; i < bcn; i++ )
+                    brow[N*i-1] = brow[(N-2) + N*i] = 0;
 
-            i = 1;
+                i = 1;
 
 #if CV_SSE2
-            if( haveSSE )
-            {
-                __m128i z = _mm_setzero_si128();
-                for( ; i <= N-9; i += 8, srow += 8, brow += 8 )
+                if( haveSSE )
                 {
-                    __m128i s1, s2, s3, s4, s6, s7, s8, s9;
-
-                    s1 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-1-bstep)),z);
-                    s2 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-bstep)),z);
-                    s3 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+1-bstep)),z);
-
-                    s4 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-1)),z);
-                    s6 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+1)),z);
-
-                    s7 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-1+bstep)),z);
-                    s8 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+bstep)),z);
-                    s9 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+1+bstep)),z);
-
-                    __m128i b0, b1, b2, b3, b4, b5, b6;
-
-                    b0 = _mm_adds_epu16(_mm_slli_epi16(_mm_absdiff_epu16(s2,s8),1),
-                                        _mm_adds_epu16(_mm_absdiff_epu16(s1, s7),
-                                                       _mm_absdiff_epu16(s3, s9)));
-                    b1 = _mm_adds_epu16(_mm_slli_epi16(_mm_absdiff_epu16(s4,s6),1),
-                                        _mm_adds_epu16(_mm_absdiff_epu16(s1, s3),
-                                                       _mm_absdiff_epu16(s7, s9)));
-                    b2 = _mm_slli_epi16(_mm_absdiff_epu16(s3,s7),1);
-                    b3 = _mm_slli_epi16(_mm_absdiff_epu16(s1,s9),1);
-
-                    _mm_storeu_si128((__m128i*)brow, b0);
-                    _mm_storeu_si128((__m128i*)(brow + N), b1);
-                    _mm_storeu_si128((__m128i*)(brow + N2), b2);
-                    _mm_storeu_si128((__m128i*)(brow + N3), b3);
-
-                    b4 = _mm_adds_epu16(b2,_mm_adds_epu16(_mm_absdiff_epu16(s2, s4),
-                                                          _mm_absdiff_epu16(s6, s8)));
-                    b5 = _mm_adds_epu16(b3,_mm_adds_epu16(_mm_absdiff_epu16(s2, s6),
-                                                          _mm_absdiff_epu16(s4, s8)));
-                    b6 = _mm_adds_epu16(_mm_adds_epu16(s2, s4), _mm_adds_epu16(s6, s8));
-                    b6 = _mm_srli_epi16(b6, 1);
-
-                    _mm_storeu_si128((__m128i*)(brow + N4), b4);
-                    _mm_storeu_si128((__m128i*)(brow + N5), b5);
-                    _mm_storeu_si128((__m128i*)(brow + N6), b6);
+                    __m128i z = _mm_setzero_si128();
+                    for( ; i <= N-9; i += 8, srow += 8, brow += 8 )
+                    {
+                        __m128i s1, s2, s3, s4, s6, s7, s8, s9;
+
+                        s1 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-1-bstep)),z);
+                        s2 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-bstep)),z);
+                        s3 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+1-bstep)),z);
+
+                        s4 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-1)),z);
+                        s6 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+1)),z);
+
+                        s7 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-1+bstep)),z);
+                        s8 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+bstep)),z);
+                        s9 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+1+bstep)),z);
+
+                        __m128i b0, b1, b2, b3, b4, b5, b6;
+
+                        b0 = _mm_adds_epu16(_mm_slli_epi16(_mm_absdiff_epu16(s2,s8),1),
+                                            _mm_adds_epu16(_mm_absdiff_epu16(s1, s7),
+                                                           _mm_absdiff_epu16(s3, s9)));
+                        b1 = _mm_adds_epu16(_mm_slli_epi16(_mm_absdiff_epu16(s4,s6),1),
+                                            _mm_adds_epu16(_mm_absdiff_epu16(s1, s3),
+                                                           _mm_absdiff_epu16(s7, s9)));
+                        b2 = _mm_slli_epi16(_mm_absdiff_epu16(s3,s7),1);
+                        b3 = _mm_slli_epi16(_mm_absdiff_epu16(s1,s9),1);
+
+                        _mm_storeu_si128((__m128i*)brow, b0);
+                        _mm_storeu_si128((__m128i*)(brow + N), b1);
+                        _mm_storeu_si128((__m128i*)(brow + N2), b2);
+                        _mm_storeu_si128((__m128i*)(brow + N3), b3);
+
+                        b4 = _mm_adds_epu16(b2,_mm_adds_epu16(_mm_absdiff_epu16(s2, s4),
+                                                              _mm_absdiff_epu16(s6, s8)));
+                        b5 = _mm_adds_epu16(b3,_mm_adds_epu16(_mm_absdiff_epu16(s2, s6),
+                                                              _mm_absdiff_epu16(s4, s8)));
+                        b6 = _mm_adds_epu16(_mm_adds_epu16(s2, s4), _mm_adds_epu16(s6, s8));
+                        b6 = _mm_srli_epi16(b6, 1);
+
+                        _mm_storeu_si128((__m128i*)(brow + N4), b4);
+                        _mm_storeu_si128((__m128i*)(brow + N5), b5);
+                        _mm_storeu_si128((__m128i*)(brow + N6), b6);
+                    }
                 }
-            }
 #endif
 
-            for( ; i < N-1; i++, srow++, brow++ )
-            {
-                brow[0] = (ushort)(std::abs(srow[-1-bstep] - srow[-1+bstep]) +
-                                   std::abs(srow[-bstep] - srow[+bstep])*2 +
-                                   std::abs(srow[1-bstep] - srow[1+bstep]));
-                brow[N] = (ushort)(std::abs(srow[-1-bstep] - srow[1-bstep]) +
-                                   std::abs(srow[-1] - srow[1])*2 +
-                                   std::abs(srow[-1+bstep] - srow[1+bstep]));
-                brow[N2] = (ushort)(std::abs(srow[+1-bstep] - srow[-1+bstep])*2);
-                brow[N3] = (ushort)(std::abs(srow[-1-bstep] - srow[1+bstep])*2);
-                brow[N4] = (ushort)(brow[N2] + std::abs(srow[-bstep] - srow[-1]) +
-                                    std::abs(srow[+bstep] - srow[1]));
-                brow[N5] = (ushort)(brow[N3] + std::abs(srow[-bstep] - srow[1]) +
-                                    std::abs(srow[+bstep] - srow[-1]));
-                brow[N6] = (ushort)((srow[-bstep] + srow[-1] + srow[1] + srow[+bstep])>>1);
+                for( ; i < N-1; i++, srow++, brow++ )
+                {
+                    brow[0] = (ushort)(std::abs(srow[-1-bstep] - srow[-1+bstep]) +
+                                       std::abs(srow[-bstep] - srow[+bstep])*2 +
+                                       std::abs(srow[1-bstep] - srow[1+bstep]));
+                    brow[N] = (ushort)(std::abs(srow[-1-bstep] - srow[1-bstep]) +
+                                       std::abs(srow[-1] - srow[1])*2 +
+                                       std::abs(srow[-1+bstep] - srow[1+bstep]));
+                    brow[N2] = (ushort)(std::abs(srow[+1-bstep] - srow[-1+bstep])*2);
+                    brow[N3] = (ushort)(std::abs(srow[-1-bstep] - srow[1+bstep])*2);
+                    brow[N4] = (ushort)(brow[N2] + std::abs(srow[-bstep] - srow[-1]) +
+                                        std::abs(srow[+bstep] - srow[1]));
+                    brow[N5] = (ushort)(brow[N3] + std::abs(srow[-bstep] - srow[1]) +
+                                        std::abs(srow[+bstep] - srow[-1]));
+                    brow[N6] = (ushort)((srow[-bstep] + srow[-1] + srow[1] + srow[+bstep])>>1);
+                }
             }
-        }
 
-        const ushort* brow0 = buf + ((y - 2) % brows)*bufstep + 2;
-        const ushort* brow1 = buf + ((y - 1) % brows)*bufstep + 2;
-        const ushort* brow2 = buf + (y % brows)*bufstep + 2;
-        static const float scale[] = { 0.f, 0.5f, 0.25f, 0.1666666666667f, 0.125f, 0.1f, 0.08333333333f, 0.0714286f, 0.0625f };
-        srow = bayer + y*bstep + 2;
-        bool greenCell = greenCell0;
+            const ushort* brow0 = buf + ((y - 2) % brows)*bufstep + 2;
+            const ushort* brow1 = buf + ((y - 1) % brows)*bufstep + 2;
+            const ushort* brow2 = buf + (y % brows)*bufstep + 2;
+            static const float scale[] = { 0.f, 0.5f, 0.25f, 0.1666666666667f, 0.125f, 0.1f, 0.08333333333f, 0.0714286f, 0.0625f };
+            srow = bayer + y*bstep + 2;
+            bool greenCell = greenCell0;
 
-        i = 2;
+            i = 2;
 #if CV_SSE2
-        int limit = !haveSSE ? N-2 : greenCell ? std::min(3, N-2) : 2;
+            int limit = !haveSSE ? N-2 : greenCell ? std::min(3, N-2) : 2;
 #else
-        int limit = N - 2;
+            int limit = N - 2;
 #endif
 
-        do
-        {
-            for( ; i < limit; i++, srow++, brow0++, brow1++, brow2++, dstrow += 3 )
+            do
             {
-                int gradN = brow0[0] + brow1[0];
-                int gradS = brow1[0] + brow2[0];
-                int gradW = brow1[N-1] + brow1[N];
-                int gradE = brow1[N] + brow1[N+1];
-                int minGrad = std::min(std::min(std::min(gradN, gradS), gradW), gradE);
-                int maxGrad = std::max(std::max(std::max(gradN, gradS), gradW), gradE);
-                int R, G, B;
-
-                if( !greenCell )
+                for( ; i < limit; i++, srow++, brow0++, brow1++, brow2++, dstrow += 3 )
                 {
-                    int gradNE = brow0[N4+1] + brow1[N4];
-                    int gradSW = brow1[N4] + brow2[N4-1];
-                    int gradNW = brow0[N5-1] + brow1[N5];
-                    int gradSE = brow1[N5] + brow2[N5+1];
-
-                    minGrad = std::min(std::min(std::min(std::min(minGrad, gradNE), gradSW), gradNW), gradSE);
-                    maxGrad = std::max(std::max(std::max(std::max(maxGrad, gradNE), gradSW), gradNW), gradSE);
-                    int T = minGrad + maxGrad/2;
-
-                    int Rs = 0, Gs = 0, Bs = 0, ng = 0;
-                    if( gradN < T )
-                    {
-                        Rs += srow[-bstep*2] + srow[0];
-                        Gs += srow[-bstep]*2;
-                        Bs += srow[-bstep-1] + srow[-bstep+1];
-                        ng++;
-                    }
-                    if( gradS < T )
-                    {
-                        Rs += srow[bstep*2] + srow[0];
-                        Gs += srow[bstep]*2;
-                        Bs += srow[bstep-1] + srow[bstep+1];
-                        ng++;
-                    }
-                    if( gradW < T )
-                    {
-                        Rs += srow[-2] + srow[0];
-                        Gs += srow[-1]*2;
-                        Bs += srow[-bstep-1] + srow[bstep-1];
-                        ng++;
-                    }
-                    if( gradE < T )
+                    int gradN = brow0[0] + brow1[0];
+                    int gradS = brow1[0] + brow2[0];
+                    int gradW = brow1[N-1] + brow1[N];
+                    int gradE = brow1[N] + brow1[N+1];
+                    int minGrad = std::min(std::min(std::min(gradN, gradS), gradW), gradE);
+                    int maxGrad = std::max(std::max(std::max(gradN, gradS), gradW), gradE);
+                    int R, G, B;
+
+                    if( !greenCell )
                     {
-                        Rs += srow[2] + srow[0];
-                        Gs += srow[1]*2;
-                        Bs += srow[-bstep+1] + srow[bstep+1];
-                        ng++;
+                        int gradNE = brow0[N4+1] + brow1[N4];
+                        int gradSW = brow1[N4] + brow2[N4-1];
+                        int gradNW = brow0[N5-1] + brow1[N5];
+                        int gradSE = brow1[N5] + brow2[N5+1];
+
+                        minGrad = std::min(std::min(std::min(std::min(minGrad, gradNE), gradSW), gradNW), gradSE);
+                        maxGrad = std::max(std::max(std::max(std::max(maxGrad, gradNE), gradSW), gradNW), gradSE);
+                        int T = minGrad + maxGrad/2;
+
+                        int Rs = 0, Gs = 0, Bs = 0, ng = 0;
+                        if( gradN < T )
+                        {
+                            Rs += srow[-bstep*2] + srow[0];
+                            Gs += srow[-bstep]*2;
+                            Bs += srow[-bstep-1] + srow[-bstep+1];
+                            ng++;
+                        }
+                        if( gradS < T )
+                        {
+                            Rs += srow[bstep*2] + srow[0];
+                            Gs += srow[bstep]*2;
+                            Bs += srow[bstep-1] + srow[bstep+1];
+                            ng++;
+                        }
+                        if( gradW < T )
+                        {
+                            Rs += srow[-2] + srow[0];
+                            Gs += srow[-1]*2;
+                            Bs += srow[-bstep-1] + srow[bstep-1];
+                            ng++;
+                        }
+                        if( gradE < T )
+                        {
+                            Rs += srow[2] + srow[0];
+                            Gs += srow[1]*2;
+                            Bs += srow[-bstep+1] + srow[bstep+1];
+                            ng++;
+                        }
+                        if( gradNE < T )
+                        {
+                            Rs += srow[-bstep*2+2] + srow[0];
+                            Gs += brow0[N6+1];
+                            Bs += srow[-bstep+1]*2;
+                            ng++;
+                        }
+                        if( gradSW < T )
+                        {
+                            Rs += srow[bstep*2-2] + srow[0];
+                            Gs += brow2[N6-1];
+                            Bs += srow[bstep-1]*2;
+                            ng++;
+                        }
+                        if( gradNW < T )
+                        {
+                            Rs += srow[-bstep*2-2] + srow[0];
+                            Gs += brow0[N6-1];
+                            Bs += srow[-bstep+1]*2;
+                            ng++;
+                        }
+                        if( gradSE < T )
+                        {
+                            Rs += srow[bstep*2+2] + srow[0];
+                            Gs += brow2[N6+1];
+                            Bs += srow[-bstep+1]*2;
+                            ng++;
+                        }
+                        R = srow[0];
+                        G = R + cvRound((Gs - Rs)*scale[ng]);
+                        B = R + cvRound((Bs - Rs)*scale[ng]);
                     }
-                    if( gradNE < T )
+                    else
                     {
-                        Rs += srow[-bstep*2+2] + srow[0];
-                        Gs += brow0[N6+1];
-                        Bs += srow[-bstep+1]*2;
-                        ng++;
+                        int gradNE = brow0[N2] + brow0[N2+1] + brow1[N2] + brow1[N2+1];
+                        int gradSW = brow1[N2] + brow1[N2-1] + brow2[N2] + brow2[N2-1];
+                        int gradNW = brow0[N3] + brow0[N3-1] + brow1[N3] + brow1[N3-1];
+                        int gradSE = brow1[N3] + brow1[N3+1] + brow2[N3] + brow2[N3+1];
+
+                        minGrad = std::min(std::min(std::min(std::min(minGrad, gradNE), gradSW), gradNW), gradSE);
+                        maxGrad = std::max(std::max(std::max(std::max(maxGrad, gradNE), gradSW), gradNW), gradSE);
+                        int T = minGrad + maxGrad/2;
+
+                        int Rs = 0, Gs = 0, Bs = 0, ng = 0;
+                        if( gradN < T )
+                        {
+                            Rs += srow[-bstep*2-1] + srow[-bstep*2+1];
+                            Gs += srow[-bstep*2] + srow[0];
+                            Bs += srow[-bstep]*2;
+                            ng++;
+                        }
+                        if( gradS < T )
+                        {
+                            Rs += srow[bstep*2-1] + srow[bstep*2+1];
+                            Gs += srow[bstep*2] + srow[0];
+                            Bs += srow[bstep]*2;
+                            ng++;
+                        }
+                        if( gradW < T )
+                        {
+                            Rs += srow[-1]*2;
+                            Gs += srow[-2] + srow[0];
+                            Bs += srow[-bstep-2]+srow[bstep-2];
+                            ng++;
+                        }
+                        if( gradE < T )
+                        {
+                            Rs += srow[1]*2;
+                            Gs += srow[2] + srow[0];
+                            Bs += srow[-bstep+2]+srow[bstep+2];
+                            ng++;
+                        }
+                        if( gradNE < T )
+                        {
+                            Rs += srow[-bstep*2+1] + srow[1];
+                            Gs += srow[-bstep+1]*2;
+                            Bs += srow[-bstep] + srow[-bstep+2];
+                            ng++;
+                        }
+                        if( gradSW < T )
+                        {
+                            Rs += srow[bstep*2-1] + srow[-1];
+                            Gs += srow[bstep-1]*2;
+                            Bs += srow[bstep] + srow[bstep-2];
+                            ng++;
+                        }
+                        if( gradNW < T )
+                        {
+                            Rs += srow[-bstep*2-1] + srow[-1];
+                            Gs += srow[-bstep-1]*2;
+                            Bs += srow[-bstep-2]+srow[-bstep];
+                            ng++;
+                        }
+                        if( gradSE < T )
+                        {
+                            Rs += srow[bstep*2+1] + srow[1];
+                            Gs += srow[bstep+1]*2;
+                            Bs += srow[bstep+2]+srow[bstep];
+                            ng++;
+                        }
+                        G = srow[0];
+                        R = G + cvRound((Rs - Gs)*scale[ng]);
+                        B = G + cvRound((Bs - Gs)*scale[ng]);
                     }
-                    if( gradSW < T )
-                    {
-                        Rs += srow[bstep*2-2] + srow[0];
-                        Gs += brow2[N6-1];
-                        Bs += srow[bstep-1]*2;
-                        ng++;
-                    }
-                    if( gradNW < T )
-                    {
-                        Rs += srow[-bstep*2-2] + srow[0];
-                        Gs += brow0[N6-1];
-                        Bs += srow[-bstep+1]*2;
-                        ng++;
-                    }
-                    if( gradSE < T )
-                    {
-                        Rs += srow[bstep*2+2] + srow[0];
-                        Gs += brow2[N6+1];
-                        Bs += srow[-bstep+1]*2;
-                        ng++;
-                    }
-                    R = srow[0];
-                    G = R + cvRound((Gs - Rs)*scale[ng]);
-                    B = R + cvRound((Bs - Rs)*scale[ng]);
+                    dstrow[blueIdx] = CV_CAST_8U(B);
+                    dstrow[1] = CV_CAST_8U(G);
+                    dstrow[blueIdx^2] = CV_CAST_8U(R);
+                    greenCell = !greenCell;
                 }
-                else
-                {
-                    int gradNE = brow0[N2] + brow0[N2+1] + brow1[N2] + brow1[N2+1];
-                    int gradSW = brow1[N2] + brow1[N2-1] + brow2[N2] + brow2[N2-1];
-                    int gradNW = brow0[N3] + brow0[N3-1] + brow1[N3] + brow1[N3-1];
-                    int gradSE = brow1[N3] + brow1[N3+1] + brow2[N3] + brow2[N3+1];
 
-                    minGrad = std::min(std::min(std::min(std::min(minGrad, gradNE), gradSW), gradNW), gradSE);
-                    maxGrad = std::max(std::max(std::max(std::max(maxGrad, gradNE), gradSW), gradNW), gradSE);
-                    int T = minGrad + maxGrad/2;
+#if CV_SSE2
+                if( !haveSSE )
+                    break;
 
-                    int Rs = 0, Gs = 0, Bs = 0, ng = 0;
-                    if( gradN < T )
-                    {
-                        Rs += srow[-bstep*2-1] + srow[-bstep*2+1];
-                        Gs += srow[-bstep*2] + srow[0];
-                        Bs += srow[-bstep]*2;
-                        ng++;
-                    }
-                    if( gradS < T )
-                    {
-                        Rs += srow[bstep*2-1] + srow[bstep*2+1];
-                        Gs += srow[bstep*2] + srow[0];
-                        Bs += srow[bstep]*2;
-                        ng++;
-                    }
-                    if( gradW < T )
-                    {
-                        Rs += srow[-1]*2;
-                        Gs += srow[-2] + srow[0];
-                        Bs += srow[-bstep-2]+srow[bstep-2];
-                        ng++;
-                    }
-                    if( gradE < T )
-                    {
-                        Rs += srow[1]*2;
-                        Gs += srow[2] + srow[0];
-                        Bs += srow[-bstep+2]+srow[bstep+2];
-                        ng++;
-                    }
-                    if( gradNE < T )
-                    {
-                        Rs += srow[-bstep*2+1] + srow[1];
-                        Gs += srow[-bstep+1]*2;
-                        Bs += srow[-bstep] + srow[-bstep+2];
-                        ng++;
-                    }
-                    if( gradSW < T )
-                    {
-                        Rs += srow[bstep*2-1] + srow[-1];
-                        Gs += srow[bstep-1]*2;
-                        Bs += srow[bstep] + srow[bstep-2];
-                        ng++;
-                    }
-                    if( gradNW < T )
-                    {
-                        Rs += srow[-bstep*2-1] + srow[-1];
-                        Gs += srow[-bstep-1]*2;
-                        Bs += srow[-bstep-2]+srow[-bstep];
-                        ng++;
-                    }
-                    if( gradSE < T )
+                __m128i emask    = _mm_set1_epi32(0x0000ffff),
+                        omask    = _mm_set1_epi32(0xffff0000),
+                        z        = _mm_setzero_si128();
+                __m128 _0_5      = _mm_set1_ps(0.5f);
+
+                #define _mm_merge_epi16(a, b) _mm_or_si128(_mm_and_si128(a, emask), _mm_and_si128(b, omask)) //(aA_aA_aA_aA) * (bB_bB_bB_bB) => (bA_bA_bA_bA)
+                #define _mm_cvtloepi16_ps(a)  _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(a,a), 16))   //(1,2,3,4,5,6,7,8) => (1f,2f,3f,4f)
+                #define _mm_cvthiepi16_ps(a)  _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(a,a), 16))   //(1,2,3,4,5,6,7,8) => (5f,6f,7f,8f)
+                #define _mm_loadl_u8_s16(ptr, offset) _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)((ptr) + (offset))), z) //load 8 uchars to 8 shorts
+
+                // process 8 pixels at once
+                for( ; i <= N - 10; i += 8, srow += 8, brow0 += 8, brow1 += 8, brow2 += 8 )
+                {
+                    //int gradN = brow0[0] + brow1[0];
+                    __m128i gradN = _mm_adds_epi16(_mm_loadu_si128((__m128i*)brow0), _mm_loadu_si128((__m128i*)brow1));
+
+                    //int gradS = brow1[0] + brow2[0];
+                    __m128i gradS = _mm_adds_epi16(_mm_loadu_si128((__m128i*)brow1), _mm_loadu_si128((__m128i*)brow2));
+
+                    //int gradW = brow1[N-1] + brow1[N];
+                    __m128i gradW = _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow1+N-1)), _mm_loadu_si128((__m128i*)(brow1+N)));
+
+                    //int gradE = brow1[N+1] + brow1[N];
+                    __m128i gradE = _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow1+N+1)), _mm_loadu_si128((__m128i*)(brow1+N)));
+
+                    //int minGrad = std::min(std::min(std::min(gradN, gradS), gradW), gradE);
+                    //int maxGrad = std::max(std::max(std::max(gradN, gradS), gradW), gradE);
+                    __m128i minGrad = _mm_min_epi16(_mm_min_epi16(gradN, gradS), _mm_min_epi16(gradW, gradE));
+                    __m128i maxGrad = _mm_max_epi16(_mm_max_epi16(gradN, gradS), _mm_max_epi16(gradW, gradE));
+
+                    __m128i grad0, grad1;
+
+                    //int gradNE = brow0[N4+1] + brow1[N4];
+                    //int gradNE = brow0[N2] + brow0[N2+1] + brow1[N2] + brow1[N2+1];
+                    grad0 = _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow0+N4+1)), _mm_loadu_si128((__m128i*)(brow1+N4)));
+                    grad1 = _mm_adds_epi16( _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow0+N2)), _mm_loadu_si128((__m128i*)(brow0+N2+1))),
+                                            _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow1+N2)), _mm_loadu_si128((__m128i*)(brow1+N2+1))));
+                    __m128i gradNE = _mm_merge_epi16(grad0, grad1);
+
+                    //int gradSW = brow1[N4] + brow2[N4-1];
+                    //int gradSW = brow1[N2] + brow1[N2-1] + brow2[N2] + brow2[N2-1];
+                    grad0 = _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow2+N4-1)), _mm_loadu_si128((__m128i*)(brow1+N4)));
+                    grad1 = _mm_adds_epi16(_mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow2+N2)), _mm_loadu_si128((__m128i*)(brow2+N2-1))),
+                                           _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow1+N2)), _mm_loadu_si128((__m128i*)(brow1+N2-1))));
+                    __m128i gradSW = _mm_merge_epi16(grad0, grad1);
+
+                    minGrad = _mm_min_epi16(_mm_min_epi16(minGrad, gradNE), gradSW);
+                    maxGrad = _mm_max_epi16(_mm_max_epi16(maxGrad, gradNE), gradSW);
+
+                    //int gradNW = brow0[N5-1] + brow1[N5];
+                    //int gradNW = brow0[N3] + brow0[N3-1] + brow1[N3] + brow1[N3-1];
+                    grad0 = _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow0+N5-1)), _mm_loadu_si128((__m128i*)(brow1+N5)));
+                    grad1 = _mm_adds_epi16(_mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow0+N3)), _mm_loadu_si128((__m128i*)(brow0+N3-1))),
+                                           _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow1+N3)), _mm_loadu_si128((__m128i*)(brow1+N3-1))));
+                    __m128i gradNW = _mm_merge_epi16(grad0, grad1);
+
+                    //int gradSE = brow1[N5] + brow2[N5+1];
+                    //int gradSE = brow1[N3] + brow1[N3+1] + brow2[N3] + brow2[N3+1];
+                    grad0 = _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow2+N5+1)), _mm_loadu_si128((__m128i*)(brow1+N5)));
+                    grad1 = _mm_adds_epi16(_mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow2+N3)), _mm_loadu_si128((__m128i*)(brow2+N3+1))),
+                                           _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow1+N3)), _mm_loadu_si128((__m128i*)(brow1+N3+1))));
+                    __m128i gradSE = _mm_merge_epi16(grad0, grad1);
+
+                    minGrad = _mm_min_epi16(_mm_min_epi16(minGrad, gradNW), gradSE);
+                    maxGrad = _mm_max_epi16(_mm_max_epi16(maxGrad, gradNW), gradSE);
+
+                    //int T = minGrad + maxGrad/2;
+                    __m128i T = _mm_adds_epi16(_mm_srli_epi16(maxGrad, 1), minGrad);
+
+                    __m128i RGs = z, GRs = z, Bs = z, ng = z;
+
+                    __m128i x0  = _mm_loadl_u8_s16(srow, +0          );
+                    __m128i x1  = _mm_loadl_u8_s16(srow, -1 - bstep  );
+                    __m128i x2  = _mm_loadl_u8_s16(srow, -1 - bstep*2);
+                    __m128i x3  = _mm_loadl_u8_s16(srow,    - bstep  );
+                    __m128i x4  = _mm_loadl_u8_s16(srow, +1 - bstep*2);
+                    __m128i x5  = _mm_loadl_u8_s16(srow, +1 - bstep  );
+                    __m128i x6  = _mm_loadl_u8_s16(srow, +2 - bstep  );
+                    __m128i x7  = _mm_loadl_u8_s16(srow, +1          );
+                    __m128i x8  = _mm_loadl_u8_s16(srow, +2 + bstep  );
+                    __m128i x9  = _mm_loadl_u8_s16(srow, +1 + bstep  );
+                    __m128i x10 = _mm_loadl_u8_s16(srow, +1 + bstep*2);
+                    __m128i x11 = _mm_loadl_u8_s16(srow,    + bstep  );
+                    __m128i x12 = _mm_loadl_u8_s16(srow, -1 + bstep*2);
+                    __m128i x13 = _mm_loadl_u8_s16(srow, -1 + bstep  );
+                    __m128i x14 = _mm_loadl_u8_s16(srow, -2 + bstep  );
+                    __m128i x15 = _mm_loadl_u8_s16(srow, -1          );
+                    __m128i x16 = _mm_loadl_u8_s16(srow, -2 - bstep  );
+
+                    __m128i t0, t1, mask;
+
+                    // gradN ***********************************************
+                    mask = _mm_cmpgt_epi16(T, gradN); // mask = T>gradN
+                    ng = _mm_sub_epi16(ng, mask);     // ng += (T>gradN)
+
+                    t0 = _mm_slli_epi16(x3, 1);                                 // srow[-bstep]*2
+                    t1 = _mm_adds_epi16(_mm_loadl_u8_s16(srow, -bstep*2), x0);  // srow[-bstep*2] + srow[0]
+
+                    // RGs += (srow[-bstep*2] + srow[0]) * (T>gradN)
+                    RGs = _mm_adds_epi16(RGs, _mm_and_si128(t1, mask));
+                    // GRs += {srow[-bstep]*2; (srow[-bstep*2-1] + srow[-bstep*2+1])} * (T>gradN)
+                    GRs = _mm_adds_epi16(GRs, _mm_and_si128(_mm_merge_epi16(t0, _mm_adds_epi16(x2,x4)), mask));
+                    // Bs  += {(srow[-bstep-1]+srow[-bstep+1]); srow[-bstep]*2 } * (T>gradN)
+                    Bs  = _mm_adds_epi16(Bs, _mm_and_si128(_mm_merge_epi16(_mm_adds_epi16(x1,x5), t0), mask));
+
+                    // gradNE **********************************************
+                    mask = _mm_cmpgt_epi16(T, gradNE); // mask = T>gradNE
+                    ng = _mm_sub_epi16(ng, mask);      // ng += (T>gradNE)
+
+                    t0 = _mm_slli_epi16(x5, 1);                                    // srow[-bstep+1]*2
+                    t1 = _mm_adds_epi16(_mm_loadl_u8_s16(srow, -bstep*2+2), x0);   // srow[-bstep*2+2] + srow[0]
+
+                    // RGs += {(srow[-bstep*2+2] + srow[0]); srow[-bstep+1]*2} * (T>gradNE)
+                    RGs = _mm_adds_epi16(RGs, _mm_and_si128(_mm_merge_epi16(t1, t0), mask));
+                    // GRs += {brow0[N6+1]; (srow[-bstep*2+1] + srow[1])} * (T>gradNE)
+                    GRs = _mm_adds_epi16(GRs, _mm_and_si128(_mm_merge_epi16(_mm_loadu_si128((__m128i*)(brow0+N6+1)), _mm_adds_epi16(x4,x7)), mask));
+                    // Bs  += {srow[-bstep+1]*2; (srow[-bstep] + srow[-bstep+2])}  * (T>gradNE)
+                    Bs  = _mm_adds_epi16(Bs, _mm_and_si128(_mm_merge_epi16(t0,_mm_adds_epi16(x3,x6)), mask));
+
+                    // gradE ***********************************************
+                    mask = _mm_cmpgt_epi16(T, gradE);  // mask = T>gradE
+                    ng = _mm_sub_epi16(ng, mask);      // ng += (T>gradE)
+
+                    t0 = _mm_slli_epi16(x7, 1);                         // srow[1]*2
+                    t1 = _mm_adds_epi16(_mm_loadl_u8_s16(srow, 2), x0); // srow[2] + srow[0]
+
+                    // RGs += (srow[2] + srow[0]) * (T>gradE)
+                    RGs = _mm_adds_epi16(RGs, _mm_and_si128(t1, mask));
+                    // GRs += (srow[1]*2) * (T>gradE)
+                    GRs = _mm_adds_epi16(GRs, _mm_and_si128(t0, mask));
+                    // Bs  += {(srow[-bstep+1]+srow[bstep+1]); (srow[-bstep+2]+srow[bstep+2])} * (T>gradE)
+                    Bs  = _mm_adds_epi16(Bs, _mm_and_si128(_mm_merge_epi16(_mm_adds_epi16(x5,x9), _mm_adds_epi16(x6,x8)), mask));
+
+                    // gradSE **********************************************
+                    mask = _mm_cmpgt_epi16(T, gradSE);  // mask = T>gradSE
+                    ng = _mm_sub_epi16(ng, mask);       // ng += (T>gradSE)
+
+                    t0 = _mm_slli_epi16(x9, 1);                                 // srow[bstep+1]*2
+                    t1 = _mm_adds_epi16(_mm_loadl_u8_s16(srow, bstep*2+2), x0); // srow[bstep*2+2] + srow[0]
+
+                    // RGs += {(srow[bstep*2+2] + srow[0]); srow[bstep+1]*2} * (T>gradSE)
+                    RGs = _mm_adds_epi16(RGs, _mm_and_si128(_mm_merge_epi16(t1, t0), mask));
+                    // GRs += {brow2[N6+1]; (srow[1]+srow[bstep*2+1])} * (T>gradSE)
+                    GRs = _mm_adds_epi16(GRs, _mm_and_si128(_mm_merge_epi16(_mm_loadu_si128((__m128i*)(brow2+N6+1)), _mm_adds_epi16(x7,x10)), mask));
+                    // Bs  += {srow[-bstep+1]*2; (srow[bstep+2]+srow[bstep])} * (T>gradSE)
+                    Bs  = _mm_adds_epi16(Bs, _mm_and_si128(_mm_merge_epi16(_mm_slli_epi16(x5, 1), _mm_adds_epi16(x8,x11)), mask));
+
+                    // gradS ***********************************************
+                    mask = _mm_cmpgt_epi16(T, gradS);  // mask = T>gradS
+                    ng = _mm_sub_epi16(ng, mask);      // ng += (T>gradS)
+
+                    t0 = _mm_slli_epi16(x11, 1);                             // srow[bstep]*2
+                    t1 = _mm_adds_epi16(_mm_loadl_u8_s16(srow,bstep*2), x0); // srow[bstep*2]+srow[0]
+
+                    // RGs += (srow[bstep*2]+srow[0]) * (T>gradS)
+                    RGs = _mm_adds_epi16(RGs, _mm_and_si128(t1, mask));
+                    // GRs += {srow[bstep]*2; (srow[bstep*2+1]+srow[bstep*2-1])} * (T>gradS)
+                    GRs = _mm_adds_epi16(GRs, _mm_and_si128(_mm_merge_epi16(t0, _mm_adds_epi16(x10,x12)), mask));
+                    // Bs  += {(srow[bstep+1]+srow[bstep-1]); srow[bstep]*2} * (T>gradS)
+                    Bs  = _mm_adds_epi16(Bs, _mm_and_si128(_mm_merge_epi16(_mm_adds_epi16(x9,x13), t0), mask));
+
+                    // gradSW **********************************************
+                    mask = _mm_cmpgt_epi16(T, gradSW);  // mask = T>gradSW
+                    ng = _mm_sub_epi16(ng, mask);       // ng += (T>gradSW)
+
+                    t0 = _mm_slli_epi16(x13, 1);                                // srow[bstep-1]*2
+                    t1 = _mm_adds_epi16(_mm_loadl_u8_s16(srow, bstep*2-2), x0); // srow[bstep*2-2]+srow[0]
+
+                    // RGs += {(srow[bstep*2-2]+srow[0]); srow[bstep-1]*2} * (T>gradSW)
+                    RGs = _mm_adds_epi16(RGs, _mm_and_si128(_mm_merge_epi16(t1, t0), mask));
+                    // GRs += {brow2[N6-1]; (srow[bstep*2-1]+srow[-1])} * (T>gradSW)
+                    GRs = _mm_adds_epi16(GRs, _mm_and_si128(_mm_merge_epi16(_mm_loadu_si128((__m128i*)(brow2+N6-1)), _mm_adds_epi16(x12,x15)), mask));
+                    // Bs  += {srow[bstep-1]*2; (srow[bstep]+srow[bstep-2])} * (T>gradSW)
+                    Bs  = _mm_adds_epi16(Bs, _mm_and_si128(_mm_merge_epi16(t0,_mm_adds_epi16(x11,x14)), mask));
+
+                    // gradW ***********************************************
+                    mask = _mm_cmpgt_epi16(T, gradW);  // mask = T>gradW
+                    ng = _mm_sub_epi16(ng, mask);      // ng += (T>gradW)
+
+                    t0 = _mm_slli_epi16(x15, 1);                         // srow[-1]*2
+                    t1 = _mm_adds_epi16(_mm_loadl_u8_s16(srow, -2), x0); // srow[-2]+srow[0]
+
+                    // RGs += (srow[-2]+srow[0]) * (T>gradW)
+                    RGs = _mm_adds_epi16(RGs, _mm_and_si128(t1, mask));
+                    // GRs += (srow[-1]*2) * (T>gradW)
+                    GRs = _mm_adds_epi16(GRs, _mm_and_si128(t0, mask));
+                    // Bs  += {(srow[-bstep-1]+srow[bstep-1]); (srow[bstep-2]+srow[-bstep-2])} * (T>gradW)
+                    Bs  = _mm_adds_epi16(Bs, _mm_and_si128(_mm_merge_epi16(_mm_adds_epi16(x1,x13), _mm_adds_epi16(x14,x16)), mask));
+
+                    // gradNW **********************************************
+                    mask = _mm_cmpgt_epi16(T, gradNW);  // mask = T>gradNW
+                    ng = _mm_sub_epi16(ng, mask);       // ng += (T>gradNW)
+
+                    t0 = _mm_slli_epi16(x1, 1);                                 // srow[-bstep-1]*2
+                    t1 = _mm_adds_epi16(_mm_loadl_u8_s16(srow,-bstep*2-2), x0); // srow[-bstep*2-2]+srow[0]
+
+                    // RGs += {(srow[-bstep*2-2]+srow[0]); srow[-bstep-1]*2} * (T>gradNW)
+                    RGs = _mm_adds_epi16(RGs, _mm_and_si128(_mm_merge_epi16(t1, t0), mask));
+                    // GRs += {brow0[N6-1]; (srow[-bstep*2-1]+srow[-1])} * (T>gradNW)
+                    GRs = _mm_adds_epi16(GRs, _mm_and_si128(_mm_merge_epi16(_mm_loadu_si128((__m128i*)(brow0+N6-1)), _mm_adds_epi16(x2,x15)), mask));
+                    // Bs  += {srow[-bstep-1]*2; (srow[-bstep]+srow[-bstep-2])} * (T>gradNW)
+                    Bs  = _mm_adds_epi16(Bs, _mm_and_si128(_mm_merge_epi16(_mm_slli_epi16(x5, 1),_mm_adds_epi16(x3,x16)), mask));
+
+                    __m128 ngf0, ngf1;
+                    ngf0 = _mm_div_ps(_0_5, _mm_cvtloepi16_ps(ng));
+                    ngf1 = _mm_div_ps(_0_5, _mm_cvthiepi16_ps(ng));
+
+                    // now interpolate r, g & b
+                    t0 = _mm_sub_epi16(GRs, RGs);
+                    t1 = _mm_sub_epi16(Bs, RGs);
+
+                    t0 = _mm_add_epi16(x0, _mm_packs_epi32(
+                                                           _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtloepi16_ps(t0), ngf0)),
+                                                           _mm_cvtps_epi32(_mm_mul_ps(_mm_cvthiepi16_ps(t0), ngf1))));
+
+                    t1 = _mm_add_epi16(x0, _mm_packs_epi32(
+                                                           _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtloepi16_ps(t1), ngf0)),
+                                                           _mm_cvtps_epi32(_mm_mul_ps(_mm_cvthiepi16_ps(t1), ngf1))));
+
+                    x1 = _mm_merge_epi16(x0, t0);
+                    x2 = _mm_merge_epi16(t0, x0);
+
+                    uchar R[8], G[8], B[8];
+
+                    _mm_storel_epi64(blueIdx ? (__m128i*)B : (__m128i*)R, _mm_packus_epi16(x1, z));
+                    _mm_storel_epi64((__m128i*)G, _mm_packus_epi16(x2, z));
+                    _mm_storel_epi64(blueIdx ? (__m128i*)R : (__m128i*)B, _mm_packus_epi16(t1, z));
+
+                    for( int j = 0; j < 8; j++, dstrow += 3 )
                     {
-                        Rs += srow[bstep*2+1] + srow[1];
-                        Gs += srow[bstep+1]*2;
-                        Bs += srow[bstep+2]+srow[bstep];
-                        ng++;
+                        dstrow[0] = B[j]; dstrow[1] = G[j]; dstrow[2] = R[j];
                     }
-                    G = srow[0];
-                    R = G + cvRound((Rs - Gs)*scale[ng]);
-                    B = G + cvRound((Bs - Gs)*scale[ng]);
                 }
-                dstrow[blueIdx] = CV_CAST_8U(B);
-                dstrow[1] = CV_CAST_8U(G);
-                dstrow[blueIdx^2] = CV_CAST_8U(R);
-                greenCell = !greenCell;
+#endif
+
+                limit = N - 2;
             }
+            while( i < N - 2 );
 
-#if CV_SSE2
-            if( !haveSSE )
-                break;
-
-            __m128i emask    = _mm_set1_epi32(0x0000ffff),
-                    omask    = _mm_set1_epi32(0xffff0000),
-                    z        = _mm_setzero_si128();
-            __m128 _0_5      = _mm_set1_ps(0.5f);
-
-            #define _mm_merge_epi16(a, b) _mm_or_si128(_mm_and_si128(a, emask), _mm_and_si128(b, omask)) //(aA_aA_aA_aA) * (bB_bB_bB_bB) => (bA_bA_bA_bA)
-            #define _mm_cvtloepi16_ps(a)  _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(a,a), 16))   //(1,2,3,4,5,6,7,8) => (1f,2f,3f,4f)
-            #define _mm_cvthiepi16_ps(a)  _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(a,a), 16))   //(1,2,3,4,5,6,7,8) => (5f,6f,7f,8f)
-            #define _mm_loadl_u8_s16(ptr, offset) _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)((ptr) + (offset))), z) //load 8 uchars to 8 shorts
-
-            // process 8 pixels at once
-            for( ; i <= N - 10; i += 8, srow += 8, brow0 += 8, brow1 += 8, brow2 += 8 )
-            {
-                //int gradN = brow0[0] + brow1[0];
-                __m128i gradN = _mm_adds_epi16(_mm_loadu_si128((__m128i*)brow0), _mm_loadu_si128((__m128i*)brow1));
-
-                //int gradS = brow1[0] + brow2[0];
-                __m128i gradS = _mm_adds_epi16(_mm_loadu_si128((__m128i*)brow1), _mm_loadu_si128((__m128i*)brow2));
-
-                //int gradW = brow1[N-1] + brow1[N];
-                __m128i gradW = _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow1+N-1)), _mm_loadu_si128((__m128i*)(brow1+N)));
-
-                //int gradE = brow1[N+1] + brow1[N];
-                __m128i gradE = _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow1+N+1)), _mm_loadu_si128((__m128i*)(brow1+N)));
-
-                //int minGrad = std::min(std::min(std::min(gradN, gradS), gradW), gradE);
-                //int maxGrad = std::max(std::max(std::max(gradN, gradS), gradW), gradE);
-                __m128i minGrad = _mm_min_epi16(_mm_min_epi16(gradN, gradS), _mm_min_epi16(gradW, gradE));
-                __m128i maxGrad = _mm_max_epi16(_mm_max_epi16(gradN, gradS), _mm_max_epi16(gradW, gradE));
-
-                __m128i grad0, grad1;
-
-                //int gradNE = brow0[N4+1] + brow1[N4];
-                //int gradNE = brow0[N2] + brow0[N2+1] + brow1[N2] + brow1[N2+1];
-                grad0 = _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow0+N4+1)), _mm_loadu_si128((__m128i*)(brow1+N4)));
-                grad1 = _mm_adds_epi16( _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow0+N2)), _mm_loadu_si128((__m128i*)(brow0+N2+1))),
-                                        _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow1+N2)), _mm_loadu_si128((__m128i*)(brow1+N2+1))));
-                __m128i gradNE = _mm_merge_epi16(grad0, grad1);
-
-                //int gradSW = brow1[N4] + brow2[N4-1];
-                //int gradSW = brow1[N2] + brow1[N2-1] + brow2[N2] + brow2[N2-1];
-                grad0 = _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow2+N4-1)), _mm_loadu_si128((__m128i*)(brow1+N4)));
-                grad1 = _mm_adds_epi16(_mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow2+N2)), _mm_loadu_si128((__m128i*)(brow2+N2-1))),
-                                       _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow1+N2)), _mm_loadu_si128((__m128i*)(brow1+N2-1))));
-                __m128i gradSW = _mm_merge_epi16(grad0, grad1);
-
-                minGrad = _mm_min_epi16(_mm_min_epi16(minGrad, gradNE), gradSW);
-                maxGrad = _mm_max_epi16(_mm_max_epi16(maxGrad, gradNE), gradSW);
-
-                //int gradNW = brow0[N5-1] + brow1[N5];
-                //int gradNW = brow0[N3] + brow0[N3-1] + brow1[N3] + brow1[N3-1];
-                grad0 = _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow0+N5-1)), _mm_loadu_si128((__m128i*)(brow1+N5)));
-                grad1 = _mm_adds_epi16(_mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow0+N3)), _mm_loadu_si128((__m128i*)(brow0+N3-1))),
-                                       _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow1+N3)), _mm_loadu_si128((__m128i*)(brow1+N3-1))));
-                __m128i gradNW = _mm_merge_epi16(grad0, grad1);
-
-                //int gradSE = brow1[N5] + brow2[N5+1];
-                //int gradSE = brow1[N3] + brow1[N3+1] + brow2[N3] + brow2[N3+1];
-                grad0 = _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow2+N5+1)), _mm_loadu_si128((__m128i*)(brow1+N5)));
-                grad1 = _mm_adds_epi16(_mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow2+N3)), _mm_loadu_si128((__m128i*)(brow2+N3+1))),
-                                       _mm_adds_epi16(_mm_loadu_si128((__m128i*)(brow1+N3)), _mm_loadu_si128((__m128i*)(brow1+N3+1))));
-                __m128i gradSE = _mm_merge_epi16(grad0, grad1);
-
-                minGrad = _mm_min_epi16(_mm_min_epi16(minGrad, gradNW), gradSE);
-                maxGrad = _mm_max_epi16(_mm_max_epi16(maxGrad, gradNW), gradSE);
-
-                //int T = minGrad + maxGrad/2;
-                __m128i T = _mm_adds_epi16(_mm_srli_epi16(maxGrad, 1), minGrad);
-
-                __m128i RGs = z, GRs = z, Bs = z, ng = z;
-
-                __m128i x0  = _mm_loadl_u8_s16(srow, +0          );
-                __m128i x1  = _mm_loadl_u8_s16(srow, -1 - bstep  );
-                __m128i x2  = _mm_loadl_u8_s16(srow, -1 - bstep*2);
-                __m128i x3  = _mm_loadl_u8_s16(srow,    - bstep  );
-                __m128i x4  = _mm_loadl_u8_s16(srow, +1 - bstep*2);
-                __m128i x5  = _mm_loadl_u8_s16(srow, +1 - bstep  );
-                __m128i x6  = _mm_loadl_u8_s16(srow, +2 - bstep  );
-                __m128i x7  = _mm_loadl_u8_s16(srow, +1          );
-                __m128i x8  = _mm_loadl_u8_s16(srow, +2 + bstep  );
-                __m128i x9  = _mm_loadl_u8_s16(srow, +1 + bstep  );
-                __m128i x10 = _mm_loadl_u8_s16(srow, +1 + bstep*2);
-                __m128i x11 = _mm_loadl_u8_s16(srow,    + bstep  );
-                __m128i x12 = _mm_loadl_u8_s16(srow, -1 + bstep*2);
-                __m128i x13 = _mm_loadl_u8_s16(srow, -1 + bstep  );
-                __m128i x14 = _mm_loadl_u8_s16(srow, -2 + bstep  );
-                __m128i x15 = _mm_loadl_u8_s16(srow, -1          );
-                __m128i x16 = _mm_loadl_u8_s16(srow, -2 - bstep  );
-
-                __m128i t0, t1, mask;
-
-                // gradN ***********************************************
-                mask = _mm_cmpgt_epi16(T, gradN); // mask = T>gradN
-                ng = _mm_sub_epi16(ng, mask);     // ng += (T>gradN)
-
-                t0 = _mm_slli_epi16(x3, 1);                                 // srow[-bstep]*2
-                t1 = _mm_adds_epi16(_mm_loadl_u8_s16(srow, -bstep*2), x0);  // srow[-bstep*2] + srow[0]
-
-                // RGs += (srow[-bstep*2] + srow[0]) * (T>gradN)
-                RGs = _mm_adds_epi16(RGs, _mm_and_si128(t1, mask));
-                // GRs += {srow[-bstep]*2; (srow[-bstep*2-1] + srow[-bstep*2+1])} * (T>gradN)
-                GRs = _mm_adds_epi16(GRs, _mm_and_si128(_mm_merge_epi16(t0, _mm_adds_epi16(x2,x4)), mask));
-                // Bs  += {(srow[-bstep-1]+srow[-bstep+1]); srow[-bstep]*2 } * (T>gradN)
-                Bs  = _mm_adds_epi16(Bs, _mm_and_si128(_mm_merge_epi16(_mm_adds_epi16(x1,x5), t0), mask));
-
-                // gradNE **********************************************
-                mask = _mm_cmpgt_epi16(T, gradNE); // mask = T>gradNE
-                ng = _mm_sub_epi16(ng, mask);      // ng += (T>gradNE)
-
-                t0 = _mm_slli_epi16(x5, 1);                                    // srow[-bstep+1]*2
-                t1 = _mm_adds_epi16(_mm_loadl_u8_s16(srow, -bstep*2+2), x0);   // srow[-bstep*2+2] + srow[0]
-
-                // RGs += {(srow[-bstep*2+2] + srow[0]); srow[-bstep+1]*2} * (T>gradNE)
-                RGs = _mm_adds_epi16(RGs, _mm_and_si128(_mm_merge_epi16(t1, t0), mask));
-                // GRs += {brow0[N6+1]; (srow[-bstep*2+1] + srow[1])} * (T>gradNE)
-                GRs = _mm_adds_epi16(GRs, _mm_and_si128(_mm_merge_epi16(_mm_loadu_si128((__m128i*)(brow0+N6+1)), _mm_adds_epi16(x4,x7)), mask));
-                // Bs  += {srow[-bstep+1]*2; (srow[-bstep] + srow[-bstep+2])}  * (T>gradNE)
-                Bs  = _mm_adds_epi16(Bs, _mm_and_si128(_mm_merge_epi16(t0,_mm_adds_epi16(x3,x6)), mask));
-
-                // gradE ***********************************************
-                mask = _mm_cmpgt_epi16(T, gradE);  // mask = T>gradE
-                ng = _mm_sub_epi16(ng, mask);      // ng += (T>gradE)
-
-                t0 = _mm_slli_epi16(x7, 1);                         // srow[1]*2
-                t1 = _mm_adds_epi16(_mm_loadl_u8_s16(srow, 2), x0); // srow[2] + srow[0]
-
-                // RGs += (srow[2] + srow[0]) * (T>gradE)
-                RGs = _mm_adds_epi16(RGs, _mm_and_si128(t1, mask));
-                // GRs += (srow[1]*2) * (T>gradE)
-                GRs = _mm_adds_epi16(GRs, _mm_and_si128(t0, mask));
-                // Bs  += {(srow[-bstep+1]+srow[bstep+1]); (srow[-bstep+2]+srow[bstep+2])} * (T>gradE)
-                Bs  = _mm_adds_epi16(Bs, _mm_and_si128(_mm_merge_epi16(_mm_adds_epi16(x5,x9), _mm_adds_epi16(x6,x8)), mask));
-
-                // gradSE **********************************************
-                mask = _mm_cmpgt_epi16(T, gradSE);  // mask = T>gradSE
-                ng = _mm_sub_epi16(ng, mask);       // ng += (T>gradSE)
-
-                t0 = _mm_slli_epi16(x9, 1);                                 // srow[bstep+1]*2
-                t1 = _mm_adds_epi16(_mm_loadl_u8_s16(srow, bstep*2+2), x0); // srow[bstep*2+2] + srow[0]
-
-                // RGs += {(srow[bstep*2+2] + srow[0]); srow[bstep+1]*2} * (T>gradSE)
-                RGs = _mm_adds_epi16(RGs, _mm_and_si128(_mm_merge_epi16(t1, t0), mask));
-                // GRs += {brow2[N6+1]; (srow[1]+srow[bstep*2+1])} * (T>gradSE)
-                GRs = _mm_adds_epi16(GRs, _mm_and_si128(_mm_merge_epi16(_mm_loadu_si128((__m128i*)(brow2+N6+1)), _mm_adds_epi16(x7,x10)), mask));
-                // Bs  += {srow[-bstep+1]*2; (srow[bstep+2]+srow[bstep])} * (T>gradSE)
-                Bs  = _mm_adds_epi16(Bs, _mm_and_si128(_mm_merge_epi16(_mm_slli_epi16(x5, 1), _mm_adds_epi16(x8,x11)), mask));
-
-                // gradS ***********************************************
-                mask = _mm_cmpgt_epi16(T, gradS);  // mask = T>gradS
-                ng = _mm_sub_epi16(ng, mask);      // ng += (T>gradS)
-
-                t0 = _mm_slli_epi16(x11, 1);                             // srow[bstep]*2
-                t1 = _mm_adds_epi16(_mm_loadl_u8_s16(srow,bstep*2), x0); // srow[bstep*2]+srow[0]
-
-                // RGs += (srow[bstep*2]+srow[0]) * (T>gradS)
-                RGs = _mm_adds_epi16(RGs, _mm_and_si128(t1, mask));
-                // GRs += {srow[bstep]*2; (srow[bstep*2+1]+srow[bstep*2-1])} * (T>gradS)
-                GRs = _mm_adds_epi16(GRs, _mm_and_si128(_mm_merge_epi16(t0, _mm_adds_epi16(x10,x12)), mask));
-                // Bs  += {(srow[bstep+1]+srow[bstep-1]); srow[bstep]*2} * (T>gradS)
-                Bs  = _mm_adds_epi16(Bs, _mm_and_si128(_mm_merge_epi16(_mm_adds_epi16(x9,x13), t0), mask));
-
-                // gradSW **********************************************
-                mask = _mm_cmpgt_epi16(T, gradSW);  // mask = T>gradSW
-                ng = _mm_sub_epi16(ng, mask);       // ng += (T>gradSW)
-
-                t0 = _mm_slli_epi16(x13, 1);                                // srow[bstep-1]*2
-                t1 = _mm_adds_epi16(_mm_loadl_u8_s16(srow, bstep*2-2), x0); // srow[bstep*2-2]+srow[0]
-
-                // RGs += {(srow[bstep*2-2]+srow[0]); srow[bstep-1]*2} * (T>gradSW)
-                RGs = _mm_adds_epi16(RGs, _mm_and_si128(_mm_merge_epi16(t1, t0), mask));
-                // GRs += {brow2[N6-1]; (srow[bstep*2-1]+srow[-1])} * (T>gradSW)
-                GRs = _mm_adds_epi16(GRs, _mm_and_si128(_mm_merge_epi16(_mm_loadu_si128((__m128i*)(brow2+N6-1)), _mm_adds_epi16(x12,x15)), mask));
-                // Bs  += {srow[bstep-1]*2; (srow[bstep]+srow[bstep-2])} * (T>gradSW)
-                Bs  = _mm_adds_epi16(Bs, _mm_and_si128(_mm_merge_epi16(t0,_mm_adds_epi16(x11,x14)), mask));
-
-                // gradW ***********************************************
-                mask = _mm_cmpgt_epi16(T, gradW);  // mask = T>gradW
-                ng = _mm_sub_epi16(ng, mask);      // ng += (T>gradW)
-
-                t0 = _mm_slli_epi16(x15, 1);                         // srow[-1]*2
-                t1 = _mm_adds_epi16(_mm_loadl_u8_s16(srow, -2), x0); // srow[-2]+srow[0]
-
-                // RGs += (srow[-2]+srow[0]) * (T>gradW)
-                RGs = _mm_adds_epi16(RGs, _mm_and_si128(t1, mask));
-                // GRs += (srow[-1]*2) * (T>gradW)
-                GRs = _mm_adds_epi16(GRs, _mm_and_si128(t0, mask));
-                // Bs  += {(srow[-bstep-1]+srow[bstep-1]); (srow[bstep-2]+srow[-bstep-2])} * (T>gradW)
-                Bs  = _mm_adds_epi16(Bs, _mm_and_si128(_mm_merge_epi16(_mm_adds_epi16(x1,x13), _mm_adds_epi16(x14,x16)), mask));
-
-                // gradNW **********************************************
-                mask = _mm_cmpgt_epi16(T, gradNW);  // mask = T>gradNW
-                ng = _mm_sub_epi16(ng, mask);       // ng += (T>gradNW)
-
-                t0 = _mm_slli_epi16(x1, 1);                                 // srow[-bstep-1]*2
-                t1 = _mm_adds_epi16(_mm_loadl_u8_s16(srow,-bstep*2-2), x0); // srow[-bstep*2-2]+srow[0]
-
-                // RGs += {(srow[-bstep*2-2]+srow[0]); srow[-bstep-1]*2} * (T>gradNW)
-                RGs = _mm_adds_epi16(RGs, _mm_and_si128(_mm_merge_epi16(t1, t0), mask));
-                // GRs += {brow0[N6-1]; (srow[-bstep*2-1]+srow[-1])} * (T>gradNW)
-                GRs = _mm_adds_epi16(GRs, _mm_and_si128(_mm_merge_epi16(_mm_loadu_si128((__m128i*)(brow0+N6-1)), _mm_adds_epi16(x2,x15)), mask));
-                // Bs  += {srow[-bstep-1]*2; (srow[-bstep]+srow[-bstep-2])} * (T>gradNW)
-                Bs  = _mm_adds_epi16(Bs, _mm_and_si128(_mm_merge_epi16(_mm_slli_epi16(x5, 1),_mm_adds_epi16(x3,x16)), mask));
-
-                __m128 ngf0, ngf1;
-                ngf0 = _mm_div_ps(_0_5, _mm_cvtloepi16_ps(ng));
-                ngf1 = _mm_div_ps(_0_5, _mm_cvthiepi16_ps(ng));
-
-                // now interpolate r, g & b
-                t0 = _mm_sub_epi16(GRs, RGs);
-                t1 = _mm_sub_epi16(Bs, RGs);
-
-                t0 = _mm_add_epi16(x0, _mm_packs_epi32(
-                                                       _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtloepi16_ps(t0), ngf0)),
-                                                       _mm_cvtps_epi32(_mm_mul_ps(_mm_cvthiepi16_ps(t0), ngf1))));
-
-                t1 = _mm_add_epi16(x0, _mm_packs_epi32(
-                                                       _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtloepi16_ps(t1), ngf0)),
-                                                       _mm_cvtps_epi32(_mm_mul_ps(_mm_cvthiepi16_ps(t1), ngf1))));
-
-                x1 = _mm_merge_epi16(x0, t0);
-                x2 = _mm_merge_epi16(t0, x0);
-
-                uchar R[8], G[8], B[8];
-
-                _mm_storel_epi64(blueIdx ? (__m128i*)B : (__m128i*)R, _mm_packus_epi16(x1, z));
-                _mm_storel_epi64((__m128i*)G, _mm_packus_epi16(x2, z));
-                _mm_storel_epi64(blueIdx ? (__m128i*)R : (__m128i*)B, _mm_packus_epi16(t1, z));
-
-                for( int j = 0; j < 8; j++, dstrow += 3 )
-                {
-                    dstrow[0] = B[j]; dstrow[1] = G[j]; dstrow[2] = R[j];
-                }
+            for( i = 0; i < 6; i++ )
+            {
+                dst[dststep*y + 5 - i] = dst[dststep*y + 8 - i];
+                dst[dststep*y + (N - 2)*3 + i] = dst[dststep*y + (N - 3)*3 + i];
             }
-#endif
 
-            limit = N - 2;
+            greenCell0 = !greenCell0;
+            blueIdx ^= 2;
         }
-        while( i < N - 2 );
+    }
 
-        for( i = 0; i < 6; i++ )
-        {
-            dst[dststep*y + 5 - i] = dst[dststep*y + 8 - i];
-            dst[dststep*y + (N - 2)*3 + i] = dst[dststep*y + (N - 3)*3 + i];
-        }
+private:
+    Mat srcmat;
+    Mat dstmat;
+    int code;
+};
 
-        greenCell0 = !greenCell0;
-        blueIdx ^= 2;
+static void Bayer2RGB_VNG_8u( const Mat& srcmat, Mat& dstmat, int code )
+{
+    uchar* dst = dstmat.data;
+    int dststep = (int)dstmat.step;
+    Size size = srcmat.size();
+    int i;
+
+    // for too small images use the simple interpolation algorithm
+    if( MIN(size.width, size.height) < 8 )
+    {
+        Bayer2RGB_<uchar, SIMDBayerInterpolator_8u>( srcmat, dstmat, code );
+        return;
     }
 
+    Range range(2, size.height - 4);
+    Bayer2RGB_VNG_8u_Invoker body(srcmat, dstmat, code);
+    int nstripes = (int)std::min(srcmat.total()/CVTCOLOR_PARALLEL_MIN, (size_t)range.size());
+    if( nstripes > 1 )
+        parallel_for_(range, body, nstripes);
+    else
+        body(range);
+
     for( i = 0; i < size.width*3; i++ )
     {
         dst[i] = dst[i + dststep] = dst[i + dststep*2];
@@ -3187,6 +3515,7 @@ struct mRGBA2RGBA
 
 void cv::cvtColor( InputArray _src, OutputArray _dst, int code, int dcn )
 {
+    CV_TRACE_FUNCTION();
     Mat src = _src.getMat(), dst;
     Size sz = src.size();
     int scn = src.channels(), depth = src.depth(), bidx;
@@ -3728,6 +4057,244 @@ void cv::cvtColor( InputArray _src, OutputArray _dst, int code, int dcn )
     }
 }
 
+//////////////////////////// Fused multi-output conversion ////////////////////////////
+
+namespace cv
+{
+
+// type-erased converter of a run of pixels, so that a list of different
+// conversions can be applied to the same block of source rows
+class CvtColorRows
+{
+public:
+    virtual ~CvtColorRows() {}
+    virtual void operator()(const uchar* src, uchar* dst, int n) const = 0;
+};
+
+template<class Cvt> class CvtColorRows_ : public CvtColorRows
+{
+    typedef typename Cvt::channel_type _Tp;
+public:
+    CvtColorRows_(const Cvt& _cvt) : cvt(_cvt) {}
+
+    void operator()(const uchar* src, uchar* dst, int n) const
+    {
+        cvt((const _Tp*)src, (_Tp*)dst, n);
+    }
+
+private:
+    Cvt cvt;
+};
+
+template<class Cvt> static Ptr<CvtColorRows> makeCvtColorRows(const Cvt& cvt)
+{
+    return Ptr<CvtColorRows>(new CvtColorRows_<Cvt>(cvt));
+}
+
+// Builds the converter for the conversions out of a 3- or 4-channel RGB image;
+// returns an empty pointer (and the caller falls back to cvtColor) otherwise.
+static Ptr<CvtColorRows> createCvtColorRows(int code, int depth, int scn, int& dcn)
+{
+    if( scn != 3 && scn != 4 )
+        return Ptr<CvtColorRows>();
+
+    switch( code )
+    {
+    case CV_BGR2BGRA: case CV_RGB2BGRA: case CV_BGRA2BGR:
+    case CV_RGBA2BGR: case CV_RGB2BGR: case CV_BGRA2RGBA:
+        {
+        int bidx = code == CV_BGR2BGRA || code == CV_BGRA2BGR ? 0 : 2;
+        dcn = code == CV_BGR2BGRA || code == CV_RGB2BGRA || code == CV_BGRA2RGBA ? 4 : 3;
+        if( depth == CV_8U )
+            return makeCvtColorRows(RGB2RGB<uchar>(scn, dcn, bidx));
+        if( depth == CV_16U )
+            return makeCvtColorRows(RGB2RGB<ushort>(scn, dcn, bidx));
+        return makeCvtColorRows(RGB2RGB<float>(scn, dcn, bidx));
+        }
+
+    case CV_BGR2GRAY: case CV_BGRA2GRAY: case CV_RGB2GRAY: case CV_RGBA2GRAY:
+        {
+        int bidx = code == CV_BGR2GRAY || code == CV_BGRA2GRAY ? 0 : 2;
+        dcn = 1;
+        if( depth == CV_8U )
+            return makeCvtColorRows(RGB2Gray<uchar>(scn, bidx, 0));
+        if( depth == CV_16U )
+            return makeCvtColorRows(RGB2Gray<ushort>(scn, bidx, 0));
+        return makeCvtColorRows(RGB2Gray<float>(scn, bidx, 0));
+        }
+
+    case CV_BGR2YCrCb: case CV_RGB2YCrCb:
+    case CV_BGR2YUV: case CV_RGB2YUV:
+        {
+        int bidx = code == CV_BGR2YCrCb || code == CV_RGB2YUV ? 0 : 2;
+        static const float yuv_f[] = { 0.114f, 0.587f, 0.299f, 0.492f, 0.877f };
+        static const int yuv_i[] = { B2Y, G2Y, R2Y, 8061, 14369 };
+        const float* coeffs_f = code == CV_BGR2YCrCb || code == CV_RGB2YCrCb ? 0 : yuv_f;
+        const int* coeffs_i = code == CV_BGR2YCrCb || code == CV_RGB2YCrCb ? 0 : yuv_i;
+        dcn = 3;
+        if( depth == CV_8U )
+            return makeCvtColorRows(RGB2YCrCb_i<uchar>(scn, bidx, coeffs_i));
+        if( depth == CV_16U )
+            return makeCvtColorRows(RGB2YCrCb_i<ushort>(scn, bidx, coeffs_i));
+        return makeCvtColorRows(RGB2YCrCb_f<float>(scn, bidx, coeffs_f));
+        }
+
+    case CV_BGR2XYZ: case CV_RGB2XYZ:
+        {
+        int bidx = code == CV_BGR2XYZ ? 0 : 2;
+        dcn = 3;
+        if( depth == CV_8U )
+            return makeCvtColorRows(RGB2XYZ_i<uchar>(scn, bidx, 0));
+        if( depth == CV_16U )
+            return makeCvtColorRows(RGB2XYZ_i<ushort>(scn, bidx, 0));
+        return makeCvtColorRows(RGB2XYZ_f<float>(scn, bidx, 0));
+        }
+
+    case CV_BGR2HSV: case CV_RGB2HSV: case CV_BGR2HSV_FULL: case CV_RGB2HSV_FULL:
+    case CV_BGR2HLS: case CV_RGB2HLS: case CV_BGR2HLS_FULL: case CV_RGB2HLS_FULL:
+        {
+        if( depth != CV_8U && depth != CV_32F )
+            break;
+        int bidx = code == CV_BGR2HSV || code == CV_BGR2HLS ||
+            code == CV_BGR2HSV_FULL || code == CV_BGR2HLS_FULL ? 0 : 2;
+        int hrange = depth == CV_32F ? 360 : code == CV_BGR2HSV || code == CV_RGB2HSV ||
+            code == CV_BGR2HLS || code == CV_RGB2HLS ? 180 : 256;
+        dcn = 3;
+        if( code == CV_BGR2HSV || code == CV_RGB2HSV ||
+            code == CV_BGR2HSV_FULL || code == CV_RGB2HSV_FULL )
+        {
+            if( depth == CV_8U )
+                return makeCvtColorRows(RGB2HSV_b(scn, bidx, hrange));
+            return makeCvtColorRows(RGB2HSV_f(scn, bidx, (float)hrange));
+        }
+        if( depth == CV_8U )
+            return makeCvtColorRows(RGB2HLS_b(scn, bidx, hrange));
+        return makeCvtColorRows(RGB2HLS_f(scn, bidx, (float)hrange));
+        }
+
+    case CV_BGR2Lab: case CV_RGB2Lab: case CV_LBGR2Lab: case CV_LRGB2Lab:
+    case CV_BGR2Luv: case CV_RGB2Luv: case CV_LBGR2Luv: case CV_LRGB2Luv:
+        {
+        if( depth != CV_8U && depth != CV_32F )
+            break;
+        int bidx = code == CV_BGR2Lab || code == CV_BGR2Luv ||
+                   code == CV_LBGR2Lab || code == CV_LBGR2Luv ? 0 : 2;
+        bool srgb = code == CV_BGR2Lab || code == CV_RGB2Lab ||
+                    code == CV_BGR2Luv || code == CV_RGB2Luv;
+        dcn = 3;
+        if( code == CV_BGR2Lab || code == CV_RGB2Lab ||
+            code == CV_LBGR2Lab || code == CV_LRGB2Lab )
+        {
+            if( depth == CV_8U )
+                return makeCvtColorRows(RGB2Lab_b(scn, bidx, 0, 0, srgb));
+            return makeCvtColorRows(RGB2Lab_f(scn, bidx, 0, 0, srgb));
+        }
+        if( depth == CV_8U )
+            return makeCvtColorRows(RGB2Luv_b(scn, bidx, 0, 0, srgb));
+        return makeCvtColorRows(RGB2Luv_f(scn, bidx, 0, 0, srgb));
+        }
+
+    default:
+        break;
+    }
+    return Ptr<CvtColorRows>();
+}
+
+class CvtColorMulti_Invoker : public ParallelLoopBody
+{
+public:
+    CvtColorMulti_Invoker(const Mat& _src, const vector<Mat*>& _dst,
+                          const vector<Ptr<CvtColorRows> >& _cvt, int _blockRows) :
+        src(_src), dst(_dst), cvt(_cvt), blockRows(_blockRows)
+    {
+    }
+
+    virtual void operator()(const Range& range) const
+    {
+        int k, ncvt = (int)cvt.size();
+
+        // all the conversions are applied to one block of rows before moving on,
+        // so the source block is read from memory once and then stays in cache
+        for( int y0 = range.start; y0 < range.end; y0 += blockRows )
+        {
+            int y1 = std::min(y0 + blockRows, range.end);
+            for( k = 0; k < ncvt; k++ )
+            {
+                const CvtColorRows& cvtk = *cvt[k];
+                Mat& d = *dst[k];
+                const uchar* yS = src.ptr(y0);
+                uchar* yD = d.ptr(y0);
+
+                if( src.isContinuous() && d.isContinuous() )
+                    cvtk(yS, yD, src.cols*(y1 - y0));
+                else
+                    for( int y = y0; y < y1; y++, yS += src.step, yD += d.step )
+                        cvtk(yS, yD, src.cols);
+            }
+        }
+    }
+
+private:
+    const Mat& src;
+    const vector<Mat*>& dst;
+    const vector<Ptr<CvtColorRows> >& cvt;
+    int blockRows;
+};
+
+// source bytes per block of rows; small enough for the block and its outputs to stay in L2
+enum { CVTCOLOR_MULTI_BLOCK_SIZE = 1 << 15 };
+
+}
+
+void cv::cvtColorMulti( InputArray _src, OutputArrayOfArrays _dst, const vector<int>& codes )
+{
+    CV_TRACE_FUNCTION();
+    Mat src = _src.getMat();
+    int i, ncodes = (int)codes.size();
+    int depth = src.depth(), scn = src.channels();
+
+    CV_Assert( depth == CV_8U || depth == CV_16U || depth == CV_32F );
+    _dst.create(ncodes, 1, depth);
+
+    vector<Ptr<CvtColorRows> > cvt;
+    vector<Mat*> dst;
+    vector<int> fallback;
+
+    for( i = 0; i < ncodes; i++ )
+    {
+        int dcn = 0;
+        Ptr<CvtColorRows> c = createCvtColorRows(codes[i], depth, scn, dcn);
+        if( c.empty() )
+        {
+            fallback.push_back(i);
+            continue;
+        }
+        Mat& d = _dst.getMatRef(i);
+        d.create(src.size(), CV_MAKETYPE(depth, dcn));
+        // an output may reuse the source buffer; convert from a copy then
+        if( d.data == src.data )
+            src = src.clone();
+        cvt.push_back(c);
+        dst.push_back(&d);
+    }
+
+    if( !cvt.empty() )
+    {
+        int blockRows = std::max((int)(CVTCOLOR_MULTI_BLOCK_SIZE/(src.cols*src.elemSize())), 1);
+        int nstripes = (int)std::min(src.total()/CVTCOLOR_PARALLEL_MIN, (size_t)src.rows);
+        CvtColorMulti_Invoker body(src, dst, cvt, blockRows);
+
+        if( nstripes > 1 )
+            parallel_for_(Range(0, src.rows), body, nstripes);
+        else
+            body(Range(0, src.rows));
+    }
+
+    // conversions without a fused implementation (Bayer, YUV 4:2:0, 16-bit RGB, ...)
+    for( i = 0; i < (int)fallback.size(); i++ )
+        cvtColor(src, _dst.getMatRef(fallback[i]), codes[fallback[i]]);
+}
+
 CV_IMPL void
 cvCvtColor( const CvArr* srcarr, CvArr* dstarr, int code )
 {
@@ -0,0 +1,470 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "precomp.hpp"
+
+/*
+   Connected component labeling.
+
+   The classical two-pass algorithm with the decision tree of Wu et al. ("Optimizing two-pass
+   connected-component labeling algorithms", 2009) and union-find over the provisional labels.
+   The image is split into horizontal strips that are scanned independently, each with its own
+   range of provisional labels; the components crossing the strip boundaries are then merged,
+   and the second pass writes the final labels and collects the statistics, again in parallel.
+
+   The union-find trees always have the smallest label as the root, and within a strip the
+   provisional labels are assigned in the raster order, so the final labels are numbered in the
+   order of the first pixel of every component, independently of the number of strips.
+*/
+
+namespace cv
+{
+
+enum { CC_PARALLEL_MIN = 1 << 16 };
+
+static inline int ccFindRoot(const int* P, int i)
+{
+    while( P[i] < i )
+        i = P[i];
+    return i;
+}
+
+static inline void ccSetRoot(int* P, int i, int root)
+{
+    while( P[i] < i )
+    {
+        int j = P[i];
+        P[i] = root;
+        i = j;
+    }
+    P[i] = root;
+}
+
+static inline int ccMerge(int* P, int i, int j)
+{
+    int root = ccFindRoot(P, i);
+    if( i != j )
+    {
+        int rootj = ccFindRoot(P, j);
+        if( root > rootj )
+            root = rootj;
+        ccSetRoot(P, j, root);
+    }
+    ccSetRoot(P, i, root);
+    return root;
+}
+
+// the maximal number of provisional labels a strip of the given size may need
+static inline int ccMaxLabels(int rows, int cols, int connectivity)
+{
+    return connectivity == 8 ? ((rows + 1)/2)*((cols + 1)/2) : (rows*cols + 1)/2;
+}
+
+class CCFirstPassInvoker : public ParallelLoopBody
+{
+public:
+    CCFirstPassInvoker(const Mat& _img, Mat& _labels, int* _P, const int* _stripRows,
+                       const int* _stripBase, int* _stripCount, int _connectivity) :
+        img(&_img), labels(&_labels), P(_P), stripRows(_stripRows), stripBase(_stripBase),
+        stripCount(_stripCount), connectivity(_connectivity)
+    {
+    }
+
+    void operator()(const Range& range) const
+    {
+        int cols = img->cols;
+
+        for( int k = range.start; k < range.end; k++ )
+        {
+            int label = stripBase[k];
+
+            for( int r = stripRows[k]; r < stripRows[k+1]; r++ )
+            {
+                const uchar* irow = img->ptr<uchar>(r);
+                int* lrow = labels->ptr<int>(r);
+                // the row above the strip is treated as background; it is taken into account when merging the strips
+                const uchar* irowPrev = r > stripRows[k] ? irow - img->step : 0;
+                const int* lrowPrev = r > stripRows[k] ? lrow - labels->step/sizeof(int) : 0;
+
+                if( connectivity == 8 )
+                {
+                    for( int c = 0; c < cols; c++ )
+                    {
+                        if( !irow[c] )
+                        {
+                            lrow[c] = 0;
+                            continue;
+                        }
+
+                        bool a = irowPrev && c > 0 && irowPrev[c-1];
+                        bool b = irowPrev && irowPrev[c];
+                        bool d = c > 0 && irow[c-1];
+
+                        if( b )
+                            lrow[c] = lrowPrev[c];
+                        else if( irowPrev && c < cols - 1 && irowPrev[c+1] )
+                        {
+                            if( a )
+                                lrow[c] = ccMerge(P, lrowPrev[c+1], lrowPrev[c-1]);
+                            else if( d )
+                                lrow[c] = ccMerge(P, lrowPrev[c+1], lrow[c-1]);
+                            else
+                                lrow[c] = lrowPrev[c+1];
+                        }
+                        else if( a )
+                            lrow[c] = lrowPrev[c-1];
+                        else if( d )
+                            lrow[c] = lrow[c-1];
+                        else
+                        {
+                            P[label] = label;
+                            lrow[c] = label++;
+                        }
+                    }
+                }
+                else
+                {
+                    for( int c = 0; c < cols; c++ )
+                    {
+                        if( !irow[c] )
+                        {
+                            lrow[c] = 0;
+                            continue;
+                        }
+
+                        bool b = irowPrev && irowPrev[c];
+                        bool d = c > 0 && irow[c-1];
+
+                        if( b )
+                            lrow[c] = d ? ccMerge(P, lrow[c-1], lrowPrev[c]) : lrowPrev[c];
+                        else if( d )
+                            lrow[c] = lrow[c-1];
+                        else
+                        {
+                            P[label] = label;
+                            lrow[c] = label++;
+                        }
+                    }
+                }
+            }
+
+            stripCount[k] = label - stripBase[k];
+        }
+    }
+
+private:
+    const Mat* img;
+    Mat* labels;
+    int* P;
+    const int* stripRows;
+    const int* stripBase;
+    int* stripCount;
+    int connectivity;
+};
+
+class CCSecondPassInvoker : public ParallelLoopBody
+{
+public:
+    CCSecondPassInvoker(const Mat& _plabels, Mat& _labels, const int* _P, const int* _stripRows,
+                        const int* _stripBase, const int* _stripOfs, int* _stats, double* _sums) :
+        plabels(&_plabels), labels(&_labels), P(_P), stripRows(_stripRows),
+        stripBase(_stripBase), stripOfs(_stripOfs), stats(_stats), sums(_sums)
+    {
+    }
+
+    void operator()(const Range& range) const
+    {
+        int cols = plabels->cols;
+        bool withStats = stats != 0;
+        bool toShort = labels->depth() == CV_16U;
+
+        for( int k = range.start; k < range.end; k++ )
+        {
+            // the statistics are collected per provisional label of the strip (slot 0 is the background)
+            // and combined into the final labels afterwards
+            int nslots = stripOfs[k+1] - stripOfs[k];
+            int* st = withStats ? stats + (size_t)stripOfs[k]*CC_STAT_MAX : 0;
+            double* sm = withStats ? sums + (size_t)stripOfs[k]*2 : 0;
+            int base = stripBase[k] - 1;
+
+            if( withStats )
+            {
+                for( int i = 0; i < nslots; i++ )
+                {
+                    st[i*CC_STAT_MAX + CC_STAT_LEFT] = INT_MAX;
+                    st[i*CC_STAT_MAX + CC_STAT_TOP] = INT_MAX;
+                    st[i*CC_STAT_MAX + CC_STAT_WIDTH] = INT_MIN;
+                    st[i*CC_STAT_MAX + CC_STAT_HEIGHT] = INT_MIN;
+                    st[i*CC_STAT_MAX + CC_STAT_AREA] = 0;
+                    sm[i*2] = sm[i*2+1] = 0;
+                }
+            }
+
+            for( int r = stripRows[k]; r < stripRows[k+1]; r++ )
+            {
+                const int* prow = plabels->ptr<int>(r);
+                int* lrow = toShort ? 0 : labels->ptr<int>(r);
+                ushort* srow = toShort ? labels->ptr<ushort>(r) : 0;
+
+                for( int c = 0; c < cols; c++ )
+                {
+                    int pl = prow[c];
+                    int l = P[pl];
+                    if( toShort )
+                        srow[c] = (ushort)l;
+                    else
+                        lrow[c] = l;
+
+                    if( withStats )
+                    {
+                        // WIDTH and HEIGHT hold the right and the bottom coordinates until the final merge
+                        int i = pl == 0 ? 0 : pl - base;
+                        int* s = st + i*CC_STAT_MAX;
+                        s[CC_STAT_LEFT] = std::min(s[CC_STAT_LEFT], c);
+                        s[CC_STAT_WIDTH] = std::max(s[CC_STAT_WIDTH], c);
+                        s[CC_STAT_TOP] = std::min(s[CC_STAT_TOP], r);
+                        s[CC_STAT_HEIGHT] = r;
+                        s[CC_STAT_AREA]++;
+                        sm[i*2] += c;
+                        sm[i*2+1] += r;
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    const Mat* plabels;
+    Mat* labels;
+    const int* P;
+    const int* stripRows;
+    const int* stripBase;
+    const int* stripOfs;
+    int* stats;
+    double* sums;
+};
+
+static int connectedComponents_( const Mat& img, OutputArray _labels, OutputArray _stats,
+                                 OutputArray _centroids, int connectivity, int ltype, bool withStats )
+{
+    CV_Assert( img.type() == CV_8UC1 );
+    CV_Assert( connectivity == 8 || connectivity == 4 );
+    CV_Assert( ltype == CV_32S || ltype == CV_16U );
+
+    int rows = img.rows, cols = img.cols;
+
+    _labels.create(img.size(), ltype);
+    Mat labels = _labels.getMat();
+
+    // the provisional labels may exceed the range of 16-bit labels, so they are always stored as 32-bit integers
+    Mat plabels = ltype == CV_32S ? labels : Mat(img.size(), CV_32S);
+
+    int nstrips = (int)std::min((size_t)std::max(rows/4, 1), img.total()/CC_PARALLEL_MIN);
+    nstrips = std::max(std::min(nstrips, getNumThreads()*4), 1);
+
+    AutoBuffer<int> _stripBuf((nstrips + 1)*3);
+    int* stripRows = _stripBuf;
+    int* stripBase = stripRows + nstrips + 1;
+    int* stripCount = stripBase + nstrips + 1;
+
+    // label 0 is the background
+    int64 maxLabels = 1;
+    for( int k = 0; k <= nstrips; k++ )
+    {
+        stripRows[k] = (int)((int64)rows*k/nstrips);
+        if( k > 0 )
+        {
+            stripBase[k-1] = (int)maxLabels;
+            maxLabels += ccMaxLabels(stripRows[k] - stripRows[k-1], cols, connectivity);
+        }
+    }
+    if( maxLabels > INT_MAX )
+        CV_Error( CV_StsOutOfRange, "The image is too large" );
+
+    AutoBuffer<int> _P((size_t)maxLabels);
+    int* P = _P;
+    P[0] = 0;
+
+    CCFirstPassInvoker firstPass(img, plabels, P, stripRows, stripBase, stripCount, connectivity);
+    if( nstrips > 1 )
+        parallel_for_(Range(0, nstrips), firstPass, nstrips);
+    else
+        firstPass(Range(0, 1));
+
+    // merge the components crossing the strip boundaries
+    for( int k = 1; k < nstrips; k++ )
+    {
+        int r = stripRows[k];
+        if( r == stripRows[k-1] || r == rows )
+            continue;
+        const uchar* irow = img.ptr<uchar>(r);
+        const uchar* irowPrev = img.ptr<uchar>(r-1);
+        const int* lrow = plabels.ptr<int>(r);
+        const int* lrowPrev = plabels.ptr<int>(r-1);
+
+        for( int c = 0; c < cols; c++ )
+        {
+            if( !irow[c] )
+                continue;
+            if( irowPrev[c] )
+                ccMerge(P, lrow[c], lrowPrev[c]);
+            if( connectivity == 8 )
+            {
+                if( c > 0 && irowPrev[c-1] )
+                    ccMerge(P, lrow[c], lrowPrev[c-1]);
+                if( c < cols - 1 && irowPrev[c+1] )
+                    ccMerge(P, lrow[c], lrowPrev[c+1]);
+            }
+        }
+    }
+
+    // flatten the union-find trees and assign the consecutive final labels;
+    // every label points to a smaller one, which is already final by the time it is visited
+    int nlabels = 1;
+    for( int k = 0; k < nstrips; k++ )
+    {
+        for( int i = stripBase[k]; i < stripBase[k] + stripCount[k]; i++ )
+        {
+            if( P[i] < i )
+                P[i] = P[P[i]];
+            else
+                P[i] = nlabels++;
+        }
+    }
+
+    if( ltype == CV_16U && nlabels > USHRT_MAX + 1 )
+        CV_Error( CV_StsOutOfRange, "The number of components does not fit the 16-bit label type" );
+
+    AutoBuffer<int> _stripOfs(nstrips + 1);
+    int* stripOfs = _stripOfs;
+    stripOfs[0] = 0;
+    for( int k = 0; k < nstrips; k++ )
+        stripOfs[k+1] = stripOfs[k] + stripCount[k] + 1;
+
+    int nslots = stripOfs[nstrips];
+    AutoBuffer<int> _slotStats(withStats ? (size_t)nslots*CC_STAT_MAX : 1);
+    AutoBuffer<double> _slotSums(withStats ? (size_t)nslots*2 : 1);
+    int* slotStats = withStats ? (int*)_slotStats : 0;
+    double* slotSums = withStats ? (double*)_slotSums : 0;
+
+    CCSecondPassInvoker secondPass(plabels, labels, P, stripRows, stripBase, stripOfs, slotStats, slotSums);
+    if( nstrips > 1 )
+        parallel_for_(Range(0, nstrips), secondPass, nstrips);
+    else
+        secondPass(Range(0, 1));
+
+    if( withStats )
+    {
+        _stats.create(nlabels, CC_STAT_MAX, CV_32S);
+        _centroids.create(nlabels, 2, CV_64F);
+        Mat stats = _stats.getMat(), centroids = _centroids.getMat();
+        AutoBuffer<double> _csums(nlabels*2);
+        double* csums = _csums;
+
+        for( int l = 0; l < nlabels; l++ )
+        {
+            int* s = stats.ptr<int>(l);
+            s[CC_STAT_LEFT] = s[CC_STAT_TOP] = INT_MAX;
+            s[CC_STAT_WIDTH] = s[CC_STAT_HEIGHT] = INT_MIN;
+            s[CC_STAT_AREA] = 0;
+            csums[l*2] = csums[l*2+1] = 0;
+        }
+
+        // the slots are visited in the same order for any number of threads, so the sums are reproducible
+        for( int k = 0; k < nstrips; k++ )
+        {
+            for( int i = 0; i <= stripCount[k]; i++ )
+            {
+                const int* ss = slotStats + (size_t)(stripOfs[k] + i)*CC_STAT_MAX;
+                const double* sm = slotSums + (size_t)(stripOfs[k] + i)*2;
+                int l = i == 0 ? 0 : P[stripBase[k] + i - 1];
+                int* s = stats.ptr<int>(l);
+
+                s[CC_STAT_LEFT] = std::min(s[CC_STAT_LEFT], ss[CC_STAT_LEFT]);
+                s[CC_STAT_TOP] = std::min(s[CC_STAT_TOP], ss[CC_STAT_TOP]);
+                s[CC_STAT_WIDTH] = std::max(s[CC_STAT_WIDTH], ss[CC_STAT_WIDTH]);
+                s[CC_STAT_HEIGHT] = std::max(s[CC_STAT_HEIGHT], ss[CC_STAT_HEIGHT]);
+                s[CC_STAT_AREA] += ss[CC_STAT_AREA];
+                csums[l*2] += sm[0];
+                csums[l*2+1] += sm[1];
+            }
+        }
+
+        for( int l = 0; l < nlabels; l++ )
+        {
+            int* s = stats.ptr<int>(l);
+            int area = s[CC_STAT_AREA];
+            double* cptr = centroids.ptr<double>(l);
+
+            if( area == 0 )
+            {
+                // only the background may be empty
+                s[CC_STAT_LEFT] = s[CC_STAT_TOP] = 0;
+                s[CC_STAT_WIDTH] = s[CC_STAT_HEIGHT] = 0;
+                cptr[0] = cptr[1] = 0.;
+                continue;
+            }
+
+            s[CC_STAT_WIDTH] -= s[CC_STAT_LEFT] - 1;
+            s[CC_STAT_HEIGHT] -= s[CC_STAT_TOP] - 1;
+            cptr[0] = csums[l*2]/area;
+            cptr[1] = csums[l*2+1]/area;
+        }
+    }
+
+    return nlabels;
+}
+
+}
+
+int cv::connectedComponents( InputArray _img, OutputArray _labels, int connectivity, int ltype )
+{
+    Mat img = _img.getMat();
+    return connectedComponents_(img, _labels, noArray(), noArray(), connectivity, ltype, false);
+}
+
+int cv::connectedComponentsWithStats( InputArray _img, OutputArray _labels, OutputArray _stats,
+                                      OutputArray _centroids, int connectivity, int ltype )
+{
+    Mat img = _img.getMat();
+    return connectedComponents_(img, _labels, _stats, _centroids, connectivity, ltype, true);
+}
@@ -126,8 +126,11 @@ FilterEngine::FilterEngine( const Ptr<BaseFilter>& _filter2D,
          _rowBorderType, _columnBorderType, _borderValue);
 }
 
+static void releaseFilterBands( const FilterEngine* engine );
+
 FilterEngine::~FilterEngine()
 {
+    releaseFilterBands(this);
 }
 
 
@@ -430,9 +433,178 @@ int FilterEngine::proceed( const uchar* src, int srcstep, int count,
 }
 
 
+// the images with fewer pixels are filtered by a single thread
+enum { FILTER_PARALLEL_MIN = 1 << 16 };
+
+template<class Filter> static Ptr<Filter> cloneFilter( const Ptr<Filter>& f )
+{
+    if( f.empty() )
+        return Ptr<Filter>();
+    const CloneableFilter<Filter>* c = dynamic_cast<const CloneableFilter<Filter>*>((const Filter*)f);
+    return c ? c->clone() : Ptr<Filter>();
+}
+
+// the copies of an engine that filter the bands of an image in parallel. They are
+// made on the first parallel call of FilterEngine::apply and reused by the next calls
+struct FilterBands
+{
+    bool prepare( const FilterEngine& engine, int nbands );
+
+    // the filters of the engine the copies have been made from
+    Ptr<BaseFilter> filter2D;
+    Ptr<BaseRowFilter> rowFilter;
+    Ptr<BaseColumnFilter> columnFilter;
+    vector<Ptr<FilterEngine> > engines;
+};
+
+// makes sure there are at least nbands copies of the engine;
+// returns false if the filters of the engine can not be copied
+bool FilterBands::prepare( const FilterEngine& engine, int nbands )
+{
+    if( !engines.empty() )
+    {
+        // the public fields of the engine may have been changed since the copies were made
+        const FilterEngine& e = *engines[0];
+        if( filter2D.obj != engine.filter2D.obj || rowFilter.obj != engine.rowFilter.obj ||
+            columnFilter.obj != engine.columnFilter.obj || e.srcType != engine.srcType ||
+            e.dstType != engine.dstType || e.bufType != engine.bufType ||
+            e.ksize != engine.ksize || e.anchor != engine.anchor ||
+            e.rowBorderType != engine.rowBorderType || e.columnBorderType != engine.columnBorderType ||
+            e.constBorderValue != engine.constBorderValue )
+            engines.clear();
+    }
+    filter2D = engine.filter2D;
+    rowFilter = engine.rowFilter;
+    columnFilter = engine.columnFilter;
+
+    while( (int)engines.size() < nbands )
+    {
+        Ptr<FilterEngine> e = new FilterEngine(engine);
+        e->filter2D = cloneFilter(engine.filter2D);
+        e->rowFilter = cloneFilter(engine.rowFilter);
+        e->columnFilter = cloneFilter(engine.columnFilter);
+        if( e->filter2D.empty() != engine.filter2D.empty() ||
+            e->rowFilter.empty() != engine.rowFilter.empty() ||
+            e->columnFilter.empty() != engine.columnFilter.empty() )
+            return false;
+        engines.push_back(e);
+    }
+    return true;
+}
+
+typedef std::map<const FilterEngine*, FilterBands*> FilterBandsMap;
+
+static Mutex& getFilterBandsMutex()
+{
+    static Mutex m;
+    return m;
+}
+
+// never destroyed, since the engines may be destroyed after the static objects of the library
+static FilterBandsMap& getFilterBandsMap()
+{
+    static FilterBandsMap* bandsMap = new FilterBandsMap;
+    return *bandsMap;
+}
+
+// takes the copies of the engine out of the map for the time of one apply() call
+class FilterBandsLock
+{
+public:
+    FilterBandsLock( const FilterEngine* _engine ) : bands(0), engine(_engine)
+    {
+        AutoLock lock(getFilterBandsMutex());
+        FilterBandsMap& bandsMap = getFilterBandsMap();
+        FilterBandsMap::iterator it = bandsMap.find(engine);
+        if( it != bandsMap.end() )
+        {
+            bands = it->second;
+            bandsMap.erase(it);
+        }
+        else
+            bands = new FilterBands;
+    }
+
+    ~FilterBandsLock()
+    {
+        FilterBands* prev = 0;
+        {
+            AutoLock lock(getFilterBandsMutex());
+            FilterBands*& b = getFilterBandsMap()[engine];
+            prev = b; // set if the engine has been applied recursively
+            b = bands;
+        }
+        // the copies of the engine take the mutex when they are destroyed
+        delete prev;
+    }
+
+    FilterBands* bands;
+
+protected:
+    const FilterEngine* engine;
+
+private:
+    FilterBandsLock(const FilterBandsLock&);
+    FilterBandsLock& operator = (const FilterBandsLock&);
+};
+
+static void releaseFilterBands( const FilterEngine* engine )
+{
+    FilterBands* bands = 0;
+    {
+        AutoLock lock(getFilterBandsMutex());
+        FilterBandsMap& bandsMap = getFilterBandsMap();
+        FilterBandsMap::iterator it = bandsMap.find(engine);
+        if( it == bandsMap.end() )
+            return;
+        bands = it->second;
+        bandsMap.erase(it);
+    }
+    delete bands;
+}
+
+// each stripe is a horizontal band of the image processed by its own copy of the engine.
+// The rows above and below the band are taken from the source image, exactly as the
+// single engine would do, so the output does not depend on the number of bands
+class FilterEngineInvoker : public ParallelLoopBody
+{
+public:
+    FilterEngineInvoker( vector<Ptr<FilterEngine> >& _engines, int _nbands,
+                         const Mat& _src, Mat& _dst, const Rect& _srcRoi, Point _dstOfs, bool _isolated )
+        : engines(&_engines), nbands(_nbands), src(&_src), dst(&_dst), srcRoi(_srcRoi),
+          dstOfs(_dstOfs), isolated(_isolated)
+    {
+    }
+
+    void operator()(const Range& range) const
+    {
+        for( int i = range.start; i < range.end; i++ )
+        {
+            FilterEngine& f = *(*engines)[i];
+            int y0 = srcRoi.height*i/nbands, y1 = srcRoi.height*(i+1)/nbands;
+            Rect roi(srcRoi.x, srcRoi.y + y0, srcRoi.width, y1 - y0);
+            int y = f.start(*src, roi, isolated);
+            f.proceed( src->data + y*src->step, (int)src->step, f.endY - f.startY,
+                       dst->data + (dstOfs.y + y0)*dst->step + dstOfs.x*dst->elemSize(),
+                       (int)dst->step );
+        }
+    }
+
+protected:
+    vector<Ptr<FilterEngine> >* engines;
+    int nbands;
+    const Mat* src;
+    Mat* dst;
+    Rect srcRoi;
+    Point dstOfs;
+    bool isolated;
+};
+
+
 void FilterEngine::apply(const Mat& src, Mat& dst,
     const Rect& _srcRoi, Point dstOfs, bool isolated)
 {
+    CV_TRACE_FUNCTION();
     CV_Assert( src.type() == srcType && dst.type() == dstType );
 
     Rect srcRoi = _srcRoi;
@@ -446,6 +618,27 @@ void FilterEngine::apply(const Mat& src, Mat& dst,
         dstOfs.x + srcRoi.width <= dst.cols &&
         dstOfs.y + srcRoi.height <= dst.rows );
 
+    // in-place filtering relies on the sequential order of rows, so it is never split
+    double total = (double)srcRoi.area();
+    int minBandRows = std::max(ksize.height*4, 16);
+    int nbands = (int)std::min(total/FILTER_PARALLEL_MIN, (double)(srcRoi.height/minBandRows));
+    if( nbands > 1 && getNumThreads() > 1 &&
+        (src.dataend <= dst.datastart || dst.dataend <= src.datastart) )
+    {
+        FilterBandsLock bandsLock(this);
+        if( bandsLock.bands->prepare(*this, nbands) )
+        {
+            // the engine itself is left in the same state as after the serial processing
+            start(src, srcRoi, isolated);
+            parallel_for_(Range(0, nbands), FilterEngineInvoker(bandsLock.bands->engines, nbands,
+                          src, dst, srcRoi, dstOfs, isolated), nbands);
+            rowCount = std::min(endY - startY0, (int)rows.size());
+            startY = endY - rowCount;
+            dstY = roi.height;
+            return;
+        }
+    }
+
     int y = start(src, srcRoi, isolated);
     proceed( src.data + y*src.step, (int)src.step, endY - startY,
              dst.data + dstOfs.y*dst.step + dstOfs.x*dst.elemSize(), (int)dst.step );
@@ -554,6 +747,8 @@ struct RowVec_8u32s
                 break;
             }
         }
+        if( checkHardwareSupport(CV_CPU_SSE2) )
+            CV_TRACE_SIMD(CV_CPU_SSE2);
     }
 
     int operator()(const uchar* _src, uchar* _dst, int width, int cn) const
@@ -646,6 +841,8 @@ struct SymmRowSmallVec_8u32s
                 break;
             }
         }
+        if( checkHardwareSupport(CV_CPU_SSE2) )
+            CV_TRACE_SIMD(CV_CPU_SSE2);
     }
 
     int operator()(const uchar* src, uchar* _dst, int width, int cn) const
@@ -967,6 +1164,8 @@ struct SymmColumnVec_32s8u
         _kernel.convertTo(kernel, CV_32F, 1./(1 << _bits), 0);
         delta = (float)(_delta/(1 << _bits));
         CV_Assert( (symmetryType & (KERNEL_SYMMETRICAL | KERNEL_ASYMMETRICAL)) != 0 );
+        if( checkHardwareSupport(CV_CPU_SSE2) )
+            CV_TRACE_SIMD(CV_CPU_SSE2);
     }
 
     int operator()(const uchar** _src, uchar* dst, int width) const
@@ -1115,6 +1314,8 @@ struct SymmColumnSmallVec_32s16s
         _kernel.convertTo(kernel, CV_32F, 1./(1 << _bits), 0);
         delta = (float)(_delta/(1 << _bits));
         CV_Assert( (symmetryType & (KERNEL_SYMMETRICAL | KERNEL_ASYMMETRICAL)) != 0 );
+        if( checkHardwareSupport(CV_CPU_SSE2) )
+            CV_TRACE_SIMD(CV_CPU_SSE2);
     }
 
     int operator()(const uchar** _src, uchar* _dst, int width) const
@@ -1247,6 +1448,8 @@ struct RowVec_16s32f
     {
         kernel = _kernel;
         sse2_supported = checkHardwareSupport(CV_CPU_SSE2);
+        if( sse2_supported )
+            CV_TRACE_SIMD(CV_CPU_SSE2);
     }
 
     int operator()(const uchar* _src, uchar* _dst, int width, int cn) const
@@ -1297,6 +1500,8 @@ struct SymmColumnVec_32f16s
         delta = (float)_delta;
         CV_Assert( (symmetryType & (KERNEL_SYMMETRICAL | KERNEL_ASYMMETRICAL)) != 0 );
         sse2_supported = checkHardwareSupport(CV_CPU_SSE2);
+        if( sse2_supported )
+            CV_TRACE_SIMD(CV_CPU_SSE2);
     }
 
     int operator()(const uchar** _src, uchar* _dst, int width) const
@@ -1445,6 +1650,8 @@ struct RowVec_32f
     RowVec_32f( const Mat& _kernel )
     {
         kernel = _kernel;
+        if( checkHardwareSupport(CV_CPU_SSE) )
+            CV_TRACE_SIMD(CV_CPU_SSE);
     }
 
     int operator()(const uchar* _src, uchar* _dst, int width, int cn) const
@@ -1488,6 +1695,8 @@ struct SymmRowSmallVec_32f
     {
         kernel = _kernel;
         symmetryType = _symmetryType;
+        if( checkHardwareSupport(CV_CPU_SSE) )
+            CV_TRACE_SIMD(CV_CPU_SSE);
     }
 
     int operator()(const uchar* _src, uchar* _dst, int width, int cn) const
@@ -1683,6 +1892,8 @@ struct SymmColumnVec_32f
         kernel = _kernel;
         delta = (float)_delta;
         CV_Assert( (symmetryType & (KERNEL_SYMMETRICAL | KERNEL_ASYMMETRICAL)) != 0 );
+        if( checkHardwareSupport(CV_CPU_SSE) )
+            CV_TRACE_SIMD(CV_CPU_SSE);
     }
 
     int operator()(const uchar** _src, uchar* _dst, int width) const
@@ -1823,6 +2034,8 @@ struct SymmColumnSmallVec_32f
         kernel = _kernel;
         delta = (float)_delta;
         CV_Assert( (symmetryType & (KERNEL_SYMMETRICAL | KERNEL_ASYMMETRICAL)) != 0 );
+        if( checkHardwareSupport(CV_CPU_SSE) )
+            CV_TRACE_SIMD(CV_CPU_SSE);
     }
 
     int operator()(const uchar** _src, uchar* _dst, int width) const
@@ -1957,6 +2170,8 @@ struct FilterVec_8u
         vector<Point> coords;
         preprocess2DKernel(kernel, coords, coeffs);
         _nz = (int)coords.size();
+        if( checkHardwareSupport(CV_CPU_SSE2) )
+            CV_TRACE_SIMD(CV_CPU_SSE2);
     }
 
     int operator()(const uchar** src, uchar* dst, int width) const
@@ -2040,6 +2255,8 @@ struct FilterVec_8u16s
         vector<Point> coords;
         preprocess2DKernel(kernel, coords, coeffs);
         _nz = (int)coords.size();
+        if( checkHardwareSupport(CV_CPU_SSE2) )
+            CV_TRACE_SIMD(CV_CPU_SSE2);
     }
 
     int operator()(const uchar** src, uchar* _dst, int width) const
@@ -2121,6 +2338,8 @@ struct FilterVec_32f
         vector<Point> coords;
         preprocess2DKernel(_kernel, coords, coeffs);
         _nz = (int)coords.size();
+        if( checkHardwareSupport(CV_CPU_SSE) )
+            CV_TRACE_SIMD(CV_CPU_SSE);
     }
 
     int operator()(const uchar** _src, uchar* _dst, int width) const
@@ -2203,7 +2422,8 @@ typedef FilterNoVec FilterVec_32f;
 #endif
 
 
-template<typename ST, typename DT, class VecOp> struct RowFilter : public BaseRowFilter
+template<typename ST, typename DT, class VecOp> struct RowFilter :
+    public BaseRowFilter, public CloneableFilter<BaseRowFilter>
 {
     RowFilter( const Mat& _kernel, int _anchor, const VecOp& _vecOp=VecOp() )
     {
@@ -2218,6 +2438,8 @@ template<typename ST, typename DT, class VecOp> struct RowFilter : public BaseRo
         vecOp = _vecOp;
     }
 
+    Ptr<BaseRowFilter> clone() const { return new RowFilter(*this); }
+
     void operator()(const uchar* src, uchar* dst, int width, int cn)
     {
         int _ksize = ksize;
@@ -2276,6 +2498,8 @@ template<typename ST, typename DT, class VecOp> struct SymmRowSmallFilter :
         CV_Assert( (symmetryType & (KERNEL_SYMMETRICAL | KERNEL_ASYMMETRICAL)) != 0 && this->ksize <= 5 );
     }
 
+    Ptr<BaseRowFilter> clone() const { return new SymmRowSmallFilter(*this); }
+
     void operator()(const uchar* src, uchar* dst, int width, int cn)
     {
         int ksize2 = this->ksize/2, ksize2n = ksize2*cn;
@@ -2393,7 +2617,8 @@ template<typename ST, typename DT, class VecOp> struct SymmRowSmallFilter :
 };
 
 
-template<class CastOp, class VecOp> struct ColumnFilter : public BaseColumnFilter
+template<class CastOp, class VecOp> struct ColumnFilter :
+    public BaseColumnFilter, public CloneableFilter<BaseColumnFilter>
 {
     typedef typename CastOp::type1 ST;
     typedef typename CastOp::rtype DT;
@@ -2415,6 +2640,8 @@ template<class CastOp, class VecOp> struct ColumnFilter : public BaseColumnFilte
                    (kernel.rows == 1 || kernel.cols == 1));
     }
 
+    Ptr<BaseColumnFilter> clone() const { return new ColumnFilter(*this); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         const ST* ky = (const ST*)kernel.data;
@@ -2478,6 +2705,8 @@ template<class CastOp, class VecOp> struct SymmColumnFilter : public ColumnFilte
         CV_Assert( (symmetryType & (KERNEL_SYMMETRICAL | KERNEL_ASYMMETRICAL)) != 0 );
     }
 
+    Ptr<BaseColumnFilter> clone() const { return new SymmColumnFilter(*this); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         int ksize2 = this->ksize/2;
@@ -2584,6 +2813,8 @@ struct SymmColumnSmallFilter : public SymmColumnFilter<CastOp, VecOp>
         CV_Assert( this->ksize == 3 );
     }
 
+    Ptr<BaseColumnFilter> clone() const { return new SymmColumnSmallFilter(*this); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         int ksize2 = this->ksize/2;
@@ -3041,7 +3272,8 @@ void preprocess2DKernel( const Mat& kernel, vector<Point>& coords, vector<uchar>
 }
 
 
-template<typename ST, class CastOp, class VecOp> struct Filter2D : public BaseFilter
+template<typename ST, class CastOp, class VecOp> struct Filter2D :
+    public BaseFilter, public CloneableFilter<BaseFilter>
 {
     typedef typename CastOp::type1 KT;
     typedef typename CastOp::rtype DT;
@@ -3060,6 +3292,8 @@ template<typename ST, class CastOp, class VecOp> struct Filter2D : public BaseFi
         ptrs.resize( coords.size() );
     }
 
+    Ptr<BaseFilter> clone() const { return new Filter2D(*this); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width, int cn)
     {
         KT _delta = delta;
@@ -3232,6 +3466,7 @@ void cv::filter2D( InputArray _src, OutputArray _dst, int ddepth,
                    InputArray _kernel, Point anchor,
                    double delta, int borderType )
 {
+    CV_TRACE_FUNCTION();
     Mat src = _src.getMat(), kernel = _kernel.getMat();
 
     if( ddepth < 0 )
@@ -3278,6 +3513,7 @@ void cv::sepFilter2D( InputArray _src, OutputArray _dst, int ddepth,
                       InputArray _kernelX, InputArray _kernelY, Point anchor,
                       double delta, int borderType )
 {
+    CV_TRACE_FUNCTION();
     Mat src = _src.getMat(), kernelX = _kernelX.getMat(), kernelY = _kernelY.getMat();
 
     if( ddepth < 0 )
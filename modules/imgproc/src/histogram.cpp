@@ -206,6 +206,39 @@ static void histPrepareImages( const Mat* images, int nimages, const int* channe
 }
 
 
+enum { HIST_PARALLEL_MIN = 1 << 16, HIST_CHUNK_SIZE = 1 << 12 };
+
+/*
+   The parallel versions process the images prepared by histPrepareImages() by parts:
+   by rows or, if the images are continuous and thus are represented as a single row,
+   by chunks of that row. Returns the number of the parts.
+*/
+static int histPartCount( Size imsize )
+{
+    return imsize.height > 1 ? imsize.height : (imsize.width + HIST_CHUNK_SIZE - 1)/HIST_CHUNK_SIZE;
+}
+
+// sets subptrs to the beginning of the parts [r.start, r.end) and returns the size of that region
+static Size histSubImage( const vector<uchar*>& ptrs, const vector<int>& deltas, Size imsize,
+                          int dims, int esz, int maskesz, const Range& r, vector<uchar*>& subptrs )
+{
+    subptrs.resize(dims + 1);
+    if( imsize.height > 1 )
+    {
+        for( int i = 0; i < dims; i++ )
+            subptrs[i] = ptrs[i] + (size_t)r.start*(imsize.width*deltas[i*2] + deltas[i*2+1])*esz;
+        subptrs[dims] = ptrs[dims] ? ptrs[dims] + (size_t)r.start*deltas[dims*2+1]*maskesz : 0;
+        return Size(imsize.width, r.end - r.start);
+    }
+
+    int x0 = r.start*HIST_CHUNK_SIZE, x1 = std::min(r.end*HIST_CHUNK_SIZE, imsize.width);
+    for( int i = 0; i < dims; i++ )
+        subptrs[i] = ptrs[i] + (size_t)x0*deltas[i*2]*esz;
+    subptrs[dims] = ptrs[dims] ? ptrs[dims] + (size_t)x0*maskesz : 0;
+    return Size(x1 - x0, 1);
+}
+
+
 ////////////////////////////////// C A L C U L A T E    H I S T O G R A M ////////////////////////////////////
 
 template<typename T> static void
@@ -442,9 +475,15 @@ calcHist_8u( vector<uchar*>& _ptrs, const vector<int>& _deltas,
     if( dims == 1 )
     {
         int d0 = deltas[0], step0 = deltas[1];
-        int matH[256] = {0};
+        // the neighbor pixels often have the same value, so the continuous rows are counted
+        // into 4 interleaved histograms, which removes the dependency between the increments
+        int matH[256] = {0}, matH4[4][256];
+        bool interleaved = d0 == 1 && !mask;
         const uchar* p0 = (const uchar*)ptrs[0];
 
+        if( interleaved )
+            memset(matH4, 0, sizeof(matH4));
+
         for( ; imsize.height--; p0 += step0, mask += mstep )
         {
             if( !mask )
@@ -454,9 +493,9 @@ calcHist_8u( vector<uchar*>& _ptrs, const vector<int>& _deltas,
                     for( x = 0; x <= imsize.width - 4; x += 4 )
                     {
                         int t0 = p0[x], t1 = p0[x+1];
-                        matH[t0]++; matH[t1]++;
+                        matH4[0][t0]++; matH4[1][t1]++;
                         t0 = p0[x+2]; t1 = p0[x+3];
-                        matH[t0]++; matH[t1]++;
+                        matH4[2][t0]++; matH4[3][t1]++;
                     }
                     p0 += x;
                 }
@@ -480,6 +519,10 @@ calcHist_8u( vector<uchar*>& _ptrs, const vector<int>& _deltas,
                         matH[*p0]++;
         }
 
+        if( interleaved )
+            for(int i = 0; i < 256; i++ )
+                matH[i] += matH4[0][i] + matH4[1][i] + matH4[2][i] + matH4[3][i];
+
         for(int i = 0; i < 256; i++ )
         {
             size_t hidx = tab[i];
@@ -591,6 +634,75 @@ calcHist_8u( vector<uchar*>& _ptrs, const vector<int>& _deltas,
     }
 }
 
+typedef void (*CalcHistFunc)( vector<uchar*>& ptrs, const vector<int>& deltas,
+                              Size imsize, Mat& hist, int dims, const float** ranges,
+                              const double* uniranges, bool uniform );
+
+/*
+   Every stripe accumulates its own histogram, which is then added to the common one.
+   The counters are integers, so the result does not depend on the order of the merges.
+*/
+class CalcHistInvoker : public ParallelLoopBody
+{
+public:
+    CalcHistInvoker( CalcHistFunc _func, const vector<uchar*>& _ptrs, const vector<int>& _deltas,
+                     Size _imsize, Mat& _hist, int _dims, const float** _ranges,
+                     const double* _uniranges, bool _uniform, int _esz, Mutex& _histMutex ) :
+        func(_func), ptrs(_ptrs), deltas(_deltas), imsize(_imsize), hist(&_hist), dims(_dims),
+        ranges(_ranges), uniranges(_uniranges), uniform(_uniform), esz(_esz), histMutex(&_histMutex)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        vector<uchar*> subptrs;
+        Size subsize = histSubImage(ptrs, deltas, imsize, dims, esz, 1, range, subptrs);
+        Mat localHist(hist->dims, hist->size, CV_32S, Scalar::all(0));
+
+        func(subptrs, deltas, subsize, localHist, dims, ranges, uniranges, uniform);
+
+        AutoLock lock(*histMutex);
+        int* H = (int*)hist->data;
+        const int* L = (const int*)localHist.data;
+        for( size_t i = 0, total = hist->total(); i < total; i++ )
+            H[i] += L[i];
+    }
+
+private:
+    CalcHistFunc func;
+    const vector<uchar*>& ptrs;
+    const vector<int>& deltas;
+    Size imsize;
+    Mat* hist;
+    int dims;
+    const float** ranges;
+    const double* uniranges;
+    bool uniform;
+    int esz;
+    Mutex* histMutex;
+};
+
+static void calcHistRun( CalcHistFunc func, vector<uchar*>& ptrs, const vector<int>& deltas,
+                         Size imsize, Mat& hist, int dims, const float** ranges,
+                         const double* uniranges, bool uniform, int esz )
+{
+    // the private histograms should not cost more than the images themselves
+    size_t npixels = (size_t)imsize.width*imsize.height;
+    int nstripes = (int)std::min(npixels/HIST_PARALLEL_MIN, (size_t)getNumThreads());
+    nstripes = (int)std::min((size_t)nstripes, npixels/std::max(hist.total(), (size_t)1));
+    nstripes = std::min(nstripes, histPartCount(imsize));
+
+    if( nstripes > 1 && hist.isContinuous() )
+    {
+        Mutex histMutex;
+        CalcHistInvoker invoker(func, ptrs, deltas, imsize, hist, dims, ranges, uniranges,
+                                uniform, esz, histMutex);
+        parallel_for_(Range(0, histPartCount(imsize)), invoker, nstripes);
+    }
+    else
+        func(ptrs, deltas, imsize, hist, dims, ranges, uniranges, uniform);
+}
+
 }
 
 void cv::calcHist( const Mat* images, int nimages, const int* channels,
@@ -622,16 +734,20 @@ void cv::calcHist( const Mat* images, int nimages, const int* channels,
     const double* _uniranges = uniform ? &uniranges[0] : 0;
 
     int depth = images[0].depth();
+    CalcHistFunc func = 0;
 
     if( depth == CV_8U )
-        calcHist_8u(ptrs, deltas, imsize, ihist, dims, ranges, _uniranges, uniform );
+        func = calcHist_8u;
     else if( depth == CV_16U )
-        calcHist_<ushort>(ptrs, deltas, imsize, ihist, dims, ranges, _uniranges, uniform );
+        func = calcHist_<ushort>;
     else if( depth == CV_32F )
-        calcHist_<float>(ptrs, deltas, imsize, ihist, dims, ranges, _uniranges, uniform );
+        func = calcHist_<float>;
     else
         CV_Error(CV_StsUnsupportedFormat, "");
 
+    calcHistRun(func, ptrs, deltas, imsize, ihist, dims, ranges, _uniranges, uniform,
+                (int)images[0].elemSize1());
+
     ihist.convertTo(hist, CV_32F);
 }
 
@@ -1148,6 +1264,43 @@ calcBackProj_8u( vector<uchar*>& _ptrs, const vector<int>& _deltas,
     }
 }
 
+typedef void (*CalcBackProjFunc)( vector<uchar*>& ptrs, const vector<int>& deltas,
+                                  Size imsize, const Mat& hist, int dims, const float** ranges,
+                                  const double* uniranges, float scale, bool uniform );
+
+// the parts of the back projection are independent
+class CalcBackProjInvoker : public ParallelLoopBody
+{
+public:
+    CalcBackProjInvoker( CalcBackProjFunc _func, const vector<uchar*>& _ptrs, const vector<int>& _deltas,
+                         Size _imsize, const Mat& _hist, int _dims, const float** _ranges,
+                         const double* _uniranges, float _scale, bool _uniform, int _esz ) :
+        func(_func), ptrs(_ptrs), deltas(_deltas), imsize(_imsize), hist(_hist), dims(_dims),
+        ranges(_ranges), uniranges(_uniranges), scale(_scale), uniform(_uniform), esz(_esz)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        vector<uchar*> subptrs;
+        Size subsize = histSubImage(ptrs, deltas, imsize, dims, esz, esz, range, subptrs);
+        func(subptrs, deltas, subsize, hist, dims, ranges, uniranges, scale, uniform);
+    }
+
+private:
+    CalcBackProjFunc func;
+    const vector<uchar*>& ptrs;
+    const vector<int>& deltas;
+    Size imsize;
+    Mat hist;
+    int dims;
+    const float** ranges;
+    const double* uniranges;
+    float scale;
+    bool uniform;
+    int esz;
+};
+
 }
 
 void cv::calcBackProject( const Mat* images, int nimages, const int* channels,
@@ -1169,14 +1322,26 @@ void cv::calcBackProject( const Mat* images, int nimages, const int* channels,
     const double* _uniranges = uniform ? &uniranges[0] : 0;
 
     int depth = images[0].depth();
+    CalcBackProjFunc func = 0;
     if( depth == CV_8U )
-        calcBackProj_8u(ptrs, deltas, imsize, hist, dims, ranges, _uniranges, (float)scale, uniform);
+        func = calcBackProj_8u;
     else if( depth == CV_16U )
-        calcBackProj_<ushort, ushort>(ptrs, deltas, imsize, hist, dims, ranges, _uniranges, (float)scale, uniform );
+        func = calcBackProj_<ushort, ushort>;
     else if( depth == CV_32F )
-        calcBackProj_<float, float>(ptrs, deltas, imsize, hist, dims, ranges, _uniranges, (float)scale, uniform );
+        func = calcBackProj_<float, float>;
     else
         CV_Error(CV_StsUnsupportedFormat, "");
+
+    size_t npixels = (size_t)imsize.width*imsize.height;
+    int nstripes = (int)std::min(npixels/HIST_PARALLEL_MIN, (size_t)histPartCount(imsize));
+    if( nstripes > 1 )
+    {
+        CalcBackProjInvoker invoker(func, ptrs, deltas, imsize, hist, dims, ranges, _uniranges,
+                                    (float)scale, uniform, (int)images[0].elemSize1());
+        parallel_for_(Range(0, histPartCount(imsize)), invoker, nstripes);
+    }
+    else
+        func(ptrs, deltas, imsize, hist, dims, ranges, _uniranges, (float)scale, uniform);
 }
 
 
@@ -1385,6 +1550,153 @@ void cv::calcBackProject( InputArrayOfArrays images, const vector<int>& channels
 }
 
 
+////////////////////////////////// S L I D I N G   H I S T O G R A M ////////////////////////////////////
+
+cv::SlidingHistogram::SlidingHistogram()
+{
+}
+
+cv::SlidingHistogram::SlidingHistogram( const vector<int>& _channels, const vector<int>& histSize,
+                                        const vector<float>& ranges )
+{
+    create(_channels, histSize, ranges);
+}
+
+void cv::SlidingHistogram::create( const vector<int>& _channels, const vector<int>& histSize,
+                                   const vector<float>& ranges )
+{
+    int i, dims = (int)histSize.size();
+    CV_Assert( dims > 0 && dims <= CV_MAX_DIM );
+    CV_Assert( _channels.empty() || (int)_channels.size() == dims );
+    CV_Assert( ranges.empty() || (int)ranges.size() == dims*2 );
+
+    counts.create(dims, &histSize[0], CV_32S);
+    counts = Scalar::all(0);
+
+    channels.resize(dims);
+    vector<double> uniranges(dims*2);
+    for( i = 0; i < dims; i++ )
+    {
+        channels[i] = _channels.empty() ? i : _channels[i];
+        CV_Assert( channels[i] >= 0 && histSize[i] > 0 );
+        if( ranges.empty() )
+        {
+            uniranges[i*2] = histSize[i]/256.;
+            uniranges[i*2+1] = 0;
+        }
+        else
+        {
+            double low = ranges[i*2], high = ranges[i*2+1];
+            CV_Assert( low < high );
+            double t = histSize[i]/(high - low);
+            uniranges[i*2] = t;
+            uniranges[i*2+1] = -t*low;
+        }
+    }
+
+    calcHistLookupTables_8u( counts, SparseMat(), dims, 0, &uniranges[0], true, false, tab );
+    image.release();
+    win = Rect();
+}
+
+void cv::SlidingHistogram::setImage( InputArray _image, Rect window )
+{
+    CV_Assert( !counts.empty() );
+    image = _image.getMat();
+    CV_Assert( image.dims <= 2 && image.depth() == CV_8U );
+    for( size_t i = 0; i < channels.size(); i++ )
+        CV_Assert( channels[i] < image.channels() );
+    CV_Assert( (window & Rect(0, 0, image.cols, image.rows)) == window );
+
+    counts = Scalar::all(0);
+    addRect(window, 1);
+    win = window;
+}
+
+void cv::SlidingHistogram::moveWindow( Rect window )
+{
+    CV_Assert( image.data && (window & Rect(0, 0, image.cols, image.rows)) == window );
+
+    Rect inter = win & window;
+
+    // starting from scratch is cheaper when the windows barely overlap
+    if( window.area() <= win.area() + window.area() - inter.area()*2 )
+    {
+        counts = Scalar::all(0);
+        addRect(window, 1);
+        win = window;
+        return;
+    }
+
+    // remove the pixels of the old window that are not in the new one, then add the new pixels
+    for( int k = 0; k < 2; k++ )
+    {
+        const Rect& r = k == 0 ? win : window;
+        int delta = k == 0 ? -1 : 1;
+        int iy1 = inter.y + inter.height, ix1 = inter.x + inter.width;
+
+        addRect(Rect(r.x, r.y, r.width, inter.y - r.y), delta);
+        addRect(Rect(r.x, iy1, r.width, r.y + r.height - iy1), delta);
+        addRect(Rect(r.x, inter.y, inter.x - r.x, inter.height), delta);
+        addRect(Rect(ix1, inter.y, r.x + r.width - ix1, inter.height), delta);
+    }
+    win = window;
+}
+
+cv::Rect cv::SlidingHistogram::window() const
+{
+    return win;
+}
+
+void cv::SlidingHistogram::getHist( OutputArray hist ) const
+{
+    counts.convertTo(hist, CV_32F);
+}
+
+void cv::SlidingHistogram::addRect( Rect r, int delta )
+{
+    if( r.width <= 0 || r.height <= 0 )
+        return;
+
+    int x, y, i, dims = (int)channels.size(), cn = image.channels();
+    const size_t* _tab = &tab[0];
+    uchar* H = counts.data;
+
+    for( y = r.y; y < r.y + r.height; y++ )
+    {
+        const uchar* p = image.ptr(y) + r.x*cn;
+
+        if( dims == 1 )
+        {
+            const uchar* p0 = p + channels[0];
+            for( x = 0; x < r.width; x++, p0 += cn )
+            {
+                size_t idx = _tab[*p0];
+                if( idx < OUT_OF_RANGE )
+                    *(int*)(H + idx) += delta;
+            }
+        }
+        else
+        {
+            for( x = 0; x < r.width; x++, p += cn )
+            {
+                uchar* Hptr = H;
+                for( i = 0; i < dims; i++ )
+                {
+                    size_t idx = _tab[p[channels[i]] + i*256];
+                    if( idx >= OUT_OF_RANGE )
+                        break;
+                    Hptr += idx;
+                }
+
+                if( i == dims )
+                    *(int*)Hptr += delta;
+            }
+        }
+    }
+}
+
+
 ////////////////// C O M P A R E   H I S T O G R A M S ////////////////////////
 
 double cv::compareHist( InputArray _H1, InputArray _H2, int method )
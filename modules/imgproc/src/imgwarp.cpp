@@ -344,6 +344,12 @@ struct HResizeNoVec
 
 struct VResizeLinearVec_32s8u
 {
+    VResizeLinearVec_32s8u()
+    {
+        if( checkHardwareSupport(CV_CPU_SSE2) )
+            CV_TRACE_SIMD(CV_CPU_SSE2);
+    }
+
     int operator()(const uchar** _src, uchar* dst, const uchar* _beta, int width ) const
     {
         if( !checkHardwareSupport(CV_CPU_SSE2) )
@@ -427,6 +433,12 @@ struct VResizeLinearVec_32s8u
 
 template<int shiftval> struct VResizeLinearVec_32f16
 {
+    VResizeLinearVec_32f16()
+    {
+        if( checkHardwareSupport(CV_CPU_SSE2) )
+            CV_TRACE_SIMD(CV_CPU_SSE2);
+    }
+
     int operator()(const uchar** _src, uchar* _dst, const uchar* _beta, int width ) const
     {
         if( !checkHardwareSupport(CV_CPU_SSE2) )
@@ -525,6 +537,12 @@ typedef VResizeLinearVec_32f16<0> VResizeLinearVec_32f16s;
 
 struct VResizeLinearVec_32f
 {
+    VResizeLinearVec_32f()
+    {
+        if( checkHardwareSupport(CV_CPU_SSE) )
+            CV_TRACE_SIMD(CV_CPU_SSE);
+    }
+
     int operator()(const uchar** _src, uchar* _dst, const uchar* _beta, int width ) const
     {
         if( !checkHardwareSupport(CV_CPU_SSE) )
@@ -576,6 +594,12 @@ struct VResizeLinearVec_32f
 
 struct VResizeCubicVec_32s8u
 {
+    VResizeCubicVec_32s8u()
+    {
+        if( checkHardwareSupport(CV_CPU_SSE2) )
+            CV_TRACE_SIMD(CV_CPU_SSE2);
+    }
+
     int operator()(const uchar** _src, uchar* dst, const uchar* _beta, int width ) const
     {
         if( !checkHardwareSupport(CV_CPU_SSE2) )
@@ -671,6 +695,12 @@ struct VResizeCubicVec_32s8u
 
 template<int shiftval> struct VResizeCubicVec_32f16
 {
+    VResizeCubicVec_32f16()
+    {
+        if( checkHardwareSupport(CV_CPU_SSE2) )
+            CV_TRACE_SIMD(CV_CPU_SSE2);
+    }
+
     int operator()(const uchar** _src, uchar* _dst, const uchar* _beta, int width ) const
     {
         if( !checkHardwareSupport(CV_CPU_SSE2) )
@@ -732,6 +762,12 @@ typedef VResizeCubicVec_32f16<0> VResizeCubicVec_32f16s;
 
 struct VResizeCubicVec_32f
 {
+    VResizeCubicVec_32f()
+    {
+        if( checkHardwareSupport(CV_CPU_SSE) )
+            CV_TRACE_SIMD(CV_CPU_SSE);
+    }
+
     int operator()(const uchar** _src, uchar* _dst, const uchar* _beta, int width ) const
     {
         if( !checkHardwareSupport(CV_CPU_SSE) )
@@ -869,7 +905,6 @@ struct VResizeLinear
         WT b0 = beta[0], b1 = beta[1];
         const WT *S0 = src[0], *S1 = src[1];
         CastOp castOp;
-        VecOp vecOp;
 
         int x = vecOp((const uchar**)src, (uchar*)dst, (const uchar*)beta, width);
         #if CV_ENABLE_UNROLLED
@@ -887,6 +922,8 @@ struct VResizeLinear
         for( ; x < width; x++ )
             dst[x] = castOp(S0[x]*b0 + S1[x]*b1);
     }
+
+    VecOp vecOp;
 };
 
 template<>
@@ -900,7 +937,6 @@ struct VResizeLinear<uchar, int, short, FixedPtCast<int, uchar, INTER_RESIZE_COE
     {
         alpha_type b0 = beta[0], b1 = beta[1];
         const buf_type *S0 = src[0], *S1 = src[1];
-        VResizeLinearVec_32s8u vecOp;
 
         int x = vecOp((const uchar**)src, (uchar*)dst, (const uchar*)beta, width);
         #if CV_ENABLE_UNROLLED
@@ -915,6 +951,8 @@ struct VResizeLinear<uchar, int, short, FixedPtCast<int, uchar, INTER_RESIZE_COE
         for( ; x < width; x++ )
             dst[x] = uchar(( ((b0 * (S0[x] >> 4)) >> 16) + ((b1 * (S1[x] >> 4)) >> 16) + 2)>>2);
     }
+
+    VResizeLinearVec_32s8u vecOp;
 };
 
 
@@ -982,12 +1020,13 @@ struct VResizeCubic
         WT b0 = beta[0], b1 = beta[1], b2 = beta[2], b3 = beta[3];
         const WT *S0 = src[0], *S1 = src[1], *S2 = src[2], *S3 = src[3];
         CastOp castOp;
-        VecOp vecOp;
 
         int x = vecOp((const uchar**)src, (uchar*)dst, (const uchar*)beta, width);
         for( ; x < width; x++ )
             dst[x] = castOp(S0[x]*b0 + S1[x]*b1 + S2[x]*b2 + S3[x]*b3);
     }
+
+    VecOp vecOp;
 };
 
 
@@ -1055,7 +1094,6 @@ struct VResizeLanczos4
     void operator()(const WT** src, T* dst, const AT* beta, int width ) const
     {
         CastOp castOp;
-        VecOp vecOp;
         int k, x = vecOp((const uchar**)src, (uchar*)dst, (const uchar*)beta, width);
         #if CV_ENABLE_UNROLLED
         for( ; x <= width - 4; x += 4 )
@@ -1082,6 +1120,8 @@ struct VResizeLanczos4
                 src[5][x]*beta[5] + src[6][x]*beta[6] + src[7][x]*beta[7]);
         }
     }
+
+    VecOp vecOp;
 };
 
 
@@ -1092,134 +1132,197 @@ static inline int clip(int x, int a, int b)
 
 static const int MAX_ESIZE=16;
 
+// the images with fewer destination pixels are processed by a single thread
+enum { WARP_PARALLEL_MIN = 1 << 16 };
+
+// runs the loop over the destination rows in parallel if the destination is big enough
+static void warpParallelFor( const Mat& dst, const ParallelLoopBody& body )
+{
+    Range range(0, dst.rows);
+    double total = (double)dst.total();
+    if( total >= WARP_PARALLEL_MIN )
+        parallel_for_(range, body, total/WARP_PARALLEL_MIN);
+    else
+        body(range);
+}
+
+// image resize is a separable operation: each destination row is computed from ksize rows
+// resized horizontally, which are kept in a ring buffer. Each stripe of rows has its own buffer,
+// so the output does not depend on the way the rows are split between the threads
 template<class HResize, class VResize>
-static void resizeGeneric_( const Mat& src, Mat& dst,
-                            const int* xofs, const void* _alpha,
-                            const int* yofs, const void* _beta,
-                            int xmin, int xmax, int ksize )
+class ResizeGenericInvoker : public ParallelLoopBody
 {
+public:
     typedef typename HResize::value_type T;
     typedef typename HResize::buf_type WT;
     typedef typename HResize::alpha_type AT;
 
-    const AT* alpha = (const AT*)_alpha;
-    const AT* beta = (const AT*)_beta;
-    Size ssize = src.size(), dsize = dst.size();
-    int cn = src.channels();
-    ssize.width *= cn;
-    dsize.width *= cn;
-    int bufstep = (int)alignSize(dsize.width, 16);
-    AutoBuffer<WT> _buffer(bufstep*ksize);
-    const T* srows[MAX_ESIZE]={0};
-    WT* rows[MAX_ESIZE]={0};
-    int prev_sy[MAX_ESIZE];
-    int dy;
-    xmin *= cn;
-    xmax *= cn;
-
-    HResize hresize;
-    VResize vresize;
-
-    for(int k = 0; k < ksize; k++ )
+    ResizeGenericInvoker( const Mat& _src, Mat& _dst, const int* _xofs, const int* _yofs,
+                          const AT* _alpha, const AT* _beta, int _xmin, int _xmax, int _ksize )
+        : src(&_src), dst(&_dst), xofs(_xofs), yofs(_yofs), alpha(_alpha), beta(_beta),
+          xmin(_xmin), xmax(_xmax), ksize(_ksize)
     {
-        prev_sy[k] = -1;
-        rows[k] = (WT*)_buffer + bufstep*k;
     }
 
-    // image resize is a separable operation. In case of not too strong
-    for( dy = 0; dy < dsize.height; dy++, beta += ksize )
+    void operator()(const Range& range) const
     {
-        int sy0 = yofs[dy], k0=ksize, k1=0, ksize2 = ksize/2;
+        Size ssize = src->size(), dsize = dst->size();
+        int cn = src->channels();
+        ssize.width *= cn;
+        dsize.width *= cn;
+        int bufstep = (int)alignSize(dsize.width, 16);
+        AutoBuffer<WT> _buffer(bufstep*ksize);
+        const T* srows[MAX_ESIZE]={0};
+        WT* rows[MAX_ESIZE]={0};
+        int prev_sy[MAX_ESIZE];
+        int dy, xmin1 = xmin*cn, xmax1 = xmax*cn;
+
+        HResize hresize;
+        VResize vresize;
 
         for(int k = 0; k < ksize; k++ )
         {
-            int sy = clip(sy0 - ksize2 + 1 + k, 0, ssize.height);
-            for( k1 = std::max(k1, k); k1 < ksize; k1++ )
+            prev_sy[k] = -1;
+            rows[k] = (WT*)_buffer + bufstep*k;
+        }
+
+        for( dy = range.start; dy < range.end; dy++ )
+        {
+            int sy0 = yofs[dy], k0=ksize, k1=0, ksize2 = ksize/2;
+
+            for(int k = 0; k < ksize; k++ )
             {
-                if( sy == prev_sy[k1] ) // if the sy-th row has been computed already, reuse it.
+                int sy = clip(sy0 - ksize2 + 1 + k, 0, ssize.height);
+                for( k1 = std::max(k1, k); k1 < ksize; k1++ )
                 {
-                    if( k1 > k )
-                        memcpy( rows[k], rows[k1], bufstep*sizeof(rows[0][0]) );
-                    break;
+                    if( sy == prev_sy[k1] ) // if the sy-th row has been computed already, reuse it.
+                    {
+                        if( k1 > k )
+                            memcpy( rows[k], rows[k1], bufstep*sizeof(rows[0][0]) );
+                        break;
+                    }
                 }
+                if( k1 == ksize )
+                    k0 = std::min(k0, k); // remember the first row that needs to be computed
+                srows[k] = (const T*)(src->data + src->step*sy);
+                prev_sy[k] = sy;
             }
-            if( k1 == ksize )
-                k0 = std::min(k0, k); // remember the first row that needs to be computed
-            srows[k] = (const T*)(src.data + src.step*sy);
-            prev_sy[k] = sy;
-        }
 
-        if( k0 < ksize )
-            hresize( srows + k0, rows + k0, ksize - k0, xofs, alpha,
-                     ssize.width, dsize.width, cn, xmin, xmax );
-        vresize( (const WT**)rows, (T*)(dst.data + dst.step*dy), beta, dsize.width );
+            if( k0 < ksize )
+                hresize( srows + k0, rows + k0, ksize - k0, xofs, alpha,
+                         ssize.width, dsize.width, cn, xmin1, xmax1 );
+            vresize( (const WT**)rows, (T*)(dst->data + dst->step*dy), beta + ksize*dy, dsize.width );
+        }
     }
+
+protected:
+    const Mat* src;
+    Mat* dst;
+    const int* xofs, *yofs;
+    const AT* alpha, *beta;
+    int xmin, xmax, ksize;
+};
+
+template<class HResize, class VResize>
+static void resizeGeneric_( const Mat& src, Mat& dst,
+                            const int* xofs, const void* _alpha,
+                            const int* yofs, const void* _beta,
+                            int xmin, int xmax, int ksize )
+{
+    typedef typename HResize::alpha_type AT;
+
+    ResizeGenericInvoker<HResize, VResize> invoker(src, dst, xofs, yofs, (const AT*)_alpha,
+                                                   (const AT*)_beta, xmin, xmax, ksize);
+    warpParallelFor(dst, invoker);
 }
 
 
 template<typename T, typename WT>
-static void resizeAreaFast_( const Mat& src, Mat& dst, const int* ofs, const int* xofs,
-                             int scale_x, int scale_y )
+class ResizeAreaFastInvoker : public ParallelLoopBody
 {
-    Size ssize = src.size(), dsize = dst.size();
-    int cn = src.channels();
-    int dy, dx, k = 0;
-    int area = scale_x*scale_y;
-    float scale = 1.f/(scale_x*scale_y);
-    int dwidth1 = (ssize.width/scale_x)*cn;
-    dsize.width *= cn;
-    ssize.width *= cn;
+public:
+    ResizeAreaFastInvoker( const Mat& _src, Mat& _dst, const int* _ofs, const int* _xofs,
+                           int _scale_x, int _scale_y )
+        : src(&_src), dst(&_dst), ofs(_ofs), xofs(_xofs), scale_x(_scale_x), scale_y(_scale_y)
+    {
+    }
 
-    for( dy = 0; dy < dsize.height; dy++ )
+    void operator()(const Range& range) const
     {
-        T* D = (T*)(dst.data + dst.step*dy);
-        int sy0 = dy*scale_y, w = sy0 + scale_y <= ssize.height ? dwidth1 : 0;
-        if( sy0 >= ssize.height )
-        {
-            for( dx = 0; dx < dsize.width; dx++ )
-                D[dx] = 0;
-            continue;
-        }
+        Size ssize = src->size(), dsize = dst->size();
+        int cn = src->channels();
+        int dy, dx, k = 0;
+        int area = scale_x*scale_y;
+        float scale = 1.f/(scale_x*scale_y);
+        int dwidth1 = (ssize.width/scale_x)*cn;
+        dsize.width *= cn;
+        ssize.width *= cn;
 
-        for( dx = 0; dx < w; dx++ )
+        for( dy = range.start; dy < range.end; dy++ )
         {
-            const T* S = (const T*)(src.data + src.step*sy0) + xofs[dx];
-            WT sum = 0;
-            k=0;
-            #if CV_ENABLE_UNROLLED
-            for( ; k <= area - 4; k += 4 )
-                sum += S[ofs[k]] + S[ofs[k+1]] + S[ofs[k+2]] + S[ofs[k+3]];
-            #endif
-            for( ; k < area; k++ )
-                sum += S[ofs[k]];
-
-            D[dx] = saturate_cast<T>(sum*scale);
-        }
+            T* D = (T*)(dst->data + dst->step*dy);
+            int sy0 = dy*scale_y, w = sy0 + scale_y <= ssize.height ? dwidth1 : 0;
+            if( sy0 >= ssize.height )
+            {
+                for( dx = 0; dx < dsize.width; dx++ )
+                    D[dx] = 0;
+                continue;
+            }
 
-        for( ; dx < dsize.width; dx++ )
-        {
-            WT sum = 0;
-            int count = 0, sx0 = xofs[dx];
-            if( sx0 >= ssize.width )
-                D[dx] = 0;
+            for( dx = 0; dx < w; dx++ )
+            {
+                const T* S = (const T*)(src->data + src->step*sy0) + xofs[dx];
+                WT sum = 0;
+                k=0;
+                #if CV_ENABLE_UNROLLED
+                for( ; k <= area - 4; k += 4 )
+                    sum += S[ofs[k]] + S[ofs[k+1]] + S[ofs[k+2]] + S[ofs[k+3]];
+                #endif
+                for( ; k < area; k++ )
+                    sum += S[ofs[k]];
 
-            for( int sy = 0; sy < scale_y; sy++ )
+                D[dx] = saturate_cast<T>(sum*scale);
+            }
+
+            for( ; dx < dsize.width; dx++ )
             {
-                if( sy0 + sy >= ssize.height )
-                    break;
-                const T* S = (const T*)(src.data + src.step*(sy0 + sy)) + sx0;
-                for( int sx = 0; sx < scale_x*cn; sx += cn )
+                WT sum = 0;
+                int count = 0, sx0 = xofs[dx];
+                if( sx0 >= ssize.width )
+                    D[dx] = 0;
+
+                for( int sy = 0; sy < scale_y; sy++ )
                 {
-                    if( sx0 + sx >= ssize.width )
+                    if( sy0 + sy >= ssize.height )
                         break;
-                    sum += S[sx];
-                    count++;
+                    const T* S = (const T*)(src->data + src->step*(sy0 + sy)) + sx0;
+                    for( int sx = 0; sx < scale_x*cn; sx += cn )
+                    {
+                        if( sx0 + sx >= ssize.width )
+                            break;
+                        sum += S[sx];
+                        count++;
+                    }
                 }
-            }
 
-            D[dx] = saturate_cast<T>((float)sum/count);
+                D[dx] = saturate_cast<T>((float)sum/count);
+            }
         }
     }
+
+protected:
+    const Mat* src;
+    Mat* dst;
+    const int* ofs, *xofs;
+    int scale_x, scale_y;
+};
+
+template<typename T, typename WT>
+static void resizeAreaFast_( const Mat& src, Mat& dst, const int* ofs, const int* xofs,
+                             int scale_x, int scale_y )
+{
+    ResizeAreaFastInvoker<T, WT> invoker(src, dst, ofs, xofs, scale_x, scale_y);
+    warpParallelFor(dst, invoker);
 }
 
 struct DecimateAlpha
@@ -1349,6 +1452,7 @@ typedef void (*ResizeAreaFunc)( const Mat& src, Mat& dst,
 void cv::resize( InputArray _src, OutputArray _dst, Size dsize,
                  double inv_scale_x, double inv_scale_y, int interpolation )
 {
+    CV_TRACE_FUNCTION();
     static ResizeFunc linear_tab[] =
     {
         resizeGeneric_<
@@ -2432,12 +2536,225 @@ typedef void (*RemapFunc)(const Mat& _src, Mat& _dst, const Mat& _xy,
                           const Mat& _fxy, const void* _wtab,
                           int borderType, const Scalar& _borderValue);
 
+// remap processes the destination image by blocks; the block coordinates are converted
+// to the fixed-point representation into the per-stripe buffers, so that the horizontal
+// bands of the destination image can be computed independently
+class RemapInvoker : public ParallelLoopBody
+{
+public:
+    RemapInvoker( const Mat& _src, Mat& _dst, const Mat* _m1, const Mat* _m2,
+                  RemapNNFunc _nnfunc, RemapFunc _ifunc, const void* _ctab,
+                  bool _direct, bool _planar_input, int _borderType, const Scalar& _borderValue )
+        : src(&_src), dst(&_dst), m1(_m1), m2(_m2), nnfunc(_nnfunc), ifunc(_ifunc), ctab(_ctab),
+          direct(_direct), planar_input(_planar_input), borderType(_borderType),
+          borderValue(_borderValue)
+    {
+    }
+
+    void operator()(const Range& range) const
+    {
+        if( direct )
+        {
+            // the maps are already in the right format, just process the band of rows
+            Mat dpart = dst->rowRange(range), mpart1 = m1->rowRange(range), mpart2;
+            if( m2->data )
+                mpart2 = m2->rowRange(range);
+            if( nnfunc )
+                nnfunc( *src, dpart, mpart1, borderType, borderValue );
+            else
+                ifunc( *src, dpart, mpart1, mpart2, ctab, borderType, borderValue );
+            return;
+        }
+
+        const Mat& map1 = *m1;
+        const Mat& map2 = *m2;
+        int map_depth = map1.depth();
+        int x, y, x1, y1;
+        const int buf_size = 1 << 14;
+        int brows0 = std::min(128, dst->rows);
+        int bcols0 = std::min(buf_size/brows0, dst->cols);
+        brows0 = std::min(buf_size/bcols0, dst->rows);
+    #if CV_SSE2
+        bool useSIMD = checkHardwareSupport(CV_CPU_SSE2);
+        if( useSIMD )
+            CV_TRACE_SIMD(CV_CPU_SSE2);
+    #endif
+
+        Mat _bufxy(brows0, bcols0, CV_16SC2), _bufa;
+        if( !nnfunc )
+            _bufa.create(brows0, bcols0, CV_16UC1);
+
+        for( y = range.start; y < range.end; y += brows0 )
+        {
+            for( x = 0; x < dst->cols; x += bcols0 )
+            {
+                int brows = std::min(brows0, range.end - y);
+                int bcols = std::min(bcols0, dst->cols - x);
+                Mat dpart(*dst, Rect(x, y, bcols, brows));
+                Mat bufxy(_bufxy, Rect(0, 0, bcols, brows));
+
+                if( nnfunc )
+                {
+                    if( map_depth != CV_32F )
+                    {
+                        for( y1 = 0; y1 < brows; y1++ )
+                        {
+                            short* XY = (short*)(bufxy.data + bufxy.step*y1);
+                            const short* sXY = (const short*)(m1->data + m1->step*(y+y1)) + x*2;
+                            const ushort* sA = (const ushort*)(m2->data + m2->step*(y+y1)) + x;
+
+                            for( x1 = 0; x1 < bcols; x1++ )
+                            {
+                                int a = sA[x1] & (INTER_TAB_SIZE2-1);
+                                XY[x1*2] = sXY[x1*2] + NNDeltaTab_i[a][0];
+                                XY[x1*2+1] = sXY[x1*2+1] + NNDeltaTab_i[a][1];
+                            }
+                        }
+                    }
+                    else if( !planar_input )
+                        map1(Rect(x, y, bcols, brows)).convertTo(bufxy, bufxy.depth());
+                    else
+                    {
+                        for( y1 = 0; y1 < brows; y1++ )
+                        {
+                            short* XY = (short*)(bufxy.data + bufxy.step*y1);
+                            const float* sX = (const float*)(map1.data + map1.step*(y+y1)) + x;
+                            const float* sY = (const float*)(map2.data + map2.step*(y+y1)) + x;
+                            x1 = 0;
+
+                        #if CV_SSE2
+                            if( useSIMD )
+                            {
+                                for( ; x1 <= bcols - 8; x1 += 8 )
+                                {
+                                    __m128 fx0 = _mm_loadu_ps(sX + x1);
+                                    __m128 fx1 = _mm_loadu_ps(sX + x1 + 4);
+                                    __m128 fy0 = _mm_loadu_ps(sY + x1);
+                                    __m128 fy1 = _mm_loadu_ps(sY + x1 + 4);
+                                    __m128i ix0 = _mm_cvtps_epi32(fx0);
+                                    __m128i ix1 = _mm_cvtps_epi32(fx1);
+                                    __m128i iy0 = _mm_cvtps_epi32(fy0);
+                                    __m128i iy1 = _mm_cvtps_epi32(fy1);
+                                    ix0 = _mm_packs_epi32(ix0, ix1);
+                                    iy0 = _mm_packs_epi32(iy0, iy1);
+                                    ix1 = _mm_unpacklo_epi16(ix0, iy0);
+                                    iy1 = _mm_unpackhi_epi16(ix0, iy0);
+                                    _mm_storeu_si128((__m128i*)(XY + x1*2), ix1);
+                                    _mm_storeu_si128((__m128i*)(XY + x1*2 + 8), iy1);
+                                }
+                            }
+                        #endif
+
+                            for( ; x1 < bcols; x1++ )
+                            {
+                                XY[x1*2] = saturate_cast<short>(sX[x1]);
+                                XY[x1*2+1] = saturate_cast<short>(sY[x1]);
+                            }
+                        }
+                    }
+                    nnfunc( *src, dpart, bufxy, borderType, borderValue );
+                    continue;
+                }
+
+                Mat bufa(_bufa, Rect(0,0,bcols, brows));
+                for( y1 = 0; y1 < brows; y1++ )
+                {
+                    short* XY = (short*)(bufxy.data + bufxy.step*y1);
+                    ushort* A = (ushort*)(bufa.data + bufa.step*y1);
+
+                    if( planar_input )
+                    {
+                        const float* sX = (const float*)(map1.data + map1.step*(y+y1)) + x;
+                        const float* sY = (const float*)(map2.data + map2.step*(y+y1)) + x;
+
+                        x1 = 0;
+                    #if CV_SSE2
+                        if( useSIMD )
+                        {
+                            __m128 scale = _mm_set1_ps((float)INTER_TAB_SIZE);
+                            __m128i mask = _mm_set1_epi32(INTER_TAB_SIZE-1);
+                            for( ; x1 <= bcols - 8; x1 += 8 )
+                            {
+                                __m128 fx0 = _mm_loadu_ps(sX + x1);
+                                __m128 fx1 = _mm_loadu_ps(sX + x1 + 4);
+                                __m128 fy0 = _mm_loadu_ps(sY + x1);
+                                __m128 fy1 = _mm_loadu_ps(sY + x1 + 4);
+                                __m128i ix0 = _mm_cvtps_epi32(_mm_mul_ps(fx0, scale));
+                                __m128i ix1 = _mm_cvtps_epi32(_mm_mul_ps(fx1, scale));
+                                __m128i iy0 = _mm_cvtps_epi32(_mm_mul_ps(fy0, scale));
+                                __m128i iy1 = _mm_cvtps_epi32(_mm_mul_ps(fy1, scale));
+                                __m128i mx0 = _mm_and_si128(ix0, mask);
+                                __m128i mx1 = _mm_and_si128(ix1, mask);
+                                __m128i my0 = _mm_and_si128(iy0, mask);
+                                __m128i my1 = _mm_and_si128(iy1, mask);
+                                mx0 = _mm_packs_epi32(mx0, mx1);
+                                my0 = _mm_packs_epi32(my0, my1);
+                                my0 = _mm_slli_epi16(my0, INTER_BITS);
+                                mx0 = _mm_or_si128(mx0, my0);
+                                _mm_storeu_si128((__m128i*)(A + x1), mx0);
+                                ix0 = _mm_srai_epi32(ix0, INTER_BITS);
+                                ix1 = _mm_srai_epi32(ix1, INTER_BITS);
+                                iy0 = _mm_srai_epi32(iy0, INTER_BITS);
+                                iy1 = _mm_srai_epi32(iy1, INTER_BITS);
+                                ix0 = _mm_packs_epi32(ix0, ix1);
+                                iy0 = _mm_packs_epi32(iy0, iy1);
+                                ix1 = _mm_unpacklo_epi16(ix0, iy0);
+                                iy1 = _mm_unpackhi_epi16(ix0, iy0);
+                                _mm_storeu_si128((__m128i*)(XY + x1*2), ix1);
+                                _mm_storeu_si128((__m128i*)(XY + x1*2 + 8), iy1);
+                            }
+                        }
+                    #endif
+
+                        for( ; x1 < bcols; x1++ )
+                        {
+                            int sx = cvRound(sX[x1]*INTER_TAB_SIZE);
+                            int sy = cvRound(sY[x1]*INTER_TAB_SIZE);
+                            int v = (sy & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE + (sx & (INTER_TAB_SIZE-1));
+                            XY[x1*2] = (short)(sx >> INTER_BITS);
+                            XY[x1*2+1] = (short)(sy >> INTER_BITS);
+                            A[x1] = (ushort)v;
+                        }
+                    }
+                    else
+                    {
+                        const float* sXY = (const float*)(map1.data + map1.step*(y+y1)) + x*2;
+
+                        for( x1 = 0; x1 < bcols; x1++ )
+                        {
+                            int sx = cvRound(sXY[x1*2]*INTER_TAB_SIZE);
+                            int sy = cvRound(sXY[x1*2+1]*INTER_TAB_SIZE);
+                            int v = (sy & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE + (sx & (INTER_TAB_SIZE-1));
+                            XY[x1*2] = (short)(sx >> INTER_BITS);
+                            XY[x1*2+1] = (short)(sy >> INTER_BITS);
+                            A[x1] = (ushort)v;
+                        }
+                    }
+                }
+                ifunc(*src, dpart, bufxy, bufa, ctab, borderType, borderValue);
+            }
+        }
+    }
+
+protected:
+    const Mat* src;
+    Mat* dst;
+    const Mat *m1, *m2;
+    RemapNNFunc nnfunc;
+    RemapFunc ifunc;
+    const void* ctab;
+    bool direct, planar_input;
+    int borderType;
+    Scalar borderValue;
+};
+
 }
 
 void cv::remap( InputArray _src, OutputArray _dst,
                 InputArray _map1, InputArray _map2,
                 int interpolation, int borderType, const Scalar& borderValue )
 {
+    CV_TRACE_FUNCTION();
     static RemapNNFunc nn_tab[] =
     {
         remapNearest<uchar>, remapNearest<schar>, remapNearest<ushort>, remapNearest<short>,
@@ -2480,7 +2797,7 @@ void cv::remap( InputArray _src, OutputArray _dst,
     if( dst.data == src.data )
         src = src.clone();
 
-    int depth = src.depth(), map_depth = map1.depth();
+    int depth = src.depth();
     RemapNNFunc nnfunc = 0;
     RemapFunc ifunc = 0;
     const void* ctab = 0;
@@ -2494,7 +2811,9 @@ void cv::remap( InputArray _src, OutputArray _dst,
 
         if( map1.type() == CV_16SC2 && !map2.data ) // the data is already in the right format
         {
-            nnfunc( src, dst, map1, borderType, borderValue );
+            RemapInvoker invoker(src, dst, &map1, &map2, nnfunc, 0, 0, true, false,
+                                 borderType, borderValue);
+            warpParallelFor(dst, invoker);
             return;
         }
     }
@@ -2524,7 +2843,9 @@ void cv::remap( InputArray _src, OutputArray _dst,
             std::swap(m1, m2);
         if( ifunc )
         {
-            ifunc( src, dst, *m1, *m2, ctab, borderType, borderValue );
+            RemapInvoker invoker(src, dst, m1, m2, 0, ifunc, ctab, true, false,
+                                 borderType, borderValue);
+            warpParallelFor(dst, invoker);
             return;
         }
     }
@@ -2535,169 +2856,9 @@ void cv::remap( InputArray _src, OutputArray _dst,
         planar_input = map1.channels() == 1;
     }
 
-    int x, y, x1, y1;
-    const int buf_size = 1 << 14;
-    int brows0 = std::min(128, dst.rows);
-    int bcols0 = std::min(buf_size/brows0, dst.cols);
-    brows0 = std::min(buf_size/bcols0, dst.rows);
-#if CV_SSE2
-    bool useSIMD = checkHardwareSupport(CV_CPU_SSE2);
-#endif
-
-    Mat _bufxy(brows0, bcols0, CV_16SC2), _bufa;
-    if( !nnfunc )
-        _bufa.create(brows0, bcols0, CV_16UC1);
-
-    for( y = 0; y < dst.rows; y += brows0 )
-    {
-        for( x = 0; x < dst.cols; x += bcols0 )
-        {
-            int brows = std::min(brows0, dst.rows - y);
-            int bcols = std::min(bcols0, dst.cols - x);
-            Mat dpart(dst, Rect(x, y, bcols, brows));
-            Mat bufxy(_bufxy, Rect(0, 0, bcols, brows));
-
-            if( nnfunc )
-            {
-                if( map_depth != CV_32F )
-                {
-                    for( y1 = 0; y1 < brows; y1++ )
-                    {
-                        short* XY = (short*)(bufxy.data + bufxy.step*y1);
-                        const short* sXY = (const short*)(m1->data + m1->step*(y+y1)) + x*2;
-                        const ushort* sA = (const ushort*)(m2->data + m2->step*(y+y1)) + x;
-
-                        for( x1 = 0; x1 < bcols; x1++ )
-                        {
-                            int a = sA[x1] & (INTER_TAB_SIZE2-1);
-                            XY[x1*2] = sXY[x1*2] + NNDeltaTab_i[a][0];
-                            XY[x1*2+1] = sXY[x1*2+1] + NNDeltaTab_i[a][1];
-                        }
-                    }
-                }
-                else if( !planar_input )
-                    map1(Rect(0,0,bcols,brows)).convertTo(bufxy, bufxy.depth());
-                else
-                {
-                    for( y1 = 0; y1 < brows; y1++ )
-                    {
-                        short* XY = (short*)(bufxy.data + bufxy.step*y1);
-                        const float* sX = (const float*)(map1.data + map1.step*(y+y1)) + x;
-                        const float* sY = (const float*)(map2.data + map2.step*(y+y1)) + x;
-                        x1 = 0;
-
-                    #if CV_SSE2
-                        if( useSIMD )
-                        {
-                            for( ; x1 <= bcols - 8; x1 += 8 )
-                            {
-                                __m128 fx0 = _mm_loadu_ps(sX + x1);
-                                __m128 fx1 = _mm_loadu_ps(sX + x1 + 4);
-                                __m128 fy0 = _mm_loadu_ps(sY + x1);
-                                __m128 fy1 = _mm_loadu_ps(sY + x1 + 4);
-                                __m128i ix0 = _mm_cvtps_epi32(fx0);
-                                __m128i ix1 = _mm_cvtps_epi32(fx1);
-                                __m128i iy0 = _mm_cvtps_epi32(fy0);
-                                __m128i iy1 = _mm_cvtps_epi32(fy1);
-                                ix0 = _mm_packs_epi32(ix0, ix1);
-                                iy0 = _mm_packs_epi32(iy0, iy1);
-                                ix1 = _mm_unpacklo_epi16(ix0, iy0);
-                                iy1 = _mm_unpackhi_epi16(ix0, iy0);
-                                _mm_storeu_si128((__m128i*)(XY + x1*2), ix1);
-                                _mm_storeu_si128((__m128i*)(XY + x1*2 + 8), iy1);
-                            }
-                        }
-                    #endif
-
-                        for( ; x1 < bcols; x1++ )
-                        {
-                            XY[x1*2] = saturate_cast<short>(sX[x1]);
-                            XY[x1*2+1] = saturate_cast<short>(sY[x1]);
-                        }
-                    }
-                }
-                nnfunc( src, dpart, bufxy, borderType, borderValue );
-                continue;
-            }
-
-            Mat bufa(_bufa, Rect(0,0,bcols, brows));
-            for( y1 = 0; y1 < brows; y1++ )
-            {
-                short* XY = (short*)(bufxy.data + bufxy.step*y1);
-                ushort* A = (ushort*)(bufa.data + bufa.step*y1);
-
-                if( planar_input )
-                {
-                    const float* sX = (const float*)(map1.data + map1.step*(y+y1)) + x;
-                    const float* sY = (const float*)(map2.data + map2.step*(y+y1)) + x;
-
-                    x1 = 0;
-                #if CV_SSE2
-                    if( useSIMD )
-                    {
-                        __m128 scale = _mm_set1_ps((float)INTER_TAB_SIZE);
-                        __m128i mask = _mm_set1_epi32(INTER_TAB_SIZE-1);
-                        for( ; x1 <= bcols - 8; x1 += 8 )
-                        {
-                            __m128 fx0 = _mm_loadu_ps(sX + x1);
-                            __m128 fx1 = _mm_loadu_ps(sX + x1 + 4);
-                            __m128 fy0 = _mm_loadu_ps(sY + x1);
-                            __m128 fy1 = _mm_loadu_ps(sY + x1 + 4);
-                            __m128i ix0 = _mm_cvtps_epi32(_mm_mul_ps(fx0, scale));
-                            __m128i ix1 = _mm_cvtps_epi32(_mm_mul_ps(fx1, scale));
-                            __m128i iy0 = _mm_cvtps_epi32(_mm_mul_ps(fy0, scale));
-                            __m128i iy1 = _mm_cvtps_epi32(_mm_mul_ps(fy1, scale));
-                            __m128i mx0 = _mm_and_si128(ix0, mask);
-                            __m128i mx1 = _mm_and_si128(ix1, mask);
-                            __m128i my0 = _mm_and_si128(iy0, mask);
-                            __m128i my1 = _mm_and_si128(iy1, mask);
-                            mx0 = _mm_packs_epi32(mx0, mx1);
-                            my0 = _mm_packs_epi32(my0, my1);
-                            my0 = _mm_slli_epi16(my0, INTER_BITS);
-                            mx0 = _mm_or_si128(mx0, my0);
-                            _mm_storeu_si128((__m128i*)(A + x1), mx0);
-                            ix0 = _mm_srai_epi32(ix0, INTER_BITS);
-                            ix1 = _mm_srai_epi32(ix1, INTER_BITS);
-                            iy0 = _mm_srai_epi32(iy0, INTER_BITS);
-                            iy1 = _mm_srai_epi32(iy1, INTER_BITS);
-                            ix0 = _mm_packs_epi32(ix0, ix1);
-                            iy0 = _mm_packs_epi32(iy0, iy1);
-                            ix1 = _mm_unpacklo_epi16(ix0, iy0);
-                            iy1 = _mm_unpackhi_epi16(ix0, iy0);
-                            _mm_storeu_si128((__m128i*)(XY + x1*2), ix1);
-                            _mm_storeu_si128((__m128i*)(XY + x1*2 + 8), iy1);
-                        }
-                    }
-                #endif
-
-                    for( ; x1 < bcols; x1++ )
-                    {
-                        int sx = cvRound(sX[x1]*INTER_TAB_SIZE);
-                        int sy = cvRound(sY[x1]*INTER_TAB_SIZE);
-                        int v = (sy & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE + (sx & (INTER_TAB_SIZE-1));
-                        XY[x1*2] = (short)(sx >> INTER_BITS);
-                        XY[x1*2+1] = (short)(sy >> INTER_BITS);
-                        A[x1] = (ushort)v;
-                    }
-                }
-                else
-                {
-                    const float* sXY = (const float*)(map1.data + map1.step*(y+y1)) + x*2;
-
-                    for( x1 = 0; x1 < bcols; x1++ )
-                    {
-                        int sx = cvRound(sXY[x1*2]*INTER_TAB_SIZE);
-                        int sy = cvRound(sXY[x1*2+1]*INTER_TAB_SIZE);
-                        int v = (sy & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE + (sx & (INTER_TAB_SIZE-1));
-                        XY[x1*2] = (short)(sx >> INTER_BITS);
-                        XY[x1*2+1] = (short)(sy >> INTER_BITS);
-                        A[x1] = (ushort)v;
-                    }
-                }
-            }
-            ifunc(src, dpart, bufxy, bufa, ctab, borderType, borderValue);
-        }
-    }
+    RemapInvoker invoker(src, dst, m1, m2, nnfunc, ifunc, ctab, false, planar_input,
+                         borderType, borderValue);
+    warpParallelFor(dst, invoker);
 }
 
 
@@ -2705,6 +2866,7 @@ void cv::convertMaps( InputArray _map1, InputArray _map2,
                       OutputArray _dstmap1, OutputArray _dstmap2,
                       int dstm1type, bool nninterpolate )
 {
+    CV_TRACE_FUNCTION();
     Mat map1 = _map1.getMat(), map2 = _map2.getMat(), dstmap1, dstmap2;
     Size size = map1.size();
     const Mat *m1 = &map1, *m2 = &map2;
@@ -2840,10 +3002,139 @@ void cv::convertMaps( InputArray _map1, InputArray _map2,
 }
 
 
+namespace cv
+{
+
+class WarpAffineInvoker : public ParallelLoopBody
+{
+public:
+    WarpAffineInvoker( const Mat& _src, Mat& _dst, int _interpolation, int _borderType,
+                       const Scalar& _borderValue, int* _adelta, int* _bdelta, double* _M )
+        : src(&_src), dst(&_dst), interpolation(_interpolation), borderType(_borderType),
+          borderValue(_borderValue), adelta(_adelta), bdelta(_bdelta), M(_M)
+    {
+    }
+
+    void operator()(const Range& range) const
+    {
+        const int BLOCK_SZ = 64;
+        short XY[BLOCK_SZ*BLOCK_SZ*2], A[BLOCK_SZ*BLOCK_SZ];
+        const int AB_BITS = MAX(10, (int)INTER_BITS);
+        const int AB_SCALE = 1 << AB_BITS;
+        int round_delta = interpolation == INTER_NEAREST ? AB_SCALE/2 : AB_SCALE/INTER_TAB_SIZE/2;
+        int x, y, x1, y1, width = dst->cols, height = dst->rows;
+    #if CV_SSE2
+        bool useSIMD = checkHardwareSupport(CV_CPU_SSE2);
+        if( useSIMD )
+            CV_TRACE_SIMD(CV_CPU_SSE2);
+    #endif
+
+        int bh0 = std::min(BLOCK_SZ/2, height);
+        int bw0 = std::min(BLOCK_SZ*BLOCK_SZ/bh0, width);
+        bh0 = std::min(BLOCK_SZ*BLOCK_SZ/bw0, height);
+
+        for( y = range.start; y < range.end; y += bh0 )
+        {
+            for( x = 0; x < width; x += bw0 )
+            {
+                int bw = std::min( bw0, width - x);
+                int bh = std::min( bh0, range.end - y);
+
+                Mat _XY(bh, bw, CV_16SC2, XY), matA;
+                Mat dpart(*dst, Rect(x, y, bw, bh));
+
+                for( y1 = 0; y1 < bh; y1++ )
+                {
+                    short* xy = XY + y1*bw*2;
+                    int X0 = saturate_cast<int>((M[1]*(y + y1) + M[2])*AB_SCALE) + round_delta;
+                    int Y0 = saturate_cast<int>((M[4]*(y + y1) + M[5])*AB_SCALE) + round_delta;
+
+                    if( interpolation == INTER_NEAREST )
+                        for( x1 = 0; x1 < bw; x1++ )
+                        {
+                            int X = (X0 + adelta[x+x1]) >> AB_BITS;
+                            int Y = (Y0 + bdelta[x+x1]) >> AB_BITS;
+                            xy[x1*2] = saturate_cast<short>(X);
+                            xy[x1*2+1] = saturate_cast<short>(Y);
+                        }
+                    else
+                    {
+                        short* alpha = A + y1*bw;
+                        x1 = 0;
+                    #if CV_SSE2
+                        if( useSIMD )
+                        {
+                            __m128i fxy_mask = _mm_set1_epi32(INTER_TAB_SIZE - 1);
+                            __m128i XX = _mm_set1_epi32(X0), YY = _mm_set1_epi32(Y0);
+                            for( ; x1 <= bw - 8; x1 += 8 )
+                            {
+                                __m128i tx0, tx1, ty0, ty1;
+                                tx0 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(adelta + x + x1)), XX);
+                                ty0 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(bdelta + x + x1)), YY);
+                                tx1 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(adelta + x + x1 + 4)), XX);
+                                ty1 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(bdelta + x + x1 + 4)), YY);
+
+                                tx0 = _mm_srai_epi32(tx0, AB_BITS - INTER_BITS);
+                                ty0 = _mm_srai_epi32(ty0, AB_BITS - INTER_BITS);
+                                tx1 = _mm_srai_epi32(tx1, AB_BITS - INTER_BITS);
+                                ty1 = _mm_srai_epi32(ty1, AB_BITS - INTER_BITS);
+
+                                __m128i fx_ = _mm_packs_epi32(_mm_and_si128(tx0, fxy_mask),
+                                                              _mm_and_si128(tx1, fxy_mask));
+                                __m128i fy_ = _mm_packs_epi32(_mm_and_si128(ty0, fxy_mask),
+                                                              _mm_and_si128(ty1, fxy_mask));
+                                tx0 = _mm_packs_epi32(_mm_srai_epi32(tx0, INTER_BITS),
+                                                              _mm_srai_epi32(tx1, INTER_BITS));
+                                ty0 = _mm_packs_epi32(_mm_srai_epi32(ty0, INTER_BITS),
+                                                      _mm_srai_epi32(ty1, INTER_BITS));
+                                fx_ = _mm_adds_epi16(fx_, _mm_slli_epi16(fy_, INTER_BITS));
+
+                                _mm_storeu_si128((__m128i*)(xy + x1*2), _mm_unpacklo_epi16(tx0, ty0));
+                                _mm_storeu_si128((__m128i*)(xy + x1*2 + 8), _mm_unpackhi_epi16(tx0, ty0));
+                                _mm_storeu_si128((__m128i*)(alpha + x1), fx_);
+                            }
+                        }
+                    #endif
+                        for( ; x1 < bw; x1++ )
+                        {
+                            int X = (X0 + adelta[x+x1]) >> (AB_BITS - INTER_BITS);
+                            int Y = (Y0 + bdelta[x+x1]) >> (AB_BITS - INTER_BITS);
+                            xy[x1*2] = saturate_cast<short>(X >> INTER_BITS);
+                            xy[x1*2+1] = saturate_cast<short>(Y >> INTER_BITS);
+                            alpha[x1] = (short)((Y & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE +
+                                    (X & (INTER_TAB_SIZE-1)));
+                        }
+                    }
+                }
+
+                if( interpolation == INTER_NEAREST )
+                    remap( *src, dpart, _XY, Mat(), interpolation, borderType, borderValue );
+                else
+                {
+                    Mat _matA(bh, bw, CV_16U, A);
+                    remap( *src, dpart, _XY, _matA, interpolation, borderType, borderValue );
+                }
+            }
+        }
+    }
+
+protected:
+    const Mat* src;
+    Mat* dst;
+    int interpolation, borderType;
+    Scalar borderValue;
+    const int *adelta, *bdelta;
+    const double* M;
+};
+
+}
+
+
 void cv::warpAffine( InputArray _src, OutputArray _dst,
                      InputArray _M0, Size dsize,
                      int flags, int borderType, const Scalar& borderValue )
 {
+    CV_TRACE_FUNCTION();
     Mat src = _src.getMat(), M0 = _M0.getMat();
     _dst.create( dsize.area() == 0 ? src.size() : dsize, src.type() );
     Mat dst = _dst.getMat();
@@ -2851,8 +3142,6 @@ void cv::warpAffine( InputArray _src, OutputArray _dst,
     if( dst.data == src.data )
         src = src.clone();
 
-    const int BLOCK_SZ = 64;
-    short XY[BLOCK_SZ*BLOCK_SZ*2], A[BLOCK_SZ*BLOCK_SZ];
     double M[6];
     Mat matM(2, 3, CV_64F, M);
     int interpolation = flags & INTER_MAX;
@@ -2879,15 +3168,11 @@ void cv::warpAffine( InputArray _src, OutputArray _dst,
         M[2] = b1; M[5] = b2;
     }
 
-    int x, y, x1, y1, width = dst.cols, height = dst.rows;
+    int x, width = dst.cols;
     AutoBuffer<int> _abdelta(width*2);
     int* adelta = &_abdelta[0], *bdelta = adelta + width;
     const int AB_BITS = MAX(10, (int)INTER_BITS);
     const int AB_SCALE = 1 << AB_BITS;
-    int round_delta = interpolation == INTER_NEAREST ? AB_SCALE/2 : AB_SCALE/INTER_TAB_SIZE/2;
-#if CV_SSE2
-    bool useSIMD = checkHardwareSupport(CV_CPU_SSE2);
-#endif
 
     for( x = 0; x < width; x++ )
     {
@@ -2895,99 +3180,111 @@ void cv::warpAffine( InputArray _src, OutputArray _dst,
         bdelta[x] = saturate_cast<int>(M[3]*x*AB_SCALE);
     }
 
-    int bh0 = std::min(BLOCK_SZ/2, height);
-    int bw0 = std::min(BLOCK_SZ*BLOCK_SZ/bh0, width);
-    bh0 = std::min(BLOCK_SZ*BLOCK_SZ/bw0, height);
+    WarpAffineInvoker invoker(src, dst, interpolation, borderType, borderValue,
+                              adelta, bdelta, M);
+    warpParallelFor(dst, invoker);
+}
+
+
+namespace cv
+{
 
-    for( y = 0; y < height; y += bh0 )
+class WarpPerspectiveInvoker : public ParallelLoopBody
+{
+public:
+    WarpPerspectiveInvoker( const Mat& _src, Mat& _dst, int _interpolation, int _borderType,
+                            const Scalar& _borderValue, double* _M )
+        : src(&_src), dst(&_dst), interpolation(_interpolation), borderType(_borderType),
+          borderValue(_borderValue), M(_M)
     {
-        for( x = 0; x < width; x += bw0 )
-        {
-            int bw = std::min( bw0, width - x);
-            int bh = std::min( bh0, height - y);
+    }
+
+    void operator()(const Range& range) const
+    {
+        const int BLOCK_SZ = 32;
+        short XY[BLOCK_SZ*BLOCK_SZ*2], A[BLOCK_SZ*BLOCK_SZ];
+        int x, y, x1, y1, width = dst->cols, height = dst->rows;
 
-            Mat _XY(bh, bw, CV_16SC2, XY), matA;
-            Mat dpart(dst, Rect(x, y, bw, bh));
+        int bh0 = std::min(BLOCK_SZ/2, height);
+        int bw0 = std::min(BLOCK_SZ*BLOCK_SZ/bh0, width);
+        bh0 = std::min(BLOCK_SZ*BLOCK_SZ/bw0, height);
 
-            for( y1 = 0; y1 < bh; y1++ )
+        for( y = range.start; y < range.end; y += bh0 )
+        {
+            for( x = 0; x < width; x += bw0 )
             {
-                short* xy = XY + y1*bw*2;
-                int X0 = saturate_cast<int>((M[1]*(y + y1) + M[2])*AB_SCALE) + round_delta;
-                int Y0 = saturate_cast<int>((M[4]*(y + y1) + M[5])*AB_SCALE) + round_delta;
+                int bw = std::min( bw0, width - x);
+                int bh = std::min( bh0, range.end - y);
 
-                if( interpolation == INTER_NEAREST )
-                    for( x1 = 0; x1 < bw; x1++ )
-                    {
-                        int X = (X0 + adelta[x+x1]) >> AB_BITS;
-                        int Y = (Y0 + bdelta[x+x1]) >> AB_BITS;
-                        xy[x1*2] = saturate_cast<short>(X);
-                        xy[x1*2+1] = saturate_cast<short>(Y);
-                    }
-                else
+                Mat _XY(bh, bw, CV_16SC2, XY), matA;
+                Mat dpart(*dst, Rect(x, y, bw, bh));
+
+                for( y1 = 0; y1 < bh; y1++ )
                 {
-                    short* alpha = A + y1*bw;
-                    x1 = 0;
-                #if CV_SSE2
-                    if( useSIMD )
-                    {
-                        __m128i fxy_mask = _mm_set1_epi32(INTER_TAB_SIZE - 1);
-                        __m128i XX = _mm_set1_epi32(X0), YY = _mm_set1_epi32(Y0);
-                        for( ; x1 <= bw - 8; x1 += 8 )
+                    short* xy = XY + y1*bw*2;
+                    double X0 = M[0]*x + M[1]*(y + y1) + M[2];
+                    double Y0 = M[3]*x + M[4]*(y + y1) + M[5];
+                    double W0 = M[6]*x + M[7]*(y + y1) + M[8];
+
+                    if( interpolation == INTER_NEAREST )
+                        for( x1 = 0; x1 < bw; x1++ )
                         {
-                            __m128i tx0, tx1, ty0, ty1;
-                            tx0 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(adelta + x + x1)), XX);
-                            ty0 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(bdelta + x + x1)), YY);
-                            tx1 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(adelta + x + x1 + 4)), XX);
-                            ty1 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(bdelta + x + x1 + 4)), YY);
-
-                            tx0 = _mm_srai_epi32(tx0, AB_BITS - INTER_BITS);
-                            ty0 = _mm_srai_epi32(ty0, AB_BITS - INTER_BITS);
-                            tx1 = _mm_srai_epi32(tx1, AB_BITS - INTER_BITS);
-                            ty1 = _mm_srai_epi32(ty1, AB_BITS - INTER_BITS);
-
-                            __m128i fx_ = _mm_packs_epi32(_mm_and_si128(tx0, fxy_mask),
-                                                          _mm_and_si128(tx1, fxy_mask));
-                            __m128i fy_ = _mm_packs_epi32(_mm_and_si128(ty0, fxy_mask),
-                                                          _mm_and_si128(ty1, fxy_mask));
-                            tx0 = _mm_packs_epi32(_mm_srai_epi32(tx0, INTER_BITS),
-                                                          _mm_srai_epi32(tx1, INTER_BITS));
-                            ty0 = _mm_packs_epi32(_mm_srai_epi32(ty0, INTER_BITS),
-                                                  _mm_srai_epi32(ty1, INTER_BITS));
-                            fx_ = _mm_adds_epi16(fx_, _mm_slli_epi16(fy_, INTER_BITS));
-
-                            _mm_storeu_si128((__m128i*)(xy + x1*2), _mm_unpacklo_epi16(tx0, ty0));
-                            _mm_storeu_si128((__m128i*)(xy + x1*2 + 8), _mm_unpackhi_epi16(tx0, ty0));
-                            _mm_storeu_si128((__m128i*)(alpha + x1), fx_);
+                            double W = W0 + M[6]*x1;
+                            W = W ? 1./W : 0;
+                            double fX = std::max((double)INT_MIN, std::min((double)INT_MAX, (X0 + M[0]*x1)*W));
+                            double fY = std::max((double)INT_MIN, std::min((double)INT_MAX, (Y0 + M[3]*x1)*W));
+                            int X = saturate_cast<int>(fX);
+                            int Y = saturate_cast<int>(fY);
+
+                            xy[x1*2] = saturate_cast<short>(X);
+                            xy[x1*2+1] = saturate_cast<short>(Y);
                         }
-                    }
-                #endif
-                    for( ; x1 < bw; x1++ )
+                    else
                     {
-                        int X = (X0 + adelta[x+x1]) >> (AB_BITS - INTER_BITS);
-                        int Y = (Y0 + bdelta[x+x1]) >> (AB_BITS - INTER_BITS);
-                        xy[x1*2] = saturate_cast<short>(X >> INTER_BITS);
-                        xy[x1*2+1] = saturate_cast<short>(Y >> INTER_BITS);
-                        alpha[x1] = (short)((Y & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE +
-                                (X & (INTER_TAB_SIZE-1)));
+                        short* alpha = A + y1*bw;
+                        for( x1 = 0; x1 < bw; x1++ )
+                        {
+                            double W = W0 + M[6]*x1;
+                            W = W ? INTER_TAB_SIZE/W : 0;
+                            double fX = std::max((double)INT_MIN, std::min((double)INT_MAX, (X0 + M[0]*x1)*W));
+                            double fY = std::max((double)INT_MIN, std::min((double)INT_MAX, (Y0 + M[3]*x1)*W));
+                            int X = saturate_cast<int>(fX);
+                            int Y = saturate_cast<int>(fY);
+
+                            xy[x1*2] = saturate_cast<short>(X >> INTER_BITS);
+                            xy[x1*2+1] = saturate_cast<short>(Y >> INTER_BITS);
+                            alpha[x1] = (short)((Y & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE +
+                                    (X & (INTER_TAB_SIZE-1)));
+                        }
                     }
                 }
-            }
 
-            if( interpolation == INTER_NEAREST )
-                remap( src, dpart, _XY, Mat(), interpolation, borderType, borderValue );
-            else
-            {
-                Mat _matA(bh, bw, CV_16U, A);
-                remap( src, dpart, _XY, _matA, interpolation, borderType, borderValue );
+                if( interpolation == INTER_NEAREST )
+                    remap( *src, dpart, _XY, Mat(), interpolation, borderType, borderValue );
+                else
+                {
+                    Mat _matA(bh, bw, CV_16U, A);
+                    remap( *src, dpart, _XY, _matA, interpolation, borderType, borderValue );
+                }
             }
         }
     }
+
+protected:
+    const Mat* src;
+    Mat* dst;
+    int interpolation, borderType;
+    Scalar borderValue;
+    const double* M;
+};
+
 }
 
 
 void cv::warpPerspective( InputArray _src, OutputArray _dst, InputArray _M0,
                           Size dsize, int flags, int borderType, const Scalar& borderValue )
 {
+    CV_TRACE_FUNCTION();
     Mat src = _src.getMat(), M0 = _M0.getMat();
     _dst.create( dsize.area() == 0 ? src.size() : dsize, src.type() );
     Mat dst = _dst.getMat();
@@ -2996,8 +3293,6 @@ void cv::warpPerspective( InputArray _src, OutputArray _dst, InputArray _M0,
     if( dst.data == src.data )
         src = src.clone();
 
-    const int BLOCK_SZ = 32;
-    short XY[BLOCK_SZ*BLOCK_SZ*2], A[BLOCK_SZ*BLOCK_SZ];
     double M[9];
     Mat matM(3, 3, CV_64F, M);
     int interpolation = flags & INTER_MAX;
@@ -3015,71 +3310,8 @@ void cv::warpPerspective( InputArray _src, OutputArray _dst, InputArray _M0,
     if( !(flags & WARP_INVERSE_MAP) )
          invert(matM, matM);
 
-    int x, y, x1, y1, width = dst.cols, height = dst.rows;
-
-    int bh0 = std::min(BLOCK_SZ/2, height);
-    int bw0 = std::min(BLOCK_SZ*BLOCK_SZ/bh0, width);
-    bh0 = std::min(BLOCK_SZ*BLOCK_SZ/bw0, height);
-
-    for( y = 0; y < height; y += bh0 )
-    {
-        for( x = 0; x < width; x += bw0 )
-        {
-            int bw = std::min( bw0, width - x);
-            int bh = std::min( bh0, height - y);
-
-            Mat _XY(bh, bw, CV_16SC2, XY), matA;
-            Mat dpart(dst, Rect(x, y, bw, bh));
-
-            for( y1 = 0; y1 < bh; y1++ )
-            {
-                short* xy = XY + y1*bw*2;
-                double X0 = M[0]*x + M[1]*(y + y1) + M[2];
-                double Y0 = M[3]*x + M[4]*(y + y1) + M[5];
-                double W0 = M[6]*x + M[7]*(y + y1) + M[8];
-
-                if( interpolation == INTER_NEAREST )
-                    for( x1 = 0; x1 < bw; x1++ )
-                    {
-                        double W = W0 + M[6]*x1;
-                        W = W ? 1./W : 0;
-                        double fX = std::max((double)INT_MIN, std::min((double)INT_MAX, (X0 + M[0]*x1)*W));
-                        double fY = std::max((double)INT_MIN, std::min((double)INT_MAX, (Y0 + M[3]*x1)*W));
-                        int X = saturate_cast<int>(fX);
-                        int Y = saturate_cast<int>(fY);
-
-                        xy[x1*2] = saturate_cast<short>(X);
-                        xy[x1*2+1] = saturate_cast<short>(Y);
-                    }
-                else
-                {
-                    short* alpha = A + y1*bw;
-                    for( x1 = 0; x1 < bw; x1++ )
-                    {
-                        double W = W0 + M[6]*x1;
-                        W = W ? INTER_TAB_SIZE/W : 0;
-                        double fX = std::max((double)INT_MIN, std::min((double)INT_MAX, (X0 + M[0]*x1)*W));
-                        double fY = std::max((double)INT_MIN, std::min((double)INT_MAX, (Y0 + M[3]*x1)*W));
-                        int X = saturate_cast<int>(fX);
-                        int Y = saturate_cast<int>(fY);
-
-                        xy[x1*2] = saturate_cast<short>(X >> INTER_BITS);
-                        xy[x1*2+1] = saturate_cast<short>(Y >> INTER_BITS);
-                        alpha[x1] = (short)((Y & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE +
-                                (X & (INTER_TAB_SIZE-1)));
-                    }
-                }
-            }
-
-            if( interpolation == INTER_NEAREST )
-                remap( src, dpart, _XY, Mat(), interpolation, borderType, borderValue );
-            else
-            {
-                Mat _matA(bh, bw, CV_16U, A);
-                remap( src, dpart, _XY, _matA, interpolation, borderType, borderValue );
-            }
-        }
-    }
+    WarpPerspectiveInvoker invoker(src, dst, interpolation, borderType, borderValue, M);
+    warpParallelFor(dst, invoker);
 }
 
 
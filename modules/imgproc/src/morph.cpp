@@ -631,7 +631,8 @@ typedef MorphNoVec ErodeVec64f;
 typedef MorphNoVec DilateVec64f;
 
 
-template<class Op, class VecOp> struct MorphRowFilter : public BaseRowFilter
+template<class Op, class VecOp> struct MorphRowFilter :
+    public BaseRowFilter, public CloneableFilter<BaseRowFilter>
 {
     typedef typename Op::rtype T;
 
@@ -641,6 +642,8 @@ template<class Op, class VecOp> struct MorphRowFilter : public BaseRowFilter
         anchor = _anchor;
     }
 
+    Ptr<BaseRowFilter> clone() const { return new MorphRowFilter(*this); }
+
     void operator()(const uchar* src, uchar* dst, int width, int cn)
     {
         int i, j, k, _ksize = ksize*cn;
@@ -685,7 +688,8 @@ template<class Op, class VecOp> struct MorphRowFilter : public BaseRowFilter
 };
 
 
-template<class Op, class VecOp> struct MorphColumnFilter : public BaseColumnFilter
+template<class Op, class VecOp> struct MorphColumnFilter :
+    public BaseColumnFilter, public CloneableFilter<BaseColumnFilter>
 {
     typedef typename Op::rtype T;
 
@@ -695,6 +699,8 @@ template<class Op, class VecOp> struct MorphColumnFilter : public BaseColumnFilt
         anchor = _anchor;
     }
 
+    Ptr<BaseColumnFilter> clone() const { return new MorphColumnFilter(*this); }
+
     void operator()(const uchar** _src, uchar* dst, int dststep, int count, int width)
     {
         int i, k, _ksize = ksize;
@@ -780,7 +786,7 @@ template<class Op, class VecOp> struct MorphColumnFilter : public BaseColumnFilt
 };
 
 
-template<class Op, class VecOp> struct MorphFilter : BaseFilter
+template<class Op, class VecOp> struct MorphFilter : BaseFilter, CloneableFilter<BaseFilter>
 {
     typedef typename Op::rtype T;
 
@@ -796,6 +802,8 @@ template<class Op, class VecOp> struct MorphFilter : BaseFilter
         ptrs.resize( coords.size() );
     }
 
+    Ptr<BaseFilter> clone() const { return new MorphFilter(*this); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width, int cn)
     {
         const Point* pt = &coords[0];
@@ -844,6 +852,244 @@ template<class Op, class VecOp> struct MorphFilter : BaseFilter
     VecOp vecOp;
 };
 
+
+/*
+ van Herk/Gil-Werman erosion/dilation with a line of ksize elements: the line is cut into
+ blocks of ksize elements; any window of ksize elements covers a suffix of one block and
+ a prefix of the next, so every output element costs 3 min/max operations whatever ksize is.
+*/
+
+// d[i] = op(a[i], b[i]); VecOp is the 2D filter vectorization (ErodeVec8u etc.)
+template<class Op, class VecOp> static inline void
+morphOpRows( const typename Op::rtype* a, const typename Op::rtype* b,
+             typename Op::rtype* d, int width )
+{
+    Op op;
+    VecOp vecOp;
+    uchar* src[] = { (uchar*)a, (uchar*)b };
+    int i = vecOp(src, 2, (uchar*)d, width);
+
+    for( ; i < width; i++ )
+        d[i] = op(a[i], b[i]);
+}
+
+// the sequential scans use plain comparisons; the table-based 8-bit MinOp/MaxOp
+// only pay off in the independent operations of the straightforward filters
+template<class Op> struct MorphScanOp : public Op {};
+
+template<> struct MorphScanOp<MinOp<uchar> >
+{
+    uchar operator ()(uchar a, uchar b) const { return std::min(a, b); }
+};
+
+template<> struct MorphScanOp<MaxOp<uchar> >
+{
+    uchar operator ()(uchar a, uchar b) const { return std::max(a, b); }
+};
+
+template<class Op, class VecOp> struct MorphRowFilterHGW :
+    public BaseRowFilter, public CloneableFilter<BaseRowFilter>
+{
+    typedef typename Op::rtype T;
+
+    MorphRowFilterHGW( int _ksize, int _anchor )
+    {
+        ksize = _ksize;
+        anchor = _anchor;
+    }
+
+    Ptr<BaseRowFilter> clone() const { return new MorphRowFilterHGW(*this); }
+
+    void operator()(const uchar* src, uchar* dst, int width, int cn)
+    {
+        int i, j, kcn = ksize*cn, len = width*cn + kcn - cn;
+        const T* S = (const T*)src;
+        T* D = (T*)dst;
+        MorphScanOp<Op> op;
+
+        buf.resize(len*2);
+        T* H = &buf[0];
+        T* G = H + len;
+
+        // within each block of ksize elements, H is the running op from the block end
+        // backwards and G is the running op from the block start forwards
+        for( i = 0; i < len; i += kcn )
+        {
+            int n = std::min(kcn, len - i);
+            const T* s = S + i;
+            T* h = H + i;
+            T* g = G + i;
+
+            // both scans go in one loop, so that the dependency chains overlap
+            if( cn == 1 )
+            {
+                T mg = s[0], mh = s[n-1];
+                g[0] = mg;
+                h[n-1] = mh;
+                for( j = 1; j < n; j++ )
+                {
+                    mg = op(mg, s[j]);
+                    mh = op(mh, s[n-1-j]);
+                    g[j] = mg;
+                    h[n-1-j] = mh;
+                }
+            }
+            else
+            {
+                for( j = 0; j < cn; j++ )
+                {
+                    g[j] = s[j];
+                    h[n-cn+j] = s[n-cn+j];
+                }
+                for( j = cn; j < n; j++ )
+                {
+                    g[j] = op(g[j-cn], s[j]);
+                    h[n-1-j] = op(h[n-1-j+cn], s[n-1-j]);
+                }
+            }
+        }
+
+        // the window [i, i+ksize) is the suffix of one block and the prefix of the next
+        morphOpRows<Op, VecOp>(H, G + kcn - cn, D, width*cn);
+    }
+
+    vector<T> buf;
+};
+
+
+template<class Op, class VecOp> struct MorphColumnFilterHGW :
+    public BaseColumnFilter, public CloneableFilter<BaseColumnFilter>
+{
+    typedef typename Op::rtype T;
+
+    MorphColumnFilterHGW( int _ksize, int _anchor )
+    {
+        ksize = _ksize;
+        anchor = _anchor;
+        reset();
+    }
+
+    Ptr<BaseColumnFilter> clone() const { return new MorphColumnFilterHGW(*this); }
+
+    // the block state is carried over the calls; a new image starts a new block
+    void reset() { blockPos = ksize; }
+
+    void operator()(const uchar** _src, uchar* dst, int dststep, int count, int width)
+    {
+        const T** src = (const T**)_src;
+        T* D = (T*)dst;
+        int k, _ksize = ksize;
+
+        dststep /= sizeof(D[0]);
+        if( buf.size() < (size_t)(_ksize + 1)*width )
+            buf.resize((_ksize + 1)*width);
+        T* H = &buf[0];
+        T* G = H + _ksize*width;
+
+        for( ; count > 0; count--, D += dststep, src++ )
+        {
+            if( blockPos == _ksize )
+            {
+                // H row k - op over the rows k, ..., ksize-1 of the window (the block)
+                memcpy(H + (_ksize - 1)*width, src[_ksize-1], width*sizeof(T));
+                for( k = _ksize - 2; k >= 0; k-- )
+                    morphOpRows<Op, VecOp>(H + (k + 1)*width, src[k], H + k*width, width);
+                memcpy(D, H, width*sizeof(T));
+                blockPos = 1;
+                continue;
+            }
+
+            // G - op over the rows of the next block inside the window
+            if( blockPos == 1 )
+                memcpy(G, src[_ksize-1], width*sizeof(T));
+            else
+                morphOpRows<Op, VecOp>(G, src[_ksize-1], G, width);
+            morphOpRows<Op, VecOp>(H + blockPos*width, G, D, width);
+            blockPos++;
+        }
+    }
+
+    vector<T> buf;
+    int blockPos;
+};
+
+// the lines of at least this many elements are processed with the van Herk/Gil-Werman
+// filters; for shorter lines the straightforward vectorized loops are faster. The row
+// scans are sequential, so the crossover is higher for the narrow 8-bit elements
+enum { MORPH_HGW_MIN_COLUMN_KSIZE = 21 };
+
+static int morphHGWMinRowKSize(int type)
+{
+    int depth = CV_MAT_DEPTH(type), cn = CV_MAT_CN(type);
+    if( depth == CV_8U )
+        return cn == 1 ? 41 : 61;
+    if( depth == CV_16U || depth == CV_16S )
+        return 21;
+    return cn == 1 ? 9 : 15;
+}
+
+static Ptr<BaseRowFilter> getMorphologyRowFilterHGW(int op, int depth, int ksize, int anchor)
+{
+    if( op == MORPH_ERODE )
+    {
+        if( depth == CV_8U )
+            return Ptr<BaseRowFilter>(new MorphRowFilterHGW<MinOp<uchar>, ErodeVec8u>(ksize, anchor));
+        if( depth == CV_16U )
+            return Ptr<BaseRowFilter>(new MorphRowFilterHGW<MinOp<ushort>, ErodeVec16u>(ksize, anchor));
+        if( depth == CV_16S )
+            return Ptr<BaseRowFilter>(new MorphRowFilterHGW<MinOp<short>, ErodeVec16s>(ksize, anchor));
+        if( depth == CV_32F )
+            return Ptr<BaseRowFilter>(new MorphRowFilterHGW<MinOp<float>, ErodeVec32f>(ksize, anchor));
+        if( depth == CV_64F )
+            return Ptr<BaseRowFilter>(new MorphRowFilterHGW<MinOp<double>, ErodeVec64f>(ksize, anchor));
+    }
+    else
+    {
+        if( depth == CV_8U )
+            return Ptr<BaseRowFilter>(new MorphRowFilterHGW<MaxOp<uchar>, DilateVec8u>(ksize, anchor));
+        if( depth == CV_16U )
+            return Ptr<BaseRowFilter>(new MorphRowFilterHGW<MaxOp<ushort>, DilateVec16u>(ksize, anchor));
+        if( depth == CV_16S )
+            return Ptr<BaseRowFilter>(new MorphRowFilterHGW<MaxOp<short>, DilateVec16s>(ksize, anchor));
+        if( depth == CV_32F )
+            return Ptr<BaseRowFilter>(new MorphRowFilterHGW<MaxOp<float>, DilateVec32f>(ksize, anchor));
+        if( depth == CV_64F )
+            return Ptr<BaseRowFilter>(new MorphRowFilterHGW<MaxOp<double>, DilateVec64f>(ksize, anchor));
+    }
+    return Ptr<BaseRowFilter>();
+}
+
+static Ptr<BaseColumnFilter> getMorphologyColumnFilterHGW(int op, int depth, int ksize, int anchor)
+{
+    if( op == MORPH_ERODE )
+    {
+        if( depth == CV_8U )
+            return Ptr<BaseColumnFilter>(new MorphColumnFilterHGW<MinOp<uchar>, ErodeVec8u>(ksize, anchor));
+        if( depth == CV_16U )
+            return Ptr<BaseColumnFilter>(new MorphColumnFilterHGW<MinOp<ushort>, ErodeVec16u>(ksize, anchor));
+        if( depth == CV_16S )
+            return Ptr<BaseColumnFilter>(new MorphColumnFilterHGW<MinOp<short>, ErodeVec16s>(ksize, anchor));
+        if( depth == CV_32F )
+            return Ptr<BaseColumnFilter>(new MorphColumnFilterHGW<MinOp<float>, ErodeVec32f>(ksize, anchor));
+        if( depth == CV_64F )
+            return Ptr<BaseColumnFilter>(new MorphColumnFilterHGW<MinOp<double>, ErodeVec64f>(ksize, anchor));
+    }
+    else
+    {
+        if( depth == CV_8U )
+            return Ptr<BaseColumnFilter>(new MorphColumnFilterHGW<MaxOp<uchar>, DilateVec8u>(ksize, anchor));
+        if( depth == CV_16U )
+            return Ptr<BaseColumnFilter>(new MorphColumnFilterHGW<MaxOp<ushort>, DilateVec16u>(ksize, anchor));
+        if( depth == CV_16S )
+            return Ptr<BaseColumnFilter>(new MorphColumnFilterHGW<MaxOp<short>, DilateVec16s>(ksize, anchor));
+        if( depth == CV_32F )
+            return Ptr<BaseColumnFilter>(new MorphColumnFilterHGW<MaxOp<float>, DilateVec32f>(ksize, anchor));
+        if( depth == CV_64F )
+            return Ptr<BaseColumnFilter>(new MorphColumnFilterHGW<MaxOp<double>, DilateVec64f>(ksize, anchor));
+    }
+    return Ptr<BaseColumnFilter>();
+}
+
 }
 
 /////////////////////////////////// External Interface /////////////////////////////////////
@@ -854,6 +1100,12 @@ cv::Ptr<cv::BaseRowFilter> cv::getMorphologyRowFilter(int op, int type, int ksiz
     if( anchor < 0 )
         anchor = ksize/2;
     CV_Assert( op == MORPH_ERODE || op == MORPH_DILATE );
+    if( ksize >= morphHGWMinRowKSize(type) )
+    {
+        Ptr<BaseRowFilter> f = getMorphologyRowFilterHGW(op, depth, ksize, anchor);
+        if( !f.empty() )
+            return f;
+    }
     if( op == MORPH_ERODE )
     {
         if( depth == CV_8U )
@@ -901,6 +1153,12 @@ cv::Ptr<cv::BaseColumnFilter> cv::getMorphologyColumnFilter(int op, int type, in
     if( anchor < 0 )
         anchor = ksize/2;
     CV_Assert( op == MORPH_ERODE || op == MORPH_DILATE );
+    if( ksize >= MORPH_HGW_MIN_COLUMN_KSIZE )
+    {
+        Ptr<BaseColumnFilter> f = getMorphologyColumnFilterHGW(op, depth, ksize, anchor);
+        if( !f.empty() )
+            return f;
+    }
     if( op == MORPH_ERODE )
     {
         if( depth == CV_8U )
@@ -1136,25 +1394,17 @@ private:
     Scalar borderValue;
 };
 
-static void morphOp( int op, InputArray _src, OutputArray _dst,
-                     InputArray _kernel,
-                     Point anchor, int iterations,
-                     int borderType, const Scalar& borderValue )
+// replaces the default kernel and the iterations of a rectangular kernel with one larger
+// rectangle; returns false if the kernel has a single element and the image is just copied
+static bool normalizeMorphKernel( Mat& kernel, Point& anchor, int& iterations )
 {
-    Mat src = _src.getMat(), kernel = _kernel.getMat();
     Size ksize = kernel.data ? kernel.size() : Size(3,3);
     anchor = normalizeAnchor(anchor, ksize);
 
     CV_Assert( anchor.inside(Rect(0, 0, ksize.width, ksize.height)) );
 
-    _dst.create( src.size(), src.type() );
-    Mat dst = _dst.getMat();
-    
     if( iterations == 0 || kernel.rows*kernel.cols == 1 )
-    {
-        src.copyTo(dst);
-        return;
-    }
+        return false;
 
     if( !kernel.data )
     {
@@ -1171,6 +1421,52 @@ static void morphOp( int op, InputArray _src, OutputArray _dst,
                                        anchor);
         iterations = 1;
     }
+    return true;
+}
+
+// a cross of at least this many elements is split into a horizontal and a vertical line
+enum { MORPH_CROSS_SPLIT_MIN_SIZE = 15 };
+
+// checks whether the kernel is a cross made of the full row and the full column through the anchor
+static bool isSplittableCross( const Mat& kernel, Point anchor )
+{
+    if( kernel.rows == 1 || kernel.cols == 1 ||
+        kernel.rows + kernel.cols - 1 < MORPH_CROSS_SPLIT_MIN_SIZE ||
+        countNonZero(kernel) != kernel.rows + kernel.cols - 1 )
+        return false;
+    return countNonZero(kernel.row(anchor.y)) == kernel.cols &&
+           countNonZero(kernel.col(anchor.x)) == kernel.rows;
+}
+
+static void morphOp( int op, InputArray _src, OutputArray _dst,
+                     InputArray _kernel,
+                     Point anchor, int iterations,
+                     int borderType, const Scalar& borderValue )
+{
+    Mat src = _src.getMat(), kernel = _kernel.getMat();
+
+    _dst.create( src.size(), src.type() );
+    Mat dst = _dst.getMat();
+
+    if( !normalizeMorphKernel(kernel, anchor, iterations) )
+    {
+        src.copyTo(dst);
+        return;
+    }
+
+    if( iterations == 1 && isSplittableCross(kernel, anchor) )
+    {
+        // the min/max over the cross is the min/max of the results for its two lines,
+        // each of which is processed in O(1) per pixel by the separable filters
+        Mat hline;
+        morphOp( op, src, hline, kernel.row(anchor.y), Point(anchor.x, 0), 1, borderType, borderValue );
+        morphOp( op, src, dst, kernel.col(anchor.x), Point(0, anchor.y), 1, borderType, borderValue );
+        if( op == MORPH_ERODE )
+            min( dst, hline, dst );
+        else
+            max( dst, hline, dst );
+        return;
+    }
 
     int nStripes = 1;
 #if defined HAVE_TBB && defined HAVE_TEGRA_OPTIMIZATION
@@ -1191,6 +1487,121 @@ static void morphOp( int op, InputArray _src, OutputArray _dst,
     //    f->apply( dst, dst );
 }
 
+// filters the rows roi of src into dst (roi.height rows), reading the rows around roi like apply() does
+static void applyMorphFilter( FilterEngine& f, const Mat& src, const Rect& roi, Mat& dst )
+{
+    int y = f.start(src, roi, false);
+    f.proceed( src.data + y*src.step, (int)src.step, f.endY - f.startY, dst.data, (int)dst.step );
+}
+
+/*
+ Opening, closing, gradient, top hat and black hat computed band by band: for each band of
+ output rows, the first operation is applied to the band together with the rows the second
+ operation needs around it, and the results are combined right away. No full-size
+ intermediate image is created and the band buffers stay in cache. The rows outside the
+ image are synthesized at the image edges only, so the output is the same as with the
+ separate erode() and dilate() calls.
+*/
+class MorphologyExInvoker : public ParallelLoopBody
+{
+public:
+    MorphologyExInvoker( const Mat& _src, Mat& _dst, int _op, const Mat& _kernel, Point _anchor,
+                         int _borderType, const Scalar& _borderValue, int _bandRows ) :
+        src(_src), dst(_dst), op(_op), kernel(_kernel), anchor(_anchor),
+        borderType(_borderType), borderValue(_borderValue), bandRows(_bandRows)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int type = src.type(), cols = src.cols;
+        int top = anchor.y, bottom = kernel.rows - anchor.y - 1;
+        Ptr<FilterEngine> fe = createMorphologyFilter(MORPH_ERODE, type, kernel, anchor,
+                                                      borderType, borderType, borderValue);
+        Ptr<FilterEngine> fd = createMorphologyFilter(MORPH_DILATE, type, kernel, anchor,
+                                                      borderType, borderType, borderValue);
+        FilterEngine& first = op == MORPH_OPEN || op == MORPH_TOPHAT ? *fe : *fd;
+        FilterEngine& second = op == MORPH_OPEN || op == MORPH_TOPHAT ? *fd : *fe;
+        Mat buf0, buf1;
+
+        for( int y0 = range.start; y0 < range.end; y0 += bandRows )
+        {
+            int y1 = std::min(y0 + bandRows, range.end);
+            Rect band(0, y0, cols, y1 - y0);
+            Mat dstBand = dst.rowRange(y0, y1);
+
+            buf0.create(y1 - y0, cols, type);
+            if( op == MORPH_GRADIENT )
+            {
+                buf1.create(y1 - y0, cols, type);
+                applyMorphFilter(*fd, src, band, buf0);
+                applyMorphFilter(*fe, src, band, buf1);
+                subtract(buf0, buf1, dstBand);
+                continue;
+            }
+
+            int a = std::max(y0 - top, 0), b = std::min(y1 + bottom, src.rows);
+            buf1.create(b - a, cols, type);
+            applyMorphFilter(first, src, Rect(0, a, cols, b - a), buf1);
+
+            // buf1 holds all the rows the second pass reads, except for the image borders
+            Rect inner(0, y0 - a, cols, y1 - y0);
+            if( op == MORPH_OPEN || op == MORPH_CLOSE )
+                applyMorphFilter(second, buf1, inner, dstBand);
+            else
+            {
+                applyMorphFilter(second, buf1, inner, buf0);
+                if( op == MORPH_TOPHAT )
+                    subtract(src.rowRange(y0, y1), buf0, dstBand);
+                else
+                    subtract(buf0, src.rowRange(y0, y1), dstBand);
+            }
+        }
+    }
+
+private:
+    const Mat& src;
+    Mat& dst;
+    int op;
+    Mat kernel;
+    Point anchor;
+    int borderType;
+    Scalar borderValue;
+    int bandRows;
+};
+
+// source bytes per band of morphologyEx
+enum { MORPH_EX_BAND_SIZE = 1 << 16, MORPH_EX_PARALLEL_MIN = 1 << 16 };
+
+static bool morphologyExBanded( const Mat& src, Mat& dst, int op, InputArray _kernel,
+                                Point anchor, int iterations, int borderType, const Scalar& borderValue )
+{
+    Mat kernel = _kernel.getMat();
+
+    // in-place processing needs the source rows after they are overwritten
+    if( op < MORPH_OPEN || op > MORPH_BLACKHAT || src.empty() ||
+        !(src.dataend <= dst.datastart || dst.dataend <= src.datastart) ||
+        !normalizeMorphKernel(kernel, anchor, iterations) || iterations != 1 ||
+        isSplittableCross(kernel, anchor) )
+        return false;
+
+    // opening and closing need no temporary image when done by one thread (the second pass
+    // runs in place), so the bands only pay off when they let the second pass run in parallel
+    if( (op == MORPH_OPEN || op == MORPH_CLOSE) && getNumThreads() <= 1 )
+        return false;
+
+    int bandRows = std::max((int)(MORPH_EX_BAND_SIZE/(src.cols*src.elemSize())), 1);
+    bandRows = std::max(bandRows, (kernel.rows - 1)*16);
+    int nstripes = (int)std::min(src.total()/MORPH_EX_PARALLEL_MIN, (size_t)(src.rows/bandRows));
+
+    MorphologyExInvoker body(src, dst, op, kernel, anchor, borderType, borderValue, bandRows);
+    if( nstripes > 1 )
+        parallel_for_(Range(0, src.rows), body, nstripes);
+    else
+        body(Range(0, src.rows));
+    return true;
+}
+
 template<> void Ptr<IplConvKernel>::delete_obj()
 { cvReleaseStructuringElement(&obj); }
 
@@ -1219,7 +1630,10 @@ void cv::morphologyEx( InputArray _src, OutputArray _dst, int op,
     Mat src = _src.getMat(), temp;
     _dst.create(src.size(), src.type());
     Mat dst = _dst.getMat();
-    
+
+    if( morphologyExBanded(src, dst, op, kernel, anchor, iterations, borderType, borderValue) )
+        return;
+
     switch( op )
     {
     case MORPH_ERODE:
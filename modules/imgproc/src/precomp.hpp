@@ -91,6 +91,15 @@ static inline Point normalizeAnchor( Point anchor, Size ksize )
     return anchor;
 }
 
+// implemented by the row, column and 2D filters of the library that can be copied,
+// so that FilterEngine::apply can process the bands of an image in parallel.
+// clone() may return an empty pointer if this particular filter can not be copied
+template<class Filter> struct CloneableFilter
+{
+    virtual ~CloneableFilter() {}
+    virtual Ptr<Filter> clone() const = 0;
+};
+
 void preprocess2DKernel( const Mat& kernel, vector<Point>& coords, vector<uchar>& coeffs );
 void crossCorr( const Mat& src, const Mat& templ, Mat& dst,
                 Size corrsize, int ctype,
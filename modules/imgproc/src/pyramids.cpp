@@ -64,6 +64,11 @@ template<typename T1, typename T2> struct NoVec
     int operator()(T1**, T2*, int, int) const { return 0; }
 };
 
+template<typename T1, typename T2> struct PyrUpNoVec
+{
+    int operator()(T1**, T2*, T2*, int) const { return 0; }
+};
+
 #if CV_SSE2
 
 struct PyrDownVec_32s8u
@@ -142,7 +147,8 @@ struct PyrDownVec_32f
         
         int x = 0;
         const float *row0 = src[0], *row1 = src[1], *row2 = src[2], *row3 = src[3], *row4 = src[4];
-        __m128 _4 = _mm_set1_ps(4.f), _scale = _mm_set1_ps(1.f/256);
+        __m128 _4 = _mm_set1_ps(4.f), _6 = _mm_set1_ps(6.f), _scale = _mm_set1_ps(1.f/256);
+        // the sums go in the same order as in the plain C code, so that the result is bit-exact with it
         for( ; x <= width - 8; x += 8 )
         {
             __m128 r0, r1, r2, r3, r4, t0, t1;
@@ -151,20 +157,16 @@ struct PyrDownVec_32f
             r2 = _mm_load_ps(row2 + x);
             r3 = _mm_load_ps(row3 + x);
             r4 = _mm_load_ps(row4 + x);
-            r0 = _mm_add_ps(r0, r4);
-            r1 = _mm_add_ps(_mm_add_ps(r1, r3), r2);
-            r0 = _mm_add_ps(r0, _mm_add_ps(r2, r2));
-            t0 = _mm_add_ps(r0, _mm_mul_ps(r1, _4));
+            t0 = _mm_add_ps(_mm_mul_ps(r2, _6), _mm_mul_ps(_mm_add_ps(r1, r3), _4));
+            t0 = _mm_add_ps(_mm_add_ps(t0, r0), r4);
 
             r0 = _mm_load_ps(row0 + x + 4);
             r1 = _mm_load_ps(row1 + x + 4);
             r2 = _mm_load_ps(row2 + x + 4);
             r3 = _mm_load_ps(row3 + x + 4);
             r4 = _mm_load_ps(row4 + x + 4);
-            r0 = _mm_add_ps(r0, r4);
-            r1 = _mm_add_ps(_mm_add_ps(r1, r3), r2);
-            r0 = _mm_add_ps(r0, _mm_add_ps(r2, r2));
-            t1 = _mm_add_ps(r0, _mm_mul_ps(r1, _4));
+            t1 = _mm_add_ps(_mm_mul_ps(r2, _6), _mm_mul_ps(_mm_add_ps(r1, r3), _4));
+            t1 = _mm_add_ps(_mm_add_ps(t1, r0), r4);
 
             t0 = _mm_mul_ps(t0, _scale);
             t1 = _mm_mul_ps(t1, _scale);
@@ -177,224 +179,447 @@ struct PyrDownVec_32f
     }
 };
 
+struct PyrDownVec_32s16s
+{
+    int operator()(int** src, short* dst, int, int width) const
+    {
+        if( !checkHardwareSupport(CV_CPU_SSE2) )
+            return 0;
+
+        int x = 0;
+        const int *row0 = src[0], *row1 = src[1], *row2 = src[2], *row3 = src[3], *row4 = src[4];
+        __m128i delta = _mm_set1_epi32(128);
+
+        for( ; x <= width - 8; x += 8 )
+        {
+            __m128i r0, r1, r2, r3, r4, t0, t1;
+            r0 = _mm_load_si128((const __m128i*)(row0 + x));
+            r1 = _mm_load_si128((const __m128i*)(row1 + x));
+            r2 = _mm_load_si128((const __m128i*)(row2 + x));
+            r3 = _mm_load_si128((const __m128i*)(row3 + x));
+            r4 = _mm_load_si128((const __m128i*)(row4 + x));
+            r0 = _mm_add_epi32(r0, r4);
+            r1 = _mm_add_epi32(_mm_add_epi32(r1, r3), r2);
+            r0 = _mm_add_epi32(r0, _mm_add_epi32(r2, r2));
+            t0 = _mm_add_epi32(r0, _mm_slli_epi32(r1, 2));
+
+            r0 = _mm_load_si128((const __m128i*)(row0 + x + 4));
+            r1 = _mm_load_si128((const __m128i*)(row1 + x + 4));
+            r2 = _mm_load_si128((const __m128i*)(row2 + x + 4));
+            r3 = _mm_load_si128((const __m128i*)(row3 + x + 4));
+            r4 = _mm_load_si128((const __m128i*)(row4 + x + 4));
+            r0 = _mm_add_epi32(r0, r4);
+            r1 = _mm_add_epi32(_mm_add_epi32(r1, r3), r2);
+            r0 = _mm_add_epi32(r0, _mm_add_epi32(r2, r2));
+            t1 = _mm_add_epi32(r0, _mm_slli_epi32(r1, 2));
+
+            t0 = _mm_srai_epi32(_mm_add_epi32(t0, delta), 8);
+            t1 = _mm_srai_epi32(_mm_add_epi32(t1, delta), 8);
+            _mm_storeu_si128((__m128i*)(dst + x), _mm_packs_epi32(t0, t1));
+        }
+
+        return x;
+    }
+};
+
+struct PyrUpVec_32s8u
+{
+    int operator()(int** src, uchar* dst0, uchar* dst1, int width) const
+    {
+        if( !checkHardwareSupport(CV_CPU_SSE2) )
+            return 0;
+
+        int x = 0;
+        const int *row0 = src[0], *row1 = src[1], *row2 = src[2];
+        __m128i delta = _mm_set1_epi16(32);
+
+        // the intermediate sums do not exceed 255*64, so they are computed in 16 bits
+        for( ; x <= width - 16; x += 16 )
+        {
+            __m128i r0, r1, r2, t00, t01, t10, t11;
+            r0 = _mm_packs_epi32(_mm_load_si128((const __m128i*)(row0 + x)),
+                                 _mm_load_si128((const __m128i*)(row0 + x + 4)));
+            r1 = _mm_packs_epi32(_mm_load_si128((const __m128i*)(row1 + x)),
+                                 _mm_load_si128((const __m128i*)(row1 + x + 4)));
+            r2 = _mm_packs_epi32(_mm_load_si128((const __m128i*)(row2 + x)),
+                                 _mm_load_si128((const __m128i*)(row2 + x + 4)));
+            t00 = _mm_add_epi16(_mm_add_epi16(r0, r2), _mm_add_epi16(_mm_slli_epi16(r1, 2), _mm_slli_epi16(r1, 1)));
+            t10 = _mm_slli_epi16(_mm_add_epi16(r1, r2), 2);
+
+            r0 = _mm_packs_epi32(_mm_load_si128((const __m128i*)(row0 + x + 8)),
+                                 _mm_load_si128((const __m128i*)(row0 + x + 12)));
+            r1 = _mm_packs_epi32(_mm_load_si128((const __m128i*)(row1 + x + 8)),
+                                 _mm_load_si128((const __m128i*)(row1 + x + 12)));
+            r2 = _mm_packs_epi32(_mm_load_si128((const __m128i*)(row2 + x + 8)),
+                                 _mm_load_si128((const __m128i*)(row2 + x + 12)));
+            t01 = _mm_add_epi16(_mm_add_epi16(r0, r2), _mm_add_epi16(_mm_slli_epi16(r1, 2), _mm_slli_epi16(r1, 1)));
+            t11 = _mm_slli_epi16(_mm_add_epi16(r1, r2), 2);
+
+            t00 = _mm_srli_epi16(_mm_add_epi16(t00, delta), 6);
+            t01 = _mm_srli_epi16(_mm_add_epi16(t01, delta), 6);
+            t10 = _mm_srli_epi16(_mm_add_epi16(t10, delta), 6);
+            t11 = _mm_srli_epi16(_mm_add_epi16(t11, delta), 6);
+            _mm_storeu_si128((__m128i*)(dst1 + x), _mm_packus_epi16(t10, t11));
+            _mm_storeu_si128((__m128i*)(dst0 + x), _mm_packus_epi16(t00, t01));
+        }
+
+        return x;
+    }
+};
+
+struct PyrUpVec_32s16s
+{
+    int operator()(int** src, short* dst0, short* dst1, int width) const
+    {
+        if( !checkHardwareSupport(CV_CPU_SSE2) )
+            return 0;
+
+        int x = 0;
+        const int *row0 = src[0], *row1 = src[1], *row2 = src[2];
+        __m128i delta = _mm_set1_epi32(32);
+
+        for( ; x <= width - 8; x += 8 )
+        {
+            __m128i r0, r1, r2, t00, t01, t10, t11;
+            r0 = _mm_load_si128((const __m128i*)(row0 + x));
+            r1 = _mm_load_si128((const __m128i*)(row1 + x));
+            r2 = _mm_load_si128((const __m128i*)(row2 + x));
+            t00 = _mm_add_epi32(_mm_add_epi32(r0, r2), _mm_add_epi32(_mm_slli_epi32(r1, 2), _mm_slli_epi32(r1, 1)));
+            t10 = _mm_slli_epi32(_mm_add_epi32(r1, r2), 2);
+
+            r0 = _mm_load_si128((const __m128i*)(row0 + x + 4));
+            r1 = _mm_load_si128((const __m128i*)(row1 + x + 4));
+            r2 = _mm_load_si128((const __m128i*)(row2 + x + 4));
+            t01 = _mm_add_epi32(_mm_add_epi32(r0, r2), _mm_add_epi32(_mm_slli_epi32(r1, 2), _mm_slli_epi32(r1, 1)));
+            t11 = _mm_slli_epi32(_mm_add_epi32(r1, r2), 2);
+
+            t00 = _mm_srai_epi32(_mm_add_epi32(t00, delta), 6);
+            t01 = _mm_srai_epi32(_mm_add_epi32(t01, delta), 6);
+            t10 = _mm_srai_epi32(_mm_add_epi32(t10, delta), 6);
+            t11 = _mm_srai_epi32(_mm_add_epi32(t11, delta), 6);
+            _mm_storeu_si128((__m128i*)(dst1 + x), _mm_packs_epi32(t10, t11));
+            _mm_storeu_si128((__m128i*)(dst0 + x), _mm_packs_epi32(t00, t01));
+        }
+
+        return x;
+    }
+};
+
+struct PyrUpVec_32f
+{
+    int operator()(float** src, float* dst0, float* dst1, int width) const
+    {
+        if( !checkHardwareSupport(CV_CPU_SSE) )
+            return 0;
+
+        int x = 0;
+        const float *row0 = src[0], *row1 = src[1], *row2 = src[2];
+        __m128 _4 = _mm_set1_ps(4.f), _6 = _mm_set1_ps(6.f), _scale = _mm_set1_ps(1.f/64);
+
+        for( ; x <= width - 8; x += 8 )
+        {
+            __m128 r0, r1, r2, t00, t01, t10, t11;
+            r0 = _mm_load_ps(row0 + x);
+            r1 = _mm_load_ps(row1 + x);
+            r2 = _mm_load_ps(row2 + x);
+            t00 = _mm_add_ps(_mm_add_ps(r0, _mm_mul_ps(r1, _6)), r2);
+            t10 = _mm_mul_ps(_mm_add_ps(r1, r2), _4);
+
+            r0 = _mm_load_ps(row0 + x + 4);
+            r1 = _mm_load_ps(row1 + x + 4);
+            r2 = _mm_load_ps(row2 + x + 4);
+            t01 = _mm_add_ps(_mm_add_ps(r0, _mm_mul_ps(r1, _6)), r2);
+            t11 = _mm_mul_ps(_mm_add_ps(r1, r2), _4);
+
+            _mm_storeu_ps(dst1 + x, _mm_mul_ps(t10, _scale));
+            _mm_storeu_ps(dst1 + x + 4, _mm_mul_ps(t11, _scale));
+            _mm_storeu_ps(dst0 + x, _mm_mul_ps(t00, _scale));
+            _mm_storeu_ps(dst0 + x + 4, _mm_mul_ps(t01, _scale));
+        }
+
+        return x;
+    }
+};
+
 #else
 
 typedef NoVec<int, uchar> PyrDownVec_32s8u;
+typedef NoVec<int, short> PyrDownVec_32s16s;
 typedef NoVec<float, float> PyrDownVec_32f;
 
+typedef PyrUpNoVec<int, uchar> PyrUpVec_32s8u;
+typedef PyrUpNoVec<int, short> PyrUpVec_32s16s;
+typedef PyrUpNoVec<float, float> PyrUpVec_32f;
+
 #endif
 
-template<class CastOp, class VecOp> void
-pyrDown_( const Mat& _src, Mat& _dst, int borderType )
+// both pyrDown and pyrUp keep the rows filtered horizontally in a small ring buffer;
+// each stripe of the destination rows has its own buffer, so the stripes can be computed
+// in parallel, and the result does not depend on the way the image is split
+enum { PYR_PARALLEL_MIN = 1 << 16 };
+
+template<class CastOp, class VecOp> class PyrDownInvoker : public ParallelLoopBody
 {
-    const int PD_SZ = 5;
-    typedef typename CastOp::type1 WT;
-    typedef typename CastOp::rtype T;
-
-    Size ssize = _src.size(), dsize = _dst.size();
-    int cn = _src.channels();
-    int bufstep = (int)alignSize(dsize.width*cn, 16);
-    AutoBuffer<WT> _buf(bufstep*PD_SZ + 16);
-    WT* buf = alignPtr((WT*)_buf, 16);
-    int tabL[CV_CN_MAX*(PD_SZ+2)], tabR[CV_CN_MAX*(PD_SZ+2)];
-    AutoBuffer<int> _tabM(dsize.width*cn);
-    int* tabM = _tabM;
-    WT* rows[PD_SZ];
-    CastOp castOp;
-    VecOp vecOp;
-
-    CV_Assert( std::abs(dsize.width*2 - ssize.width) <= 2 &&
-               std::abs(dsize.height*2 - ssize.height) <= 2 );
-    int k, x, sy0 = -PD_SZ/2, sy = sy0, width0 = std::min((ssize.width-PD_SZ/2-1)/2 + 1, dsize.width);
-
-    for( x = 0; x <= PD_SZ+1; x++ )
+public:
+    PyrDownInvoker( const Mat& _src, Mat& _dst, int _borderType )
+        : src(&_src), dst(&_dst), borderType(_borderType)
+    {
+    }
+
+    void operator()(const Range& range) const
     {
-        int sx0 = borderInterpolate(x - PD_SZ/2, ssize.width, borderType)*cn;
-        int sx1 = borderInterpolate(x + width0*2 - PD_SZ/2, ssize.width, borderType)*cn;
-        for( k = 0; k < cn; k++ )
+        const int PD_SZ = 5;
+        typedef typename CastOp::type1 WT;
+        typedef typename CastOp::rtype T;
+
+        Size ssize = src->size(), dsize = dst->size();
+        int cn = src->channels();
+        int bufstep = (int)alignSize(dsize.width*cn, 16);
+        AutoBuffer<WT> _buf(bufstep*PD_SZ + 16);
+        WT* buf = alignPtr((WT*)_buf, 16);
+        int tabL[CV_CN_MAX*(PD_SZ+2)], tabR[CV_CN_MAX*(PD_SZ+2)];
+        AutoBuffer<int> _tabM(dsize.width*cn);
+        int* tabM = _tabM;
+        WT* rows[PD_SZ];
+        CastOp castOp;
+        VecOp vecOp;
+
+        int k, x, sy0 = range.start*2 - PD_SZ/2, sy = sy0, width0 = std::min((ssize.width-PD_SZ/2-1)/2 + 1, dsize.width);
+
+        for( x = 0; x <= PD_SZ+1; x++ )
         {
-            tabL[x*cn + k] = sx0 + k;
-            tabR[x*cn + k] = sx1 + k;
+            int sx0 = borderInterpolate(x - PD_SZ/2, ssize.width, borderType)*cn;
+            int sx1 = borderInterpolate(x + width0*2 - PD_SZ/2, ssize.width, borderType)*cn;
+            for( k = 0; k < cn; k++ )
+            {
+                tabL[x*cn + k] = sx0 + k;
+                tabR[x*cn + k] = sx1 + k;
+            }
         }
-    }
     
-    ssize.width *= cn;
-    dsize.width *= cn;
-    width0 *= cn;
-
-    for( x = 0; x < dsize.width; x++ )
-        tabM[x] = (x/cn)*2*cn + x % cn;
+        ssize.width *= cn;
+        dsize.width *= cn;
+        width0 *= cn;
 
-    for( int y = 0; y < dsize.height; y++ )
-    {
-        T* dst = (T*)(_dst.data + _dst.step*y);
-        WT *row0, *row1, *row2, *row3, *row4;
+        for( x = 0; x < dsize.width; x++ )
+            tabM[x] = (x/cn)*2*cn + x % cn;
 
-        // fill the ring buffer (horizontal convolution and decimation)
-        for( ; sy <= y*2 + 2; sy++ )
+        for( int y = range.start; y < range.end; y++ )
         {
-            WT* row = buf + ((sy - sy0) % PD_SZ)*bufstep;
-            int _sy = borderInterpolate(sy, ssize.height, borderType);
-            const T* src = (const T*)(_src.data + _src.step*_sy);
-            int limit = cn;
-            const int* tab = tabL;
+            T* D = (T*)(dst->data + dst->step*y);
+            WT *row0, *row1, *row2, *row3, *row4;
 
-            for( x = 0;;)
+            // fill the ring buffer (horizontal convolution and decimation)
+            for( ; sy <= y*2 + 2; sy++ )
             {
-                for( ; x < limit; x++ )
+                WT* row = buf + ((sy - sy0) % PD_SZ)*bufstep;
+                int _sy = borderInterpolate(sy, ssize.height, borderType);
+                const T* S = (const T*)(src->data + src->step*_sy);
+                int limit = cn;
+                const int* tab = tabL;
+
+                for( x = 0;;)
                 {
-                    row[x] = src[tab[x+cn*2]]*6 + (src[tab[x+cn]] + src[tab[x+cn*3]])*4 +
-                        src[tab[x]] + src[tab[x+cn*4]];
-                }
+                    for( ; x < limit; x++ )
+                    {
+                        row[x] = S[tab[x+cn*2]]*6 + (S[tab[x+cn]] + S[tab[x+cn*3]])*4 +
+                            S[tab[x]] + S[tab[x+cn*4]];
+                    }
 
-                if( x == dsize.width )
-                    break;
+                    if( x == dsize.width )
+                        break;
 
-                if( cn == 1 )
-                {
-                    for( ; x < width0; x++ )
-                        row[x] = src[x*2]*6 + (src[x*2 - 1] + src[x*2 + 1])*4 +
-                            src[x*2 - 2] + src[x*2 + 2];
-                }
-                else if( cn == 3 )
-                {
-                    for( ; x < width0; x += 3 )
+                    if( cn == 1 )
                     {
-                        const T* s = src + x*2;
-                        WT t0 = s[0]*6 + (s[-3] + s[3])*4 + s[-6] + s[6];
-                        WT t1 = s[1]*6 + (s[-2] + s[4])*4 + s[-5] + s[7];
-                        WT t2 = s[2]*6 + (s[-1] + s[5])*4 + s[-4] + s[8];
-                        row[x] = t0; row[x+1] = t1; row[x+2] = t2;
+                        for( ; x < width0; x++ )
+                            row[x] = S[x*2]*6 + (S[x*2 - 1] + S[x*2 + 1])*4 +
+                                S[x*2 - 2] + S[x*2 + 2];
                     }
-                }
-                else if( cn == 4 )
-                {
-                    for( ; x < width0; x += 4 )
+                    else if( cn == 3 )
                     {
-                        const T* s = src + x*2;
-                        WT t0 = s[0]*6 + (s[-4] + s[4])*4 + s[-8] + s[8];
-                        WT t1 = s[1]*6 + (s[-3] + s[5])*4 + s[-7] + s[9];
-                        row[x] = t0; row[x+1] = t1;
-                        t0 = s[2]*6 + (s[-2] + s[6])*4 + s[-6] + s[10];
-                        t1 = s[3]*6 + (s[-1] + s[7])*4 + s[-5] + s[11];
-                        row[x+2] = t0; row[x+3] = t1;
+                        for( ; x < width0; x += 3 )
+                        {
+                            const T* s = S + x*2;
+                            WT t0 = s[0]*6 + (s[-3] + s[3])*4 + s[-6] + s[6];
+                            WT t1 = s[1]*6 + (s[-2] + s[4])*4 + s[-5] + s[7];
+                            WT t2 = s[2]*6 + (s[-1] + s[5])*4 + s[-4] + s[8];
+                            row[x] = t0; row[x+1] = t1; row[x+2] = t2;
+                        }
                     }
-                }
-                else
-                {
-                    for( ; x < width0; x++ )
+                    else if( cn == 4 )
                     {
-                        int sx = tabM[x];
-                        row[x] = src[sx]*6 + (src[sx - cn] + src[sx + cn])*4 +
-                            src[sx - cn*2] + src[sx + cn*2];
+                        for( ; x < width0; x += 4 )
+                        {
+                            const T* s = S + x*2;
+                            WT t0 = s[0]*6 + (s[-4] + s[4])*4 + s[-8] + s[8];
+                            WT t1 = s[1]*6 + (s[-3] + s[5])*4 + s[-7] + s[9];
+                            row[x] = t0; row[x+1] = t1;
+                            t0 = s[2]*6 + (s[-2] + s[6])*4 + s[-6] + s[10];
+                            t1 = s[3]*6 + (s[-1] + s[7])*4 + s[-5] + s[11];
+                            row[x+2] = t0; row[x+3] = t1;
+                        }
+                    }
+                    else
+                    {
+                        for( ; x < width0; x++ )
+                        {
+                            int sx = tabM[x];
+                            row[x] = S[sx]*6 + (S[sx - cn] + S[sx + cn])*4 +
+                                S[sx - cn*2] + S[sx + cn*2];
+                        }
                     }
-                }
 
-                limit = dsize.width;
-                tab = tabR - x;
+                    limit = dsize.width;
+                    tab = tabR - x;
+                }
             }
-        }
 
-        // do vertical convolution and decimation and write the result to the destination image
-        for( k = 0; k < PD_SZ; k++ )
-            rows[k] = buf + ((y*2 - PD_SZ/2 + k - sy0) % PD_SZ)*bufstep;
-        row0 = rows[0]; row1 = rows[1]; row2 = rows[2]; row3 = rows[3]; row4 = rows[4];
+            // do vertical convolution and decimation and write the result to the destination image
+            for( k = 0; k < PD_SZ; k++ )
+                rows[k] = buf + ((y*2 - PD_SZ/2 + k - sy0) % PD_SZ)*bufstep;
+            row0 = rows[0]; row1 = rows[1]; row2 = rows[2]; row3 = rows[3]; row4 = rows[4];
 
-        x = vecOp(rows, dst, (int)_dst.step, dsize.width);
-        for( ; x < dsize.width; x++ )
-            dst[x] = castOp(row2[x]*6 + (row1[x] + row3[x])*4 + row0[x] + row4[x]);
+            x = vecOp(rows, D, (int)dst->step, dsize.width);
+            for( ; x < dsize.width; x++ )
+                D[x] = castOp(row2[x]*6 + (row1[x] + row3[x])*4 + row0[x] + row4[x]);
+        }
     }
-}
+
+protected:
+    const Mat* src;
+    Mat* dst;
+    int borderType;
+};
 
 
 template<class CastOp, class VecOp> void
-pyrUp_( const Mat& _src, Mat& _dst, int)
+pyrDown_( const Mat& _src, Mat& _dst, int borderType )
 {
-    const int PU_SZ = 3;
-    typedef typename CastOp::type1 WT;
-    typedef typename CastOp::rtype T;
-
-    Size ssize = _src.size(), dsize = _dst.size();
-    int cn = _src.channels();
-    int bufstep = (int)alignSize((dsize.width+1)*cn, 16);
-    AutoBuffer<WT> _buf(bufstep*PU_SZ + 16);
-    WT* buf = alignPtr((WT*)_buf, 16);
-    AutoBuffer<int> _dtab(ssize.width*cn);
-    int* dtab = _dtab;
-    WT* rows[PU_SZ];
-    CastOp castOp;
-    VecOp vecOp;
-
-    CV_Assert( std::abs(dsize.width - ssize.width*2) == dsize.width % 2 &&
-               std::abs(dsize.height - ssize.height*2) == dsize.height % 2);
-    int k, x, sy0 = -PU_SZ/2, sy = sy0, width0 = ssize.width - 1;
-
-    ssize.width *= cn;
-    dsize.width *= cn;
-    width0 *= cn;
-
-    for( x = 0; x < ssize.width; x++ )
-        dtab[x] = (x/cn)*2*cn + x % cn;
-
-    for( int y = 0; y < ssize.height; y++ )
-    {
-        T* dst0 = (T*)(_dst.data + _dst.step*y*2);
-        T* dst1 = (T*)(_dst.data + _dst.step*(y*2+1));
-        WT *row0, *row1, *row2;
+    CV_Assert( std::abs(_dst.cols*2 - _src.cols) <= 2 &&
+               std::abs(_dst.rows*2 - _src.rows) <= 2 );
+
+    PyrDownInvoker<CastOp, VecOp> invoker(_src, _dst, borderType);
+    double total = (double)_dst.total();
+    if( total >= PYR_PARALLEL_MIN )
+        parallel_for_(Range(0, _dst.rows), invoker, total/PYR_PARALLEL_MIN);
+    else
+        invoker(Range(0, _dst.rows));
+}
+
 
-        if( y*2+1 >= dsize.height )
-            dst1 = dst0;
+template<class CastOp, class VecOp> class PyrUpInvoker : public ParallelLoopBody
+{
+public:
+    PyrUpInvoker( const Mat& _src, Mat& _dst )
+        : src(&_src), dst(&_dst)
+    {
+    }
 
-        // fill the ring buffer (horizontal convolution and decimation)
-        for( ; sy <= y + 1; sy++ )
+    void operator()(const Range& range) const
+    {
+        const int PU_SZ = 3;
+        typedef typename CastOp::type1 WT;
+        typedef typename CastOp::rtype T;
+
+        Size ssize = src->size(), dsize = dst->size();
+        int cn = src->channels();
+        int bufstep = (int)alignSize((dsize.width+1)*cn, 16);
+        AutoBuffer<WT> _buf(bufstep*PU_SZ + 16);
+        WT* buf = alignPtr((WT*)_buf, 16);
+        AutoBuffer<int> _dtab(ssize.width*cn);
+        int* dtab = _dtab;
+        WT* rows[PU_SZ];
+        CastOp castOp;
+        VecOp vecOp;
+
+        int k, x, sy0 = range.start - PU_SZ/2, sy = sy0, width0 = ssize.width - 1;
+
+        ssize.width *= cn;
+        dsize.width *= cn;
+        width0 *= cn;
+
+        for( x = 0; x < ssize.width; x++ )
+            dtab[x] = (x/cn)*2*cn + x % cn;
+
+        for( int y = range.start; y < range.end; y++ )
         {
-            WT* row = buf + ((sy - sy0) % PU_SZ)*bufstep;
-            int _sy = borderInterpolate(sy*2, dsize.height, BORDER_REFLECT_101)/2;
-            const T* src = (const T*)(_src.data + _src.step*_sy);
+            T* dst0 = (T*)(dst->data + dst->step*y*2);
+            T* dst1 = (T*)(dst->data + dst->step*(y*2+1));
+            WT *row0, *row1, *row2;
 
-            if( ssize.width == cn )
+            if( y*2+1 >= dsize.height )
+                dst1 = dst0;
+
+            // fill the ring buffer (horizontal convolution and decimation)
+            for( ; sy <= y + 1; sy++ )
             {
+                WT* row = buf + ((sy - sy0) % PU_SZ)*bufstep;
+                int _sy = borderInterpolate(sy*2, dsize.height, BORDER_REFLECT_101)/2;
+                const T* S = (const T*)(src->data + src->step*_sy);
+
+                if( ssize.width == cn )
+                {
+                    for( x = 0; x < cn; x++ )
+                        row[x] = row[x + cn] = S[x]*8;
+                    continue;
+                }
+
                 for( x = 0; x < cn; x++ )
-                    row[x] = row[x + cn] = src[x]*8;
-                continue;
-            }
+                {
+                    int dx = dtab[x];
+                    WT t0 = S[x]*6 + S[x + cn]*2;
+                    WT t1 = (S[x] + S[x + cn])*4;
+                    row[dx] = t0; row[dx + cn] = t1;
+                    dx = dtab[ssize.width - cn + x];
+                    int sx = ssize.width - cn + x;
+                    t0 = S[sx - cn] + S[sx]*7;
+                    t1 = S[sx]*8;
+                    row[dx] = t0; row[dx + cn] = t1;
+                }
 
-            for( x = 0; x < cn; x++ )
-            {
-                int dx = dtab[x];
-                WT t0 = src[x]*6 + src[x + cn]*2;
-                WT t1 = (src[x] + src[x + cn])*4;
-                row[dx] = t0; row[dx + cn] = t1;
-                dx = dtab[ssize.width - cn + x];
-                int sx = ssize.width - cn + x;
-                t0 = src[sx - cn] + src[sx]*7;
-                t1 = src[sx]*8;
-                row[dx] = t0; row[dx + cn] = t1;
+                for( x = cn; x < ssize.width - cn; x++ )
+                {
+                    int dx = dtab[x];
+                    WT t0 = S[x-cn] + S[x]*6 + S[x+cn];
+                    WT t1 = (S[x] + S[x+cn])*4;
+                    row[dx] = t0;
+                    row[dx+cn] = t1;
+                }
             }
 
-            for( x = cn; x < ssize.width - cn; x++ )
+            // do vertical convolution and decimation and write the result to the destination image
+            for( k = 0; k < PU_SZ; k++ )
+                rows[k] = buf + ((y - PU_SZ/2 + k - sy0) % PU_SZ)*bufstep;
+            row0 = rows[0]; row1 = rows[1]; row2 = rows[2];
+
+            x = vecOp(rows, dst0, dst1, dsize.width);
+            for( ; x < dsize.width; x++ )
             {
-                int dx = dtab[x];
-                WT t0 = src[x-cn] + src[x]*6 + src[x+cn];
-                WT t1 = (src[x] + src[x+cn])*4;
-                row[dx] = t0;
-                row[dx+cn] = t1;
+                T t1 = castOp((row1[x] + row2[x])*4);
+                T t0 = castOp(row0[x] + row1[x]*6 + row2[x]);
+                dst1[x] = t1; dst0[x] = t0;
             }
         }
+    }
 
-        // do vertical convolution and decimation and write the result to the destination image
-        for( k = 0; k < PU_SZ; k++ )
-            rows[k] = buf + ((y - PU_SZ/2 + k - sy0) % PU_SZ)*bufstep;
-        row0 = rows[0]; row1 = rows[1]; row2 = rows[2];
+protected:
+    const Mat* src;
+    Mat* dst;
+};
 
-        x = vecOp(rows, dst0, (int)_dst.step, dsize.width);
-        for( ; x < dsize.width; x++ )
-        {
-            T t1 = castOp((row1[x] + row2[x])*4);
-            T t0 = castOp(row0[x] + row1[x]*6 + row2[x]);
-            dst1[x] = t1; dst0[x] = t0;
-        }
-    }
+
+template<class CastOp, class VecOp> void
+pyrUp_( const Mat& _src, Mat& _dst, int)
+{
+    CV_Assert( std::abs(_dst.cols - _src.cols*2) == _dst.cols % 2 &&
+               std::abs(_dst.rows - _src.rows*2) == _dst.rows % 2);
+
+    PyrUpInvoker<CastOp, VecOp> invoker(_src, _dst);
+    double total = (double)_dst.total();
+    if( total >= PYR_PARALLEL_MIN )
+        parallel_for_(Range(0, _src.rows), invoker, total/PYR_PARALLEL_MIN);
+    else
+        invoker(Range(0, _src.rows));
 }
 
 typedef void (*PyrFunc)(const Mat&, Mat&, int);
@@ -418,7 +643,7 @@ void cv::pyrDown( InputArray _src, OutputArray _dst, const Size& _dsz, int borde
     if( depth == CV_8U )
         func = pyrDown_<FixPtCast<uchar, 8>, PyrDownVec_32s8u>;
     else if( depth == CV_16S )
-        func = pyrDown_<FixPtCast<short, 8>, NoVec<int, short> >;
+        func = pyrDown_<FixPtCast<short, 8>, PyrDownVec_32s16s>;
     else if( depth == CV_16U )
         func = pyrDown_<FixPtCast<ushort, 8>, NoVec<int, ushort> >;
     else if( depth == CV_32F )
@@ -446,15 +671,15 @@ void cv::pyrUp( InputArray _src, OutputArray _dst, const Size& _dsz, int borderT
     int depth = src.depth();
     PyrFunc func = 0;
     if( depth == CV_8U )
-        func = pyrUp_<FixPtCast<uchar, 6>, NoVec<int, uchar> >;
+        func = pyrUp_<FixPtCast<uchar, 6>, PyrUpVec_32s8u>;
     else if( depth == CV_16S )
-        func = pyrUp_<FixPtCast<short, 6>, NoVec<int, short> >;
+        func = pyrUp_<FixPtCast<short, 6>, PyrUpVec_32s16s>;
     else if( depth == CV_16U )
-        func = pyrUp_<FixPtCast<ushort, 6>, NoVec<int, ushort> >;
+        func = pyrUp_<FixPtCast<ushort, 6>, PyrUpNoVec<int, ushort> >;
     else if( depth == CV_32F )
-        func = pyrUp_<FltCast<float, 6>, NoVec<float, float> >;
+        func = pyrUp_<FltCast<float, 6>, PyrUpVec_32f>;
     else if( depth == CV_64F )
-        func = pyrUp_<FltCast<double, 6>, NoVec<double, double> >;
+        func = pyrUp_<FltCast<double, 6>, PyrUpNoVec<double, double> >;
     else
         CV_Error( CV_StsUnsupportedFormat, "" );
 
@@ -470,6 +695,70 @@ void cv::buildPyramid( InputArray _src, OutputArrayOfArrays _dst, int maxlevel,
         pyrDown( _dst.getMatRef(i-1), _dst.getMatRef(i), Size(), borderType );
 }
 
+cv::GaussianPyramid::GaussianPyramid()
+{
+}
+
+cv::GaussianPyramid::GaussianPyramid( InputArray img, int maxlevel, int borderType )
+{
+    build(img, maxlevel, borderType);
+}
+
+void cv::GaussianPyramid::build( InputArray _img, int maxlevel, int borderType )
+{
+    Mat img = _img.getMat();
+    CV_Assert( img.dims <= 2 && !img.empty() && maxlevel >= 0 );
+
+    // the levels are placed one after another, each one starting at a 16-element boundary
+    vector<Size> sizes(maxlevel + 1);
+    vector<int> ofs(maxlevel + 1);
+    int i, total = 0;
+    sizes[0] = img.size();
+    for( i = 1; i <= maxlevel; i++ )
+    {
+        sizes[i] = Size((sizes[i-1].width + 1)/2, (sizes[i-1].height + 1)/2);
+        ofs[i] = total;
+        total = (int)alignSize(total + sizes[i].area(), 16);
+    }
+
+    // the buffer is overwritten only if nobody else (e.g. img itself) still uses it
+    for( i = 0; i < (int)pyr.size(); i++ )
+        pyr[i].release();
+    if( buf.refcount && *buf.refcount > 1 )
+        buf.release();
+    if( total > 0 )
+        buf.create(1, total, img.type());
+
+    pyr.resize(maxlevel + 1);
+    pyr[0] = img;
+    for( i = 1; i <= maxlevel; i++ )
+    {
+        pyr[i] = buf.colRange(ofs[i], ofs[i] + sizes[i].area()).reshape(0, sizes[i].height);
+        pyrDown( pyr[i-1], pyr[i], sizes[i], borderType );
+    }
+}
+
+int cv::GaussianPyramid::size() const
+{
+    return (int)pyr.size();
+}
+
+bool cv::GaussianPyramid::empty() const
+{
+    return pyr.empty();
+}
+
+const cv::Mat& cv::GaussianPyramid::operator[](int i) const
+{
+    CV_Assert( 0 <= i && i < (int)pyr.size() );
+    return pyr[i];
+}
+
+const std::vector<cv::Mat>& cv::GaussianPyramid::levels() const
+{
+    return pyr;
+}
+
 CV_IMPL void cvPyrDown( const void* srcarr, void* dstarr, int _filter )
 {
     cv::Mat src = cv::cvarrToMat(srcarr), dst = cv::cvarrToMat(dstarr);
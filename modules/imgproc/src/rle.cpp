@@ -0,0 +1,1246 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "precomp.hpp"
+
+/*
+   Run-length encoded binary images.
+
+   Every row is a sorted list of disjoint, non-adjacent runs [start, end), so all the
+   operations below are merges of the sorted run boundaries and cost O(number of runs).
+   The vertical pass of the rectangular morphology is done with a sparse table of the
+   row unions (intersections) over the power-of-two windows, so it takes
+   O(runs*log(ksize.height)) independently of the kernel size.
+
+   The contours are traced by the regular border following, but only over the bounding
+   boxes of the connected components: the components are labeled directly on the runs
+   (in parallel by horizontal strips, merging the components that cross the strip
+   boundaries), the nested components are grouped together, and the groups are split
+   into chunks of a limited area that are decoded into small patches and traced in
+   parallel. The result is the same as the one of findContours on the decoded image,
+   up to the order of the contours, and it is written into the flat arrays of
+   FlatContours, which keeps all its buffers between the calls.
+*/
+
+namespace cv
+{
+
+enum { RLE_PARALLEL_MIN = 1 << 16, RLE_CHUNK_AREA = 1 << 16 };
+
+static inline int rleTrailingZeros(unsigned x)
+{
+#if defined __GNUC__
+    return __builtin_ctz(x);
+#else
+    int i = 0;
+    for( ; !(x & 1); x >>= 1 )
+        i++;
+    return i;
+#endif
+}
+
+static inline const Vec2i* rleRow(const RLEImage& img, int y, int& n)
+{
+    int ofs = img.rowOfs[y];
+    n = img.rowOfs[y+1] - ofs;
+    return n > 0 ? &img.runs[ofs] : 0;
+}
+
+static void rleAssign(RLEImage& dst, RLEImage& src)
+{
+    dst.rows = src.rows;
+    dst.cols = src.cols;
+    std::swap(dst.runs, src.runs);
+    std::swap(dst.rowOfs, src.rowOfs);
+}
+
+template<typename T> static void
+rleThreshRow(const T* src, int width, T thresh, bool inv, vector<Vec2i>& runs)
+{
+    int x = 0;
+    for(;;)
+    {
+        for( ; x < width && (src[x] > thresh) == inv; x++ )
+            ;
+        if( x >= width )
+            break;
+        int start = x;
+        for( ; x < width && (src[x] > thresh) != inv; x++ )
+            ;
+        runs.push_back(Vec2i(start, x));
+    }
+}
+
+static void
+rleThreshRow8u(const uchar* src, int width, uchar thresh, bool inv, bool useSIMD, vector<Vec2i>& runs)
+{
+    int x = 0, start = 0;
+    bool inRun = false;
+
+#if CV_SSE2
+    if( useSIMD )
+    {
+        __m128i delta = _mm_set1_epi8((char)-128), t = _mm_set1_epi8((char)(thresh ^ 128));
+        unsigned flip = inv ? 0xffff : 0;
+        for( ; x <= width - 16; x += 16 )
+        {
+            // skip the 64-pixel blocks that do not change the state
+            for( ; x <= width - 64; x += 64 )
+            {
+                __m128i c0 = _mm_cmpgt_epi8(_mm_xor_si128(_mm_loadu_si128((const __m128i*)(src + x)), delta), t);
+                __m128i c1 = _mm_cmpgt_epi8(_mm_xor_si128(_mm_loadu_si128((const __m128i*)(src + x + 16)), delta), t);
+                __m128i c2 = _mm_cmpgt_epi8(_mm_xor_si128(_mm_loadu_si128((const __m128i*)(src + x + 32)), delta), t);
+                __m128i c3 = _mm_cmpgt_epi8(_mm_xor_si128(_mm_loadu_si128((const __m128i*)(src + x + 48)), delta), t);
+                __m128i any = _mm_or_si128(_mm_or_si128(c0, c1), _mm_or_si128(c2, c3));
+                __m128i all = _mm_and_si128(_mm_and_si128(c0, c1), _mm_and_si128(c2, c3));
+                unsigned m = inRun != inv ? (unsigned)_mm_movemask_epi8(all) ^ 0xffff :
+                                            (unsigned)_mm_movemask_epi8(any);
+                if( m != 0 )
+                    break;
+            }
+            if( x > width - 16 )
+                break;
+
+            __m128i v = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(src + x)), delta);
+            unsigned m = (unsigned)_mm_movemask_epi8(_mm_cmpgt_epi8(v, t)) ^ flip;
+            // the bits where the pixel differs from its left neighbor
+            unsigned edges = (m ^ ((m << 1) | (unsigned)inRun)) & 0xffff;
+            while( edges )
+            {
+                int i = x + rleTrailingZeros(edges);
+                edges &= edges - 1;
+                if( inRun )
+                    runs.push_back(Vec2i(start, i));
+                else
+                    start = i;
+                inRun = !inRun;
+            }
+        }
+    }
+#else
+    (void)useSIMD;
+#endif
+
+    for( ; x < width; x++ )
+    {
+        bool v = (src[x] > thresh) != inv;
+        if( v != inRun )
+        {
+            if( inRun )
+                runs.push_back(Vec2i(start, x));
+            else
+                start = x;
+            inRun = v;
+        }
+    }
+    if( inRun )
+        runs.push_back(Vec2i(start, width));
+}
+
+struct RLEOpAnd { bool operator()(bool a, bool b) const { return a && b; } };
+struct RLEOpOr { bool operator()(bool a, bool b) const { return a || b; } };
+struct RLEOpXor { bool operator()(bool a, bool b) const { return a != b; } };
+
+// merges the boundaries of two sorted run lists, appending the runs where op(a, b) holds
+template<class Op> static void
+rleCombineRow(const Vec2i* a, int na, const Vec2i* b, int nb, Op op, vector<Vec2i>& dst)
+{
+    const int* pa = (const int*)a;
+    const int* pb = (const int*)b;
+    int ia = 0, ib = 0, start = 0;
+    bool inA = false, inB = false, inD = false;
+
+    na *= 2;
+    nb *= 2;
+    while( ia < na || ib < nb )
+    {
+        int xa = ia < na ? pa[ia] : INT_MAX;
+        int xb = ib < nb ? pb[ib] : INT_MAX;
+        int x = std::min(xa, xb);
+        if( xa == x )
+            inA = !inA, ia++;
+        if( xb == x )
+            inB = !inB, ib++;
+        bool v = op(inA, inB);
+        if( v != inD )
+        {
+            if( v )
+                start = x;
+            else
+                dst.push_back(Vec2i(start, x));
+            inD = v;
+        }
+    }
+}
+
+template<class Op> static void
+rleBinaryOp(const RLEImage& src1, const RLEImage& src2, RLEImage& dst, Op op)
+{
+    CV_Assert( src1.size() == src2.size() );
+
+    RLEImage tmp(src1.size());
+    tmp.runs.reserve(src1.runs.size() + src2.runs.size());
+    for( int y = 0; y < src1.rows; y++ )
+    {
+        int n1, n2;
+        const Vec2i* r1 = rleRow(src1, y, n1);
+        const Vec2i* r2 = rleRow(src2, y, n2);
+        rleCombineRow(r1, n1, r2, n2, op, tmp.runs);
+        tmp.rowOfs[y+1] = (int)tmp.runs.size();
+    }
+    rleAssign(dst, tmp);
+}
+
+/*
+   The vertical pass of the rectangular morphology:
+   dst[y] = op(src[y - anchor], ..., src[y - anchor + ksize - 1]), where the rows outside
+   of the image are skipped (they are the identity element of op). level[k][y] keeps the
+   combination of the 2^k rows starting from y, and every window is covered by two
+   (possibly overlapping) power-of-two windows.
+*/
+template<class Op> static void
+rleMorphColumns(RLEImage& src, int ksize, int anchor, Op op, RLEImage& dst)
+{
+    int rows = src.rows;
+    vector<RLEImage> levels(1);
+    rleAssign(levels[0], src);
+
+    for( int s = 1; s*2 <= ksize && s < rows; s *= 2 )
+    {
+        const RLEImage& prev = levels.back();
+        RLEImage next(prev.size());
+        next.runs.reserve(prev.runs.size());
+        for( int y = 0; y < rows; y++ )
+        {
+            int n1, n2 = 0;
+            const Vec2i* r1 = rleRow(prev, y, n1);
+            const Vec2i* r2 = y + s < rows ? rleRow(prev, y + s, n2) : 0;
+            rleCombineRow(r1, n1, r2, n2, op, next.runs);
+            next.rowOfs[y+1] = (int)next.runs.size();
+        }
+        levels.push_back(RLEImage());
+        rleAssign(levels.back(), next);
+    }
+
+    RLEImage tmp(levels[0].size());
+    tmp.runs.reserve(levels[0].runs.size());
+    for( int y = 0; y < rows; y++ )
+    {
+        int y0 = std::max(y - anchor, 0), y1 = std::min(y - anchor + ksize, rows);
+        int k = 0;
+        while( (2 << k) <= y1 - y0 && k + 1 < (int)levels.size() )
+            k++;
+        int n1, n2;
+        const Vec2i* r1 = rleRow(levels[k], y0, n1);
+        const Vec2i* r2 = rleRow(levels[k], y1 - (1 << k), n2);
+        rleCombineRow(r1, n1, r2, n2, op, tmp.runs);
+        tmp.rowOfs[y+1] = (int)tmp.runs.size();
+    }
+    rleAssign(dst, tmp);
+}
+
+static void normalizeRLEKernel(Size ksize, Point& anchor)
+{
+    CV_Assert( ksize.width > 0 && ksize.height > 0 );
+    if( anchor.x == -1 )
+        anchor.x = ksize.width/2;
+    if( anchor.y == -1 )
+        anchor.y = ksize.height/2;
+    CV_Assert( 0 <= anchor.x && anchor.x < ksize.width &&
+               0 <= anchor.y && anchor.y < ksize.height );
+}
+
+// the sums of x^k over [0, n)
+static inline int64 rlePowerSum1(int64 n) { return n*(n - 1)/2; }
+static inline int64 rlePowerSum2(int64 n) { return (n - 1)*n*(2*n - 1)/6; }
+static inline int64 rlePowerSum3(int64 n) { int64 s = rlePowerSum1(n); return s*s; }
+
+}
+
+
+cv::RLEImage::RLEImage() : rows(0), cols(0)
+{
+    rowOfs.assign(1, 0);
+}
+
+cv::RLEImage::RLEImage(Size _size) : rows(0), cols(0)
+{
+    create(_size);
+}
+
+cv::RLEImage::RLEImage(InputArray _mask) : rows(0), cols(0)
+{
+    Mat mask = _mask.getMat();
+    CV_Assert( mask.type() == CV_8UC1 );
+    threshold(mask, *this, 0, THRESH_BINARY);
+}
+
+void cv::RLEImage::create(Size _size)
+{
+    CV_Assert( _size.width >= 0 && _size.height >= 0 );
+    rows = _size.height;
+    cols = _size.width;
+    runs.clear();
+    rowOfs.assign(rows + 1, 0);
+}
+
+void cv::RLEImage::copyTo(OutputArray _mask, int value) const
+{
+    _mask.create(rows, cols, CV_8U);
+    Mat mask = _mask.getMat();
+    uchar v = saturate_cast<uchar>(value);
+
+    for( int y = 0; y < rows; y++ )
+    {
+        uchar* dst = mask.ptr(y);
+        int x = 0, n;
+        const Vec2i* r = rleRow(*this, y, n);
+        for( int i = 0; i < n; i++ )
+        {
+            memset(dst + x, 0, r[i][0] - x);
+            memset(dst + r[i][0], v, r[i][1] - r[i][0]);
+            x = r[i][1];
+        }
+        memset(dst + x, 0, cols - x);
+    }
+}
+
+cv::Size cv::RLEImage::size() const
+{
+    return Size(cols, rows);
+}
+
+bool cv::RLEImage::empty() const
+{
+    return runs.empty();
+}
+
+int cv::RLEImage::area() const
+{
+    int s = 0;
+    for( size_t i = 0; i < runs.size(); i++ )
+        s += runs[i][1] - runs[i][0];
+    return s;
+}
+
+
+namespace cv
+{
+
+// encodes the rows [y0, y1) of the image; rowEnd[y] receives the end of the runs of the row y
+static void rleThreshRows(const Mat& src, int y0, int y1, double thresh, int type,
+                          vector<Vec2i>& runs, int* rowEnd)
+{
+    int depth = src.depth();
+    bool inv = type == THRESH_BINARY_INV;
+    // 1 when every pixel is above the threshold, -1 when none of them is
+    int constant = 0, ithresh = cvFloor(thresh);
+    if( depth == CV_8U )
+        constant = ithresh < 0 ? 1 : ithresh >= UCHAR_MAX ? -1 : 0;
+    else if( depth == CV_16S )
+        constant = ithresh < SHRT_MIN ? 1 : ithresh >= SHRT_MAX ? -1 : 0;
+
+    bool useSIMD = checkHardwareSupport(CV_CPU_SSE2);
+
+    for( int y = y0; y < y1; y++ )
+    {
+        if( constant != 0 )
+        {
+            if( (constant > 0) != inv && src.cols > 0 )
+                runs.push_back(Vec2i(0, src.cols));
+        }
+        else if( depth == CV_8U )
+            rleThreshRow8u(src.ptr(y), src.cols, (uchar)ithresh, inv, useSIMD, runs);
+        else if( depth == CV_16S )
+            rleThreshRow(src.ptr<short>(y), src.cols, (short)ithresh, inv, runs);
+        else
+            rleThreshRow(src.ptr<float>(y), src.cols, (float)thresh, inv, runs);
+        rowEnd[y] = (int)runs.size();
+    }
+}
+
+class RLEThreshInvoker : public ParallelLoopBody
+{
+public:
+    RLEThreshInvoker(const Mat& _src, double _thresh, int _type, vector<Vec2i>* _stripes,
+                     int* _rowEnd, const int* _stripRows) :
+        src(&_src), thresh(_thresh), type(_type), stripes(_stripes),
+        rowEnd(_rowEnd), stripRows(_stripRows)
+    {
+    }
+
+    void operator()(const Range& range) const
+    {
+        for( int k = range.start; k < range.end; k++ )
+        {
+            stripes[k].clear();
+            rleThreshRows(*src, stripRows[k], stripRows[k+1], thresh, type, stripes[k], rowEnd);
+        }
+    }
+
+private:
+    const Mat* src;
+    double thresh;
+    int type;
+    vector<Vec2i>* stripes;
+    int* rowEnd;
+    const int* stripRows;
+};
+
+// the horizontal strips are encoded in parallel into the separate buffers and then concatenated
+static void rleThreshold(const Mat& src, double thresh, int type, RLEImage& dst,
+                         vector<vector<Vec2i> >& stripes)
+{
+    int depth = src.depth();
+    CV_Assert( src.channels() == 1 && (depth == CV_8U || depth == CV_16S || depth == CV_32F) &&
+               (type == THRESH_BINARY || type == THRESH_BINARY_INV) );
+
+    int rows = src.rows;
+    int nstrips = (int)std::min((size_t)std::max(rows/4, 1), src.total()/RLE_PARALLEL_MIN);
+    nstrips = std::max(std::min(nstrips, getNumThreads()*4), 1);
+
+    dst.create(src.size());
+    int* rowEnd = &dst.rowOfs[0] + 1;
+    if( nstrips == 1 )
+    {
+        rleThreshRows(src, 0, rows, thresh, type, dst.runs, rowEnd);
+        return;
+    }
+
+    AutoBuffer<int> _stripRows(nstrips + 1);
+    int* stripRows = _stripRows;
+    for( int k = 0; k <= nstrips; k++ )
+        stripRows[k] = (int)((int64)rows*k/nstrips);
+    if( (int)stripes.size() < nstrips )
+        stripes.resize(nstrips);
+
+    RLEThreshInvoker body(src, thresh, type, &stripes[0], rowEnd, stripRows);
+    parallel_for_(Range(0, nstrips), body, nstrips);
+
+    size_t total = 0;
+    for( int k = 0; k < nstrips; k++ )
+        total += stripes[k].size();
+    dst.runs.resize(total);
+
+    int base = 0;
+    for( int k = 0; k < nstrips; k++ )
+    {
+        std::copy(stripes[k].begin(), stripes[k].end(), dst.runs.begin() + base);
+        for( int y = stripRows[k]; y < stripRows[k+1]; y++ )
+            rowEnd[y] += base;
+        base += (int)stripes[k].size();
+    }
+}
+
+}
+
+void cv::threshold( InputArray _src, RLEImage& dst, double thresh, int type )
+{
+    vector<vector<Vec2i> > stripes;
+    rleThreshold(_src.getMat(), thresh, type, dst, stripes);
+}
+
+
+void cv::bitwise_and( const RLEImage& src1, const RLEImage& src2, RLEImage& dst )
+{
+    rleBinaryOp(src1, src2, dst, RLEOpAnd());
+}
+
+void cv::bitwise_or( const RLEImage& src1, const RLEImage& src2, RLEImage& dst )
+{
+    rleBinaryOp(src1, src2, dst, RLEOpOr());
+}
+
+void cv::bitwise_xor( const RLEImage& src1, const RLEImage& src2, RLEImage& dst )
+{
+    rleBinaryOp(src1, src2, dst, RLEOpXor());
+}
+
+void cv::bitwise_not( const RLEImage& src, RLEImage& dst )
+{
+    RLEImage tmp(src.size());
+    tmp.runs.reserve(src.runs.size() + src.rows);
+    for( int y = 0; y < src.rows; y++ )
+    {
+        int x = 0, n;
+        const Vec2i* r = rleRow(src, y, n);
+        for( int i = 0; i < n; i++ )
+        {
+            if( r[i][0] > x )
+                tmp.runs.push_back(Vec2i(x, r[i][0]));
+            x = r[i][1];
+        }
+        if( x < src.cols )
+            tmp.runs.push_back(Vec2i(x, src.cols));
+        tmp.rowOfs[y+1] = (int)tmp.runs.size();
+    }
+    rleAssign(dst, tmp);
+}
+
+
+// the pixels outside of the image are treated as non-zero, like the default border of erode()
+void cv::erode( const RLEImage& src, RLEImage& dst, Size ksize, Point anchor )
+{
+    normalizeRLEKernel(ksize, anchor);
+
+    int cols = src.cols, left = anchor.x, right = ksize.width - 1 - anchor.x;
+    RLEImage tmp(src.size());
+    tmp.runs.reserve(src.runs.size());
+    for( int y = 0; y < src.rows; y++ )
+    {
+        int n;
+        const Vec2i* r = rleRow(src, y, n);
+        for( int i = 0; i < n; i++ )
+        {
+            int a = r[i][0] > 0 ? r[i][0] + left : 0;
+            int b = r[i][1] < cols ? r[i][1] - right : cols;
+            if( a < b )
+                tmp.runs.push_back(Vec2i(a, b));
+        }
+        tmp.rowOfs[y+1] = (int)tmp.runs.size();
+    }
+
+    if( ksize.height > 1 )
+        rleMorphColumns(tmp, ksize.height, anchor.y, RLEOpAnd(), dst);
+    else
+        rleAssign(dst, tmp);
+}
+
+// the pixels outside of the image are treated as zeros, like the default border of dilate()
+void cv::dilate( const RLEImage& src, RLEImage& dst, Size ksize, Point anchor )
+{
+    normalizeRLEKernel(ksize, anchor);
+
+    int cols = src.cols, left = ksize.width - 1 - anchor.x, right = anchor.x;
+    RLEImage tmp(src.size());
+    tmp.runs.reserve(src.runs.size());
+    for( int y = 0; y < src.rows; y++ )
+    {
+        int n, ofs = (int)tmp.runs.size();
+        const Vec2i* r = rleRow(src, y, n);
+        for( int i = 0; i < n; i++ )
+        {
+            int a = std::max(r[i][0] - left, 0);
+            int b = std::min(r[i][1] + right, cols);
+            if( (int)tmp.runs.size() > ofs && a <= tmp.runs.back()[1] )
+                tmp.runs.back()[1] = std::max(tmp.runs.back()[1], b);
+            else
+                tmp.runs.push_back(Vec2i(a, b));
+        }
+        tmp.rowOfs[y+1] = (int)tmp.runs.size();
+    }
+
+    if( ksize.height > 1 )
+        rleMorphColumns(tmp, ksize.height, anchor.y, RLEOpOr(), dst);
+    else
+        rleAssign(dst, tmp);
+}
+
+
+cv::Moments cv::moments( const RLEImage& image )
+{
+    double m00 = 0, m10 = 0, m01 = 0, m20 = 0, m11 = 0, m02 = 0, m30 = 0, m21 = 0, m12 = 0, m03 = 0;
+
+    for( int y = 0; y < image.rows; y++ )
+    {
+        int n;
+        const Vec2i* r = rleRow(image, y, n);
+        if( n == 0 )
+            continue;
+
+        // the exact row sums of x^k
+        int64 s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+        for( int i = 0; i < n; i++ )
+        {
+            int64 a = r[i][0], b = r[i][1];
+            s0 += b - a;
+            s1 += rlePowerSum1(b) - rlePowerSum1(a);
+            s2 += rlePowerSum2(b) - rlePowerSum2(a);
+            s3 += rlePowerSum3(b) - rlePowerSum3(a);
+        }
+
+        double fy = y, fy2 = fy*fy;
+        m00 += (double)s0;
+        m10 += (double)s1;
+        m01 += s0*fy;
+        m20 += (double)s2;
+        m11 += s1*fy;
+        m02 += s0*fy2;
+        m30 += (double)s3;
+        m21 += s2*fy;
+        m12 += s1*fy2;
+        m03 += s0*fy2*fy;
+    }
+
+    return Moments(m00, m10, m01, m20, m11, m02, m30, m21, m12, m03);
+}
+
+cv::Rect cv::boundingRect( const RLEImage& image )
+{
+    int x0 = INT_MAX, x1 = INT_MIN, y0 = -1, y1 = -1;
+
+    for( int y = 0; y < image.rows; y++ )
+    {
+        int n;
+        const Vec2i* r = rleRow(image, y, n);
+        if( n == 0 )
+            continue;
+        if( y0 < 0 )
+            y0 = y;
+        y1 = y;
+        x0 = std::min(x0, r[0][0]);
+        x1 = std::max(x1, r[n-1][1]);
+    }
+
+    return y0 < 0 ? Rect() : Rect(x0, y0, x1 - x0, y1 - y0 + 1);
+}
+
+
+namespace cv
+{
+
+static inline int rleFindRoot(vector<int>& P, int i)
+{
+    while( P[i] != i )
+    {
+        P[i] = P[P[i]];
+        i = P[i];
+    }
+    return i;
+}
+
+// merges the sets, keeping the smallest index as the root
+static inline int rleUnion(vector<int>& P, int i, int j)
+{
+    i = rleFindRoot(P, i);
+    j = rleFindRoot(P, j);
+    if( i < j )
+        P[j] = i;
+    else
+        P[i] = j;
+    return std::min(i, j);
+}
+
+// unites the 8-connected runs of two consecutive rows, [i, j) and [j, jend)
+static void rleUniteRows(const vector<Vec2i>& runs, int i, int j, int jend, vector<int>& P)
+{
+    int iend = j;
+    while( i < iend && j < jend )
+    {
+        if( runs[i][0] <= runs[j][1] && runs[j][0] <= runs[i][1] )
+            rleUnion(P, i, j);
+        if( runs[i][1] < runs[j][1] )
+            i++;
+        else
+            j++;
+    }
+}
+
+class RLELabelInvoker : public ParallelLoopBody
+{
+public:
+    RLELabelInvoker(const RLEImage& _mask, vector<int>& _P, const int* _stripRows) :
+        mask(&_mask), P(&_P), stripRows(_stripRows)
+    {
+    }
+
+    void operator()(const Range& range) const
+    {
+        const int* rowOfs = &mask->rowOfs[0];
+
+        for( int k = range.start; k < range.end; k++ )
+        {
+            int y0 = stripRows[k], y1 = stripRows[k+1];
+            for( int i = rowOfs[y0]; i < rowOfs[y1]; i++ )
+                (*P)[i] = i;
+            for( int y = y0 + 1; y < y1; y++ )
+                rleUniteRows(mask->runs, rowOfs[y-1], rowOfs[y], rowOfs[y+1], *P);
+        }
+    }
+
+private:
+    const RLEImage* mask;
+    vector<int>* P;
+    const int* stripRows;
+};
+
+class FlatContours::Impl
+{
+public:
+    Impl() { offsets.assign(1, 0); }
+
+    void clear()
+    {
+        points.clear();
+        offsets.assign(1, 0);
+        hierarchy.clear();
+    }
+
+    vector<Point> points;
+    vector<int> offsets;
+    vector<Vec4i> hierarchy;
+
+    // the temporary buffers of findContours(), kept between the calls
+    RLEImage mask;
+    vector<vector<Vec2i> > stripes;
+    vector<int> labels, groups, active, chunkOfs;
+    vector<Vec4i> boxes, chunkBoxes, chunkInfo;
+    vector<Vec3i> chunkRuns;
+    vector<vector<uchar> > patches;
+    vector<MemStorage> storages;
+    vector<CvSeq*> trees;
+};
+
+class FlatContoursFinder
+{
+public:
+    static void findDense(const Mat& image, FlatContours::Impl& fc, int mode, int method, Point offset);
+    static void findRLE(const RLEImage& image, FlatContours::Impl& fc, int mode, int method, Point offset);
+
+protected:
+    static void checkParams(int mode, int method);
+    static void find(FlatContours::Impl& fc, int mode, int method, Point origin);
+    static void label(FlatContours::Impl& fc);
+    static int makeChunks(FlatContours::Impl& fc, int ncomps);
+};
+
+class RLETraceInvoker : public ParallelLoopBody
+{
+public:
+    RLETraceInvoker(const Vec4i* _chunkBoxes, const Vec3i* _chunkRuns, const int* _chunkOfs,
+                    vector<uchar>* _patches, MemStorage* _storages, CvSeq** _trees, Vec4i* _chunkInfo,
+                    int _mode, int _method, Point _origin) :
+        chunkBoxes(_chunkBoxes), chunkRuns(_chunkRuns), chunkOfs(_chunkOfs), patches(_patches),
+        storages(_storages), trees(_trees), chunkInfo(_chunkInfo), mode(_mode), method(_method), origin(_origin)
+    {
+    }
+
+    void operator()(const Range& range) const
+    {
+        for( int k = range.start; k < range.end; k++ )
+        {
+            // the runs of the chunk are drawn into a patch with a 1-pixel zero frame around
+            // the bounding box of the chunk and traced by the regular border following
+            const Vec4i& b = chunkBoxes[k];
+            int px = b[0] - 1, py = b[1] - 1, pw = b[2] - b[0] + 2, ph = b[3] - b[1] + 2;
+            vector<uchar>& buf = patches[k];
+            if( buf.size() < (size_t)pw*ph )
+                buf.resize((size_t)pw*ph);
+            uchar* data = &buf[0];
+            memset(data, 0, (size_t)pw*ph);
+
+            const Vec3i* r = chunkRuns;
+            for( int j = chunkOfs[k]; j < chunkOfs[k+1]; j++ )
+                memset(data + (size_t)(r[j][2] - py)*pw + r[j][0] - px, 1, r[j][1] - r[j][0]);
+
+            CvMat patch = cvMat(ph, pw, CV_8UC1, data);
+            CvMemStorage* storage = storages[k];
+            CvSeq* first = 0;
+            cvClearMemStorage(storage);
+            cvFindContours(&patch, storage, &first, sizeof(CvContour), mode, method,
+                           cvPoint(origin.x + px, origin.y + py));
+
+            int ncontours = 0, npoints = 0;
+            trees[k] = 0;
+            if( first )
+            {
+                CvSeq* tree = trees[k] = cvTreeToNodeSeq(first, sizeof(CvSeq), storage);
+                Seq<CvSeq*> all(tree);
+                SeqIterator<CvSeq*> it = all.begin();
+                ncontours = tree->total;
+                for( int i = 0; i < ncontours; i++, ++it )
+                {
+                    CvSeq* c = *it;
+                    ((CvContour*)c)->color = i;
+                    npoints += c->total;
+                }
+            }
+            chunkInfo[k] = Vec4i(0, 0, ncontours, npoints);
+        }
+    }
+
+private:
+    const Vec4i* chunkBoxes;
+    const Vec3i* chunkRuns;
+    const int* chunkOfs;
+    vector<uchar>* patches;
+    MemStorage* storages;
+    CvSeq** trees;
+    Vec4i* chunkInfo;
+    int mode, method;
+    Point origin;
+};
+
+class RLECopyInvoker : public ParallelLoopBody
+{
+public:
+    RLECopyInvoker(CvSeq* const* _trees, const Vec4i* _chunkInfo, Point* _points,
+                   int* _offsets, Vec4i* _hierarchy) :
+        trees(_trees), chunkInfo(_chunkInfo), points(_points), offsets(_offsets), hierarchy(_hierarchy)
+    {
+    }
+
+    void operator()(const Range& range) const
+    {
+        for( int k = range.start; k < range.end; k++ )
+        {
+            CvSeq* tree = trees[k];
+            if( !tree )
+                continue;
+
+            // the contour and point indices of the chunk start from chunkInfo[k][0] and chunkInfo[k][1]
+            int cbase = chunkInfo[k][0], pbase = chunkInfo[k][1];
+            Seq<CvSeq*> all(tree);
+            SeqIterator<CvSeq*> it = all.begin();
+            for( int i = 0; i < tree->total; i++, ++it )
+            {
+                CvSeq* c = *it;
+                offsets[cbase + i] = pbase;
+                cvCvtSeqToArray(c, points + pbase);
+                pbase += c->total;
+                hierarchy[cbase + i] =
+                    Vec4i(c->h_next ? ((CvContour*)c->h_next)->color + cbase : -1,
+                          c->h_prev ? ((CvContour*)c->h_prev)->color + cbase : -1,
+                          c->v_next ? ((CvContour*)c->v_next)->color + cbase : -1,
+                          c->v_prev ? ((CvContour*)c->v_prev)->color + cbase : -1);
+            }
+        }
+    }
+
+private:
+    CvSeq* const* trees;
+    const Vec4i* chunkInfo;
+    Point* points;
+    int* offsets;
+    Vec4i* hierarchy;
+};
+
+void FlatContoursFinder::checkParams(int mode, int method)
+{
+    CV_Assert( (mode == RETR_EXTERNAL || mode == RETR_LIST || mode == RETR_CCOMP || mode == RETR_TREE) &&
+               (method >= CHAIN_APPROX_NONE && method <= CHAIN_APPROX_TC89_KCOS) );
+}
+
+void FlatContoursFinder::findDense(const Mat& image, FlatContours::Impl& fc, int mode, int method, Point offset)
+{
+    CV_Assert( image.type() == CV_8UC1 );
+    checkParams(mode, method);
+
+    // the 1-pixel image border is treated as zeros, so only the inner part is encoded
+    if( image.rows < 3 || image.cols < 3 )
+    {
+        fc.clear();
+        return;
+    }
+    rleThreshold(image(Rect(1, 1, image.cols - 2, image.rows - 2)), 0, THRESH_BINARY, fc.mask, fc.stripes);
+    find(fc, mode, method, offset + Point(1, 1));
+}
+
+void FlatContoursFinder::findRLE(const RLEImage& image, FlatContours::Impl& fc, int mode, int method, Point offset)
+{
+    checkParams(mode, method);
+
+    if( image.rows < 3 || image.cols < 3 )
+    {
+        fc.clear();
+        return;
+    }
+
+    int rows = image.rows - 2, cols = image.cols - 2;
+    RLEImage& mask = fc.mask;
+    mask.create(Size(cols, rows));
+    for( int y = 0; y < rows; y++ )
+    {
+        int n;
+        const Vec2i* r = rleRow(image, y + 1, n);
+        for( int i = 0; i < n; i++ )
+        {
+            int a = std::max(r[i][0], 1) - 1, b = std::min(r[i][1], cols + 1) - 1;
+            if( a < b )
+                mask.runs.push_back(Vec2i(a, b));
+        }
+        mask.rowOfs[y+1] = (int)mask.runs.size();
+    }
+    find(fc, mode, method, offset + Point(1, 1));
+}
+
+// labels the 8-connected components of the runs and computes their bounding boxes;
+// the components are numbered in the raster order of their first pixels
+void FlatContoursFinder::label(FlatContours::Impl& fc)
+{
+    const RLEImage& mask = fc.mask;
+    int rows = mask.rows, nruns = (int)mask.runs.size();
+    vector<int>& P = fc.labels;
+    P.resize(nruns);
+
+    // the strips are labeled in parallel and the components crossing the strip boundaries
+    // are merged afterwards; the roots are the smallest indices, so the result does not
+    // depend on the number of strips
+    int nstrips = (int)std::min((size_t)std::max(rows/4, 1), (size_t)rows*mask.cols/RLE_PARALLEL_MIN);
+    nstrips = std::max(std::min(nstrips, getNumThreads()*4), 1);
+
+    AutoBuffer<int> _stripRows(nstrips + 1);
+    int* stripRows = _stripRows;
+    for( int k = 0; k <= nstrips; k++ )
+        stripRows[k] = (int)((int64)rows*k/nstrips);
+
+    RLELabelInvoker body(mask, P, stripRows);
+    if( nstrips > 1 )
+        parallel_for_(Range(0, nstrips), body, nstrips);
+    else
+        body(Range(0, 1));
+
+    const int* rowOfs = &mask.rowOfs[0];
+    for( int k = 1; k < nstrips; k++ )
+    {
+        int y = stripRows[k];
+        rleUniteRows(mask.runs, rowOfs[y-1], rowOfs[y], rowOfs[y+1], P);
+    }
+
+    // every parent precedes its children, so the labels can be replaced in place
+    fc.boxes.clear();
+    for( int y = 0; y < rows; y++ )
+        for( int i = rowOfs[y]; i < rowOfs[y+1]; i++ )
+        {
+            const Vec2i& r = mask.runs[i];
+            if( P[i] == i )
+            {
+                P[i] = (int)fc.boxes.size();
+                fc.boxes.push_back(Vec4i(r[0], y, r[1], y + 1));
+                continue;
+            }
+            Vec4i& b = fc.boxes[P[i] = P[P[i]]];
+            b[0] = std::min(b[0], r[0]);
+            b[2] = std::max(b[2], r[1]);
+            b[3] = y + 1;
+        }
+}
+
+// groups the nested components and splits the groups into chunks that are traced independently;
+// returns the number of chunks
+int FlatContoursFinder::makeChunks(FlatContours::Impl& fc, int ncomps)
+{
+    vector<Vec4i>& boxes = fc.boxes;
+    vector<int>& groups = fc.groups;
+    vector<int>& active = fc.active;
+
+    // a component can be nested into another one only if its bounding box lies strictly inside
+    // the other box, so such components are put into the same group; the components are sorted
+    // by the top row, and the active ones are those that can still contain the next components
+    groups.resize(ncomps);
+    active.clear();
+    for( int c = 0; c < ncomps; c++ )
+    {
+        const Vec4i& b = boxes[c];
+        size_t n = 0;
+        groups[c] = c;
+        for( size_t l = 0; l < active.size(); l++ )
+        {
+            int a = active[l];
+            const Vec4i& ba = boxes[a];
+            if( ba[3] <= b[1] + 1 )
+                continue;
+            active[n++] = a;
+            if( ba[1] < b[1] && ba[0] < b[0] && b[2] < ba[2] && b[3] < ba[3] )
+                rleUnion(groups, a, c);
+        }
+        active.resize(n);
+        // a component without holes cannot contain anything
+        if( b[2] - b[0] > 2 && b[3] - b[1] > 2 )
+            active.push_back(c);
+    }
+
+    // the group boxes are collected in the boxes of the roots, which precede the other members
+    for( int c = 0; c < ncomps; c++ )
+    {
+        int g = groups[c] = rleFindRoot(groups, c);
+        if( g == c )
+            continue;
+        Vec4i& bg = boxes[g];
+        const Vec4i& b = boxes[c];
+        bg = Vec4i(std::min(bg[0], b[0]), bg[1], std::max(bg[2], b[2]), std::max(bg[3], b[3]));
+    }
+
+    // the groups are taken in the order of their top rows and added to the current chunk while
+    // the chunk box stays small; the split does not depend on the number of threads, so neither
+    // does the order of the contours
+    vector<Vec4i>& chunkBoxes = fc.chunkBoxes;
+    chunkBoxes.clear();
+    for( int c = 0; c < ncomps; c++ )
+    {
+        if( groups[c] != c )
+        {
+            groups[c] = groups[groups[c]];
+            continue;
+        }
+        const Vec4i& b = boxes[c];
+        if( !chunkBoxes.empty() )
+        {
+            const Vec4i& cb = chunkBoxes.back();
+            Vec4i u(std::min(cb[0], b[0]), cb[1], std::max(cb[2], b[2]), std::max(cb[3], b[3]));
+            if( (int64)(u[2] - u[0])*(u[3] - u[1]) <= RLE_CHUNK_AREA )
+            {
+                chunkBoxes.back() = u;
+                groups[c] = (int)chunkBoxes.size() - 1;
+                continue;
+            }
+        }
+        groups[c] = (int)chunkBoxes.size();
+        chunkBoxes.push_back(b);
+    }
+    return (int)chunkBoxes.size();
+}
+
+void FlatContoursFinder::find(FlatContours::Impl& fc, int mode, int method, Point origin)
+{
+    const RLEImage& mask = fc.mask;
+    int rows = mask.rows, nruns = (int)mask.runs.size();
+    if( nruns == 0 )
+    {
+        fc.clear();
+        return;
+    }
+
+    label(fc);
+    int nchunks = makeChunks(fc, (int)fc.boxes.size());
+
+    // sort the runs by the chunk, keeping the raster order inside the chunks
+    vector<int>& chunkOfs = fc.chunkOfs;
+    vector<int>& pos = fc.active;
+    const int* rowOfs = &mask.rowOfs[0];
+    int i, k;
+
+    chunkOfs.assign(nchunks + 1, 0);
+    for( i = 0; i < nruns; i++ )
+    {
+        k = fc.labels[i] = fc.groups[fc.labels[i]];
+        chunkOfs[k+1]++;
+    }
+    for( k = 0; k < nchunks; k++ )
+        chunkOfs[k+1] += chunkOfs[k];
+    pos.assign(chunkOfs.begin(), chunkOfs.end() - 1);
+    fc.chunkRuns.resize(nruns);
+    for( int y = 0; y < rows; y++ )
+        for( i = rowOfs[y]; i < rowOfs[y+1]; i++ )
+        {
+            const Vec2i& r = mask.runs[i];
+            fc.chunkRuns[pos[fc.labels[i]]++] = Vec3i(r[0], r[1], y);
+        }
+
+    if( (int)fc.patches.size() < nchunks )
+    {
+        fc.patches.resize(nchunks);
+        fc.storages.resize(nchunks);
+    }
+    for( k = 0; k < nchunks; k++ )
+        if( fc.storages[k].empty() )
+            fc.storages[k] = MemStorage(cvCreateMemStorage());
+    fc.trees.resize(nchunks);
+    fc.chunkInfo.resize(nchunks);
+
+    RLETraceInvoker trace(&fc.chunkBoxes[0], &fc.chunkRuns[0], &fc.chunkOfs[0], &fc.patches[0],
+                          &fc.storages[0], &fc.trees[0], &fc.chunkInfo[0], mode, method, origin);
+    if( nchunks > 1 )
+        parallel_for_(Range(0, nchunks), trace, nchunks);
+    else
+        trace(Range(0, nchunks));
+
+    int ncontours = 0, npoints = 0;
+    for( k = 0; k < nchunks; k++ )
+    {
+        Vec4i& info = fc.chunkInfo[k];
+        int n = info[2], np = info[3];
+        info[0] = ncontours;
+        info[1] = npoints;
+        ncontours += n;
+        npoints += np;
+    }
+
+    fc.points.resize(npoints);
+    fc.offsets.resize(ncontours + 1);
+    fc.hierarchy.resize(ncontours);
+
+    RLECopyInvoker copy(&fc.trees[0], &fc.chunkInfo[0], &fc.points[0], &fc.offsets[0], &fc.hierarchy[0]);
+    if( nchunks > 1 )
+        parallel_for_(Range(0, nchunks), copy, nchunks);
+    else
+        copy(Range(0, nchunks));
+    fc.offsets[ncontours] = npoints;
+
+    // chain the top-level contours of every chunk after the ones of the previous chunks;
+    // the first contour of a chunk is always on the top level
+    int prevTail = -1;
+    for( k = 0; k < nchunks; k++ )
+    {
+        const Vec4i& info = fc.chunkInfo[k];
+        if( info[2] == 0 )
+            continue;
+        int head = info[0], tail = head;
+        while( fc.hierarchy[tail][0] >= 0 )
+            tail = fc.hierarchy[tail][0];
+        if( prevTail >= 0 )
+        {
+            fc.hierarchy[prevTail][0] = head;
+            fc.hierarchy[head][1] = prevTail;
+        }
+        prevTail = tail;
+    }
+}
+
+}
+
+
+cv::FlatContours::FlatContours() : impl(new Impl)
+{
+}
+
+cv::FlatContours::FlatContours(const FlatContours& c) : impl(new Impl)
+{
+    *this = c;
+}
+
+cv::FlatContours& cv::FlatContours::operator = (const FlatContours& c)
+{
+    if( this != &c )
+    {
+        impl->points = c.impl->points;
+        impl->offsets = c.impl->offsets;
+        impl->hierarchy = c.impl->hierarchy;
+    }
+    return *this;
+}
+
+cv::FlatContours::~FlatContours()
+{
+    delete impl;
+}
+
+int cv::FlatContours::size() const
+{
+    return (int)impl->offsets.size() - 1;
+}
+
+bool cv::FlatContours::empty() const
+{
+    return size() == 0;
+}
+
+const cv::Point* cv::FlatContours::contour(int i) const
+{
+    CV_DbgAssert( 0 <= i && i < size() );
+    return &impl->points[0] + impl->offsets[i];
+}
+
+int cv::FlatContours::contourSize(int i) const
+{
+    CV_DbgAssert( 0 <= i && i < size() );
+    return impl->offsets[i+1] - impl->offsets[i];
+}
+
+void cv::FlatContours::clear()
+{
+    impl->clear();
+}
+
+const std::vector<cv::Point>& cv::FlatContours::points() const
+{
+    return impl->points;
+}
+
+const std::vector<int>& cv::FlatContours::offsets() const
+{
+    return impl->offsets;
+}
+
+const std::vector<cv::Vec4i>& cv::FlatContours::hierarchy() const
+{
+    return impl->hierarchy;
+}
+
+
+void cv::findContours( InputArray image, FlatContours& contours, int mode, int method, Point offset )
+{
+    FlatContoursFinder::findDense(image.getMat(), *contours.impl, mode, method, offset);
+}
+
+void cv::findContours( const RLEImage& image, FlatContours& contours, int mode, int method, Point offset )
+{
+    FlatContoursFinder::findRLE(image, *contours.impl, mode, method, offset);
+}
+
+void cv::findContours( const RLEImage& image, OutputArrayOfArrays _contours,
+                       OutputArray _hierarchy, int mode, int method, Point offset )
+{
+    FlatContours fc;
+    findContours(image, fc, mode, method, offset);
+
+    if( _hierarchy.needed() )
+        _hierarchy.clear();
+
+    int i, total = fc.size();
+    if( total == 0 )
+    {
+        _contours.clear();
+        return;
+    }
+
+    _contours.create(total, 1, 0, -1, true);
+    for( i = 0; i < total; i++ )
+    {
+        _contours.create(fc.contourSize(i), 1, CV_32SC2, i, true);
+        Mat ci = _contours.getMat(i);
+        CV_Assert( ci.isContinuous() );
+        memcpy(ci.data, fc.contour(i), fc.contourSize(i)*sizeof(Point));
+    }
+
+    if( _hierarchy.needed() )
+    {
+        _hierarchy.create(1, total, CV_32SC4, -1, true);
+        Mat(fc.hierarchy()).reshape(4, 1).copyTo(_hierarchy);
+    }
+}
+
+void cv::findContours( const RLEImage& image, OutputArrayOfArrays contours,
+                       int mode, int method, Point offset )
+{
+    findContours(image, contours, noArray(), mode, method, offset);
+}
@@ -66,7 +66,8 @@ namespace cv
                                          Box Filter
 \****************************************************************************************/
 
-template<typename T, typename ST> struct RowSum : public BaseRowFilter
+template<typename T, typename ST> struct RowSum :
+    public BaseRowFilter, public CloneableFilter<BaseRowFilter>
 {
     RowSum( int _ksize, int _anchor )
     {
@@ -74,6 +75,8 @@ template<typename T, typename ST> struct RowSum : public BaseRowFilter
         anchor = _anchor;
     }
 
+    Ptr<BaseRowFilter> clone() const { return new RowSum(*this); }
+
     void operator()(const uchar* src, uchar* dst, int width, int cn)
     {
         const T* S = (const T*)src;
@@ -97,7 +100,8 @@ template<typename T, typename ST> struct RowSum : public BaseRowFilter
 };
 
 
-template<typename ST, typename T> struct ColumnSum : public BaseColumnFilter
+template<typename ST, typename T> struct ColumnSum :
+    public BaseColumnFilter, public CloneableFilter<BaseColumnFilter>
 {
     ColumnSum( int _ksize, int _anchor, double _scale )
     {
@@ -109,6 +113,13 @@ template<typename ST, typename T> struct ColumnSum : public BaseColumnFilter
 
     void reset() { sumCount = 0; }
 
+    // the floating-point sliding sum depends on the row where the summation has started,
+    // so only the integer sums can be split between the threads without changing the result
+    Ptr<BaseColumnFilter> clone() const
+    {
+        return std::numeric_limits<ST>::is_integer ? new ColumnSum(*this) : 0;
+    }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         int i;
@@ -1218,6 +1229,290 @@ medianBlur_SortNet( const Mat& _src, Mat& _dst, int m )
     }
 }
 
+typedef void (*MedianBlur8uFunc)( const Mat& src, Mat& dst, int ksize );
+
+/*
+ Runs one of the 8u median implementations on vertical slabs of the image.
+ Each output column depends only on the ksize source columns around it,
+ so the slabs are independent and the result does not depend on the split.
+*/
+class MedianBlur8uInvoker : public ParallelLoopBody
+{
+public:
+    MedianBlur8uInvoker( const Mat& _src, Mat& _dst, int _ksize,
+                         int _slabWidth, MedianBlur8uFunc _func ) :
+        src(_src), dst(_dst), ksize(_ksize), slabWidth(_slabWidth), func(_func)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int x0 = range.start*slabWidth, x1 = std::min(range.end*slabWidth, dst.cols);
+        Mat dstSlab = dst.colRange(x0, x1);
+        func( src.colRange(x0, x1 + ksize - 1), dstSlab, ksize );
+    }
+
+private:
+    Mat src;
+    Mat dst;
+    int ksize;
+    int slabWidth;
+    MedianBlur8uFunc func;
+};
+
+enum { MEDIAN_PARALLEL_MIN = 1 << 16, MEDIAN_MIN_SLAB_WIDTH = 64 };
+
+static void
+medianBlur_8u_parallel( const Mat& src, Mat& dst, int ksize, MedianBlur8uFunc func )
+{
+    int nslabs = std::min( (int)(dst.total()/MEDIAN_PARALLEL_MIN),
+                           dst.cols/MEDIAN_MIN_SLAB_WIDTH );
+    nslabs = std::min( nslabs, std::max(getNumThreads(), 1) );
+    if( nslabs <= 1 )
+    {
+        func( src, dst, ksize );
+        return;
+    }
+
+    // round the slab width to a multiple of 16 columns to keep the slabs aligned
+    int slabWidth = ((dst.cols + nslabs - 1)/nslabs + 15) & -16;
+    nslabs = (dst.cols + slabWidth - 1)/slabWidth;
+    parallel_for_( Range(0, nslabs),
+                   MedianBlur8uInvoker(src, dst, ksize, slabWidth, func), nslabs );
+}
+
+/*
+ Median filter with large apertures for 16u, 16s and 32f images.
+
+ The image is processed in square tiles. The source tile, together with
+ its (ksize/2)-wide border, is radix-sorted and the values are replaced
+ with their dense ranks, which index a two-level (coarse/fine) histogram
+ just like in the 8u algorithms above. The window walks the tile in a
+ serpentine order, so that each step only removes one row or column and
+ adds another one, and the median rank is tracked incrementally from the
+ previous position. The tiles are independent and are processed in parallel.
+*/
+template<typename T> struct MedianRankKey {};
+
+template<> struct MedianRankKey<ushort>
+{
+    enum { BITS = 16 };
+    static unsigned get( ushort v ) { return v; }
+};
+
+template<> struct MedianRankKey<short>
+{
+    enum { BITS = 16 };
+    static unsigned get( short v ) { return (unsigned)(v + 32768); }
+};
+
+template<> struct MedianRankKey<float>
+{
+    enum { BITS = 32 };
+    static unsigned get( float v )
+    {
+        Cv32suf u;
+        u.f = v;
+        return u.i < 0 ? ~(unsigned)u.i : (unsigned)u.i | 0x80000000u;
+    }
+};
+
+template<typename T> class MedianBlurRankInvoker : public ParallelLoopBody
+{
+public:
+    enum { COARSE_SHIFT = 4, RADIX_BITS = MedianRankKey<T>::BITS == 16 ? 8 : 11 };
+
+    MedianBlurRankInvoker( const Mat& _src, Mat& _dst, int _ksize, int _tileSize ) :
+        src(_src), dst(_dst), ksize(_ksize), tileSize(_tileSize)
+    {
+        tilesX = (dst.cols + tileSize - 1)/tileSize;
+    }
+
+    void operator()( const Range& range ) const
+    {
+        const int BUCKET = 1 << COARSE_SHIFT, BUCKET_MASK = BUCKET - 1;
+        int cn = dst.channels();
+        int maxw = tileSize + ksize - 1, maxsize = maxw*maxw;
+        AutoBuffer<unsigned> _keys(maxsize*2);
+        AutoBuffer<int> _idx(maxsize*2), _ranks(maxsize), _fine(maxsize + 1);
+        AutoBuffer<int> _coarse((maxsize >> COARSE_SHIFT) + 2), _counts(1 << RADIX_BITS);
+        AutoBuffer<T> _values(maxsize), _tile(maxsize);
+        unsigned *keys = _keys, *keys1 = keys + maxsize;
+        int *idx = _idx, *idx1 = idx + maxsize;
+        int *ranks = _ranks, *fine = _fine, *coarse = _coarse, *counts = _counts;
+        T *values = _values, *tileVals = _tile;
+        int t = ksize*ksize/2;
+
+        for( int tile = range.start; tile < range.end; tile++ )
+        {
+            int x0 = (tile % tilesX)*tileSize, y0 = (tile / tilesX)*tileSize;
+            int tw = std::min(tileSize, dst.cols - x0), th = std::min(tileSize, dst.rows - y0);
+            int iw = tw + ksize - 1, ih = th + ksize - 1, isize = iw*ih;
+
+            for( int c = 0; c < cn; c++ )
+            {
+                for( int y = 0; y < ih; y++ )
+                {
+                    const T* sptr = (const T*)src.ptr(y0 + y) + x0*cn + c;
+                    for( int x = 0; x < iw; x++ )
+                    {
+                        T v = sptr[x*cn];
+                        tileVals[y*iw + x] = v;
+                        keys[y*iw + x] = MedianRankKey<T>::get(v);
+                        idx[y*iw + x] = y*iw + x;
+                    }
+                }
+
+                // LSD radix sort of the keys; the passes where all the digits are equal are skipped
+                unsigned *k0 = keys, *k1 = keys1;
+                int *i0 = idx, *i1 = idx1;
+                for( int shift = 0; shift < MedianRankKey<T>::BITS; shift += RADIX_BITS )
+                {
+                    const unsigned mask = (1u << RADIX_BITS) - 1;
+                    memset( counts, 0, sizeof(counts[0]) << RADIX_BITS );
+                    for( int i = 0; i < isize; i++ )
+                        counts[(k0[i] >> shift) & mask]++;
+                    if( counts[(k0[0] >> shift) & mask] == isize )
+                        continue;
+                    for( int i = 0, sum = 0; i <= (int)mask; i++ )
+                    {
+                        int n = counts[i];
+                        counts[i] = sum;
+                        sum += n;
+                    }
+                    for( int i = 0; i < isize; i++ )
+                    {
+                        int pos = counts[(k0[i] >> shift) & mask]++;
+                        k1[pos] = k0[i];
+                        i1[pos] = i0[i];
+                    }
+                    std::swap(k0, k1);
+                    std::swap(i0, i1);
+                }
+
+                // replace the source values with their dense ranks
+                int nranks = 0;
+                for( int i = 0; i < isize; i++ )
+                {
+                    if( i == 0 || k0[i-1] != k0[i] )
+                        values[nranks++] = tileVals[i0[i]];
+                    ranks[i0[i]] = nranks - 1;
+                }
+
+                memset( fine, 0, (nranks + 1)*sizeof(fine[0]) );
+                memset( coarse, 0, ((nranks >> COARSE_SHIFT) + 1)*sizeof(coarse[0]) );
+
+                for( int y = 0; y < ksize; y++ )
+                    for( int x = 0; x < ksize; x++ )
+                    {
+                        int v = ranks[y*iw + x];
+                        fine[v]++;
+                        coarse[v >> COARSE_SHIFT]++;
+                    }
+
+                // "m" is the current median rank and "below" is the number of elements with smaller ranks
+                int m = 0, below = 0;
+
+                for( int y = 0; y < th; y++ )
+                {
+                    T* dptr = (T*)dst.ptr(y0 + y) + x0*cn + c;
+                    bool forward = (y & 1) == 0;
+
+                    if( y > 0 )
+                    {
+                        // move the window one row down
+                        int xw = forward ? 0 : tw - 1;
+                        const int* rem = ranks + (y - 1)*iw + xw;
+                        const int* add = ranks + (y + ksize - 1)*iw + xw;
+                        for( int k = 0; k < ksize; k++ )
+                        {
+                            int v = rem[k];
+                            fine[v]--; coarse[v >> COARSE_SHIFT]--;
+                            below -= v < m;
+                            v = add[k];
+                            fine[v]++; coarse[v >> COARSE_SHIFT]++;
+                            below += v < m;
+                        }
+                    }
+
+                    for( int i = 0; i < tw; i++ )
+                    {
+                        int x = forward ? i : tw - 1 - i;
+
+                        if( i > 0 )
+                        {
+                            // move the window one column left or right
+                            int xrem = forward ? x - 1 : x + ksize;
+                            int xadd = forward ? x + ksize - 1 : x;
+                            const int* rem = ranks + y*iw + xrem;
+                            const int* add = ranks + y*iw + xadd;
+                            for( int k = 0; k < ksize*iw; k += iw )
+                            {
+                                int v = rem[k];
+                                fine[v]--; coarse[v >> COARSE_SHIFT]--;
+                                below -= v < m;
+                                v = add[k];
+                                fine[v]++; coarse[v >> COARSE_SHIFT]++;
+                                below += v < m;
+                            }
+                        }
+
+                        // move the median, skipping whole coarse buckets where possible
+                        if( below > t )
+                        {
+                            do
+                            {
+                                if( (m & BUCKET_MASK) == 0 && below - coarse[(m >> COARSE_SHIFT) - 1] > t )
+                                {
+                                    m -= BUCKET;
+                                    below -= coarse[m >> COARSE_SHIFT];
+                                }
+                                else
+                                    below -= fine[--m];
+                            }
+                            while( below > t );
+                        }
+                        else
+                        {
+                            while( below + fine[m] <= t )
+                            {
+                                if( (m & BUCKET_MASK) == 0 && below + coarse[m >> COARSE_SHIFT] <= t )
+                                {
+                                    below += coarse[m >> COARSE_SHIFT];
+                                    m += BUCKET;
+                                }
+                                else
+                                    below += fine[m++];
+                            }
+                        }
+
+                        dptr[x*cn] = values[m];
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    Mat src;
+    Mat dst;
+    int ksize;
+    int tileSize;
+    int tilesX;
+};
+
+template<typename T> static void
+medianBlur_Rank( const Mat& src, Mat& dst, int ksize )
+{
+    int tileSize = std::max(32, ksize*2);
+    int ntiles = ((dst.cols + tileSize - 1)/tileSize)*((dst.rows + tileSize - 1)/tileSize);
+    MedianBlurRankInvoker<T> body(src, dst, ksize, tileSize);
+    if( ntiles > 1 && dst.total()*ksize >= (size_t)MEDIAN_PARALLEL_MIN )
+        parallel_for_( Range(0, ntiles), body, ntiles );
+    else
+        body( Range(0, ntiles) );
+}
+
 }
 
 void cv::medianBlur( InputArray _src0, OutputArray _dst, int ksize )
@@ -1266,6 +1561,20 @@ void cv::medianBlur( InputArray _src0, OutputArray _dst, int ksize )
 
         return;
     }
+    else if( src0.depth() != CV_8U )
+    {
+        int r = ksize/2;
+        cv::copyMakeBorder( src0, src, r, r, r, r, BORDER_REPLICATE );
+
+        if( src.depth() == CV_16U )
+            medianBlur_Rank<ushort>( src, dst, ksize );
+        else if( src.depth() == CV_16S )
+            medianBlur_Rank<short>( src, dst, ksize );
+        else if( src.depth() == CV_32F )
+            medianBlur_Rank<float>( src, dst, ksize );
+        else
+            CV_Error(CV_StsUnsupportedFormat, "");
+    }
     else
     {
         cv::copyMakeBorder( src0, src, 0, 0, ksize/2, ksize/2, BORDER_REPLICATE );
@@ -1275,9 +1584,9 @@ void cv::medianBlur( InputArray _src0, OutputArray _dst, int ksize )
 
         double img_size_mp = (double)(src0.total())/(1 << 20);
         if( ksize <= 3 + (img_size_mp < 1 ? 12 : img_size_mp < 4 ? 6 : 2)*(MEDIAN_HAVE_SIMD && checkHardwareSupport(CV_CPU_SSE2) ? 1 : 3))
-            medianBlur_8u_Om( src, dst, ksize );
+            medianBlur_8u_parallel( src, dst, ksize, medianBlur_8u_Om );
         else
-            medianBlur_8u_O1( src, dst, ksize );
+            medianBlur_8u_parallel( src, dst, ksize, medianBlur_8u_O1 );
     }
 }
 
@@ -1584,6 +1893,197 @@ bilateralFilter_32f( const Mat& src, Mat& dst, int d,
     parallel_for_(Range(0, size.height), body);
 }
 
+/*
+ Approximate bilateral filter computed on a bilateral grid
+ (S. Paris and F. Durand, "A Fast Approximation of the Bilateral Filter
+ using a Signal Processing Approach"). The pixels are accumulated into a
+ coarse 3D grid with sigmaSpace x sigmaSpace x sigmaColor cells, the grid is
+ blurred with the separable [1 4 6 4 1] kernel and the result is read back
+ with trilinear interpolation. The cost per pixel does not depend on the
+ sigmas. The grid is built in independent horizontal bands (with a 2-cell
+ overlap for the blur), which bounds the memory use and lets the bands be
+ processed in parallel.
+*/
+template<typename T, int cn> class BilateralGridInvoker : public ParallelLoopBody
+{
+public:
+    // the grid has PAD empty cells before the data and PAD+1 after it,
+    // so that the blur and the interpolation never need to check the bounds
+    enum { PAD = 2, BAND_ROWS = 8, NC = cn + 1 };
+
+    BilateralGridInvoker( const Mat& _src, Mat& _dst, double _sigmaColor, double _sigmaSpace,
+                          double _minVal, double _maxVal ) :
+        src(_src), dst(_dst), minVal((float)_minVal)
+    {
+        spaceScale = (float)(1./_sigmaSpace);
+        colorScale = (float)(1./_sigmaColor);
+        gw = cvFloor((src.cols - 1)*spaceScale) + 2 + PAD*2;
+        gd = cvFloor((_maxVal - _minVal)*colorScale) + 2 + PAD*2;
+
+        splatX.resize(src.cols);
+        sliceX.resize(src.cols);
+        sliceWX.resize(src.cols);
+        for( int x = 0; x < src.cols; x++ )
+        {
+            float fx = x*spaceScale;
+            splatX[x] = (cvRound(fx) + PAD)*gd*NC;
+            sliceX[x] = cvFloor(fx);
+            sliceWX[x] = fx - sliceX[x];
+            sliceX[x] = (sliceX[x] + PAD)*gd*NC;
+        }
+
+        splatY.resize(src.rows);
+        sliceY.resize(src.rows);
+        for( int y = 0; y < src.rows; y++ )
+        {
+            splatY[y] = cvRound(y*spaceScale) + PAD;
+            sliceY[y] = cvFloor(y*spaceScale) + PAD;
+        }
+
+        size_t rowSize = (size_t)gw*gd*NC;
+        bandRows = (int)std::max(std::min((size_t)BAND_ROWS, (size_t)(1 << 22)/rowSize), (size_t)1);
+    }
+
+    int bandCount() const
+    {
+        int rows = sliceY.back() - PAD + 1;
+        return (rows + bandRows - 1)/bandRows;
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int rowSize = gw*gd*NC, xstep = gd*NC;
+        int maxRows = bandRows + PAD*2 + 1;
+        AutoBuffer<float> _grid(rowSize*maxRows), _blurred(rowSize*(bandRows + 1)), _tmp(rowSize);
+        float *grid = _grid, *blurred = _blurred, *tmp = _tmp;
+        int x, y, c;
+
+        memset( tmp, 0, rowSize*sizeof(tmp[0]) );
+
+        for( int band = range.start; band < range.end; band++ )
+        {
+            // the band produces the rows [a, b) of the slicing grid
+            int a = PAD + band*bandRows, b = std::min(a + bandRows, sliceY.back() + 1);
+            int g0 = a - PAD, nrows = b - a + PAD*2 + 1;
+
+            memset( grid, 0, rowSize*nrows*sizeof(grid[0]) );
+
+            // splat
+            int ystart = (int)(std::lower_bound(splatY.begin(), splatY.end(), g0) - splatY.begin());
+            for( y = ystart; y < src.rows && splatY[y] < g0 + nrows; y++ )
+            {
+                const T* sptr = (const T*)src.ptr(y);
+                float* grow = grid + (splatY[y] - g0)*rowSize;
+                for( x = 0; x < src.cols; x++, sptr += cn )
+                {
+                    float guide = (float)sptr[0];
+                    for( c = 1; c < cn; c++ )
+                        guide += (float)sptr[c];
+                    if( cn > 1 )
+                        guide *= 1.f/cn;
+                    int z = cvRound((guide - minVal)*colorScale) + PAD;
+                    float* cell = grow + splatX[x] + z*NC;
+                    for( c = 0; c < cn; c++ )
+                        cell[c] += (float)sptr[c];
+                    cell[cn] += 1.f;
+                }
+            }
+
+            // blur along z and x inside of each grid row
+            for( int l = 0; l < nrows; l++ )
+            {
+                float* grow = grid + l*rowSize;
+                blur5( grow, tmp, gw, xstep, gd, NC, NC );
+                blur5( tmp, grow, 1, 0, gw, xstep, xstep );
+            }
+
+            // blur along y, keeping only the rows [a, b]
+            for( int l = 0; l <= b - a; l++ )
+            {
+                const float* g = grid + (l + PAD)*rowSize;
+                float* drow = blurred + l*rowSize;
+                for( x = 0; x < rowSize; x++ )
+                    drow[x] = (g[x - rowSize*2] + g[x + rowSize*2]) +
+                        (g[x - rowSize] + g[x + rowSize])*4.f + g[x]*6.f;
+            }
+
+            // slice
+            ystart = (int)(std::lower_bound(sliceY.begin(), sliceY.end(), a) - sliceY.begin());
+            for( y = ystart; y < src.rows && sliceY[y] < b; y++ )
+            {
+                const T* sptr = (const T*)src.ptr(y);
+                T* dptr = (T*)dst.ptr(y);
+                float wy = y*spaceScale + PAD - sliceY[y];
+                const float* r0 = blurred + (sliceY[y] - a)*rowSize;
+                const float* r1 = r0 + rowSize;
+
+                for( x = 0; x < src.cols; x++, sptr += cn, dptr += cn )
+                {
+                    float guide = (float)sptr[0];
+                    for( c = 1; c < cn; c++ )
+                        guide += (float)sptr[c];
+                    if( cn > 1 )
+                        guide *= 1.f/cn;
+                    float fz = (guide - minVal)*colorScale;
+                    int z = cvFloor(fz);
+                    float wz = fz - z, wx = sliceWX[x];
+                    float w00 = (1 - wy)*(1 - wx), w01 = (1 - wy)*wx, w10 = wy*(1 - wx), w11 = wy*wx;
+                    int ofs = sliceX[x] + (z + PAD)*NC;
+                    const float *p00 = r0 + ofs, *p01 = p00 + xstep, *p10 = r1 + ofs, *p11 = p10 + xstep;
+                    float acc[NC];
+
+                    for( c = 0; c < NC; c++ )
+                    {
+                        float v0 = p00[c]*w00 + p01[c]*w01 + p10[c]*w10 + p11[c]*w11;
+                        float v1 = p00[c+NC]*w00 + p01[c+NC]*w01 + p10[c+NC]*w10 + p11[c+NC]*w11;
+                        acc[c] = v0 + (v1 - v0)*wz;
+                    }
+
+                    if( acc[cn] > FLT_EPSILON )
+                    {
+                        float scale = 1.f/acc[cn];
+                        for( c = 0; c < cn; c++ )
+                            dptr[c] = saturate_cast<T>(acc[c]*scale);
+                    }
+                    else
+                    {
+                        for( c = 0; c < cn; c++ )
+                            dptr[c] = sptr[c];
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    // blurs "count" groups (spaced by "groupStep") of "len" elements (spaced by "step"),
+    // each element having "n" floats; the PAD elements on each side of a group are
+    // only read, so the result is the same as if they were the zero extension of the data
+    static void blur5( const float* src, float* dst, int count, int groupStep,
+                       int len, int step, int n )
+    {
+        for( int i = 0; i < count; i++ )
+        {
+            const float* s = src + i*groupStep;
+            float* d = dst + i*groupStep;
+            for( int j = PAD; j < len - PAD; j++ )
+            {
+                const float* sj = s + j*step;
+                float* dj = d + j*step;
+                for( int k = 0; k < n; k++ )
+                    dj[k] = (sj[k - step*2] + sj[k + step*2]) +
+                        (sj[k - step] + sj[k + step])*4.f + sj[k]*6.f;
+            }
+        }
+    }
+
+    Mat src;
+    Mat dst;
+    float minVal, spaceScale, colorScale;
+    int gw, gd, bandRows;
+    vector<int> splatX, sliceX, splatY, sliceY;
+    vector<float> sliceWX;
+};
 }
 
 void cv::bilateralFilter( InputArray _src, OutputArray _dst, int d,
@@ -1603,6 +2103,55 @@ void cv::bilateralFilter( InputArray _src, OutputArray _dst, int d,
         "Bilateral filtering is only implemented for 8u and 32f images" );
 }
 
+void cv::bilateralGridFilter( InputArray _src, OutputArray _dst,
+                              double sigmaColor, double sigmaSpace )
+{
+    Mat src = _src.getMat();
+    int type = src.type();
+
+    CV_Assert( type == CV_8UC1 || type == CV_8UC3 || type == CV_32FC1 || type == CV_32FC3 );
+
+    _dst.create( src.size(), type );
+    Mat dst = _dst.getMat();
+
+    if( sigmaColor <= 0 )
+        sigmaColor = 1;
+    if( sigmaSpace <= 0 )
+        sigmaSpace = 1;
+
+    if( src.data == dst.data )
+        src = src.clone();
+
+    double minVal = 0, maxVal = 0;
+    minMaxLoc( src.reshape(1), &minVal, &maxVal );
+    if( src.empty() || maxVal - minVal < FLT_EPSILON )
+    {
+        src.copyTo(dst);
+        return;
+    }
+
+    if( type == CV_8UC1 )
+    {
+        BilateralGridInvoker<uchar, 1> body(src, dst, sigmaColor, sigmaSpace, minVal, maxVal);
+        parallel_for_(Range(0, body.bandCount()), body);
+    }
+    else if( type == CV_8UC3 )
+    {
+        BilateralGridInvoker<uchar, 3> body(src, dst, sigmaColor, sigmaSpace, minVal, maxVal);
+        parallel_for_(Range(0, body.bandCount()), body);
+    }
+    else if( type == CV_32FC1 )
+    {
+        BilateralGridInvoker<float, 1> body(src, dst, sigmaColor, sigmaSpace, minVal, maxVal);
+        parallel_for_(Range(0, body.bandCount()), body);
+    }
+    else
+    {
+        BilateralGridInvoker<float, 3> body(src, dst, sigmaColor, sigmaSpace, minVal, maxVal);
+        parallel_for_(Range(0, body.bandCount()), body);
+    }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////
 
 CV_IMPL void
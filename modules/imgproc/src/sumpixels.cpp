@@ -45,6 +45,244 @@
 namespace cv
 {
 
+enum { INTEGRAL_PARALLEL_MIN = 1 << 16 };
+
+// horizontal prefix sums of one row, separately for every channel; sum or sqsum may be NULL
+template<typename T, typename ST, typename QT> struct IntegralRow
+{
+    int operator()( const T*, ST*, QT*, int, int ) const { return 0; }
+};
+
+#if CV_SSE2
+
+template<> struct IntegralRow<uchar, int, double>
+{
+    // returns the number of processed elements; the caller continues from there with the running sums
+    int operator()( const uchar* src, int* sum, double* sqsum, int width, int cn ) const
+    {
+        if( cn != 1 || !checkHardwareSupport(CV_CPU_SSE2) )
+            return 0;
+
+        // the squares are accumulated in 32 bits, which is exact for the rows of up to 33025 pixels
+        if( sqsum && width > 33025 )
+            return 0;
+
+        int x = 0;
+        __m128i z = _mm_setzero_si128(), s = z, sq = z;
+
+        for( ; x <= width - 8; x += 8 )
+        {
+            __m128i v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(src + x)), z);
+
+            if( sum )
+            {
+                // the prefix sums of 8 values fit 16 bits
+                __m128i p = _mm_add_epi16(v, _mm_slli_si128(v, 2));
+                p = _mm_add_epi16(p, _mm_slli_si128(p, 4));
+                p = _mm_add_epi16(p, _mm_slli_si128(p, 8));
+                __m128i p0 = _mm_add_epi32(_mm_unpacklo_epi16(p, z), s);
+                __m128i p1 = _mm_add_epi32(_mm_unpackhi_epi16(p, z), s);
+                _mm_storeu_si128((__m128i*)(sum + x), p0);
+                _mm_storeu_si128((__m128i*)(sum + x + 4), p1);
+                s = _mm_shuffle_epi32(p1, _MM_SHUFFLE(3, 3, 3, 3));
+            }
+
+            if( sqsum )
+            {
+                __m128i v0 = _mm_unpacklo_epi16(v, z), v1 = _mm_unpackhi_epi16(v, z);
+                v0 = _mm_madd_epi16(v0, v0);
+                v1 = _mm_madd_epi16(v1, v1);
+                v0 = _mm_add_epi32(v0, _mm_slli_si128(v0, 4));
+                v0 = _mm_add_epi32(v0, _mm_slli_si128(v0, 8));
+                v1 = _mm_add_epi32(v1, _mm_slli_si128(v1, 4));
+                v1 = _mm_add_epi32(v1, _mm_slli_si128(v1, 8));
+                v0 = _mm_add_epi32(v0, sq);
+                v1 = _mm_add_epi32(v1, _mm_shuffle_epi32(v0, _MM_SHUFFLE(3, 3, 3, 3)));
+                _mm_storeu_pd(sqsum + x, _mm_cvtepi32_pd(v0));
+                _mm_storeu_pd(sqsum + x + 2, _mm_cvtepi32_pd(_mm_srli_si128(v0, 8)));
+                _mm_storeu_pd(sqsum + x + 4, _mm_cvtepi32_pd(v1));
+                _mm_storeu_pd(sqsum + x + 6, _mm_cvtepi32_pd(_mm_srli_si128(v1, 8)));
+                sq = _mm_shuffle_epi32(v1, _MM_SHUFFLE(3, 3, 3, 3));
+            }
+        }
+
+        return x;
+    }
+};
+
+#endif
+
+template<typename T, typename ST, typename QT>
+static void integralRow_( const T* src, ST* sum, QT* sqsum, int width, int cn )
+{
+    int x0 = IntegralRow<T, ST, QT>()(src, sum, sqsum, width, cn);
+
+    for( int k = 0; k < cn; k++ )
+    {
+        ST s = 0;
+        QT sq = 0;
+        int x = x0 + k;
+
+        // continue from the sums computed by the vectorized part
+        if( x0 > 0 && sum )
+            s = sum[x0 - cn + k];
+        if( x0 > 0 && sqsum )
+            sq = sqsum[x0 - cn + k];
+
+        if( sum && sqsum )
+        {
+            for( ; x < width; x += cn )
+            {
+                T it = src[x];
+                s += it;
+                sq += (QT)it*it;
+                sum[x] = s;
+                sqsum[x] = sq;
+            }
+        }
+        else if( sum )
+        {
+            for( ; x < width; x += cn )
+            {
+                s += src[x];
+                sum[x] = s;
+            }
+        }
+        else
+        {
+            for( ; x < width; x += cn )
+            {
+                T it = src[x];
+                sq += (QT)it*it;
+                sqsum[x] = sq;
+            }
+        }
+    }
+}
+
+// adds the previous row of the integral image to the current one, which holds the row prefix sums
+template<typename ST> static inline void integralAddAbove_( ST* row, const ST* above, int start, int end )
+{
+    for( int x = start; x < end; x++ )
+        row[x] = above[x] + row[x];
+}
+
+// the first pass of the parallel algorithm: the row prefix sums
+template<typename T, typename ST, typename QT> class IntegralRowInvoker : public ParallelLoopBody
+{
+public:
+    IntegralRowInvoker( const T* _src, int _srcstep, ST* _sum, int _sumstep,
+                        QT* _sqsum, int _sqsumstep, int _width, int _cn ) :
+        src(_src), srcstep(_srcstep), sum(_sum), sumstep(_sumstep),
+        sqsum(_sqsum), sqsumstep(_sqsumstep), width(_width), cn(_cn)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        for( int y = range.start; y < range.end; y++ )
+        {
+            ST* srow = sum ? sum + (size_t)sumstep*(y + 1) : 0;
+            QT* sqrow = sqsum ? sqsum + (size_t)sqsumstep*(y + 1) : 0;
+            for( int k = 0; k < cn; k++ )
+            {
+                if( srow )
+                    srow[k] = 0;
+                if( sqrow )
+                    sqrow[k] = 0;
+            }
+            integralRow_(src + (size_t)srcstep*y, srow ? srow + cn : 0, sqrow ? sqrow + cn : 0, width, cn);
+        }
+    }
+
+private:
+    const T* src;
+    int srcstep;
+    ST* sum;
+    int sumstep;
+    QT* sqsum;
+    int sqsumstep;
+    int width, cn;
+};
+
+// the second pass of the parallel algorithm: the accumulation along the columns, by blocks of columns
+template<typename ST, typename QT> class IntegralColumnInvoker : public ParallelLoopBody
+{
+public:
+    IntegralColumnInvoker( ST* _sum, int _sumstep, QT* _sqsum, int _sqsumstep, int _height ) :
+        sum(_sum), sumstep(_sumstep), sqsum(_sqsum), sqsumstep(_sqsumstep), height(_height)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        for( int y = 2; y <= height; y++ )
+        {
+            if( sum )
+                integralAddAbove_(sum + (size_t)sumstep*y, sum + (size_t)sumstep*(y - 1), range.start, range.end);
+            if( sqsum )
+                integralAddAbove_(sqsum + (size_t)sqsumstep*y, sqsum + (size_t)sqsumstep*(y - 1), range.start, range.end);
+        }
+    }
+
+private:
+    ST* sum;
+    int sumstep;
+    QT* sqsum;
+    int sqsumstep;
+    int height;
+};
+
+/*
+   The up-right integral images. Every element is computed as the element above plus the row
+   prefix sum, both in the serial and in the parallel (two-pass) mode, so the result is the same
+   for any number of threads, bit-exactly for the floating-point types too.
+*/
+template<typename T, typename ST, typename QT>
+static void integralUpright_( const T* src, int srcstep, ST* sum, int sumstep,
+                              QT* sqsum, int sqsumstep, Size size, int cn )
+{
+    int y, k, width = size.width*cn;
+
+    if( sum )
+        memset( sum, 0, (width+cn)*sizeof(sum[0]));
+    if( sqsum )
+        memset( sqsum, 0, (width+cn)*sizeof(sqsum[0]));
+
+    if( size.area() >= INTEGRAL_PARALLEL_MIN && width >= 64 && getNumThreads() > 1 )
+    {
+        IntegralRowInvoker<T, ST, QT> rows(src, srcstep, sum, sumstep, sqsum, sqsumstep, width, cn);
+        parallel_for_(Range(0, size.height), rows, (int)std::min((size_t)size.height, (size_t)size.area()/INTEGRAL_PARALLEL_MIN));
+
+        IntegralColumnInvoker<ST, QT> columns(sum, sumstep, sqsum, sqsumstep, size.height);
+        parallel_for_(Range(cn, width + cn), columns, std::min(width/64, getNumThreads()*2));
+        return;
+    }
+
+    for( y = 0; y < size.height; y++, src += srcstep )
+    {
+        if( sum )
+            sum += sumstep;
+        if( sqsum )
+            sqsum += sqsumstep;
+
+        for( k = 0; k < cn; k++ )
+        {
+            if( sum )
+                sum[k] = 0;
+            if( sqsum )
+                sqsum[k] = 0;
+        }
+
+        integralRow_(src, sum ? sum + cn : 0, sqsum ? sqsum + cn : 0, width, cn);
+
+        if( sum )
+            integralAddAbove_(sum, sum - sumstep, cn, width + cn);
+        if( sqsum )
+            integralAddAbove_(sqsum, sqsum - sqsumstep, cn, width + cn);
+    }
+}
+
 template<typename T, typename ST, typename QT>
 void integral_( const T* src, size_t _srcstep, ST* sum, size_t _sumstep,
                 QT* sqsum, size_t _sqsumstep, ST* tilted, size_t _tiltedstep,
@@ -57,6 +295,12 @@ void integral_( const T* src, size_t _srcstep, ST* sum, size_t _sumstep,
     int tiltedstep = (int)(_tiltedstep/sizeof(ST));
     int sqsumstep = (int)(_sqsumstep/sizeof(QT));
 
+    if( tilted == 0 )
+    {
+        integralUpright_(src, srcstep, sum, sumstep, sqsum, sqsumstep, size, cn);
+        return;
+    }
+
     size.width *= cn;
 
     memset( sum, 0, (size.width+cn)*sizeof(sum[0]));
@@ -68,139 +312,96 @@ void integral_( const T* src, size_t _srcstep, ST* sum, size_t _sumstep,
         sqsum += sqsumstep + cn;
     }
 
-    if( tilted )
-    {
-        memset( tilted, 0, (size.width+cn)*sizeof(tilted[0]));
-        tilted += tiltedstep + cn;
-    }
+    memset( tilted, 0, (size.width+cn)*sizeof(tilted[0]));
+    tilted += tiltedstep + cn;
 
-    if( sqsum == 0 && tilted == 0 )
+    AutoBuffer<ST> _buf(size.width+cn);
+    ST* buf = _buf;
+    ST s;
+    QT sq;
+    for( k = 0; k < cn; k++, src++, sum++, tilted++, buf++ )
     {
-        for( y = 0; y < size.height; y++, src += srcstep - cn, sum += sumstep - cn )
+        sum[-cn] = tilted[-cn] = 0;
+
+        for( x = 0, s = 0, sq = 0; x < size.width; x += cn )
         {
-            for( k = 0; k < cn; k++, src++, sum++ )
-            {
-                ST s = sum[-cn] = 0;
-                for( x = 0; x < size.width; x += cn )
-                {
-                    s += src[x];
-                    sum[x] = sum[x - sumstep] + s;
-                }
-            }
+            T it = src[x];
+            buf[x] = tilted[x] = it;
+            s += it;
+            sq += (QT)it*it;
+            sum[x] = s;
+            if( sqsum )
+                sqsum[x] = sq;
         }
-    }
-    else if( tilted == 0 )
-    {
-        for( y = 0; y < size.height; y++, src += srcstep - cn,
-                        sum += sumstep - cn, sqsum += sqsumstep - cn )
+
+        if( size.width == cn )
+            buf[cn] = 0;
+
+        if( sqsum )
         {
-            for( k = 0; k < cn; k++, src++, sum++, sqsum++ )
-            {
-                ST s = sum[-cn] = 0;
-                QT sq = sqsum[-cn] = 0;
-                for( x = 0; x < size.width; x += cn )
-                {
-                    T it = src[x];
-                    s += it;
-                    sq += (QT)it*it;
-                    ST t = sum[x - sumstep] + s;
-                    QT tq = sqsum[x - sqsumstep] + sq;
-                    sum[x] = t;
-                    sqsum[x] = tq;
-                }
-            }
+            sqsum[-cn] = 0;
+            sqsum++;
         }
     }
-    else
+
+    for( y = 1; y < size.height; y++ )
     {
-        AutoBuffer<ST> _buf(size.width+cn);
-        ST* buf = _buf;
-        ST s;
-        QT sq;
-        for( k = 0; k < cn; k++, src++, sum++, tilted++, buf++ )
-        {
-            sum[-cn] = tilted[-cn] = 0;
+        src += srcstep - cn;
+        sum += sumstep - cn;
+        tilted += tiltedstep - cn;
+        buf += -cn;
 
-            for( x = 0, s = 0, sq = 0; x < size.width; x += cn )
-            {
-                T it = src[x];
-                buf[x] = tilted[x] = it;
-                s += it;
-                sq += (QT)it*it;
-                sum[x] = s;
-                if( sqsum )
-                    sqsum[x] = sq;
-            }
+        if( sqsum )
+            sqsum += sqsumstep - cn;
 
-            if( size.width == cn )
-                buf[cn] = 0;
+        for( k = 0; k < cn; k++, src++, sum++, tilted++, buf++ )
+        {
+            T it = src[0];
+            ST t0 = s = it;
+            QT tq0 = sq = (QT)it*it;
 
+            sum[-cn] = 0;
             if( sqsum )
-            {
                 sqsum[-cn] = 0;
-                sqsum++;
-            }
-        }
-
-        for( y = 1; y < size.height; y++ )
-        {
-            src += srcstep - cn;
-            sum += sumstep - cn;
-            tilted += tiltedstep - cn;
-            buf += -cn;
+            tilted[-cn] = tilted[-tiltedstep];
 
+            sum[0] = sum[-sumstep] + t0;
             if( sqsum )
-                sqsum += sqsumstep - cn;
+                sqsum[0] = sqsum[-sqsumstep] + tq0;
+            tilted[0] = tilted[-tiltedstep] + t0 + buf[cn];
 
-            for( k = 0; k < cn; k++, src++, sum++, tilted++, buf++ )
+            for( x = cn; x < size.width - cn; x += cn )
             {
-                T it = src[0];
-                ST t0 = s = it;
-                QT tq0 = sq = (QT)it*it;
-
-                sum[-cn] = 0;
-                if( sqsum )
-                    sqsum[-cn] = 0;
-                tilted[-cn] = tilted[-tiltedstep];
-
-                sum[0] = sum[-sumstep] + t0;
+                ST t1 = buf[x];
+                buf[x - cn] = t1 + t0;
+                t0 = it = src[x];
+                tq0 = (QT)it*it;
+                s += t0;
+                sq += tq0;
+                sum[x] = sum[x - sumstep] + s;
                 if( sqsum )
-                    sqsum[0] = sqsum[-sqsumstep] + tq0;
-                tilted[0] = tilted[-tiltedstep] + t0 + buf[cn];
-
-                for( x = cn; x < size.width - cn; x += cn )
-                {
-                    ST t1 = buf[x];
-                    buf[x - cn] = t1 + t0;
-                    t0 = it = src[x];
-                    tq0 = (QT)it*it;
-                    s += t0;
-                    sq += tq0;
-                    sum[x] = sum[x - sumstep] + s;
-                    if( sqsum )
-                        sqsum[x] = sqsum[x - sqsumstep] + sq;
-                    t1 += buf[x + cn] + t0 + tilted[x - tiltedstep - cn];
-                    tilted[x] = t1;
-                }
-
-                if( size.width > cn )
-                {
-                    ST t1 = buf[x];
-                    buf[x - cn] = t1 + t0;
-                    t0 = it = src[x];
-                    tq0 = (QT)it*it;
-                    s += t0;
-                    sq += tq0;
-                    sum[x] = sum[x - sumstep] + s;
-                    if( sqsum )
-                        sqsum[x] = sqsum[x - sqsumstep] + sq;
-                    tilted[x] = t0 + t1 + tilted[x - tiltedstep - cn];
-                    buf[x] = t0;
-                }
+                    sqsum[x] = sqsum[x - sqsumstep] + sq;
+                t1 += buf[x + cn] + t0 + tilted[x - tiltedstep - cn];
+                tilted[x] = t1;
+            }
 
+            if( size.width > cn )
+            {
+                ST t1 = buf[x];
+                buf[x - cn] = t1 + t0;
+                t0 = it = src[x];
+                tq0 = (QT)it*it;
+                s += t0;
+                sq += tq0;
+                sum[x] = sum[x - sumstep] + s;
                 if( sqsum )
-                    sqsum++;
+                    sqsum[x] = sqsum[x - sqsumstep] + sq;
+                tilted[x] = t0 + t1 + tilted[x - tiltedstep - cn];
+                buf[x] = t0;
             }
+
+            if( sqsum )
+                sqsum++;
         }
     }
 }
@@ -212,9 +413,12 @@ static void integral_##suffix( T* src, size_t srcstep, ST* sum, size_t sumstep,
 { integral_(src, srcstep, sum, sumstep, sqsum, sqsumstep, tilted, tiltedstep, size, cn); }
 
 DEF_INTEGRAL_FUNC(8u32s, uchar, int, double)
+DEF_INTEGRAL_FUNC(8u32s32f, uchar, int, float)
 DEF_INTEGRAL_FUNC(8u32f, uchar, float, double)
+DEF_INTEGRAL_FUNC(8u32f32f, uchar, float, float)
 DEF_INTEGRAL_FUNC(8u64f, uchar, double, double)
 DEF_INTEGRAL_FUNC(32f, float, float, double)
+DEF_INTEGRAL_FUNC(32f32f32f, float, float, float)
 DEF_INTEGRAL_FUNC(32f64f, float, double, double)
 DEF_INTEGRAL_FUNC(64f, double, double, double)
 
@@ -225,7 +429,8 @@ typedef void (*IntegralFunc)(const uchar* src, size_t srcstep, uchar* sum, size_
 }
 
 
-void cv::integral( InputArray _src, OutputArray _sum, OutputArray _sqsum, OutputArray _tilted, int sdepth )
+void cv::integral( InputArray _src, OutputArray _sum, OutputArray _sqsum, OutputArray _tilted,
+                   int sdepth, int sqdepth )
 {
     Mat src = _src.getMat(), sum, sqsum, tilted;
     int depth = src.depth(), cn = src.channels();
@@ -234,8 +439,20 @@ void cv::integral( InputArray _src, OutputArray _sum, OutputArray _sqsum, Output
     if( sdepth <= 0 )
         sdepth = depth == CV_8U ? CV_32S : CV_64F;
     sdepth = CV_MAT_DEPTH(sdepth);
-    _sum.create( isize, CV_MAKETYPE(sdepth, cn) );
-    sum = _sum.getMat();
+    if( sqdepth <= 0 )
+        sqdepth = CV_64F;
+    sqdepth = CV_MAT_DEPTH(sqdepth);
+
+    CV_Assert( _sum.needed() || _sqsum.needed() || _tilted.needed() );
+
+    // the tilted integral is computed together with the up-right one
+    if( _sum.needed() )
+    {
+        _sum.create( isize, CV_MAKETYPE(sdepth, cn) );
+        sum = _sum.getMat();
+    }
+    else if( _tilted.needed() )
+        sum.create( isize, CV_MAKETYPE(sdepth, cn) );
 
     if( _tilted.needed() )
     {
@@ -245,23 +462,29 @@ void cv::integral( InputArray _src, OutputArray _sum, OutputArray _sqsum, Output
 
     if( _sqsum.needed() )
     {
-        _sqsum.create( isize, CV_MAKETYPE(CV_64F, cn) );
+        _sqsum.create( isize, CV_MAKETYPE(sqdepth, cn) );
         sqsum = _sqsum.getMat();
     }
 
     IntegralFunc func = 0;
 
-    if( depth == CV_8U && sdepth == CV_32S )
+    if( depth == CV_8U && sdepth == CV_32S && sqdepth == CV_64F )
         func = (IntegralFunc)GET_OPTIMIZED(integral_8u32s);
-    else if( depth == CV_8U && sdepth == CV_32F )
+    else if( depth == CV_8U && sdepth == CV_32S && sqdepth == CV_32F )
+        func = (IntegralFunc)integral_8u32s32f;
+    else if( depth == CV_8U && sdepth == CV_32F && sqdepth == CV_64F )
         func = (IntegralFunc)integral_8u32f;
-    else if( depth == CV_8U && sdepth == CV_64F )
+    else if( depth == CV_8U && sdepth == CV_32F && sqdepth == CV_32F )
+        func = (IntegralFunc)integral_8u32f32f;
+    else if( depth == CV_8U && sdepth == CV_64F && sqdepth == CV_64F )
         func = (IntegralFunc)integral_8u64f;
-    else if( depth == CV_32F && sdepth == CV_32F )
+    else if( depth == CV_32F && sdepth == CV_32F && sqdepth == CV_64F )
         func = (IntegralFunc)integral_32f;
-    else if( depth == CV_32F && sdepth == CV_64F )
+    else if( depth == CV_32F && sdepth == CV_32F && sqdepth == CV_32F )
+        func = (IntegralFunc)integral_32f32f32f;
+    else if( depth == CV_32F && sdepth == CV_64F && sqdepth == CV_64F )
         func = (IntegralFunc)integral_32f64f;
-    else if( depth == CV_64F && sdepth == CV_64F )
+    else if( depth == CV_64F && sdepth == CV_64F && sqdepth == CV_64F )
         func = (IntegralFunc)integral_64f;
     else
         CV_Error( CV_StsUnsupportedFormat, "" );
@@ -272,12 +495,23 @@ void cv::integral( InputArray _src, OutputArray _sum, OutputArray _sqsum, Output
 
 void cv::integral( InputArray src, OutputArray sum, int sdepth )
 {
-    integral( src, sum, noArray(), noArray(), sdepth );
+    integral( src, sum, noArray(), noArray(), sdepth, CV_64F );
 }
 
 void cv::integral( InputArray src, OutputArray sum, OutputArray sqsum, int sdepth )
 {
-    integral( src, sum, sqsum, noArray(), sdepth );
+    integral( src, sum, sqsum, noArray(), sdepth, CV_64F );
+}
+
+void cv::integral( InputArray src, OutputArray sum, OutputArray sqsum,
+                   OutputArray tilted, int sdepth )
+{
+    integral( src, sum, sqsum, tilted, sdepth, CV_64F );
+}
+
+void cv::integral( InputArray src, OutputArray sum, OutputArray sqsum, int sdepth, int sqdepth )
+{
+    integral( src, sum, sqsum, noArray(), sdepth, sqdepth );
 }
 
 
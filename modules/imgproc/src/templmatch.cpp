@@ -44,73 +44,44 @@
 namespace cv
 {
 
-void crossCorr( const Mat& img, const Mat& _templ, Mat& corr,
-                Size corrsize, int ctype,
-                Point anchor, double delta, int borderType )
+enum { TEMPLMATCH_PARALLEL_MIN = 1 << 16 };
+
+// chooses the size of the correlation blocks and of their DFT for the given template and output size
+static Size crossCorrBlockSize( Size templsize, Size corrsize, Size& dftsize )
 {
     const double blockScale = 4.5;
     const int minBlockSize = 256;
-    std::vector<uchar> buf;
+    Size blocksize;
 
-    Mat templ = _templ;
-    int depth = img.depth(), cn = img.channels();
-    int tdepth = templ.depth(), tcn = templ.channels();
-    int cdepth = CV_MAT_DEPTH(ctype), ccn = CV_MAT_CN(ctype);
-    
-    CV_Assert( img.dims <= 2 && templ.dims <= 2 && corr.dims <= 2 );
-    
-    if( depth != tdepth && tdepth != std::max(CV_32F, depth) )
-    {
-        _templ.convertTo(templ, std::max(CV_32F, depth));
-        tdepth = templ.depth();
-    }
-    
-    CV_Assert( depth == tdepth || tdepth == CV_32F);
-    CV_Assert( corrsize.height <= img.rows + templ.rows - 1 &&
-               corrsize.width <= img.cols + templ.cols - 1 );
-    
-    CV_Assert( ccn == 1 || delta == 0 );
-    
-    corr.create(corrsize, ctype);
+    blocksize.width = cvRound(templsize.width*blockScale);
+    blocksize.width = std::max( blocksize.width, minBlockSize - templsize.width + 1 );
+    blocksize.width = std::min( blocksize.width, corrsize.width );
+    blocksize.height = cvRound(templsize.height*blockScale);
+    blocksize.height = std::max( blocksize.height, minBlockSize - templsize.height + 1 );
+    blocksize.height = std::min( blocksize.height, corrsize.height );
 
-    int maxDepth = depth > CV_8S ? CV_64F : std::max(std::max(CV_32F, tdepth), cdepth);
-    Size blocksize, dftsize;
-    
-    blocksize.width = cvRound(templ.cols*blockScale);
-    blocksize.width = std::max( blocksize.width, minBlockSize - templ.cols + 1 );
-    blocksize.width = std::min( blocksize.width, corr.cols );
-    blocksize.height = cvRound(templ.rows*blockScale);
-    blocksize.height = std::max( blocksize.height, minBlockSize - templ.rows + 1 );
-    blocksize.height = std::min( blocksize.height, corr.rows );
-
-    dftsize.width = std::max(getOptimalDFTSize(blocksize.width + templ.cols - 1), 2);
-    dftsize.height = getOptimalDFTSize(blocksize.height + templ.rows - 1);
+    dftsize.width = std::max(getOptimalDFTSize(blocksize.width + templsize.width - 1), 2);
+    dftsize.height = getOptimalDFTSize(blocksize.height + templsize.height - 1);
     if( dftsize.width <= 0 || dftsize.height <= 0 )
         CV_Error( CV_StsOutOfRange, "the input arrays are too big" );
 
     // recompute block size
-    blocksize.width = dftsize.width - templ.cols + 1;
-    blocksize.width = MIN( blocksize.width, corr.cols );
-    blocksize.height = dftsize.height - templ.rows + 1;
-    blocksize.height = MIN( blocksize.height, corr.rows );
+    blocksize.width = dftsize.width - templsize.width + 1;
+    blocksize.width = MIN( blocksize.width, corrsize.width );
+    blocksize.height = dftsize.height - templsize.height + 1;
+    blocksize.height = MIN( blocksize.height, corrsize.height );
 
-    Mat dftTempl( dftsize.height*tcn, dftsize.width, maxDepth );
-    Mat dftImg( dftsize, maxDepth );
-
-    int i, k, bufSize = 0;
-    if( tcn > 1 && tdepth != maxDepth )
-        bufSize = templ.cols*templ.rows*CV_ELEM_SIZE(tdepth);
+    return blocksize;
+}
 
-    if( cn > 1 && depth != maxDepth )
-        bufSize = std::max( bufSize, (blocksize.width + templ.cols - 1)*
-            (blocksize.height + templ.rows - 1)*CV_ELEM_SIZE(depth));
+// computes DFT of each template plane; the planes are stacked vertically in dftTempl
+static void templateSpectrum( const Mat& templ, Size dftsize, int maxDepth, Mat& dftTempl )
+{
+    int k, tdepth = templ.depth(), tcn = templ.channels();
+    Mat plane;
 
-    if( (ccn > 1 || cn > 1) && cdepth != maxDepth )
-        bufSize = std::max( bufSize, blocksize.width*blocksize.height*CV_ELEM_SIZE(cdepth));
+    dftTempl.create( dftsize.height*tcn, dftsize.width, maxDepth );
 
-    buf.resize(bufSize);
-    
-    // compute DFT of each template plane
     for( k = 0; k < tcn; k++ )
     {
         int yofs = k*dftsize.height;
@@ -120,7 +91,13 @@ void crossCorr( const Mat& img, const Mat& _templ, Mat& corr,
 
         if( tcn > 1 )
         {
-            src = tdepth == maxDepth ? dst1 : Mat(templ.size(), tdepth, &buf[0]);
+            if( tdepth == maxDepth )
+                src = dst1;
+            else
+            {
+                plane.create(templ.size(), tdepth);
+                src = plane;
+            }
             int pairs[] = {k, 0};
             mixChannels(&templ, 1, &src, 1, pairs, 1);
         }
@@ -135,15 +112,151 @@ void crossCorr( const Mat& img, const Mat& _templ, Mat& corr,
         }
         dft(dst, dst, 0, templ.rows);
     }
+}
 
-    int tileCountX = (corr.cols + blocksize.width - 1)/blocksize.width;
-    int tileCountY = (corr.rows + blocksize.height - 1)/blocksize.height;
-    int tileCount = tileCountX * tileCountY;
-    
+/*
+   Correlates the image with one or more templates, block by block. Every block of the image is
+   transformed once and then multiplied by the spectra of all the templates. The blocks are
+   independent and are processed in parallel; every block writes its own part of the outputs.
+*/
+class CrossCorrInvoker : public ParallelLoopBody
+{
+public:
+    CrossCorrInvoker( const Mat& _img0, Point _roiofs, const Mat* _dftTempl, const Size* _templSize,
+                      Mat* _corr, int _ntempl, Size _gridsize, Size _blocksize, Size _dftsize,
+                      int _maxDepth, Point _anchor, double _delta, int _borderType ) :
+        img0(_img0), roiofs(_roiofs), dftTempl(_dftTempl), templSize(_templSize), corr(_corr),
+        ntempl(_ntempl), gridsize(_gridsize), blocksize(_blocksize), dftsize(_dftsize),
+        maxDepth(_maxDepth), anchor(_anchor), delta(_delta), borderType(_borderType)
+    {
+        maxTemplSize = templSize[0];
+        for( int t = 1; t < ntempl; t++ )
+        {
+            maxTemplSize.width = std::max(maxTemplSize.width, templSize[t].width);
+            maxTemplSize.height = std::max(maxTemplSize.height, templSize[t].height);
+        }
+        tileCountX = (gridsize.width + blocksize.width - 1)/blocksize.width;
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int depth = img0.depth(), cn = img0.channels();
+        Mat dftImg( dftsize, maxDepth ), dftProd( dftsize, maxDepth ), plane;
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            int x = (i%tileCountX)*blocksize.width;
+            int y = (i/tileCountX)*blocksize.height;
+
+            Size bsz(std::min(blocksize.width, gridsize.width - x),
+                     std::min(blocksize.height, gridsize.height - y));
+            Size dsz(bsz.width + maxTemplSize.width - 1, bsz.height + maxTemplSize.height - 1);
+            int x0 = x - anchor.x + roiofs.x, y0 = y - anchor.y + roiofs.y;
+            int x1 = std::max(0, x0), y1 = std::max(0, y0);
+            int x2 = std::min(img0.cols, x0 + dsz.width);
+            int y2 = std::min(img0.rows, y0 + dsz.height);
+            Mat src0(img0, Range(y1, y2), Range(x1, x2));
+            Mat dst(dftImg, Rect(0, 0, dsz.width, dsz.height));
+            Mat dst1(dftImg, Rect(x1-x0, y1-y0, x2-x1, y2-y1));
+
+            for( int k = 0; k < cn; k++ )
+            {
+                Mat src = src0;
+                dftImg = Scalar::all(0);
+
+                if( cn > 1 )
+                {
+                    if( depth == maxDepth )
+                        src = dst1;
+                    else
+                    {
+                        plane.create(y2-y1, x2-x1, depth);
+                        src = plane;
+                    }
+                    int pairs[] = {k, 0};
+                    mixChannels(&src0, 1, &src, 1, pairs, 1);
+                }
+
+                if( dst1.data != src.data )
+                    src.convertTo(dst1, dst1.depth());
+
+                if( x2 - x1 < dsz.width || y2 - y1 < dsz.height )
+                    copyMakeBorder(dst1, dst, y1-y0, dst.rows-dst1.rows-(y1-y0),
+                                   x1-x0, dst.cols-dst1.cols-(x1-x0), borderType);
+
+                dft( dftImg, dftImg, 0, dsz.height );
+
+                for( int t = 0; t < ntempl; t++ )
+                {
+                    // the smaller templates have larger outputs, but the grid covers the largest one
+                    Mat& c = corr[t];
+                    Size tsz(std::min(bsz.width, c.cols - x), std::min(bsz.height, c.rows - y));
+                    if( tsz.width <= 0 || tsz.height <= 0 )
+                        continue;
+
+                    int ccn = c.channels(), cdepth = c.depth();
+                    Mat cdst(c, Rect(x, y, tsz.width, tsz.height));
+                    Mat dftTempl1(dftTempl[t], Rect(0, dftTempl[t].rows > dftsize.height ? k*dftsize.height : 0,
+                                                    dftsize.width, dftsize.height));
+                    mulSpectrums(dftImg, dftTempl1, dftProd, 0, true);
+                    dft( dftProd, dftProd, DFT_INVERSE + DFT_SCALE, tsz.height );
+
+                    Mat res = dftProd(Rect(0, 0, tsz.width, tsz.height));
+
+                    if( ccn > 1 )
+                    {
+                        if( cdepth != maxDepth )
+                        {
+                            Mat cplane;
+                            res.convertTo(cplane, cdepth, 1, delta);
+                            res = cplane;
+                        }
+                        int pairs[] = {0, k};
+                        mixChannels(&res, 1, &cdst, 1, pairs, 1);
+                    }
+                    else
+                    {
+                        if( k == 0 )
+                            res.convertTo(cdst, cdepth, 1, delta);
+                        else
+                        {
+                            if( maxDepth != cdepth )
+                            {
+                                Mat cplane;
+                                res.convertTo(cplane, cdepth);
+                                res = cplane;
+                            }
+                            add(res, cdst, cdst);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    Mat img0;
+    Point roiofs;
+    const Mat* dftTempl;
+    const Size* templSize;
+    Mat* corr;
+    int ntempl;
+    Size gridsize, blocksize, dftsize, maxTemplSize;
+    int tileCountX;
+    int maxDepth;
+    Point anchor;
+    double delta;
+    int borderType;
+};
+
+static void crossCorrBlocks( const Mat& img, const Mat* dftTempl, const Size* templSize, Mat* corr,
+                             int ntempl, Size gridsize, Size blocksize, Size dftsize, int maxDepth,
+                             Point anchor, double delta, int borderType )
+{
     Size wholeSize = img.size();
     Point roiofs(0,0);
     Mat img0 = img;
-    
+
     if( !(borderType & BORDER_ISOLATED) )
     {
         img.locateROI(wholeSize, roiofs);
@@ -151,80 +264,247 @@ void crossCorr( const Mat& img, const Mat& _templ, Mat& corr,
                        roiofs.x, wholeSize.width-img.cols-roiofs.x);
     }
     borderType |= BORDER_ISOLATED;
-    
-    // calculate correlation by blocks
-    for( i = 0; i < tileCount; i++ )
+
+    int tileCountX = (gridsize.width + blocksize.width - 1)/blocksize.width;
+    int tileCountY = (gridsize.height + blocksize.height - 1)/blocksize.height;
+    int tileCount = tileCountX * tileCountY;
+
+    CrossCorrInvoker invoker(img0, roiofs, dftTempl, templSize, corr, ntempl, gridsize,
+                             blocksize, dftsize, maxDepth, anchor, delta, borderType);
+    if( tileCount > 1 )
+        parallel_for_(Range(0, tileCount), invoker, tileCount);
+    else
+        invoker(Range(0, tileCount));
+}
+
+void crossCorr( const Mat& img, const Mat& _templ, Mat& corr,
+                Size corrsize, int ctype,
+                Point anchor, double delta, int borderType )
+{
+    Mat templ = _templ;
+    int depth = img.depth();
+    int tdepth = templ.depth();
+    int cdepth = CV_MAT_DEPTH(ctype), ccn = CV_MAT_CN(ctype);
+
+    CV_Assert( img.dims <= 2 && templ.dims <= 2 && corr.dims <= 2 );
+
+    if( depth != tdepth && tdepth != std::max(CV_32F, depth) )
     {
-        int x = (i%tileCountX)*blocksize.width;
-        int y = (i/tileCountX)*blocksize.height;
-        
-        Size bsz(std::min(blocksize.width, corr.cols - x),
-                 std::min(blocksize.height, corr.rows - y));
-        Size dsz(bsz.width + templ.cols - 1, bsz.height + templ.rows - 1);
-        int x0 = x - anchor.x + roiofs.x, y0 = y - anchor.y + roiofs.y;
-        int x1 = std::max(0, x0), y1 = std::max(0, y0);
-        int x2 = std::min(img0.cols, x0 + dsz.width);
-        int y2 = std::min(img0.rows, y0 + dsz.height);
-        Mat src0(img0, Range(y1, y2), Range(x1, x2));
-        Mat dst(dftImg, Rect(0, 0, dsz.width, dsz.height));
-        Mat dst1(dftImg, Rect(x1-x0, y1-y0, x2-x1, y2-y1));
-        Mat cdst(corr, Rect(x, y, bsz.width, bsz.height));
-        
-        for( k = 0; k < cn; k++ )
+        _templ.convertTo(templ, std::max(CV_32F, depth));
+        tdepth = templ.depth();
+    }
+
+    CV_Assert( depth == tdepth || tdepth == CV_32F);
+    CV_Assert( corrsize.height <= img.rows + templ.rows - 1 &&
+               corrsize.width <= img.cols + templ.cols - 1 );
+
+    CV_Assert( ccn == 1 || delta == 0 );
+
+    corr.create(corrsize, ctype);
+
+    int maxDepth = depth > CV_8S ? CV_64F : std::max(std::max(CV_32F, tdepth), cdepth);
+    Size dftsize, blocksize = crossCorrBlockSize(templ.size(), corr.size(), dftsize);
+
+    Mat dftTempl;
+    templateSpectrum(templ, dftsize, maxDepth, dftTempl);
+
+    Size templSize = templ.size();
+    crossCorrBlocks(img, &dftTempl, &templSize, &corr, 1, corr.size(), blocksize, dftsize,
+                    maxDepth, anchor, delta, borderType);
+}
+
+// the statistics of a template used by the normalized methods and CV_TM_CCOEFF
+struct TemplateStats
+{
+    TemplateStats() : templNorm(0), templSum2(0), flat(false) {}
+
+    Scalar templMean;
+    double templNorm, templSum2;
+    // the template is constant, so CV_TM_CCOEFF_NORMED is 1 everywhere
+    bool flat;
+};
+
+static TemplateStats computeTemplateStats( const Mat& templ, int method )
+{
+    TemplateStats st;
+    int numType = method == CV_TM_CCORR || method == CV_TM_CCORR_NORMED ? 0 :
+                  method == CV_TM_CCOEFF || method == CV_TM_CCOEFF_NORMED ? 1 : 2;
+    double invArea = 1./((double)templ.rows * templ.cols);
+
+    if( method == CV_TM_CCORR )
+        return st;
+
+    if( method == CV_TM_CCOEFF )
+    {
+        st.templMean = mean(templ);
+        return st;
+    }
+
+    Scalar templSdv;
+    meanStdDev( templ, st.templMean, templSdv );
+
+    st.templNorm = CV_SQR(templSdv[0]) + CV_SQR(templSdv[1]) +
+                   CV_SQR(templSdv[2]) + CV_SQR(templSdv[3]);
+
+    if( st.templNorm < DBL_EPSILON && method == CV_TM_CCOEFF_NORMED )
+    {
+        st.flat = true;
+        return st;
+    }
+
+    st.templSum2 = st.templNorm +
+                   CV_SQR(st.templMean[0]) + CV_SQR(st.templMean[1]) +
+                   CV_SQR(st.templMean[2]) + CV_SQR(st.templMean[3]);
+
+    if( numType != 1 )
+    {
+        st.templMean = Scalar::all(0);
+        st.templNorm = st.templSum2;
+    }
+
+    st.templSum2 /= invArea;
+    st.templNorm = sqrt(st.templNorm);
+    st.templNorm /= sqrt(invArea); // care of accuracy here
+    return st;
+}
+
+// converts the correlation to the requested measure using the integrals of the image
+class MatchTemplateNormInvoker : public ParallelLoopBody
+{
+public:
+    MatchTemplateNormInvoker( const Mat& _sum, const Mat& _sqsum, Size _templSize, int _cn,
+                              const TemplateStats& _st, int _method, Mat& _result ) :
+        sum(_sum), sqsum(_sqsum), templSize(_templSize), cn(_cn), st(_st), method(_method),
+        result(_result)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int numType = method == CV_TM_CCORR || method == CV_TM_CCORR_NORMED ? 0 :
+                      method == CV_TM_CCOEFF || method == CV_TM_CCOEFF_NORMED ? 1 : 2;
+        bool isNormed = method == CV_TM_CCORR_NORMED ||
+                        method == CV_TM_SQDIFF_NORMED ||
+                        method == CV_TM_CCOEFF_NORMED;
+        double invArea = 1./((double)templSize.height * templSize.width);
+        const Scalar& templMean = st.templMean;
+        double templNorm = st.templNorm, templSum2 = st.templSum2;
+
+        const double *p0 = 0, *p1 = 0, *p2 = 0, *p3 = 0;
+        const double *q0 = 0, *q1 = 0, *q2 = 0, *q3 = 0;
+
+        if( sum.data )
         {
-            Mat src = src0;
-            dftImg = Scalar::all(0);
-            
-            if( cn > 1 )
-            {
-                src = depth == maxDepth ? dst1 : Mat(y2-y1, x2-x1, depth, &buf[0]);
-                int pairs[] = {k, 0};
-                mixChannels(&src0, 1, &src, 1, pairs, 1);
-            }
+            p0 = (const double*)sum.data;
+            p1 = p0 + templSize.width*cn;
+            p2 = (const double*)(sum.data + templSize.height*sum.step);
+            p3 = p2 + templSize.width*cn;
+        }
 
-            if( dst1.data != src.data )
-                src.convertTo(dst1, dst1.depth());
+        if( sqsum.data )
+        {
+            q0 = (const double*)sqsum.data;
+            q1 = q0 + templSize.width*cn;
+            q2 = (const double*)(sqsum.data + templSize.height*sqsum.step);
+            q3 = q2 + templSize.width*cn;
+        }
 
-            if( x2 - x1 < dsz.width || y2 - y1 < dsz.height )
-                copyMakeBorder(dst1, dst, y1-y0, dst.rows-dst1.rows-(y1-y0),
-                               x1-x0, dst.cols-dst1.cols-(x1-x0), borderType);
+        int sumstep = sum.data ? (int)(sum.step / sizeof(double)) : 0;
+        int sqstep = sqsum.data ? (int)(sqsum.step / sizeof(double)) : 0;
 
-            dft( dftImg, dftImg, 0, dsz.height );
-            Mat dftTempl1(dftTempl, Rect(0, tcn > 1 ? k*dftsize.height : 0,
-                                         dftsize.width, dftsize.height));
-            mulSpectrums(dftImg, dftTempl1, dftImg, 0, true);
-            dft( dftImg, dftImg, DFT_INVERSE + DFT_SCALE, bsz.height );
+        int i, j, k;
 
-            src = dftImg(Rect(0, 0, bsz.width, bsz.height));
+        for( i = range.start; i < range.end; i++ )
+        {
+            float* rrow = (float*)(result.data + i*result.step);
+            int idx = i * sumstep;
+            int idx2 = i * sqstep;
 
-            if( ccn > 1 )
+            for( j = 0; j < result.cols; j++, idx += cn, idx2 += cn )
             {
-                if( cdepth != maxDepth )
+                double num = rrow[j], t;
+                double wndMean2 = 0, wndSum2 = 0;
+
+                if( numType == 1 )
                 {
-                    Mat plane(bsz, cdepth, &buf[0]);
-                    src.convertTo(plane, cdepth, 1, delta);
-                    src = plane;
+                    for( k = 0; k < cn; k++ )
+                    {
+                        t = p0[idx+k] - p1[idx+k] - p2[idx+k] + p3[idx+k];
+                        wndMean2 += CV_SQR(t);
+                        num -= t*templMean[k];
+                    }
+
+                    wndMean2 *= invArea;
                 }
-                int pairs[] = {0, k};
-                mixChannels(&src, 1, &cdst, 1, pairs, 1); 
-            }
-            else
-            {
-                if( k == 0 )
-                    src.convertTo(cdst, cdepth, 1, delta);
-                else
+
+                if( isNormed || numType == 2 )
                 {
-                    if( maxDepth != cdepth )
+                    for( k = 0; k < cn; k++ )
                     {
-                        Mat plane(bsz, cdepth, &buf[0]);
-                        src.convertTo(plane, cdepth);
-                        src = plane;
+                        t = q0[idx2+k] - q1[idx2+k] - q2[idx2+k] + q3[idx2+k];
+                        wndSum2 += t;
                     }
-                    add(src, cdst, cdst);
+
+                    if( numType == 2 )
+                        num = wndSum2 - 2*num + templSum2;
                 }
+
+                if( isNormed )
+                {
+                    t = sqrt(MAX(wndSum2 - wndMean2,0))*templNorm;
+                    if( fabs(num) < t )
+                        num /= t;
+                    else if( fabs(num) < t*1.125 )
+                        num = num > 0 ? 1 : -1;
+                    else
+                        num = method != CV_TM_SQDIFF_NORMED ? 0 : 1;
+                }
+
+                rrow[j] = (float)num;
             }
         }
     }
+
+private:
+    Mat sum, sqsum;
+    Size templSize;
+    int cn;
+    TemplateStats st;
+    int method;
+    Mat result;
+};
+
+static void imageIntegrals( const Mat& img, int method, Mat& sum, Mat& sqsum )
+{
+    if( method == CV_TM_CCORR )
+        return;
+    if( method == CV_TM_CCOEFF )
+        integral(img, sum, CV_64F);
+    else if( method == CV_TM_CCOEFF_NORMED )
+        integral(img, sum, sqsum, CV_64F);
+    else
+        // the window sums of the image are not needed, only the sums of squares
+        integral(img, noArray(), sqsum, CV_64F);
+}
+
+static void normalizeCorr( const Mat& sum, const Mat& sqsum, Size templSize, int cn,
+                           const TemplateStats& st, int method, Mat& result )
+{
+    if( method == CV_TM_CCORR )
+        return;
+
+    if( st.flat )
+    {
+        result = Scalar::all(1);
+        return;
+    }
+
+    MatchTemplateNormInvoker invoker(sum, sqsum, templSize, cn, st, method, result);
+    int nstripes = (int)std::min(result.total()/TEMPLMATCH_PARALLEL_MIN, (size_t)result.rows);
+    if( nstripes > 1 )
+        parallel_for_(Range(0, result.rows), invoker, nstripes);
+    else
+        invoker(Range(0, result.rows));
 }
 
 }
@@ -234,137 +514,143 @@ void crossCorr( const Mat& img, const Mat& _templ, Mat& corr,
 void cv::matchTemplate( InputArray _img, InputArray _templ, OutputArray _result, int method )
 {
     CV_Assert( CV_TM_SQDIFF <= method && method <= CV_TM_CCOEFF_NORMED );
-    
-    int numType = method == CV_TM_CCORR || method == CV_TM_CCORR_NORMED ? 0 :
-                  method == CV_TM_CCOEFF || method == CV_TM_CCOEFF_NORMED ? 1 : 2;
-    bool isNormed = method == CV_TM_CCORR_NORMED ||
-                    method == CV_TM_SQDIFF_NORMED ||
-                    method == CV_TM_CCOEFF_NORMED;
 
     Mat img = _img.getMat(), templ = _templ.getMat();
     if( img.rows < templ.rows || img.cols < templ.cols )
         std::swap(img, templ);
-    
+
     CV_Assert( (img.depth() == CV_8U || img.depth() == CV_32F) &&
                img.type() == templ.type() );
 
     Size corrSize(img.cols - templ.cols + 1, img.rows - templ.rows + 1);
     _result.create(corrSize, CV_32F);
     Mat result = _result.getMat();
-    
-    int cn = img.channels();
+
     crossCorr( img, templ, result, result.size(), result.type(), Point(0,0), 0, 0);
 
-    if( method == CV_TM_CCORR )
-        return;
+    Mat sum, sqsum;
+    TemplateStats st = computeTemplateStats(templ, method);
+    if( !st.flat )
+        imageIntegrals(img, method, sum, sqsum);
+    normalizeCorr(sum, sqsum, templ.size(), img.channels(), st, method, result);
+}
 
-    double invArea = 1./((double)templ.rows * templ.cols);
+/*****************************************************************************************/
 
-    Mat sum, sqsum;
-    Scalar templMean, templSdv;
-    double *q0 = 0, *q1 = 0, *q2 = 0, *q3 = 0;
-    double templNorm = 0, templSum2 = 0;
-    
-    if( method == CV_TM_CCOEFF )
-    {
-        integral(img, sum, CV_64F);
-        templMean = mean(templ);
-    }
-    else
-    {
-        integral(img, sum, sqsum, CV_64F);
-        meanStdDev( templ, templMean, templSdv );
+cv::TemplateMatcher::TemplateMatcher() : method(CV_TM_CCOEFF_NORMED), imgType(-1)
+{
+}
 
-        templNorm = CV_SQR(templSdv[0]) + CV_SQR(templSdv[1]) +
-                    CV_SQR(templSdv[2]) + CV_SQR(templSdv[3]);
+cv::TemplateMatcher::TemplateMatcher( InputArrayOfArrays _templs, int _method ) : imgType(-1)
+{
+    setTemplates(_templs, _method);
+}
 
-        if( templNorm < DBL_EPSILON && method == CV_TM_CCOEFF_NORMED )
-        {
-            result = Scalar::all(1);
-            return;
-        }
-        
-        templSum2 = templNorm +
-                     CV_SQR(templMean[0]) + CV_SQR(templMean[1]) +
-                     CV_SQR(templMean[2]) + CV_SQR(templMean[3]);
+void cv::TemplateMatcher::setTemplates( InputArrayOfArrays _templs, int _method )
+{
+    CV_Assert( CV_TM_SQDIFF <= _method && _method <= CV_TM_CCOEFF_NORMED );
 
-        if( numType != 1 )
-        {
-            templMean = Scalar::all(0);
-            templNorm = templSum2;
-        }
-        
-        templSum2 /= invArea;
-        templNorm = sqrt(templNorm);
-        templNorm /= sqrt(invArea); // care of accuracy here
-
-        q0 = (double*)sqsum.data;
-        q1 = q0 + templ.cols*cn;
-        q2 = (double*)(sqsum.data + templ.rows*sqsum.step);
-        q3 = q2 + templ.cols*cn;
+    int i, n = (int)_templs.total();
+    CV_Assert( n > 0 );
+
+    templs.resize(n);
+    templMean.resize(n);
+    templNorm.resize(n);
+    templSum2.resize(n);
+    flat.resize(n);
+
+    for( i = 0; i < n; i++ )
+    {
+        Mat templ = _templs.getMat(i);
+        CV_Assert( templ.dims <= 2 && !templ.empty() &&
+                   (templ.depth() == CV_8U || templ.depth() == CV_32F) &&
+                   templ.type() == _templs.getMat(0).type() );
+        // a copy, so that the cached spectra stay valid whatever happens to the input
+        templ.copyTo(templs[i]);
+
+        TemplateStats st = computeTemplateStats(templs[i], _method);
+        templMean[i] = st.templMean;
+        templNorm[i] = st.templNorm;
+        templSum2[i] = st.templSum2;
+        flat[i] = st.flat;
     }
 
-    double* p0 = (double*)sum.data;
-    double* p1 = p0 + templ.cols*cn;
-    double* p2 = (double*)(sum.data + templ.rows*sum.step);
-    double* p3 = p2 + templ.cols*cn;
+    method = _method;
+    // the spectra are computed by the next match() call
+    dftTempls.clear();
+    imgSize = Size();
+    imgType = -1;
+}
+
+void cv::TemplateMatcher::match( InputArray _img, OutputArrayOfArrays _results )
+{
+    Mat img = _img.getMat();
+    int i, n = (int)templs.size();
 
-    int sumstep = sum.data ? (int)(sum.step / sizeof(double)) : 0;
-    int sqstep = sqsum.data ? (int)(sqsum.step / sizeof(double)) : 0;
+    CV_Assert( n > 0 && img.dims <= 2 && img.type() == templs[0].type() );
 
-    int i, j, k;
-    
-    for( i = 0; i < result.rows; i++ )
+    Size minTemplSize = templs[0].size(), maxTemplSize = templs[0].size();
+    for( i = 1; i < n; i++ )
     {
-        float* rrow = (float*)(result.data + i*result.step);
-        int idx = i * sumstep;
-        int idx2 = i * sqstep;
+        minTemplSize.width = std::min(minTemplSize.width, templs[i].cols);
+        minTemplSize.height = std::min(minTemplSize.height, templs[i].rows);
+        maxTemplSize.width = std::max(maxTemplSize.width, templs[i].cols);
+        maxTemplSize.height = std::max(maxTemplSize.height, templs[i].rows);
+    }
+    CV_Assert( maxTemplSize.width <= img.cols && maxTemplSize.height <= img.rows );
 
-        for( j = 0; j < result.cols; j++, idx += cn, idx2 += cn )
-        {
-            double num = rrow[j], t;
-            double wndMean2 = 0, wndSum2 = 0;
-            
-            if( numType == 1 )
-            {
-                for( k = 0; k < cn; k++ )
-                {
-                    t = p0[idx+k] - p1[idx+k] - p2[idx+k] + p3[idx+k];
-                    wndMean2 += CV_SQR(t);
-                    num -= t*templMean[k];
-                }
+    // the block grid covers the largest output, the blocks have room for the largest template
+    Size gridSize(img.cols - minTemplSize.width + 1, img.rows - minTemplSize.height + 1);
+    int maxDepth = img.depth() > CV_8S ? CV_64F : CV_32F;
 
-                wndMean2 *= invArea;
-            }
+    if( img.size() != imgSize || img.type() != imgType || (int)dftTempls.size() != n )
+    {
+        blockSize = crossCorrBlockSize(maxTemplSize, gridSize, dftSize);
+        dftTempls.resize(n);
+        for( i = 0; i < n; i++ )
+            templateSpectrum(templs[i], dftSize, maxDepth, dftTempls[i]);
+        imgSize = img.size();
+        imgType = img.type();
+    }
 
-            if( isNormed || numType == 2 )
-            {
-                for( k = 0; k < cn; k++ )
-                {
-                    t = q0[idx2+k] - q1[idx2+k] - q2[idx2+k] + q3[idx2+k];
-                    wndSum2 += t;
-                }
+    _results.create(n, 1, CV_32F);
+    vector<Mat> results(n);
+    vector<Size> templSizes(n);
+    for( i = 0; i < n; i++ )
+    {
+        templSizes[i] = templs[i].size();
+        _results.create(Size(img.cols - templs[i].cols + 1, img.rows - templs[i].rows + 1), CV_32F, i);
+        results[i] = _results.getMat(i);
+    }
 
-                if( numType == 2 )
-                    num = wndSum2 - 2*num + templSum2;
-            }
+    crossCorrBlocks(img, &dftTempls[0], &templSizes[0], &results[0], n, gridSize, blockSize,
+                    dftSize, maxDepth, Point(0,0), 0, 0);
 
-            if( isNormed )
-            {
-                t = sqrt(MAX(wndSum2 - wndMean2,0))*templNorm;
-                if( fabs(num) < t )
-                    num /= t;
-                else if( fabs(num) < t*1.125 )
-                    num = num > 0 ? 1 : -1;
-                else
-                    num = method != CV_TM_SQDIFF_NORMED ? 0 : 1;
-            }
+    // the integrals of the image are shared by all the templates
+    Mat sum, sqsum;
+    imageIntegrals(img, method, sum, sqsum);
 
-            rrow[j] = (float)num;
-        }
+    for( i = 0; i < n; i++ )
+    {
+        TemplateStats st;
+        st.templMean = templMean[i];
+        st.templNorm = templNorm[i];
+        st.templSum2 = templSum2[i];
+        st.flat = flat[i] != 0;
+        normalizeCorr(sum, sqsum, templSizes[i], img.channels(), st, method, results[i]);
     }
 }
 
+int cv::TemplateMatcher::size() const
+{
+    return (int)templs.size();
+}
+
+int cv::TemplateMatcher::getMethod() const
+{
+    return method;
+}
+
 
 CV_IMPL void
 cvMatchTemplate( const CvArr* _img, const CvArr* _templ, CvArr* _result, int method )
@@ -288,3 +288,64 @@ namespace cvtest
     }
 
 } // end of namespace cvtest
+
+TEST(Imgproc_BilateralGridFilter, accuracy)
+{
+    // two flat regions separated by a vertical step edge, plus noise
+    Mat src(480, 640, CV_8UC1), noise(src.size(), CV_8SC1);
+    src.colRange(0, 320).setTo(Scalar::all(60));
+    src.colRange(320, 640).setTo(Scalar::all(180));
+    randn(noise, Scalar::all(0), Scalar::all(6));
+    add(src, noise, src, noArray(), CV_8U);
+
+    Mat dst, ref;
+    bilateralGridFilter(src, dst, 30, 8);
+    bilateralFilter(src, ref, -1, 30, 8);
+    ASSERT_EQ(src.type(), dst.type());
+
+    // the noise is removed and the edge is preserved
+    Mat diff;
+    absdiff(dst.colRange(0, 317), Scalar::all(60), diff);
+    EXPECT_LE(norm(diff, NORM_INF), 4);
+    absdiff(dst.colRange(323, 640), Scalar::all(180), diff);
+    EXPECT_LE(norm(diff, NORM_INF), 4);
+    EXPECT_LE(norm(dst, ref, NORM_L1)/src.total(), 1.5);
+
+    Mat fsrc, fdst, fref;
+    src.convertTo(fsrc, CV_32F, 1./255);
+    bilateralGridFilter(fsrc, fdst, 30./255, 8);
+    dst.convertTo(fref, CV_32F, 1./255);
+    EXPECT_LE(norm(fdst, fref, NORM_INF), 1./255);
+
+    // a constant image is not changed
+    Mat flat(100, 150, CV_8UC3, Scalar(10, 20, 30));
+    bilateralGridFilter(flat, dst, 10, 3);
+    EXPECT_EQ(0, norm(flat, dst, NORM_INF));
+}
+
+struct BilateralGridBody
+{
+    BilateralGridBody(const Mat& _src, const Mat& _fsrc) : src(_src), fsrc(_fsrc) {}
+    void operator()(vector<Mat>& dst) const
+    {
+        dst.resize(4);
+        bilateralGridFilter(src, dst[0], 20, 4);
+        bilateralGridFilter(fsrc, dst[1], 0.05, 16);
+        bilateralGridFilter(fsrc.reshape(1), dst[2], 0.1, 32);
+        // in-place
+        src.copyTo(dst[3]);
+        bilateralGridFilter(dst[3], dst[3], 20, 4);
+        EXPECT_EQ(0, norm(dst[0], dst[3], NORM_INF));
+    }
+    Mat src, fsrc;
+};
+
+TEST(Imgproc_BilateralGridFilter, parallelDeterminism)
+{
+    Mat src(720, 1280, CV_8UC3), fsrc;
+    randu(src, Scalar::all(0), Scalar::all(256));
+    GaussianBlur(src, src, Size(9, 9), 0);
+    src.convertTo(fsrc, CV_32F, 1./255);
+
+    cvtest::checkParallelDeterminism(BilateralGridBody(src, fsrc));
+}
@@ -284,4 +284,60 @@ int CV_CannyTest::validate_test_results( int test_case_idx )
 
 TEST(Imgproc_Canny, accuracy) { CV_CannyTest test; test.safe_run(); }
 
+struct CannyBody
+{
+    CannyBody(const Mat& _src, double _low, double _high, int _aperture, bool _L2gradient)
+        : src(_src), low(_low), high(_high), aperture(_aperture), L2gradient(_L2gradient) {}
+    void operator()(vector<Mat>& dst) const
+    {
+        dst.resize(1);
+        Canny(src, dst[0], low, high, aperture, L2gradient);
+        EXPECT_LT(0, countNonZero(dst[0]));
+    }
+    Mat src;
+    double low, high;
+    int aperture;
+    bool L2gradient;
+};
+
+TEST(Imgproc_Canny, parallelDeterminism)
+{
+    for( int k = 0; k < 8; k++ )
+    {
+        int type = k % 2 == 0 ? CV_8UC1 : CV_8UC3;
+        int aperture = k % 4 < 2 ? 3 : 5;
+        bool L2gradient = k >= 4;
+        double low = aperture == 3 ? 50 : 300, high = aperture == 3 ? 150 : 900;
+
+        Mat src(1080, 1920, type);
+        randu(src, Scalar::all(0), Scalar::all(256));
+        GaussianBlur(src, src, Size(7, 7), 2);
+
+        // the plain C code running in one thread is the reference
+        SCOPED_TRACE(cv::format("test #%d", k));
+        cvtest::checkParallelDeterminism(CannyBody(src, low, high, aperture, L2gradient), true);
+    }
+}
+
+TEST(Imgproc_Canny, derivatives)
+{
+    for( int k = 0; k < 4; k++ )
+    {
+        int type = k % 2 == 0 ? CV_8UC1 : CV_8UC3;
+        bool L2gradient = k >= 2;
+
+        Mat src(481, 641, type), dx, dy, edges, edgesDxDy;
+        randu(src, Scalar::all(0), Scalar::all(256));
+        GaussianBlur(src, src, Size(5, 5), 1.5);
+
+        Sobel(src, dx, CV_16S, 1, 0, 3, 1, 0, BORDER_REPLICATE);
+        Sobel(src, dy, CV_16S, 0, 1, 3, 1, 0, BORDER_REPLICATE);
+
+        Canny(src, edges, 40, 120, 3, L2gradient);
+        Canny(dx, dy, edgesDxDy, 40, 120, L2gradient);
+
+        EXPECT_EQ(0, norm(edges, edgesDxDy, NORM_INF)) << "test #" << k;
+    }
+}
+
 /* End of file. */
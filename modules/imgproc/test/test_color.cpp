@@ -1711,3 +1711,100 @@ TEST(Imgproc_ColorBayerVNG, regression)
 
     EXPECT_EQ(0, countNonZero(diff.reshape(1) > 1));
 }
+
+struct CvtColorBody
+{
+    CvtColorBody(const Mat& _src, int _code) : src(_src), code(_code) {}
+    void operator()(vector<Mat>& dst) const
+    {
+        dst.resize(1);
+        cvtColor(src, dst[0], code);
+    }
+    Mat src;
+    int code;
+};
+
+TEST(Imgproc_CvtColor, parallelDeterminism)
+{
+    // {source type, code, whether the SIMD path must match the scalar one bit-exactly};
+    // the SSE2 Bayer gray and VNG kernels round intermediate averages differently
+    static const int codes[][3] =
+    {
+        {CV_8UC3, CV_BGR2GRAY, 1}, {CV_8UC4, CV_BGRA2GRAY, 1}, {CV_8UC3, CV_RGB2GRAY, 1},
+        {CV_8UC3, CV_BGR2YCrCb, 1}, {CV_8UC4, CV_RGB2YCrCb, 1}, {CV_8UC3, CV_BGR2YUV, 1},
+        {CV_8UC3, CV_BGR2HSV, 1}, {CV_8UC3, CV_RGB2HSV_FULL, 1}, {CV_8UC3, CV_BGR2Lab, 1},
+        {CV_32FC3, CV_BGR2GRAY, 1}, {CV_32FC3, CV_BGR2HSV, 1}, {CV_32FC3, CV_BGR2Lab, 1},
+        {CV_8UC1, CV_BayerBG2BGR, 1}, {CV_8UC1, CV_BayerGR2BGR, 1}, {CV_8UC1, CV_BayerGB2GRAY, 0},
+        {CV_8UC1, CV_BayerRG2GRAY, 0}, {CV_16UC1, CV_BayerGB2BGR, 1}, {CV_8UC1, CV_BayerBG2BGR_VNG, 0},
+        {CV_8UC1, CV_BayerGR2BGR_VNG, 0}
+    };
+
+    RNG& rng = theRNG();
+
+    for( int k = 0; k < (int)(sizeof(codes)/sizeof(codes[0])); k++ )
+    {
+        Mat big(rng.uniform(300, 600), rng.uniform(300, 600), codes[k][0]);
+        rng.fill(big, RNG::UNIFORM, Scalar::all(0), Scalar::all(CV_MAT_DEPTH(codes[k][0]) == CV_32F ? 1 : 256));
+        // odd-sized, non-continuous source
+        Mat src = big(Rect(3, 1, (big.cols - 8) | 1, (big.rows - 5) | 1));
+
+        // the scalar code is the single-threaded reference where it must match the SIMD one
+        SCOPED_TRACE(cv::format("test #%d", k));
+        cvtest::checkParallelDeterminism(CvtColorBody(src, codes[k][1]), codes[k][2] != 0);
+    }
+}
+
+TEST(Imgproc_CvtColorMulti, accuracy)
+{
+    static const int codes[] =
+    {
+        CV_BGR2GRAY, CV_BGR2HSV, CV_BGR2YCrCb, CV_RGB2Lab, CV_BGR2HLS_FULL,
+        CV_RGB2XYZ, CV_BGR2RGB, CV_BGR2BGRA, CV_LBGR2Luv, CV_BGR2YUV
+    };
+    static const int types[] = { CV_8UC3, CV_8UC4, CV_32FC3 };
+
+    RNG& rng = theRNG();
+
+    for( int t = 0; t < (int)(sizeof(types)/sizeof(types[0])); t++ )
+    {
+        Mat big(rng.uniform(200, 500), rng.uniform(200, 500), types[t]);
+        rng.fill(big, RNG::UNIFORM, Scalar::all(0), Scalar::all(CV_MAT_DEPTH(types[t]) == CV_32F ? 1 : 256));
+        Mat src = big(Rect(1, 2, big.cols - 3, big.rows - 5));
+
+        vector<int> cvtCodes(codes, codes + sizeof(codes)/sizeof(codes[0]));
+        // no fused implementation, goes through cvtColor
+        if( CV_MAT_DEPTH(types[t]) == CV_8U )
+            cvtCodes.push_back(CV_BGR2BGR565);
+
+        vector<Mat> dst;
+        cvtColorMulti(src, dst, cvtCodes);
+        ASSERT_EQ(cvtCodes.size(), dst.size());
+
+        for( size_t i = 0; i < cvtCodes.size(); i++ )
+        {
+            Mat ref;
+            cvtColor(src, ref, cvtCodes[i]);
+            ASSERT_EQ(ref.type(), dst[i].type()) << "type #" << t << ", code #" << i;
+            ASSERT_EQ(ref.size(), dst[i].size()) << "type #" << t << ", code #" << i;
+            EXPECT_EQ(0, norm(ref, dst[i], NORM_INF)) << "type #" << t << ", code #" << i;
+        }
+    }
+}
+
+TEST(Imgproc_CvtColorMulti, inplace)
+{
+    Mat src(123, 457, CV_8UC3), ref[2];
+    theRNG().fill(src, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+    int codes[] = { CV_BGR2RGB, CV_BGR2HSV };
+
+    cvtColor(src, ref[0], codes[0]);
+    cvtColor(src, ref[1], codes[1]);
+
+    // the first output overwrites the source buffer
+    vector<Mat> dst(2);
+    dst[0] = src;
+    cvtColorMulti(src, dst, vector<int>(codes, codes + 2));
+
+    EXPECT_EQ(0, norm(ref[0], dst[0], NORM_INF));
+    EXPECT_EQ(0, norm(ref[1], dst[1], NORM_INF));
+}
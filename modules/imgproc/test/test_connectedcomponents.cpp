@@ -0,0 +1,166 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "test_precomp.hpp"
+
+using namespace cv;
+using namespace std;
+
+// labels the components with the breadth-first search, in the order of their first pixels
+static int referenceLabeling(const Mat& img, Mat& labels, int connectivity)
+{
+    labels = Mat::zeros(img.size(), CV_32S);
+    int nlabels = 1;
+    vector<Point> queue;
+
+    for( int y = 0; y < img.rows; y++ )
+        for( int x = 0; x < img.cols; x++ )
+        {
+            if( !img.at<uchar>(y, x) || labels.at<int>(y, x) )
+                continue;
+            queue.assign(1, Point(x, y));
+            labels.at<int>(y, x) = nlabels;
+            for( size_t i = 0; i < queue.size(); i++ )
+            {
+                Point p = queue[i];
+                for( int dy = -1; dy <= 1; dy++ )
+                    for( int dx = -1; dx <= 1; dx++ )
+                    {
+                        Point q(p.x + dx, p.y + dy);
+                        if( (dx == 0 && dy == 0) || (connectivity == 4 && dx != 0 && dy != 0) ||
+                            !Rect(0, 0, img.cols, img.rows).contains(q) ||
+                            !img.at<uchar>(q) || labels.at<int>(q) )
+                            continue;
+                        labels.at<int>(q) = nlabels;
+                        queue.push_back(q);
+                    }
+            }
+            nlabels++;
+        }
+
+    return nlabels;
+}
+
+TEST(Imgproc_ConnectedComponents, accuracy)
+{
+    RNG& rng = theRNG();
+    int nthreads = getNumThreads();
+
+    for( int k = 0; k < 40; k++ )
+    {
+        int connectivity = k % 2 == 0 ? 8 : 4;
+        int ltype = k % 4 < 2 ? CV_32S : CV_16U;
+        Size sz = k < 4 ? Size(rng.uniform(300, 700), rng.uniform(300, 700)) : Size(rng.uniform(1, 100), rng.uniform(1, 100));
+
+        // random blobs of different density, so that the components cross the strip boundaries
+        Mat noise(sz, CV_32F), img;
+        randu(noise, Scalar::all(0), Scalar::all(1));
+        GaussianBlur(noise, noise, Size(5, 5), rng.uniform(0., 2.));
+        threshold(noise, img, rng.uniform(0.3, 0.7), 255, THRESH_BINARY);
+        img.convertTo(img, CV_8U);
+
+        Mat ref, labels, labels1, stats, centroids;
+        int nref = referenceLabeling(img, ref, connectivity);
+
+        setNumThreads(k % 3 == 0 ? 1 : 4);
+        int n = connectedComponentsWithStats(img, labels, stats, centroids, connectivity, ltype);
+        int n1 = connectedComponents(img, labels1, connectivity, ltype);
+        setNumThreads(nthreads);
+
+        ASSERT_EQ(nref, n) << "test #" << k;
+        ASSERT_EQ(n, n1) << "test #" << k;
+        ASSERT_EQ(ltype, labels.type());
+        labels.convertTo(labels, CV_32S);
+        labels1.convertTo(labels1, CV_32S);
+        EXPECT_EQ(0, norm(ref, labels, NORM_INF)) << "test #" << k;
+        EXPECT_EQ(0, norm(ref, labels1, NORM_INF)) << "test #" << k;
+
+        ASSERT_EQ(Size(CC_STAT_MAX, n), stats.size());
+        ASSERT_EQ(Size(2, n), centroids.size());
+
+        vector<Rect> bbox(n);
+        vector<int> area(n, 0);
+        vector<Point2d> center(n);
+        for( int y = 0; y < sz.height; y++ )
+            for( int x = 0; x < sz.width; x++ )
+            {
+                int l = ref.at<int>(y, x);
+                bbox[l] = area[l] == 0 ? Rect(x, y, 1, 1) : bbox[l] | Rect(x, y, 1, 1);
+                area[l]++;
+                center[l] += Point2d(x, y);
+            }
+
+        for( int l = 0; l < n; l++ )
+        {
+            if( area[l] == 0 )
+                continue;
+            EXPECT_EQ(area[l], stats.at<int>(l, CC_STAT_AREA)) << "test #" << k << ", label " << l;
+            EXPECT_EQ(bbox[l], Rect(stats.at<int>(l, CC_STAT_LEFT), stats.at<int>(l, CC_STAT_TOP),
+                                    stats.at<int>(l, CC_STAT_WIDTH), stats.at<int>(l, CC_STAT_HEIGHT)));
+            EXPECT_NEAR(center[l].x/area[l], centroids.at<double>(l, 0), 1e-6);
+            EXPECT_NEAR(center[l].y/area[l], centroids.at<double>(l, 1), 1e-6);
+        }
+        EXPECT_EQ(sz.area() - countNonZero(img), stats.at<int>(0, CC_STAT_AREA));
+    }
+}
+
+TEST(Imgproc_ConnectedComponents, singleComponentAcrossStrips)
+{
+    // nested rectangles joined by short bridges cross every strip boundary many times, but form one component
+    Mat img = Mat::zeros(1001, 1001, CV_8U);
+    for( int i = 0; i < 250; i += 4 )
+        rectangle(img, Point(i, i), Point(1000 - i, 1000 - i), Scalar(255));
+    for( int i = 0; i < 248; i += 4 )
+        line(img, Point(i + 1, 500), Point(i + 3, 500), Scalar(255));
+
+    Mat labels, stats, centroids;
+    int nthreads = getNumThreads();
+    setNumThreads(4);
+    int n = connectedComponentsWithStats(img, labels, stats, centroids, 4);
+    setNumThreads(nthreads);
+
+    ASSERT_EQ(2, n);
+    EXPECT_EQ(countNonZero(img), stats.at<int>(1, CC_STAT_AREA));
+    EXPECT_EQ(1001, stats.at<int>(1, CC_STAT_WIDTH));
+    EXPECT_EQ(1001, stats.at<int>(1, CC_STAT_HEIGHT));
+    EXPECT_NEAR(500., centroids.at<double>(1, 0), 1.);
+}
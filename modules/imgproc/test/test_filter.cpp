@@ -1879,3 +1879,394 @@ protected:
 
 TEST(Imgproc_Filtering, supportedFormats) { CV_FilterSupportedFormatsTest test; test.safe_run(); }
 
+
+struct FilteringBody
+{
+    FilteringBody(const Mat& _src, const Mat& _fsrc) : src(_src), fsrc(_fsrc)
+    {
+        kernel2d = (Mat_<float>(3, 3) << 0.1f, 0.2f, 0.1f, 0.f, 0.3f, -0.1f, 0.05f, 0.15f, 0.2f);
+        kx = getGaussianKernel(9, 2., CV_32F);
+        ky = getGaussianKernel(7, 1.5, CV_32F);
+    }
+    void operator()(vector<Mat>& dst) const
+    {
+        dst.resize(10);
+        GaussianBlur(src, dst[0], Size(5, 5), 0);
+        GaussianBlur(src, dst[1], Size(7, 7), 0, 0, BORDER_CONSTANT|BORDER_ISOLATED);
+        GaussianBlur(fsrc, dst[2], Size(5, 5), 0, 0, BORDER_REFLECT);
+        Sobel(src, dst[3], CV_16S, 1, 1, 3);
+        Sobel(fsrc, dst[4], CV_32F, 2, 0, 5, 1, 0, BORDER_REPLICATE|BORDER_ISOLATED);
+        blur(src, dst[5], Size(11, 11));
+        blur(fsrc, dst[6], Size(5, 5));
+        filter2D(src, dst[7], -1, kernel2d);
+        sepFilter2D(fsrc, dst[8], -1, kx, ky, Point(-1, -1), 0, BORDER_CONSTANT);
+        // in-place
+        src.copyTo(dst[9]);
+        GaussianBlur(dst[9], dst[9], Size(5, 5), 0);
+    }
+    Mat src, fsrc, kernel2d, kx, ky;
+};
+
+TEST(Imgproc_Filtering, parallelDeterminism)
+{
+    Mat big(760, 1300, CV_8UC3), fbig;
+    randu(big, Scalar::all(0), Scalar::all(256));
+    big.convertTo(fbig, CV_32F, 1./255);
+    Mat src = big(Rect(10, 20, 1280, 720)), fsrc = fbig(Rect(10, 20, 1280, 720));
+
+    cvtest::checkParallelDeterminism(FilteringBody(src, fsrc));
+}
+
+TEST(Imgproc_FilterEngine, parallelApply)
+{
+    Mat src(720, 1280, CV_8UC1), dst[2], dst2;
+    randu(src, Scalar::all(0), Scalar::all(256));
+    Ptr<FilterEngine> f[2];
+    int nthreads = getNumThreads();
+
+    for( int i = 0; i < 2; i++ )
+    {
+        setNumThreads(i == 0 ? 1 : 4);
+        f[i] = createGaussianFilter(CV_8UC1, Size(7, 7), 1.5);
+        dst[i].create(src.size(), src.type());
+        f[i]->apply(src, dst[i]);
+    }
+    // the copies of the engine made for the bands are reused by the next call
+    dst2.create(src.size(), src.type());
+    f[1]->apply(src, dst2);
+    setNumThreads(nthreads);
+
+    EXPECT_EQ(0, norm(dst[0], dst[1], NORM_INF));
+    EXPECT_EQ(0, norm(dst[0], dst2, NORM_INF));
+    EXPECT_EQ(f[0]->startY, f[1]->startY);
+    EXPECT_EQ(f[0]->endY, f[1]->endY);
+    EXPECT_EQ(f[0]->remainingInputRows(), f[1]->remainingInputRows());
+    EXPECT_EQ(0, f[1]->remainingOutputRows());
+}
+
+struct PyramidBody
+{
+    PyramidBody(const Mat& _src) : src(_src) {}
+    void operator()(vector<Mat>& dst) const
+    {
+        dst.resize(2);
+        pyrDown(src, dst[0]);
+        pyrUp(src, dst[1]);
+    }
+    Mat src;
+};
+
+TEST(Imgproc_Pyramid, parallelDeterminism)
+{
+    const int types[] = { CV_8UC1, CV_8UC3, CV_16SC1, CV_16SC4, CV_32FC1, CV_32FC3 };
+    const Size sizes[] = { Size(1281, 721), Size(640, 480), Size(37, 19) };
+
+    for( int t = 0; t < (int)(sizeof(types)/sizeof(types[0])); t++ )
+        for( int s = 0; s < (int)(sizeof(sizes)/sizeof(sizes[0])); s++ )
+        {
+            Mat src(sizes[s], types[t]);
+            if( CV_MAT_DEPTH(types[t]) == CV_16S )
+                randu(src, Scalar::all(-32768), Scalar::all(32768));
+            else
+                randu(src, Scalar::all(0), Scalar::all(256));
+
+            // the plain C code running in one thread is the reference
+            SCOPED_TRACE(cv::format("type %d, size %d", types[t], sizes[s].width));
+            cvtest::checkParallelDeterminism(PyramidBody(src), true);
+        }
+}
+
+TEST(Imgproc_Pyramid, gaussianPyramid)
+{
+    Mat src(483, 641, CV_8UC3);
+    randu(src, Scalar::all(0), Scalar::all(256));
+
+    vector<Mat> ref;
+    buildPyramid(src, ref, 4);
+
+    GaussianPyramid pyr(src, 4);
+    ASSERT_EQ(5, pyr.size());
+    EXPECT_EQ(src.data, pyr[0].data);
+    for( int i = 1; i < pyr.size(); i++ )
+    {
+        ASSERT_EQ(ref[i].size(), pyr[i].size());
+        EXPECT_EQ(0, norm(ref[i], pyr[i], NORM_INF));
+        // all the levels live in one buffer
+        EXPECT_EQ(pyr[1].datastart, pyr[i].datastart);
+        EXPECT_EQ(0u, (size_t)pyr[i].data % 16);
+    }
+
+    // the buffer is reused for the next frame of the same size
+    const uchar* data1 = pyr[1].data;
+    pyr.build(src, 4);
+    EXPECT_EQ(data1, pyr[1].data);
+
+    // ... but not if the previous levels are still in use
+    Mat level1 = pyr[1].clone(), prevLevel1 = pyr[1];
+    Mat src2 = Mat::zeros(src.size(), src.type());
+    pyr.build(src2, 4);
+    EXPECT_NE(prevLevel1.data, pyr[1].data);
+    EXPECT_EQ(0, norm(level1, prevLevel1, NORM_INF));
+    EXPECT_EQ(0, countNonZero(pyr[4].reshape(1)));
+}
+
+struct IntegralBody
+{
+    IntegralBody(const Mat& _src) : src(_src) {}
+    void operator()(vector<Mat>& dst) const
+    {
+        dst.resize(4);
+        integral(src, dst[0], dst[1]);
+        int depth32f = src.depth() == CV_64F ? CV_64F : CV_32F;
+        integral(src, dst[2], dst[3], depth32f, depth32f);
+    }
+    Mat src;
+};
+
+TEST(Imgproc_Integral, parallelDeterminism)
+{
+    const int types[] = { CV_8UC1, CV_8UC3, CV_32FC1, CV_64FC2 };
+    const Size sizes[] = { Size(1281, 721), Size(640, 480), Size(37, 19) };
+
+    for( int t = 0; t < (int)(sizeof(types)/sizeof(types[0])); t++ )
+        for( int s = 0; s < (int)(sizeof(sizes)/sizeof(sizes[0])); s++ )
+        {
+            Mat src(sizes[s], types[t]);
+            randu(src, Scalar::all(0), Scalar::all(256));
+
+            // the plain C code running in one thread is the reference
+            SCOPED_TRACE(cv::format("type %d, size %d", types[t], sizes[s].width));
+            cvtest::checkParallelDeterminism(IntegralBody(src), true);
+        }
+}
+
+TEST(Imgproc_Integral, selectedPlanes)
+{
+    Mat src(480, 640, CV_8UC1);
+    randu(src, Scalar::all(0), Scalar::all(256));
+
+    Mat sum, sqsum, tilted;
+    integral(src, sum, sqsum, tilted, CV_32S);
+
+    // only the squares
+    Mat sqsumOnly;
+    integral(src, noArray(), sqsumOnly);
+    ASSERT_EQ(CV_64FC1, sqsumOnly.type());
+    EXPECT_EQ(0, norm(sqsum, sqsumOnly, NORM_INF));
+
+    // the single-precision squares are exact as long as they fit the mantissa
+    Mat small = src(Rect(0, 0, 16, 16)), sum32s, sqsum32f, sqsumRef;
+    integral(small, sum32s, sqsum32f, CV_32S, CV_32F);
+    ASSERT_EQ(CV_32FC1, sqsum32f.type());
+    sqsum(Rect(0, 0, 17, 17)).convertTo(sqsumRef, CV_32F);
+    EXPECT_EQ(0, norm(sum32s, sum(Rect(0, 0, 17, 17)), NORM_INF));
+    EXPECT_EQ(0, norm(sqsum32f, sqsumRef, NORM_INF));
+
+    // only the tilted integral
+    Mat tiltedOnly;
+    integral(src, noArray(), noArray(), tiltedOnly, CV_32S);
+    EXPECT_EQ(0, norm(tilted, tiltedOnly, NORM_INF));
+}
+
+static void referenceMedianBlur( const Mat& src, Mat& dst, int ksize )
+{
+    int r = ksize/2, cn = src.channels();
+    Mat border, src64f;
+    src.convertTo(src64f, CV_64F);
+    copyMakeBorder(src64f, border, r, r, r, r, BORDER_REPLICATE);
+    dst.create(src.size(), src64f.type());
+    vector<double> buf(ksize*ksize);
+
+    for( int y = 0; y < src.rows; y++ )
+        for( int x = 0; x < src.cols; x++ )
+            for( int c = 0; c < cn; c++ )
+            {
+                for( int dy = 0; dy < ksize; dy++ )
+                    for( int dx = 0; dx < ksize; dx++ )
+                        buf[dy*ksize + dx] = border.ptr<double>(y + dy)[(x + dx)*cn + c];
+                std::nth_element(buf.begin(), buf.begin() + buf.size()/2, buf.end());
+                dst.ptr<double>(y)[x*cn + c] = buf[buf.size()/2];
+            }
+}
+
+TEST(Imgproc_MedianBlur, largeAperture)
+{
+    const int types[] = { CV_8UC1, CV_8UC3, CV_16UC1, CV_16SC3, CV_32FC1, CV_32FC4 };
+    const int ksizes[] = { 7, 13, 31 };
+    RNG& rng = theRNG();
+
+    for( int t = 0; t < (int)(sizeof(types)/sizeof(types[0])); t++ )
+        for( int k = 0; k < (int)(sizeof(ksizes)/sizeof(ksizes[0])); k++ )
+        {
+            int ksize = ksizes[k];
+            Mat src(rng.uniform(1, 90), rng.uniform(1, 170), types[t]), dst, dst64f, ref;
+            // a narrow value range produces lots of equal values
+            if( t % 2 == 0 )
+                randu(src, Scalar::all(0), Scalar::all(256));
+            else
+                randu(src, Scalar::all(-5), Scalar::all(5));
+
+            medianBlur(src, dst, ksize);
+            ASSERT_EQ(src.type(), dst.type());
+            referenceMedianBlur(src, ref, ksize);
+            dst.convertTo(dst64f, CV_64F);
+            EXPECT_EQ(0, norm(dst64f, ref, NORM_INF)) << "type " << types[t] << ", ksize " << ksize
+                << ", size " << src.cols << "x" << src.rows;
+        }
+}
+
+struct MedianBlurBody
+{
+    MedianBlurBody(const Mat& _src) : src(_src)
+    {
+        src.convertTo(src16u, CV_16U, 256);
+        src.convertTo(src32f, CV_32F, 1./255);
+    }
+    void operator()(vector<Mat>& dst) const
+    {
+        dst.resize(6);
+        medianBlur(src, dst[0], 7);
+        medianBlur(src, dst[1], 25);
+        medianBlur(src.colRange(3, 1203), dst[2], 51);
+        medianBlur(src16u, dst[3], 15);
+        medianBlur(src32f, dst[4], 9);
+        medianBlur(src16u, dst[5], 25);
+
+        // the 8u and the rank-based implementations must agree
+        Mat dst16u;
+        dst[1].convertTo(dst16u, CV_16U, 256);
+        EXPECT_EQ(0, norm(dst16u, dst[5], NORM_INF));
+    }
+    Mat src, src16u, src32f;
+};
+
+TEST(Imgproc_MedianBlur, parallelDeterminism)
+{
+    Mat src(720, 1280, CV_8UC3);
+    randu(src, Scalar::all(0), Scalar::all(256));
+
+    cvtest::checkParallelDeterminism(MedianBlurBody(src));
+}
+
+// brute-force erosion/dilation, computed in double precision on a padded copy
+static Mat referenceMorph( const Mat& src, int op, const Mat& kernel, Point anchor, int borderType )
+{
+    Mat src64f, padded, dst64f(src.size(), CV_MAKETYPE(CV_64F, src.channels()));
+    src.convertTo(src64f, CV_64F);
+    double borderValue = op == MORPH_ERODE ? DBL_MAX : -DBL_MAX;
+    copyMakeBorder(src64f, padded, anchor.y, kernel.rows - anchor.y - 1,
+                   anchor.x, kernel.cols - anchor.x - 1, borderType, Scalar::all(borderValue));
+    int cn = src.channels();
+
+    for( int y = 0; y < src.rows; y++ )
+        for( int x = 0; x < src.cols*cn; x++ )
+        {
+            double v = op == MORPH_ERODE ? DBL_MAX : -DBL_MAX;
+            for( int i = 0; i < kernel.rows; i++ )
+                for( int j = 0; j < kernel.cols; j++ )
+                    if( kernel.at<uchar>(i, j) )
+                    {
+                        double p = padded.ptr<double>(y + i)[x + j*cn];
+                        v = op == MORPH_ERODE ? std::min(v, p) : std::max(v, p);
+                    }
+            dst64f.ptr<double>(y)[x] = v;
+        }
+
+    Mat dst;
+    dst64f.convertTo(dst, src.type());
+    return dst;
+}
+
+TEST(Imgproc_Morphology, largeKernels)
+{
+    const int types[] = { CV_8UC1, CV_8UC3, CV_16UC1, CV_16SC1, CV_32FC1, CV_32FC3, CV_64FC1 };
+    // below and above the van Herk/Gil-Werman thresholds, lines and a decomposed cross
+    const int shapes[][3] = { {MORPH_RECT, 21, 21}, {MORPH_RECT, 45, 9}, {MORPH_RECT, 63, 70},
+                              {MORPH_RECT, 1, 33}, {MORPH_RECT, 62, 1}, {MORPH_CROSS, 17, 25} };
+    const int borders[] = { BORDER_CONSTANT, BORDER_REPLICATE, BORDER_REFLECT_101 };
+    RNG& rng = theRNG();
+
+    for( int t = 0; t < (int)(sizeof(types)/sizeof(types[0])); t++ )
+        for( int s = 0; s < (int)(sizeof(shapes)/sizeof(shapes[0])); s++ )
+        {
+            Mat src(rng.uniform(40, 90), rng.uniform(40, 90), types[t]);
+            rng.fill(src, RNG::UNIFORM, Scalar::all(-1000), Scalar::all(1000));
+            Size ksize(shapes[s][1], shapes[s][2]);
+            Mat kernel = getStructuringElement(shapes[s][0], ksize);
+            Point anchor = shapes[s][0] == MORPH_RECT ?
+                Point(rng.uniform(0, ksize.width), rng.uniform(0, ksize.height)) :
+                Point(ksize.width/2, ksize.height/2);
+            int op = (s + t) % 2 == 0 ? MORPH_ERODE : MORPH_DILATE;
+            int borderType = borders[(s + t) % 3];
+
+            Mat dst;
+            morphologyEx(src, dst, op, kernel, anchor, 1, borderType);
+            Mat ref = referenceMorph(src, op, kernel, anchor, borderType);
+            EXPECT_EQ(0, norm(dst, ref, NORM_INF)) << "type #" << t << ", shape #" << s;
+        }
+}
+
+struct MorphologyExBody
+{
+    MorphologyExBody(const Mat& _src, const Mat& _ref, int _op, const Mat& _kernel, int _iterations, int _borderType)
+        : src(_src), ref(_ref), kernel(_kernel), op(_op), iterations(_iterations), borderType(_borderType) {}
+    void operator()(vector<Mat>& dst) const
+    {
+        dst.resize(1);
+        morphologyEx(src, dst[0], op, kernel, Point(-1, -1), iterations, borderType);
+        EXPECT_EQ(0, norm(dst[0], ref, NORM_INF));
+    }
+    Mat src, ref, kernel;
+    int op, iterations, borderType;
+};
+
+TEST(Imgproc_MorphologyEx, banded)
+{
+    const int types[] = { CV_8UC1, CV_16UC1, CV_32FC3 };
+    const int ops[] = { MORPH_OPEN, MORPH_CLOSE, MORPH_GRADIENT, MORPH_TOPHAT, MORPH_BLACKHAT };
+    RNG& rng = theRNG();
+
+    for( int t = 0; t < (int)(sizeof(types)/sizeof(types[0])); t++ )
+    {
+        Mat big(380, 1700, types[t]);
+        rng.fill(big, RNG::UNIFORM, Scalar::all(0), Scalar::all(200));
+        // the rows and columns around the ROI are used by the non-isolated borders
+        Mat src = big(Rect(5, 7, 1690, 365));
+
+        for( int k = 0; k < (int)(sizeof(ops)/sizeof(ops[0])); k++ )
+        {
+            int op = ops[k];
+            Mat kernel = k % 2 == 0 ? getStructuringElement(MORPH_ELLIPSE, Size(7, 11)) :
+                                      getStructuringElement(MORPH_RECT, Size(13, 9));
+            int iterations = k % 2 == 0 ? 1 : 2;
+            int borderType = k < 3 ? BORDER_CONSTANT : BORDER_REPLICATE;
+
+            // the composition of separate erode() and dilate() calls
+            Mat first, second, ref;
+            bool erodeFirst = op == MORPH_OPEN || op == MORPH_TOPHAT;
+            if( op == MORPH_GRADIENT )
+            {
+                dilate(src, first, kernel, Point(-1, -1), iterations, borderType);
+                erode(src, second, kernel, Point(-1, -1), iterations, borderType);
+                ref = first - second;
+            }
+            else
+            {
+                if( erodeFirst )
+                {
+                    erode(src, first, kernel, Point(-1, -1), iterations, borderType);
+                    dilate(first, second, kernel, Point(-1, -1), iterations, borderType);
+                }
+                else
+                {
+                    dilate(src, first, kernel, Point(-1, -1), iterations, borderType);
+                    erode(first, second, kernel, Point(-1, -1), iterations, borderType);
+                }
+                ref = op == MORPH_TOPHAT ? src - second : op == MORPH_BLACKHAT ? second - src : second;
+            }
+
+            SCOPED_TRACE(cv::format("type #%d, op #%d", t, k));
+            cvtest::checkParallelDeterminism(MorphologyExBody(src, ref, op, kernel, iterations, borderType));
+        }
+    }
+}
@@ -1834,4 +1834,223 @@ TEST(Imgproc_Hist_CalcBackProject, accuracy) { CV_CalcBackProjectTest test; test
 TEST(Imgproc_Hist_CalcBackProjectPatch, accuracy) { CV_CalcBackProjectPatchTest test; test.safe_run(); }
 TEST(Imgproc_Hist_BayesianProb, accuracy) { CV_BayesianProbTest test; test.safe_run(); }
 
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+template<typename T> static void referenceCLAHE(const Mat& src, Mat& dst, double clipLimit, Size tiles)
+{
+    const int histSize = src.depth() == CV_8U ? 256 : 65536;
+    Mat ext;
+    copyMakeBorder(src, ext, 0, (tiles.height - src.rows % tiles.height) % tiles.height,
+                   0, (tiles.width - src.cols % tiles.width) % tiles.width, BORDER_REFLECT_101);
+    Size tileSize(ext.cols / tiles.width, ext.rows / tiles.height);
+    int area = tileSize.area();
+    int clip = clipLimit > 0 ? std::max((int)(clipLimit * area / histSize), 1) : 0;
+
+    Mat lut(tiles.area(), histSize, CV_64F);
+    vector<int> hist(histSize);
+    for( int k = 0; k < tiles.area(); k++ )
+    {
+        Mat tile = ext(Rect((k % tiles.width)*tileSize.width, (k / tiles.width)*tileSize.height,
+                            tileSize.width, tileSize.height));
+        std::fill(hist.begin(), hist.end(), 0);
+        for( int y = 0; y < tile.rows; y++ )
+            for( int x = 0; x < tile.cols; x++ )
+                hist[tile.at<T>(y, x)]++;
+        if( clip > 0 )
+        {
+            int excess = 0;
+            for( int i = 0; i < histSize; i++ )
+                if( hist[i] > clip )
+                    excess += hist[i] - clip, hist[i] = clip;
+            int batch = excess / histSize, residual = excess - batch*histSize;
+            for( int i = 0; i < histSize; i++ )
+                hist[i] += batch;
+            for( int i = 0, step = std::max(histSize / std::max(residual, 1), 1); i < histSize && residual > 0; i += step, residual-- )
+                hist[i]++;
+        }
+        for( int i = 0, sum = 0; i < histSize; i++ )
+        {
+            sum += hist[i];
+            lut.at<double>(k, i) = saturate_cast<T>(sum * (histSize - 1.) / area);
+        }
+    }
+
+    dst.create(src.size(), src.type());
+    for( int y = 0; y < src.rows; y++ )
+        for( int x = 0; x < src.cols; x++ )
+        {
+            double fy = (double)y / tileSize.height - 0.5, fx = (double)x / tileSize.width - 0.5;
+            int y1 = cvFloor(fy), x1 = cvFloor(fx);
+            double ay = fy - y1, ax = fx - x1;
+            int y2 = std::min(y1 + 1, tiles.height - 1), x2 = std::min(x1 + 1, tiles.width - 1);
+            y1 = std::max(y1, 0); x1 = std::max(x1, 0);
+            int v = src.at<T>(y, x);
+            double res = (lut.at<double>(y1*tiles.width + x1, v)*(1 - ax) + lut.at<double>(y1*tiles.width + x2, v)*ax)*(1 - ay) +
+                         (lut.at<double>(y2*tiles.width + x1, v)*(1 - ax) + lut.at<double>(y2*tiles.width + x2, v)*ax)*ay;
+            dst.at<T>(y, x) = saturate_cast<T>(res);
+        }
+}
+
+TEST(Imgproc_CLAHE, accuracy)
+{
+    RNG& rng = theRNG();
+    for( int k = 0; k < 20; k++ )
+    {
+        int depth = k % 2 == 0 ? CV_8U : CV_16U;
+        Size sz(rng.uniform(1, 300), rng.uniform(1, 300));
+        Size tiles(rng.uniform(1, 10), rng.uniform(1, 10));
+        double clipLimit = k % 4 < 2 ? rng.uniform(0.5, 50.) : 0.;
+        Mat src(sz, CV_MAKETYPE(depth, 1)), dst, ref;
+
+        // a smooth gradient plus noise, so that the tiles have different histograms
+        Mat noise(sz, CV_32F);
+        randu(noise, Scalar::all(0), Scalar::all(depth == CV_8U ? 64 : 16384));
+        for( int y = 0; y < sz.height; y++ )
+            for( int x = 0; x < sz.width; x++ )
+            {
+                float v = noise.at<float>(y, x) + (x + y)*(depth == CV_8U ? 0.3f : 80.f);
+                if( depth == CV_8U )
+                    src.at<uchar>(y, x) = saturate_cast<uchar>(v);
+                else
+                    src.at<ushort>(y, x) = saturate_cast<ushort>(v);
+            }
+
+        Ptr<CLAHE> clahe = createCLAHE(clipLimit, tiles);
+        clahe->apply(src, dst);
+
+        if( depth == CV_8U )
+            referenceCLAHE<uchar>(src, ref, clipLimit, tiles);
+        else
+            referenceCLAHE<ushort>(src, ref, clipLimit, tiles);
+
+        EXPECT_LE(norm(dst, ref, NORM_INF), 1.) << "test #" << k << ", size " << sz.width << "x" << sz.height
+                                                << ", tiles " << tiles.width << "x" << tiles.height;
+    }
+}
+
+struct CLAHEBody
+{
+    CLAHEBody(const Ptr<CLAHE>& _clahe, const Mat& _src) : clahe(_clahe), src(_src) {}
+    void operator()(vector<Mat>& dst) const
+    {
+        Ptr<CLAHE> c = clahe;
+        dst.resize(1);
+        c->apply(src, dst[0]);
+    }
+    Ptr<CLAHE> clahe;
+    Mat src;
+};
+
+TEST(Imgproc_CLAHE, parallelDeterminism)
+{
+    Ptr<CLAHE> clahe = createCLAHE(4.0, Size(8, 8));
+
+    for( int k = 0; k < 4; k++ )
+    {
+        Mat src(Size(1283, 719), k % 2 == 0 ? CV_8UC1 : CV_16UC1);
+        randu(src, Scalar::all(0), Scalar::all(k % 2 == 0 ? 256 : 65536));
+        GaussianBlur(src, src, Size(5, 5), 2);
+
+        // the plain C code running in one thread is the reference
+        SCOPED_TRACE(cv::format("test #%d", k));
+        cvtest::checkParallelDeterminism(CLAHEBody(clahe, src), true);
+    }
+
+    // the state kept between the frames must not affect the result
+    Mat src(Size(640, 480), CV_8UC1), dst1, dst2;
+    randu(src, Scalar::all(0), Scalar::all(256));
+    clahe->apply(src, dst1);
+    clahe->collectGarbage();
+    createCLAHE(4.0, Size(8, 8))->apply(src, dst2);
+    EXPECT_EQ(0, norm(dst1, dst2, NORM_INF));
+    EXPECT_EQ(4.0, clahe->getDouble("clipLimit"));
+}
+
+struct CalcHistBody
+{
+    CalcHistBody(const Mat& _img, const Mat& _mask, int _dims) : img(_img), mask(_mask), dims(_dims) {}
+    void operator()(vector<Mat>& dst) const
+    {
+        int channels[] = { 2, 0, 3, 1 };
+        int histSize[] = { 32, 8, 16, 4 };
+        float r0[] = { 0, 256 }, r1[] = { 16, 200 }, r2[] = { 0, 128 }, r3[] = { 10, 250 };
+        const float* ranges[] = { r0, r1, r2, r3 };
+
+        dst.resize(2);
+        calcHist(&img, 1, channels, mask, dst[0], dims, histSize, ranges);
+        calcBackProject(&img, 1, channels, dst[0], dst[1], ranges, 0.01);
+    }
+    Mat img, mask;
+    int dims;
+};
+
+TEST(Imgproc_Hist_Calc, parallelDeterminism)
+{
+    const int depths[] = { CV_8U, CV_16U, CV_32F };
+
+    for( int d = 0; d < (int)(sizeof(depths)/sizeof(depths[0])); d++ )
+        for( int dims = 1; dims <= 4; dims++ )
+            for( int k = 0; k < 4; k++ )
+            {
+                // continuous and non-continuous images, with and without the mask
+                bool useRoi = k % 2 != 0, useMask = k >= 2;
+                Mat big(730, 1290, CV_MAKETYPE(depths[d], 4)), mask;
+                randu(big, Scalar::all(0), Scalar::all(256));
+                Mat img = useRoi ? big(Rect(3, 5, 1280, 720)) : big;
+                if( useMask )
+                {
+                    mask.create(img.size(), CV_8U);
+                    randu(mask, Scalar::all(0), Scalar::all(2));
+                }
+
+                SCOPED_TRACE(cv::format("depth %d, dims %d, test #%d", depths[d], dims, k));
+                cvtest::checkParallelDeterminism(CalcHistBody(img, mask, dims));
+            }
+}
+
+TEST(Imgproc_Hist_Sliding, accuracy)
+{
+    Mat img(240, 320, CV_8UC3);
+    randu(img, Scalar::all(0), Scalar::all(256));
+
+    vector<int> channels(2), histSize(2);
+    channels[0] = 2; channels[1] = 0;
+    histSize[0] = 16; histSize[1] = 8;
+    vector<float> ranges(4);
+    ranges[0] = 0; ranges[1] = 256; ranges[2] = 32; ranges[3] = 224;
+
+    SlidingHistogram sh(channels, histSize, ranges);
+    Rect r(50, 40, 60, 45);
+    sh.setImage(img, r);
+
+    RNG& rng = theRNG();
+    for( int iter = 0; iter < 200; iter++ )
+    {
+        Mat hist, ref;
+        sh.getHist(hist);
+        Mat roi = img(sh.window());
+        calcHist(vector<Mat>(1, roi), channels, Mat(), ref, histSize, ranges);
+        ASSERT_EQ(0, norm(hist, ref, NORM_INF)) << "iteration " << iter;
+
+        // mostly small steps, sometimes with the size change, sometimes a jump
+        if( iter % 17 == 16 )
+            r = Rect(rng.uniform(0, 200), rng.uniform(0, 150), rng.uniform(1, 100), rng.uniform(1, 80));
+        else
+        {
+            r.x += rng.uniform(-3, 4);
+            r.y += rng.uniform(-3, 4);
+            if( iter % 5 == 4 )
+            {
+                r.width += rng.uniform(-2, 3);
+                r.height += rng.uniform(-2, 3);
+            }
+        }
+        r &= Rect(0, 0, img.cols, img.rows);
+        if( r.area() == 0 )
+            r = Rect(0, 0, 10, 10);
+        sh.moveWindow(r);
+        ASSERT_EQ(r, sh.window());
+    }
+}
+
 /* End Of File */
@@ -1504,6 +1504,56 @@ TEST(Imgproc_resize_area, regression)
     ASSERT_EQ(norm(one_channel_diff, cv::NORM_INF),0);
 }
 
+TEST(Imgproc_Remap, nearest_32FC2_map)
+{
+    // the map spans many remap blocks; each one must be read from its own part of the map
+    Mat src(300, 400, CV_8UC3), map(300, 400, CV_32FC2), dst, expected;
+    randu(src, Scalar::all(0), Scalar::all(256));
+    for( int y = 0; y < map.rows; y++ )
+        for( int x = 0; x < map.cols; x++ )
+            map.at<Point2f>(y, x) = Point2f((float)(map.cols - 1 - x), (float)(map.rows - 1 - y));
+
+    remap(src, dst, map, Mat(), INTER_NEAREST);
+    flip(src, expected, -1);
+    EXPECT_EQ(0, norm(dst, expected, NORM_INF));
+}
+
+
+struct WarpBody
+{
+    WarpBody(const Mat& _src) : src(_src), mapX(720, 1280, CV_32FC1), mapY(720, 1280, CV_32FC1)
+    {
+        randu(mapX, Scalar::all(-10), Scalar::all(src.cols + 10));
+        randu(mapY, Scalar::all(-10), Scalar::all(src.rows + 10));
+        convertMaps(mapX, mapY, map1, map2, CV_16SC2);
+        rotM = getRotationMatrix2D(Point2f(src.cols/2.f, src.rows/2.f), 30., 2.2);
+        rotM.copyTo(perspM);
+        perspM.push_back(Mat((Mat_<double>(1, 3) << 3e-4, 2e-4, 1)));
+    }
+    void operator()(vector<Mat>& dst) const
+    {
+        dst.resize(9);
+        resize(src, dst[0], Size(1280, 720), 0, 0, INTER_LINEAR);
+        resize(src, dst[1], Size(1280, 720), 0, 0, INTER_CUBIC);
+        resize(src, dst[2], Size(), 0.5, 0.5, INTER_AREA);
+        warpAffine(src, dst[3], rotM, Size(1280, 720), INTER_LINEAR);
+        warpAffine(src, dst[4], rotM, Size(1280, 720), INTER_NEAREST, BORDER_REPLICATE);
+        warpPerspective(src, dst[5], perspM, Size(1280, 720), INTER_LINEAR);
+        remap(src, dst[6], mapX, mapY, INTER_LINEAR);
+        remap(src, dst[7], mapX, mapY, INTER_NEAREST);
+        remap(src, dst[8], map1, map2, INTER_LINEAR);
+    }
+    Mat src, mapX, mapY, map1, map2, rotM, perspM;
+};
+
+TEST(Imgproc_Warp, parallelDeterminism)
+{
+    Mat src(480, 640, CV_8UC3);
+    randu(src, Scalar::all(0), Scalar::all(256));
+
+    cvtest::checkParallelDeterminism(WarpBody(src));
+}
+
 
 //////////////////////////////////////////////////////////////////////////
 
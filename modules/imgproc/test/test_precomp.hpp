@@ -13,4 +13,39 @@
 #include "opencv2/highgui/highgui_c.h"
 #include <iostream>
 
+namespace cvtest
+{
+
+// Runs body(dst) in one thread and then in four threads and expects the outputs to be
+// bit-exact. With plainReference the single-threaded run also disables the optimized code.
+template<class Body> void checkParallelDeterminism( const Body& body, bool plainReference=false )
+{
+    int nthreads = cv::getNumThreads();
+    bool useOptimized = cv::useOptimized();
+    std::vector<cv::Mat> dst[2];
+
+    for( int i = 0; i < 2; i++ )
+    {
+        cv::setNumThreads(i == 0 ? 1 : 4);
+        if( plainReference )
+            cv::setUseOptimized(i != 0);
+        body(dst[i]);
+    }
+    cv::setNumThreads(nthreads);
+    cv::setUseOptimized(useOptimized);
+
+    ASSERT_EQ(dst[0].size(), dst[1].size());
+    for( size_t k = 0; k < dst[0].size(); k++ )
+    {
+        ASSERT_EQ(dst[0][k].type(), dst[1][k].type()) << "output #" << k;
+        ASSERT_TRUE(dst[0][k].size == dst[1][k].size) << "output #" << k;
+        if( !dst[0][k].empty() )
+        {
+            EXPECT_EQ(0, cv::norm(dst[0][k], dst[1][k], cv::NORM_INF)) << "output #" << k;
+        }
+    }
+}
+
+}
+
 #endif
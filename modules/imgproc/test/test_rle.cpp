@@ -0,0 +1,420 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "test_precomp.hpp"
+
+using namespace cv;
+using namespace std;
+
+// blobs, rings and nested blobs of random sizes, with some isolated pixels
+static void makeRLETestMask(RNG& rng, Mat& mask, int maxSize = 160, int maxBlobs = 25)
+{
+    Size sz(rng.uniform(1, maxSize), rng.uniform(1, maxSize));
+    mask = Mat::zeros(sz, CV_8U);
+
+    int nblobs = rng.uniform(0, maxBlobs);
+    for( int i = 0; i < nblobs; i++ )
+    {
+        Point c(rng.uniform(-10, sz.width + 10), rng.uniform(-10, sz.height + 10));
+        int r = rng.uniform(1, 30), value = i > 0 && rng.uniform(0, 4) == 0 ? 0 : rng.uniform(1, 256);
+        circle(mask, c, r, Scalar::all(value), rng.uniform(0, 3) == 0 ? rng.uniform(1, 4) : -1);
+    }
+
+    int npoints = rng.uniform(0, 40);
+    for( int i = 0; i < npoints; i++ )
+        mask.at<uchar>(rng.uniform(0, sz.height), rng.uniform(0, sz.width)) = 255;
+}
+
+static void checkRLEInvariants(const RLEImage& rle)
+{
+    ASSERT_EQ(rle.rows + 1, (int)rle.rowOfs.size());
+    ASSERT_EQ(0, rle.rowOfs[0]);
+    ASSERT_EQ((int)rle.runs.size(), rle.rowOfs[rle.rows]);
+    for( int y = 0; y < rle.rows; y++ )
+        for( int i = rle.rowOfs[y]; i < rle.rowOfs[y+1]; i++ )
+        {
+            const Vec2i& r = rle.runs[i];
+            ASSERT_TRUE(0 <= r[0] && r[0] < r[1] && r[1] <= rle.cols) << "row " << y;
+            if( i > rle.rowOfs[y] )
+            {
+                ASSERT_LT(rle.runs[i-1][1], r[0]) << "row " << y;
+            }
+        }
+}
+
+static Mat binarize(const Mat& m)
+{
+    Mat b;
+    compare(m, 0, b, CMP_NE);
+    return b;
+}
+
+TEST(Imgproc_RLE, encodeDecode)
+{
+    RNG& rng = theRNG();
+    for( int k = 0; k < 100; k++ )
+    {
+        Mat mask, decoded;
+        makeRLETestMask(rng, mask);
+
+        RLEImage rle(mask);
+        checkRLEInvariants(rle);
+        rle.copyTo(decoded, 255);
+
+        EXPECT_EQ(mask.size(), rle.size()) << "test #" << k;
+        EXPECT_EQ(0, norm(binarize(mask), decoded, NORM_INF)) << "test #" << k;
+        EXPECT_EQ(countNonZero(mask), rle.area()) << "test #" << k;
+        EXPECT_EQ(countNonZero(mask) == 0, rle.empty()) << "test #" << k;
+
+        vector<Point> pts;
+        for( int y = 0; y < mask.rows; y++ )
+            for( int x = 0; x < mask.cols; x++ )
+                if( mask.at<uchar>(y, x) )
+                    pts.push_back(Point(x, y));
+        Rect ref = pts.empty() ? Rect() : boundingRect(pts);
+        EXPECT_EQ(ref, boundingRect(rle)) << "test #" << k;
+    }
+}
+
+TEST(Imgproc_RLE, threshold)
+{
+    RNG& rng = theRNG();
+    const int depths[] = { CV_8U, CV_16S, CV_32F };
+
+    for( int k = 0; k < 60; k++ )
+    {
+        int depth = depths[k % 3];
+        int type = rng.uniform(0, 2) ? THRESH_BINARY : THRESH_BINARY_INV;
+        Mat src(rng.uniform(1, 100), rng.uniform(1, 100), depth);
+        double lo = depth == CV_8U ? 0 : -300, hi = depth == CV_8U ? 256 : 300;
+        rng.fill(src, RNG::UNIFORM, lo, hi);
+        // long runs in some of the rows
+        for( int y = 0; y < src.rows; y += 3 )
+            src.row(y).colRange(0, src.cols/2) = Scalar::all(hi - 1);
+
+        double thresh = k % 10 == 0 ? lo - 1 : k % 10 == 1 ? hi : rng.uniform(lo, hi);
+        if( k % 10 == 2 )
+            thresh += 0.5;
+
+        Mat ref, decoded;
+        cv::threshold(src, ref, thresh, 1, type);
+        RLEImage rle;
+        cv::threshold(src, rle, thresh, type);
+        checkRLEInvariants(rle);
+        rle.copyTo(decoded);
+
+        EXPECT_EQ(0, norm(binarize(ref), decoded, NORM_INF)) << "test #" << k << ", thresh=" << thresh;
+    }
+}
+
+TEST(Imgproc_RLE, logic)
+{
+    RNG& rng = theRNG();
+    for( int k = 0; k < 100; k++ )
+    {
+        Mat mask1, mask2;
+        makeRLETestMask(rng, mask1);
+        makeRLETestMask(rng, mask2);
+        resize(mask2, mask2, mask1.size(), 0, 0, INTER_NEAREST);
+        mask1 = binarize(mask1);
+        mask2 = binarize(mask2);
+
+        RLEImage a(mask1), b(mask2), c;
+        Mat ref, decoded;
+
+        bitwise_and(a, b, c);
+        checkRLEInvariants(c);
+        c.copyTo(decoded);
+        bitwise_and(mask1, mask2, ref);
+        EXPECT_EQ(0, norm(ref, decoded, NORM_INF)) << "and, test #" << k;
+
+        bitwise_or(a, b, c);
+        checkRLEInvariants(c);
+        c.copyTo(decoded);
+        bitwise_or(mask1, mask2, ref);
+        EXPECT_EQ(0, norm(ref, decoded, NORM_INF)) << "or, test #" << k;
+
+        bitwise_xor(a, b, c);
+        checkRLEInvariants(c);
+        c.copyTo(decoded);
+        bitwise_xor(mask1, mask2, ref);
+        EXPECT_EQ(0, norm(ref, decoded, NORM_INF)) << "xor, test #" << k;
+
+        bitwise_not(a, c);
+        checkRLEInvariants(c);
+        c.copyTo(decoded);
+        bitwise_not(mask1, ref);
+        EXPECT_EQ(0, norm(ref, decoded, NORM_INF)) << "not, test #" << k;
+
+        // in-place
+        bitwise_and(a, b, a);
+        a.copyTo(decoded);
+        bitwise_and(mask1, mask2, ref);
+        EXPECT_EQ(0, norm(ref, decoded, NORM_INF)) << "in-place and, test #" << k;
+    }
+}
+
+TEST(Imgproc_RLE, morphology)
+{
+    RNG& rng = theRNG();
+    for( int k = 0; k < 100; k++ )
+    {
+        Mat mask;
+        makeRLETestMask(rng, mask);
+        mask = binarize(mask);
+
+        Size ksize(rng.uniform(1, 30), rng.uniform(1, 30));
+        Point anchor = k % 2 ? Point(-1, -1) : Point(rng.uniform(0, ksize.width), rng.uniform(0, ksize.height));
+        Mat kernel = getStructuringElement(MORPH_RECT, ksize, anchor), ref, decoded;
+
+        RLEImage src(mask), dst;
+        erode(src, dst, ksize, anchor);
+        checkRLEInvariants(dst);
+        dst.copyTo(decoded);
+        erode(mask, ref, kernel, anchor);
+        EXPECT_EQ(0, norm(ref, decoded, NORM_INF)) << "erode, test #" << k << ", ksize=" << ksize.width << "x" << ksize.height << ", anchor=" << anchor;
+
+        dilate(src, dst, ksize, anchor);
+        checkRLEInvariants(dst);
+        dst.copyTo(decoded);
+        dilate(mask, ref, kernel, anchor);
+        EXPECT_EQ(0, norm(ref, decoded, NORM_INF)) << "dilate, test #" << k << ", ksize=" << ksize.width << "x" << ksize.height << ", anchor=" << anchor;
+    }
+}
+
+TEST(Imgproc_RLE, moments)
+{
+    RNG& rng = theRNG();
+    for( int k = 0; k < 100; k++ )
+    {
+        Mat mask;
+        makeRLETestMask(rng, mask);
+
+        Moments ref = moments(mask, true), m = moments(RLEImage(mask));
+        const double* a = &ref.m00;
+        const double* b = &m.m00;
+        // the spatial and the central moments
+        for( int i = 0; i < 17; i++ )
+            EXPECT_NEAR(a[i], b[i], 1e-9*(fabs(a[i]) + 1)) << "moment #" << i << ", test #" << k;
+    }
+}
+
+static bool lessContour(const vector<Point>& a, const vector<Point>& b)
+{
+    if( a.size() != b.size() )
+        return a.size() < b.size();
+    for( size_t i = 0; i < a.size(); i++ )
+        if( a[i] != b[i] )
+            return a[i].x < b[i].x || (a[i].x == b[i].x && a[i].y < b[i].y);
+    return false;
+}
+
+struct ContourIdxLess
+{
+    ContourIdxLess(const vector<vector<Point> >& _c) : c(&_c) {}
+    bool operator()(int a, int b) const { return lessContour((*c)[a], (*c)[b]); }
+    const vector<vector<Point> >* c;
+};
+
+static vector<int> sortedContourOrder(const vector<vector<Point> >& contours)
+{
+    vector<int> idx(contours.size());
+    for( size_t i = 0; i < idx.size(); i++ )
+        idx[i] = (int)i;
+    std::sort(idx.begin(), idx.end(), ContourIdxLess(contours));
+    return idx;
+}
+
+// compares the contours as sets, together with the parents, the children and the sibling lists
+static void checkSameContours(const vector<vector<Point> >& refContours, const vector<Vec4i>& refHierarchy,
+                              const vector<vector<Point> >& contours, const vector<Vec4i>& hierarchy)
+{
+    ASSERT_EQ(refContours.size(), contours.size());
+    ASSERT_EQ(refHierarchy.size(), hierarchy.size());
+
+    int n = (int)contours.size();
+    vector<int> refOrder = sortedContourOrder(refContours), order = sortedContourOrder(contours);
+    vector<int> toRef(n, -1);
+    for( int i = 0; i < n; i++ )
+    {
+        ASSERT_TRUE(refContours[refOrder[i]] == contours[order[i]]) << "contour #" << order[i];
+        toRef[order[i]] = refOrder[i];
+    }
+
+    int ntop = 0, ntopRef = 0;
+    for( int i = 0; i < n; i++ )
+    {
+        const Vec4i& h = hierarchy[i];
+        const Vec4i& r = refHierarchy[toRef[i]];
+        EXPECT_EQ(r[3], h[3] < 0 ? -1 : toRef[h[3]]) << "contour #" << i;
+        EXPECT_EQ(r[2] < 0, h[2] < 0) << "contour #" << i;
+        if( h[0] >= 0 )
+        {
+            EXPECT_EQ(i, hierarchy[h[0]][1]);
+            EXPECT_EQ(h[3], hierarchy[h[0]][3]);
+        }
+        if( h[2] >= 0 )
+        {
+            EXPECT_EQ(i, hierarchy[h[2]][3]);
+        }
+        ntop += h[3] < 0;
+        ntopRef += r[3] < 0;
+    }
+    EXPECT_EQ(ntopRef, ntop);
+
+    int nchain = 0;
+    for( int i = 0; i < n; nchain++ )
+        i = hierarchy[i][0] >= 0 ? hierarchy[i][0] : n;
+    if( n > 0 )
+    {
+        EXPECT_EQ(ntop, nchain);
+    }
+}
+
+static void flatToVectors(const FlatContours& fc, vector<vector<Point> >& contours)
+{
+    ASSERT_EQ(fc.size() + 1, (int)fc.offsets().size());
+    ASSERT_EQ(fc.size(), (int)fc.hierarchy().size());
+    ASSERT_EQ((int)fc.points().size(), fc.offsets()[fc.size()]);
+    contours.resize(fc.size());
+    for( int i = 0; i < fc.size(); i++ )
+    {
+        ASSERT_GT(fc.contourSize(i), 0);
+        contours[i].assign(fc.contour(i), fc.contour(i) + fc.contourSize(i));
+    }
+}
+
+TEST(Imgproc_RLE, findContours)
+{
+    RNG& rng = theRNG();
+    const int modes[] = { RETR_EXTERNAL, RETR_LIST, RETR_CCOMP, RETR_TREE };
+    const int methods[] = { CHAIN_APPROX_NONE, CHAIN_APPROX_SIMPLE };
+
+    for( int k = 0; k < 160; k++ )
+    {
+        Mat mask, tmp;
+        makeRLETestMask(rng, mask);
+        int mode = modes[k % 4], method = methods[(k / 4) % 2];
+        Point offset(rng.uniform(-5, 5), rng.uniform(-5, 5));
+
+        vector<vector<Point> > refContours, contours;
+        vector<Vec4i> refHierarchy, hierarchy;
+        mask.copyTo(tmp);
+        findContours(tmp, refContours, refHierarchy, mode, method, offset);
+        findContours(RLEImage(mask), contours, hierarchy, mode, method, offset);
+
+        SCOPED_TRACE(cv::format("test #%d, mode=%d", k, mode));
+        checkSameContours(refContours, refHierarchy, contours, hierarchy);
+    }
+}
+
+TEST(Imgproc_RLE, flatContours)
+{
+    RNG& rng = theRNG();
+    const int modes[] = { RETR_EXTERNAL, RETR_LIST, RETR_CCOMP, RETR_TREE };
+    const int methods[] = { CHAIN_APPROX_NONE, CHAIN_APPROX_SIMPLE, CHAIN_APPROX_TC89_L1 };
+
+    // the same object is reused for all the images, so that the stale data of the previous
+    // images would show up; the large images are split into several chunks
+    FlatContours fc, rfc;
+    for( int k = 0; k < 48; k++ )
+    {
+        Mat mask, tmp;
+        makeRLETestMask(rng, mask, k % 2 == 0 ? 640 : 64, k % 2 == 0 ? 400 : 10);
+        int mode = modes[k % 4], method = methods[(k / 4) % 3];
+        Point offset(rng.uniform(-5, 5), rng.uniform(-5, 5));
+
+        vector<vector<Point> > refContours, contours, rcontours;
+        vector<Vec4i> refHierarchy;
+        mask.copyTo(tmp);
+        findContours(tmp, refContours, refHierarchy, mode, method, offset);
+        findContours(mask, fc, mode, method, offset);
+        findContours(RLEImage(mask), rfc, mode, method, offset);
+
+        SCOPED_TRACE(cv::format("test #%d, mode=%d, method=%d", k, mode, method));
+        flatToVectors(fc, contours);
+        checkSameContours(refContours, refHierarchy, contours, fc.hierarchy());
+
+        // the encoded image gives exactly the same result
+        flatToVectors(rfc, rcontours);
+        EXPECT_TRUE(contours == rcontours);
+        EXPECT_TRUE(fc.hierarchy() == rfc.hierarchy());
+    }
+
+    // no contours
+    findContours(Mat::zeros(100, 100, CV_8U), fc, RETR_LIST, CHAIN_APPROX_SIMPLE);
+    EXPECT_TRUE(fc.empty());
+    EXPECT_EQ(1u, fc.offsets().size());
+    findContours(Mat(2, 2, CV_8U, Scalar::all(255)), fc, RETR_LIST, CHAIN_APPROX_SIMPLE);
+    EXPECT_TRUE(fc.empty());
+}
+
+struct FlatContoursBody
+{
+    FlatContoursBody(const Mat& _mask) : mask(_mask) {}
+    void operator()(vector<Mat>& dst) const
+    {
+        FlatContours fc;
+        RLEImage rle;
+        findContours(mask, fc, RETR_TREE, CHAIN_APPROX_SIMPLE);
+        threshold(mask, rle, 0, THRESH_BINARY);
+        EXPECT_LT(0, fc.size());
+
+        dst.resize(5);
+        Mat(rle.runs).copyTo(dst[0]);
+        Mat(rle.rowOfs).copyTo(dst[1]);
+        Mat(fc.points()).copyTo(dst[2]);
+        Mat(fc.offsets()).copyTo(dst[3]);
+        Mat(fc.hierarchy()).copyTo(dst[4]);
+    }
+    Mat mask;
+};
+
+TEST(Imgproc_RLE, flatContoursParallelDeterminism)
+{
+    RNG rng(0x5678);
+    Mat mask;
+    while( mask.total() < 400000 )
+        makeRLETestMask(rng, mask, 1200, 1500);
+
+    cvtest::checkParallelDeterminism(FlatContoursBody(mask));
+}
@@ -334,3 +334,80 @@ void CV_TemplMatchTest::prepare_to_validation( int /*test_case_idx*/ )
 }
 
 TEST(Imgproc_MatchTemplate, accuracy) { CV_TemplMatchTest test; test.safe_run(); }
+
+struct MatchTemplateBody
+{
+    MatchTemplateBody(const Mat& _img, const Mat& _templ, int _method) : img(_img), templ(_templ), method(_method) {}
+    void operator()(vector<Mat>& dst) const
+    {
+        dst.resize(1);
+        matchTemplate(img, templ, dst[0], method);
+    }
+    Mat img, templ;
+    int method;
+};
+
+TEST(Imgproc_MatchTemplate, parallelDeterminism)
+{
+    const int types[] = { CV_8UC1, CV_8UC3, CV_32FC1 };
+
+    for( int t = 0; t < (int)(sizeof(types)/sizeof(types[0])); t++ )
+        for( int method = CV_TM_SQDIFF; method <= CV_TM_CCOEFF_NORMED; method++ )
+        {
+            Mat img(723, 1281, types[t]), templ;
+            randu(img, Scalar::all(0), Scalar::all(256));
+            img(Rect(100, 200, 47, 31)).copyTo(templ);
+
+            SCOPED_TRACE(cv::format("type %d, method %d", types[t], method));
+            cvtest::checkParallelDeterminism(MatchTemplateBody(img, templ, method));
+        }
+}
+
+TEST(Imgproc_MatchTemplate, templateMatcher)
+{
+    const int types[] = { CV_8UC1, CV_8UC3, CV_32FC1 };
+    const Size templSizes[] = { Size(16, 16), Size(47, 31), Size(9, 60), Size(33, 33) };
+    const int ntempl = (int)(sizeof(templSizes)/sizeof(templSizes[0]));
+    RNG& rng = theRNG();
+
+    for( int t = 0; t < (int)(sizeof(types)/sizeof(types[0])); t++ )
+        for( int method = CV_TM_SQDIFF; method <= CV_TM_CCOEFF_NORMED; method++ )
+        {
+            Mat img(480, 640, types[t]);
+            randu(img, Scalar::all(0), Scalar::all(256));
+            GaussianBlur(img, img, Size(5, 5), 0);
+
+            vector<Mat> templs(ntempl);
+            for( int k = 0; k < ntempl; k++ )
+            {
+                Point ofs(rng.uniform(0, img.cols - templSizes[k].width),
+                          rng.uniform(0, img.rows - templSizes[k].height));
+                img(Rect(ofs, templSizes[k])).copyTo(templs[k]);
+            }
+
+            TemplateMatcher matcher(templs, method);
+            ASSERT_EQ(ntempl, matcher.size());
+            ASSERT_EQ(method, matcher.getMethod());
+
+            // the second frame reuses the spectra computed for the first one, the third one has a new size
+            for( int frame = 0; frame < 3; frame++ )
+            {
+                Mat frameImg = frame < 2 ? img : img(Rect(13, 7, 500, 400));
+                vector<Mat> results;
+                matcher.match(frameImg, results);
+                ASSERT_EQ(ntempl, (int)results.size());
+
+                for( int k = 0; k < ntempl; k++ )
+                {
+                    Mat ref;
+                    matchTemplate(frameImg, templs[k], ref, method);
+                    ASSERT_EQ(ref.size(), results[k].size());
+                    ASSERT_EQ(CV_32FC1, results[k].type());
+                    // the blocks and the DFT sizes differ, so does the rounding
+                    double maxVal = std::max(norm(ref, NORM_INF), 1.);
+                    EXPECT_LE(norm(ref, results[k], NORM_INF), maxVal*1e-3)
+                        << "type " << types[t] << ", method " << method << ", template " << k << ", frame " << frame;
+                }
+            }
+        }
+}
@@ -0,0 +1,66 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+// Startup time of a random forest classifier: loading the 500-tree model saved
+// in XML and the same model converted to the binary file storage format.
+
+typedef std::tr1::tuple<int, bool> NumTrees_Binary_t;
+typedef perf::TestBaseWithParam<NumTrees_Binary_t> NumTrees_Binary;
+
+PERF_TEST_P(NumTrees_Binary, RTrees_load,
+            testing::Combine(
+                testing::Values(500),
+                testing::Bool()
+                )
+            )
+{
+    int ntrees = get<0>(GetParam());
+    bool binary = get<1>(GetParam());
+
+    const int nsamples = 1000, nvars = 16;
+    Mat samples(nsamples, nvars, CV_32F), responses(nsamples, 1, CV_32F);
+    RNG& rng = theRNG();
+    rng.fill(samples, RNG::UNIFORM, 0, 1);
+    for( int i = 0; i < nsamples; i++ )
+    {
+        const float* x = samples.ptr<float>(i);
+        responses.at<float>(i) = (float)((x[0] + x[1] > 1) + (x[2] > 0.5f)*2);
+    }
+    Mat varType(nvars + 1, 1, CV_8U, Scalar::all(CV_VAR_ORDERED));
+    varType.at<uchar>(nvars) = CV_VAR_CATEGORICAL;
+
+    CvRTrees forest;
+    forest.train(samples, CV_ROW_SAMPLE, responses, Mat(), Mat(), varType, Mat(),
+                 CvRTParams(10, 10, 0, false, 10, 0, false, 4, ntrees, 0.01f, CV_TERMCRIT_ITER));
+
+    string filename = cv::tempfile(".xml");
+    forest.save(filename.c_str());
+    if( binary )
+    {
+        string binname = cv::tempfile(".bin");
+        FileStorage::convert(filename, binname, FileStorage::FORMAT_BINARY);
+        remove(filename.c_str());
+        filename = binname;
+    }
+
+    declare.time(30);
+
+    TEST_CYCLE()
+    {
+        CvRTrees loaded;
+        loaded.load(filename.c_str());
+    }
+
+    CvRTrees loaded;
+    loaded.load(filename.c_str());
+    remove(filename.c_str());
+
+    ASSERT_EQ(ntrees, loaded.get_tree_count());
+    for( int i = 0; i < nsamples; i++ )
+        ASSERT_EQ(forest.predict(samples.row(i)), loaded.predict(samples.row(i)));
+}
@@ -52,3 +52,39 @@ PERF_TEST_P(ImageName_MinSize, CascadeClassifierLBPFrontalFace,
         stopTimer();
     }
 }
+
+// Startup time of the detector: loading the Haar cascade from the XML file and
+// from the same cascade converted to the binary file storage format.
+
+typedef std::tr1::tuple<std::string, bool> CascadeName_Binary_t;
+typedef perf::TestBaseWithParam<CascadeName_Binary_t> CascadeName_Binary;
+
+PERF_TEST_P(CascadeName_Binary, CascadeClassifierLoad,
+            testing::Combine(testing::Values( std::string("cv/cascadeandhog/cascades/haarcascade_frontalface_alt.xml"),
+                                              std::string("cv/cascadeandhog/cascades/lbpcascade_frontalface.xml")),
+                             testing::Bool()
+                             )
+            )
+{
+    string filename = getDataPath(get<0>(GetParam()));
+    bool binary = get<1>(GetParam());
+
+    if( binary )
+    {
+        string binname = cv::tempfile(".bin");
+        FileStorage::convert(filename, binname, FileStorage::FORMAT_BINARY);
+        filename = binname;
+    }
+
+    bool loaded = false;
+    TEST_CYCLE()
+    {
+        CascadeClassifier cc;
+        loaded = cc.load(filename);
+    }
+
+    if( binary )
+        remove(filename.c_str());
+    if( !loaded )
+        FAIL() << "Can't load cascade file";
+}
@@ -134,6 +134,7 @@ public:
 
 void groupRectangles(vector<Rect>& rectList, int groupThreshold, double eps, vector<int>* weights, vector<double>* levelWeights)
 {
+    CV_TRACE_FUNCTION();
     if( groupThreshold <= 0 || rectList.empty() )
     {
         if( weights )
@@ -1019,6 +1020,7 @@ bool CascadeClassifier::detectSingleScale( const Mat& image, int stripCount, Siz
                                            int stripSize, int yStep, double factor, vector<Rect>& candidates,
                                            vector<int>& levels, vector<double>& weights, bool outputRejectLevels )
 {
+    CV_TRACE_FUNCTION();
     if( !featureEvaluator->setImage( image, data.origWinSize ) )
         return false;
 
@@ -1083,6 +1085,7 @@ void CascadeClassifier::detectMultiScale( const Mat& image, vector<Rect>& object
                                           int flags, Size minObjectSize, Size maxObjectSize,
                                           bool outputRejectLevels )
 {
+    CV_TRACE_FUNCTION();
     const double GROUP_EPS = 0.2;
 
     CV_Assert( scaleFactor > 1 && image.depth() == CV_8U );
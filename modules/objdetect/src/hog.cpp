@@ -174,6 +174,7 @@ void HOGDescriptor::copyTo(HOGDescriptor& c) const
 void HOGDescriptor::computeGradient(const Mat& img, Mat& grad, Mat& qangle,
                                     Size paddingTL, Size paddingBR) const
 {
+    CV_TRACE_FUNCTION();
     CV_Assert( img.type() == CV_8U || img.type() == CV_8UC3 );
 
     Size gradsize(img.cols + paddingTL.width + paddingBR.width,
@@ -795,6 +796,7 @@ void HOGDescriptor::compute(const Mat& img, vector<float>& descriptors,
                             Size winStride, Size padding,
                             const vector<Point>& locations) const
 {
+    CV_TRACE_FUNCTION();
     if( winStride == Size() )
         winStride = cellSize;
     Size cacheStride(gcd(winStride.width, blockStride.width),
@@ -857,6 +859,7 @@ void HOGDescriptor::detect(const Mat& img,
     vector<Point>& hits, vector<double>& weights, double hitThreshold, 
     Size winStride, Size padding, const vector<Point>& locations) const
 {
+    CV_TRACE_FUNCTION();
     hits.clear();
     if( svmDetector.empty() )
         return;
@@ -1014,6 +1017,7 @@ void HOGDescriptor::detectMultiScale(
     double hitThreshold, Size winStride, Size padding,
     double scale0, double finalThreshold, bool useMeanshiftGrouping) const  
 {
+    CV_TRACE_FUNCTION();
     double scale = 1.;
     int levels = 0;
 
@@ -2439,6 +2443,7 @@ void HOGDescriptor::detectROI(const cv::Mat& img, const vector<cv::Point> &locat
                                        double hitThreshold, cv::Size winStride,
                                        cv::Size padding) const
 {
+    CV_TRACE_FUNCTION();
    foundLocations.clear();
 
    confidences.clear();
@@ -279,8 +279,7 @@ void MultiBandBlender::feed(const Mat &img, const Mat &mask, Point tl)
         createLaplacePyr(img_with_border, num_bands_, src_pyr_laplace);
 
     // Create the weight map Gaussian pyramid
-    Mat weight_map;
-    vector<Mat> weight_pyr_gauss(num_bands_ + 1);
+    Mat weight_map, weight_map_with_border;
 
     if(weight_type_ == CV_32F)
     {
@@ -292,10 +291,8 @@ void MultiBandBlender::feed(const Mat &img, const Mat &mask, Point tl)
         add(weight_map, 1, weight_map, mask != 0);
     }
 
-    copyMakeBorder(weight_map, weight_pyr_gauss[0], top, bottom, left, right, BORDER_CONSTANT);
-
-    for (int i = 0; i < num_bands_; ++i)
-        pyrDown(weight_pyr_gauss[i], weight_pyr_gauss[i + 1]);
+    copyMakeBorder(weight_map, weight_map_with_border, top, bottom, left, right, BORDER_CONSTANT);
+    GaussianPyramid weight_pyr_gauss(weight_map_with_border, num_bands_);
 
     int y_tl = tl_new.y - dst_roi_.y;
     int y_br = br_new.y - dst_roi_.y;
@@ -282,6 +282,7 @@ private:
     unsigned int nIters;
     unsigned int currentIter;
     unsigned int runsPerIteration;
+    int prevNumThreads;
 
     performance_metrics metrics;
     void validateMetrics();
@@ -310,6 +311,7 @@ private:
         _declareHelper& iterations(unsigned int n);
         _declareHelper& time(double timeLimitSecs);
         _declareHelper& tbb_threads(int n = -1);
+        _declareHelper& threads(int n);
         _declareHelper& runs(unsigned int runsNumber);
     private:
         TestBase* test;
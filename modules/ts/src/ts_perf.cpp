@@ -17,6 +17,7 @@ const char *command_line_keys =
     "{   |perf_force_samples  |100      |force set maximum number of samples for all tests}"
     "{   |perf_seed           |809564   |seed for random numbers generator}"
     "{   |perf_tbb_nthreads   |-1       |if TBB is enabled, the number of TBB threads}"
+    "{   |perf_threads        |-1       |the number of threads used by cv::parallel_for_}"
     "{   |perf_write_sanity   |false    |allow to create new records for sanity checks}"
     #ifdef ANDROID
     "{   |perf_time_limit     |6.0      |default time limit for a single test (in seconds)}"
@@ -36,6 +37,7 @@ static unsigned int param_force_samples;
 static uint64       param_seed;
 static double       param_time_limit;
 static int          param_tbb_nthreads;
+static int          param_threads;
 static bool         param_write_sanity;
 #ifdef ANDROID
 static int          param_affinity_mask;
@@ -534,6 +536,7 @@ void TestBase::Init(int argc, const char* const argv[])
     param_force_samples = args.get<unsigned int>("perf_force_samples");
     param_write_sanity = args.get<bool>("perf_write_sanity");
     param_tbb_nthreads  = args.get<int>("perf_tbb_nthreads");
+    param_threads = args.get<int>("perf_threads");
 #ifdef ANDROID
     param_affinity_mask = args.get<int>("perf_affinity_mask");
     log_power_checkpoints = args.get<bool>("perf_log_power_checkpoints");
@@ -910,6 +913,9 @@ void TestBase::SetUp()
     if (param_affinity_mask)
         setCurrentThreadAffinityMask(param_affinity_mask);
 #endif
+    prevNumThreads = -1;
+    if (param_threads > 0)
+        declare.threads(param_threads);
     lastTime = 0;
     totalTime = 0;
     runsPerIteration = 1;
@@ -937,6 +943,8 @@ void TestBase::TearDown()
 #ifdef HAVE_TBB
     p_tbb_initializer.release();
 #endif
+    if (prevNumThreads >= 0)
+        cv::setNumThreads(prevNumThreads);
 }
 
 std::string TestBase::getDataPath(const std::string& relativePath)
@@ -1034,6 +1042,14 @@ TestBase::_declareHelper& TestBase::_declareHelper::tbb_threads(int n)
     return *this;
 }
 
+TestBase::_declareHelper& TestBase::_declareHelper::threads(int n)
+{
+    if (test->prevNumThreads < 0)
+        test->prevNumThreads = cv::getNumThreads();
+    cv::setNumThreads(n);
+    return *this;
+}
+
 TestBase::_declareHelper& TestBase::_declareHelper::runs(unsigned int runsNumber)
 {
     test->runsPerIteration = runsNumber;
@@ -47,6 +47,7 @@ namespace
 {
 static void calcSharrDeriv(const cv::Mat& src, cv::Mat& dst)
 {
+    CV_TRACE_FUNCTION();
     using namespace cv;
     using cv::detail::deriv_type;
     int rows = src.rows, cols = src.cols, cn = src.channels(), colsn = cols*cn, depth = src.depth();
@@ -63,6 +64,7 @@ static void calcSharrDeriv(const cv::Mat& src, cv::Mat& dst)
     deriv_type *trow0 = alignPtr(_tempBuf + cn, 16), *trow1 = alignPtr(trow0 + delta, 16);
 
 #if CV_SSE2
+    CV_TRACE_SIMD(CV_CPU_SSE2);
     __m128i z = _mm_setzero_si128(), c3 = _mm_set1_epi16(3), c10 = _mm_set1_epi16(10);
 #endif
 
@@ -158,6 +160,10 @@ cv::detail::LKTrackerInvoker::LKTrackerInvoker(
 
 void cv::detail::LKTrackerInvoker::operator()(const BlockedRange& range) const
 {
+    CV_TRACE_REGION("LKTrackerInvoker");
+#if CV_SSE2
+    CV_TRACE_SIMD(CV_CPU_SSE2);
+#endif
     Point2f halfWin((winSize.width-1)*0.5f, (winSize.height-1)*0.5f);
     const Mat& I = *prevImg;
     const Mat& J = *nextImg;
@@ -484,6 +490,7 @@ void cv::detail::LKTrackerInvoker::operator()(const BlockedRange& range) const
 int cv::buildOpticalFlowPyramid(InputArray _img, OutputArrayOfArrays pyramid, Size winSize, int maxLevel, bool withDerivatives,
                                 int pyrBorder, int derivBorder, bool tryReuseInputImage)
 {
+    CV_TRACE_FUNCTION();
     Mat img = _img.getMat();
     CV_Assert(img.depth() == CV_8U && winSize.width > 2 && winSize.height > 2 );
     int pyrstep = withDerivatives ? 2 : 1;
@@ -584,6 +591,7 @@ void cv::calcOpticalFlowPyrLK( InputArray _prevImg, InputArray _nextImg,
                            TermCriteria criteria,
                            int flags, double minEigThreshold )
 {
+    CV_TRACE_FUNCTION();
     Mat prevPtsMat = _prevPts.getMat();
     const int derivDepth = DataType<cv::detail::deriv_type>::depth;
 